@@ -0,0 +1,56 @@
+from paraview import servermanager
+from paraview import simple as smp
+from paraview import smtesting
+from paraview.vtk.vtkImagingCore import vtkImageDifference
+
+# Make sure the test driver know that process has properly started
+print ("Process started")
+
+def getHost(url):
+   return url.split(':')[1][2:]
+def getPort(url):
+   return int(url.split(':')[2])
+
+# Renders remotely and captures the image delivered to the client.
+def captureImage(view, pipelined):
+    view.PipelinedImageDelivery = pipelined
+    smp.Render(view)
+    return view.SMProxy.CaptureImage(1)
+
+def runTest():
+    options = servermanager.vtkProcessModule.GetProcessModule().GetOptions()
+    url = options.GetServerURL()
+    smp.Connect(getHost(url), getPort(url))
+
+    # The image is only sent in chunks when it has several times the chunk
+    # size of active pixels: use a large view that a colored slice covers.
+    r = smp.CreateRenderView()
+    r.RemoteRenderThreshold = 0
+    r.ViewSize = [800, 800]
+    r.OrientationAxesVisibility = 0
+    w = smp.Wavelet()
+    w.WholeExtent = [-50, 50, -50, 50, -50, 50]
+    s = smp.Slice(Input=w)
+    s.SliceType.Normal = [0, 0, 1]
+    d = smp.Show(s, r)
+    smp.ColorBy(d, ('POINTS', 'RTData'))
+    r.CameraPosition = [0, 0, 150]
+    r.CameraFocalPoint = [0, 0, 0]
+    r.CameraViewUp = [0, 1, 0]
+    r.CameraParallelProjection = 1
+    r.CameraParallelScale = 40
+
+    single = captureImage(r, 0)
+    chunked = captureImage(r, 1)
+
+    diff = vtkImageDifference()
+    diff.SetInputData(chunked)
+    diff.SetImageData(single)
+    diff.SetThreshold(0)
+    diff.AllowShiftOff()
+    diff.AveragingOff()
+    diff.Update()
+    if diff.GetThresholdedError() != 0:
+        raise smtesting.TestError ("The pipelined image differs from the one sent at once!!!")
+    print ("Test Passed")
+runTest()
@@ -0,0 +1,196 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestActivePixelEncoding.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include "vtkImageCompressor.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkPVClientServerSynchronizedRenderers.h"
+#include "vtkUnsignedCharArray.h"
+
+#include <vector>
+
+#define TEST_SUCCESS 0
+#define TEST_FAILED 1
+
+namespace
+{
+// Exposes the active pixel encoding and the compression of the images.
+class vtkTestSynchronizedRenderers : public vtkPVClientServerSynchronizedRenderers
+{
+public:
+  static vtkTestSynchronizedRenderers* New();
+  vtkTypeMacro(vtkTestSynchronizedRenderers, vtkPVClientServerSynchronizedRenderers);
+  using vtkPVClientServerSynchronizedRenderers::Compress;
+  using vtkPVClientServerSynchronizedRenderers::Decompress;
+  using vtkPVClientServerSynchronizedRenderers::DecodeActivePixels;
+  using vtkPVClientServerSynchronizedRenderers::EncodeActivePixels;
+  using vtkPVClientServerSynchronizedRenderers::GetCompressor;
+};
+vtkStandardNewMacro(vtkTestSynchronizedRenderers);
+
+const int Width = 37;
+const int Height = 23;
+const int NumberOfComponents = 4;
+
+void CreateImage(vtkUnsignedCharArray* image)
+{
+  image->SetNumberOfComponents(NumberOfComponents);
+  image->SetNumberOfTuples(Width * Height);
+  for (int cc = 0; cc < NumberOfComponents; ++cc)
+  {
+    image->FillComponent(cc, 0);
+  }
+}
+
+// Every pixel has at least one non-zero component.
+void FillImage(vtkUnsignedCharArray* image)
+{
+  for (vtkIdType pixel = 0; pixel < image->GetNumberOfTuples(); ++pixel)
+  {
+    for (int cc = 0; cc < NumberOfComponents; ++cc)
+    {
+      image->SetTypedComponent(pixel, cc, static_cast<unsigned char>((pixel + cc) % 255 + 1));
+    }
+  }
+}
+
+// Single active pixels at the end of every row, with the very last pixel of
+// the image, and a pixel that is only active through its alpha.
+void SetRowEnds(vtkUnsignedCharArray* image)
+{
+  for (int row = 0; row < Height; ++row)
+  {
+    const vtkIdType pixel = row * Width + Width - 1;
+    image->SetTypedComponent(pixel, 0, static_cast<unsigned char>(row + 1));
+    image->SetTypedComponent(pixel, 3, 255);
+  }
+  image->SetTypedComponent(Width / 2, 3, 7);
+}
+
+bool SameImages(vtkUnsignedCharArray* expected, vtkUnsignedCharArray* image, const char* name)
+{
+  if (image->GetNumberOfTuples() != expected->GetNumberOfTuples() ||
+    image->GetNumberOfComponents() != expected->GetNumberOfComponents())
+  {
+    cerr << name << ": the decoded image has another size." << endl;
+    return false;
+  }
+  for (vtkIdType pixel = 0; pixel < expected->GetNumberOfTuples(); ++pixel)
+  {
+    for (int cc = 0; cc < NumberOfComponents; ++cc)
+    {
+      if (image->GetTypedComponent(pixel, cc) != expected->GetTypedComponent(pixel, cc))
+      {
+        cerr << name << ": pixel " << pixel << " differs after decoding." << endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Encodes `image`, optionally compresses and decompresses the active pixels,
+// and decodes them in an image that has garbage in it.
+bool RoundTrip(vtkTestSynchronizedRenderers* renderers, vtkUnsignedCharArray* image,
+  bool compress, std::vector<int>& spans, const char* name)
+{
+  vtkNew<vtkUnsignedCharArray> active;
+  if (!renderers->EncodeActivePixels(image, spans, active.GetPointer()))
+  {
+    cerr << name << ": the image was not encoded." << endl;
+    return false;
+  }
+  vtkNew<vtkUnsignedCharArray> received;
+  if (compress)
+  {
+    // As sent: the active pixels are compressed as a one row image.
+    renderers->GetCompressor()->SetImageResolution(
+      static_cast<int>(active->GetNumberOfTuples()), 1);
+    vtkNew<vtkUnsignedCharArray> compressed;
+    compressed->DeepCopy(renderers->Compress(active.GetPointer()));
+    received->SetNumberOfComponents(NumberOfComponents);
+    received->SetNumberOfTuples(active->GetNumberOfTuples());
+    renderers->Decompress(compressed.GetPointer(), received.GetPointer());
+  }
+  else
+  {
+    received->DeepCopy(active.GetPointer());
+  }
+
+  vtkNew<vtkUnsignedCharArray> decoded;
+  decoded->SetNumberOfComponents(NumberOfComponents);
+  decoded->SetNumberOfTuples(Width * Height);
+  FillImage(decoded.GetPointer());
+  renderers->DecodeActivePixels(received.GetPointer(), spans, decoded.GetPointer());
+  return SameImages(image, decoded.GetPointer(), name);
+}
+}
+
+int TestActivePixelEncoding(int, char* [])
+{
+  vtkNew<vtkTestSynchronizedRenderers> renderers;
+  std::vector<int> spans;
+  int result = TEST_SUCCESS;
+
+  // An all background image is still encoded, as one span.
+  vtkNew<vtkUnsignedCharArray> background;
+  CreateImage(background.GetPointer());
+  if (!RoundTrip(renderers.GetPointer(), background.GetPointer(), false, spans, "background"))
+  {
+    result = TEST_FAILED;
+  }
+  else if (spans.size() != 2)
+  {
+    cerr << "An all background image has " << spans.size() / 2 << " spans." << endl;
+    result = TEST_FAILED;
+  }
+
+  // A full image is larger when encoded, and must be sent as is.
+  vtkNew<vtkUnsignedCharArray> full;
+  CreateImage(full.GetPointer());
+  FillImage(full.GetPointer());
+  vtkNew<vtkUnsignedCharArray> active;
+  if (renderers->EncodeActivePixels(full.GetPointer(), spans, active.GetPointer()))
+  {
+    cerr << "A full image was encoded." << endl;
+    result = TEST_FAILED;
+  }
+
+  // Single pixel spans, one per row plus the alpha only pixel.
+  vtkNew<vtkUnsignedCharArray> rowEnds;
+  CreateImage(rowEnds.GetPointer());
+  SetRowEnds(rowEnds.GetPointer());
+  for (int compress = 0; compress < 2; ++compress)
+  {
+    const char* name = compress ? "compressed row ends" : "row ends";
+    if (!RoundTrip(renderers.GetPointer(), rowEnds.GetPointer(), compress != 0, spans, name))
+    {
+      result = TEST_FAILED;
+      continue;
+    }
+    bool singles = spans.size() == 2 * (Height + 1);
+    for (size_t cc = 1; singles && cc < spans.size(); cc += 2)
+    {
+      singles = spans[cc] == 1;
+    }
+    if (!singles)
+    {
+      cerr << name << ": expected " << Height + 1 << " single pixel spans." << endl;
+      result = TEST_FAILED;
+    }
+  }
+
+  return result;
+}
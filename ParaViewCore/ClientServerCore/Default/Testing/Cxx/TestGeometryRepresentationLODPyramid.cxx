@@ -0,0 +1,170 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestGeometryRepresentationLODPyramid.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include "vtkCompositeDataIterator.h"
+#include "vtkCompositeDataSet.h"
+#include "vtkDataSet.h"
+#include "vtkGeometryRepresentation.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkSphereSource.h"
+
+#include <vector>
+
+#define TEST_SUCCESS 0
+#define TEST_FAILED 1
+
+namespace
+{
+// Exposes the LOD pyramid level selection.
+class vtkTestGeometryRepresentation : public vtkGeometryRepresentation
+{
+public:
+  static vtkTestGeometryRepresentation* New();
+  vtkTypeMacro(vtkTestGeometryRepresentation, vtkGeometryRepresentation);
+  using vtkGeometryRepresentation::GetLODPyramidLevel;
+};
+vtkStandardNewMacro(vtkTestGeometryRepresentation);
+
+vtkIdType GetNumberOfCells(vtkDataObject* dobj)
+{
+  if (vtkDataSet* ds = vtkDataSet::SafeDownCast(dobj))
+  {
+    return ds->GetNumberOfCells();
+  }
+  vtkIdType numberOfCells = 0;
+  if (vtkCompositeDataSet* cd = vtkCompositeDataSet::SafeDownCast(dobj))
+  {
+    vtkCompositeDataIterator* iter = cd->NewIterator();
+    for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+    {
+      numberOfCells += GetNumberOfCells(iter->GetCurrentDataObject());
+    }
+    iter->Delete();
+  }
+  return numberOfCells;
+}
+
+const double Factors[5] = { 0.0, 0.25, 0.5, 0.75, 1.0 };
+
+// With a budget of 1 every level fits, so the level for the largest factor is
+// returned. This gives the number of cells of each level of the pyramid.
+bool GetLevelSizes(vtkTestGeometryRepresentation* repr, std::vector<vtkIdType>& sizes)
+{
+  sizes.clear();
+  for (int cc = 0; cc < 5; ++cc)
+  {
+    vtkDataObject* level = repr->GetLODPyramidLevel(Factors[cc], 1.0);
+    if (!level)
+    {
+      cerr << "No level for factor " << Factors[cc] << endl;
+      return false;
+    }
+    sizes.push_back(GetNumberOfCells(level));
+    if (cc > 0 && sizes[cc] < sizes[cc - 1])
+    {
+      cerr << "Level " << cc << " has fewer cells than level " << cc - 1 << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+// The selected level must be the finest one with at most budget * fullSize
+// cells, or the coarsest one when none fits.
+bool CheckSelection(vtkTestGeometryRepresentation* repr, const std::vector<vtkIdType>& sizes,
+  vtkIdType fullSize, double budget)
+{
+  size_t expected = 0;
+  for (size_t cc = 1; cc < sizes.size() && sizes[cc] <= budget * fullSize; ++cc)
+  {
+    expected = cc;
+  }
+  vtkDataObject* level = repr->GetLODPyramidLevel(1.0, budget);
+  vtkIdType numberOfCells = level ? GetNumberOfCells(level) : -1;
+  if (numberOfCells != sizes[expected])
+  {
+    cerr << "Budget " << budget << " selected a level with " << numberOfCells
+         << " cells, expected " << sizes[expected] << endl;
+    return false;
+  }
+  return true;
+}
+}
+
+int TestGeometryRepresentationLODPyramid(int, char* [])
+{
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(400);
+  sphere->SetPhiResolution(400);
+
+  vtkNew<vtkTestGeometryRepresentation> repr;
+  repr->SetInputConnection(sphere->GetOutputPort());
+  repr->Update();
+  sphere->Update();
+  const vtkIdType fullSize = sphere->GetOutput()->GetNumberOfCells();
+
+  std::vector<vtkIdType> sizes;
+  if (!GetLevelSizes(repr.GetPointer(), sizes))
+  {
+    return TEST_FAILED;
+  }
+  if (sizes[0] == sizes[4] || sizes[4] > fullSize)
+  {
+    cerr << "Unexpected level sizes " << sizes[0] << " ... " << sizes[4] << " for "
+         << fullSize << " cells." << endl;
+    return TEST_FAILED;
+  }
+
+  // Budgets below, at and between the level sizes.
+  std::vector<double> budgets;
+  budgets.push_back(0.0);
+  budgets.push_back(1.0);
+  for (size_t cc = 0; cc < sizes.size(); ++cc)
+  {
+    budgets.push_back(static_cast<double>(sizes[cc]) / fullSize);
+    budgets.push_back(static_cast<double>(sizes[cc] - 1) / fullSize);
+  }
+  for (size_t cc = 0; cc < budgets.size(); ++cc)
+  {
+    if (!CheckSelection(repr.GetPointer(), sizes, fullSize, budgets[cc]))
+    {
+      return TEST_FAILED;
+    }
+  }
+
+  // Levels are kept until the data changes.
+  vtkDataObject* level = repr->GetLODPyramidLevel(0.5, 1.0);
+  if (repr->GetLODPyramidLevel(0.5, 1.0) != level)
+  {
+    cerr << "Levels are not reused." << endl;
+    return TEST_FAILED;
+  }
+  sphere->SetThetaResolution(40);
+  sphere->SetPhiResolution(40);
+  repr->Update();
+  std::vector<vtkIdType> newSizes;
+  if (!GetLevelSizes(repr.GetPointer(), newSizes))
+  {
+    return TEST_FAILED;
+  }
+  if (newSizes[4] > sphere->GetOutput()->GetNumberOfCells())
+  {
+    cerr << "Levels were not recomputed for the new input." << endl;
+    return TEST_FAILED;
+  }
+
+  return TEST_SUCCESS;
+}
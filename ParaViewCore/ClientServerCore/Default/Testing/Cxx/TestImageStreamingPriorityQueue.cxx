@@ -0,0 +1,267 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestImageStreamingPriorityQueue.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include "vtkCamera.h"
+#include "vtkImageStreamingPriorityQueue.h"
+#include "vtkNew.h"
+
+#include <cmath>
+#include <set>
+#include <vector>
+
+#define TEST_SUCCESS 0
+#define TEST_FAILED 1
+
+namespace
+{
+// 128^3 points with bricks of 17 samples: levels with strides 8, 4, 2 and 1,
+// with 1, 8, 64 and 512 bricks respectively.
+const int WholeExtent[6] = { 0, 127, 0, 127, 0, 127 };
+const double Origin[3] = { 0, 0, 0 };
+const double Spacing[3] = { 1, 1, 1 };
+const int BrickSize = 17;
+const int ViewportSize[2] = { 400, 400 };
+
+struct Brick
+{
+  unsigned int Id;
+  int Extent[6];
+  int Stride;
+};
+
+void GetViewPlanes(const double position[3], const double focal_point[3], double view_angle,
+  double planes[24])
+{
+  vtkNew<vtkCamera> camera;
+  camera->SetPosition(position[0], position[1], position[2]);
+  camera->SetFocalPoint(focal_point[0], focal_point[1], focal_point[2]);
+  camera->SetViewUp(0, 1, 0);
+  camera->SetViewAngle(view_angle);
+  camera->SetClippingRange(1, 1000);
+  camera->GetFrustumPlanes(static_cast<double>(ViewportSize[0]) / ViewportSize[1], planes);
+}
+
+// Same test as the queue: the bounding sphere of the brick is not completely
+// outside one of the frustum planes.
+bool IsVisible(const double planes[24], const int extent[6])
+{
+  double center[3], radius = 0;
+  for (int cc = 0; cc < 3; ++cc)
+  {
+    center[cc] = 0.5 * (extent[2 * cc] + extent[2 * cc + 1]);
+    const double half = 0.5 * (extent[2 * cc + 1] - extent[2 * cc]);
+    radius += half * half;
+  }
+  radius = std::sqrt(radius);
+  for (int i = 0; i < 6; ++i)
+  {
+    const double* plane = planes + 4 * i;
+    if (plane[0] * center[0] + plane[1] * center[1] + plane[2] * center[2] + plane[3] < -radius)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Contains(const int outer[6], const int inner[6])
+{
+  for (int cc = 0; cc < 3; ++cc)
+  {
+    if (inner[2 * cc] < outer[2 * cc] || inner[2 * cc + 1] > outer[2 * cc + 1])
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Pops all bricks, checking that none is returned twice (also across calls,
+// through `seen`) and that each brick comes after the brick it refines.
+bool PopAll(vtkImageStreamingPriorityQueue* queue, std::set<unsigned int>& seen,
+  std::vector<Brick>& bricks)
+{
+  const int coarsest_stride = 1 << (queue->GetNumberOfLevels() - 1);
+  while (!queue->IsEmpty())
+  {
+    Brick brick;
+    brick.Id = queue->Pop();
+    if (brick.Id == VTK_UNSIGNED_INT_MAX)
+    {
+      continue;
+    }
+    if (!seen.insert(brick.Id).second)
+    {
+      cerr << "Brick " << brick.Id << " was returned twice." << endl;
+      return false;
+    }
+    if (!queue->GetBrick(brick.Id, brick.Extent, brick.Stride))
+    {
+      cerr << "Invalid brick " << brick.Id << endl;
+      return false;
+    }
+    bool has_parent = brick.Stride == coarsest_stride;
+    for (size_t cc = 0; !has_parent && cc < bricks.size(); ++cc)
+    {
+      has_parent =
+        bricks[cc].Stride == 2 * brick.Stride && Contains(bricks[cc].Extent, brick.Extent);
+    }
+    if (!has_parent)
+    {
+      cerr << "Brick " << brick.Id << " (stride " << brick.Stride
+           << ") was returned before the brick it refines." << endl;
+      return false;
+    }
+    bricks.push_back(brick);
+  }
+  return true;
+}
+
+int CountBricks(const std::vector<Brick>& bricks, int stride)
+{
+  int count = 0;
+  for (size_t cc = 0; cc < bricks.size(); ++cc)
+  {
+    count += bricks[cc].Stride == stride ? 1 : 0;
+  }
+  return count;
+}
+}
+
+int TestImageStreamingPriorityQueue(int, char* [])
+{
+  vtkNew<vtkImageStreamingPriorityQueue> queue;
+  queue->SetController(NULL);
+  queue->SetViewportSize(ViewportSize[0], ViewportSize[1]);
+  queue->Initialize(WholeExtent, Origin, Spacing, BrickSize);
+  if (queue->GetNumberOfLevels() != 4)
+  {
+    cerr << "Expected 4 levels, got " << queue->GetNumberOfLevels() << endl;
+    return TEST_FAILED;
+  }
+
+  // Without a view, only the coarsest brick, covering the whole extent, is
+  // returned.
+  std::set<unsigned int> seen;
+  std::vector<Brick> bricks;
+  if (!PopAll(queue.GetPointer(), seen, bricks))
+  {
+    return TEST_FAILED;
+  }
+  if (bricks.size() != 1 || bricks[0].Stride != 8 || !Contains(bricks[0].Extent, WholeExtent))
+  {
+    cerr << "Expected the coarsest brick only, got " << bricks.size() << " bricks." << endl;
+    return TEST_FAILED;
+  }
+
+  // Looking down the z axis at the whole image, about 3 pixels per point:
+  // everything is refined down to full resolution, coarse bricks first, and
+  // bricks closer to the camera first.
+  const double focal_point[3] = { 63.5, 63.5, 63.5 };
+  const double position[3] = { 63.5, 63.5, 300 };
+  double planes[24];
+  GetViewPlanes(position, focal_point, 30, planes);
+  queue->Reinitialize();
+  queue->Update(planes);
+  seen.clear();
+  bricks.clear();
+  if (!PopAll(queue.GetPointer(), seen, bricks))
+  {
+    return TEST_FAILED;
+  }
+  if (bricks.size() != 1 + 8 + 64 + 512)
+  {
+    cerr << "Expected all 585 bricks, got " << bricks.size() << endl;
+    return TEST_FAILED;
+  }
+  if (bricks[0].Stride != 8)
+  {
+    cerr << "The coarsest brick must be returned first." << endl;
+    return TEST_FAILED;
+  }
+  int rank = 0;
+  for (size_t cc = 0; cc < bricks.size(); ++cc)
+  {
+    if (bricks[cc].Stride == 4)
+    {
+      // the 4 level 1 bricks in the upper half of z are closer to the camera.
+      const bool near_brick = bricks[cc].Extent[4] > 0;
+      if (near_brick != (rank < 4))
+      {
+        cerr << "Level 1 brick " << bricks[cc].Id << " is returned out of order." << endl;
+        return TEST_FAILED;
+      }
+      ++rank;
+    }
+  }
+
+  // Moving the camera restarts from the coarsest bricks, but the bricks
+  // already returned are not returned again.
+  const double moved_position[3] = { 63.5, 63.5, 290 };
+  GetViewPlanes(moved_position, focal_point, 30, planes);
+  queue->Update(planes);
+  std::vector<Brick> again;
+  if (!PopAll(queue.GetPointer(), seen, again) || !again.empty())
+  {
+    cerr << "Bricks were returned again after moving the camera." << endl;
+    return TEST_FAILED;
+  }
+
+  // Zooming on a corner only refines the visible bricks.
+  const double corner_focal_point[3] = { 16, 16, 127 };
+  const double corner_position[3] = { 16, 16, 200 };
+  GetViewPlanes(corner_position, corner_focal_point, 10, planes);
+  queue->Reinitialize();
+  queue->Update(planes);
+  seen.clear();
+  bricks.clear();
+  if (!PopAll(queue.GetPointer(), seen, bricks))
+  {
+    return TEST_FAILED;
+  }
+  for (size_t cc = 0; cc < bricks.size(); ++cc)
+  {
+    if (!IsVisible(planes, bricks[cc].Extent))
+    {
+      cerr << "Brick " << bricks[cc].Id << " is outside the view frustum." << endl;
+      return TEST_FAILED;
+    }
+  }
+  const int finest = CountBricks(bricks, 1);
+  if (finest == 0 || finest >= 512)
+  {
+    cerr << "Expected some, but not all, full resolution bricks; got " << finest << endl;
+    return TEST_FAILED;
+  }
+
+  // MaximumLevel limits the refinement.
+  queue->SetMaximumLevel(1);
+  GetViewPlanes(position, focal_point, 30, planes);
+  queue->Reinitialize();
+  queue->Update(planes);
+  seen.clear();
+  bricks.clear();
+  if (!PopAll(queue.GetPointer(), seen, bricks))
+  {
+    return TEST_FAILED;
+  }
+  if (bricks.size() != 1 + 8 || CountBricks(bricks, 4) != 8)
+  {
+    cerr << "Expected the 9 bricks of levels 0 and 1, got " << bricks.size() << endl;
+    return TEST_FAILED;
+  }
+
+  return TEST_SUCCESS;
+}
@@ -43,6 +43,8 @@ vtkPythonCalculator::vtkPythonCalculator()
   this->SetArrayName("result");
   this->SetExecuteMethod(vtkPythonCalculator::ExecuteScript, this);
   this->ArrayAssociation = vtkDataObject::FIELD_ASSOCIATION_POINTS;
+  this->BatchedEvaluation = false;
+  this->UseNumExpr = false;
 }
 
 //----------------------------------------------------------------------------
@@ -169,4 +171,6 @@ int vtkPythonCalculator::FillInputPortInformation(int port, vtkInformation* info
 void vtkPythonCalculator::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "BatchedEvaluation: " << this->BatchedEvaluation << endl;
+  os << indent << "UseNumExpr: " << this->UseNumExpr << endl;
 }
@@ -74,6 +74,34 @@ public:
      */
     static void ExecuteScript(void*);
 
+  //@{
+  /**
+   * When set and the input is a composite dataset, the arrays of all blocks
+   * are concatenated and the expression is evaluated once on the concatenated
+   * arrays, instead of block by block. The result is split back into the
+   * blocks as views of the single result array, without copies. Expressions
+   * that cannot be evaluated this way (e.g. arrays missing in some blocks or
+   * scalar results) are evaluated block by block. Default is false.
+   */
+  vtkSetMacro(BatchedEvaluation, bool);
+  vtkGetMacro(BatchedEvaluation, bool);
+  vtkBooleanMacro(BatchedEvaluation, bool);
+  //@}
+
+  //@{
+  /**
+   * When set and the numexpr Python module is available, element-wise
+   * expressions of floating point arrays are evaluated with numexpr, which
+   * uses multiple threads. numexpr is only used when it gives the same values
+   * and type as numpy on the first tuples, and never for integer arrays,
+   * modulo or floor division, where their semantics differ. Other expressions
+   * are evaluated with Python as usual. Default is false.
+   */
+  vtkSetMacro(UseNumExpr, bool);
+  vtkGetMacro(UseNumExpr, bool);
+  vtkBooleanMacro(UseNumExpr, bool);
+  //@}
+
 protected:
   vtkPythonCalculator();
   ~vtkPythonCalculator() override;
@@ -96,6 +124,8 @@ protected:
   char* Expression;
   char* ArrayName;
   int ArrayAssociation;
+  bool BatchedEvaluation;
+  bool UseNumExpr;
 
 private:
   vtkPythonCalculator(const vtkPythonCalculator&) = delete;
@@ -21,7 +21,9 @@
 #include "vtkCommand.h"
 #include "vtkCompositeDataDisplayAttributes.h"
 #include "vtkCompositeDataIterator.h"
+#include "vtkCompositeDataSet.h"
 #include "vtkCompositePolyDataMapper2.h"
+#include "vtkDataSet.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkMath.h"
@@ -55,6 +57,8 @@
 
 #include <vtksys/SystemTools.hxx>
 
+#include <algorithm>
+
 //*****************************************************************************
 // This is used to convert a vtkPolyData to a vtkMultiBlockDataSet. If input is
 // vtkMultiBlockDataSet, then this is simply a pass-through filter. This makes
@@ -95,6 +99,33 @@ protected:
 };
 vtkStandardNewMacro(vtkGeometryRepresentationMultiBlockMaker);
 
+namespace
+{
+// Returns the number of cells (vertices, lines, polygons and strips) in the
+// geometry, which is what the LOD pyramid levels are compared on.
+vtkIdType vtkGeometryRepresentationGetNumberOfCells(vtkDataObject* dobj)
+{
+  if (vtkDataSet* ds = vtkDataSet::SafeDownCast(dobj))
+  {
+    return ds->GetNumberOfCells();
+  }
+  vtkIdType numberOfCells = 0;
+  if (vtkCompositeDataSet* cd = vtkCompositeDataSet::SafeDownCast(dobj))
+  {
+    vtkCompositeDataIterator* iter = cd->NewIterator();
+    for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+    {
+      if (vtkDataSet* ds = vtkDataSet::SafeDownCast(iter->GetCurrentDataObject()))
+      {
+        numberOfCells += ds->GetNumberOfCells();
+      }
+    }
+    iter->Delete();
+  }
+  return numberOfCells;
+}
+}
+
 //*****************************************************************************
 
 vtkStandardNewMacro(vtkGeometryRepresentation);
@@ -355,19 +386,32 @@ int vtkGeometryRepresentation::ProcessViewRequest(
         // new geometry.
         this->LODOutlineFilter->Modified();
 
-        if (inInfo->Has(vtkPVRenderView::LOD_RESOLUTION()))
+        if (inInfo->Has(vtkPVRenderView::LOD_BUDGET()))
         {
-          // We handle this number differently depending on decimator
-          // implementation.
-          const double factor = inInfo->Get(vtkPVRenderView::LOD_RESOLUTION());
-          this->Decimator->SetLODFactor(factor);
+          // Pick the level of the LOD pyramid that fits the view's interactive
+          // frame budget. LOD_RESOLUTION caps the finest level used.
+          const double factor = inInfo->Has(vtkPVRenderView::LOD_RESOLUTION())
+            ? inInfo->Get(vtkPVRenderView::LOD_RESOLUTION())
+            : 0.5;
+          vtkPVRenderView::SetPieceLOD(inInfo, this,
+            this->GetLODPyramidLevel(factor, inInfo->Get(vtkPVRenderView::LOD_BUDGET())));
+        }
+        else
+        {
+          if (inInfo->Has(vtkPVRenderView::LOD_RESOLUTION()))
+          {
+            // We handle this number differently depending on decimator
+            // implementation.
+            const double factor = inInfo->Get(vtkPVRenderView::LOD_RESOLUTION());
+            this->Decimator->SetLODFactor(factor);
+          }
+
+          this->Decimator->Update();
+
+          // Pass along the LOD geometry to the view so that it can deliver it to
+          // the rendering node as and when needed.
+          vtkPVRenderView::SetPieceLOD(inInfo, this, this->Decimator->GetOutputDataObject(0));
         }
-
-        this->Decimator->Update();
-
-        // Pass along the LOD geometry to the view so that it can deliver it to
-        // the rendering node as and when needed.
-        vtkPVRenderView::SetPieceLOD(inInfo, this, this->Decimator->GetOutputDataObject(0));
       }
     }
   }
@@ -472,6 +516,7 @@ int vtkGeometryRepresentation::RequestData(
     this->GeometryFilter->SetInputDataObject(0, placeholder.GetPointer());
   }
   this->CacheKeeper->Update();
+  this->PruneLODPyramid();
 
   // HACK: To overcome issue with PolyDataMapper (OpenGL2). It doesn't recreate
   // VBO/IBOs when using data from cache. I suspect it's because the blocks in
@@ -529,10 +574,83 @@ void vtkGeometryRepresentation::MarkModified()
   {
     // Cleanup caches when not using cache.
     this->CacheKeeper->RemoveAllCaches();
+    this->LODPyramid.clear();
   }
   this->Superclass::MarkModified();
 }
 
+//----------------------------------------------------------------------------
+void vtkGeometryRepresentation::PruneLODPyramid()
+{
+  if (!this->GetUseCache())
+  {
+    // The levels were computed for data that has just been replaced.
+    this->LODPyramid.clear();
+    return;
+  }
+
+  // Keep the levels for timesteps still held by the cache keeper.
+  auto iter = this->LODPyramid.begin();
+  while (iter != this->LODPyramid.end())
+  {
+    if (this->CacheKeeper->IsCached(iter->first))
+    {
+      ++iter;
+    }
+    else
+    {
+      iter = this->LODPyramid.erase(iter);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkDataObject* vtkGeometryRepresentation::GetLODPyramidLevel(double max_factor, double budget)
+{
+  vtkDataObject* fullres = this->CacheKeeper->GetOutputDataObject(0);
+  const double key = this->GetUseCache() ? this->GetCacheKey() : 0.0;
+  std::map<double, vtkSmartPointer<vtkDataObject> >& levels = this->LODPyramid[key];
+
+  // Number of cells that can be rendered in the budget. The budget is the
+  // frame budget divided by the time of the last still render of the full
+  // resolution geometry. Render time is taken to grow linearly with the
+  // number of cells drawn, which holds once rendering is geometry bound, i.e.
+  // in the cases where LOD matters. The per-frame costs that do not depend on
+  // the geometry (clearing, compositing, image delivery) are not modeled, so
+  // interactive frames may exceed the budget by about that much.
+  const double max_cells =
+    budget * (fullres ? vtkGeometryRepresentationGetNumberOfCells(fullres) : 0);
+
+  // Levels are 0.25 apart in LOD factor, i.e. each level doubles the
+  // clustering grid of the vtkm decimator (64^3, 128^3, 256^3, ...). Walk from
+  // coarse to fine and stop at the first level that does not fit, so the finer
+  // levels are only computed when they can actually be used.
+  vtkDataObject* selected = NULL;
+  for (int cc = 0;; ++cc)
+  {
+    const double factor = std::min(0.25 * cc, max_factor);
+    vtkSmartPointer<vtkDataObject>& level = levels[factor];
+    if (!level)
+    {
+      this->Decimator->SetLODFactor(factor);
+      this->Decimator->Update();
+      vtkDataObject* output = this->Decimator->GetOutputDataObject(0);
+      level.TakeReference(output->NewInstance());
+      level->DeepCopy(output);
+    }
+    if (selected && vtkGeometryRepresentationGetNumberOfCells(level) > max_cells)
+    {
+      break;
+    }
+    selected = level;
+    if (factor >= max_factor)
+    {
+      break;
+    }
+  }
+  return selected;
+}
+
 //----------------------------------------------------------------------------
 bool vtkGeometryRepresentation::AddToView(vtkView* view)
 {
@@ -28,11 +28,13 @@
 #ifndef vtkGeometryRepresentation_h
 #define vtkGeometryRepresentation_h
 #include <array>         // needed for array
+#include <map>           // needed for map
 #include <unordered_map> // needed for unordered_map
 
 #include "vtkPVClientServerCoreRenderingModule.h" // needed for exports
 #include "vtkPVDataRepresentation.h"
-#include "vtkProperty.h" // needed for VTK_POINTS etc.
+#include "vtkProperty.h"     // needed for VTK_POINTS etc.
+#include "vtkSmartPointer.h" // needed for vtkSmartPointer
 
 class vtkCallbackCommand;
 class vtkCompositeDataDisplayAttributes;
@@ -370,6 +372,21 @@ protected:
    */
   void ComputeVisibleDataBounds();
 
+  /**
+   * Used in REQUEST_UPDATE_LOD() pass when the view provides a
+   * vtkPVRenderView::LOD_BUDGET(). Returns the finest level of the LOD pyramid
+   * with at most \c budget times as many cells as the full resolution
+   * geometry, using LOD factors up to \c max_factor. The coarsest level is
+   * returned when none fits. Levels are computed as needed and kept for the
+   * current cache key.
+   */
+  vtkDataObject* GetLODPyramidLevel(double max_factor, double budget);
+
+  /**
+   * Releases LOD pyramid levels that are no longer valid.
+   */
+  void PruneLODPyramid();
+
   vtkAlgorithm* GeometryFilter;
   vtkAlgorithm* MultiBlockMaker;
   vtkPVCacheKeeper* CacheKeeper;
@@ -402,6 +419,9 @@ protected:
   std::unordered_map<unsigned int, double> BlockOpacities;
   std::unordered_map<unsigned int, std::array<double, 3> > BlockColors;
 
+  // LOD pyramid levels, indexed by cache key and by LOD factor.
+  std::map<double, std::map<double, vtkSmartPointer<vtkDataObject> > > LODPyramid;
+
 private:
   vtkGeometryRepresentation(const vtkGeometryRepresentation&) = delete;
   void operator=(const vtkGeometryRepresentation&) = delete;
@@ -14,8 +14,8 @@
 =========================================================================*/
 
 // We'll use the VTKm decimation filter if TBB is enabled, otherwise we'll
-// fallback to vtkQuadricClustering, since vtkmLevelOfDetail is slow on the
-// serial backend.
+// fallback to vtkPVQuadricClustering, a multithreaded vtkQuadricClustering,
+// since vtkmLevelOfDetail is slow on the serial backend.
 #ifndef __VTK_WRAP__
 #ifdef PARAVIEW_USE_VTKM
 #include "vtkmConfig.h" // for VTKM_ENABLE_TBB
@@ -47,14 +47,14 @@ public:
 vtkStandardNewMacro(DecimationFilterType)
 }
 #else // VTKM_ENABLE_TBB
-#include "vtkQuadricClustering.h"
+#include "vtkPVQuadricClustering.h"
 namespace vtkGeometryRepresentation_detail
 {
-class DecimationFilterType : public vtkQuadricClustering
+class DecimationFilterType : public vtkPVQuadricClustering
 {
 public:
   static DecimationFilterType* New();
-  vtkTypeMacro(DecimationFilterType, vtkQuadricClustering)
+  vtkTypeMacro(DecimationFilterType, vtkPVQuadricClustering)
 
     // This version gets slower as the grid increases, while the VTKM version
     // scales with number of points. This means we can get away with a much finer
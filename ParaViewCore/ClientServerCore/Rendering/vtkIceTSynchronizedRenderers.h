@@ -145,6 +145,14 @@ public:
    */
   void SetRenderEmptyImages(bool);
 
+  /**
+   * Set the IceT compositing strategies.
+   * See vtkIceTCompositePass::SetStrategy() and
+   * vtkIceTCompositePass::SetSingleImageStrategy().
+   */
+  void SetStrategy(int val) { this->IceTCompositePass->SetStrategy(val); }
+  void SetSingleImageStrategy(int val) { this->IceTCompositePass->SetSingleImageStrategy(val); }
+
   //@{
   /**
    * Get/Set geometry rendering pass. This pass is used to render the geometry.
@@ -0,0 +1,403 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    vtkImageStreamingPriorityQueue.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkImageStreamingPriorityQueue.h"
+
+#include "vtkBoundingBox.h"
+#include "vtkMath.h"
+#include "vtkMultiProcessController.h"
+#include "vtkObjectFactory.h"
+#include "vtkStreamingPriorityQueue.h"
+#include "vtkTimeStamp.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+#include <set>
+#include <vector>
+
+class vtkImageStreamingPriorityQueue::vtkInternals
+{
+public:
+  vtkStreamingPriorityQueue<> PriorityQueue;
+
+  // Bricks already returned by Pop(). They are never returned again, but are
+  // still refined when the view changes.
+  std::set<unsigned int> PoppedBricks;
+
+  bool Initialized;
+  int WholeExtent[6];
+  double Origin[3];
+  double Spacing[3];
+  int BrickSize;
+  int NumberOfLevels;
+
+  // Number of bricks along each axis for each level, and the identifier of the
+  // first brick of each level.
+  std::vector<int> LevelDimensions;
+  std::vector<unsigned int> LevelOffsets;
+
+  bool HasViewPlanes;
+  double ViewPlanes[24];
+  double ClampBounds[6];
+  vtkTimeStamp UpdateTime;
+
+  vtkInternals()
+    : Initialized(false)
+    , BrickSize(0)
+    , NumberOfLevels(0)
+    , HasViewPlanes(false)
+  {
+    vtkMath::UninitializeBounds(this->ClampBounds);
+  }
+
+  int GetStride(int level) const { return 1 << (this->NumberOfLevels - 1 - level); }
+
+  bool Setup(const int whole_extent[6], const double origin[3], const double spacing[3],
+    int brick_size)
+  {
+    std::copy(whole_extent, whole_extent + 6, this->WholeExtent);
+    std::copy(origin, origin + 3, this->Origin);
+    std::copy(spacing, spacing + 3, this->Spacing);
+    this->BrickSize = brick_size;
+
+    int max_cells = 0;
+    for (int cc = 0; cc < 3; cc++)
+    {
+      max_cells = std::max(max_cells, whole_extent[2 * cc + 1] - whole_extent[2 * cc]);
+    }
+
+    // the coarsest level has a single brick along the longest axis.
+    const int brick_cells = brick_size - 1;
+    this->NumberOfLevels = 1;
+    for (vtkIdType span = brick_cells; span < max_cells; span *= 2)
+    {
+      this->NumberOfLevels++;
+    }
+
+    this->LevelDimensions.resize(3 * this->NumberOfLevels);
+    this->LevelOffsets.resize(this->NumberOfLevels);
+    double num_bricks = 0;
+    for (int level = 0; level < this->NumberOfLevels; level++)
+    {
+      const vtkIdType span = static_cast<vtkIdType>(brick_cells) * this->GetStride(level);
+      double level_bricks = 1;
+      for (int cc = 0; cc < 3; cc++)
+      {
+        const vtkIdType cells = whole_extent[2 * cc + 1] - whole_extent[2 * cc];
+        int& dim = this->LevelDimensions[3 * level + cc];
+        dim = std::max(1, static_cast<int>((cells + span - 1) / span));
+        level_bricks *= dim;
+      }
+      this->LevelOffsets[level] = static_cast<unsigned int>(num_bricks);
+      num_bricks += level_bricks;
+    }
+    // VTK_UNSIGNED_INT_MAX is used to mean "no brick".
+    return num_bricks < VTK_UNSIGNED_INT_MAX;
+  }
+
+  bool GetBrickIndex(unsigned int id, int& level, int ijk[3]) const
+  {
+    if (!this->Initialized)
+    {
+      return false;
+    }
+    for (level = this->NumberOfLevels - 1; level >= 0; level--)
+    {
+      if (id >= this->LevelOffsets[level])
+      {
+        const int* dims = &this->LevelDimensions[3 * level];
+        unsigned int index = id - this->LevelOffsets[level];
+        if (index >= static_cast<unsigned int>(dims[0]) * dims[1] * dims[2])
+        {
+          return false;
+        }
+        ijk[0] = static_cast<int>(index % dims[0]);
+        ijk[1] = static_cast<int>((index / dims[0]) % dims[1]);
+        ijk[2] = static_cast<int>(index / (dims[0] * dims[1]));
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void GetBrickExtent(int level, const int ijk[3], int extent[6]) const
+  {
+    const int span = (this->BrickSize - 1) * this->GetStride(level);
+    for (int cc = 0; cc < 3; cc++)
+    {
+      extent[2 * cc] = this->WholeExtent[2 * cc] + ijk[cc] * span;
+      extent[2 * cc + 1] = std::min(extent[2 * cc] + span, this->WholeExtent[2 * cc + 1]);
+    }
+  }
+
+  vtkStreamingPriorityQueueItem NewItem(int level, const int ijk[3]) const
+  {
+    const int* dims = &this->LevelDimensions[3 * level];
+
+    vtkStreamingPriorityQueueItem item;
+    item.Identifier =
+      this->LevelOffsets[level] + ijk[0] + dims[0] * (ijk[1] + dims[1] * ijk[2]);
+    item.Refinement = static_cast<double>(level);
+
+    int extent[6];
+    this->GetBrickExtent(level, ijk, extent);
+    for (int cc = 0; cc < 8; cc++)
+    {
+      item.Bounds.AddPoint(this->Origin[0] + extent[cc & 1] * this->Spacing[0],
+        this->Origin[1] + extent[2 + ((cc >> 1) & 1)] * this->Spacing[1],
+        this->Origin[2] + extent[4 + ((cc >> 2) & 1)] * this->Spacing[2]);
+    }
+    return item;
+  }
+
+  void PushCoarsestBricks()
+  {
+    this->PriorityQueue = vtkStreamingPriorityQueue<>();
+    const int* dims = &this->LevelDimensions[0];
+    int ijk[3];
+    for (ijk[2] = 0; ijk[2] < dims[2]; ijk[2]++)
+    {
+      for (ijk[1] = 0; ijk[1] < dims[1]; ijk[1]++)
+      {
+        for (ijk[0] = 0; ijk[0] < dims[0]; ijk[0]++)
+        {
+          this->PriorityQueue.push(this->NewItem(0, ijk));
+        }
+      }
+    }
+    if (this->HasViewPlanes)
+    {
+      this->PriorityQueue.UpdatePriorities(this->ViewPlanes, this->ClampBounds);
+    }
+  }
+
+  // Adds the visible children of the brick to the queue.
+  void PushChildren(const vtkStreamingPriorityQueueItem& item)
+  {
+    int level, ijk[3];
+    this->GetBrickIndex(item.Identifier, level, ijk);
+
+    vtkStreamingPriorityQueue<> children;
+    const int* dims = &this->LevelDimensions[3 * (level + 1)];
+    for (int cc = 0; cc < 8; cc++)
+    {
+      int child[3] = { 2 * ijk[0] + (cc & 1), 2 * ijk[1] + ((cc >> 1) & 1),
+        2 * ijk[2] + ((cc >> 2) & 1) };
+      if (child[0] < dims[0] && child[1] < dims[1] && child[2] < dims[2])
+      {
+        children.push(this->NewItem(level + 1, child));
+      }
+    }
+    children.UpdatePriorities(this->ViewPlanes, this->ClampBounds);
+    for (; !children.empty(); children.pop())
+    {
+      if (children.top().ScreenCoverage > 0)
+      {
+        this->PriorityQueue.push(children.top());
+      }
+    }
+  }
+
+  // Returns the number of pixels covered by a sample of the brick.
+  double GetPixelsPerSample(const vtkStreamingPriorityQueueItem& item, const int viewport[2]) const
+  {
+    int level, ijk[3], extent[6];
+    this->GetBrickIndex(item.Identifier, level, ijk);
+    this->GetBrickExtent(level, ijk, extent);
+    const int stride = this->GetStride(level);
+
+    // ScreenCoverage is the fraction of the screen covered by the visible part
+    // of the brick's bounding sphere, ItemCoverage the visible fraction.
+    double area = item.ScreenCoverage;
+    if (item.ItemCoverage > 0)
+    {
+      area /= std::min(1.0, item.ItemCoverage);
+    }
+    const double pixels = std::sqrt(area * viewport[0] * viewport[1]);
+
+    // the sphere diameter is the brick diagonal.
+    double samples2 = 0;
+    for (int cc = 0; cc < 3; cc++)
+    {
+      const double samples = static_cast<double>(extent[2 * cc + 1] - extent[2 * cc]) / stride;
+      samples2 += samples * samples;
+    }
+    return pixels / std::max(1.0, std::sqrt(samples2));
+  }
+};
+
+vtkStandardNewMacro(vtkImageStreamingPriorityQueue);
+vtkCxxSetObjectMacro(vtkImageStreamingPriorityQueue, Controller, vtkMultiProcessController);
+//----------------------------------------------------------------------------
+vtkImageStreamingPriorityQueue::vtkImageStreamingPriorityQueue()
+{
+  this->Internals = new vtkInternals();
+  this->Controller = 0;
+  this->ScreenSpaceError = 1.0;
+  this->ViewportSize[0] = this->ViewportSize[1] = 0;
+  this->MaximumLevel = VTK_INT_MAX;
+  this->SetController(vtkMultiProcessController::GetGlobalController());
+}
+
+//----------------------------------------------------------------------------
+vtkImageStreamingPriorityQueue::~vtkImageStreamingPriorityQueue()
+{
+  delete this->Internals;
+  this->Internals = 0;
+  this->SetController(0);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStreamingPriorityQueue::Initialize(
+  const int whole_extent[6], const double origin[3], const double spacing[3], int brick_size)
+{
+  delete this->Internals;
+  this->Internals = new vtkInternals();
+  if (whole_extent[0] > whole_extent[1] || whole_extent[2] > whole_extent[3] ||
+    whole_extent[4] > whole_extent[5])
+  {
+    // empty image, nothing to stream.
+    return;
+  }
+
+  if (!this->Internals->Setup(whole_extent, origin, spacing, std::max(2, brick_size)))
+  {
+    vtkErrorMacro("Too many bricks. Please use a larger brick size.");
+    return;
+  }
+  this->Internals->Initialized = true;
+  this->Internals->PushCoarsestBricks();
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStreamingPriorityQueue::Reinitialize()
+{
+  if (this->Internals->Initialized)
+  {
+    this->Internals->PoppedBricks.clear();
+    this->Internals->PushCoarsestBricks();
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkImageStreamingPriorityQueue::IsEmpty()
+{
+  return this->Internals->PriorityQueue.empty();
+}
+
+//----------------------------------------------------------------------------
+unsigned int vtkImageStreamingPriorityQueue::Pop()
+{
+  if (this->IsEmpty())
+  {
+    vtkErrorMacro("Queue is empty!");
+    return VTK_UNSIGNED_INT_MAX;
+  }
+
+  int num_procs = this->Controller ? this->Controller->GetNumberOfProcesses() : 1;
+  int myid = this->Controller ? this->Controller->GetLocalProcessId() : 0;
+  assert(myid < num_procs);
+
+  vtkInternals& internals = *this->Internals;
+  std::vector<unsigned int> items(num_procs, VTK_UNSIGNED_INT_MAX);
+  for (int cc = 0; cc < num_procs && !internals.PriorityQueue.empty();)
+  {
+    vtkStreamingPriorityQueueItem item = internals.PriorityQueue.top();
+    internals.PriorityQueue.pop();
+
+    // refine the brick if its samples are too large on screen.
+    const int level = static_cast<int>(item.Refinement);
+    if (internals.HasViewPlanes && item.ScreenCoverage > 0 &&
+      level + 1 < internals.NumberOfLevels && level < this->MaximumLevel &&
+      internals.GetPixelsPerSample(item, this->ViewportSize) > this->ScreenSpaceError)
+    {
+      internals.PushChildren(item);
+    }
+
+    // bricks popped for a previous view are refined, but not requested again.
+    if (internals.PoppedBricks.insert(item.Identifier).second)
+    {
+      items[cc++] = item.Identifier;
+    }
+  }
+
+  // at the end, when the queue empties out in the middle of a pop, the
+  // remaining processes get no brick.
+  return items[myid];
+}
+
+//----------------------------------------------------------------------------
+bool vtkImageStreamingPriorityQueue::GetBrick(unsigned int id, int extent[6], int& stride)
+{
+  int level, ijk[3];
+  if (!this->Internals->GetBrickIndex(id, level, ijk))
+  {
+    return false;
+  }
+  this->Internals->GetBrickExtent(level, ijk, extent);
+  stride = this->Internals->GetStride(level);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageStreamingPriorityQueue::GetNumberOfLevels()
+{
+  return this->Internals->NumberOfLevels;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStreamingPriorityQueue::Update(const double view_planes[24])
+{
+  double clamp_bounds[6];
+  vtkMath::UninitializeBounds(clamp_bounds);
+  this->Update(view_planes, clamp_bounds);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStreamingPriorityQueue::Update(
+  const double view_planes[24], const double clamp_bounds[6])
+{
+  vtkInternals& internals = *this->Internals;
+  if (!internals.Initialized)
+  {
+    return;
+  }
+
+  bool changed = !internals.HasViewPlanes || this->GetMTime() > internals.UpdateTime ||
+    !std::equal(view_planes, view_planes + 24, internals.ViewPlanes) ||
+    !std::equal(clamp_bounds, clamp_bounds + 6, internals.ClampBounds);
+  internals.HasViewPlanes = true;
+  internals.UpdateTime.Modified();
+  std::copy(view_planes, view_planes + 24, internals.ViewPlanes);
+  std::copy(clamp_bounds, clamp_bounds + 6, internals.ClampBounds);
+  if (changed)
+  {
+    // bricks dropped as invisible or not refined enough for the previous view
+    // (or the previous screen-space error) may be needed now: restart from the
+    // coarsest bricks. Bricks already popped are skipped by Pop().
+    internals.PushCoarsestBricks();
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStreamingPriorityQueue::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Controller: " << this->Controller << endl;
+  os << indent << "ScreenSpaceError: " << this->ScreenSpaceError << endl;
+  os << indent << "ViewportSize: " << this->ViewportSize[0] << ", " << this->ViewportSize[1]
+     << endl;
+  os << indent << "MaximumLevel: " << this->MaximumLevel << endl;
+}
@@ -0,0 +1,160 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    vtkImageStreamingPriorityQueue.h
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+ * @class   vtkImageStreamingPriorityQueue
+ * @brief   implements a coverage based priority
+ * queue for bricks of a vtkImageData.
+ *
+ * vtkImageStreamingPriorityQueue is used by representations streaming large
+ * images brick by brick to determine the order in which to request the
+ * bricks. The whole extent of the image is split into a hierarchy of bricks:
+ * at level 0, a single brick (per axis) covers the whole extent at a coarse
+ * sample stride; every level halves the stride and splits each brick into
+ * (up to) 8 children, down to the finest level, which samples every point.
+ * All bricks have at most BrickSize samples along each axis.
+ *
+ * The queue starts with the level 0 bricks. Priorities are computed using the
+ * view planes just like vtkAMRStreamingPriorityQueue. When a brick is popped,
+ * its children are added to the queue if a sample of the brick covers more
+ * than ScreenSpaceError pixels on screen. Bricks outside the view frustum are
+ * never refined. Thus only bricks visible in the view get read, at a
+ * resolution matching their size on screen.
+ * @sa
+ * vtkImageStreamingVolumeRepresentation, vtkAMRStreamingPriorityQueue.
+*/
+
+#ifndef vtkImageStreamingPriorityQueue_h
+#define vtkImageStreamingPriorityQueue_h
+
+#include "vtkObject.h"
+#include "vtkPVClientServerCoreRenderingModule.h" // for export macros
+
+class vtkMultiProcessController;
+
+class VTKPVCLIENTSERVERCORERENDERING_EXPORT vtkImageStreamingPriorityQueue : public vtkObject
+{
+public:
+  static vtkImageStreamingPriorityQueue* New();
+  vtkTypeMacro(vtkImageStreamingPriorityQueue, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  //@{
+  /**
+   * If the controller is specified, the queue can be used in parallel. So long
+   * as Initialize(), Update() and Pop() methods are called on all processes
+   * (need not be synchronized) and all process get the same image meta-data
+   * and view_planes (which is generally true with ParaView), the bricks are
+   * distributed among the processes.
+   * By default, this is set to the
+   * vtkMultiProcessController::GetGlobalController();
+   */
+  void SetController(vtkMultiProcessController*);
+  vtkGetObjectMacro(Controller, vtkMultiProcessController);
+  //@}
+
+  //@{
+  /**
+   * Number of pixels a brick sample may cover on screen before the brick is
+   * refined. Default is 1.
+   */
+  vtkSetClampMacro(ScreenSpaceError, double, 0.01, VTK_DOUBLE_MAX);
+  vtkGetMacro(ScreenSpaceError, double);
+  //@}
+
+  //@{
+  /**
+   * Size of the viewport in pixels, used to compute the screen-space error.
+   * This must be set before Update().
+   */
+  vtkSetVector2Macro(ViewportSize, int);
+  vtkGetVector2Macro(ViewportSize, int);
+  //@}
+
+  //@{
+  /**
+   * Bricks at levels greater than this are never requested. Use this when
+   * the consumer cannot make use of samples finer than a given level.
+   * Default is VTK_INT_MAX, i.e. down to the full resolution.
+   */
+  vtkSetMacro(MaximumLevel, int);
+  vtkGetMacro(MaximumLevel, int);
+  //@}
+
+  /**
+   * Initializes the queue for an image with the given meta-data. All
+   * information about items in the queue is lost. brick_size is the maximum
+   * number of samples along each axis of a brick.
+   */
+  void Initialize(const int whole_extent[6], const double origin[3], const double spacing[3],
+    int brick_size);
+
+  /**
+   * Re-initializes the priority queue using the meta-data given to the most
+   * recent call to Initialize().
+   */
+  void Reinitialize();
+
+  //@{
+  /**
+   * Updates the priorities of bricks based on the new view frustum planes.
+   * Bricks completely outside the clamp_bounds, if specified, are dropped.
+   * Information about bricks "popped" from the queue is preserved: they are
+   * refined if needed, but never returned again by Pop().
+   */
+  void Update(const double view_planes[24], const double clamp_bounds[6]);
+  void Update(const double view_planes[24]);
+  //@}
+
+  /**
+   * Returns if the queue is empty.
+   */
+  bool IsEmpty();
+
+  /**
+   * Pops and returns the identifier for the brick to request on this process.
+   * Returns VTK_UNSIGNED_INT_MAX if there is no brick left for this process.
+   * Test if the queue is empty before calling this method.
+   */
+  unsigned int Pop();
+
+  /**
+   * Provides the point extent (at full resolution) and the sample stride of a
+   * brick returned by Pop(). Returns false for invalid identifiers.
+   */
+  bool GetBrick(unsigned int id, int extent[6], int& stride);
+
+  /**
+   * Returns the number of levels in the brick hierarchy.
+   */
+  int GetNumberOfLevels();
+
+protected:
+  vtkImageStreamingPriorityQueue();
+  ~vtkImageStreamingPriorityQueue() override;
+
+  vtkMultiProcessController* Controller;
+  double ScreenSpaceError;
+  int ViewportSize[2];
+  int MaximumLevel;
+
+private:
+  vtkImageStreamingPriorityQueue(const vtkImageStreamingPriorityQueue&) = delete;
+  void operator=(const vtkImageStreamingPriorityQueue&) = delete;
+
+  class vtkInternals;
+  vtkInternals* Internals;
+};
+
+#endif
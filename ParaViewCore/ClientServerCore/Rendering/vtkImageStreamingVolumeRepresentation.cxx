@@ -0,0 +1,1000 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    vtkImageStreamingVolumeRepresentation.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkImageStreamingVolumeRepresentation.h"
+
+#include "vtkAMRVolumeMapper.h"
+#include "vtkAlgorithmOutput.h"
+#include "vtkDoubleArray.h"
+#include "vtkFieldData.h"
+#include "vtkImageData.h"
+#include "vtkImageStreamingPriorityQueue.h"
+#include "vtkInformation.h"
+#include "vtkInformationVector.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkOutlineSource.h"
+#include "vtkPVLODVolume.h"
+#include "vtkPVRenderView.h"
+#include "vtkPVStreamingMacros.h"
+#include "vtkPointData.h"
+#include "vtkPolyDataMapper.h"
+#include "vtkRenderWindow.h"
+#include "vtkRenderer.h"
+#include "vtkSmartVolumeMapper.h"
+#include "vtkStreamingDemandDrivenPipeline.h"
+#include "vtkStructuredData.h"
+#include "vtkVolumeProperty.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+#include <cstring>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace
+{
+// Name of the field array used to tag streamed bricks with the geometry of the
+// volume they were requested for: bounds followed by the number of samples.
+const char* vtkVolumeGeometryArrayName = "VolumeGeometry";
+
+//----------------------------------------------------------------------------
+void vtkComputeVolumeGeometry(
+  const double bounds[6], const int samples[3], int dims[3], double spacing[3])
+{
+  for (int cc = 0; cc < 3; cc++)
+  {
+    const double length = bounds[2 * cc + 1] - bounds[2 * cc];
+    dims[cc] = length > 0 ? std::max(2, samples[cc]) : 1;
+    spacing[cc] = length > 0 ? length / (dims[cc] - 1) : 1.0;
+  }
+}
+}
+
+class vtkImageStreamingVolumeRepresentation::vtkInternals
+{
+public:
+  //---------------------------------------------------------------------------
+  // Meta-data about the input image, from RequestInformation().
+  int WholeExtent[6];
+  double Origin[3];
+  double Spacing[3];
+
+  //---------------------------------------------------------------------------
+  // Brick being assembled from the input on the data-server nodes. Bricks with
+  // a sample stride use the index space of the whole extent subsampled at that
+  // stride, so that bricks read in parallel can be appended.
+  vtkSmartPointer<vtkImageData> Brick;
+  int BrickStride;
+  int RequestExtent[6];
+  double VolumeGeometry[9];
+
+  //---------------------------------------------------------------------------
+  // Least-recently-used brick cache, on the data-server nodes. The most
+  // recently used bricks are at the front of the list.
+  typedef std::list<std::pair<unsigned int, vtkSmartPointer<vtkImageData> > > BrickListType;
+  BrickListType CachedBricks;
+  std::map<unsigned int, BrickListType::iterator> CachedBricksMap;
+  unsigned long CachedBricksSize; // in kibibytes.
+
+  //---------------------------------------------------------------------------
+  // Resampled volume, on the rendering nodes. VolumeResolution keeps, for each
+  // sample, the spacing of the brick it comes from, so that finer bricks
+  // override coarser ones.
+  vtkSmartPointer<vtkImageData> Volume;
+  std::vector<double> VolumeResolution;
+  bool VolumeNeedsInitialization;
+  double RenderedVolumeGeometry[9];
+
+  vtkInternals()
+    : BrickStride(1)
+    , CachedBricksSize(0)
+    , VolumeNeedsInitialization(true)
+  {
+    this->WholeExtent[0] = this->WholeExtent[2] = this->WholeExtent[4] = 0;
+    this->WholeExtent[1] = this->WholeExtent[3] = this->WholeExtent[5] = -1;
+    this->Origin[0] = this->Origin[1] = this->Origin[2] = 0;
+    this->Spacing[0] = this->Spacing[1] = this->Spacing[2] = 1;
+    std::fill(this->RequestExtent, this->RequestExtent + 6, 0);
+    std::fill(this->VolumeGeometry, this->VolumeGeometry + 9, 0);
+    std::fill(this->RenderedVolumeGeometry, this->RenderedVolumeGeometry + 9, 0);
+  }
+
+  //---------------------------------------------------------------------------
+  vtkImageData* GetCachedBrick(unsigned int id)
+  {
+    std::map<unsigned int, BrickListType::iterator>::iterator iter =
+      this->CachedBricksMap.find(id);
+    if (iter == this->CachedBricksMap.end())
+    {
+      return NULL;
+    }
+    this->CachedBricks.splice(this->CachedBricks.begin(), this->CachedBricks, iter->second);
+    return iter->second->second;
+  }
+
+  void AddCachedBrick(unsigned int id, vtkImageData* brick, unsigned long max_size)
+  {
+    const unsigned long size = brick->GetActualMemorySize();
+    if (size > max_size || this->CachedBricksMap.find(id) != this->CachedBricksMap.end())
+    {
+      return;
+    }
+    while (!this->CachedBricks.empty() && this->CachedBricksSize + size > max_size)
+    {
+      this->CachedBricksSize -= this->CachedBricks.back().second->GetActualMemorySize();
+      this->CachedBricksMap.erase(this->CachedBricks.back().first);
+      this->CachedBricks.pop_back();
+    }
+    this->CachedBricks.push_front(std::make_pair(id, vtkSmartPointer<vtkImageData>(brick)));
+    this->CachedBricksMap[id] = this->CachedBricks.begin();
+    this->CachedBricksSize += size;
+  }
+
+  void ClearCache()
+  {
+    this->CachedBricks.clear();
+    this->CachedBricksMap.clear();
+    this->CachedBricksSize = 0;
+  }
+
+  //---------------------------------------------------------------------------
+  // Starts a new brick covering the given point extent at the given stride.
+  void StartBrick(const int extent[6], int stride)
+  {
+    int brick_extent[6];
+    for (int cc = 0; cc < 3; cc++)
+    {
+      const int first = extent[2 * cc] - this->WholeExtent[2 * cc];
+      const int last = extent[2 * cc + 1] - this->WholeExtent[2 * cc];
+      brick_extent[2 * cc] = (first + stride - 1) / stride;
+      brick_extent[2 * cc + 1] = last / stride;
+    }
+
+    this->Brick = vtkSmartPointer<vtkImageData>::New();
+    this->Brick->SetExtent(brick_extent);
+    this->Brick->SetOrigin(this->Origin[0] + this->WholeExtent[0] * this->Spacing[0],
+      this->Origin[1] + this->WholeExtent[2] * this->Spacing[1],
+      this->Origin[2] + this->WholeExtent[4] * this->Spacing[2]);
+    this->Brick->SetSpacing(
+      this->Spacing[0] * stride, this->Spacing[1] * stride, this->Spacing[2] * stride);
+    this->BrickStride = stride;
+  }
+
+  // Returns the number of input requests needed to fill the brick, and sets up
+  // RequestExtent for the given one. Bricks with a stride are read one slice
+  // at a time, so that the memory needed does not depend on the stride.
+  int GetNumberOfRequests() const
+  {
+    const int* ext = this->Brick->GetExtent();
+    return this->BrickStride == 1 ? 1 : std::max(0, ext[5] - ext[4] + 1);
+  }
+
+  void SetupRequest(const int extent[6], int request)
+  {
+    std::copy(extent, extent + 6, this->RequestExtent);
+    if (this->BrickStride > 1)
+    {
+      const int k =
+        this->WholeExtent[4] + (this->Brick->GetExtent()[4] + request) * this->BrickStride;
+      this->RequestExtent[4] = this->RequestExtent[5] = k;
+    }
+  }
+
+  // Copies the samples of the input falling in the brick.
+  void CopySamples(vtkImageData* input, const char* name)
+  {
+    vtkDataArray* source = (name && name[0]) ? input->GetPointData()->GetArray(name)
+                                             : input->GetPointData()->GetScalars();
+    if (!source || input->GetNumberOfPoints() == 0)
+    {
+      return;
+    }
+
+    vtkDataArray* dest = this->Brick->GetPointData()->GetScalars();
+    if (!dest)
+    {
+      dest = source->NewInstance();
+      dest->SetName(source->GetName());
+      dest->SetNumberOfComponents(source->GetNumberOfComponents());
+      dest->SetNumberOfTuples(this->Brick->GetNumberOfPoints());
+      for (int cc = 0; cc < dest->GetNumberOfComponents(); cc++)
+      {
+        dest->FillComponent(cc, 0.0);
+      }
+      this->Brick->GetPointData()->SetScalars(dest);
+      dest->FastDelete();
+    }
+
+    int in_extent[6], brick_extent[6], range[6];
+    input->GetExtent(in_extent);
+    this->Brick->GetExtent(brick_extent);
+    const int stride = this->BrickStride;
+    for (int cc = 0; cc < 3; cc++)
+    {
+      const int first = in_extent[2 * cc] - this->WholeExtent[2 * cc];
+      const int last = in_extent[2 * cc + 1] - this->WholeExtent[2 * cc];
+      range[2 * cc] = std::max(brick_extent[2 * cc], (first + stride - 1) / stride);
+      range[2 * cc + 1] = std::min(brick_extent[2 * cc + 1], last / stride);
+    }
+
+    int ijk[3], in_ijk[3];
+    for (ijk[2] = range[4]; ijk[2] <= range[5]; ijk[2]++)
+    {
+      in_ijk[2] = this->WholeExtent[4] + ijk[2] * stride;
+      for (ijk[1] = range[2]; ijk[1] <= range[3]; ijk[1]++)
+      {
+        in_ijk[1] = this->WholeExtent[2] + ijk[1] * stride;
+        for (ijk[0] = range[0]; ijk[0] <= range[1]; ijk[0]++)
+        {
+          in_ijk[0] = this->WholeExtent[0] + ijk[0] * stride;
+          dest->SetTuple(vtkStructuredData::ComputePointIdForExtent(brick_extent, ijk),
+            vtkStructuredData::ComputePointIdForExtent(in_extent, in_ijk), source);
+        }
+      }
+    }
+    dest->Modified();
+  }
+
+  //---------------------------------------------------------------------------
+  void InitializeVolume(const double bounds[6], const int samples[3])
+  {
+    int dims[3];
+    double spacing[3];
+    vtkComputeVolumeGeometry(bounds, samples, dims, spacing);
+
+    this->Volume = vtkSmartPointer<vtkImageData>::New();
+    this->Volume->SetDimensions(dims);
+    this->Volume->SetOrigin(bounds[0], bounds[2], bounds[4]);
+    this->Volume->SetSpacing(spacing);
+    this->VolumeResolution.clear();
+
+    std::copy(bounds, bounds + 6, this->RenderedVolumeGeometry);
+    std::copy(samples, samples + 3, this->RenderedVolumeGeometry + 6);
+  }
+
+  // Resamples the brick into the volume.
+  void AddToVolume(vtkImageData* brick)
+  {
+    vtkDataArray* source = brick ? brick->GetPointData()->GetScalars() : NULL;
+    if (!source || !this->Volume || brick->GetNumberOfPoints() == 0)
+    {
+      return;
+    }
+
+    const vtkIdType num_samples = this->Volume->GetNumberOfPoints();
+    vtkDataArray* dest = this->Volume->GetPointData()->GetScalars();
+    if (!dest || dest->GetDataType() != source->GetDataType() ||
+      dest->GetNumberOfComponents() != source->GetNumberOfComponents() ||
+      std::string(dest->GetName() ? dest->GetName() : "") !=
+        std::string(source->GetName() ? source->GetName() : ""))
+    {
+      dest = source->NewInstance();
+      dest->SetName(source->GetName());
+      dest->SetNumberOfComponents(source->GetNumberOfComponents());
+      dest->SetNumberOfTuples(num_samples);
+      for (int cc = 0; cc < dest->GetNumberOfComponents(); cc++)
+      {
+        dest->FillComponent(cc, 0.0);
+      }
+      this->Volume->GetPointData()->Initialize();
+      this->Volume->GetPointData()->SetScalars(dest);
+      dest->FastDelete();
+      this->VolumeResolution.assign(num_samples, VTK_DOUBLE_MAX);
+    }
+
+    double brick_bounds[6], brick_origin[3], brick_spacing[3];
+    int brick_extent[6];
+    brick->GetBounds(brick_bounds);
+    brick->GetOrigin(brick_origin);
+    brick->GetSpacing(brick_spacing);
+    brick->GetExtent(brick_extent);
+    const double resolution = std::max(std::abs(brick_spacing[0]),
+      std::max(std::abs(brick_spacing[1]), std::abs(brick_spacing[2])));
+
+    const int* dims = this->Volume->GetDimensions();
+    const double* origin = this->Volume->GetOrigin();
+    const double* spacing = this->Volume->GetSpacing();
+    int range[6];
+    for (int cc = 0; cc < 3; cc++)
+    {
+      const double first = (brick_bounds[2 * cc] - origin[cc]) / spacing[cc];
+      const double last = (brick_bounds[2 * cc + 1] - origin[cc]) / spacing[cc];
+      range[2 * cc] = std::max(0, static_cast<int>(std::ceil(first - 1e-6)));
+      range[2 * cc + 1] = std::min(dims[cc] - 1, static_cast<int>(std::floor(last + 1e-6)));
+    }
+
+    int ijk[3], brick_ijk[3];
+    for (ijk[2] = range[4]; ijk[2] <= range[5]; ijk[2]++)
+    {
+      for (ijk[1] = range[2]; ijk[1] <= range[3]; ijk[1]++)
+      {
+        for (ijk[0] = range[0]; ijk[0] <= range[1]; ijk[0]++)
+        {
+          const vtkIdType id =
+            ijk[0] + dims[0] * (ijk[1] + static_cast<vtkIdType>(dims[1]) * ijk[2]);
+          if (resolution > this->VolumeResolution[id])
+          {
+            continue;
+          }
+          for (int cc = 0; cc < 3; cc++)
+          {
+            const double x = origin[cc] + ijk[cc] * spacing[cc];
+            const int index = vtkMath::Round((x - brick_origin[cc]) / brick_spacing[cc]);
+            brick_ijk[cc] =
+              std::min(brick_extent[2 * cc + 1], std::max(brick_extent[2 * cc], index));
+          }
+          dest->SetTuple(
+            id, vtkStructuredData::ComputePointIdForExtent(brick_extent, brick_ijk), source);
+          this->VolumeResolution[id] = resolution;
+        }
+      }
+    }
+    dest->Modified();
+    this->Volume->Modified();
+  }
+
+  bool HasVolumeArray(const char* name)
+  {
+    vtkDataArray* array = this->Volume ? this->Volume->GetPointData()->GetScalars() : NULL;
+    return array && name && array->GetName() && strcmp(array->GetName(), name) == 0;
+  }
+};
+
+vtkStandardNewMacro(vtkImageStreamingVolumeRepresentation);
+//----------------------------------------------------------------------------
+vtkImageStreamingVolumeRepresentation::vtkImageStreamingVolumeRepresentation()
+{
+  this->Internals = new vtkInternals();
+  this->StreamingCapablePipeline = false;
+  this->InStreamingUpdate = false;
+
+  this->ProcessedData = vtkSmartPointer<vtkImageData>::New();
+  this->PriorityQueue = vtkSmartPointer<vtkImageStreamingPriorityQueue>::New();
+
+  this->VolumeMapper = vtkSmartPointer<vtkSmartVolumeMapper>::New();
+  this->Property = vtkSmartPointer<vtkVolumeProperty>::New();
+  this->Actor = vtkSmartPointer<vtkPVLODVolume>::New();
+  this->Actor->SetProperty(this->Property);
+  this->Actor->SetMapper(this->VolumeMapper);
+
+  this->OutlineSource = vtkSmartPointer<vtkOutlineSource>::New();
+  this->OutlineMapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+  this->OutlineMapper->SetInputConnection(this->OutlineSource->GetOutputPort());
+  this->Actor->SetLODMapper(this->OutlineMapper);
+
+  this->ResamplingMode = vtkImageStreamingVolumeRepresentation::RESAMPLE_OVER_DATA_BOUNDS;
+  this->NumberOfSamples[0] = this->NumberOfSamples[1] = this->NumberOfSamples[2] = 256;
+  this->BrickSize = 64;
+  this->BrickCacheSize = 1024;
+  this->ScreenSpaceError = 1.0;
+}
+
+//----------------------------------------------------------------------------
+vtkImageStreamingVolumeRepresentation::~vtkImageStreamingVolumeRepresentation()
+{
+  delete this->Internals;
+  this->Internals = NULL;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStreamingVolumeRepresentation::SetResamplingMode(int val)
+{
+  if (val != this->ResamplingMode && val >= RESAMPLE_OVER_DATA_BOUNDS &&
+    val <= RESAMPLE_USING_VIEW_FRUSTUM)
+  {
+    this->ResamplingMode = val;
+    this->Modified();
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStreamingVolumeRepresentation::SetNumberOfSamples(int x, int y, int z)
+{
+  if (x >= 10 && y >= 10 && z >= 10)
+  {
+    this->NumberOfSamples[0] = x;
+    this->NumberOfSamples[1] = y;
+    this->NumberOfSamples[2] = z;
+    if (!this->StreamingCapablePipeline)
+    {
+      // when streaming, StreamingUpdate() notices the change and streams the
+      // bricks again, mostly from the cache. Otherwise, resample the input again.
+      this->MarkModified();
+    }
+    else
+    {
+      this->Modified();
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStreamingVolumeRepresentation::SetBrickSize(int val)
+{
+  val = std::max(2, val);
+  if (val != this->BrickSize)
+  {
+    this->BrickSize = val;
+    this->MarkModified();
+  }
+}
+
+//----------------------------------------------------------------------------
+int vtkImageStreamingVolumeRepresentation::FillInputPortInformation(
+  int vtkNotUsed(port), vtkInformation* info)
+{
+  info->Set(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkImageData");
+  info->Set(vtkAlgorithm::INPUT_IS_OPTIONAL(), 1);
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStreamingVolumeRepresentation::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "ResamplingMode: ";
+  switch (this->ResamplingMode)
+  {
+    case RESAMPLE_OVER_DATA_BOUNDS:
+      os << "RESAMPLE_OVER_DATA_BOUNDS" << endl;
+      break;
+
+    case RESAMPLE_USING_VIEW_FRUSTUM:
+      os << "RESAMPLE_USING_VIEW_FRUSTUM" << endl;
+      break;
+
+    default:
+      os << "(invalid)" << endl;
+  }
+  os << indent << "NumberOfSamples: " << this->NumberOfSamples[0] << ", "
+     << this->NumberOfSamples[1] << ", " << this->NumberOfSamples[2] << endl;
+  os << indent << "BrickSize: " << this->BrickSize << endl;
+  os << indent << "BrickCacheSize: " << this->BrickCacheSize << endl;
+  os << indent << "ScreenSpaceError: " << this->ScreenSpaceError << endl;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStreamingVolumeRepresentation::MarkModified()
+{
+  this->Internals->ClearCache();
+  this->Superclass::MarkModified();
+}
+
+//----------------------------------------------------------------------------
+int vtkImageStreamingVolumeRepresentation::ProcessViewRequest(
+  vtkInformationRequestKey* request_type, vtkInformation* inInfo, vtkInformation* outInfo)
+{
+  if (!this->Superclass::ProcessViewRequest(request_type, inInfo, outInfo))
+  {
+    return 0;
+  }
+
+  if (request_type == vtkPVView::REQUEST_UPDATE())
+  {
+    // Provide the data being rendered: when streaming, this is an image
+    // without any arrays, only used to know the image bounds.
+    vtkPVRenderView::SetPiece(inInfo, this, this->ProcessedData);
+
+    double bounds[6];
+    this->DataBounds.GetBounds(bounds);
+    vtkPVRenderView::SetGeometryBounds(inInfo, bounds);
+
+    vtkPVRenderView::SetStreamable(inInfo, this, this->GetStreamingCapablePipeline());
+  }
+  else if (request_type == vtkPVRenderView::REQUEST_STREAMING_UPDATE())
+  {
+    if (this->GetStreamingCapablePipeline())
+    {
+      // This is a streaming update request, request next brick.
+      double view_planes[24];
+      inInfo->Get(vtkPVRenderView::VIEW_PLANES(), view_planes);
+      vtkPVRenderView* view = vtkPVRenderView::SafeDownCast(inInfo->Get(vtkPVRenderView::VIEW()));
+      if (this->StreamingUpdate(view, view_planes))
+      {
+        // since we indeed "had" a next piece to produce, give it to the view
+        // so it can deliver it to the rendering nodes.
+        vtkPVRenderView::SetNextStreamedPiece(inInfo, this, this->ProcessedPiece);
+      }
+    }
+  }
+  else if (request_type == vtkPVView::REQUEST_RENDER() ||
+    request_type == vtkPVRenderView::REQUEST_PROCESS_STREAMED_PIECE())
+  {
+    vtkInternals& internals = *this->Internals;
+    if (internals.VolumeNeedsInitialization)
+    {
+      vtkStreamingStatusMacro(<< this << ": initializing resampled volume.");
+      vtkAlgorithmOutput* producerPort = vtkPVRenderView::GetPieceProducer(inInfo, this);
+      vtkAlgorithm* producer = producerPort->GetProducer();
+      vtkImageData* image =
+        vtkImageData::SafeDownCast(producer->GetOutputDataObject(producerPort->GetIndex()));
+      double bounds[6];
+      vtkMath::UninitializeBounds(bounds);
+      if (image && image->GetNumberOfPoints() > 0)
+      {
+        image->GetBounds(bounds);
+        this->OutlineSource->SetBounds(bounds);
+      }
+      internals.InitializeVolume(bounds, this->NumberOfSamples);
+      // when not streaming, the delivered data is the resampled input.
+      internals.AddToVolume(image);
+      internals.VolumeNeedsInitialization = false;
+    }
+
+    if (request_type == vtkPVRenderView::REQUEST_PROCESS_STREAMED_PIECE())
+    {
+      vtkImageData* piece =
+        vtkImageData::SafeDownCast(vtkPVRenderView::GetCurrentStreamedPiece(inInfo, this));
+      vtkDataArray* geometry =
+        piece ? piece->GetFieldData()->GetArray(vtkVolumeGeometryArrayName) : NULL;
+      if (geometry && geometry->GetNumberOfTuples() == 1 &&
+        geometry->GetNumberOfComponents() == 9)
+      {
+        double values[9];
+        geometry->GetTuple(0, values);
+        if (!std::equal(values, values + 9, internals.RenderedVolumeGeometry))
+        {
+          // the volume was moved or resized on the data-server nodes,
+          // start over.
+          vtkStreamingStatusMacro(<< this << ": reinitializing resampled volume.");
+          int samples[3] = { static_cast<int>(values[6]), static_cast<int>(values[7]),
+            static_cast<int>(values[8]) };
+          internals.InitializeVolume(values, samples);
+        }
+        internals.AddToVolume(piece);
+      }
+    }
+    else
+    {
+      this->UpdateMapperParameters();
+    }
+  }
+
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageStreamingVolumeRepresentation::RequestInformation(
+  vtkInformation* rqst, vtkInformationVector** inputVector, vtkInformationVector* outputVector)
+{
+  // Determine if the input is streaming capable. Any image pipeline providing
+  // the WHOLE_EXTENT lets us request arbitrary sub-extents.
+  this->StreamingCapablePipeline = false;
+  if (inputVector[0]->GetNumberOfInformationObjects() == 1)
+  {
+    vtkInformation* inInfo = inputVector[0]->GetInformationObject(0);
+    vtkInternals& internals = *this->Internals;
+    if (inInfo->Has(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT()))
+    {
+      inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), internals.WholeExtent);
+      if (inInfo->Has(vtkDataObject::ORIGIN()))
+      {
+        inInfo->Get(vtkDataObject::ORIGIN(), internals.Origin);
+      }
+      if (inInfo->Has(vtkDataObject::SPACING()))
+      {
+        inInfo->Get(vtkDataObject::SPACING(), internals.Spacing);
+      }
+      this->StreamingCapablePipeline = vtkPVView::GetEnableStreaming();
+    }
+  }
+
+  vtkStreamingStatusMacro(<< this << ": streaming capable input pipeline? "
+                          << (this->StreamingCapablePipeline ? "yes" : "no"));
+  return this->Superclass::RequestInformation(rqst, inputVector, outputVector);
+}
+
+//----------------------------------------------------------------------------
+int vtkImageStreamingVolumeRepresentation::RequestUpdateExtent(
+  vtkInformation* request, vtkInformationVector** inputVector, vtkInformationVector* outputVector)
+{
+  if (!this->Superclass::RequestUpdateExtent(request, inputVector, outputVector))
+  {
+    return 0;
+  }
+
+  if (!this->InStreamingUpdate && !this->GetStreamingCapablePipeline())
+  {
+    // read the whole image, split among processes as usual.
+    return 1;
+  }
+
+  // Each process reads the brick it popped from the queue, so the extent
+  // must not be split any further. Outside of streaming updates, nothing is
+  // read.
+  const int empty_extent[6] = { 0, -1, 0, -1, 0, -1 };
+  const int* extent = this->InStreamingUpdate ? this->Internals->RequestExtent : empty_extent;
+  for (int cc = 0; cc < this->GetNumberOfInputPorts(); cc++)
+  {
+    for (int kk = 0; kk < inputVector[cc]->GetNumberOfInformationObjects(); kk++)
+    {
+      vtkInformation* info = inputVector[cc]->GetInformationObject(kk);
+      info->Set(vtkStreamingDemandDrivenPipeline::UPDATE_PIECE_NUMBER(), 0);
+      info->Set(vtkStreamingDemandDrivenPipeline::UPDATE_NUMBER_OF_PIECES(), 1);
+      info->Set(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), const_cast<int*>(extent), 6);
+    }
+  }
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageStreamingVolumeRepresentation::RequestData(
+  vtkInformation* rqst, vtkInformationVector** inputVector, vtkInformationVector* outputVector)
+{
+  vtkInternals& internals = *this->Internals;
+  const char* name = NULL;
+  vtkInformation* arrayInfo = this->GetInputArrayInformation(0);
+  if (arrayInfo && arrayInfo->Has(vtkDataObject::FIELD_NAME()))
+  {
+    name = arrayInfo->Get(vtkDataObject::FIELD_NAME());
+  }
+
+  if (this->GetInStreamingUpdate())
+  {
+    // add the slice (or brick) read to the brick being assembled.
+    if (inputVector[0]->GetNumberOfInformationObjects() == 1)
+    {
+      internals.CopySamples(vtkImageData::GetData(inputVector[0], 0), name);
+    }
+    return this->Superclass::RequestData(rqst, inputVector, outputVector);
+  }
+
+  // Since the representation reexecuted, it means that the input changed
+  // and we should initialize our streaming.
+  internals.VolumeNeedsInitialization = true;
+  std::fill(internals.VolumeGeometry, internals.VolumeGeometry + 9, 0);
+  this->VolumeBounds.Reset();
+  this->ProcessedPiece = NULL;
+  this->ProcessedData = vtkSmartPointer<vtkImageData>::New();
+  this->DataBounds.Reset();
+
+  if (inputVector[0]->GetNumberOfInformationObjects() == 1)
+  {
+    vtkImageData* input = vtkImageData::GetData(inputVector[0], 0);
+    if (this->GetStreamingCapablePipeline())
+    {
+      this->PriorityQueue->Initialize(
+        internals.WholeExtent, internals.Origin, internals.Spacing, this->BrickSize);
+
+      // an image with no arrays, only used to let the rendering nodes know of
+      // the image bounds.
+      this->ProcessedData->SetExtent(internals.WholeExtent);
+      this->ProcessedData->SetOrigin(internals.Origin);
+      this->ProcessedData->SetSpacing(internals.Spacing);
+    }
+    else
+    {
+      // resample the whole input at once, using a stride matching
+      // NumberOfSamples.
+      if (!inputVector[0]->GetInformationObject(0)->Has(
+            vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT()))
+      {
+        input->GetExtent(internals.WholeExtent);
+        input->GetOrigin(internals.Origin);
+        input->GetSpacing(internals.Spacing);
+      }
+      int stride = 1;
+      for (int cc = 0; cc < 3; cc++)
+      {
+        const int cells = internals.WholeExtent[2 * cc + 1] - internals.WholeExtent[2 * cc];
+        const int samples = this->NumberOfSamples[cc] - 1;
+        stride = std::max(stride, (cells + samples - 1) / samples);
+      }
+      internals.StartBrick(input->GetExtent(), stride);
+      internals.CopySamples(input, name);
+      this->ProcessedData = internals.Brick;
+      internals.Brick = NULL;
+    }
+
+    if (this->ProcessedData->GetNumberOfPoints() > 0)
+    {
+      double bounds[6];
+      this->ProcessedData->GetBounds(bounds);
+      this->DataBounds.SetBounds(bounds);
+    }
+  }
+
+  return this->Superclass::RequestData(rqst, inputVector, outputVector);
+}
+
+//----------------------------------------------------------------------------
+bool vtkImageStreamingVolumeRepresentation::UpdateVolumeBounds(vtkPVRenderView* view)
+{
+  double data_bounds[6];
+  this->DataBounds.GetBounds(data_bounds);
+
+  double bounds[6];
+  std::copy(data_bounds, data_bounds + 6, bounds);
+  if (this->ResamplingMode == RESAMPLE_USING_VIEW_FRUSTUM && view)
+  {
+    if (view->GetRenderWindow()->GetDesiredUpdateRate() >= 1 && this->VolumeBounds.IsValid())
+    {
+      // don't move the volume while interacting.
+      return false;
+    }
+    vtkAMRVolumeMapper::ComputeResamplerBoundsFrustumMethod(
+      view->GetActiveCamera(), view->GetRenderer(), data_bounds, bounds);
+  }
+
+  double geometry[9];
+  std::copy(bounds, bounds + 6, geometry);
+  std::copy(this->NumberOfSamples, this->NumberOfSamples + 3, geometry + 6);
+  if (std::equal(geometry, geometry + 9, this->Internals->VolumeGeometry))
+  {
+    return false;
+  }
+  std::copy(geometry, geometry + 9, this->Internals->VolumeGeometry);
+  this->VolumeBounds.SetBounds(bounds);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkImageStreamingVolumeRepresentation::StreamingUpdate(
+  vtkPVRenderView* view, const double view_planes[24])
+{
+  assert(this->InStreamingUpdate == false);
+  vtkInternals& internals = *this->Internals;
+
+  if (this->UpdateVolumeBounds(view))
+  {
+    // the rendering nodes start over with a new volume, so all bricks must be
+    // delivered again. Most should come from the cache.
+    vtkStreamingStatusMacro(<< this << ": reinitializing priority queue.");
+    this->PriorityQueue->Reinitialize();
+  }
+  if (this->PriorityQueue->IsEmpty())
+  {
+    return false;
+  }
+
+  // Don't request bricks finer than the resampled volume.
+  int dims[3];
+  double spacing[3], bounds[6];
+  this->VolumeBounds.GetBounds(bounds);
+  vtkComputeVolumeGeometry(bounds, this->NumberOfSamples, dims, spacing);
+  double ratio = VTK_DOUBLE_MAX;
+  for (int cc = 0; cc < 3; cc++)
+  {
+    if (dims[cc] > 1 && internals.Spacing[cc] != 0)
+    {
+      ratio = std::min(ratio, spacing[cc] / std::abs(internals.Spacing[cc]));
+    }
+  }
+  int max_level = this->PriorityQueue->GetNumberOfLevels() - 1;
+  for (double stride = 2; stride <= ratio && max_level > 0; stride *= 2)
+  {
+    max_level--;
+  }
+  this->PriorityQueue->SetMaximumLevel(max_level);
+  this->PriorityQueue->SetScreenSpaceError(this->ScreenSpaceError);
+  if (view)
+  {
+    this->PriorityQueue->SetViewportSize(view->GetRenderer()->GetSize());
+  }
+  this->PriorityQueue->Update(view_planes, bounds);
+  if (this->PriorityQueue->IsEmpty())
+  {
+    return false;
+  }
+
+  this->InStreamingUpdate = true;
+  this->ProcessedPiece = vtkSmartPointer<vtkImageData>::New();
+
+  unsigned int id = this->PriorityQueue->Pop();
+  int extent[6], stride;
+  if (id != VTK_UNSIGNED_INT_MAX && this->PriorityQueue->GetBrick(id, extent, stride))
+  {
+    vtkImageData* brick = internals.GetCachedBrick(id);
+    if (!brick)
+    {
+      internals.StartBrick(extent, stride);
+      const int num_requests = internals.GetNumberOfRequests();
+      for (int cc = 0; cc < num_requests; cc++)
+      {
+        internals.SetupRequest(extent, cc);
+        // not MarkModified(), which would clear the cache.
+        this->Modified();
+        this->Update();
+      }
+      brick = internals.Brick;
+      internals.AddCachedBrick(id, brick, static_cast<unsigned long>(this->BrickCacheSize) * 1024);
+    }
+    this->ProcessedPiece->ShallowCopy(brick);
+    internals.Brick = NULL;
+  }
+
+  // tag the piece with the volume it is meant for.
+  vtkNew<vtkFieldData> fieldData;
+  vtkNew<vtkDoubleArray> geometry;
+  geometry->SetName(vtkVolumeGeometryArrayName);
+  geometry->SetNumberOfComponents(9);
+  geometry->InsertNextTuple(internals.VolumeGeometry);
+  fieldData->AddArray(geometry.GetPointer());
+  this->ProcessedPiece->SetFieldData(fieldData.GetPointer());
+
+  this->InStreamingUpdate = false;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStreamingVolumeRepresentation::UpdateMapperParameters()
+{
+  const char* colorArrayName = NULL;
+  vtkInformation* info = this->GetInputArrayInformation(0);
+  if (info && info->Has(vtkDataObject::FIELD_NAME()))
+  {
+    colorArrayName = info->Get(vtkDataObject::FIELD_NAME());
+  }
+
+  // this is necessary since volume mappers don't like empty arrays: show the
+  // outline until the first brick arrives.
+  if (this->Internals->HasVolumeArray(colorArrayName))
+  {
+    this->VolumeMapper->SetInputData(this->Internals->Volume);
+    this->VolumeMapper->SelectScalarArray(colorArrayName);
+    this->VolumeMapper->SetScalarMode(VTK_SCALAR_MODE_USE_POINT_FIELD_DATA);
+    this->Actor->SetEnableLOD(0);
+  }
+  else
+  {
+    this->VolumeMapper->RemoveAllInputs();
+    this->Actor->SetEnableLOD(1);
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkImageStreamingVolumeRepresentation::AddToView(vtkView* view)
+{
+  vtkPVRenderView* rview = vtkPVRenderView::SafeDownCast(view);
+  if (rview)
+  {
+    rview->GetRenderer()->AddActor(this->Actor);
+    return this->Superclass::AddToView(rview);
+  }
+  return false;
+}
+
+//----------------------------------------------------------------------------
+bool vtkImageStreamingVolumeRepresentation::RemoveFromView(vtkView* view)
+{
+  vtkPVRenderView* rview = vtkPVRenderView::SafeDownCast(view);
+  if (rview)
+  {
+    rview->GetRenderer()->RemoveActor(this->Actor);
+    return this->Superclass::RemoveFromView(rview);
+  }
+  return false;
+}
+
+//***************************************************************************
+// Forwarded to Actor.
+
+//----------------------------------------------------------------------------
+void vtkImageStreamingVolumeRepresentation::SetOrientation(double x, double y, double z)
+{
+  this->Actor->SetOrientation(x, y, z);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStreamingVolumeRepresentation::SetOrigin(double x, double y, double z)
+{
+  this->Actor->SetOrigin(x, y, z);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStreamingVolumeRepresentation::SetPickable(int val)
+{
+  this->Actor->SetPickable(val);
+}
+//----------------------------------------------------------------------------
+void vtkImageStreamingVolumeRepresentation::SetPosition(double x, double y, double z)
+{
+  this->Actor->SetPosition(x, y, z);
+}
+//----------------------------------------------------------------------------
+void vtkImageStreamingVolumeRepresentation::SetScale(double x, double y, double z)
+{
+  this->Actor->SetScale(x, y, z);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStreamingVolumeRepresentation::SetVisibility(bool val)
+{
+  this->Actor->SetVisibility(val ? 1 : 0);
+  this->Superclass::SetVisibility(val);
+}
+
+//***************************************************************************
+// Forwarded to vtkVolumeProperty.
+//----------------------------------------------------------------------------
+void vtkImageStreamingVolumeRepresentation::SetInterpolationType(int val)
+{
+  this->Property->SetInterpolationType(val);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStreamingVolumeRepresentation::SetColor(vtkColorTransferFunction* lut)
+{
+  this->Property->SetColor(lut);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStreamingVolumeRepresentation::SetScalarOpacity(vtkPiecewiseFunction* pwf)
+{
+  this->Property->SetScalarOpacity(pwf);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStreamingVolumeRepresentation::SetScalarOpacityUnitDistance(double val)
+{
+  this->Property->SetScalarOpacityUnitDistance(val);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStreamingVolumeRepresentation::SetAmbient(double val)
+{
+  this->Property->SetAmbient(val);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStreamingVolumeRepresentation::SetDiffuse(double val)
+{
+  this->Property->SetDiffuse(val);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStreamingVolumeRepresentation::SetSpecular(double val)
+{
+  this->Property->SetSpecular(val);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStreamingVolumeRepresentation::SetSpecularPower(double val)
+{
+  this->Property->SetSpecularPower(val);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStreamingVolumeRepresentation::SetShade(bool val)
+{
+  this->Property->SetShade(val);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStreamingVolumeRepresentation::SetIndependantComponents(bool val)
+{
+  this->Property->SetIndependentComponents(val);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStreamingVolumeRepresentation::SetInputArrayToProcess(
+  int idx, int port, int connection, int fieldAssociation, const char* name)
+{
+  this->Superclass::SetInputArrayToProcess(idx, port, connection, fieldAssociation, name);
+  // bricks only carry the selected array, so stream them again.
+  this->MarkModified();
+}
+
+//***************************************************************************
+// Forwarded to vtkSmartVolumeMapper.
+//----------------------------------------------------------------------------
+void vtkImageStreamingVolumeRepresentation::SetRequestedRenderMode(int mode)
+{
+  this->VolumeMapper->SetRequestedRenderMode(mode);
+}
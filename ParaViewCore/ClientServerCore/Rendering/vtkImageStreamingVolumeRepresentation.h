@@ -0,0 +1,346 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    vtkImageStreamingVolumeRepresentation.h
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+ * @class   vtkImageStreamingVolumeRepresentation
+ * @brief   representation used for volume
+ * rendering large images by streaming bricks.
+ *
+ * vtkImageStreamingVolumeRepresentation is a representation for volume
+ * rendering vtkImageData too large to be read at once. Unlike
+ * vtkImageVolumeRepresentation, the input image is never requested as a
+ * whole. Instead, the image is split into a hierarchy of bricks (see
+ * vtkImageStreamingPriorityQueue) and, during streaming passes, bricks
+ * intersecting the view frustum are requested from the input pipeline, one at
+ * a time, by setting the UPDATE_EXTENT. Coarse bricks are assembled from
+ * single slices, subsampled in the slice plane, so that the memory needed for
+ * any brick is bounded. The resolution of the bricks requested is chosen
+ * based on the size of their samples on screen.
+ *
+ * Bricks are kept in a least-recently-used cache on the data-server nodes, up
+ * to BrickCacheSize, so that bricks needed again when the view changes are
+ * not read again.
+ *
+ * Bricks delivered to the rendering nodes are resampled into a volume of
+ * NumberOfSamples samples, finer bricks overriding coarser ones, which is
+ * rendered using vtkSmartVolumeMapper. Like vtkAMRStreamingVolumeRepresentation
+ * this volume can either cover the data bounds or be fitted to the view
+ * frustum.
+ *
+ * Only the point array selected for rendering is streamed. When streaming is
+ * not enabled (see vtkPVView::GetEnableStreaming()), the whole image is read
+ * and resampled in one go.
+ *
+ * Parallel volume rendering on the server is not supported: the bricks are
+ * resampled into a single volume that is rendered on one process. Images
+ * meant for this representation, up to 8192^3 samples, do not fit in the
+ * memory of the server anyway, so there is no full resolution volume that
+ * could be distributed. Builtin, single-server with remote rendering and
+ * parallel-server with local rendering configurations are supported.
+*/
+
+#ifndef vtkImageStreamingVolumeRepresentation_h
+#define vtkImageStreamingVolumeRepresentation_h
+
+#include "vtkBoundingBox.h" // needed for vtkBoundingBox.
+#include "vtkPVDataRepresentation.h"
+#include "vtkSmartPointer.h" // needed for vtkSmartPointer.
+
+class vtkColorTransferFunction;
+class vtkImageData;
+class vtkImageStreamingPriorityQueue;
+class vtkOutlineSource;
+class vtkPiecewiseFunction;
+class vtkPolyDataMapper;
+class vtkPVLODVolume;
+class vtkPVRenderView;
+class vtkSmartVolumeMapper;
+class vtkVolumeProperty;
+
+class VTKPVCLIENTSERVERCORERENDERING_EXPORT vtkImageStreamingVolumeRepresentation
+  : public vtkPVDataRepresentation
+{
+public:
+  static vtkImageStreamingVolumeRepresentation* New();
+  vtkTypeMacro(vtkImageStreamingVolumeRepresentation, vtkPVDataRepresentation);
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  enum ResamplingModes
+  {
+    RESAMPLE_OVER_DATA_BOUNDS = 0,
+    RESAMPLE_USING_VIEW_FRUSTUM = 1
+  };
+
+  //@{
+  /**
+   * This control the logic used to determine how to place the resampling grid
+   * within the image bounds.
+   * \li RESAMPLE_OVER_DATA_BOUNDS implies that the volume is
+   * set to the data bounds and is not updated as the user interacts.
+   * \li RESAMPLE_USING_VIEW_FRUSTUM indicates that the volume must be
+   * repositioned when the camera changes using the current view frustum.
+   * Bricks are then streamed again, mostly from the brick cache.
+   */
+  void SetResamplingMode(int val);
+  vtkGetMacro(ResamplingMode, int);
+  //@}
+
+  /**
+   * vtkAlgorithm::ProcessRequest() equivalent for rendering passes. This is
+   * typically called by the vtkView to request meta-data from the
+   * representations or ask them to perform certain tasks e.g.
+   * PrepareForRendering.
+   */
+  int ProcessViewRequest(vtkInformationRequestKey* request_type, vtkInformation* inInfo,
+    vtkInformation* outInfo) VTK_OVERRIDE;
+
+  /**
+   * Overridden to clear the brick cache, since the input may have changed.
+   */
+  void MarkModified() VTK_OVERRIDE;
+
+  /**
+   * Get/Set the visibility for this representation. When the visibility of
+   * representation of false, all view passes are ignored.
+   */
+  void SetVisibility(bool val) VTK_OVERRIDE;
+
+  /**
+   * Get/Set the resample buffer size. This controls the resolution at which the
+   * data is resampled for rendering.
+   */
+  void SetNumberOfSamples(int x, int y, int z);
+
+  /**
+   * Set the maximum number of samples along each axis of a brick. Default is
+   * 64.
+   */
+  void SetBrickSize(int val);
+  vtkGetMacro(BrickSize, int);
+
+  //@{
+  /**
+   * Set the size of the brick cache on each data-server process, in
+   * megabytes. Default is 1024.
+   */
+  vtkSetClampMacro(BrickCacheSize, int, 0, VTK_INT_MAX);
+  vtkGetMacro(BrickCacheSize, int);
+  //@}
+
+  //@{
+  /**
+   * Number of pixels a brick sample may cover on screen before finer bricks
+   * are requested. Default is 1.
+   */
+  vtkSetClampMacro(ScreenSpaceError, double, 0.01, VTK_DOUBLE_MAX);
+  vtkGetMacro(ScreenSpaceError, double);
+  //@}
+
+  //@{
+  /**
+   * Set the input data arrays that this algorithm will process.
+   * Overridden to restart streaming since only the selected array is streamed.
+   */
+  void SetInputArrayToProcess(
+    int idx, int port, int connection, int fieldAssociation, const char* name) VTK_OVERRIDE;
+  void SetInputArrayToProcess(
+    int idx, int port, int connection, int fieldAssociation, int fieldAttributeType) VTK_OVERRIDE
+  {
+    this->Superclass::SetInputArrayToProcess(
+      idx, port, connection, fieldAssociation, fieldAttributeType);
+  }
+  void SetInputArrayToProcess(int idx, vtkInformation* info) VTK_OVERRIDE
+  {
+    this->Superclass::SetInputArrayToProcess(idx, info);
+  }
+  void SetInputArrayToProcess(int idx, int port, int connection, const char* fieldAssociation,
+    const char* attributeTypeorName) VTK_OVERRIDE
+  {
+    this->Superclass::SetInputArrayToProcess(
+      idx, port, connection, fieldAssociation, attributeTypeorName);
+  }
+  //@}
+
+  //***************************************************************************
+  // Forwarded to Actor.
+  void SetOrientation(double, double, double);
+  void SetOrigin(double, double, double);
+  void SetPickable(int val);
+  void SetPosition(double, double, double);
+  void SetScale(double, double, double);
+
+  //***************************************************************************
+  // Forwarded to vtkVolumeProperty.
+  void SetInterpolationType(int val);
+  void SetColor(vtkColorTransferFunction* lut);
+  void SetScalarOpacity(vtkPiecewiseFunction* pwf);
+  void SetScalarOpacityUnitDistance(double val);
+  void SetAmbient(double);
+  void SetDiffuse(double);
+  void SetSpecular(double);
+  void SetSpecularPower(double);
+  void SetShade(bool);
+  void SetIndependantComponents(bool);
+
+  //***************************************************************************
+  // Forwarded to vtkSmartVolumeMapper.
+  void SetRequestedRenderMode(int);
+
+protected:
+  vtkImageStreamingVolumeRepresentation();
+  ~vtkImageStreamingVolumeRepresentation() override;
+
+  /**
+   * Adds the representation to the view.  This is called from
+   * vtkView::AddRepresentation().  Subclasses should override this method.
+   * Returns true if the addition succeeds.
+   */
+  bool AddToView(vtkView* view) VTK_OVERRIDE;
+
+  /**
+   * Removes the representation to the view.  This is called from
+   * vtkView::RemoveRepresentation().  Subclasses should override this method.
+   * Returns true if the removal succeeds.
+   */
+  bool RemoveFromView(vtkView* view) VTK_OVERRIDE;
+
+  /**
+   * Fill input port information.
+   */
+  int FillInputPortInformation(int port, vtkInformation* info) VTK_OVERRIDE;
+
+  /**
+   * Overridden to check if the input pipeline is streaming capable i.e.
+   * streaming is enabled and the input provides the image meta-data.
+   */
+  int RequestInformation(vtkInformation* request, vtkInformationVector** inputVector,
+    vtkInformationVector* outputVector) VTK_OVERRIDE;
+
+  /**
+   * Setup the extent request. During StreamingUpdate, this requests the
+   * extent of the slice or brick being read, otherwise an empty extent is
+   * requested when the pipeline is streaming capable.
+   */
+  int RequestUpdateExtent(vtkInformation* request, vtkInformationVector** inputVector,
+    vtkInformationVector* outputVector) VTK_OVERRIDE;
+
+  /**
+   * Process the current input for volume rendering (if anything).
+   * When not in StreamingUpdate, this also initializes the priority queue since
+   * the input image may have totally changed.
+   */
+  int RequestData(vtkInformation*, vtkInformationVector**, vtkInformationVector*) VTK_OVERRIDE;
+
+  //@{
+  /**
+   * Returns true when the input pipeline supports streaming. It is set in
+   * RequestInformation().
+   */
+  vtkGetMacro(StreamingCapablePipeline, bool);
+  //@}
+
+  //@{
+  /**
+   * Returns true when StreamingUpdate() is being processed.
+   */
+  vtkGetMacro(InStreamingUpdate, bool);
+  //@}
+
+  /**
+   * Returns true if this representation has a "next piece" that it streamed.
+   * This method will update the PriorityQueue using the view planes specified
+   * and then read the next brick, from the brick cache if possible.
+   */
+  bool StreamingUpdate(vtkPVRenderView* view, const double view_planes[24]);
+
+  /**
+   * Computes the bounds of the resampled volume for the view, based on the
+   * ResamplingMode. Returns true if they changed.
+   */
+  bool UpdateVolumeBounds(vtkPVRenderView* view);
+
+  /**
+   * Passes on parameters to the volume mapper.
+   */
+  void UpdateMapperParameters();
+
+  /**
+   * This is the data object generated processed by the most recent call to
+   * RequestData() while not streaming: an image without arrays describing the
+   * input image when streaming, the resampled input otherwise.
+   */
+  vtkSmartPointer<vtkImageData> ProcessedData;
+
+  /**
+   * This is the brick generated by the most recent call to StreamingUpdate().
+   * This is non-empty only on the data-server nodes.
+   */
+  vtkSmartPointer<vtkImageData> ProcessedPiece;
+
+  /**
+   * vtkImageStreamingPriorityQueue is a helper class we used to compute the
+   * order in which to request bricks from the input pipeline.
+   */
+  vtkSmartPointer<vtkImageStreamingPriorityQueue> PriorityQueue;
+
+  //@{
+  /**
+   * Rendering components.
+   */
+  vtkSmartPointer<vtkSmartVolumeMapper> VolumeMapper;
+  vtkSmartPointer<vtkVolumeProperty> Property;
+  vtkSmartPointer<vtkPVLODVolume> Actor;
+  vtkSmartPointer<vtkOutlineSource> OutlineSource;
+  vtkSmartPointer<vtkPolyDataMapper> OutlineMapper;
+  //@}
+
+  /**
+   * Used to keep track of data bounds.
+   */
+  vtkBoundingBox DataBounds;
+
+  /**
+   * Bounds of the resampled volume.
+   */
+  vtkBoundingBox VolumeBounds;
+
+  int ResamplingMode;
+  int NumberOfSamples[3];
+  int BrickSize;
+  int BrickCacheSize;
+  double ScreenSpaceError;
+
+private:
+  vtkImageStreamingVolumeRepresentation(const vtkImageStreamingVolumeRepresentation&) = delete;
+  void operator=(const vtkImageStreamingVolumeRepresentation&) = delete;
+
+  /**
+   * This flag is set to true if the input pipeline is streaming capable in
+   * RequestInformation(). Note that in client-server mode, this is valid only
+   * on the data-server nodes since all other nodes don't have input pipelines
+   * connected, they cannot indicate if the pipeline supports streaming.
+   */
+  bool StreamingCapablePipeline;
+
+  /**
+   * This flag is used to indicate that the representation is being updated
+   * during the streaming pass.
+   */
+  bool InStreamingUpdate;
+
+  class vtkInternals;
+  vtkInternals* Internals;
+};
+
+#endif
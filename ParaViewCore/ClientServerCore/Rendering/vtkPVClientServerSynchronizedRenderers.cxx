@@ -20,6 +20,7 @@
 #include "vtkObjectFactory.h"
 #include "vtkOpenGLRenderer.h"
 #include "vtkPVConfig.h"
+#include "vtkSmartPointer.h"
 #include "vtkSquirtCompressor.h"
 #include "vtkUnsignedCharArray.h"
 #include "vtkZlibImageCompressor.h"
@@ -27,8 +28,84 @@
 #include "vtkNvPipeCompressor.h"
 #endif
 
+#include <algorithm>
 #include <assert.h>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
 #include <sstream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+// Image header sent ahead of each image: valid, width, height, number of
+// components, number of active pixel spans (0 when the full image is sent) and
+// number of pipelined chunks (0 when sent in one piece).
+const int HeaderSize = 6;
+
+// Approximate size of the chunks used for pipelined delivery.
+const vtkIdType PipelineChunkSize = 256 * 1024;
+const int MaximumNumberOfPipelineChunks = 16;
+
+// Hands chunks over from one thread to another, in order.
+class ChunkQueue
+{
+public:
+  void Push(vtkUnsignedCharArray* chunk)
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->Chunks.push_back(chunk);
+    this->Condition.notify_one();
+  }
+
+  vtkSmartPointer<vtkUnsignedCharArray> Pop()
+  {
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    this->Condition.wait(lock, [this]() { return !this->Chunks.empty(); });
+    vtkSmartPointer<vtkUnsignedCharArray> chunk = this->Chunks.front();
+    this->Chunks.pop_front();
+    return chunk;
+  }
+
+private:
+  std::mutex Mutex;
+  std::condition_variable Condition;
+  std::deque<vtkSmartPointer<vtkUnsignedCharArray> > Chunks;
+};
+
+// Range of tuples in chunk `index` out of `num_chunks`.
+void GetChunkRange(
+  vtkIdType num_tuples, int num_chunks, int index, vtkIdType& first, vtkIdType& count)
+{
+  const vtkIdType size = (num_tuples + num_chunks - 1) / num_chunks;
+  first = std::min(num_tuples, index * size);
+  count = std::min(num_tuples - first, size);
+}
+
+inline bool IsActive(const unsigned char* pixel, int numComps)
+{
+  for (int cc = 0; cc < numComps; ++cc)
+  {
+    if (pixel[cc] != 0)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+int GetNumberOfActivePixels(const std::vector<int>& spans)
+{
+  int count = 0;
+  for (size_t cc = 1; cc < spans.size(); cc += 2)
+  {
+    count += spans[cc];
+  }
+  return count;
+}
+}
 
 vtkStandardNewMacro(vtkPVClientServerSynchronizedRenderers);
 vtkCxxSetObjectMacro(vtkPVClientServerSynchronizedRenderers, Compressor, vtkImageCompressor);
@@ -37,6 +114,8 @@ vtkPVClientServerSynchronizedRenderers::vtkPVClientServerSynchronizedRenderers()
   : Compressor(NULL)
   , LossLessCompression(true)
   , NVPipeSupport(false)
+  , UseActivePixelEncoding(true)
+  , UsePipelinedDelivery(false)
 {
   this->ConfigureCompressor("vtkLZ4Compressor 0 3");
 }
@@ -56,27 +135,127 @@ void vtkPVClientServerSynchronizedRenderers::MasterEndRender()
 
   vtkRawImage& rawImage = (this->ImageReductionFactor == 1) ? this->FullImage : this->ReducedImage;
 
-  int header[4];
-  this->ParallelController->Receive(header, 4, 1, 0x023430);
+  int header[HeaderSize];
+  this->ParallelController->Receive(header, HeaderSize, 1, 0x023430);
   if (header[0] > 0)
   {
     rawImage.Resize(header[1], header[2], header[3]);
-    if (this->Compressor)
+
+    // When active pixel spans are sent, the pixels received are only the
+    // active ones, which are scattered back in the image afterwards.
+    const int numSpans = header[4];
+    std::vector<int> spans(2 * numSpans);
+    vtkUnsignedCharArray* pixels = rawImage.GetRawPtr();
+    int resolution[2] = { header[1], header[2] };
+    if (numSpans > 0)
+    {
+      this->ParallelController->Receive(&spans[0], 2 * numSpans, 1, 0x023430);
+      pixels = this->ActivePixels.Get();
+      pixels->SetNumberOfComponents(header[3]);
+      pixels->SetNumberOfTuples(GetNumberOfActivePixels(spans));
+      resolution[0] = static_cast<int>(pixels->GetNumberOfTuples());
+      resolution[1] = 1;
+    }
+
+    if (this->Compressor && header[5] > 1)
+    {
+      this->ReceivePipelined(pixels, header[5]);
+    }
+    else if (this->Compressor)
     {
       vtkUnsignedCharArray* data = vtkUnsignedCharArray::New();
       this->ParallelController->Receive(data, 1, 0x023430);
-      this->Compressor->SetImageResolution(header[1], header[2]);
-      this->Decompress(data, rawImage.GetRawPtr());
+      this->Compressor->SetImageResolution(resolution[0], resolution[1]);
+      this->Decompress(data, pixels);
       data->Delete();
     }
     else
     {
-      this->ParallelController->Receive(rawImage.GetRawPtr(), 1, 0x023430);
+      this->ParallelController->Receive(pixels, 1, 0x023430);
+    }
+
+    if (numSpans > 0)
+    {
+      this->DecodeActivePixels(pixels, spans, rawImage.GetRawPtr());
     }
     rawImage.MarkValid();
   }
 }
 
+//----------------------------------------------------------------------------
+bool vtkPVClientServerSynchronizedRenderers::EncodeActivePixels(
+  vtkUnsignedCharArray* image, std::vector<int>& spans, vtkUnsignedCharArray* active)
+{
+  const int numComps = image->GetNumberOfComponents();
+  const vtkIdType numPixels = image->GetNumberOfTuples();
+  const unsigned char* data = image->GetPointer(0);
+  const vtkIdType fullSize = numPixels * numComps;
+  if (fullSize == 0)
+  {
+    return false;
+  }
+
+  spans.clear();
+  vtkIdType activeSize = 0;
+  for (vtkIdType cc = 0; cc < numPixels;)
+  {
+    // skip inactive pixels.
+    while (cc < numPixels && !IsActive(data + cc * numComps, numComps))
+    {
+      ++cc;
+    }
+    const vtkIdType first = cc;
+    while (cc < numPixels && IsActive(data + cc * numComps, numComps))
+    {
+      ++cc;
+    }
+    if (cc > first)
+    {
+      spans.push_back(static_cast<int>(first));
+      spans.push_back(static_cast<int>(cc - first));
+      activeSize += (cc - first) * numComps;
+      if (activeSize + static_cast<vtkIdType>(spans.size() * sizeof(int)) >= fullSize)
+      {
+        return false;
+      }
+    }
+  }
+  if (spans.empty())
+  {
+    // keep at least one span so that an empty image is still encoded.
+    spans.push_back(0);
+    spans.push_back(1);
+    activeSize = numComps;
+  }
+
+  active->SetNumberOfComponents(numComps);
+  active->SetNumberOfTuples(activeSize / numComps);
+  unsigned char* out = active->GetPointer(0);
+  for (size_t cc = 0; cc < spans.size(); cc += 2)
+  {
+    const size_t length = static_cast<size_t>(spans[cc + 1]) * numComps;
+    memcpy(out, data + static_cast<vtkIdType>(spans[cc]) * numComps, length);
+    out += length;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkPVClientServerSynchronizedRenderers::DecodeActivePixels(
+  vtkUnsignedCharArray* active, const std::vector<int>& spans, vtkUnsignedCharArray* image)
+{
+  const int numComps = image->GetNumberOfComponents();
+  unsigned char* data = image->GetPointer(0);
+  memset(data, 0, image->GetNumberOfTuples() * numComps);
+  const unsigned char* in = active->GetPointer(0);
+  for (size_t cc = 0; cc < spans.size(); cc += 2)
+  {
+    const size_t length = static_cast<size_t>(spans[cc + 1]) * numComps;
+    memcpy(data + static_cast<vtkIdType>(spans[cc]) * numComps, in, length);
+    in += length;
+  }
+}
+
 //----------------------------------------------------------------------------
 void vtkPVClientServerSynchronizedRenderers::SlaveStartRender()
 {
@@ -103,29 +282,168 @@ void vtkPVClientServerSynchronizedRenderers::SlaveEndRender()
 
   vtkRawImage& rawImage = this->CaptureRenderedImage();
 
-  int header[4];
+  int header[HeaderSize];
   header[0] = rawImage.IsValid() ? 1 : 0;
   header[1] = rawImage.GetWidth();
   header[2] = rawImage.GetHeight();
   header[3] = rawImage.IsValid() ? rawImage.GetRawPtr()->GetNumberOfComponents() : 0;
+  header[4] = 0;
+  header[5] = 0;
+
+  // Send only the active pixels when that is smaller than the image. NvPipe
+  // encodes video frames and needs the full image.
+  const bool nvpipe = this->Compressor && this->Compressor->IsA("vtkNvPipeCompressor");
+  std::vector<int> spans;
+  vtkUnsignedCharArray* pixels = rawImage.IsValid() ? rawImage.GetRawPtr() : NULL;
+  int resolution[2] = { header[1], header[2] };
+  if (pixels && this->UseActivePixelEncoding && !nvpipe &&
+    this->EncodeActivePixels(pixels, spans, this->ActivePixels.Get()))
+  {
+    header[4] = static_cast<int>(spans.size() / 2);
+    pixels = this->ActivePixels.Get();
+    resolution[0] = static_cast<int>(pixels->GetNumberOfTuples());
+    resolution[1] = 1;
+  }
+  if (pixels && this->UsePipelinedDelivery && this->Compressor && !nvpipe)
+  {
+    const vtkIdType size = pixels->GetNumberOfTuples() * pixels->GetNumberOfComponents();
+    const vtkIdType chunks =
+      std::min<vtkIdType>(size / PipelineChunkSize, MaximumNumberOfPipelineChunks);
+    header[5] = chunks > 1 ? static_cast<int>(chunks) : 0;
+  }
 
   // send the image to the client.
-  this->ParallelController->Send(header, 4, 1, 0x023430);
+  this->ParallelController->Send(header, HeaderSize, 1, 0x023430);
 
-  if (rawImage.IsValid())
+  if (pixels)
   {
-    if (this->Compressor)
+    if (header[4] > 0)
+    {
+      this->ParallelController->Send(&spans[0], 2 * header[4], 1, 0x023430);
+    }
+    if (header[5] > 1)
     {
-      this->Compressor->SetImageResolution(header[1], header[2]);
-      this->ParallelController->Send(this->Compress(rawImage.GetRawPtr()), 1, 0x023430);
+      this->SendPipelined(pixels, header[5]);
+    }
+    else if (this->Compressor)
+    {
+      this->Compressor->SetImageResolution(resolution[0], resolution[1]);
+      this->ParallelController->Send(this->Compress(pixels), 1, 0x023430);
     }
     else
     {
-      this->ParallelController->Send(rawImage.GetRawPtr(), 1, 0x023430);
+      this->ParallelController->Send(pixels, 1, 0x023430);
     }
   }
 }
 
+//----------------------------------------------------------------------------
+void vtkPVClientServerSynchronizedRenderers::SendPipelined(
+  vtkUnsignedCharArray* pixels, int num_chunks)
+{
+  // The socket is only used by the sending thread until it is joined, and the
+  // compressor only by this thread.
+  // Errors of the sending thread are reported here once it is joined.
+  ChunkQueue queue;
+  vtkMultiProcessController* controller = this->ParallelController;
+  bool sent = true;
+  std::thread sender([&queue, &sent, controller, num_chunks]() {
+    for (int cc = 0; cc < num_chunks; ++cc)
+    {
+      vtkSmartPointer<vtkUnsignedCharArray> chunk = queue.Pop();
+      if (sent && !controller->Send(chunk.GetPointer(), 1, 0x023430))
+      {
+        sent = false;
+      }
+    }
+  });
+
+  const int numComps = pixels->GetNumberOfComponents();
+  for (int cc = 0; cc < num_chunks; ++cc)
+  {
+    vtkIdType first, count;
+    GetChunkRange(pixels->GetNumberOfTuples(), num_chunks, cc, first, count);
+
+    vtkNew<vtkUnsignedCharArray> input;
+    input->SetNumberOfComponents(numComps);
+    input->SetArray(pixels->GetPointer(first * numComps), count * numComps, /*save=*/1);
+
+    this->Compressor->SetImageResolution(static_cast<int>(count), 1);
+    vtkNew<vtkUnsignedCharArray> compressed;
+    compressed->DeepCopy(this->Compress(input.GetPointer()));
+    queue.Push(compressed.GetPointer());
+  }
+  sender.join();
+  if (!sent)
+  {
+    vtkErrorMacro("Failed to send the image to the client.");
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkPVClientServerSynchronizedRenderers::ReceivePipelined(
+  vtkUnsignedCharArray* pixels, int num_chunks)
+{
+  // The compressor is only used by the decompressing thread until it is
+  // joined, and the socket only by this thread. The decompressing thread does
+  // not report errors itself: they are reported here once it is joined.
+  ChunkQueue queue;
+  vtkImageCompressor* compressor = this->Compressor;
+  const bool lossLess = this->LossLessCompression;
+  bool decompressed = true;
+  std::thread decompressor([&queue, &decompressed, compressor, lossLess, pixels, num_chunks]() {
+    const int numComps = pixels->GetNumberOfComponents();
+    vtkNew<vtkUnsignedCharArray> output;
+    for (int cc = 0; cc < num_chunks; ++cc)
+    {
+      vtkSmartPointer<vtkUnsignedCharArray> chunk = queue.Pop();
+      if (!chunk || chunk->GetNumberOfTuples() == 0)
+      {
+        // not received.
+        decompressed = false;
+        continue;
+      }
+      vtkIdType first, count;
+      GetChunkRange(pixels->GetNumberOfTuples(), num_chunks, cc, first, count);
+      output->SetNumberOfComponents(numComps);
+      output->SetNumberOfTuples(count);
+      compressor->SetImageResolution(static_cast<int>(count), 1);
+      compressor->SetLossLessMode(lossLess);
+      compressor->SetInput(chunk);
+      compressor->SetOutput(output.GetPointer());
+      if (compressor->Decompress() == 0)
+      {
+        decompressed = false;
+        continue;
+      }
+      memcpy(pixels->GetPointer(first * numComps), output->GetPointer(0),
+        std::min(output->GetNumberOfTuples(), count) * numComps);
+    }
+  });
+
+  bool received = true;
+  for (int cc = 0; cc < num_chunks; ++cc)
+  {
+    vtkSmartPointer<vtkUnsignedCharArray> chunk = vtkSmartPointer<vtkUnsignedCharArray>::New();
+    if (!this->ParallelController->Receive(chunk.GetPointer(), 1, 0x023430))
+    {
+      // the decompressing thread still expects num_chunks chunks.
+      received = false;
+      chunk = NULL;
+    }
+    queue.Push(chunk);
+  }
+  decompressor.join();
+  if (!received)
+  {
+    vtkErrorMacro("Failed to receive the image from the server.");
+  }
+  else if (!decompressed)
+  {
+    vtkErrorMacro("Image de-compression failed!");
+  }
+}
+
 //----------------------------------------------------------------------------
 vtkUnsignedCharArray* vtkPVClientServerSynchronizedRenderers::Compress(vtkUnsignedCharArray* data)
 {
@@ -255,4 +573,6 @@ void vtkPVClientServerSynchronizedRenderers::PushImageToScreen()
 void vtkPVClientServerSynchronizedRenderers::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "UseActivePixelEncoding: " << this->UseActivePixelEncoding << endl;
+  os << indent << "UsePipelinedDelivery: " << this->UsePipelinedDelivery << endl;
 }
@@ -24,11 +24,14 @@
 #ifndef vtkPVClientServerSynchronizedRenderers_h
 #define vtkPVClientServerSynchronizedRenderers_h
 
+#include "vtkNew.h"                                // needed for vtkNew
 #include "vtkPVClientServerCoreRenderingModule.h" //needed for exports
 #include "vtkSynchronizedRenderers.h"
+#include "vtkUnsignedCharArray.h" // needed for vtkNew<vtkUnsignedCharArray>
+
+#include <vector> // needed for std::vector
 
 class vtkImageCompressor;
-class vtkUnsignedCharArray;
 
 class VTKPVCLIENTSERVERCORERENDERING_EXPORT vtkPVClientServerSynchronizedRenderers
   : public vtkSynchronizedRenderers
@@ -52,6 +55,33 @@ public:
   vtkSetMacro(NVPipeSupport, bool);
   vtkGetMacro(NVPipeSupport, bool);
 
+  //@{
+  /**
+   * When set, images that are mostly background are sent as active pixels
+   * only: the spans of non-background pixels, followed by the pixels in those
+   * spans, which are compressed with the configured compressor. The client
+   * decodes them back into the full image. The encoding is only used when it
+   * is smaller than the full image, and not with vtkNvPipeCompressor, which
+   * needs actual images. Set on the server. Default is on.
+   */
+  vtkSetMacro(UseActivePixelEncoding, bool);
+  vtkGetMacro(UseActivePixelEncoding, bool);
+  vtkBooleanMacro(UseActivePixelEncoding, bool);
+  //@}
+
+  //@{
+  /**
+   * When set, large images are split in chunks that are compressed and sent
+   * in a pipeline: the server compresses a chunk while the previous one is
+   * being sent, and the client decompresses a chunk while the next one is
+   * being received. Only used with a compressor other than
+   * vtkNvPipeCompressor. Set on the server. Default is off.
+   */
+  vtkSetMacro(UsePipelinedDelivery, bool);
+  vtkGetMacro(UsePipelinedDelivery, bool);
+  vtkBooleanMacro(UsePipelinedDelivery, bool);
+  //@}
+
   /**
    * Set and configure a compressor from it's own configuration stream. This
    * is used by ParaView to configure the compressor from application wide
@@ -81,6 +111,32 @@ protected:
   vtkUnsignedCharArray* Compress(vtkUnsignedCharArray*);
   void Decompress(vtkUnsignedCharArray* input, vtkUnsignedCharArray* outputBuffer);
 
+  /**
+   * Finds the spans of active pixels, i.e. pixels with at least one non-zero
+   * component, and packs them in `active`. Servers render on a black, fully
+   * transparent background, so inactive pixels are all zeros. `spans` holds
+   * (first pixel, number of pixels) pairs. Returns false if the active pixels
+   * and spans would not be smaller than the full image.
+   */
+  static bool EncodeActivePixels(
+    vtkUnsignedCharArray* image, std::vector<int>& spans, vtkUnsignedCharArray* active);
+
+  /**
+   * Scatters the active pixels encoded by EncodeActivePixels back in `image`,
+   * which must have the size and number of components of the encoded image.
+   */
+  static void DecodeActivePixels(
+    vtkUnsignedCharArray* active, const std::vector<int>& spans, vtkUnsignedCharArray* image);
+
+  //@{
+  /**
+   * Compress and send, or receive and decompress, `pixels` as `num_chunks`
+   * chunks, overlapping compression and communication.
+   */
+  void SendPipelined(vtkUnsignedCharArray* pixels, int num_chunks);
+  void ReceivePipelined(vtkUnsignedCharArray* pixels, int num_chunks);
+  //@}
+
   void MasterEndRender() VTK_OVERRIDE;
   void SlaveStartRender() VTK_OVERRIDE;
   void SlaveEndRender() VTK_OVERRIDE;
@@ -88,6 +144,9 @@ protected:
   vtkImageCompressor* Compressor;
   bool LossLessCompression;
   bool NVPipeSupport;
+  bool UseActivePixelEncoding;
+  bool UsePipelinedDelivery;
+  vtkNew<vtkUnsignedCharArray> ActivePixels;
 
 private:
   vtkPVClientServerSynchronizedRenderers(const vtkPVClientServerSynchronizedRenderers&) = delete;
@@ -652,7 +652,14 @@ void vtkPVDataDeliveryManager::RedistributeDataForOrderedCompositing(bool use_lo
     // need to re-generate the kd-tree.
     this->RedistributionTimeStamp.Modified();
 
-    vtkNew<vtkKdTreeManager> cutsGenerator;
+    // The manager keeps the KdTree untouched if its previous decomposition
+    // still fits the data, in which case only changed data is redistributed.
+    if (!this->KdTreeManager)
+    {
+      this->KdTreeManager = vtkSmartPointer<vtkKdTreeManager>::New();
+    }
+    vtkKdTreeManager* cutsGenerator = this->KdTreeManager;
+    cutsGenerator->RemoveStructuredDataInformation();
     vtkInternals::ItemsMapType::iterator iter;
     for (iter = this->Internals->ItemsMap.begin(); iter != this->Internals->ItemsMap.end(); ++iter)
     {
@@ -674,6 +681,7 @@ void vtkPVDataDeliveryManager::RedistributeDataForOrderedCompositing(bool use_lo
       }
     }
     cutsGenerator->GenerateKdTree();
+    cutsGenerator->RemoveAllDataObjects();
     this->KdTree = cutsGenerator->GetKdTree();
     vtkTimerLog::MarkEndEvent("Regenerate Kd-Tree");
   }
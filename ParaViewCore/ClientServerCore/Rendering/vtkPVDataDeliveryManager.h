@@ -35,6 +35,7 @@
 class vtkAlgorithmOutput;
 class vtkDataObject;
 class vtkExtentTranslator;
+class vtkKdTreeManager;
 class vtkPKdTree;
 class vtkPVDataRepresentation;
 class vtkPVRenderView;
@@ -235,6 +236,9 @@ protected:
   vtkWeakPointer<vtkPVRenderView> RenderView;
   vtkSmartPointer<vtkPKdTree> KdTree;
 
+  // Kept across updates so that the previous decomposition can be reused.
+  vtkSmartPointer<vtkKdTreeManager> KdTreeManager;
+
   vtkTimeStamp RedistributionTimeStamp;
 
 private:
@@ -108,7 +108,9 @@
 #include "vtkOSPRayRendererNode.h"
 #endif
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <map>
 #include <set>
 #include <sstream>
@@ -310,6 +312,7 @@ vtkStandardNewMacro(vtkPVRenderView);
 vtkInformationKeyMacro(vtkPVRenderView, USE_LOD, Integer);
 vtkInformationKeyMacro(vtkPVRenderView, USE_OUTLINE_FOR_LOD, Integer);
 vtkInformationKeyMacro(vtkPVRenderView, LOD_RESOLUTION, Double);
+vtkInformationKeyMacro(vtkPVRenderView, LOD_BUDGET, Double);
 vtkInformationKeyMacro(vtkPVRenderView, NEED_ORDERED_COMPOSITING, Integer);
 vtkInformationKeyMacro(vtkPVRenderView, RENDER_EMPTY_IMAGES, Integer);
 vtkInformationKeyMacro(vtkPVRenderView, REQUEST_STREAMING_UPDATE, Request);
@@ -356,10 +359,16 @@ vtkPVRenderView::vtkPVRenderView()
   this->PreviousSwapBuffers = 0;
   this->StillRenderImageReductionFactor = 1;
   this->InteractiveRenderImageReductionFactor = 2;
+  this->TargetInteractiveFrameRate = 0.0;
+  this->AdaptiveImageReductionFactor = 0.0;
+  this->IceTStrategy = 0;
+  this->IceTSingleImageStrategy = 0;
   this->RemoteRenderingThreshold = 0;
   this->LODRenderingThreshold = 0;
   this->LODResolution = 0.5;
   this->UseOutlineForLODRendering = false;
+  this->LODFrameBudget = 0.0;
+  this->LastStillRenderTime = 0.0;
   this->UseLightKit = false;
   this->Interactor = 0;
   this->InteractorStyle = 0;
@@ -1310,6 +1319,20 @@ void vtkPVRenderView::UpdateLOD()
   {
     this->RequestInformation->Set(USE_OUTLINE_FOR_LOD(), 1);
   }
+  double budget = this->LODFrameBudget;
+  if (budget == 0 && this->TargetInteractiveFrameRate > 0)
+  {
+    budget = 1.0 / this->TargetInteractiveFrameRate;
+  }
+  // The still render time differs between processes. Use the slowest one so
+  // that all processes pick the same LOD level, otherwise the geometry
+  // delivered to the processes would not match.
+  double stillRenderTime = this->LastStillRenderTime;
+  this->SynchronizedWindows->Reduce(stillRenderTime, vtkPVSynchronizedRenderWindows::MAX_OP);
+  if (budget > 0 && stillRenderTime > 0)
+  {
+    this->RequestInformation->Set(LOD_BUDGET(), budget / stillRenderTime);
+  }
 
   // reset flags that representations set in REQUEST_UPDATE_LOD() pass.
   this->DistributedRenderingRequiredLOD = false;
@@ -1344,7 +1367,11 @@ void vtkPVRenderView::StillRender()
 
   this->Internals->PreRender(this->RenderView);
 
+  // Time the still render. It is used to estimate how much of the full
+  // resolution geometry can be rendered within the LODFrameBudget.
+  double start = vtkTimerLog::GetUniversalTime();
   this->Render(false, false);
+  this->LastStillRenderTime = vtkTimerLog::GetUniversalTime() - start;
 
   vtkTimerLog::MarkEndEvent("Still Render");
 }
@@ -1358,11 +1385,67 @@ void vtkPVRenderView::InteractiveRender()
   this->Internals->OSPRayCount = 0;
   this->Internals->PreRender(this->RenderView);
 
+  double start = vtkTimerLog::GetUniversalTime();
   this->Render(true, false);
+  this->UpdateAdaptiveImageReductionFactor(vtkTimerLog::GetUniversalTime() - start);
 
   vtkTimerLog::MarkEndEvent("Interactive Render");
 }
 
+//----------------------------------------------------------------------------
+void vtkPVRenderView::SetTargetInteractiveFrameRate(double rate)
+{
+  rate = std::max(rate, 0.0);
+  if (this->TargetInteractiveFrameRate != rate)
+  {
+    this->TargetInteractiveFrameRate = rate;
+    // Start over from InteractiveRenderImageReductionFactor.
+    this->AdaptiveImageReductionFactor = 0.0;
+    this->Modified();
+  }
+}
+
+//----------------------------------------------------------------------------
+int vtkPVRenderView::GetEffectiveInteractiveRenderImageReductionFactor()
+{
+  if (this->TargetInteractiveFrameRate > 0 && this->AdaptiveImageReductionFactor >= 1.0)
+  {
+    return static_cast<int>(this->AdaptiveImageReductionFactor + 0.5);
+  }
+  return this->InteractiveRenderImageReductionFactor;
+}
+
+//----------------------------------------------------------------------------
+void vtkPVRenderView::UpdateAdaptiveImageReductionFactor(double frame_time)
+{
+  if (this->TargetInteractiveFrameRate <= 0 || frame_time <= 0)
+  {
+    return;
+  }
+
+  // Images are only reduced by the server and batch processes (see
+  // vtkPVSynchronizedRenderer::SetImageReductionFactor). The client only pushes
+  // TargetInteractiveFrameRate and InteractiveRenderImageReductionFactor to the
+  // server, its own frame time must not drive the factor.
+  const int mode = this->SynchronizedWindows->GetMode();
+  if (mode != vtkPVSynchronizedRenderWindows::RENDER_SERVER &&
+    mode != vtkPVSynchronizedRenderWindows::BATCH)
+  {
+    return;
+  }
+
+  double factor = this->AdaptiveImageReductionFactor >= 1.0
+    ? this->AdaptiveImageReductionFactor
+    : this->InteractiveRenderImageReductionFactor;
+
+  // The cost of compositing and delivering an image is roughly proportional to
+  // its number of pixels, i.e. to 1/factor^2. Move half way towards the factor
+  // that would have hit the target to avoid oscillating between factors.
+  double ideal = factor * std::sqrt(frame_time * this->TargetInteractiveFrameRate);
+  factor = vtkMath::ClampValue(0.5 * (factor + ideal), 1.0, 20.0);
+  this->AdaptiveImageReductionFactor = factor;
+}
+
 //----------------------------------------------------------------------------
 void vtkPVRenderView::Render(bool interactive, bool skip_rendering)
 {
@@ -1455,6 +1538,8 @@ void vtkPVRenderView::Render(bool interactive, bool skip_rendering)
 
   // enable render empty images if it was requested
   this->SynchronizedRenderers->SetRenderEmptyImages(this->GetRenderEmptyImages());
+  this->SynchronizedRenderers->SetIceTStrategies(
+    this->IceTStrategy, this->IceTSingleImageStrategy);
 
   // Render each representation with available geometry.
   // This is the pass where representations get an opportunity to get the
@@ -1464,7 +1549,7 @@ void vtkPVRenderView::Render(bool interactive, bool skip_rendering)
 
   // set the image reduction factor.
   this->SynchronizedRenderers->SetImageReductionFactor(
-    (interactive ? this->InteractiveRenderImageReductionFactor
+    (interactive ? this->GetEffectiveInteractiveRenderImageReductionFactor()
                  : this->StillRenderImageReductionFactor));
 
   this->UsedLODForLastRender = use_lod_rendering;
@@ -1516,6 +1601,11 @@ void vtkPVRenderView::Render(bool interactive, bool skip_rendering)
     stream << "Mode: " << (interactive ? "interactive" : "still") << "\n"
            << "Level-of-detail: " << (use_lod_rendering ? "yes" : "no") << "\n"
            << "Remote/parallel rendering: " << (use_distributed_rendering ? "yes" : "no") << "\n";
+    if (interactive && this->TargetInteractiveFrameRate > 0)
+    {
+      stream << "Image reduction factor: "
+             << this->GetEffectiveInteractiveRenderImageReductionFactor() << "\n";
+    }
     this->Annotation->SetText(stream.str().c_str());
   }
 
@@ -2209,6 +2299,8 @@ void vtkPVRenderView::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
   os << indent << "UseLightKit: " << this->UseLightKit << endl;
+  os << indent << "LODFrameBudget: " << this->LODFrameBudget << endl;
+  os << indent << "TargetInteractiveFrameRate: " << this->TargetInteractiveFrameRate << endl;
 }
 
 //----------------------------------------------------------------------------
@@ -2217,6 +2309,12 @@ void vtkPVRenderView::ConfigureCompressor(const char* configuration)
   this->SynchronizedRenderers->ConfigureCompressor(configuration);
 }
 
+//----------------------------------------------------------------------------
+void vtkPVRenderView::SetPipelinedImageDelivery(bool val)
+{
+  this->SynchronizedRenderers->SetPipelinedImageDelivery(val);
+}
+
 //----------------------------------------------------------------------------
 void vtkPVRenderView::InvalidateCachedSelection()
 {
@@ -226,6 +226,52 @@ public:
   vtkGetMacro(InteractiveRenderImageReductionFactor, int);
   //@}
 
+  //@{
+  /**
+   * Get/Set the frame rate, in frames per second, to maintain during
+   * InteractiveRender(). When non-zero, the image reduction factor used for
+   * interactive renders is adjusted after each of them, based on its measured
+   * duration. InteractiveRenderImageReductionFactor is used as the initial
+   * value. Like InteractiveRenderImageReductionFactor, the value set on the
+   * client is pushed to the server, and the factor is adapted where images are
+   * reduced: on the render server in client-server mode, where the root's
+   * frame time includes rendering, compositing, compressing and sending the
+   * image to the client, and in batch mode. Satellites follow the root's factor.
+   * The client and builtin sessions do not reduce images, so the factor is not
+   * adapted there and GetEffectiveInteractiveRenderImageReductionFactor()
+   * returns InteractiveRenderImageReductionFactor.
+   * StillRender() always uses StillRenderImageReductionFactor. When
+   * LODFrameBudget is 0, the frame time is also used as the LOD frame budget.
+   * 0 (default) disables this.
+   * \note CallOnAllProcesses
+   */
+  void SetTargetInteractiveFrameRate(double);
+  vtkGetMacro(TargetInteractiveFrameRate, double);
+  //@}
+
+  //@{
+  /**
+   * Get/Set the IceT strategies used for parallel compositing. Values are
+   * vtkIceTCompositePass::Strategies and
+   * vtkIceTCompositePass::SingleImageStrategies respectively. The single image
+   * strategy can be auto-tuned, in which case the fastest strategy is picked
+   * after timing each of them on the first frames.
+   * Have no effect unless IceT is used.
+   * \note CallOnAllProcesses
+   */
+  vtkSetMacro(IceTStrategy, int);
+  vtkGetMacro(IceTStrategy, int);
+  vtkSetMacro(IceTSingleImageStrategy, int);
+  vtkGetMacro(IceTSingleImageStrategy, int);
+  //@}
+
+  /**
+   * Returns the image reduction factor the next InteractiveRender() will use.
+   * This is InteractiveRenderImageReductionFactor unless
+   * TargetInteractiveFrameRate is non-zero and the local process reduces images.
+   */
+  int GetEffectiveInteractiveRenderImageReductionFactor();
+
   //@{
   /**
    * Get/Set the data-size in megabytes above which remote-rendering should be
@@ -268,6 +314,20 @@ public:
   vtkGetMacro(UseOutlineForLODRendering, bool);
   //@}
 
+  //@{
+  /**
+   * Get/Set the target time, in seconds, for interactive renders. When
+   * non-zero, representations that support it compute their LOD geometry at
+   * several resolutions and use the finest one expected to render within this
+   * time, as estimated from the duration of the last still render.
+   * LODResolution remains the upper limit for the resolution. 0 (default)
+   * disables this and only LODResolution is used.
+   * \note CallOnAllProcesses
+   */
+  vtkSetClampMacro(LODFrameBudget, double, 0.0, VTK_DOUBLE_MAX);
+  vtkGetMacro(LODFrameBudget, double);
+  //@}
+
   /**
    * Passes the compressor configuration to the client-server synchronizer, if
    * any. This affects the image compression used to relay images back to the
@@ -278,6 +338,14 @@ public:
    */
   void ConfigureCompressor(const char* configuration);
 
+  /**
+   * Enables pipelined delivery of images to the client, where compression
+   * (and decompression on the client) overlaps with the transfer of the
+   * image. See vtkPVClientServerSynchronizedRenderers::SetUsePipelinedDelivery().
+   * \note CallOnAllProcesses
+   */
+  void SetPipelinedImageDelivery(bool);
+
   /**
    * Resets the clipping range. One does not need to call this directly ever. It
    * is called periodically by the vtkRenderer to reset the camera range.
@@ -315,6 +383,17 @@ public:
    */
   static vtkInformationIntegerKey* USE_OUTLINE_FOR_LOD();
 
+  /**
+   * Indicates, in REQUEST_UPDATE_LOD() pass, the fraction of the full
+   * resolution geometry that is expected to render within the LODFrameBudget,
+   * i.e. LODFrameBudget divided by the time of the last still render on the
+   * slowest process, so that all processes agree on the level.
+   * Representations compare it to the ratio of the number of cells of the
+   * decimated and full resolution geometries.
+   * Only set when LODFrameBudget is non-zero.
+   */
+  static vtkInformationDoubleKey* LOD_BUDGET();
+
   /**
    * Representation can publish this key in their REQUEST_INFORMATION()
    * pass to indicate that the representation needs to disable
@@ -986,6 +1065,12 @@ protected:
    */
   bool ShouldUseLODRendering(double geometry);
 
+  /**
+   * Adjusts AdaptiveImageReductionFactor after an interactive render that took
+   * `frame_time` seconds, when TargetInteractiveFrameRate is non-zero.
+   */
+  void UpdateAdaptiveImageReductionFactor(double frame_time);
+
   /**
    * Returns true if the local process is invovled in rendering composited
    * geometry i.e. geometry rendered in view that is composited together.
@@ -1075,6 +1160,10 @@ protected:
 
   int StillRenderImageReductionFactor;
   int InteractiveRenderImageReductionFactor;
+  double TargetInteractiveFrameRate;
+  double AdaptiveImageReductionFactor;
+  int IceTStrategy;
+  int IceTSingleImageStrategy;
   int InteractionMode;
   bool ShowAnnotation;
   bool UpdateAnnotation;
@@ -1110,6 +1199,8 @@ protected:
   bool UsedLODForLastRender;
   bool UseLODForInteractiveRender;
   bool UseOutlineForLODRendering;
+  double LODFrameBudget;
+  double LastStillRenderTime;
   bool UseDistributedRenderingForStillRender;
   bool UseDistributedRenderingForInteractiveRender;
 
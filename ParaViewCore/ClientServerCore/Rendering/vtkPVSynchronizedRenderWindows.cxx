@@ -1608,6 +1608,13 @@ bool vtkPVSynchronizedRenderWindows::Reduce(
   return this->ReduceTemplate<vtkIdType>(value, operation);
 }
 
+//----------------------------------------------------------------------------
+bool vtkPVSynchronizedRenderWindows::Reduce(
+  double& value, vtkPVSynchronizedRenderWindows::StandardOperations operation)
+{
+  return this->ReduceTemplate<double>(value, operation);
+}
+
 //----------------------------------------------------------------------------
 bool vtkPVSynchronizedRenderWindows::SynchronizeBounds(double bounds[6])
 {
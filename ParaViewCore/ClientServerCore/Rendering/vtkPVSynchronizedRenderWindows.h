@@ -152,6 +152,7 @@ public:
     SUM_OP = vtkCommunicator::SUM_OP
   };
   bool Reduce(vtkIdType& value, StandardOperations operation);
+  bool Reduce(double& value, StandardOperations operation);
 
   //@{
   /**
@@ -262,6 +262,21 @@ void vtkPVSynchronizedRenderer::SetLossLessCompression(bool val)
   }
 }
 
+//----------------------------------------------------------------------------
+void vtkPVSynchronizedRenderer::SetPipelinedImageDelivery(bool val)
+{
+  vtkPVClientServerSynchronizedRenderers* cssync =
+    vtkPVClientServerSynchronizedRenderers::SafeDownCast(this->CSSynchronizer);
+  if (cssync)
+  {
+    cssync->SetUsePipelinedDelivery(val);
+  }
+  else
+  {
+    vtkDebugMacro("Not in client-server mode.");
+  }
+}
+
 //----------------------------------------------------------------------------
 void vtkPVSynchronizedRenderer::ConfigureCompressor(const char* configuration)
 {
@@ -338,6 +353,28 @@ void vtkPVSynchronizedRenderer::SetRenderEmptyImages(bool useREI)
 #endif
 }
 
+//----------------------------------------------------------------------------
+void vtkPVSynchronizedRenderer::SetIceTStrategies(int strategy, int single_image_strategy)
+{
+  if (this->ParallelSynchronizer == 0)
+  {
+    return;
+  }
+#if defined PARAVIEW_USE_ICE_T && defined PARAVIEW_USE_MPI
+  vtkIceTSynchronizedRenderers* sync =
+    vtkIceTSynchronizedRenderers::SafeDownCast(this->ParallelSynchronizer);
+  if (sync)
+  {
+    sync->SetStrategy(strategy);
+    sync->SetSingleImageStrategy(single_image_strategy);
+  }
+#else
+  // unused warning when MPI is off.
+  static_cast<void>(strategy);
+  static_cast<void>(single_image_strategy);
+#endif
+}
+
 //----------------------------------------------------------------------------
 void vtkPVSynchronizedRenderer::SetNVPipeSupport(bool enable)
 {
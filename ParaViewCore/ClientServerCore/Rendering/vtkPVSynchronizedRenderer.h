@@ -130,6 +130,7 @@ public:
    */
   void ConfigureCompressor(const char* configuration);
   void SetLossLessCompression(bool);
+  void SetPipelinedImageDelivery(bool);
   //@}
 
   /**
@@ -142,6 +143,13 @@ public:
    */
   void SetRenderEmptyImages(bool);
 
+  /**
+   * Set the IceT compositing strategies, if IceT is being used.
+   * See vtkIceTCompositePass::SetStrategy() and
+   * vtkIceTCompositePass::SetSingleImageStrategy().
+   */
+  void SetIceTStrategies(int strategy, int single_image_strategy);
+
   /**
    * Enable/Disable NVPipe
    */
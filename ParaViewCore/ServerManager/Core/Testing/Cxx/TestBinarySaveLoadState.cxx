@@ -0,0 +1,174 @@
+/*=========================================================================
+
+Program:   ParaView
+Module:    TestBinarySaveLoadState.cxx
+
+Copyright (c) Kitware, Inc.
+All rights reserved.
+See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+This software is distributed WITHOUT ANY WARRANTY; without even
+the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkInitializationHelper.h"
+#include "vtkNew.h"
+#include "vtkPVDataInformation.h"
+#include "vtkProcessModule.h"
+#include "vtkSMBinaryStateLoader.h"
+#include "vtkSMParaViewPipelineController.h"
+#include "vtkSMPropertyHelper.h"
+#include "vtkSMProxyDefinitionManager.h"
+#include "vtkSMSession.h"
+#include "vtkSMSessionProxyManager.h"
+#include "vtkSMSourceProxy.h"
+#include "vtkSMStateLocator.h"
+#include "vtkSmartPointer.h"
+#include "vtkTestUtilities.h"
+
+#include <string>
+
+// A source with a sub-proxy, to check that sub-proxy states are restored.
+const char* testdefinition =
+  "<ServerManagerConfiguration>"
+  "   <ProxyGroup name=\"sources\">"
+  "     <SourceProxy name=\"SphereWithTransform\" class=\"vtkSphereSource\">"
+  "       <SubProxy>"
+  "         <Proxy name=\"Transform\" proxygroup=\"extended_sources\" "
+  "proxyname=\"Transform3\" />"
+  "       </SubProxy>"
+  "     </SourceProxy>"
+  "   </ProxyGroup>"
+  "</ServerManagerConfiguration>";
+
+int TestBinarySaveLoadState(int argc, char* argv[])
+{
+  vtkInitializationHelper::Initialize(argv[0], vtkProcessModule::PROCESS_CLIENT);
+
+  vtkNew<vtkSMParaViewPipelineController> controller;
+
+  // Create a new session.
+  vtkSMSession* session = vtkSMSession::New();
+  vtkSMSessionProxyManager* pxm = session->GetSessionProxyManager();
+  if (!controller->InitializeSession(session))
+  {
+    return EXIT_FAILURE;
+  }
+  pxm->GetProxyDefinitionManager()->LoadConfigurationXMLFromString(testdefinition);
+
+  vtkSmartPointer<vtkSMProxy> sphere;
+  sphere.TakeReference(pxm->NewProxy("sources", "SphereSource"));
+  controller->InitializeProxy(sphere);
+  vtkSMPropertyHelper(sphere, "PhiResolution").Set(20);
+  vtkSMPropertyHelper(sphere, "ThetaResolution").Set(24);
+  sphere->UpdateVTKObjects();
+  controller->RegisterPipelineProxy(sphere, "sphere");
+
+  vtkSmartPointer<vtkSMSourceProxy> shrink;
+  shrink.TakeReference(vtkSMSourceProxy::SafeDownCast(pxm->NewProxy("filters", "ShrinkFilter")));
+  controller->PreInitializeProxy(shrink);
+  vtkSMPropertyHelper(shrink, "Input").Set(sphere);
+  vtkSMPropertyHelper(shrink, "ShrinkFactor").Set(0.25);
+  controller->PostInitializeProxy(shrink);
+  shrink->UpdateVTKObjects();
+  controller->RegisterPipelineProxy(shrink, "shrink");
+  shrink->UpdatePipeline();
+  const vtkIdType numberOfCells = shrink->GetDataInformation()->GetNumberOfCells();
+
+  const double position[3] = { 1, 2, 3 };
+  vtkSmartPointer<vtkSMProxy> custom;
+  custom.TakeReference(pxm->NewProxy("sources", "SphereWithTransform"));
+  controller->InitializeProxy(custom);
+  vtkSMPropertyHelper(custom->GetSubProxy("Transform"), "Position").Set(position, 3);
+  custom->UpdateVTKObjects();
+  controller->RegisterPipelineProxy(custom, "custom");
+
+  char* tempDir =
+    vtkTestUtilities::GetArgOrEnvOrDefault("-T", argc, argv, "VTK_TEMP_DIR", "Testing/Temporary");
+  if (!tempDir)
+  {
+    cerr << "Could not determine temporary directory.\n";
+    return EXIT_FAILURE;
+  }
+  std::string path = tempDir;
+  path += "/TestBinarySaveLoadState.pvsb";
+  delete[] tempDir;
+
+  if (!pxm->SaveBinaryState(path.c_str()) ||
+    !vtkSMBinaryStateLoader::IsBinaryStateFile(path.c_str()))
+  {
+    cerr << "Failed to save binary state!" << endl;
+    return EXIT_FAILURE;
+  }
+
+  controller->UnRegisterProxy(custom);
+  controller->UnRegisterProxy(shrink);
+  controller->UnRegisterProxy(sphere);
+  custom = NULL;
+  shrink = NULL;
+  sphere = NULL;
+  if (pxm->GetProxy("sources", "sphere") || pxm->GetProxy("sources", "shrink"))
+  {
+    cerr << "Cleanup has failed!" << endl;
+    return EXIT_FAILURE;
+  }
+
+  if (!pxm->LoadBinaryState(path.c_str()))
+  {
+    cerr << "Failed to load binary state!" << endl;
+    return EXIT_FAILURE;
+  }
+
+  sphere = pxm->GetProxy("sources", "sphere");
+  shrink = vtkSMSourceProxy::SafeDownCast(pxm->GetProxy("sources", "shrink"));
+  custom = pxm->GetProxy("sources", "custom");
+  if (!sphere || !shrink || !custom)
+  {
+    cerr << "Failed to load proxies from state file!" << endl;
+    return EXIT_FAILURE;
+  }
+  if (vtkSMPropertyHelper(sphere, "PhiResolution").GetAsInt() != 20 ||
+    vtkSMPropertyHelper(sphere, "ThetaResolution").GetAsInt() != 24 ||
+    vtkSMPropertyHelper(shrink, "ShrinkFactor").GetAsDouble() != 0.25 ||
+    vtkSMPropertyHelper(shrink, "Input").GetAsProxy() != sphere)
+  {
+    cerr << "Property values were not restored!" << endl;
+    return EXIT_FAILURE;
+  }
+  shrink->UpdatePipeline();
+  if (shrink->GetDataInformation()->GetNumberOfCells() != numberOfCells)
+  {
+    cerr << "Loaded pipeline produces " << shrink->GetDataInformation()->GetNumberOfCells()
+         << " cells, expected " << numberOfCells << endl;
+    return EXIT_FAILURE;
+  }
+
+  vtkSMProxy* transform = custom->GetSubProxy("Transform");
+  double loadedPosition[3];
+  vtkSMPropertyHelper(transform, "Position").Get(loadedPosition, 3);
+  if (loadedPosition[0] != position[0] || loadedPosition[1] != position[1] ||
+    loadedPosition[2] != position[2])
+  {
+    cerr << "Sub-proxy state was not restored!" << endl;
+    return EXIT_FAILURE;
+  }
+
+  // The loaded states must not be left behind in the session state locator.
+  vtkSMStateLocator* locator = session->GetStateLocator();
+  if (locator->IsStateLocal(sphere->GetGlobalID()) ||
+    locator->IsStateLocal(shrink->GetGlobalID()) ||
+    locator->IsStateLocal(custom->GetGlobalID()) ||
+    locator->IsStateLocal(transform->GetGlobalID()))
+  {
+    cerr << "Binary state was registered in the session state locator!" << endl;
+    return EXIT_FAILURE;
+  }
+
+  sphere = NULL;
+  shrink = NULL;
+  custom = NULL;
+  session->Delete();
+  vtkInitializationHelper::Finalize();
+  return EXIT_SUCCESS;
+}
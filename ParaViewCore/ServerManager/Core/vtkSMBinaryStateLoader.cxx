@@ -0,0 +1,615 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    vtkSMBinaryStateLoader.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkSMBinaryStateLoader.h"
+
+#include "vtkObjectFactory.h"
+#include "vtkSMMessage.h"
+#include "vtkSMPTools.h"
+#include "vtkSMProxy.h"
+#include "vtkSMProxyLocator.h"
+#include "vtkSMProxyManager.h"
+#include "vtkSMSession.h"
+#include "vtkSMSessionProxyManager.h"
+#include "vtkSMSourceProxy.h"
+#include "vtkSMStateLocator.h"
+#include "vtkSmartPointer.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+// File layout (all integers are unsigned 32-bit little-endian):
+//   "PVBS" | schema version | ParaView major | minor | patch | message count
+//   followed, for each message, by its size in bytes and its serialized bytes.
+// Message 0 is the PXMRegistrationState, the others are proxy states.
+const char vtkSMBinaryStateMagic[4] = { 'P', 'V', 'B', 'S' };
+const size_t vtkSMBinaryStateHeaderSize = 24;
+
+void WriteUInt32(ostream& os, vtkTypeUInt32 value)
+{
+  unsigned char bytes[4];
+  for (int cc = 0; cc < 4; ++cc)
+  {
+    bytes[cc] = static_cast<unsigned char>((value >> (8 * cc)) & 0xff);
+  }
+  os.write(reinterpret_cast<const char*>(bytes), 4);
+}
+
+vtkTypeUInt32 ReadUInt32(const char* buffer)
+{
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(buffer);
+  return static_cast<vtkTypeUInt32>(bytes[0]) | (static_cast<vtkTypeUInt32>(bytes[1]) << 8) |
+    (static_cast<vtkTypeUInt32>(bytes[2]) << 16) | (static_cast<vtkTypeUInt32>(bytes[3]) << 24);
+}
+
+typedef std::map<vtkTypeUInt32, vtkTypeUInt32> IdMapType;
+
+vtkTypeUInt32 RemapId(const IdMapType& idMap, vtkTypeUInt64 id)
+{
+  IdMapType::const_iterator iter = idMap.find(static_cast<vtkTypeUInt32>(id));
+  // ids that are not part of the state refer to proxies that already exist in
+  // the session (e.g. settings), keep them as is.
+  return iter != idMap.end() ? iter->second : static_cast<vtkTypeUInt32>(id);
+}
+
+// Replaces the "<id>" found in registration names such as
+// "pq_helper_proxies.<id>" or "Separate_<id>_<array>".
+void RemapIdInName(const IdMapType& idMap, std::string& name, size_t start, size_t end)
+{
+  if (end <= start)
+  {
+    return;
+  }
+  std::string idStr = name.substr(start, end - start);
+  vtkTypeUInt32 id = static_cast<vtkTypeUInt32>(std::atoi(idStr.c_str()));
+  std::ostringstream newId;
+  newId << RemapId(idMap, id);
+  name.replace(start, end - start, newId.str());
+}
+
+// Decode the messages in parallel. Each item only touches its own message.
+class vtkDecodeFunctor
+{
+public:
+  const char* Buffer;
+  const std::vector<size_t>* Offsets;
+  const std::vector<vtkTypeUInt32>* Sizes;
+  std::vector<vtkSMMessage>* Messages;
+  std::vector<char>* Status;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType cc = begin; cc < end; ++cc)
+    {
+      (*this->Status)[cc] = (*this->Messages)[cc].ParseFromArray(
+        this->Buffer + (*this->Offsets)[cc], static_cast<int>((*this->Sizes)[cc]));
+    }
+  }
+};
+
+// Remap the global ids referenced by the proxy states in parallel. The id map
+// is only read here.
+class vtkRemapFunctor
+{
+public:
+  const IdMapType* IdMap;
+  std::vector<vtkSMMessage>* Messages;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    const IdMapType& idMap = *this->IdMap;
+    for (vtkIdType cc = std::max<vtkIdType>(begin, 1); cc < end; ++cc)
+    {
+      vtkSMMessage& msg = (*this->Messages)[cc];
+      msg.set_global_id(RemapId(idMap, msg.global_id()));
+
+      int nbSubProxy = msg.ExtensionSize(ProxyState::subproxy);
+      for (int i = 0; i < nbSubProxy; ++i)
+      {
+        ProxyState_SubProxy* subProxy = msg.MutableExtension(ProxyState::subproxy, i);
+        subProxy->set_global_id(RemapId(idMap, subProxy->global_id()));
+      }
+
+      int nbProperties = msg.ExtensionSize(ProxyState::property);
+      for (int i = 0; i < nbProperties; ++i)
+      {
+        ProxyState_Property* prop = msg.MutableExtension(ProxyState::property, i);
+        if (!prop->has_value())
+        {
+          continue;
+        }
+        Variant* value = prop->mutable_value();
+        for (int j = 0; j < value->proxy_global_id_size(); ++j)
+        {
+          value->set_proxy_global_id(j, RemapId(idMap, value->proxy_global_id(j)));
+        }
+      }
+    }
+  }
+};
+
+// vtkSMProxy::LoadState() assigns the ids of the sub-proxies but only looks
+// for their states in the session state locator, which the binary state is
+// not added to. Load them from the loader's locator instead.
+void vtkLoadSubProxyStates(vtkSMProxy* proxy, const vtkSMMessage& msg,
+  vtkSMStateLocator* stateLocator, vtkSMProxyLocator* locator)
+{
+  for (int i = 0; i < msg.ExtensionSize(ProxyState::subproxy); ++i)
+  {
+    const ProxyState_SubProxy& subProxyMsg = msg.GetExtension(ProxyState::subproxy, i);
+    vtkSMProxy* subProxy = proxy->GetSubProxy(subProxyMsg.name().c_str());
+    vtkSMMessage subProxyState;
+    if (subProxy && subProxy->HasGlobalID() && subProxy->GetGlobalID() == subProxyMsg.global_id() &&
+      stateLocator->FindState(subProxyMsg.global_id(), &subProxyState, false))
+    {
+      subProxy->LoadState(&subProxyState, locator);
+      vtkLoadSubProxyStates(subProxy, subProxyState, stateLocator, locator);
+    }
+  }
+}
+
+struct vtkSingletonProxy
+{
+  const char* RegistrationGroup;
+  const char* XMLGroup;
+  const char* XMLName;
+};
+
+// Proxies that exist only once per session. Their state is loaded on the
+// existing instance instead of creating a new one (see
+// vtkSMStateLoader::CreateProxy).
+const vtkSingletonProxy vtkSMBinaryStateSingletons[] = {
+  { "animation", "animation", "AnimationScene" },
+  { "animation", "animation", "TimeAnimationCue" },
+  { "timekeeper", "misc", "TimeKeeper" },
+  { "materiallibrary", "materials", "MaterialLibrary" },
+  { NULL, NULL, NULL },
+};
+}
+
+//----------------------------------------------------------------------------
+class vtkSMBinaryStateLoader::vtkInternals
+{
+public:
+  std::vector<vtkSmartPointer<vtkSMProxy> > ProxyCreationOrder;
+  std::map<vtkTypeUInt32, size_t> StateIndex;
+  std::vector<vtkSMMessage> Messages;
+
+  // Map the id of a singleton proxy (and of its sub-proxies) in the file to
+  // the id of the existing proxy.
+  void MapExistingProxy(vtkTypeUInt32 fileId, const vtkSMMessage* existingState, IdMapType& idMap)
+  {
+    idMap[fileId] = static_cast<vtkTypeUInt32>(existingState->global_id());
+
+    std::map<vtkTypeUInt32, size_t>::const_iterator iter = this->StateIndex.find(fileId);
+    if (iter == this->StateIndex.end())
+    {
+      return;
+    }
+    const vtkSMMessage& fileState = this->Messages[iter->second];
+    int nbFileSubProxy = fileState.ExtensionSize(ProxyState::subproxy);
+    int nbExistingSubProxy = existingState->ExtensionSize(ProxyState::subproxy);
+    for (int i = 0; i < nbFileSubProxy; ++i)
+    {
+      const ProxyState_SubProxy& fileSub = fileState.GetExtension(ProxyState::subproxy, i);
+      for (int j = 0; j < nbExistingSubProxy; ++j)
+      {
+        const ProxyState_SubProxy& existingSub =
+          existingState->GetExtension(ProxyState::subproxy, j);
+        if (existingSub.name() == fileSub.name())
+        {
+          idMap[fileSub.global_id()] = existingSub.global_id();
+          break;
+        }
+      }
+    }
+  }
+};
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSMBinaryStateLoader);
+//----------------------------------------------------------------------------
+vtkSMBinaryStateLoader::vtkSMBinaryStateLoader()
+{
+  this->ProxyLocator = NULL;
+  this->Internals = new vtkInternals();
+}
+
+//----------------------------------------------------------------------------
+vtkSMBinaryStateLoader::~vtkSMBinaryStateLoader()
+{
+  if (this->ProxyLocator)
+  {
+    this->ProxyLocator->Delete();
+    this->ProxyLocator = NULL;
+  }
+  delete this->Internals;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSMBinaryStateLoader::IsBinaryStateFile(const char* filename)
+{
+  ifstream file(filename, ios::in | ios::binary);
+  char magic[4];
+  if (!filename || !file || !file.read(magic, 4))
+  {
+    return false;
+  }
+  return memcmp(magic, vtkSMBinaryStateMagic, 4) == 0;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSMBinaryStateLoader::WriteState(ostream& os, const std::vector<vtkSMMessage>& messages)
+{
+  os.write(vtkSMBinaryStateMagic, 4);
+  WriteUInt32(os, vtkSMBinaryStateLoader::GetSchemaVersion());
+  WriteUInt32(os, static_cast<vtkTypeUInt32>(vtkSMProxyManager::GetVersionMajor()));
+  WriteUInt32(os, static_cast<vtkTypeUInt32>(vtkSMProxyManager::GetVersionMinor()));
+  WriteUInt32(os, static_cast<vtkTypeUInt32>(vtkSMProxyManager::GetVersionPatch()));
+  WriteUInt32(os, static_cast<vtkTypeUInt32>(messages.size()));
+
+  std::string buffer;
+  for (size_t cc = 0; cc < messages.size(); ++cc)
+  {
+    buffer.clear();
+    if (!messages[cc].SerializeToString(&buffer))
+    {
+      return false;
+    }
+    WriteUInt32(os, static_cast<vtkTypeUInt32>(buffer.size()));
+    os.write(buffer.data(), buffer.size());
+  }
+  return !os.fail();
+}
+
+//----------------------------------------------------------------------------
+bool vtkSMBinaryStateLoader::LoadState(const char* filename)
+{
+  std::vector<vtkSMMessage> messages;
+  return this->ReadState(filename, messages) && this->LoadState(messages);
+}
+
+//----------------------------------------------------------------------------
+bool vtkSMBinaryStateLoader::LoadState(const char* buffer, size_t length)
+{
+  std::vector<vtkSMMessage> messages;
+  return this->ReadState(buffer, length, messages) && this->LoadState(messages);
+}
+
+//----------------------------------------------------------------------------
+bool vtkSMBinaryStateLoader::ReadState(const char* filename, std::vector<vtkSMMessage>& messages)
+{
+  ifstream file(filename, ios::in | ios::binary);
+  if (!filename || !file)
+  {
+    vtkErrorMacro("Failed to open state file: " << (filename ? filename : "(null)"));
+    return false;
+  }
+
+  file.seekg(0, ios::end);
+  std::streamoff length = file.tellg();
+  file.seekg(0, ios::beg);
+  if (length <= 0)
+  {
+    vtkErrorMacro("Empty state file: " << filename);
+    return false;
+  }
+
+  std::vector<char> buffer(static_cast<size_t>(length));
+  if (!file.read(&buffer[0], length))
+  {
+    vtkErrorMacro("Failed to read state file: " << filename);
+    return false;
+  }
+  return this->ReadState(&buffer[0], buffer.size(), messages);
+}
+
+//----------------------------------------------------------------------------
+bool vtkSMBinaryStateLoader::ReadState(
+  const char* buffer, size_t length, std::vector<vtkSMMessage>& messages)
+{
+  if (!buffer || length < vtkSMBinaryStateHeaderSize ||
+    memcmp(buffer, vtkSMBinaryStateMagic, 4) != 0)
+  {
+    vtkErrorMacro("Not a binary state file.");
+    return false;
+  }
+  if (ReadUInt32(buffer + 4) > vtkSMBinaryStateLoader::GetSchemaVersion())
+  {
+    vtkErrorMacro("State file uses schema version "
+      << ReadUInt32(buffer + 4) << " which is newer than the supported version "
+      << vtkSMBinaryStateLoader::GetSchemaVersion() << ".");
+    return false;
+  }
+  const vtkTypeUInt32 count = ReadUInt32(buffer + 20);
+  if (count == 0)
+  {
+    vtkErrorMacro("State file has no registration information.");
+    return false;
+  }
+
+  // Locate the messages. This is a cheap scan over the size prefixes.
+  std::vector<size_t> offsets(count);
+  std::vector<vtkTypeUInt32> sizes(count);
+  size_t offset = vtkSMBinaryStateHeaderSize;
+  for (vtkTypeUInt32 cc = 0; cc < count; ++cc)
+  {
+    if (offset + 4 > length)
+    {
+      vtkErrorMacro("Truncated state file.");
+      return false;
+    }
+    sizes[cc] = ReadUInt32(buffer + offset);
+    offsets[cc] = offset + 4;
+    offset += 4 + sizes[cc];
+    if (offset > length)
+    {
+      vtkErrorMacro("Truncated state file.");
+      return false;
+    }
+  }
+
+  messages.clear();
+  messages.resize(count);
+  std::vector<char> status(count, 0);
+  vtkDecodeFunctor decode;
+  decode.Buffer = buffer;
+  decode.Offsets = &offsets;
+  decode.Sizes = &sizes;
+  decode.Messages = &messages;
+  decode.Status = &status;
+  vtkSMPTools::For(0, static_cast<vtkIdType>(count), decode);
+  for (vtkTypeUInt32 cc = 0; cc < count; ++cc)
+  {
+    if (!status[cc])
+    {
+      vtkErrorMacro("Failed to decode message " << cc << " of the state file.");
+      messages.clear();
+      return false;
+    }
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSMBinaryStateLoader::LoadState(std::vector<vtkSMMessage>& messages)
+{
+  vtkSMSessionProxyManager* pxm = this->GetSessionProxyManager();
+  vtkSMSession* session = this->GetSession();
+  if (!pxm || !session)
+  {
+    vtkErrorMacro("Cannot load state without a session proxy manager.");
+    return false;
+  }
+  if (messages.empty())
+  {
+    vtkErrorMacro("State has no registration information.");
+    return false;
+  }
+
+  const vtkTypeUInt32 count = static_cast<vtkTypeUInt32>(messages.size());
+  vtkInternals& internals = *this->Internals;
+  internals.Messages.swap(messages);
+  internals.StateIndex.clear();
+  internals.ProxyCreationOrder.clear();
+
+  // Build the id map. Singleton proxies map to the existing instances, every
+  // other proxy gets an id from a freshly reserved chunk.
+  IdMapType idMap;
+  std::vector<vtkTypeUInt32> fileIds;
+  std::vector<vtkSMProxy*> existingProxies(count, static_cast<vtkSMProxy*>(NULL));
+  for (vtkTypeUInt32 cc = 1; cc < count; ++cc)
+  {
+    const vtkSMMessage& msg = internals.Messages[cc];
+    internals.StateIndex[static_cast<vtkTypeUInt32>(msg.global_id())] = cc;
+  }
+  for (vtkTypeUInt32 cc = 1; cc < count; ++cc)
+  {
+    const vtkSMMessage& msg = internals.Messages[cc];
+    const std::string& xmlgroup = msg.GetExtension(ProxyState::xml_group);
+    const std::string& xmlname = msg.GetExtension(ProxyState::xml_name);
+    for (const vtkSingletonProxy* item = vtkSMBinaryStateSingletons; item->XMLGroup; ++item)
+    {
+      if (xmlgroup == item->XMLGroup && xmlname == item->XMLName)
+      {
+        existingProxies[cc] =
+          pxm->FindProxy(item->RegistrationGroup, item->XMLGroup, item->XMLName);
+        if (existingProxies[cc])
+        {
+          existingProxies[cc]->UpdateVTKObjects();
+          internals.MapExistingProxy(static_cast<vtkTypeUInt32>(msg.global_id()),
+            existingProxies[cc]->GetFullState(), idMap);
+        }
+        break;
+      }
+    }
+  }
+  for (vtkTypeUInt32 cc = 1; cc < count; ++cc)
+  {
+    vtkTypeUInt32 id = static_cast<vtkTypeUInt32>(internals.Messages[cc].global_id());
+    if (idMap.find(id) == idMap.end())
+    {
+      fileIds.push_back(id);
+    }
+  }
+  if (!fileIds.empty())
+  {
+    vtkTypeUInt32 firstId =
+      session->GetNextChunkGlobalUniqueIdentifier(static_cast<vtkTypeUInt32>(fileIds.size()));
+    for (size_t cc = 0; cc < fileIds.size(); ++cc)
+    {
+      idMap[fileIds[cc]] = firstId + static_cast<vtkTypeUInt32>(cc);
+    }
+  }
+
+  vtkRemapFunctor remap;
+  remap.IdMap = &idMap;
+  remap.Messages = &internals.Messages;
+  vtkSMPTools::For(0, static_cast<vtkIdType>(count), remap);
+
+  // The states only live in a locator of their own for the duration of the
+  // load, so that they do not linger in the session.
+  std::set<vtkTypeUInt32> subProxyIds;
+  vtkSmartPointer<vtkSMStateLocator> stateLocator = vtkSmartPointer<vtkSMStateLocator>::New();
+  stateLocator->SetParentLocator(session->GetStateLocator());
+  for (vtkTypeUInt32 cc = 1; cc < count; ++cc)
+  {
+    const vtkSMMessage& msg = internals.Messages[cc];
+    stateLocator->RegisterState(&msg);
+    for (int i = 0; i < msg.ExtensionSize(ProxyState::subproxy); ++i)
+    {
+      subProxyIds.insert(msg.GetExtension(ProxyState::subproxy, i).global_id());
+    }
+  }
+  this->SetStateLocator(stateLocator);
+
+  if (this->ProxyLocator)
+  {
+    this->ProxyLocator->Delete();
+  }
+  this->ProxyLocator = vtkSMProxyLocator::New();
+  this->ProxyLocator->SetDeserializer(this);
+  this->ProxyLocator->SetSession(session);
+  this->ProxyLocator->UseSessionToLocateProxy(true);
+
+  // Create all proxies and load their states. Nothing is pushed yet.
+  for (vtkTypeUInt32 cc = 1; cc < count; ++cc)
+  {
+    vtkTypeUInt32 id = static_cast<vtkTypeUInt32>(internals.Messages[cc].global_id());
+    if (existingProxies[cc] == NULL && subProxyIds.find(id) == subProxyIds.end())
+    {
+      this->ProxyLocator->LocateProxy(id);
+    }
+  }
+
+  // Push all the states in dependency order.
+  for (size_t cc = 0; cc < internals.ProxyCreationOrder.size(); ++cc)
+  {
+    internals.ProxyCreationOrder[cc]->UpdateVTKObjects();
+  }
+  for (size_t cc = 0; cc < internals.ProxyCreationOrder.size(); ++cc)
+  {
+    if (vtkSMSourceProxy* source = vtkSMSourceProxy::SafeDownCast(internals.ProxyCreationOrder[cc]))
+    {
+      source->UpdatePipelineInformation();
+    }
+  }
+
+  // Register proxies in creation order.
+  const vtkSMMessage& registration = internals.Messages[0];
+  typedef std::vector<std::pair<std::string, std::string> > NamesType;
+  std::map<vtkTypeUInt32, NamesType> regInfo;
+  for (int i = 0; i < registration.ExtensionSize(PXMRegistrationState::registered_proxy); ++i)
+  {
+    const PXMRegistrationState_Entry& entry =
+      registration.GetExtension(PXMRegistrationState::registered_proxy, i);
+    std::string group = entry.group();
+    std::string name = entry.name();
+
+    static const char* helper_proxies_prefix = "pq_helper_proxies.";
+    static const size_t len = strlen(helper_proxies_prefix);
+    if (group.compare(0, len, helper_proxies_prefix) == 0)
+    {
+      RemapIdInName(idMap, group, len, group.size());
+    }
+    const std::string separatePrefix = "Separate_";
+    if ((group == "lookup_tables" || group == "piecewise_functions") &&
+      name.compare(0, separatePrefix.size(), separatePrefix) == 0)
+    {
+      RemapIdInName(
+        idMap, name, separatePrefix.size(), name.find_first_of("_", separatePrefix.size()));
+    }
+    regInfo[RemapId(idMap, entry.global_id())].push_back(std::make_pair(group, name));
+  }
+
+  for (size_t cc = 0; cc < internals.ProxyCreationOrder.size(); ++cc)
+  {
+    vtkSMProxy* proxy = internals.ProxyCreationOrder[cc];
+    const NamesType& names = regInfo[proxy->GetGlobalID()];
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+      pxm->RegisterProxy(names[i].first.c_str(), names[i].second.c_str(), proxy);
+    }
+  }
+
+  // Now that all other proxies exist and are registered, load the state of the
+  // singleton proxies (see vtkSMStateLoader::LoadStateInternal).
+  for (vtkTypeUInt32 cc = 1; cc < count; ++cc)
+  {
+    if (vtkSMProxy* proxy = existingProxies[cc])
+    {
+      proxy->LoadState(&internals.Messages[cc], this->ProxyLocator);
+      proxy->UpdateVTKObjects();
+      const NamesType& names = regInfo[proxy->GetGlobalID()];
+      for (size_t i = 0; i < names.size(); ++i)
+      {
+        pxm->RegisterProxy(names[i].first.c_str(), names[i].second.c_str(), proxy);
+      }
+    }
+  }
+
+  this->ProxyLocator->SetDeserializer(NULL);
+  this->SetStateLocator(NULL);
+  internals.ProxyCreationOrder.clear();
+  internals.StateIndex.clear();
+  internals.Messages.clear();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+vtkSMProxy* vtkSMBinaryStateLoader::NewProxy(vtkTypeUInt32 id, vtkSMProxyLocator* locator)
+{
+  vtkSMMessage msg;
+  if (!this->StateLocator || !this->StateLocator->FindState(id, &msg))
+  {
+    return NULL;
+  }
+
+  const char* group = msg.GetExtension(ProxyState::xml_group).c_str();
+  const char* type = msg.GetExtension(ProxyState::xml_name).c_str();
+  const char* subProxyName = (msg.HasExtension(ProxyState::xml_sub_proxy_name))
+    ? msg.GetExtension(ProxyState::xml_sub_proxy_name).c_str()
+    : NULL;
+
+  vtkSMProxy* proxy = this->CreateProxy(group, type, subProxyName);
+  if (!proxy)
+  {
+    vtkErrorMacro("Could not create a proxy of group: "
+      << group << " type: " << type
+      << " subProxyName: " << (subProxyName ? subProxyName : "(null)"));
+    return NULL;
+  }
+
+  // Loading the state locates (and hence creates) the proxies this one depends
+  // on, so appending after LoadState() keeps the list in dependency order.
+  proxy->LoadState(&msg, locator);
+  vtkLoadSubProxyStates(proxy, msg, this->StateLocator, locator);
+  this->Internals->ProxyCreationOrder.push_back(proxy);
+  return proxy;
+}
+
+//----------------------------------------------------------------------------
+void vtkSMBinaryStateLoader::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "ProxyLocator: " << this->ProxyLocator << endl;
+}
@@ -0,0 +1,132 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    vtkSMBinaryStateLoader.h
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+ * @class   vtkSMBinaryStateLoader
+ * @brief   Utility class to load state from the binary state format.
+ *
+ * vtkSMBinaryStateLoader loads server manager state saved with
+ * vtkSMSessionProxyManager::SaveBinaryState(). The binary state is a
+ * schema-versioned sequence of protobuf vtkSMMessage proxy states (the same
+ * messages used for undo/redo and collaboration), preceded by a
+ * PXMRegistrationState message listing the proxy registrations.
+ *
+ * Loading happens in three phases. First, all messages are decoded and the
+ * global ids they contain are remapped to freshly reserved ids; this is done
+ * in parallel using vtkSMPTools. Next, proxies are created and their states
+ * are loaded, without pushing anything to the server. Finally, all proxies are
+ * updated in dependency order in a single pass and registered with the proxy
+ * manager. The states are kept in a state locator private to the loader, the
+ * session state locator is left untouched.
+ *
+ * Links, selection models and custom proxy definitions are not part of the
+ * binary state. Use the XML state (vtkSMStateLoader) when those are needed.
+ *
+ * @sa
+ * vtkSMStateLoader vtkSMSessionProxyManager
+*/
+
+#ifndef vtkSMBinaryStateLoader_h
+#define vtkSMBinaryStateLoader_h
+
+#include "vtkPVServerManagerCoreModule.h" //needed for exports
+#include "vtkSMDeserializerProtobuf.h"
+#include "vtkSMMessageMinimal.h" // needed for vtkSMMessage
+
+#include <vector> // needed for API
+
+class vtkSMProxy;
+class vtkSMProxyLocator;
+
+class VTKPVSERVERMANAGERCORE_EXPORT vtkSMBinaryStateLoader : public vtkSMDeserializerProtobuf
+{
+public:
+  static vtkSMBinaryStateLoader* New();
+  vtkTypeMacro(vtkSMBinaryStateLoader, vtkSMDeserializerProtobuf);
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  /**
+   * Load the state from the given file. Returns false if the file could not be
+   * read, is not a binary state file or was written with a newer schema.
+   */
+  bool LoadState(const char* filename);
+
+  /**
+   * Load the state from an in-memory buffer holding the contents of a binary
+   * state file.
+   */
+  bool LoadState(const char* buffer, size_t length);
+
+  /**
+   * Returns true if the file starts with the binary state signature.
+   */
+  static bool IsBinaryStateFile(const char* filename);
+
+  /**
+   * Schema version written by this version of ParaView. Files with a greater
+   * version are rejected.
+   */
+  static unsigned int GetSchemaVersion() { return 1; }
+
+#ifndef __WRAP__
+  /**
+   * Write a binary state file. The first message must be the
+   * PXMRegistrationState, the remaining ones are the proxy states.
+   * Used by vtkSMSessionProxyManager::SaveBinaryState().
+   */
+  static bool WriteState(ostream& os, const std::vector<vtkSMMessage>& messages);
+
+  //@{
+  /**
+   * Decode the messages of a binary state file (or of a buffer holding its
+   * contents) without loading them. The messages may be modified, e.g. to
+   * change file names (see vtkSMLoadStateOptionsProxy), before being passed
+   * to LoadState(std::vector<vtkSMMessage>&).
+   */
+  bool ReadState(const char* filename, std::vector<vtkSMMessage>& messages);
+  bool ReadState(const char* buffer, size_t length, std::vector<vtkSMMessage>& messages);
+  //@}
+
+  /**
+   * Load the state from decoded messages. The messages are consumed.
+   */
+  bool LoadState(std::vector<vtkSMMessage>& messages);
+#endif
+
+  /**
+   * Get the proxy locator used during the last call to LoadState().
+   */
+  vtkGetObjectMacro(ProxyLocator, vtkSMProxyLocator);
+
+protected:
+  vtkSMBinaryStateLoader();
+  ~vtkSMBinaryStateLoader() override;
+
+  /**
+   * Overridden to defer vtkSMProxy::UpdateVTKObjects() until all proxies have
+   * been created, and to keep track of the creation order.
+   */
+  vtkSMProxy* NewProxy(vtkTypeUInt32 id, vtkSMProxyLocator* locator) VTK_OVERRIDE;
+
+  vtkSMProxyLocator* ProxyLocator;
+
+private:
+  vtkSMBinaryStateLoader(const vtkSMBinaryStateLoader&) = delete;
+  void operator=(const vtkSMBinaryStateLoader&) = delete;
+
+  class vtkInternals;
+  vtkInternals* Internals;
+};
+
+#endif
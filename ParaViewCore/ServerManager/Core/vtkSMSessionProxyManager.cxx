@@ -26,6 +26,7 @@
 #include "vtkPVXMLParser.h"
 #include "vtkProcessModule.h"
 #include "vtkReservedRemoteObjectIds.h"
+#include "vtkSMBinaryStateLoader.h"
 #include "vtkSMCollaborationManager.h"
 #include "vtkSMCoreUtilities.h"
 #include "vtkSMDeserializerProtobuf.h"
@@ -118,6 +119,36 @@ protected:
   vtkSMProxyManagerForwarder() {}
 };
 //*****************************************************************************
+namespace
+{
+// Append the full state of the proxy and of its sub-proxies to the messages
+// saved in a binary state file.
+void vtkAppendBinaryState(vtkSMSession* session, vtkSMProxy* proxy,
+  std::vector<vtkSMMessage>& messages, std::set<vtkTypeUInt32>& visited)
+{
+  if (!proxy || !proxy->GetFullState() || !visited.insert(proxy->GetGlobalID()).second)
+  {
+    return;
+  }
+
+  messages.push_back(*proxy->GetFullState());
+  vtkSMMessage& msg = messages.back();
+  msg.set_global_id(proxy->GetGlobalID());
+  msg.set_location(proxy->GetLocation());
+
+  std::vector<vtkTypeUInt32> subProxyIds;
+  for (int cc = 0; cc < msg.ExtensionSize(ProxyState::subproxy); ++cc)
+  {
+    subProxyIds.push_back(msg.GetExtension(ProxyState::subproxy, cc).global_id());
+  }
+  for (size_t cc = 0; cc < subProxyIds.size(); ++cc)
+  {
+    vtkAppendBinaryState(session,
+      vtkSMProxy::SafeDownCast(session->GetRemoteObject(subProxyIds[cc])), messages, visited);
+  }
+}
+}
+//*****************************************************************************
 //---------------------------------------------------------------------------
 vtkSMSessionProxyManager* vtkSMSessionProxyManager::New(vtkSMSession* session)
 {
@@ -1258,6 +1289,86 @@ vtkPVXMLElement* vtkSMSessionProxyManager::SaveXMLState()
   return root;
 }
 
+//---------------------------------------------------------------------------
+bool vtkSMSessionProxyManager::SaveBinaryState(const char* filename)
+{
+  // Message 0 holds the registration information, the others are the proxy
+  // states.
+  std::vector<vtkSMMessage> messages(1);
+  std::set<vtkTypeUInt32> visited;
+  vtksys::RegularExpression prototypesRe("_prototypes$");
+  vtkSMSessionProxyManagerInternals::ProxyGroupType::iterator it =
+    this->Internals->RegisteredProxyMap.begin();
+  for (; it != this->Internals->RegisteredProxyMap.end(); it++)
+  {
+    // Skip the same groups as AddInternalState().
+    const std::string& colname = it->first;
+    if (colname == "global_properties" || colname == "settings" || colname.empty() ||
+      colname[0] == '_' || prototypesRe.find(colname))
+    {
+      continue;
+    }
+
+    vtkSMProxyManagerProxyMapType::iterator it2 = it->second.begin();
+    for (; it2 != it->second.end(); it2++)
+    {
+      vtkSMProxyManagerProxyListType::iterator it3 = it2->second.begin();
+      for (; it3 != it2->second.end(); ++it3)
+      {
+        vtkSMProxy* proxy = it3->GetPointer()->Proxy.GetPointer();
+        PXMRegistrationState_Entry* entry =
+          messages[0].AddExtension(PXMRegistrationState::registered_proxy);
+        entry->set_group(colname);
+        entry->set_name(it2->first);
+        entry->set_global_id(proxy->GetGlobalID());
+        vtkAppendBinaryState(this->GetSession(), proxy, messages, visited);
+      }
+    }
+  }
+
+  ofstream os(filename, ios::out | ios::binary);
+  if (!os || !vtkSMBinaryStateLoader::WriteState(os, messages))
+  {
+    vtkErrorMacro("Failed to write state file: " << filename);
+    return false;
+  }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool vtkSMSessionProxyManager::LoadBinaryState(
+  const char* filename, vtkSMBinaryStateLoader* loader /*=NULL*/)
+{
+  bool prev = this->InLoadXMLState;
+  this->InLoadXMLState = true;
+  vtkSmartPointer<vtkSMBinaryStateLoader> spLoader = loader;
+  if (!spLoader)
+  {
+    spLoader = vtkSmartPointer<vtkSMBinaryStateLoader>::New();
+    spLoader->SetSessionProxyManager(this);
+  }
+  bool status = spLoader->LoadState(filename);
+  this->InLoadXMLState = prev;
+  return status;
+}
+
+//---------------------------------------------------------------------------
+bool vtkSMSessionProxyManager::LoadBinaryState(
+  std::vector<vtkSMMessage>& messages, vtkSMBinaryStateLoader* loader /*=NULL*/)
+{
+  bool prev = this->InLoadXMLState;
+  this->InLoadXMLState = true;
+  vtkSmartPointer<vtkSMBinaryStateLoader> spLoader = loader;
+  if (!spLoader)
+  {
+    spLoader = vtkSmartPointer<vtkSMBinaryStateLoader>::New();
+    spLoader->SetSessionProxyManager(this);
+  }
+  bool status = spLoader->LoadState(messages);
+  this->InLoadXMLState = prev;
+  return status;
+}
+
 //---------------------------------------------------------------------------
 void vtkSMSessionProxyManager::CollectReferredProxies(
   vtkSMProxyManagerProxySet& setOfProxies, vtkSMProxy* proxy)
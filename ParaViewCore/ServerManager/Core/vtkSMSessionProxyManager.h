@@ -117,9 +117,12 @@
 #include "vtkSMMessageMinimal.h"          // needed for vtkSMMessage.
 #include "vtkSMSessionObject.h"
 
+#include <vector> // needed for std::vector
+
 class vtkCollection;
 class vtkEventForwarderCommand;
 class vtkPVXMLElement;
+class vtkSMBinaryStateLoader;
 class vtkSMCompoundSourceProxy;
 class vtkSMDocumentation;
 class vtkSMLink;
@@ -435,6 +438,22 @@ public:
    */
   vtkPVXMLElement* SaveXMLState();
 
+  //@{
+  /**
+   * Save/Load the state of the server manager in the binary state format (see
+   * vtkSMBinaryStateLoader). The binary state holds the proxies and their
+   * registration, but not links, selection models or custom proxy definitions.
+   * Binary states load much faster than XML states for large pipelines.
+   * While loading, `vtkSMSessionProxyManager::GetInLoadXMLState` returns true.
+   */
+  bool SaveBinaryState(const char* filename);
+  bool LoadBinaryState(const char* filename, vtkSMBinaryStateLoader* loader = NULL);
+#ifndef __WRAP__
+  bool LoadBinaryState(
+    std::vector<vtkSMMessage>& messages, vtkSMBinaryStateLoader* loader = NULL);
+#endif
+  //@}
+
   /**
    * Save/Load registered link states.
    */
@@ -0,0 +1,57 @@
+# Saves a binary (.pvsb) state and loads it back, first as is and then with
+# its data file moved to another directory (LoadStateDataFileOptions).
+from paraview.simple import *
+from paraview import smtesting
+import os
+import shutil
+
+smtesting.ProcessCommandLineArguments()
+
+testdir = os.path.join(smtesting.TempDir, "BinaryState")
+if os.path.isdir(testdir):
+    shutil.rmtree(testdir)
+originaldir = os.path.join(testdir, "original")
+moveddir = os.path.join(testdir, "moved")
+os.makedirs(originaldir)
+os.makedirs(moveddir)
+
+datafile = os.path.join(originaldir, "sphere.vtp")
+sphere = Sphere(ThetaResolution=16, PhiResolution=12)
+SaveData(datafile, proxy=sphere)
+Delete(sphere)
+
+reader = OpenDataFile(datafile)
+shrink = Shrink(Input=reader, ShrinkFactor=0.3)
+shrink.UpdatePipeline()
+numCells = shrink.GetDataInformation().GetNumberOfCells()
+
+statefile = os.path.join(testdir, "state.pvsb")
+SaveState(statefile)
+
+def check_state(expected_filename):
+    reader = FindSource("sphere.vtp")
+    shrink = FindSource("Shrink1")
+    if not reader or not shrink:
+        raise smtesting.TestError("Proxies were not loaded from %s" % statefile)
+    filename = reader.SMProxy.GetProperty("FileName").GetElement(0)
+    if os.path.normpath(filename) != os.path.normpath(expected_filename):
+        raise smtesting.TestError("Reader file name is %s, expected %s" %
+            (filename, expected_filename))
+    if shrink.ShrinkFactor != 0.3 or shrink.Input.SMProxy != reader.SMProxy:
+        raise smtesting.TestError("Shrink filter state was not restored")
+    shrink.UpdatePipeline()
+    if shrink.GetDataInformation().GetNumberOfCells() != numCells:
+        raise smtesting.TestError("Loaded pipeline produces %d cells, expected %d" %
+            (shrink.GetDataInformation().GetNumberOfCells(), numCells))
+
+ResetSession()
+LoadState(statefile)
+check_state(datafile)
+
+# Move the data file and load the state again, searching the new directory.
+moveddatafile = os.path.join(moveddir, "sphere.vtp")
+shutil.move(datafile, moveddatafile)
+ResetSession()
+LoadState(statefile, LoadStateDataFileOptions="Search files under specified directory",
+    DataDirectory=moveddir, OnlyUseFilesInDataDirectory=1)
+check_state(moveddatafile)
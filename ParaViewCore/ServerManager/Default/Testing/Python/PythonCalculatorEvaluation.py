@@ -0,0 +1,74 @@
+# Checks that the batched and numexpr evaluations of the Python Calculator
+# give the same arrays, with the same types, as the default evaluation.
+from paraview.simple import *
+from paraview import smtesting
+from paraview import calculator
+from vtkmodules.numpy_interface import dataset_adapter as dsa
+import numpy as np
+
+smtesting.ProcessCommandLineArguments()
+
+EXPRESSIONS = [
+    "RTData * 2.5 + 1",
+    "RTData / 7",
+    "Double ** 2 - Double * RTData",
+    "sqrt(abs(Double)) * Double - 1/3",
+    "sin(Double) + cos(RTData)",
+    "IntData / 7",
+    "IntData % 7 - 3",
+    "(IntData - 50) // 3",
+    "IntData * Double",
+    ]
+
+def add_arrays(source):
+    double = PythonCalculator(Input=source, ArrayName="Double",
+        Expression="RTData.astype(np.float64) * 0.01 - 1")
+    return PythonCalculator(Input=double, ArrayName="IntData",
+        Expression="np.asarray(RTData * 10, dtype=np.int32) - 1000")
+
+def evaluate(source, expression, batched, use_numexpr):
+    calc = PythonCalculator(Input=source, Expression=expression, CopyArrays=0,
+        BatchedEvaluation=batched, UseNumExpr=use_numexpr)
+    result = dsa.WrapDataObject(servermanager.Fetch(calc)).PointData["result"]
+    Delete(calc)
+    if isinstance(result, dsa.VTKCompositeDataArray):
+        return [np.asarray(a) for a in result.Arrays]
+    return [np.asarray(result)]
+
+def same_arrays(first, second):
+    if len(first) != len(second):
+        return False
+    for a, b in zip(first, second):
+        if not calculator._same_values(a, b):
+            return False
+    return True
+
+single = add_arrays(Wavelet())
+group = GroupDatasets(Input=[add_arrays(Wavelet()),
+    add_arrays(Wavelet(WholeExtent=[-5, 5, -5, 5, -5, 5]))])
+
+for source in [single, group]:
+    for expression in EXPRESSIONS:
+        reference = evaluate(source, expression, 0, 0)
+        for batched, use_numexpr in [(1, 0), (0, 1), (1, 1)]:
+            result = evaluate(source, expression, batched, use_numexpr)
+            if not same_arrays(reference, result):
+                raise smtesting.TestError(
+                    "'%s' (BatchedEvaluation=%d, UseNumExpr=%d) differs from the default "
+                    "evaluation" % (expression, batched, use_numexpr))
+
+# When numexpr is available, make sure it is actually used for expressions it
+# evaluates the same way as numpy, and not for integer arithmetic.
+try:
+    import numexpr
+except ImportError:
+    numexpr = None
+if numexpr:
+    values = np.linspace(-1, 1, 1000)
+    ns = { "a": values, "b": values[::-1].copy(), "i": np.arange(-500, 500) }
+    result = calculator.evaluate_numexpr("a * b + 2 * a - 0.5", ns)
+    if result is None or not calculator._same_values(result, ns["a"] * ns["b"] + 2 * ns["a"] - 0.5):
+        raise smtesting.TestError("numexpr was not used or gave a different result")
+    if calculator.evaluate_numexpr("i / 3", ns) is not None or \
+        calculator.evaluate_numexpr("a % 0.3", ns) is not None:
+        raise smtesting.TestError("numexpr must not be used for integer arrays or modulo")
@@ -0,0 +1,69 @@
+# Volume renders a Wavelet with the "Streaming Volume" representation, which
+# requests the image brick by brick, and compares the image obtained once all
+# bricks are streamed with the one rendered from the whole image.
+from paraview.simple import *
+from paraview import smtesting
+from paraview.vtk.vtkPVClientServerCoreRendering import vtkPVView
+from paraview.vtk.vtkTestingRendering import vtkTesting
+import os
+
+smtesting.ProcessCommandLineArguments()
+paraview.simple._DisableFirstRenderCameraReset()
+
+lut = GetColorTransferFunction("RTData")
+lut.AutomaticRescaleRangeMode = "Never"
+lut.RescaleTransferFunction(37.0, 277.0)
+pwf = GetOpacityTransferFunction("RTData")
+pwf.RescaleTransferFunction(37.0, 277.0)
+
+def render_volume(streaming, filename):
+    vtkPVView.SetEnableStreaming(streaming)
+    view = CreateRenderView(ViewSize=[300, 300], OrientationAxesVisibility=0)
+    view.CameraPosition = [0, 0, 150]
+    view.CameraFocalPoint = [0, 0, 0]
+    view.CameraViewUp = [0, 1, 0]
+
+    # 64^3 points in bricks of 16^3 samples: 4 levels, 125 bricks at full
+    # resolution.
+    wavelet = Wavelet(WholeExtent=[-31, 32, -31, 32, -31, 32])
+    display = Show(wavelet, view)
+    display.Representation = "Streaming Volume"
+    display.ColorArrayName = ["POINTS", "RTData"]
+    display.LookupTable = lut
+    display.ScalarOpacityFunction = pwf
+    display.NumberOfSamples = [64, 64, 64]
+    display.BrickSize = 16
+    # refine all bricks down to full resolution.
+    display.ScreenSpaceError = 0.01
+    Render(view)
+
+    passes = 0
+    while view.SMProxy.StreamingUpdate(True):
+        passes += 1
+        if passes > 1000:
+            raise smtesting.TestError("Streaming does not terminate")
+    Render(view)
+    SaveScreenshot(filename, view, ImageResolution=[300, 300])
+
+    Delete(display)
+    Delete(wavelet)
+    Delete(view)
+    vtkPVView.SetEnableStreaming(False)
+    return passes
+
+reference = os.path.join(smtesting.TempDir, "StreamingVolume_whole.png")
+streamed = os.path.join(smtesting.TempDir, "StreamingVolume_streamed.png")
+
+if render_volume(False, reference) != 0:
+    raise smtesting.TestError("Bricks were streamed with streaming disabled")
+passes = render_volume(True, streamed)
+if passes < 1 + 8 + 27 + 125:
+    raise smtesting.TestError("Only %d bricks were streamed" % passes)
+
+testing = vtkTesting()
+testing.AddArgument("-T")
+testing.AddArgument(smtesting.TempDir)
+testing.AddArgument("-V")
+testing.AddArgument(reference)
+if testing.RegressionTest(streamed, smtesting.Threshold) != testing.PASSED:
+    raise smtesting.TestError("Streamed volume differs from the volume of the whole image")
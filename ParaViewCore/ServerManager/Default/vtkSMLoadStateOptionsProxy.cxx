@@ -20,8 +20,10 @@
 #include "vtkPVSession.h"
 #include "vtkPVXMLElement.h"
 #include "vtkPVXMLParser.h"
+#include "vtkSMBinaryStateLoader.h"
 #include "vtkSMDomainIterator.h"
 #include "vtkSMFileListDomain.h"
+#include "vtkSMMessage.h"
 #include "vtkSMProperty.h"
 #include "vtkSMPropertyHelper.h"
 #include "vtkSMPropertyIterator.h"
@@ -44,18 +46,37 @@ public:
   struct PropertyInfo
   {
     pugi::xml_node XMLElement;
+    // Location of the property in the binary state messages.
+    size_t MessageIndex;
+    int PropertyIndex;
     std::vector<std::string> FilePaths;
     bool Modified;
     PropertyInfo()
-      : Modified(false)
+      : MessageIndex(0)
+      , PropertyIndex(-1)
+      , Modified(false)
     {
     }
   };
   typedef std::map<int, std::map<std::string, PropertyInfo> > PropertiesMapType;
   PropertiesMapType PropertiesMap;
+  // XML group and type of the proxies in PropertiesMap.
+  std::map<int, std::pair<std::string, std::string> > ProxyTypes;
   std::map<int, pugi::xml_node> CollectionsMap;
   pugi::xml_document StateXML;
 
+  // Binary state (see vtkSMBinaryStateLoader). The first message holds the
+  // proxy registrations, RegistrationsMap gives the index of the "sources"
+  // registration of a proxy in it.
+  bool BinaryState;
+  std::vector<vtkSMMessage> Messages;
+  std::map<int, int> RegistrationsMap;
+
+  vtkInternals()
+    : BinaryState(false)
+  {
+  }
+
   void ProcessStateFile(pugi::xml_node node)
   {
     pugi::xpath_node_set proxies =
@@ -98,6 +119,7 @@ public:
     }
 
     int proxyId = node.attribute("id").as_int();
+    this->ProxyTypes[proxyId] = std::make_pair(group.value(), type.value());
 
     pugi::xpath_variable_set vars;
     vars.add("propertyname", pugi::xpath_type_string);
@@ -138,6 +160,142 @@ public:
     }
   }
 
+  void ProcessBinaryState()
+  {
+    std::set<vtkTypeUInt64> subProxyIds;
+    for (size_t cc = 1; cc < this->Messages.size(); ++cc)
+    {
+      const vtkSMMessage& msg = this->Messages[cc];
+      for (int i = 0; i < msg.ExtensionSize(ProxyState::subproxy); ++i)
+      {
+        subProxyIds.insert(msg.GetExtension(ProxyState::subproxy, i).global_id());
+      }
+    }
+    for (size_t cc = 1; cc < this->Messages.size(); ++cc)
+    {
+      if (subProxyIds.find(this->Messages[cc].global_id()) == subProxyIds.end())
+      {
+        this->ProcessProxyMessage(cc);
+      }
+    }
+
+    const vtkSMMessage& registration = this->Messages[0];
+    for (int i = 0; i < registration.ExtensionSize(PXMRegistrationState::registered_proxy); ++i)
+    {
+      const PXMRegistrationState_Entry& entry =
+        registration.GetExtension(PXMRegistrationState::registered_proxy, i);
+      if (entry.group() == "sources")
+      {
+        this->RegistrationsMap[static_cast<int>(entry.global_id())] = i;
+      }
+    }
+  }
+
+  void ProcessProxyMessage(size_t index)
+  {
+    const vtkSMMessage& msg = this->Messages[index];
+    if (!msg.HasExtension(ProxyState::xml_group) || !msg.HasExtension(ProxyState::xml_name))
+    {
+      vtkGenericWarningMacro("Possibly invalid state file.");
+      return;
+    }
+    const std::string& group = msg.GetExtension(ProxyState::xml_group);
+    const std::string& type = msg.GetExtension(ProxyState::xml_name);
+
+    vtkSMProxy* prototype =
+      vtkSMProxyManager::GetProxyManager()->GetActiveSessionProxyManager()->GetPrototypeProxy(
+        group.c_str(), type.c_str());
+    if (!prototype)
+    {
+      return;
+    }
+
+    std::set<std::string> filenameProperties = this->LocateFileNameProperties(prototype);
+    if (filenameProperties.size() == 0)
+    {
+      return;
+    }
+
+    int proxyId = static_cast<int>(msg.global_id());
+    for (int i = 0; i < msg.ExtensionSize(ProxyState::property); ++i)
+    {
+      const ProxyState_Property& prop = msg.GetExtension(ProxyState::property, i);
+      if (!prop.has_value() || filenameProperties.find(prop.name()) == filenameProperties.end())
+      {
+        continue;
+      }
+      PropertyInfo info;
+      info.MessageIndex = index;
+      info.PropertyIndex = i;
+      for (int j = 0; j < prop.value().txt_size(); ++j)
+      {
+        info.FilePaths.push_back(prop.value().txt(j));
+      }
+      this->PropertiesMap[proxyId][prop.name()] = info;
+      this->ProxyTypes[proxyId] = std::make_pair(group, type);
+    }
+  }
+
+  // Write the file paths of a property back to the state.
+  void UpdateFilePaths(const PropertyInfo& info)
+  {
+    if (this->BinaryState)
+    {
+      Variant* value = this->Messages[info.MessageIndex]
+                         .MutableExtension(ProxyState::property, info.PropertyIndex)
+                         ->mutable_value();
+      value->clear_txt();
+      for (auto fIter = info.FilePaths.begin(); fIter != info.FilePaths.end(); ++fIter)
+      {
+        value->add_txt(*fIter);
+      }
+      return;
+    }
+
+    // Clear out existing file names
+    pugi::xml_node element = info.XMLElement;
+    while (element.remove_child("Element"))
+    {
+    }
+    for (auto fIter = info.FilePaths.begin(); fIter != info.FilePaths.end(); ++fIter)
+    {
+      std::string idx = std::to_string(std::distance(info.FilePaths.begin(), fIter));
+      pugi::xml_node newNode = element.append_child("Element");
+      newNode.append_attribute("index").set_value(idx.c_str());
+      newNode.append_attribute("value").set_value(fIter->c_str());
+    }
+  }
+
+  std::string GetCollectionName(int proxyId)
+  {
+    if (this->BinaryState)
+    {
+      auto iter = this->RegistrationsMap.find(proxyId);
+      return iter == this->RegistrationsMap.end()
+        ? std::string()
+        : this->Messages[0]
+            .GetExtension(PXMRegistrationState::registered_proxy, iter->second)
+            .name();
+    }
+    return this->CollectionsMap[proxyId].attribute("name").as_string();
+  }
+
+  void SetCollectionName(int proxyId, const std::string& name)
+  {
+    if (this->BinaryState)
+    {
+      auto iter = this->RegistrationsMap.find(proxyId);
+      if (iter != this->RegistrationsMap.end())
+      {
+        this->Messages[0]
+          .MutableExtension(PXMRegistrationState::registered_proxy, iter->second)
+          ->set_name(name);
+      }
+      return;
+    }
+    this->CollectionsMap[proxyId].attribute("name").set_value(name.c_str());
+  }
+
   std::set<std::string> LocateFileNameProperties(vtkSMProxy* proxy)
   {
     std::set<std::string> fileNameProperties;
@@ -197,16 +355,30 @@ vtkPVXMLElement* ConvertXML(vtkPVXMLParser* parser, pugi::xml_node& node)
 bool vtkSMLoadStateOptionsProxy::PrepareToLoad(const char* statefilename)
 {
   this->SetStateFileName(statefilename);
-  pugi::xml_parse_result result = this->Internals->StateXML.load_file(statefilename);
-
-  if (!result)
+  this->Internals->BinaryState = vtkSMBinaryStateLoader::IsBinaryStateFile(statefilename);
+  if (this->Internals->BinaryState)
   {
-    vtkErrorMacro(
-      "Error parsing state file XML from " << statefilename << ": " << result.description());
-    return false;
+    vtkNew<vtkSMBinaryStateLoader> loader;
+    if (!loader->ReadState(statefilename, this->Internals->Messages))
+    {
+      vtkErrorMacro("Error reading binary state file " << statefilename);
+      return false;
+    }
+    this->Internals->ProcessBinaryState();
   }
+  else
+  {
+    pugi::xml_parse_result result = this->Internals->StateXML.load_file(statefilename);
+
+    if (!result)
+    {
+      vtkErrorMacro(
+        "Error parsing state file XML from " << statefilename << ": " << result.description());
+      return false;
+    }
 
-  this->Internals->ProcessStateFile(this->Internals->StateXML);
+    this->Internals->ProcessStateFile(this->Internals->StateXML);
+  }
 
   vtkSMSessionProxyManager* pxm =
     vtkSMProxyManager::GetProxyManager()->GetActiveSessionProxyManager();
@@ -217,25 +389,43 @@ bool vtkSMLoadStateOptionsProxy::PrepareToLoad(const char* statefilename)
   for (auto idIter = this->Internals->PropertiesMap.begin();
        idIter != this->Internals->PropertiesMap.end(); idIter++)
   {
-    pugi::xml_node proxyXML = idIter->second.begin()->second.XMLElement.parent();
+    const std::pair<std::string, std::string>& proxyType =
+      this->Internals->ProxyTypes[idIter->first];
     vtkSmartPointer<vtkSMProxy> newReaderProxy;
     newReaderProxy.TakeReference(
-      pxm->NewProxy(proxyXML.attribute("group").value(), proxyXML.attribute("type").value()));
+      pxm->NewProxy(proxyType.first.c_str(), proxyType.second.c_str()));
     newReaderProxy->PrototypeOn();
 
     // Property group to group properties by source
     pugi::xml_document propertyGroup;
     pugi::xml_node propertyGroupElement = propertyGroup.append_child("PropertyGroup");
-    propertyGroupElement.append_attribute("label").set_value(proxyXML.attribute("type").value());
+    propertyGroupElement.append_attribute("label").set_value(proxyType.second.c_str());
     propertyGroupElement.append_attribute("panel_widget").set_value("LoadStateOptionsDialog");
 
     vtkNew<vtkPVXMLParser> XMLParser;
-    newReaderProxy->LoadXMLState(ConvertXML(XMLParser.Get(), proxyXML), nullptr);
+    if (this->Internals->BinaryState)
+    {
+      // Only the file names are needed by the dialog.
+      for (auto pIter = idIter->second.begin(); pIter != idIter->second.end(); pIter++)
+      {
+        const std::vector<std::string>& filePaths = pIter->second.FilePaths;
+        vtkSMPropertyHelper helper(newReaderProxy, pIter->first.c_str());
+        helper.SetNumberOfElements(static_cast<unsigned int>(filePaths.size()));
+        for (unsigned int i = 0; i < filePaths.size(); ++i)
+        {
+          helper.Set(i, filePaths[i].c_str());
+        }
+      }
+    }
+    else
+    {
+      pugi::xml_node proxyXML = idIter->second.begin()->second.XMLElement.parent();
+      newReaderProxy->LoadXMLState(ConvertXML(XMLParser.Get(), proxyXML), nullptr);
+    }
     std::string newProxyName = std::to_string(idIter->first);
     this->AddSubProxy(newProxyName.c_str(), newReaderProxy.GetPointer());
 
-    std::string baseName =
-      this->Internals->CollectionsMap[idIter->first].attribute("name").as_string();
+    std::string baseName = this->Internals->GetCollectionName(idIter->first);
 
     // Remove all '.'s in the name to avoid possible name collisions with the appended index
     // If baseName is not unique for each proxy then the proxies are linked and their properties
@@ -270,12 +460,11 @@ bool vtkSMLoadStateOptionsProxy::PrepareToLoad(const char* statefilename)
 
       property->SetHints(ConvertXML(XMLParser.Get(), hints));
 
-      pugi::xml_node propertyXML = pIter->second.XMLElement;
       std::string exposedName = baseName;
 
-      exposedName.append(".").append(propertyXML.attribute("name").value());
-      this->ExposeSubProxyProperty(newProxyName.c_str(), propertyXML.attribute("name").value(),
-        exposedName.c_str(), 1 /*override*/);
+      exposedName.append(".").append(pIter->first);
+      this->ExposeSubProxyProperty(
+        newProxyName.c_str(), pIter->first.c_str(), exposedName.c_str(), 1 /*override*/);
       propertyGroupElement.append_child("Property")
         .append_attribute("name")
         .set_value(exposedName.c_str());
@@ -404,13 +593,9 @@ bool vtkSMLoadStateOptionsProxy::Load()
             propertiesModified = true;
           }
 
+          this->Internals->UpdateFilePaths(info);
           for (auto fIter = info.FilePaths.begin(); fIter != info.FilePaths.end(); ++fIter)
           {
-            std::string idx = std::to_string(std::distance(info.FilePaths.begin(), fIter));
-            info.XMLElement.find_child_by_attribute("Element", "index", idx.c_str())
-              .attribute("value")
-              .set_value(fIter->c_str());
-
             if (primaryFilename.empty() && fIter->compare(0, 3, "XML") != 0)
             {
               primaryFilename = fIter->c_str();
@@ -429,8 +614,7 @@ bool vtkSMLoadStateOptionsProxy::Load()
             filename = sequenceParser->GetSequenceName();
           }
 
-          this->Internals->CollectionsMap[idIter->first].attribute("name").set_value(
-            filename.c_str());
+          this->Internals->SetCollectionName(idIter->first, filename);
         }
       }
 
@@ -471,25 +655,19 @@ bool vtkSMLoadStateOptionsProxy::Load()
             }
           }
 
-          // Clear out existing file names
-          while (info.XMLElement.remove_child("Element"))
-          {
-          }
-
-          // Add the new file names
+          // Build up file name list from the current property value
+          info.FilePaths.clear();
           vtkSMPropertyHelper filenamePropHelper(subProxy, pIter->first.c_str());
           for (unsigned int i = 0; i < filenamePropHelper.GetNumberOfElements(); ++i)
           {
-            // Build up file name list from the current property value
-            pugi::xml_node newNode = info.XMLElement.append_child("Element");
-            newNode.append_attribute("index").set_value(std::to_string(i).c_str());
             std::string filename = filenamePropHelper.GetAsString(i);
-            newNode.append_attribute("value").set_value(filename.c_str());
+            info.FilePaths.push_back(filename);
             if (primaryFilename.empty())
             {
               primaryFilename = filename;
             }
           }
+          this->Internals->UpdateFilePaths(info);
         }
 
         // Also fix up sources proxy collection
@@ -500,8 +678,7 @@ bool vtkSMLoadStateOptionsProxy::Load()
           filename = sequenceParser->GetSequenceName();
         }
 
-        this->Internals->CollectionsMap[idIter->first].attribute("name").set_value(
-          filename.c_str());
+        this->Internals->SetCollectionName(idIter->first, filename);
       }
       break;
     }
@@ -509,6 +686,10 @@ bool vtkSMLoadStateOptionsProxy::Load()
 
   vtkSMSessionProxyManager* pxm =
     vtkSMProxyManager::GetProxyManager()->GetActiveSessionProxyManager();
+  if (this->Internals->BinaryState)
+  {
+    return pxm->LoadBinaryState(this->Internals->Messages);
+  }
   vtkNew<vtkPVXMLParser> XMLParser;
   pxm->LoadXMLState(ConvertXML(XMLParser.Get(), this->Internals->StateXML));
 
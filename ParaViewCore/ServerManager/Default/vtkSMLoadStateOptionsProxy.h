@@ -20,6 +20,8 @@
  * vtkSMLoadStateOptionsProxy provides a dialog to allow a user to change the
  * locations of data files when loading a state file. The user can give a directory
  * where the data files reside or explicitly change the path for each data file.
+ * Both XML (.pvsm) and binary (.pvsb, see vtkSMBinaryStateLoader) state files
+ * are supported.
  */
 
 #ifndef vtkSMLoadStateOptionsProxy_h
@@ -14,26 +14,38 @@
 =========================================================================*/
 #include "vtkIntegrateAttributes.h"
 
+#include "vtkArrayDispatch.h"
 #include "vtkCellData.h"
 #include "vtkCellType.h"
 #include "vtkCompositeDataIterator.h"
 #include "vtkCompositeDataPipeline.h"
 #include "vtkCompositeDataSet.h"
+#include "vtkDataArrayAccessor.h"
 #include "vtkDataSet.h"
 #include "vtkDoubleArray.h"
+#include "vtkGenericCell.h"
 #include "vtkIdList.h"
+#include "vtkImageData.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkMath.h"
 #include "vtkMultiProcessController.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
-#include "vtkPointData.h"
-#include "vtkPolygon.h"
-#include "vtkTriangle.h"
+#include "vtkPoints.h"
+#include "vtkRectilinearGrid.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+#include "vtkUniformGrid.h"
 #include "vtkUnsignedCharArray.h"
 #include "vtkUnstructuredGrid.h"
 
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
 vtkStandardNewMacro(vtkIntegrateAttributes);
 
 class vtkIntegrateAttributes::vtkFieldList : public vtkDataSetAttributes::FieldList
@@ -62,260 +74,1122 @@ protected:
   }
 };
 
+namespace
+{
 //-----------------------------------------------------------------------------
-vtkIntegrateAttributes::vtkIntegrateAttributes()
+// Compensated (Kahan-Babuska) sum: the rounding error of every addition is
+// accumulated separately, so that summing millions of small contributions
+// does not lose their low order bits.
+class vtkIntegrateSum
 {
-  this->IntegrationDimension = 0;
-  this->Sum = 0.0;
-  this->SumCenter[0] = this->SumCenter[1] = this->SumCenter[2] = 0.0;
-  this->Controller = 0;
+public:
+  vtkIntegrateSum()
+    : Sum(0.0)
+    , Compensation(0.0)
+  {
+  }
 
-  this->PointFieldList = 0;
-  this->CellFieldList = 0;
-  this->FieldListIndex = 0;
+  void Add(double value)
+  {
+    const double sum = this->Sum + value;
+    if (fabs(this->Sum) >= fabs(value))
+    {
+      this->Compensation += (this->Sum - sum) + value;
+    }
+    else
+    {
+      this->Compensation += (value - sum) + this->Sum;
+    }
+    this->Sum = sum;
+  }
 
-  this->DivideAllCellDataByVolume = false;
+  void Add(const vtkIntegrateSum& other)
+  {
+    this->Add(other.Sum);
+    this->Add(other.Compensation);
+  }
 
-  SetController(vtkMultiProcessController::GetGlobalController());
-}
+  double Get() const { return this->Sum + this->Compensation; }
+
+private:
+  double Sum;
+  double Compensation;
+};
 
 //-----------------------------------------------------------------------------
-vtkIntegrateAttributes::~vtkIntegrateAttributes()
+// An input array to integrate, and where its sums go.
+struct vtkIntegrateArrayEntry
 {
-  if (this->Controller)
+  vtkDataArray* Array;
+  bool IsPointArray;
+  vtkIdType Offset;
+};
+
+// Collects the input arrays of the field lists that have an output array.
+// Returns the number of values (components) to sum.
+vtkIdType vtkCollectIntegratedArrays(vtkDataSet* input, vtkUnstructuredGrid* output,
+  int fieldset_index, vtkDataSetAttributes::FieldList& pdList,
+  vtkDataSetAttributes::FieldList& cdList, std::vector<vtkIntegrateArrayEntry>& arrays,
+  std::vector<vtkDoubleArray*>& outArrays)
+{
+  vtkIdType numValues = 0;
+  for (int pass = 0; pass < 2; ++pass)
   {
-    this->Controller->Delete();
-    this->Controller = 0;
+    const bool isPointData = (pass == 0);
+    vtkDataSetAttributes::FieldList& fieldList = isPointData ? pdList : cdList;
+    vtkDataSetAttributes* inda = isPointData
+      ? static_cast<vtkDataSetAttributes*>(input->GetPointData())
+      : static_cast<vtkDataSetAttributes*>(input->GetCellData());
+    vtkDataSetAttributes* outda = isPointData
+      ? static_cast<vtkDataSetAttributes*>(output->GetPointData())
+      : static_cast<vtkDataSetAttributes*>(output->GetCellData());
+    for (int i = 0, numArrays = fieldList.GetNumberOfFields(); i < numArrays; ++i)
+    {
+      if (fieldList.GetFieldIndex(i) < 0)
+      {
+        continue;
+      }
+      vtkDataArray* inArray = inda->GetArray(fieldList.GetDSAIndex(fieldset_index, i));
+      // Output arrays are always vtkDoubleArray (see vtkFieldList::CreateArray).
+      vtkDoubleArray* outArray =
+        vtkDoubleArray::SafeDownCast(outda->GetArray(fieldList.GetFieldIndex(i)));
+      if (inArray && outArray)
+      {
+        vtkIntegrateArrayEntry entry = { inArray, isPointData, numValues };
+        arrays.push_back(entry);
+        outArrays.push_back(outArray);
+        numValues += inArray->GetNumberOfComponents();
+      }
+    }
   }
+  return numValues;
 }
 
-//----------------------------------------------------------------------------
-void vtkIntegrateAttributes::SetController(vtkMultiProcessController* controller)
+//-----------------------------------------------------------------------------
+// A cell skipped because its triangulation is not made of simplices. Worker
+// threads record these, and the filter warns about them afterwards.
+struct vtkIntegrateSkippedCell
 {
-  if (this->Controller)
+  vtkIdType CellId;
+  int Dimension;
+  vtkIdType NumberOfPoints;
+};
+
+// The integration of a range of cells. Only the highest dimension met is kept,
+// as the filter does for the whole input. Geometry holds the measure and the
+// weighted center.
+struct vtkIntegratePartial
+{
+  int Dimension;
+  vtkIntegrateSum Geometry[4];
+  std::vector<vtkIntegrateSum> Sums;
+  std::vector<vtkIntegrateSkippedCell> Skipped;
+
+  vtkIntegratePartial()
+    : Dimension(0)
   {
-    this->Controller->UnRegister(this);
   }
 
-  this->Controller = controller;
+  void Reset(int dim, vtkIdType numValues)
+  {
+    this->Dimension = dim;
+    std::fill(this->Geometry, this->Geometry + 4, vtkIntegrateSum());
+    this->Sums.assign(numValues, vtkIntegrateSum());
+  }
 
-  if (this->Controller)
+  void AddGeometry(double k, const double center[3])
   {
-    this->Controller->Register(this);
+    this->Geometry[0].Add(k);
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      this->Geometry[axis + 1].Add(center[axis] * k);
+    }
   }
-}
 
-//----------------------------------------------------------------------------
-vtkExecutive* vtkIntegrateAttributes::CreateDefaultExecutive()
+  // Adds the partial of the next range of cells.
+  void Add(const vtkIntegratePartial& other)
+  {
+    this->Skipped.insert(this->Skipped.end(), other.Skipped.begin(), other.Skipped.end());
+    if (other.Dimension > this->Dimension)
+    {
+      this->Reset(other.Dimension, static_cast<vtkIdType>(other.Sums.size()));
+    }
+    else if (other.Dimension < this->Dimension || other.Dimension == 0)
+    {
+      return;
+    }
+    for (int cc = 0; cc < 4; ++cc)
+    {
+      this->Geometry[cc].Add(other.Geometry[cc]);
+    }
+    for (size_t cc = 0; cc < this->Sums.size(); ++cc)
+    {
+      this->Sums[cc].Add(other.Sums[cc]);
+    }
+  }
+};
+
+// Upper bound on the number of chunks a block is split into. This is
+// independent of the number of threads to keep results reproducible.
+const vtkIdType vtkIntegrateMaximumNumberOfChunks = 1024;
+
+//-----------------------------------------------------------------------------
+// Describes the cells of a vtkImageData or vtkRectilinearGrid as the tensor
+// product of per-axis intervals. This lets us integrate such datasets without
+// fetching any cell geometry: the measure of a cell is the product of its
+// interval widths and its center is the product of the interval mid points.
+class vtkStructuredIntegrationGrid
 {
-  return vtkCompositeDataPipeline::New();
-}
+public:
+  int PointDims[3];
+  int CellDims[3];
+  int Dimension;
+  int NumberOfCorners;
+  vtkIdType CornerOffsets[8];
+  std::vector<double> Widths[3];
+  std::vector<double> Centers[3];
+
+  bool Initialize(vtkDataSet* input)
+  {
+    vtkImageData* image = vtkImageData::SafeDownCast(input);
+    vtkRectilinearGrid* rgrid = vtkRectilinearGrid::SafeDownCast(input);
+    if (image)
+    {
+      image->GetDimensions(this->PointDims);
+    }
+    else if (rgrid)
+    {
+      rgrid->GetDimensions(this->PointDims);
+    }
+    else
+    {
+      return false;
+    }
 
-//----------------------------------------------------------------------------
-int vtkIntegrateAttributes::FillInputPortInformation(int port, vtkInformation* info)
+    this->Dimension = 0;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      if (this->PointDims[axis] <= 0)
+      {
+        return false;
+      }
+      this->CellDims[axis] = std::max(this->PointDims[axis] - 1, 1);
+      this->Widths[axis].resize(this->CellDims[axis]);
+      this->Centers[axis].resize(this->CellDims[axis]);
+
+      // Collapsed axes contribute a unit width so that they do not change the
+      // measure of the cells.
+      const bool active = this->PointDims[axis] > 1;
+      this->Dimension += active ? 1 : 0;
+      for (int cc = 0; cc < this->CellDims[axis]; ++cc)
+      {
+        double x0, x1;
+        if (image)
+        {
+          const double* origin = image->GetOrigin();
+          const double* spacing = image->GetSpacing();
+          const int* extent = image->GetExtent();
+          x0 = origin[axis] + spacing[axis] * (extent[2 * axis] + cc);
+          x1 = active ? x0 + spacing[axis] : x0;
+        }
+        else
+        {
+          vtkDataArray* coords = axis == 0 ? rgrid->GetXCoordinates()
+                                           : (axis == 1 ? rgrid->GetYCoordinates()
+                                                        : rgrid->GetZCoordinates());
+          x0 = coords->GetComponent(cc, 0);
+          x1 = active ? coords->GetComponent(cc + 1, 0) : x0;
+        }
+        this->Widths[axis][cc] = active ? fabs(x1 - x0) : 1.0;
+        this->Centers[axis][cc] = 0.5 * (x0 + x1);
+      }
+    }
+
+    if (this->Dimension == 0)
+    {
+      return false;
+    }
+
+    // Point id offsets of the cell corners relative to the corner with the
+    // smallest structured index.
+    const vtkIdType strides[3] = { 1, this->PointDims[0],
+      static_cast<vtkIdType>(this->PointDims[0]) * this->PointDims[1] };
+    this->NumberOfCorners = 1;
+    this->CornerOffsets[0] = 0;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      if (this->PointDims[axis] > 1)
+      {
+        for (int cc = 0; cc < this->NumberOfCorners; ++cc)
+        {
+          this->CornerOffsets[this->NumberOfCorners + cc] = this->CornerOffsets[cc] + strides[axis];
+        }
+        this->NumberOfCorners *= 2;
+      }
+    }
+    return true;
+  }
+
+  vtkIdType GetNumberOfCells() const
+  {
+    return static_cast<vtkIdType>(this->CellDims[0]) * this->CellDims[1] * this->CellDims[2];
+  }
+};
+
+//-----------------------------------------------------------------------------
+// Iterates over a contiguous range of cell ids of a vtkStructuredIntegrationGrid
+// skipping ghost/blanked cells, without a division per cell.
+class vtkStructuredIntegrationCellIterator
 {
-  if (!this->Superclass::FillInputPortInformation(port, info))
+public:
+  vtkStructuredIntegrationCellIterator(const vtkStructuredIntegrationGrid& grid,
+    vtkUnsignedCharArray* ghosts, vtkIdType begin, vtkIdType end)
+    : Grid(grid)
+    , Ghosts(ghosts)
+    , CellId(begin)
+    , End(end)
   {
-    return 0;
+    const vtkIdType slice = static_cast<vtkIdType>(grid.CellDims[0]) * grid.CellDims[1];
+    this->IJK[2] = static_cast<int>(begin / slice);
+    this->IJK[1] = static_cast<int>((begin % slice) / grid.CellDims[0]);
+    this->IJK[0] = static_cast<int>(begin % grid.CellDims[0]);
+    this->SkipHidden();
+  }
+
+  bool IsDone() const { return this->CellId >= this->End; }
+
+  void Next()
+  {
+    this->Advance();
+    this->SkipHidden();
   }
-  info->Set(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkDataObject");
-  return 1;
-}
+
+  vtkIdType GetCellId() const { return this->CellId; }
+
+  vtkIdType GetFirstPointId() const
+  {
+    return this->IJK[0] +
+      static_cast<vtkIdType>(this->Grid.PointDims[0]) *
+      (this->IJK[1] + static_cast<vtkIdType>(this->Grid.PointDims[1]) * this->IJK[2]);
+  }
+
+  double GetMeasure() const
+  {
+    return this->Grid.Widths[0][this->IJK[0]] * this->Grid.Widths[1][this->IJK[1]] *
+      this->Grid.Widths[2][this->IJK[2]];
+  }
+
+  void GetCenter(double center[3]) const
+  {
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      center[axis] = this->Grid.Centers[axis][this->IJK[axis]];
+    }
+  }
+
+private:
+  void Advance()
+  {
+    ++this->CellId;
+    if (++this->IJK[0] == this->Grid.CellDims[0])
+    {
+      this->IJK[0] = 0;
+      if (++this->IJK[1] == this->Grid.CellDims[1])
+      {
+        this->IJK[1] = 0;
+        ++this->IJK[2];
+      }
+    }
+  }
+
+  void SkipHidden()
+  {
+    while (this->Ghosts && this->CellId < this->End &&
+      (this->Ghosts->GetValue(this->CellId) &
+        (vtkDataSetAttributes::DUPLICATECELL | vtkDataSetAttributes::HIDDENCELL)))
+    {
+      this->Advance();
+    }
+  }
+
+  const vtkStructuredIntegrationGrid& Grid;
+  vtkUnsignedCharArray* Ghosts;
+  vtkIdType CellId;
+  vtkIdType End;
+  int IJK[3];
+};
 
 //-----------------------------------------------------------------------------
-int vtkIntegrateAttributes::CompareIntegrationDimension(vtkDataSet* output, int dim)
+// Typed kernels summing one input array over a range of cells.
+struct vtkIntegrateStructuredCellArray
 {
-  // higher dimension prevails
-  if (this->IntegrationDimension < dim)
-  { // Throw out results from lower dimension.
-    this->Sum = 0;
-    this->SumCenter[0] = this->SumCenter[1] = this->SumCenter[2] = 0.0;
-    this->ZeroAttributes(output->GetPointData());
-    this->ZeroAttributes(output->GetCellData());
-    this->IntegrationDimension = dim;
-    return 1;
+  template <typename ArrayT>
+  void operator()(ArrayT* array, const vtkStructuredIntegrationGrid& grid,
+    vtkUnsignedCharArray* ghosts, vtkIdType begin, vtkIdType end, vtkIntegrateSum* sums)
+  {
+    vtkDataArrayAccessor<ArrayT> accessor(array);
+    const int numComps = array->GetNumberOfComponents();
+    for (vtkStructuredIntegrationCellIterator iter(grid, ghosts, begin, end); !iter.IsDone();
+         iter.Next())
+    {
+      const double k = iter.GetMeasure();
+      const vtkIdType cellId = iter.GetCellId();
+      for (int comp = 0; comp < numComps; ++comp)
+      {
+        sums[comp].Add(k * static_cast<double>(accessor.Get(cellId, comp)));
+      }
+    }
   }
-  // Skip this cell if we are inetrgrting a higher dimension.
-  return (this->IntegrationDimension == dim);
-}
+};
 
-//----------------------------------------------------------------------------
-void vtkIntegrateAttributes::ExecuteBlock(vtkDataSet* input, vtkUnstructuredGrid* output,
-  int fieldset_index, vtkIntegrateAttributes::vtkFieldList& pdList,
-  vtkIntegrateAttributes::vtkFieldList& cdList)
+struct vtkIntegrateStructuredPointArray
 {
-  vtkUnsignedCharArray* ghostArray = input->GetCellGhostArray();
-
-  // This is sort of a hack since it's incredibly painful to change all the
-  // signatures to take the pdList, cdList and fieldset_index.
-  this->PointFieldList = &pdList;
-  this->CellFieldList = &cdList;
-  this->FieldListIndex = fieldset_index;
-
-  vtkIdList* cellPtIds = vtkIdList::New();
-  vtkIdType numCells = input->GetNumberOfCells();
-  vtkIdType cellId;
-  vtkPoints* cellPoints = 0; // needed if we need to split 3D cells
-  int cellType;
-  for (cellId = 0; cellId < numCells; ++cellId)
-  {
-    cellType = input->GetCellType(cellId);
-    // Make sure we are not integrating ghost/blanked cells.
-    if (ghostArray && (ghostArray->GetValue(cellId) &
-                        (vtkDataSetAttributes::DUPLICATECELL | vtkDataSetAttributes::HIDDENCELL)))
+  template <typename ArrayT>
+  void operator()(ArrayT* array, const vtkStructuredIntegrationGrid& grid,
+    vtkUnsignedCharArray* ghosts, vtkIdType begin, vtkIdType end, vtkIntegrateSum* sums)
+  {
+    vtkDataArrayAccessor<ArrayT> accessor(array);
+    const int numComps = array->GetNumberOfComponents();
+    const double cornerWeight = 1.0 / grid.NumberOfCorners;
+    for (vtkStructuredIntegrationCellIterator iter(grid, ghosts, begin, end); !iter.IsDone();
+         iter.Next())
     {
-      continue;
+      const double k = iter.GetMeasure() * cornerWeight;
+      const vtkIdType ptId = iter.GetFirstPointId();
+      for (int comp = 0; comp < numComps; ++comp)
+      {
+        double value = 0.0;
+        for (int corner = 0; corner < grid.NumberOfCorners; ++corner)
+        {
+          value += static_cast<double>(accessor.Get(ptId + grid.CornerOffsets[corner], comp));
+        }
+        sums[comp].Add(k * value);
+      }
     }
+  }
+};
 
-    switch (cellType)
+//-----------------------------------------------------------------------------
+// Integrates a structured block in a fixed number of chunks. Each chunk owns
+// its partial sums and the partials are combined in chunk order afterwards,
+// so the result does not depend on the number of threads or on scheduling.
+class vtkIntegrateStructuredFunctor
+{
+public:
+  vtkIntegrateStructuredFunctor(const vtkStructuredIntegrationGrid& grid,
+    vtkUnsignedCharArray* ghosts, const std::vector<vtkIntegrateArrayEntry>& arrays,
+    vtkIdType numValues, vtkIdType numChunks)
+    : Grid(grid)
+    , Ghosts(ghosts)
+    , Arrays(arrays)
+    , NumberOfValues(numValues)
+    , NumberOfChunks(numChunks)
+    , NumberOfCells(grid.GetNumberOfCells())
+    , Partials(numChunks)
+  {
+  }
+
+  void operator()(vtkIdType firstChunk, vtkIdType lastChunk)
+  {
+    for (vtkIdType chunk = firstChunk; chunk < lastChunk; ++chunk)
     {
-      // skip empty or 0D Cells
-      case VTK_EMPTY_CELL:
-      case VTK_VERTEX:
-      case VTK_POLY_VERTEX:
-        break;
+      const vtkIdType begin = chunk * this->NumberOfCells / this->NumberOfChunks;
+      const vtkIdType end = (chunk + 1) * this->NumberOfCells / this->NumberOfChunks;
+
+      vtkIntegratePartial& partial = this->Partials[chunk];
+      partial.Reset(0, this->NumberOfValues);
+      double center[3];
+      for (vtkStructuredIntegrationCellIterator iter(this->Grid, this->Ghosts, begin, end);
+           !iter.IsDone(); iter.Next())
+      {
+        iter.GetCenter(center);
+        partial.AddGeometry(iter.GetMeasure(), center);
+        partial.Dimension = this->Grid.Dimension;
+      }
+      if (partial.Dimension == 0)
+      {
+        // Only ghost cells in this chunk.
+        continue;
+      }
 
-      case VTK_POLY_LINE:
-      case VTK_LINE:
+      vtkIntegrateSum* sums = this->NumberOfValues > 0 ? &partial.Sums[0] : NULL;
+      for (const vtkIntegrateArrayEntry& entry : this->Arrays)
       {
-        if (this->CompareIntegrationDimension(output, 1))
+        if (entry.IsPointArray)
+        {
+          vtkIntegrateStructuredPointArray worker;
+          if (!vtkArrayDispatch::Dispatch::Execute(
+                entry.Array, worker, this->Grid, this->Ghosts, begin, end, sums + entry.Offset))
+          {
+            worker(entry.Array, this->Grid, this->Ghosts, begin, end, sums + entry.Offset);
+          }
+        }
+        else
         {
-          input->GetCellPoints(cellId, cellPtIds);
-          this->IntegratePolyLine(input, output, cellId, cellPtIds);
+          vtkIntegrateStructuredCellArray worker;
+          if (!vtkArrayDispatch::Dispatch::Execute(
+                entry.Array, worker, this->Grid, this->Ghosts, begin, end, sums + entry.Offset))
+          {
+            worker(entry.Array, this->Grid, this->Ghosts, begin, end, sums + entry.Offset);
+          }
         }
       }
-      break;
+    }
+  }
 
-      case VTK_TRIANGLE:
+  // Combines the per-chunk partials in chunk order.
+  void GetResult(vtkIntegratePartial& result) const
+  {
+    for (const vtkIntegratePartial& partial : this->Partials)
+    {
+      result.Add(partial);
+    }
+  }
+
+private:
+  const vtkStructuredIntegrationGrid& Grid;
+  vtkUnsignedCharArray* Ghosts;
+  const std::vector<vtkIntegrateArrayEntry>& Arrays;
+  vtkIdType NumberOfValues;
+  vtkIdType NumberOfChunks;
+  vtkIdType NumberOfCells;
+  std::vector<vtkIntegratePartial> Partials;
+};
+
+// Integrates a vtkImageData or vtkRectilinearGrid block without per-cell
+// geometry queries. Returns false if the block has to go through the generic
+// per-cell path instead.
+bool vtkIntegrateStructuredBlock(vtkDataSet* input,
+  const std::vector<vtkIntegrateArrayEntry>& arrays, vtkIdType numValues,
+  vtkIntegratePartial& result)
+{
+  // vtkUniformGrid can also be blanked through hidden points, which the
+  // structured path does not account for.
+  if (vtkUniformGrid::SafeDownCast(input) && input->GetPointGhostArray())
+  {
+    return false;
+  }
+
+  vtkStructuredIntegrationGrid grid;
+  if (!grid.Initialize(input) || grid.GetNumberOfCells() != input->GetNumberOfCells())
+  {
+    return false;
+  }
+
+  const vtkIdType numChunks = std::min(grid.GetNumberOfCells(), vtkIntegrateMaximumNumberOfChunks);
+  vtkIntegrateStructuredFunctor functor(
+    grid, input->GetCellGhostArray(), arrays, numValues, numChunks);
+  vtkSMPTools::For(0, numChunks, 1, functor);
+  functor.GetResult(result);
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+// A simplex (or half a voxel) of a cell. Its point attributes are integrated
+// as the average of its point values weighted by PointWeight, and the cell
+// attributes as the cell value weighted by CellWeight.
+struct vtkIntegrationElement
+{
+  vtkIdType CellId;
+  vtkIdType PointIds[4];
+  int NumberOfPoints;
+  double PointWeight;
+  double CellWeight;
+};
+
+// Typed kernels summing one input array over the elements of a chunk.
+struct vtkIntegrateElementPointArray
+{
+  template <typename ArrayT>
+  void operator()(
+    ArrayT* array, const std::vector<vtkIntegrationElement>& elements, vtkIntegrateSum* sums)
+  {
+    vtkDataArrayAccessor<ArrayT> accessor(array);
+    const int numComps = array->GetNumberOfComponents();
+    for (const vtkIntegrationElement& element : elements)
+    {
+      const double k = element.PointWeight / element.NumberOfPoints;
+      for (int comp = 0; comp < numComps; ++comp)
       {
-        if (this->CompareIntegrationDimension(output, 2))
+        double value = 0.0;
+        for (int cc = 0; cc < element.NumberOfPoints; ++cc)
         {
-          input->GetCellPoints(cellId, cellPtIds);
-          this->IntegrateTriangle(
-            input, output, cellId, cellPtIds->GetId(0), cellPtIds->GetId(1), cellPtIds->GetId(2));
+          value += static_cast<double>(accessor.Get(element.PointIds[cc], comp));
         }
+        sums[comp].Add(k * value);
       }
-      break;
+    }
+  }
+};
 
-      case VTK_TRIANGLE_STRIP:
+struct vtkIntegrateElementCellArray
+{
+  template <typename ArrayT>
+  void operator()(
+    ArrayT* array, const std::vector<vtkIntegrationElement>& elements, vtkIntegrateSum* sums)
+  {
+    vtkDataArrayAccessor<ArrayT> accessor(array);
+    const int numComps = array->GetNumberOfComponents();
+    for (const vtkIntegrationElement& element : elements)
+    {
+      if (element.CellWeight == 0.0)
+      {
+        continue;
+      }
+      for (int comp = 0; comp < numComps; ++comp)
       {
-        if (this->CompareIntegrationDimension(output, 2))
+        sums[comp].Add(
+          element.CellWeight * static_cast<double>(accessor.Get(element.CellId, comp)));
+      }
+    }
+  }
+};
+
+//-----------------------------------------------------------------------------
+// Integrates the cells of any vtkDataSet in a fixed number of chunks. The
+// cells of a chunk are first split into elements, computing their measure
+// and center, then each array is summed over the elements with a typed
+// kernel. As for structured blocks, the partials are combined in chunk order.
+class vtkIntegrateCellsFunctor
+{
+public:
+  vtkIntegrateCellsFunctor(vtkDataSet* input, const std::vector<vtkIntegrateArrayEntry>& arrays,
+    vtkIdType numValues, vtkIdType numChunks)
+    : Input(input)
+    , Ghosts(input->GetCellGhostArray())
+    , Arrays(arrays)
+    , NumberOfValues(numValues)
+    , NumberOfChunks(numChunks)
+    , NumberOfCells(input->GetNumberOfCells())
+    , Partials(numChunks)
+  {
+  }
+
+  void operator()(vtkIdType firstChunk, vtkIdType lastChunk)
+  {
+    vtkIdList* ptIds = this->PointIds.Local();
+    vtkGenericCell* cell = this->Cell.Local();
+    vtkPoints* points = this->Points.Local();
+    std::vector<vtkIntegrationElement>& elements = this->Elements.Local();
+    for (vtkIdType chunk = firstChunk; chunk < lastChunk; ++chunk)
+    {
+      const vtkIdType begin = chunk * this->NumberOfCells / this->NumberOfChunks;
+      const vtkIdType end = (chunk + 1) * this->NumberOfCells / this->NumberOfChunks;
+
+      vtkIntegratePartial& partial = this->Partials[chunk];
+      partial.Reset(0, this->NumberOfValues);
+      elements.clear();
+      for (vtkIdType cellId = begin; cellId < end; ++cellId)
+      {
+        // Make sure we are not integrating ghost/blanked cells.
+        if (this->Ghosts &&
+          (this->Ghosts->GetValue(cellId) &
+            (vtkDataSetAttributes::DUPLICATECELL | vtkDataSetAttributes::HIDDENCELL)))
         {
-          input->GetCellPoints(cellId, cellPtIds);
-          this->IntegrateTriangleStrip(input, output, cellId, cellPtIds);
+          continue;
         }
+        this->AddCell(cellId, ptIds, cell, points, partial, elements);
       }
-      break;
 
-      case VTK_POLYGON:
+      vtkIntegrateSum* sums = this->NumberOfValues > 0 ? &partial.Sums[0] : NULL;
+      for (const vtkIntegrateArrayEntry& entry : this->Arrays)
       {
-        if (this->CompareIntegrationDimension(output, 2))
+        if (entry.IsPointArray)
+        {
+          vtkIntegrateElementPointArray worker;
+          if (!vtkArrayDispatch::Dispatch::Execute(
+                entry.Array, worker, elements, sums + entry.Offset))
+          {
+            worker(entry.Array, elements, sums + entry.Offset);
+          }
+        }
+        else
         {
-          input->GetCellPoints(cellId, cellPtIds);
-          this->IntegratePolygon(input, output, cellId, cellPtIds);
+          vtkIntegrateElementCellArray worker;
+          if (!vtkArrayDispatch::Dispatch::Execute(
+                entry.Array, worker, elements, sums + entry.Offset))
+          {
+            worker(entry.Array, elements, sums + entry.Offset);
+          }
         }
       }
-      break;
+    }
+  }
 
-      case VTK_PIXEL:
+  // Combines the per-chunk partials in chunk order.
+  void GetResult(vtkIntegratePartial& result) const
+  {
+    for (const vtkIntegratePartial& partial : this->Partials)
+    {
+      result.Add(partial);
+    }
+  }
+
+private:
+  // Higher dimension prevails: elements of a lower dimension are thrown out.
+  // Returns false if the cell is of a lower dimension than the chunk.
+  static bool UseDimension(
+    vtkIntegratePartial& partial, std::vector<vtkIntegrationElement>& elements, int dim)
+  {
+    if (partial.Dimension < dim)
+    {
+      partial.Reset(dim, static_cast<vtkIdType>(partial.Sums.size()));
+      elements.clear();
+      return true;
+    }
+    return partial.Dimension == dim;
+  }
+
+  static void AddElement(std::vector<vtkIntegrationElement>& elements, vtkIdType cellId,
+    const vtkIdType* pointIds, int numPoints, double pointWeight, double cellWeight)
+  {
+    vtkIntegrationElement element;
+    element.CellId = cellId;
+    std::copy(pointIds, pointIds + numPoints, element.PointIds);
+    element.NumberOfPoints = numPoints;
+    element.PointWeight = pointWeight;
+    element.CellWeight = cellWeight;
+    elements.push_back(element);
+  }
+
+  void AddLine(vtkIntegratePartial& partial, std::vector<vtkIntegrationElement>& elements,
+    vtkIdType cellId, vtkIdType pt1Id, vtkIdType pt2Id)
+  {
+    double pt1[3], pt2[3], mid[3];
+    this->Input->GetPoint(pt1Id, pt1);
+    this->Input->GetPoint(pt2Id, pt2);
+
+    // Compute the length of the line.
+    const double length = sqrt(vtkMath::Distance2BetweenPoints(pt1, pt2));
+
+    // Compute the middle, which is really just another attribute.
+    mid[0] = (pt1[0] + pt2[0]) * 0.5;
+    mid[1] = (pt1[1] + pt2[1]) * 0.5;
+    mid[2] = (pt1[2] + pt2[2]) * 0.5;
+    partial.AddGeometry(length, mid);
+
+    const vtkIdType ids[2] = { pt1Id, pt2Id };
+    AddElement(elements, cellId, ids, 2, length, length);
+  }
+
+  void AddTriangle(vtkIntegratePartial& partial, std::vector<vtkIntegrationElement>& elements,
+    vtkIdType cellId, vtkIdType pt1Id, vtkIdType pt2Id, vtkIdType pt3Id)
+  {
+    double pt1[3], pt2[3], pt3[3];
+    double mid[3], v1[3], v2[3];
+    double cross[3];
+    this->Input->GetPoint(pt1Id, pt1);
+    this->Input->GetPoint(pt2Id, pt2);
+    this->Input->GetPoint(pt3Id, pt3);
+
+    // Compute two legs.
+    for (int i = 0; i < 3; ++i)
+    {
+      v1[i] = pt2[i] - pt1[i];
+      v2[i] = pt3[i] - pt1[i];
+    }
+
+    // Use the cross product to compute the area of the parallelogram.
+    vtkMath::Cross(v1, v2, cross);
+    const double k = sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]) * 0.5;
+    if (k == 0.0)
+    {
+      return;
+    }
+
+    // Compute the middle, which is really just another attribute.
+    mid[0] = (pt1[0] + pt2[0] + pt3[0]) / 3.0;
+    mid[1] = (pt1[1] + pt2[1] + pt3[1]) / 3.0;
+    mid[2] = (pt1[2] + pt2[2] + pt3[2]) / 3.0;
+    partial.AddGeometry(k, mid);
+
+    const vtkIdType ids[3] = { pt1Id, pt2Id, pt3Id };
+    AddElement(elements, cellId, ids, 3, k, k);
+  }
+
+  void AddTetrahedron(vtkIntegratePartial& partial, std::vector<vtkIntegrationElement>& elements,
+    vtkIdType cellId, vtkIdType pt1Id, vtkIdType pt2Id, vtkIdType pt3Id, vtkIdType pt4Id)
+  {
+    double pts[4][3];
+    this->Input->GetPoint(pt1Id, pts[0]);
+    this->Input->GetPoint(pt2Id, pts[1]);
+    this->Input->GetPoint(pt3Id, pts[2]);
+    this->Input->GetPoint(pt4Id, pts[3]);
+
+    // Compute the principle vectors around pt0 and the centroid.
+    double a[3], b[3], c[3], n[3], mid[3];
+    for (int i = 0; i < 3; i++)
+    {
+      a[i] = pts[1][i] - pts[0][i];
+      b[i] = pts[2][i] - pts[0][i];
+      c[i] = pts[3][i] - pts[0][i];
+      mid[i] = (pts[0][i] + pts[1][i] + pts[2][i] + pts[3][i]) * 0.25;
+    }
+
+    // Calculate the volume of the tet which is 1/6 * the box product.
+    vtkMath::Cross(a, b, n);
+    const double v = vtkMath::Dot(c, n) / 6.0;
+    partial.AddGeometry(v, mid);
+
+    const vtkIdType ids[4] = { pt1Id, pt2Id, pt3Id, pt4Id };
+    AddElement(elements, cellId, ids, 4, v, v);
+  }
+
+  // For axis aligned rectangular cells.
+  void AddPixel(vtkIntegratePartial& partial, std::vector<vtkIntegrationElement>& elements,
+    vtkIdType cellId, vtkIdList* cellPtIds)
+  {
+    double pts[4][3];
+    for (int i = 0; i < 4; ++i)
+    {
+      this->Input->GetPoint(cellPtIds->GetId(i), pts[i]);
+    }
+
+    // Get the lengths of its 2 orthogonal sides. Since only 1 coordinate
+    // can be different we can add the differences in all 3 directions.
+    const double l = (pts[0][0] - pts[1][0]) + (pts[0][1] - pts[1][1]) + (pts[0][2] - pts[1][2]);
+    const double w = (pts[0][0] - pts[2][0]) + (pts[0][1] - pts[2][1]) + (pts[0][2] - pts[2][2]);
+    const double a = fabs(l * w);
+
+    // Compute the middle, which is really just another attribute.
+    double mid[3];
+    for (int i = 0; i < 3; ++i)
+    {
+      mid[i] = (pts[0][i] + pts[1][i] + pts[2][i] + pts[3][i]) * 0.25;
+    }
+    partial.AddGeometry(a, mid);
+
+    AddElement(elements, cellId, cellPtIds->GetPointer(0), 4, a, a);
+  }
+
+  // For axis aligned hexahedral cells.
+  void AddVoxel(vtkIntegratePartial& partial, std::vector<vtkIntegrationElement>& elements,
+    vtkIdType cellId, vtkIdList* cellPtIds)
+  {
+    double pts[8][3];
+    for (int i = 0; i < 8; ++i)
+    {
+      this->Input->GetPoint(cellPtIds->GetId(i), pts[i]);
+    }
+
+    // Calculate the volume of the voxel.
+    const double l = pts[1][0] - pts[0][0];
+    const double w = pts[2][1] - pts[0][1];
+    const double h = pts[4][2] - pts[0][2];
+    const double v = fabs(l * w * h);
+
+    double mid[3];
+    for (int i = 0; i < 3; ++i)
+    {
+      mid[i] = 0.0;
+      for (int j = 0; j < 8; ++j)
       {
-        if (this->CompareIntegrationDimension(output, 2))
+        mid[i] += pts[j][i];
+      }
+      mid[i] *= 0.125;
+    }
+    partial.AddGeometry(v, mid);
+
+    // The point attributes of the bottom and top faces are each weighted by
+    // half the volume, so that every point is weighted by 1/8 of it. The cell
+    // attributes are integrated once.
+    const vtkIdType* ids = cellPtIds->GetPointer(0);
+    AddElement(elements, cellId, ids, 4, v * 0.5, v);
+    AddElement(elements, cellId, ids + 4, 4, v * 0.5, 0.0);
+  }
+
+  void AddCell(vtkIdType cellId, vtkIdList* cellPtIds, vtkGenericCell* cell, vtkPoints* points,
+    vtkIntegratePartial& partial, std::vector<vtkIntegrationElement>& elements)
+  {
+    switch (this->Input->GetCellType(cellId))
+    {
+      // skip empty or 0D Cells
+      case VTK_EMPTY_CELL:
+      case VTK_VERTEX:
+      case VTK_POLY_VERTEX:
+        break;
+
+      case VTK_POLY_LINE:
+      case VTK_LINE:
+        if (UseDimension(partial, elements, 1))
         {
-          input->GetCellPoints(cellId, cellPtIds);
-          this->IntegratePixel(input, output, cellId, cellPtIds);
+          this->Input->GetCellPoints(cellId, cellPtIds);
+          for (vtkIdType cc = 0; cc + 1 < cellPtIds->GetNumberOfIds(); ++cc)
+          {
+            this->AddLine(
+              partial, elements, cellId, cellPtIds->GetId(cc), cellPtIds->GetId(cc + 1));
+          }
         }
-      }
-      break;
+        break;
+
+      case VTK_TRIANGLE:
+      case VTK_TRIANGLE_STRIP:
+        if (UseDimension(partial, elements, 2))
+        {
+          this->Input->GetCellPoints(cellId, cellPtIds);
+          for (vtkIdType cc = 0; cc + 2 < cellPtIds->GetNumberOfIds(); ++cc)
+          {
+            this->AddTriangle(partial, elements, cellId, cellPtIds->GetId(cc),
+              cellPtIds->GetId(cc + 1), cellPtIds->GetId(cc + 2));
+          }
+        }
+        break;
+
+      case VTK_POLYGON:
+        // Works for convex polygons, and interpolation is not correct.
+        if (UseDimension(partial, elements, 2))
+        {
+          this->Input->GetCellPoints(cellId, cellPtIds);
+          for (vtkIdType cc = 1; cc + 1 < cellPtIds->GetNumberOfIds(); ++cc)
+          {
+            this->AddTriangle(partial, elements, cellId, cellPtIds->GetId(0),
+              cellPtIds->GetId(cc), cellPtIds->GetId(cc + 1));
+          }
+        }
+        break;
+
+      case VTK_PIXEL:
+        if (UseDimension(partial, elements, 2))
+        {
+          this->Input->GetCellPoints(cellId, cellPtIds);
+          this->AddPixel(partial, elements, cellId, cellPtIds);
+        }
+        break;
 
       case VTK_QUAD:
+        if (UseDimension(partial, elements, 2))
+        {
+          this->Input->GetCellPoints(cellId, cellPtIds);
+          const vtkIdType* ids = cellPtIds->GetPointer(0);
+          this->AddTriangle(partial, elements, cellId, ids[0], ids[1], ids[2]);
+          this->AddTriangle(partial, elements, cellId, ids[0], ids[3], ids[2]);
+        }
+        break;
+
+      case VTK_VOXEL:
+        if (UseDimension(partial, elements, 3))
+        {
+          this->Input->GetCellPoints(cellId, cellPtIds);
+          this->AddVoxel(partial, elements, cellId, cellPtIds);
+        }
+        break;
+
+      case VTK_TETRA:
+        if (UseDimension(partial, elements, 3))
+        {
+          this->Input->GetCellPoints(cellId, cellPtIds);
+          const vtkIdType* ids = cellPtIds->GetPointer(0);
+          this->AddTetrahedron(partial, elements, cellId, ids[0], ids[1], ids[2], ids[3]);
+        }
+        break;
+
+      default:
       {
-        if (this->CompareIntegrationDimension(output, 2))
+        // We need to explicitly get the cell.
+        this->Input->GetCell(cellId, cell);
+        const int cellDim = cell->GetCellDimension();
+        if (cellDim == 0 || !UseDimension(partial, elements, cellDim))
         {
-          vtkIdType pt1Id, pt2Id, pt3Id;
-          input->GetCellPoints(cellId, cellPtIds);
-          pt1Id = cellPtIds->GetId(0);
-          pt2Id = cellPtIds->GetId(1);
-          pt3Id = cellPtIds->GetId(2);
-          this->IntegrateTriangle(input, output, cellId, pt1Id, pt2Id, pt3Id);
-          pt2Id = cellPtIds->GetId(3);
-          this->IntegrateTriangle(input, output, cellId, pt1Id, pt2Id, pt3Id);
+          break;
+        }
+
+        cell->Triangulate(1, cellPtIds, points);
+        const vtkIdType nPnts = cellPtIds->GetNumberOfIds();
+        const vtkIdType* ids = cellPtIds->GetPointer(0);
+        // The triangulation must be made of lines, triangles or tetrahedra.
+        if (cellDim > 3 || nPnts % (cellDim + 1))
+        {
+          vtkIntegrateSkippedCell skipped = { cellId, cellDim, nPnts };
+          partial.Skipped.push_back(skipped);
+          break;
+        }
+        for (vtkIdType cc = 0; cc < nPnts; cc += cellDim + 1)
+        {
+          switch (cellDim)
+          {
+            case 1:
+              this->AddLine(partial, elements, cellId, ids[cc], ids[cc + 1]);
+              break;
+            case 2:
+              this->AddTriangle(partial, elements, cellId, ids[cc], ids[cc + 1], ids[cc + 2]);
+              break;
+            default:
+              this->AddTetrahedron(
+                partial, elements, cellId, ids[cc], ids[cc + 1], ids[cc + 2], ids[cc + 3]);
+          }
         }
       }
-      break;
+    }
+  }
+
+  vtkDataSet* Input;
+  vtkUnsignedCharArray* Ghosts;
+  const std::vector<vtkIntegrateArrayEntry>& Arrays;
+  vtkIdType NumberOfValues;
+  vtkIdType NumberOfChunks;
+  vtkIdType NumberOfCells;
+  std::vector<vtkIntegratePartial> Partials;
+  vtkSMPThreadLocalObject<vtkIdList> PointIds;
+  vtkSMPThreadLocalObject<vtkGenericCell> Cell;
+  vtkSMPThreadLocalObject<vtkPoints> Points;
+  vtkSMPThreadLocal<std::vector<vtkIntegrationElement> > Elements;
+};
+
+// Integrates the cells of any vtkDataSet, one cell at a time.
+void vtkIntegrateCells(vtkDataSet* input, const std::vector<vtkIntegrateArrayEntry>& arrays,
+  vtkIdType numValues, vtkIntegratePartial& result)
+{
+  const vtkIdType numCells = input->GetNumberOfCells();
+  if (numCells == 0)
+  {
+    return;
+  }
+
+  // Call GetCell once so that the cell structures of the input are built
+  // before the threads query them.
+  vtkNew<vtkGenericCell> cell;
+  input->GetCell(0, cell.GetPointer());
+
+  const vtkIdType numChunks = std::min(numCells, vtkIntegrateMaximumNumberOfChunks);
+  vtkIntegrateCellsFunctor functor(input, arrays, numValues, numChunks);
+  vtkSMPTools::For(0, numChunks, 1, functor);
+  functor.GetResult(result);
+}
+}
+
+//-----------------------------------------------------------------------------
+vtkIntegrateAttributes::vtkIntegrateAttributes()
+{
+  this->IntegrationDimension = 0;
+  this->Sum = 0.0;
+  this->SumCenter[0] = this->SumCenter[1] = this->SumCenter[2] = 0.0;
+  this->Controller = 0;
+
+  this->DivideAllCellDataByVolume = false;
+
+  SetController(vtkMultiProcessController::GetGlobalController());
+}
+
+//-----------------------------------------------------------------------------
+vtkIntegrateAttributes::~vtkIntegrateAttributes()
+{
+  if (this->Controller)
+  {
+    this->Controller->Delete();
+    this->Controller = 0;
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkIntegrateAttributes::SetController(vtkMultiProcessController* controller)
+{
+  if (this->Controller)
+  {
+    this->Controller->UnRegister(this);
+  }
+
+  this->Controller = controller;
+
+  if (this->Controller)
+  {
+    this->Controller->Register(this);
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkExecutive* vtkIntegrateAttributes::CreateDefaultExecutive()
+{
+  return vtkCompositeDataPipeline::New();
+}
 
-      case VTK_VOXEL:
-      {
-        if (this->CompareIntegrationDimension(output, 3))
-        {
-          input->GetCellPoints(cellId, cellPtIds);
-          this->IntegrateVoxel(input, output, cellId, cellPtIds);
-        }
-      }
-      break;
+//----------------------------------------------------------------------------
+int vtkIntegrateAttributes::FillInputPortInformation(int port, vtkInformation* info)
+{
+  if (!this->Superclass::FillInputPortInformation(port, info))
+  {
+    return 0;
+  }
+  info->Set(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkDataObject");
+  return 1;
+}
 
-      case VTK_TETRA:
-      {
-        if (this->CompareIntegrationDimension(output, 3))
-        {
-          vtkIdType pt1Id, pt2Id, pt3Id, pt4Id;
-          input->GetCellPoints(cellId, cellPtIds);
-          pt1Id = cellPtIds->GetId(0);
-          pt2Id = cellPtIds->GetId(1);
-          pt3Id = cellPtIds->GetId(2);
-          pt4Id = cellPtIds->GetId(3);
-          this->IntegrateTetrahedron(input, output, cellId, pt1Id, pt2Id, pt3Id, pt4Id);
-        }
-      }
-      break;
+//-----------------------------------------------------------------------------
+int vtkIntegrateAttributes::CompareIntegrationDimension(vtkDataSet* output, int dim)
+{
+  // higher dimension prevails
+  if (this->IntegrationDimension < dim)
+  { // Throw out results from lower dimension.
+    this->Sum = 0;
+    this->SumCenter[0] = this->SumCenter[1] = this->SumCenter[2] = 0.0;
+    this->ZeroAttributes(output->GetPointData());
+    this->ZeroAttributes(output->GetCellData());
+    this->IntegrationDimension = dim;
+    return 1;
+  }
+  // Skip this cell if we are inetrgrting a higher dimension.
+  return (this->IntegrationDimension == dim);
+}
 
-      default:
-      {
-        // We need to explicitly get the cell
-        vtkCell* cell = input->GetCell(cellId);
-        int cellDim = cell->GetCellDimension();
-        if (cellDim == 0)
-        {
-          continue;
-        }
-        if (!this->CompareIntegrationDimension(output, cellDim))
-        {
-          continue;
-        }
+//----------------------------------------------------------------------------
+void vtkIntegrateAttributes::ExecuteBlock(vtkDataSet* input, vtkUnstructuredGrid* output,
+  int fieldset_index, vtkIntegrateAttributes::vtkFieldList& pdList,
+  vtkIntegrateAttributes::vtkFieldList& cdList)
+{
+  std::vector<vtkIntegrateArrayEntry> arrays;
+  std::vector<vtkDoubleArray*> outArrays;
+  const vtkIdType numValues = vtkCollectIntegratedArrays(
+    input, output, fieldset_index, pdList, cdList, arrays, outArrays);
 
-        // We will need a place to store points from the cell's
-        // triangulate function
-        if (!cellPoints)
-        {
-          cellPoints = vtkPoints::New();
-        }
+  vtkIntegratePartial result;
+  if (!vtkIntegrateStructuredBlock(input, arrays, numValues, result))
+  {
+    vtkIntegrateCells(input, arrays, numValues, result);
+  }
 
-        cell->Triangulate(1, cellPtIds, cellPoints);
-        switch (cellDim)
-        {
-          case 1:
-            this->IntegrateGeneral1DCell(input, output, cellId, cellPtIds);
-            break;
-          case 2:
-            this->IntegrateGeneral2DCell(input, output, cellId, cellPtIds);
-            break;
-          case 3:
-            this->IntegrateGeneral3DCell(input, output, cellId, cellPtIds);
-            break;
-          default:
-            vtkWarningMacro("Unsupported Cell Dimension = " << cellDim);
-        }
-      }
+  for (const vtkIntegrateSkippedCell& skipped : result.Skipped)
+  {
+    switch (skipped.Dimension)
+    {
+      case 1:
+        vtkWarningMacro("Odd number of points(" << skipped.NumberOfPoints
+                                                << ")  encountered - skipping "
+                                                << " 1D Cell: " << skipped.CellId);
+        break;
+      case 2:
+        vtkWarningMacro("Number of points (" << skipped.NumberOfPoints
+                                             << ") is not divisiable by 3 - skipping "
+                                             << " 2D Cell: " << skipped.CellId);
+        break;
+      case 3:
+        vtkWarningMacro("Number of points (" << skipped.NumberOfPoints
+                                             << ") is not divisiable by 4 - skipping "
+                                             << " 3D Cell: " << skipped.CellId);
+        break;
+      default:
+        vtkWarningMacro("Unsupported Cell Dimension = " << skipped.Dimension);
     }
   }
-  cellPtIds->Delete();
-  if (cellPoints)
+
+  // Nothing to add if all cells are ghosts, or if we are integrating a higher
+  // dimension.
+  if (result.Dimension == 0 || !this->CompareIntegrationDimension(output, result.Dimension))
   {
-    cellPoints->Delete();
+    return;
   }
 
-  this->PointFieldList = NULL;
-  this->CellFieldList = NULL;
-  this->FieldListIndex = 0;
+  this->Sum += result.Geometry[0].Get();
+  this->SumCenter[0] += result.Geometry[1].Get();
+  this->SumCenter[1] += result.Geometry[2].Get();
+  this->SumCenter[2] += result.Geometry[3].Get();
+  for (size_t cc = 0; cc < arrays.size(); ++cc)
+  {
+    double* out = outArrays[cc]->GetPointer(0);
+    for (int comp = 0, numComps = arrays[cc].Array->GetNumberOfComponents(); comp < numComps;
+         ++comp)
+    {
+      out[comp] += result.Sums[arrays[cc].Offset + comp].Get();
+    }
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -466,35 +1340,9 @@ int vtkIntegrateAttributes::RequestData(
   }
   sumArray->Delete();
 
-  int globalMin = this->PieceNodeMinToNode0(output);
-  int processId = this->Controller->GetLocalProcessId();
-  int numProcs = this->Controller->GetNumberOfProcesses();
-  if (globalMin == numProcs)
-  {
-    // there is no data in any of the processors
-    if (this->Sum != 0.0 && this->DivideAllCellDataByVolume)
-    {
-      DivideDataArraysByConstant(output->GetCellData(), true, this->Sum);
-    }
-    return 1;
-  }
-  if (processId > 0)
-  {
-    if (processId != globalMin)
-    {
-      this->SendPiece(output);
-    }
-  }
-  else
+  this->ReducePiecesToNode0(output);
+  if (this->Controller->GetLocalProcessId() == 0)
   {
-    for (int id = 1; id < numProcs; ++id)
-    {
-      if (id != globalMin)
-      {
-        this->ReceivePiece(output, id);
-      }
-    }
-
     // now that we have all of the sums from each process
     // set the point location with the global value
     if (this->Sum != 0.0)
@@ -519,33 +1367,33 @@ int vtkIntegrateAttributes::RequestData(
   return 1;
 }
 
-int vtkIntegrateAttributes::PieceNodeMinToNode0(vtkUnstructuredGrid* data)
+//-----------------------------------------------------------------------------
+// Sums the pieces of all processes into process 0 along a binomial tree, so
+// that the root merges log(numProcs) pieces instead of one per process.
+void vtkIntegrateAttributes::ReducePiecesToNode0(vtkUnstructuredGrid* data)
 {
-  int numProcs = this->Controller->GetNumberOfProcesses();
-  int processId = this->Controller->GetLocalProcessId();
-  int localMin = (data->GetNumberOfCells() == 0 ? numProcs : processId);
-  int globalMin = numProcs;
-  if (numProcs == 1)
-  {
-    return 0;
-  }
-  this->Controller->AllReduce(&localMin, &globalMin, 1, vtkCommunicator::MIN_OP);
-  if (globalMin == 0 || globalMin == numProcs)
-  {
-    return globalMin;
-  }
-  if (processId == 0)
+  if (!this->Controller)
   {
-    this->ReceivePiece(data, globalMin);
+    return;
   }
-  else if (processId == globalMin)
+  const int numProcs = this->Controller->GetNumberOfProcesses();
+  const int processId = this->Controller->GetLocalProcessId();
+  for (int step = 1; step < numProcs; step *= 2)
   {
-    this->SendPiece(data);
+    if (processId % (2 * step) != 0)
+    {
+      this->SendPiece(data, processId - step);
+      return;
+    }
+    if (processId + step < numProcs)
+    {
+      this->ReceivePiece(data, processId + step);
+    }
   }
-  return globalMin;
 }
 
-void vtkIntegrateAttributes::SendPiece(vtkUnstructuredGrid* src)
+//-----------------------------------------------------------------------------
+void vtkIntegrateAttributes::SendPiece(vtkUnstructuredGrid* src, int toId)
 {
   double msg[5];
   msg[0] = (double)(this->IntegrationDimension);
@@ -553,19 +1401,33 @@ void vtkIntegrateAttributes::SendPiece(vtkUnstructuredGrid* src)
   msg[2] = this->SumCenter[0];
   msg[3] = this->SumCenter[1];
   msg[4] = this->SumCenter[2];
-  this->Controller->Send(msg, 5, 0, vtkIntegrateAttributes::IntegrateAttrInfo);
-  this->Controller->Send(src, 0, vtkIntegrateAttributes::IntegrateAttrData);
+  this->Controller->Send(msg, 5, toId, vtkIntegrateAttributes::IntegrateAttrInfo);
+  this->Controller->Send(src, toId, vtkIntegrateAttributes::IntegrateAttrData);
   // Done sending.  Reset src so satellites will have empty data.
   src->Initialize();
 }
 
+//-----------------------------------------------------------------------------
 void vtkIntegrateAttributes::ReceivePiece(vtkUnstructuredGrid* mergeTo, int fromId)
 {
   double msg[5];
   this->Controller->Receive(msg, 5, fromId, vtkIntegrateAttributes::IntegrateAttrInfo);
   vtkUnstructuredGrid* tmp = vtkUnstructuredGrid::New();
   this->Controller->Receive(tmp, fromId, vtkIntegrateAttributes::IntegrateAttrData);
-  if (this->CompareIntegrationDimension(mergeTo, (int)(msg[0])))
+  const int dim = static_cast<int>(msg[0]);
+  if (dim > this->IntegrationDimension)
+  {
+    // The incoming piece integrated a higher dimension. Ours is thrown out,
+    // including the length/area/volume array that may not match.
+    this->IntegrationDimension = dim;
+    this->Sum = msg[1];
+    this->SumCenter[0] = msg[2];
+    this->SumCenter[1] = msg[3];
+    this->SumCenter[2] = msg[4];
+    mergeTo->GetPointData()->DeepCopy(tmp->GetPointData());
+    mergeTo->GetCellData()->DeepCopy(tmp->GetCellData());
+  }
+  else if (dim == this->IntegrationDimension)
   {
     this->Sum += msg[1];
     this->SumCenter[0] += msg[2];
@@ -619,134 +1481,6 @@ void vtkIntegrateAttributes::ZeroAttributes(vtkDataSetAttributes* outda)
     }
   }
 }
-//-----------------------------------------------------------------------------
-void vtkIntegrateAttributes::IntegrateData1(vtkDataSetAttributes* inda, vtkDataSetAttributes* outda,
-  vtkIdType pt1Id, double k, vtkIntegrateAttributes::vtkFieldList& fieldList, int index)
-{
-  int numArrays, i, numComponents, j;
-  vtkDataArray* inArray;
-  vtkDataArray* outArray;
-  numArrays = fieldList.GetNumberOfFields();
-  double vIn1, dv, vOut;
-  for (i = 0; i < numArrays; ++i)
-  {
-    if (fieldList.GetFieldIndex(i) < 0)
-    {
-      continue;
-    }
-    // We could template for speed.
-    inArray = inda->GetArray(fieldList.GetDSAIndex(index, i));
-    outArray = outda->GetArray(fieldList.GetFieldIndex(i));
-    numComponents = inArray->GetNumberOfComponents();
-    for (j = 0; j < numComponents; ++j)
-    {
-      vIn1 = inArray->GetComponent(pt1Id, j);
-      vOut = outArray->GetComponent(0, j);
-      dv = vIn1;
-      vOut += dv * k;
-      outArray->SetComponent(0, j, vOut);
-    }
-  }
-}
-//-----------------------------------------------------------------------------
-void vtkIntegrateAttributes::IntegrateData2(vtkDataSetAttributes* inda, vtkDataSetAttributes* outda,
-  vtkIdType pt1Id, vtkIdType pt2Id, double k, vtkIntegrateAttributes::vtkFieldList& fieldList,
-  int index)
-{
-  int numArrays, i, numComponents, j;
-  vtkDataArray* inArray;
-  vtkDataArray* outArray;
-  numArrays = fieldList.GetNumberOfFields();
-  double vIn1, vIn2, dv, vOut;
-  for (i = 0; i < numArrays; ++i)
-  {
-    if (fieldList.GetFieldIndex(i) < 0)
-    {
-      continue;
-    }
-    // We could template for speed.
-    inArray = inda->GetArray(fieldList.GetDSAIndex(index, i));
-    outArray = outda->GetArray(fieldList.GetFieldIndex(i));
-    numComponents = inArray->GetNumberOfComponents();
-    for (j = 0; j < numComponents; ++j)
-    {
-      vIn1 = inArray->GetComponent(pt1Id, j);
-      vIn2 = inArray->GetComponent(pt2Id, j);
-      vOut = outArray->GetComponent(0, j);
-      dv = 0.5 * (vIn1 + vIn2);
-      vOut += dv * k;
-      outArray->SetComponent(0, j, vOut);
-    }
-  }
-}
-//-----------------------------------------------------------------------------
-// Is the extra performance worth duplicating this code with IntergrateData2.
-void vtkIntegrateAttributes::IntegrateData3(vtkDataSetAttributes* inda, vtkDataSetAttributes* outda,
-  vtkIdType pt1Id, vtkIdType pt2Id, vtkIdType pt3Id, double k,
-  vtkIntegrateAttributes::vtkFieldList& fieldList, int index)
-{
-  int numArrays, i, numComponents, j;
-  vtkDataArray* inArray;
-  vtkDataArray* outArray;
-  numArrays = fieldList.GetNumberOfFields();
-  double vIn1, vIn2, vIn3, dv, vOut;
-  for (i = 0; i < numArrays; ++i)
-  {
-    if (fieldList.GetFieldIndex(i) < 0)
-    {
-      continue;
-    }
-    // We could template for speed.
-    inArray = inda->GetArray(fieldList.GetDSAIndex(index, i));
-    outArray = outda->GetArray(fieldList.GetFieldIndex(i));
-    numComponents = inArray->GetNumberOfComponents();
-    for (j = 0; j < numComponents; ++j)
-    {
-      vIn1 = inArray->GetComponent(pt1Id, j);
-      vIn2 = inArray->GetComponent(pt2Id, j);
-      vIn3 = inArray->GetComponent(pt3Id, j);
-      vOut = outArray->GetComponent(0, j);
-      dv = (vIn1 + vIn2 + vIn3) / 3.0;
-      vOut += dv * k;
-      outArray->SetComponent(0, j, vOut);
-    }
-  }
-}
-
-//-----------------------------------------------------------------------------
-// Is the extra performance worth duplicating this code with IntergrateData2.
-void vtkIntegrateAttributes::IntegrateData4(vtkDataSetAttributes* inda, vtkDataSetAttributes* outda,
-  vtkIdType pt1Id, vtkIdType pt2Id, vtkIdType pt3Id, vtkIdType pt4Id, double k,
-  vtkIntegrateAttributes::vtkFieldList& fieldList, int index)
-{
-  int numArrays, i, numComponents, j;
-  vtkDataArray* inArray;
-  vtkDataArray* outArray;
-  numArrays = fieldList.GetNumberOfFields();
-  double vIn1, vIn2, vIn3, vIn4, dv, vOut;
-  for (i = 0; i < numArrays; ++i)
-  {
-    if (fieldList.GetFieldIndex(i) < 0)
-    {
-      continue;
-    }
-    // We could template for speed.
-    inArray = inda->GetArray(fieldList.GetDSAIndex(index, i));
-    outArray = outda->GetArray(fieldList.GetFieldIndex(i));
-    numComponents = inArray->GetNumberOfComponents();
-    for (j = 0; j < numComponents; ++j)
-    {
-      vIn1 = inArray->GetComponent(pt1Id, j);
-      vIn2 = inArray->GetComponent(pt2Id, j);
-      vIn3 = inArray->GetComponent(pt3Id, j);
-      vIn4 = inArray->GetComponent(pt4Id, j);
-      vOut = outArray->GetComponent(0, j);
-      dv = (vIn1 + vIn2 + vIn3 + vIn4) * 0.25;
-      vOut += dv * k;
-      outArray->SetComponent(0, j, vOut);
-    }
-  }
-}
 
 //-----------------------------------------------------------------------------
 // Used to sum arrays from all processes.
@@ -795,378 +1529,6 @@ void vtkIntegrateAttributes::IntegrateSatelliteData(
   }
 }
 
-//-----------------------------------------------------------------------------
-void vtkIntegrateAttributes::IntegratePolyLine(
-  vtkDataSet* input, vtkUnstructuredGrid* output, vtkIdType cellId, vtkIdList* ptIds)
-{
-  double length;
-  double pt1[3], pt2[3], mid[3];
-  vtkIdType numLines, lineIdx;
-  vtkIdType pt1Id, pt2Id;
-
-  numLines = ptIds->GetNumberOfIds() - 1;
-  for (lineIdx = 0; lineIdx < numLines; ++lineIdx)
-  {
-    pt1Id = ptIds->GetId(lineIdx);
-    pt2Id = ptIds->GetId(lineIdx + 1);
-    input->GetPoint(pt1Id, pt1);
-    input->GetPoint(pt2Id, pt2);
-
-    // Compute the length of the line.
-    length = sqrt(vtkMath::Distance2BetweenPoints(pt1, pt2));
-    this->Sum += length;
-
-    // Compute the middle, which is really just another attribute.
-    mid[0] = (pt1[0] + pt2[0]) * 0.5;
-    mid[1] = (pt1[1] + pt2[1]) * 0.5;
-    mid[2] = (pt1[2] + pt2[2]) * 0.5;
-    // Add weighted to sumCenter.
-    this->SumCenter[0] += mid[0] * length;
-    this->SumCenter[1] += mid[1] * length;
-    this->SumCenter[2] += mid[2] * length;
-
-    // Now integrate the rest of the attributes.
-    this->IntegrateData2(input->GetPointData(), output->GetPointData(), pt1Id, pt2Id, length,
-      *this->PointFieldList, this->FieldListIndex);
-    this->IntegrateData1(input->GetCellData(), output->GetCellData(), cellId, length,
-      *this->CellFieldList, this->FieldListIndex);
-  }
-}
-
-//-----------------------------------------------------------------------------
-void vtkIntegrateAttributes::IntegrateGeneral1DCell(
-  vtkDataSet* input, vtkUnstructuredGrid* output, vtkIdType cellId, vtkIdList* ptIds)
-{
-  // Determine the number of lines
-  vtkIdType nPnts = ptIds->GetNumberOfIds();
-  // There should be an even number of points from the triangulation
-  if (nPnts % 2)
-  {
-    vtkWarningMacro("Odd number of points(" << nPnts << ")  encountered - skipping "
-                                            << " 1D Cell: " << cellId);
-    return;
-  }
-
-  double length;
-  double pt1[3], pt2[3], mid[3];
-  vtkIdType pid = 0;
-  vtkIdType pt1Id, pt2Id;
-
-  while (pid < nPnts)
-  {
-    pt1Id = ptIds->GetId(pid++);
-    pt2Id = ptIds->GetId(pid++);
-    input->GetPoint(pt1Id, pt1);
-    input->GetPoint(pt2Id, pt2);
-
-    // Compute the length of the line.
-    length = sqrt(vtkMath::Distance2BetweenPoints(pt1, pt2));
-    this->Sum += length;
-
-    // Compute the middle, which is really just another attribute.
-    mid[0] = (pt1[0] + pt2[0]) * 0.5;
-    mid[1] = (pt1[1] + pt2[1]) * 0.5;
-    mid[2] = (pt1[2] + pt2[2]) * 0.5;
-    // Add weighted to sumCenter.
-    this->SumCenter[0] += mid[0] * length;
-    this->SumCenter[1] += mid[1] * length;
-    this->SumCenter[2] += mid[2] * length;
-
-    // Now integrate the rest of the attributes.
-    this->IntegrateData2(input->GetPointData(), output->GetPointData(), pt1Id, pt2Id, length,
-      *this->PointFieldList, this->FieldListIndex);
-    this->IntegrateData1(input->GetCellData(), output->GetCellData(), cellId, length,
-      *this->CellFieldList, this->FieldListIndex);
-  }
-}
-
-//-----------------------------------------------------------------------------
-void vtkIntegrateAttributes::IntegrateTriangleStrip(
-  vtkDataSet* input, vtkUnstructuredGrid* output, vtkIdType cellId, vtkIdList* ptIds)
-{
-  vtkIdType numTris, triIdx;
-  vtkIdType pt1Id, pt2Id, pt3Id;
-
-  numTris = ptIds->GetNumberOfIds() - 2;
-  for (triIdx = 0; triIdx < numTris; ++triIdx)
-  {
-    pt1Id = ptIds->GetId(triIdx);
-    pt2Id = ptIds->GetId(triIdx + 1);
-    pt3Id = ptIds->GetId(triIdx + 2);
-    this->IntegrateTriangle(input, output, cellId, pt1Id, pt2Id, pt3Id);
-  }
-}
-
-//-----------------------------------------------------------------------------
-// Works for convex polygons, and interpoaltion is not correct.
-void vtkIntegrateAttributes::IntegratePolygon(
-  vtkDataSet* input, vtkUnstructuredGrid* output, vtkIdType cellId, vtkIdList* ptIds)
-{
-  vtkIdType numTris, triIdx;
-  vtkIdType pt1Id, pt2Id, pt3Id;
-
-  numTris = ptIds->GetNumberOfIds() - 2;
-  pt1Id = ptIds->GetId(0);
-  for (triIdx = 0; triIdx < numTris; ++triIdx)
-  {
-    pt2Id = ptIds->GetId(triIdx + 1);
-    pt3Id = ptIds->GetId(triIdx + 2);
-    this->IntegrateTriangle(input, output, cellId, pt1Id, pt2Id, pt3Id);
-  }
-}
-
-//-----------------------------------------------------------------------------
-// For axis aligned rectangular cells
-void vtkIntegrateAttributes::IntegratePixel(
-  vtkDataSet* input, vtkUnstructuredGrid* output, vtkIdType cellId, vtkIdList* cellPtIds)
-{
-  vtkIdType pt1Id, pt2Id, pt3Id, pt4Id;
-  double pts[4][3];
-  pt1Id = cellPtIds->GetId(0);
-  pt2Id = cellPtIds->GetId(1);
-  pt3Id = cellPtIds->GetId(2);
-  pt4Id = cellPtIds->GetId(3);
-  input->GetPoint(pt1Id, pts[0]);
-  input->GetPoint(pt2Id, pts[1]);
-  input->GetPoint(pt3Id, pts[2]);
-  input->GetPoint(pt4Id, pts[3]);
-
-  double l, w, a, mid[3];
-
-  // get the lengths of its 2 orthogonal sides.  Since only 1 coordinate
-  // can be different we can add the differences in all 3 directions
-  l = (pts[0][0] - pts[1][0]) + (pts[0][1] - pts[1][1]) + (pts[0][2] - pts[1][2]);
-
-  w = (pts[0][0] - pts[2][0]) + (pts[0][1] - pts[2][1]) + (pts[0][2] - pts[2][2]);
-
-  a = fabs(l * w);
-  this->Sum += a;
-  // Compute the middle, which is really just another attribute.
-  mid[0] = (pts[0][0] + pts[1][0] + pts[2][0] + pts[3][0]) * 0.25;
-  mid[1] = (pts[0][1] + pts[1][1] + pts[2][1] + pts[3][1]) * 0.25;
-  mid[2] = (pts[0][2] + pts[1][2] + pts[2][2] + pts[3][2]) * 0.25;
-  // Add weighted to sumCenter.
-  this->SumCenter[0] += mid[0] * a;
-  this->SumCenter[1] += mid[1] * a;
-  this->SumCenter[2] += mid[2] * a;
-
-  // Now integrate the rest of the attributes.
-  this->IntegrateData4(input->GetPointData(), output->GetPointData(), pt1Id, pt2Id, pt3Id, pt4Id, a,
-    *this->PointFieldList, this->FieldListIndex);
-  this->IntegrateData1(input->GetCellData(), output->GetCellData(), cellId, a, *this->CellFieldList,
-    this->FieldListIndex);
-}
-
-//-----------------------------------------------------------------------------
-void vtkIntegrateAttributes::IntegrateTriangle(vtkDataSet* input, vtkUnstructuredGrid* output,
-  vtkIdType cellId, vtkIdType pt1Id, vtkIdType pt2Id, vtkIdType pt3Id)
-{
-  double pt1[3], pt2[3], pt3[3];
-  double mid[3], v1[3], v2[3];
-  double cross[3];
-  double k;
-
-  input->GetPoint(pt1Id, pt1);
-  input->GetPoint(pt2Id, pt2);
-  input->GetPoint(pt3Id, pt3);
-
-  // Compute two legs.
-  v1[0] = pt2[0] - pt1[0];
-  v1[1] = pt2[1] - pt1[1];
-  v1[2] = pt2[2] - pt1[2];
-  v2[0] = pt3[0] - pt1[0];
-  v2[1] = pt3[1] - pt1[1];
-  v2[2] = pt3[2] - pt1[2];
-
-  // Use the cross product to compute the area of the parallelogram.
-  vtkMath::Cross(v1, v2, cross);
-  k = sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]) * 0.5;
-
-  if (k == 0.0)
-  {
-    return;
-  }
-  this->Sum += k;
-
-  // Compute the middle, which is really just another attribute.
-  mid[0] = (pt1[0] + pt2[0] + pt3[0]) / 3.0;
-  mid[1] = (pt1[1] + pt2[1] + pt3[1]) / 3.0;
-  mid[2] = (pt1[2] + pt2[2] + pt3[2]) / 3.0;
-  // Add weighted to sumCenter.
-  this->SumCenter[0] += mid[0] * k;
-  this->SumCenter[1] += mid[1] * k;
-  this->SumCenter[2] += mid[2] * k;
-
-  // Now integrate the rest of the attributes.
-  this->IntegrateData3(input->GetPointData(), output->GetPointData(), pt1Id, pt2Id, pt3Id, k,
-    *this->PointFieldList, this->FieldListIndex);
-  this->IntegrateData1(input->GetCellData(), output->GetCellData(), cellId, k, *this->CellFieldList,
-    this->FieldListIndex);
-}
-
-//-----------------------------------------------------------------------------
-void vtkIntegrateAttributes::IntegrateGeneral2DCell(
-  vtkDataSet* input, vtkUnstructuredGrid* output, vtkIdType cellId, vtkIdList* ptIds)
-{
-  vtkIdType nPnts = ptIds->GetNumberOfIds();
-  // There should be a number of points that is a multiple of 3
-  // from the triangulation
-  if (nPnts % 3)
-  {
-    vtkWarningMacro("Number of points (" << nPnts << ") is not divisiable by 3 - skipping "
-                                         << " 2D Cell: " << cellId);
-    return;
-  }
-
-  vtkIdType triIdx = 0;
-  vtkIdType pt1Id, pt2Id, pt3Id;
-
-  while (triIdx < nPnts)
-  {
-    pt1Id = ptIds->GetId(triIdx++);
-    pt2Id = ptIds->GetId(triIdx++);
-    pt3Id = ptIds->GetId(triIdx++);
-    this->IntegrateTriangle(input, output, cellId, pt1Id, pt2Id, pt3Id);
-  }
-}
-
-//-----------------------------------------------------------------------------
-// For Tetrahedral cells
-void vtkIntegrateAttributes::IntegrateTetrahedron(vtkDataSet* input, vtkUnstructuredGrid* output,
-  vtkIdType cellId, vtkIdType pt1Id, vtkIdType pt2Id, vtkIdType pt3Id, vtkIdType pt4Id)
-{
-  double pts[4][3];
-  input->GetPoint(pt1Id, pts[0]);
-  input->GetPoint(pt2Id, pts[1]);
-  input->GetPoint(pt3Id, pts[2]);
-  input->GetPoint(pt4Id, pts[3]);
-
-  double a[3], b[3], c[3], n[3], v, mid[3];
-  int i;
-  // Compute the principle vectors around pt0 and the
-  // centroid
-  for (i = 0; i < 3; i++)
-  {
-    a[i] = pts[1][i] - pts[0][i];
-    b[i] = pts[2][i] - pts[0][i];
-    c[i] = pts[3][i] - pts[0][i];
-    mid[i] = (pts[0][i] + pts[1][i] + pts[2][i] + pts[3][i]) * 0.25;
-  }
-
-  // Calculate the volume of the tet which is 1/6 * the box product
-  vtkMath::Cross(a, b, n);
-  v = vtkMath::Dot(c, n) / 6.0;
-  this->Sum += v;
-
-  // Add weighted to sumCenter.
-  this->SumCenter[0] += mid[0] * v;
-  this->SumCenter[1] += mid[1] * v;
-  this->SumCenter[2] += mid[2] * v;
-
-  // Integrate the attributes on the cell itself
-  this->IntegrateData1(input->GetCellData(), output->GetCellData(), cellId, v, *this->CellFieldList,
-    this->FieldListIndex);
-
-  // Integrate the attributes associated with the points
-  this->IntegrateData4(input->GetPointData(), output->GetPointData(), pt1Id, pt2Id, pt3Id, pt4Id, v,
-    *this->PointFieldList, this->FieldListIndex);
-}
-
-//-----------------------------------------------------------------------------
-// For axis aligned hexahedral cells
-void vtkIntegrateAttributes::IntegrateVoxel(
-  vtkDataSet* input, vtkUnstructuredGrid* output, vtkIdType cellId, vtkIdList* cellPtIds)
-{
-  vtkIdType pt1Id, pt2Id, pt3Id, pt4Id, pt5Id;
-  double pts[5][3];
-  pt1Id = cellPtIds->GetId(0);
-  pt2Id = cellPtIds->GetId(1);
-  pt3Id = cellPtIds->GetId(2);
-  pt4Id = cellPtIds->GetId(3);
-  pt5Id = cellPtIds->GetId(4);
-  input->GetPoint(pt1Id, pts[0]);
-  input->GetPoint(pt2Id, pts[1]);
-  input->GetPoint(pt3Id, pts[2]);
-  input->GetPoint(pt4Id, pts[3]);
-  input->GetPoint(pt5Id, pts[4]);
-
-  double l, w, h, v, mid[3];
-
-  // Calculate the volume of the voxel
-  l = pts[1][0] - pts[0][0];
-  w = pts[2][1] - pts[0][1];
-  h = pts[4][2] - pts[0][2];
-  v = fabs(l * w * h);
-  this->Sum += v;
-
-  // Partially Compute the middle, which is really just another attribute.
-  mid[0] = (pts[0][0] + pts[1][0] + pts[2][0] + pts[3][0]) * 0.125;
-  mid[1] = (pts[0][1] + pts[1][1] + pts[2][1] + pts[3][1]) * 0.125;
-  mid[2] = (pts[0][2] + pts[1][2] + pts[2][2] + pts[3][2]) * 0.125;
-
-  // Integrate the attributes on the cell itself
-  this->IntegrateData1(input->GetCellData(), output->GetCellData(), cellId, v, *this->CellFieldList,
-    this->FieldListIndex);
-
-  // Integrate the attributes associated with the points on the bottom face
-  // note that since IntegrateData4 is going to weigh everything by 1/4
-  // we need to pass down 1/2 the volume so they will be weighted by 1/8
-
-  this->IntegrateData4(input->GetPointData(), output->GetPointData(), pt1Id, pt2Id, pt3Id, pt4Id,
-    v * 0.5, *this->PointFieldList, this->FieldListIndex);
-
-  // Now process the top face points
-  pt1Id = cellPtIds->GetId(5);
-  pt2Id = cellPtIds->GetId(6);
-  pt3Id = cellPtIds->GetId(7);
-  input->GetPoint(pt1Id, pts[0]);
-  input->GetPoint(pt2Id, pts[1]);
-  input->GetPoint(pt3Id, pts[2]);
-  // Finish Computing the middle, which is really just another attribute.
-  mid[0] += (pts[0][0] + pts[1][0] + pts[2][0] + pts[4][0]) * 0.125;
-  mid[1] += (pts[0][1] + pts[1][1] + pts[2][1] + pts[4][1]) * 0.125;
-  mid[2] += (pts[0][2] + pts[1][2] + pts[2][2] + pts[4][2]) * 0.125;
-
-  // Add weighted to sumCenter.
-  this->SumCenter[0] += mid[0] * v;
-  this->SumCenter[1] += mid[1] * v;
-  this->SumCenter[2] += mid[2] * v;
-
-  // Integrate the attributes associated with the points on the top face
-  // note that since IntegrateData4 is going to weigh everything by 1/4
-  // we need to pass down 1/2 the volume so they will be weighted by 1/8
-  this->IntegrateData4(input->GetPointData(), output->GetPointData(), pt1Id, pt2Id, pt3Id, pt5Id,
-    v * 0.5, *this->PointFieldList, this->FieldListIndex);
-}
-
-//-----------------------------------------------------------------------------
-void vtkIntegrateAttributes::IntegrateGeneral3DCell(
-  vtkDataSet* input, vtkUnstructuredGrid* output, vtkIdType cellId, vtkIdList* ptIds)
-{
-
-  vtkIdType nPnts = ptIds->GetNumberOfIds();
-  // There should be a number of points that is a multiple of 4
-  // from the triangulation
-  if (nPnts % 4)
-  {
-    vtkWarningMacro("Number of points (" << nPnts << ") is not divisiable by 4 - skipping "
-                                         << " 3D Cell: " << cellId);
-    return;
-  }
-
-  vtkIdType tetIdx = 0;
-  vtkIdType pt1Id, pt2Id, pt3Id, pt4Id;
-
-  while (tetIdx < nPnts)
-  {
-    pt1Id = ptIds->GetId(tetIdx++);
-    pt2Id = ptIds->GetId(tetIdx++);
-    pt3Id = ptIds->GetId(tetIdx++);
-    pt4Id = ptIds->GetId(tetIdx++);
-    this->IntegrateTetrahedron(input, output, cellId, pt1Id, pt2Id, pt3Id, pt4Id);
-  }
-}
-
 //-----------------------------------------------------------------------------
 void vtkIntegrateAttributes::DivideDataArraysByConstant(
   vtkDataSetAttributes* data, bool skipLastArray, double sum)
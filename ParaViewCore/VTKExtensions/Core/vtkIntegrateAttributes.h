@@ -23,6 +23,12 @@
  * The output of this filter is a single point and vertex.  The attributes
  * for this point and cell will contain the integration results
  * for the corresponding input attributes.
+ *
+ * Blocks are integrated with vtkSMPTools, in a fixed number of chunks whose
+ * compensated (Kahan) partial sums are combined in order, so results do not
+ * depend on the number of threads. vtkImageData and vtkRectilinearGrid blocks
+ * are integrated without per-cell geometry queries. In parallel, the results
+ * of all ranks are combined on rank 0 along a binomial tree.
 */
 
 #ifndef vtkIntegrateAttributes_h
@@ -32,7 +38,6 @@
 #include "vtkUnstructuredGridAlgorithm.h"
 
 class vtkDataSet;
-class vtkIdList;
 class vtkInformation;
 class vtkInformationVector;
 class vtkDataSetAttributes;
@@ -78,30 +83,10 @@ protected:
 
   bool DivideAllCellDataByVolume;
 
-  void IntegratePolyLine(
-    vtkDataSet* input, vtkUnstructuredGrid* output, vtkIdType cellId, vtkIdList* cellPtIds);
-  void IntegratePolygon(
-    vtkDataSet* input, vtkUnstructuredGrid* output, vtkIdType cellId, vtkIdList* cellPtIds);
-  void IntegrateTriangleStrip(
-    vtkDataSet* input, vtkUnstructuredGrid* output, vtkIdType cellId, vtkIdList* cellPtIds);
-  void IntegrateTriangle(vtkDataSet* input, vtkUnstructuredGrid* output, vtkIdType cellId,
-    vtkIdType pt1Id, vtkIdType pt2Id, vtkIdType pt3Id);
-  void IntegrateTetrahedron(vtkDataSet* input, vtkUnstructuredGrid* output, vtkIdType cellId,
-    vtkIdType pt1Id, vtkIdType pt2Id, vtkIdType pt3Id, vtkIdType pt4Id);
-  void IntegratePixel(
-    vtkDataSet* input, vtkUnstructuredGrid* output, vtkIdType cellId, vtkIdList* cellPtIds);
-  void IntegrateVoxel(
-    vtkDataSet* input, vtkUnstructuredGrid* output, vtkIdType cellId, vtkIdList* cellPtIds);
-  void IntegrateGeneral1DCell(
-    vtkDataSet* input, vtkUnstructuredGrid* output, vtkIdType cellId, vtkIdList* cellPtIds);
-  void IntegrateGeneral2DCell(
-    vtkDataSet* input, vtkUnstructuredGrid* output, vtkIdType cellId, vtkIdList* cellPtIds);
-  void IntegrateGeneral3DCell(
-    vtkDataSet* input, vtkUnstructuredGrid* output, vtkIdType cellId, vtkIdList* cellPtIds);
   void IntegrateSatelliteData(vtkDataSetAttributes* inda, vtkDataSetAttributes* outda);
   void ZeroAttributes(vtkDataSetAttributes* outda);
-  int PieceNodeMinToNode0(vtkUnstructuredGrid* data);
-  void SendPiece(vtkUnstructuredGrid* src);
+  void ReducePiecesToNode0(vtkUnstructuredGrid* data);
+  void SendPiece(vtkUnstructuredGrid* src, int toId);
   void ReceivePiece(vtkUnstructuredGrid* mergeTo, int fromId);
 
   // This function assumes the data is in the format of the output of this filter with one
@@ -116,24 +101,11 @@ private:
   void operator=(const vtkIntegrateAttributes&) = delete;
 
   class vtkFieldList;
-  vtkFieldList* CellFieldList;
-  vtkFieldList* PointFieldList;
-  int FieldListIndex;
 
   void AllocateAttributes(vtkFieldList& fieldList, vtkDataSetAttributes* outda);
   void ExecuteBlock(vtkDataSet* input, vtkUnstructuredGrid* output, int fieldset_index,
     vtkFieldList& pdList, vtkFieldList& cdList);
 
-  void IntegrateData1(vtkDataSetAttributes* inda, vtkDataSetAttributes* outda, vtkIdType pt1Id,
-    double k, vtkFieldList& fieldlist, int fieldlist_index);
-  void IntegrateData2(vtkDataSetAttributes* inda, vtkDataSetAttributes* outda, vtkIdType pt1Id,
-    vtkIdType pt2Id, double k, vtkFieldList& fieldlist, int fieldlist_index);
-  void IntegrateData3(vtkDataSetAttributes* inda, vtkDataSetAttributes* outda, vtkIdType pt1Id,
-    vtkIdType pt2Id, vtkIdType pt3Id, double k, vtkFieldList& fieldlist, int fieldlist_index);
-  void IntegrateData4(vtkDataSetAttributes* inda, vtkDataSetAttributes* outda, vtkIdType pt1Id,
-    vtkIdType pt2Id, vtkIdType pt3Id, vtkIdType pt4Id, double k, vtkFieldList& fieldlist,
-    int fieldlist_index);
-
 public:
   enum CommunicationIds
   {
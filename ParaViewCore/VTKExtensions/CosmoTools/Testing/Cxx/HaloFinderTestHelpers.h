@@ -15,6 +15,7 @@
 
 #include "vtkActor.h"
 #include "vtkCompositePolyDataMapper2.h"
+#include "vtkDataArray.h"
 #include "vtkMaskPoints.h"
 #include "vtkNew.h"
 #include "vtkPANLHaloFinder.h"
@@ -103,6 +104,37 @@ inline bool pointDataHasTheseArrays(vtkPointData* pd, const std::set<std::string
   return true;
 }
 
+// Executes the halo finder again without multithreading and checks that the
+// array of the given output does not change.
+inline bool sameArrayWhenSerial(vtkPANLHaloFinder* haloFinder, int port, const char* arrayName)
+{
+  vtkDataArray* array = haloFinder->GetOutput(port)->GetPointData()->GetArray(arrayName);
+  vtkSmartPointer<vtkDataArray> threaded;
+  threaded.TakeReference(array->NewInstance());
+  threaded->DeepCopy(array);
+
+  haloFinder->UseMultithreadingOff();
+  haloFinder->Update();
+  array = haloFinder->GetOutput(port)->GetPointData()->GetArray(arrayName);
+  bool same = array->GetNumberOfTuples() == threaded->GetNumberOfTuples() &&
+    array->GetNumberOfComponents() == threaded->GetNumberOfComponents();
+  for (vtkIdType i = 0; same && i < array->GetNumberOfTuples(); ++i)
+  {
+    for (int j = 0; j < array->GetNumberOfComponents(); ++j)
+    {
+      same = same && array->GetComponent(i, j) == threaded->GetComponent(i, j);
+    }
+  }
+  if (!same)
+  {
+    std::cerr << "Array " << arrayName << " differs when multithreaded." << std::endl;
+  }
+
+  haloFinder->UseMultithreadingOn();
+  haloFinder->Update();
+  return same;
+}
+
 inline HaloFinderTestVTKObjects SetupHaloFinderTest(int argc, char* argv[],
   vtkPANLHaloFinder::CenterFindingType centerFinding = vtkPANLHaloFinder::NONE,
   bool findSubhalos = false)
@@ -0,0 +1,208 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestGenericIOReadWrite.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include <mpi.h>
+
+#include "vtkDataArraySelection.h"
+#include "vtkDoubleArray.h"
+#include "vtkFieldData.h"
+#include "vtkFloatArray.h"
+#include "vtkIntArray.h"
+#include "vtkMPIController.h"
+#include "vtkMultiBlockDataSet.h"
+#include "vtkNew.h"
+#include "vtkPGenericIOMultiBlockWriter.h"
+#include "vtkPGenericIOReader.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkTestUtilities.h"
+#include "vtkTypeInt64Array.h"
+#include "vtkUnsignedLongLongArray.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <string>
+
+#define TEST_SUCCESS 0
+#define TEST_FAILED 1
+
+namespace
+{
+// GenericIO writes the CRC of each block right after the values it reads, so
+// every read goes past the last particle of the array it reads into.
+const int ParticlesPerBlock = 37;
+
+void AddFieldData(vtkFieldData* fd, const char* name, double x, double y, double z)
+{
+  vtkNew<vtkDoubleArray> array;
+  array->SetName(name);
+  array->SetNumberOfComponents(3);
+  array->InsertNextTuple3(x, y, z);
+  fd->AddArray(array.GetPointer());
+}
+
+void AddUInt64FieldData(vtkFieldData* fd, const char* name, unsigned long long z)
+{
+  vtkNew<vtkUnsignedLongLongArray> array;
+  array->SetName(name);
+  array->SetNumberOfComponents(3);
+  unsigned long long values[3] = { 1, 1, z };
+  array->InsertNextTypedTuple(values);
+  fd->AddArray(array.GetPointer());
+}
+
+// Each process writes one block; particle g of the file has the coordinates
+// (g, 2g, -g) and arrays derived from g.
+void CreateInput(int myId, int numProcs, vtkMultiBlockDataSet* input)
+{
+  AddFieldData(input->GetFieldData(), "genericio_phys_origin", 0, 0, 0);
+  AddFieldData(input->GetFieldData(), "genericio_phys_scale", 1, 1, 1);
+  AddUInt64FieldData(input->GetFieldData(), "genericio_global_dimensions", numProcs);
+
+  vtkNew<vtkUnstructuredGrid> grid;
+  vtkNew<vtkPoints> points;
+  points->SetDataTypeToDouble();
+  points->SetNumberOfPoints(ParticlesPerBlock);
+  vtkNew<vtkDoubleArray> mass;
+  mass->SetName("mass");
+  mass->SetNumberOfTuples(ParticlesPerBlock);
+  vtkNew<vtkFloatArray> density;
+  density->SetName("density");
+  density->SetNumberOfTuples(ParticlesPerBlock);
+  vtkNew<vtkTypeInt64Array> tag;
+  tag->SetName("tag");
+  tag->SetNumberOfTuples(ParticlesPerBlock);
+  vtkNew<vtkIntArray> count;
+  count->SetName("count");
+  count->SetNumberOfTuples(ParticlesPerBlock);
+  for (int ii = 0; ii < ParticlesPerBlock; ++ii)
+  {
+    const int g = myId * ParticlesPerBlock + ii;
+    points->SetPoint(ii, g, 2.0 * g, -g);
+    mass->SetValue(ii, g + 0.25);
+    density->SetValue(ii, 0.5f * g);
+    tag->SetValue(ii, g);
+    count->SetValue(ii, 3 * g);
+  }
+  grid->SetPoints(points.GetPointer());
+  grid->GetPointData()->AddArray(mass.GetPointer());
+  grid->GetPointData()->AddArray(density.GetPointer());
+  grid->GetPointData()->AddArray(tag.GetPointer());
+  grid->GetPointData()->AddArray(count.GetPointer());
+  AddUInt64FieldData(grid->GetFieldData(), "genericio_block_coords", myId);
+
+  input->SetNumberOfBlocks(numProcs);
+  input->SetBlock(myId, grid.GetPointer());
+}
+
+// Checks the particles read by this process, and counts them and sums their
+// tags so that the caller can check that every particle was read once.
+bool CheckOutput(vtkUnstructuredGrid* output, double& count, double& tagSum)
+{
+  vtkPointData* pd = output->GetPointData();
+  vtkDataArray* mass = pd->GetArray("mass");
+  vtkDataArray* density = pd->GetArray("density");
+  vtkDataArray* tag = pd->GetArray("tag");
+  vtkDataArray* counts = pd->GetArray("count");
+  const vtkIdType numPoints = output->GetNumberOfPoints();
+  if (!mass || !density || !tag || !counts)
+  {
+    cerr << "Missing arrays." << endl;
+    return false;
+  }
+  if (mass->GetNumberOfTuples() != numPoints || density->GetNumberOfTuples() != numPoints ||
+    tag->GetNumberOfTuples() != numPoints || counts->GetNumberOfTuples() != numPoints)
+  {
+    cerr << "Arrays do not have one value per particle." << endl;
+    return false;
+  }
+  count = static_cast<double>(numPoints);
+  tagSum = 0.0;
+  for (vtkIdType ii = 0; ii < numPoints; ++ii)
+  {
+    const double g = tag->GetComponent(ii, 0);
+    double pt[3];
+    output->GetPoint(ii, pt);
+    if (pt[0] != g || pt[1] != 2.0 * g || pt[2] != -g || mass->GetComponent(ii, 0) != g + 0.25 ||
+      density->GetComponent(ii, 0) != 0.5 * g || counts->GetComponent(ii, 0) != 3.0 * g)
+    {
+      cerr << "Wrong values for particle " << g << endl;
+      return false;
+    }
+    tagSum += g;
+  }
+  return true;
+}
+}
+
+int TestGenericIOReadWrite(int argc, char* argv[])
+{
+  MPI_Init(&argc, &argv);
+
+  vtkNew<vtkMPIController> controller;
+  controller->Initialize();
+  vtkMultiProcessController::SetGlobalController(controller.GetPointer());
+  const int myId = controller->GetLocalProcessId();
+  const int numProcs = controller->GetNumberOfProcesses();
+
+  char* tempDir =
+    vtkTestUtilities::GetArgOrEnvOrDefault("-T", argc, argv, "VTK_TEMP_DIR", "Testing/Temporary");
+  const std::string fileName = std::string(tempDir) + "/TestGenericIOReadWrite.gio";
+  delete[] tempDir;
+
+  vtkNew<vtkMultiBlockDataSet> input;
+  CreateInput(myId, numProcs, input.GetPointer());
+  vtkNew<vtkPGenericIOMultiBlockWriter> writer;
+  writer->SetFileName(fileName.c_str());
+  writer->SetInputData(input.GetPointer());
+  writer->Write();
+  controller->Barrier();
+
+  vtkNew<vtkPGenericIOReader> reader;
+  reader->SetController(controller.GetPointer());
+  reader->SetFileName(fileName.c_str());
+  reader->SetGenericIOType(vtkPGenericIOReader::IOTYPEMPI);
+  reader->SetXAxisVariableName("x");
+  reader->SetYAxisVariableName("y");
+  reader->SetZAxisVariableName("z");
+  reader->UpdateInformation();
+  reader->GetPointDataArraySelection()->EnableAllArrays();
+  reader->Update();
+
+  double local[3] = { 1, 0, 0 };
+  local[0] = CheckOutput(reader->GetOutput(), local[1], local[2]) ? 1 : 0;
+  double valid = 0, total = 0, tagSum = 0;
+  controller->AllReduce(&local[0], &valid, 1, vtkCommunicator::MIN_OP);
+  controller->AllReduce(&local[1], &total, 1, vtkCommunicator::SUM_OP);
+  controller->AllReduce(&local[2], &tagSum, 1, vtkCommunicator::SUM_OP);
+
+  const double numParticles = static_cast<double>(numProcs) * ParticlesPerBlock;
+  int retVal = TEST_SUCCESS;
+  if (valid == 0)
+  {
+    retVal = TEST_FAILED;
+  }
+  else if (total != numParticles || tagSum != numParticles * (numParticles - 1) / 2)
+  {
+    if (myId == 0)
+    {
+      cerr << "Read " << total << " particles, expected " << numParticles << endl;
+    }
+    retVal = TEST_FAILED;
+  }
+
+  vtkMultiProcessController::SetGlobalController(NULL);
+  controller->Finalize();
+  return retVal;
+}
@@ -0,0 +1,139 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestHaloFinderReexecute.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include <mpi.h>
+
+#include "HaloFinderTestHelpers.h"
+
+#include "vtkMPIController.h"
+
+namespace
+{
+void SetupHaloFinder(vtkPANLHaloFinder* haloFinder)
+{
+  haloFinder->SetRL(128);
+  haloFinder->SetParticleMass(13070871810);
+  haloFinder->SetNP(128);
+  haloFinder->SetPMin(100);
+  haloFinder->SetCenterFindingMode(vtkPANLHaloFinder::MOST_BOUND_PARTICLE);
+  haloFinder->SetOmegaDM(0.2068);
+  haloFinder->SetDeut(0.0224);
+  haloFinder->SetHubble(0.72);
+}
+
+// The halo summaries of a halo finder that executed before must be exactly
+// the ones of a new halo finder.
+bool SameSummaries(vtkUnstructuredGrid* reused, vtkUnstructuredGrid* fresh)
+{
+  if (reused->GetNumberOfPoints() != fresh->GetNumberOfPoints())
+  {
+    std::cerr << "Got " << reused->GetNumberOfPoints() << " halos, expected "
+              << fresh->GetNumberOfPoints() << std::endl;
+    return false;
+  }
+  if (fresh->GetNumberOfPoints() == 0)
+  {
+    std::cerr << "No halos found." << std::endl;
+    return false;
+  }
+  std::set<std::string> names = HaloFinderTestHelpers::getHaloSummaryWithCenterInfoArrays();
+  for (std::set<std::string>::iterator itr = names.begin(); itr != names.end(); ++itr)
+  {
+    vtkDataArray* first = reused->GetPointData()->GetArray(itr->c_str());
+    vtkDataArray* second = fresh->GetPointData()->GetArray(itr->c_str());
+    if (!first || !second || first->GetNumberOfComponents() != second->GetNumberOfComponents())
+    {
+      std::cerr << "Array " << *itr << " is missing or has another size." << std::endl;
+      return false;
+    }
+    for (vtkIdType i = 0; i < fresh->GetNumberOfPoints(); ++i)
+    {
+      for (int j = 0; j < first->GetNumberOfComponents(); ++j)
+      {
+        if (first->GetComponent(i, j) != second->GetComponent(i, j))
+        {
+          std::cerr << "Array " << *itr << " differs for halo " << i << std::endl;
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+int runHaloFinderTest(int argc, char* argv[])
+{
+  char* fname = vtkTestUtilities::ExpandDataFileName(argc, argv, "genericio/m000.499.allparticles");
+  vtkNew<vtkPGenericIOReader> reader;
+  reader->SetFileName(fname);
+  reader->UpdateInformation();
+  reader->SetXAxisVariableName("x");
+  reader->SetYAxisVariableName("y");
+  reader->SetZAxisVariableName("z");
+  reader->SetPointArrayStatus("vx", 1);
+  reader->SetPointArrayStatus("vy", 1);
+  reader->SetPointArrayStatus("vz", 1);
+  reader->SetPointArrayStatus("id", 1);
+  reader->Update();
+  delete[] fname;
+
+  // Another input: the particles with the lower half of the ids.
+  vtkDataArray* ids = reader->GetOutput()->GetPointData()->GetArray("id");
+  if (!ids || ids->GetNumberOfTuples() == 0)
+  {
+    std::cerr << "Error at line: " << __LINE__ << std::endl;
+    return 0;
+  }
+  double range[2];
+  ids->GetRange(range);
+  vtkNew<vtkThreshold> half;
+  half->SetInputConnection(reader->GetOutputPort());
+  half->SetInputArrayToProcess(0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_POINTS, "id");
+  half->ThresholdByLower(0.5 * (range[0] + range[1]));
+
+  vtkNew<vtkPANLHaloFinder> reused;
+  SetupHaloFinder(reused.GetPointer());
+  reused->SetInputConnection(reader->GetOutputPort());
+  reused->Update();
+  reused->SetInputConnection(half->GetOutputPort());
+  reused->Update();
+
+  vtkNew<vtkPANLHaloFinder> fresh;
+  SetupHaloFinder(fresh.GetPointer());
+  fresh->SetInputConnection(half->GetOutputPort());
+  fresh->Update();
+
+  if (!SameSummaries(reused->GetOutput(1), fresh->GetOutput(1)))
+  {
+    std::cerr << "Error at line: " << __LINE__ << std::endl;
+    return 0;
+  }
+  return 1;
+}
+}
+
+int TestHaloFinderReexecute(int argc, char* argv[])
+{
+  MPI_Init(&argc, &argv);
+
+  vtkNew<vtkMPIController> controller;
+  controller->Initialize();
+  vtkMultiProcessController::SetGlobalController(controller.GetPointer());
+
+  int retVal = runHaloFinderTest(argc, argv);
+
+  controller->Finalize();
+  return !retVal;
+}
@@ -67,6 +67,12 @@ int runHaloFinderTest(int argc, char* argv[])
     std::cerr << "Error at line: " << __LINE__ << std::endl;
     return 0;
   }
+  if (!HaloFinderTestHelpers::sameArrayWhenSerial(to.haloFinder, 0, "subhalo_tag") ||
+    !HaloFinderTestHelpers::sameArrayWhenSerial(to.haloFinder, 2, "subhalo_mass"))
+  {
+    std::cerr << "Error at line: " << __LINE__ << std::endl;
+    return 0;
+  }
 
   to.onlyPointsInHalos->SetInputArrayToProcess(
     0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_POINTS, "subhalo_tag");
@@ -43,6 +43,11 @@ int runHaloFinderTest(int argc, char* argv[])
     std::cerr << "Error at line: " << __LINE__ << std::endl;
     return 0;
   }
+  if (!HaloFinderTestHelpers::sameArrayWhenSerial(to.haloFinder, 1, "fof_center"))
+  {
+    std::cerr << "Error at line: " << __LINE__ << std::endl;
+    return 0;
+  }
 
   vtkNew<vtkArrayCalculator> calc;
   calc->SetInputConnection(to.haloFinder->GetOutputPort(1));
@@ -46,57 +46,63 @@ MPI_Comm GetMPICommunicator(vtkMultiProcessController* mpc)
 }
 
 //==============================================================================
-vtkDataArray* GetVtkDataArray(std::string name, int type, void* rawBuffer, int N)
+vtkDataArray* CreateVtkDataArray(const std::string& name, int type, int N)
 {
-  assert("pre: cannot read from null buffer!" && (rawBuffer != NULL));
   vtkDataArray* dataArray = NULL;
-  size_t dataSize = 0;
 
   switch (type)
   {
     case gio::GENERIC_IO_INT32_TYPE:
       dataArray = vtkDataArray::CreateDataArray(VTK_TYPE_INT32);
-      dataSize = sizeof(vtkTypeInt32);
       break;
     case gio::GENERIC_IO_INT64_TYPE:
       dataArray = vtkDataArray::CreateDataArray(VTK_TYPE_INT64);
       // i.e., don't run this on windows
       assert(sizeof(vtkTypeInt64) == sizeof(uint64_t));
-      dataSize = sizeof(vtkTypeInt64);
       break;
     case gio::GENERIC_IO_UINT32_TYPE:
       dataArray = vtkDataArray::CreateDataArray(VTK_TYPE_UINT32);
-      dataSize = sizeof(vtkTypeUInt32);
       break;
     case gio::GENERIC_IO_UINT64_TYPE:
       dataArray = vtkDataArray::CreateDataArray(VTK_TYPE_UINT64);
       // i.e., don't run this on windows
       assert(sizeof(vtkTypeUInt64) == sizeof(uint64_t));
-      dataSize = sizeof(vtkTypeUInt64);
       break;
     case gio::GENERIC_IO_DOUBLE_TYPE:
       dataArray = vtkDataArray::CreateDataArray(VTK_DOUBLE);
-      dataSize = sizeof(double);
       break;
     case gio::GENERIC_IO_FLOAT_TYPE:
       dataArray = vtkDataArray::CreateDataArray(VTK_FLOAT);
-      dataSize = sizeof(float);
       break;
     default:
-      dataSize = 0;
       return NULL;
   } // END switch
 
   assert("pre: null data array!" && (dataArray != NULL));
 
+  // GenericIO writes the CRC of each block right after the values it reads,
+  // so the array has room for it past its last tuple.
+  const int typeSize = dataArray->GetDataTypeSize();
   dataArray->SetNumberOfComponents(1);
-  dataArray->SetNumberOfTuples(N);
-  dataArray->SetName(name.c_str());
+  dataArray->Allocate(N + (gio::CRCSize + typeSize - 1) / typeSize);
   if (N > 0)
+  {
+    dataArray->SetNumberOfTuples(N);
+  }
+  dataArray->SetName(name.c_str());
+  return (dataArray);
+}
+
+//==============================================================================
+vtkDataArray* GetVtkDataArray(std::string name, int type, void* rawBuffer, int N)
+{
+  assert("pre: cannot read from null buffer!" && (rawBuffer != NULL));
+  vtkDataArray* dataArray = CreateVtkDataArray(name, type, N);
+  if (dataArray != NULL && N > 0)
   {
     void* dataBuffer = dataArray->GetVoidPointer(0);
     assert("pre: encountered NULL data buffer!" && (dataBuffer != NULL));
-    memcpy(dataBuffer, rawBuffer, N * dataSize);
+    memcpy(dataBuffer, rawBuffer, N * dataArray->GetDataTypeSize());
   }
   return (dataArray);
 }
@@ -86,6 +86,16 @@ inline std::string& trim(std::string& s)
  */
 MPI_Comm GetMPICommunicator(vtkMultiProcessController* mpc);
 
+//==============================================================================
+/**
+ * This method creates a single component vtkDataArray of N tuples, with the
+ * VTK type matching the given GenericIO type, that GenericIO can read the
+ * variable into directly. The array is allocated with gio::CRCSize extra bytes
+ * past the N tuples, since GenericIO writes the block CRC there. Returns NULL
+ * if the type is not supported.
+ */
+vtkDataArray* CreateVtkDataArray(const std::string& name, int type, int N);
+
 //==============================================================================
 /**
  * This method parses the data in the rawbuffer and reads it into a vtkDataArray
@@ -25,6 +25,8 @@
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPoints.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 #include "vtkTypeInt64Array.h"
 #include "vtkUnstructuredGrid.h"
 
@@ -119,6 +121,176 @@ private:
   std::vector<POSVEL_T> mass;
   std::vector<ID_T> id;
 };
+
+// Finds the center of a range of FOF halos. Halos are independent, so each
+// thread extracts them into its own copy of the ExtractHalo buffers and runs
+// its own center finder.
+class FindHaloCenters
+{
+public:
+  FindHaloCenters(const ExtractHalo& exemplar)
+    : HaloData(exemplar)
+  {
+  }
+
+  vtkSMPThreadLocal<ExtractHalo> HaloData;
+  vtkPoints* Points;
+  float* Centers;
+  int Mode;
+  double BB;
+  double SmoothingLength;
+  double DistanceConvertFactor;
+  double RL;
+  int NP;
+  double OmegaMatter;
+  double OmegaCB;
+  double Hubble;
+  double RedShift;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    ExtractHalo& haloData = this->HaloData.Local();
+    for (vtkIdType halo = begin; halo < end; ++halo)
+    {
+      haloData.SetCurrentHalo(halo);
+      cosmotk::HaloCenterFinder centerFinder;
+      haloData.SetParticles(centerFinder);
+      centerFinder.setParameters(this->BB, this->SmoothingLength, this->DistanceConvertFactor,
+        this->RL, this->NP, this->OmegaMatter, this->OmegaCB, this->Hubble, this->RedShift);
+      int centerIndex = -1;
+      if (this->Mode == vtkPANLHaloFinder::MOST_BOUND_PARTICLE)
+      {
+        float minPotential;
+        if (haloData.GetNumberOfParticlesInCurrentHalo() < MBP_THRESHOLD)
+        {
+          centerIndex = centerFinder.mostBoundParticleN2(&minPotential);
+        }
+        else
+        {
+          centerIndex = centerFinder.mostBoundParticleAStar(&minPotential);
+        }
+      }
+      else if (this->Mode == vtkPANLHaloFinder::MOST_CONNECTED_PARTICLE)
+      {
+        if (haloData.GetNumberOfParticlesInCurrentHalo() < MCP_THRESHOLD)
+        {
+          centerIndex = centerFinder.mostConnectedParticleN2();
+        }
+        else
+        {
+          centerIndex = centerFinder.mostConnectedParticleChainMesh();
+        }
+      }
+      else
+      {
+        centerIndex = centerFinder.mostConnectedParticleHist();
+      }
+      float* center = this->Centers + 3 * halo;
+      center[0] = center[1] = center[2] = 0.0;
+      if (centerIndex >= 0)
+      {
+        double point[3];
+        this->Points->GetPoint(haloData.GetActualIndex(centerIndex), point);
+        center[0] = point[0];
+        center[1] = point[1];
+        center[2] = point[2];
+      }
+    }
+  }
+};
+
+// Subhalos found in one FOF halo. They are kept until all halos are
+// processed so that they are appended to the output in the order of the
+// halos, whatever the order in which threads processed them.
+class SubhaloResults
+{
+public:
+  std::vector<int> Count;
+  std::vector<POSVEL_T> Mass;
+  std::vector<POSVEL_T> XPos;
+  std::vector<POSVEL_T> YPos;
+  std::vector<POSVEL_T> ZPos;
+  std::vector<POSVEL_T> XCofMass;
+  std::vector<POSVEL_T> YCofMass;
+  std::vector<POSVEL_T> ZCofMass;
+  std::vector<POSVEL_T> XVel;
+  std::vector<POSVEL_T> YVel;
+  std::vector<POSVEL_T> ZVel;
+  std::vector<POSVEL_T> VelDisp;
+  // index in the input and subhalo id of each particle of the halo
+  std::vector<int> ParticleIndices;
+  std::vector<ID_T> ParticleSubhaloIds;
+};
+
+// Runs the subhalo finder on a range of the large FOF halos.
+class FindSubhalos
+{
+public:
+  FindSubhalos(const ExtractHalo& exemplar)
+    : HaloData(exemplar)
+  {
+  }
+
+  vtkSMPThreadLocal<ExtractHalo> HaloData;
+  cosmotk::CosmoHaloFinderP* HaloFinder;
+  const std::vector<int>* Halos;
+  std::vector<SubhaloResults>* Results;
+  float ParticleMass;
+  double AlphaFactor;
+  double BetaFactor;
+  int MinCandidateSize;
+  int NumSPHNeighbors;
+  int NumNeighbors;
+  double RL;
+  double DeadSize;
+  double BB;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    ExtractHalo& haloData = this->HaloData.Local();
+    for (vtkIdType idx = begin; idx < end; ++idx)
+    {
+      const int halo = (*this->Halos)[idx];
+      SubhaloResults& results = (*this->Results)[idx];
+      haloData.SetCurrentHalo(halo);
+
+      cosmotk::SubHaloFinder subFinder;
+      subFinder.setParameters(this->ParticleMass, GRAVITY_C, this->AlphaFactor, this->BetaFactor,
+        this->MinCandidateSize, this->NumSPHNeighbors, this->NumNeighbors);
+
+      haloData.SetParticles(subFinder);
+      subFinder.findSubHalos();
+
+      int numberOfSubHalos = subFinder.getNumberOfSubhalos();
+      int* fofSubHalos = subFinder.getSubhalos();
+      int* fofSubHaloCount = subFinder.getSubhaloCount();
+      int* fofSubHaloList = subFinder.getSubhaloList();
+      results.Count.assign(fofSubHaloCount, fofSubHaloCount + numberOfSubHalos);
+
+      cosmotk::FOFHaloProperties subhaloProperties;
+      subhaloProperties.setHalos(numberOfSubHalos, fofSubHalos, fofSubHaloCount, fofSubHaloList);
+      subhaloProperties.setParameters("", this->RL, this->DeadSize, this->BB);
+      haloData.SetParticles(subhaloProperties);
+
+      subhaloProperties.FOFHaloMass(&results.Mass);
+      subhaloProperties.FOFPosition(&results.XPos, &results.YPos, &results.ZPos);
+      subhaloProperties.FOFCenterOfMass(&results.XCofMass, &results.YCofMass, &results.ZCofMass);
+      subhaloProperties.FOFVelocity(&results.XVel, &results.YVel, &results.ZVel);
+      subhaloProperties.FOFVelocityDispersion(
+        &results.XVel, &results.YVel, &results.ZVel, &results.VelDisp);
+
+      std::vector<POSVEL_T> shX, shY, shZ, shVX, shVY, shVZ;
+      std::vector<ID_T> shTag, shHID;
+      subFinder.getSubhaloCosmoData(this->HaloFinder->getHaloID(halo), shX, shY, shZ, shVX,
+        shVY, shVZ, shTag, shHID, results.ParticleSubhaloIds);
+      results.ParticleIndices.resize(results.ParticleSubhaloIds.size());
+      for (size_t i = 0; i < results.ParticleIndices.size(); ++i)
+      {
+        results.ParticleIndices[i] = haloData.GetActualIndex(i);
+      }
+    }
+  }
+};
 }
 
 class vtkPANLHaloFinder::vtkInternals
@@ -173,7 +345,7 @@ public:
 
   void reserveForInputData(vtkIdType numPts)
   {
-    if (numPts > 0 && this->xx.capacity() < static_cast<size_t>(numPts))
+    if (numPts > 0 && this->xx.size() < static_cast<size_t>(numPts))
     {
       this->xx.resize(numPts);
       this->yy.resize(numPts);
@@ -192,7 +364,28 @@ public:
     this->vx.clear();
     this->vy.clear();
     this->vz.clear();
+    this->mass.clear();
     this->tag.clear();
+    this->mask.clear();
+    this->potential.clear();
+    this->status.clear();
+    // the FOF halo properties append to these
+    this->center.clear();
+    this->fofMass.clear();
+    this->fofXPos.clear();
+    this->fofYPos.clear();
+    this->fofZPos.clear();
+    this->fofXCofMass.clear();
+    this->fofYCofMass.clear();
+    this->fofZCofMass.clear();
+    this->fofXVel.clear();
+    this->fofYVel.clear();
+    this->fofZVel.clear();
+    this->fofVelDisp.clear();
+    delete this->fof;
+    this->fof = NULL;
+    delete this->haloFinder;
+    this->haloFinder = NULL;
   }
 };
 
@@ -219,6 +412,7 @@ vtkStandardNewMacro(vtkPANLHaloFinder)
   this->MinCandidateSize = 200;
   this->NumSPHNeighbors = 64;
   this->NumNeighbors = 20;
+  this->UseMultithreading = true;
 
   this->CenterFindingMode = NONE;
   this->SmoothingLength = 0.0;
@@ -237,6 +431,7 @@ vtkPANLHaloFinder::~vtkPANLHaloFinder()
 void vtkPANLHaloFinder::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "UseMultithreading: " << this->UseMultithreading << endl;
 }
 
 int vtkPANLHaloFinder::RequestInformation(
@@ -271,6 +466,9 @@ int vtkPANLHaloFinder::RequestData(
 
   cosmotk::Partition::initialize();
 
+  // the particles of a previous execution must not be distributed again
+  this->Internal->clear();
+
   if (grid != NULL)
   {
     this->ExtractDataArrays(grid, 0);
@@ -497,9 +695,6 @@ void vtkPANLHaloFinder::ExecuteSubHaloFinder(
   std::vector<POSVEL_T> subRadius, subMass, subCenterOfMassX, subCenterOfMassY, subCenterOfMassZ,
     subAvgX, subAvgY, subAvgZ, subAvgVX, subAvgVY, subAvgVZ, subVelDisp;
 
-  std::vector<POSVEL_T> shX, shY, shZ, shVX, shVY, shVZ;
-  std::vector<ID_T> shTag, shHID, shID;
-
   vtkNew<vtkTypeInt64Array> subhaloId;
   subhaloId->SetName("subhalo_tag");
   subhaloId->SetNumberOfTuples(this->Internal->xx.size());
@@ -510,81 +705,66 @@ void vtkPANLHaloFinder::ExecuteSubHaloFinder(
 
   int numberOfFOFHalos = this->Internal->haloFinder->getNumberOfHalos();
   int* fofHaloCount = this->Internal->haloFinder->getHaloCount();
-  ExtractHalo haloData(numberOfFOFHalos, fofHaloCount, this->Internal->fof);
-
+  std::vector<int> largeHalos;
   for (int halo = 0; halo < numberOfFOFHalos; ++halo)
   {
-    long particleCount = fofHaloCount[halo];
-    if (particleCount > this->MinFOFSubhaloSize)
+    if (fofHaloCount[halo] > this->MinFOFSubhaloSize)
     {
-      haloData.SetCurrentHalo(halo);
-
-      cosmotk::SubHaloFinder subFinder;
-      subFinder.setParameters(this->ParticleMass, GRAVITY_C, this->AlphaFactor, this->BetaFactor,
-        this->MinCandidateSize, this->NumSPHNeighbors, this->NumNeighbors);
-
-      haloData.SetParticles(subFinder);
-      subFinder.findSubHalos();
-
-      int numberOfSubHalos = subFinder.getNumberOfSubhalos();
-      int* fofSubHalos = subFinder.getSubhalos();
-      int* fofSubHaloCount = subFinder.getSubhaloCount();
-      int* fofSubHaloList = subFinder.getSubhaloList();
-
-      cosmotk::FOFHaloProperties subhaloProperties;
-      subhaloProperties.setHalos(numberOfSubHalos, fofSubHalos, fofSubHaloCount, fofSubHaloList);
-      subhaloProperties.setParameters("", this->RL, this->DeadSize, this->BB);
-      haloData.SetParticles(subhaloProperties);
-
-      std::vector<POSVEL_T> subhaloMass;
-      subhaloProperties.FOFHaloMass(&subhaloMass);
-
-      std::vector<POSVEL_T> subhaloXPos;
-      std::vector<POSVEL_T> subhaloYPos;
-      std::vector<POSVEL_T> subhaloZPos;
-      subhaloProperties.FOFPosition(&subhaloXPos, &subhaloYPos, &subhaloZPos);
-
-      std::vector<POSVEL_T> subhaloXCofMass;
-      std::vector<POSVEL_T> subhaloYCofMass;
-      std::vector<POSVEL_T> subhaloZCofMass;
-      subhaloProperties.FOFCenterOfMass(&subhaloXCofMass, &subhaloYCofMass, &subhaloZCofMass);
-
-      std::vector<POSVEL_T> subhaloXVel;
-      std::vector<POSVEL_T> subhaloYVel;
-      std::vector<POSVEL_T> subhaloZVel;
-      subhaloProperties.FOFVelocity(&subhaloXVel, &subhaloYVel, &subhaloZVel);
-
-      std::vector<POSVEL_T> subhaloVelDisp;
-      subhaloProperties.FOFVelocityDispersion(
-        &subhaloXVel, &subhaloYVel, &subhaloZVel, &subhaloVelDisp);
-
-      for (int sidx = 0; sidx < numberOfSubHalos; ++sidx)
-      {
-        parentHaloTag.push_back(this->Internal->haloFinder->getHaloID(halo));
-        parentFOFCount.push_back(particleCount);
-        subHaloTag.push_back(sidx);
-        subCount.push_back(fofSubHaloCount[sidx]);
-        subMass.push_back(subhaloMass[sidx]);
-        subCenterOfMassX.push_back(subhaloXCofMass[sidx]);
-        subCenterOfMassY.push_back(subhaloYCofMass[sidx]);
-        subCenterOfMassZ.push_back(subhaloZCofMass[sidx]);
-        subAvgX.push_back(subhaloXPos[sidx]);
-        subAvgY.push_back(subhaloYPos[sidx]);
-        subAvgZ.push_back(subhaloZPos[sidx]);
-        subAvgVX.push_back(subhaloXVel[sidx]);
-        subAvgVY.push_back(subhaloYVel[sidx]);
-        subAvgVZ.push_back(subhaloZVel[sidx]);
-        subVelDisp.push_back(subhaloVelDisp[sidx]);
-      }
+      largeHalos.push_back(halo);
+    }
+  }
+  const vtkIdType numberOfLargeHalos = static_cast<vtkIdType>(largeHalos.size());
+
+  std::vector<SubhaloResults> results(largeHalos.size());
+  FindSubhalos functor(ExtractHalo(numberOfFOFHalos, fofHaloCount, this->Internal->fof));
+  functor.HaloFinder = this->Internal->haloFinder;
+  functor.Halos = &largeHalos;
+  functor.Results = &results;
+  functor.ParticleMass = this->ParticleMass;
+  functor.AlphaFactor = this->AlphaFactor;
+  functor.BetaFactor = this->BetaFactor;
+  functor.MinCandidateSize = this->MinCandidateSize;
+  functor.NumSPHNeighbors = this->NumSPHNeighbors;
+  functor.NumNeighbors = this->NumNeighbors;
+  functor.RL = this->RL;
+  functor.DeadSize = this->DeadSize;
+  functor.BB = this->BB;
+  if (this->UseMultithreading && numberOfLargeHalos > 1)
+  {
+    vtkSMPTools::For(0, numberOfLargeHalos, 1, functor);
+  }
+  else
+  {
+    functor(0, numberOfLargeHalos);
+  }
 
-      size_t pointsBefore = shX.size();
-      subFinder.getSubhaloCosmoData(this->Internal->haloFinder->getHaloID(halo), shX, shY, shZ,
-        shVX, shVY, shVZ, shTag, shHID, shID);
+  for (size_t idx = 0; idx < largeHalos.size(); ++idx)
+  {
+    const int halo = largeHalos[idx];
+    const SubhaloResults& subhalos = results[idx];
+    long particleCount = fofHaloCount[halo];
+    for (size_t sidx = 0; sidx < subhalos.Count.size(); ++sidx)
+    {
+      parentHaloTag.push_back(this->Internal->haloFinder->getHaloID(halo));
+      parentFOFCount.push_back(particleCount);
+      subHaloTag.push_back(sidx);
+      subCount.push_back(subhalos.Count[sidx]);
+      subMass.push_back(subhalos.Mass[sidx]);
+      subCenterOfMassX.push_back(subhalos.XCofMass[sidx]);
+      subCenterOfMassY.push_back(subhalos.YCofMass[sidx]);
+      subCenterOfMassZ.push_back(subhalos.ZCofMass[sidx]);
+      subAvgX.push_back(subhalos.XPos[sidx]);
+      subAvgY.push_back(subhalos.YPos[sidx]);
+      subAvgZ.push_back(subhalos.ZPos[sidx]);
+      subAvgVX.push_back(subhalos.XVel[sidx]);
+      subAvgVY.push_back(subhalos.YVel[sidx]);
+      subAvgVZ.push_back(subhalos.ZVel[sidx]);
+      subVelDisp.push_back(subhalos.VelDisp[sidx]);
+    }
 
-      for (size_t i = 0; pointsBefore + i < shX.size(); ++i)
-      {
-        subhaloId->SetValue(haloData.GetActualIndex(i), shID[pointsBefore + i]);
-      }
+    for (size_t i = 0; i < subhalos.ParticleIndices.size(); ++i)
+    {
+      subhaloId->SetValue(subhalos.ParticleIndices[i], subhalos.ParticleSubhaloIds[i]);
     }
   }
 
@@ -657,7 +837,9 @@ void vtkPANLHaloFinder::ExecuteSubHaloFinder(
 void vtkPANLHaloFinder::FindCenters(
   vtkUnstructuredGrid* allParticles, vtkUnstructuredGrid* fofProperties)
 {
-  if (this->CenterFindingMode == vtkPANLHaloFinder::NONE)
+  if (this->CenterFindingMode != MOST_BOUND_PARTICLE &&
+    this->CenterFindingMode != MOST_CONNECTED_PARTICLE &&
+    this->CenterFindingMode != HIST_CENTER_FINDING)
   {
     return;
   }
@@ -672,55 +854,26 @@ void vtkPANLHaloFinder::FindCenters(
   centers->SetNumberOfComponents(3);
   centers->SetNumberOfTuples(numberOfFOFHalos);
 
-  ExtractHalo haloData(numberOfFOFHalos, fofHaloCount, this->Internal->fof);
-  for (int halo = 0; halo < numberOfFOFHalos; ++halo)
+  FindHaloCenters functor(ExtractHalo(numberOfFOFHalos, fofHaloCount, this->Internal->fof));
+  functor.Points = allParticles->GetPoints();
+  functor.Centers = centers->GetPointer(0);
+  functor.Mode = this->CenterFindingMode;
+  functor.BB = this->BB;
+  functor.SmoothingLength = this->SmoothingLength;
+  functor.DistanceConvertFactor = this->DistanceConvertFactor;
+  functor.RL = this->RL;
+  functor.NP = this->NP;
+  functor.OmegaMatter = OmegaMatter;
+  functor.OmegaCB = OmegaCB;
+  functor.Hubble = this->Hubble;
+  functor.RedShift = this->RedShift;
+  if (this->UseMultithreading && numberOfFOFHalos > 1)
   {
-    haloData.SetCurrentHalo(halo);
-    cosmotk::HaloCenterFinder centerFinder;
-    haloData.SetParticles(centerFinder);
-    centerFinder.setParameters(this->BB, this->SmoothingLength, this->DistanceConvertFactor,
-      this->RL, this->NP, OmegaMatter, OmegaCB, this->Hubble, this->RedShift);
-    int centerIndex = -1;
-    if (this->CenterFindingMode == MOST_BOUND_PARTICLE)
-    {
-      float minPotential;
-      if (haloData.GetNumberOfParticlesInCurrentHalo() < MBP_THRESHOLD)
-      {
-        centerIndex = centerFinder.mostBoundParticleN2(&minPotential);
-      }
-      else
-      {
-        centerIndex = centerFinder.mostBoundParticleAStar(&minPotential);
-      }
-    }
-    else if (this->CenterFindingMode == MOST_CONNECTED_PARTICLE)
-    {
-      if (haloData.GetNumberOfParticlesInCurrentHalo() < MCP_THRESHOLD)
-      {
-        centerIndex = centerFinder.mostConnectedParticleN2();
-      }
-      else
-      {
-        centerIndex = centerFinder.mostConnectedParticleChainMesh();
-      }
-    }
-    else if (this->CenterFindingMode == HIST_CENTER_FINDING)
-    {
-      centerIndex = centerFinder.mostConnectedParticleHist();
-    }
-    else
-    {
-      return;
-    }
-    float center[] = { 0.0, 0.0, 0.0 };
-    if (centerIndex >= 0)
-    {
-      double* point = allParticles->GetPoint(haloData.GetActualIndex(centerIndex));
-      center[0] = point[0];
-      center[1] = point[1];
-      center[2] = point[2];
-    }
-    centers->SetTypedTuple(halo, center);
+    vtkSMPTools::For(0, numberOfFOFHalos, 1, functor);
+  }
+  else
+  {
+    functor(0, numberOfFOFHalos);
   }
   fofProperties->GetPointData()->AddArray(centers.GetPointer());
 }
@@ -255,6 +255,16 @@ class VTKPVVTKEXTENSIONSCOSMOTOOLS_EXPORT vtkPANLHaloFinder : public vtkUnstruct
     vtkSetMacro(RedShift, double) vtkGetMacro(RedShift, double)
     //@}
 
+    //@{
+    /**
+     * When on, the centers and the subhalos of the halos of each process are
+     * computed by multiple threads. The output is the same either way.
+     * Default: On
+     */
+    vtkSetMacro(UseMultithreading, bool) vtkGetMacro(UseMultithreading, bool)
+      vtkBooleanMacro(UseMultithreading, bool)
+    //@}
+
     protected : vtkPANLHaloFinder();
   virtual ~vtkPANLHaloFinder();
 
@@ -279,6 +289,7 @@ class VTKPVVTKEXTENSIONSCOSMOTOOLS_EXPORT vtkPANLHaloFinder : public vtkUnstruct
   int NumNeighbors;
 
   bool RunSubHaloFinder;
+  bool UseMultithreading;
 
   // Center finding parameters
   int CenterFindingMode;
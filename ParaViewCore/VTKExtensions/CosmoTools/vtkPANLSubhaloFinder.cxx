@@ -25,6 +25,8 @@
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPoints.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 #include "vtkTypeInt64Array.h"
 #include "vtkUnstructuredGrid.h"
 
@@ -39,14 +41,11 @@ namespace
 {
 // magic number taken from BasicDefinition.h in the halo finder code
 static const double GRAVITY_C = 43.015e-10;
-}
 
-class vtkPANLSubhaloFinder::vtkInternals
+// The particles of one halo, in the layout the subhalo finder expects.
+class HaloParticles
 {
 public:
-  vtkInternals() {}
-  std::map<vtkIdType, std::vector<vtkIdType> > haloIndices;
-
   std::vector<POSVEL_T> xx;
   std::vector<POSVEL_T> yy;
   std::vector<POSVEL_T> zz;
@@ -57,26 +56,8 @@ public:
   std::vector<ID_T> id;
   std::vector<ID_T> actualIndex;
 
-  void ReadHalos(vtkDataArray* haloTag, vtkIdList* halos)
-  {
-    haloIndices.clear();
-    for (int i = 0; i < halos->GetNumberOfIds(); ++i)
-    {
-      haloIndices[halos->GetId(i)] = std::vector<vtkIdType>();
-    }
-    for (int j = 0; j < haloTag->GetNumberOfTuples(); ++j)
-    {
-      for (int i = 0; i < halos->GetNumberOfIds(); ++i)
-      {
-        if (halos->GetId(i) == static_cast<vtkIdType>(haloTag->GetTuple1(j)))
-        {
-          haloIndices[halos->GetId(i)].push_back(j);
-        }
-      }
-    }
-  }
-
-  void LoadHalo(vtkIdType haloId, double particleMass, vtkUnstructuredGrid* input)
+  void LoadHalo(
+    const std::vector<vtkIdType>& haloIdxs, double particleMass, vtkUnstructuredGrid* input)
   {
     vtkPointData* pd = input->GetPointData();
     assert(pd);
@@ -89,7 +70,6 @@ public:
     vtkDataArray* id_array = pd->GetArray("id");
     assert(id_array);
     double point[3];
-    std::vector<vtkIdType>& haloIdxs = haloIndices[haloId];
     this->xx.resize(haloIdxs.size());
     this->yy.resize(haloIdxs.size());
     this->zz.resize(haloIdxs.size());
@@ -101,21 +81,142 @@ public:
     this->actualIndex.resize(haloIdxs.size());
     for (size_t i = 0; i < haloIdxs.size(); ++i)
     {
+      // GetComponent, unlike GetTuple1, can be called by several threads.
       vtkIdType idx = haloIdxs[i];
       input->GetPoint(idx, point);
       this->xx[i] = point[0];
       this->yy[i] = point[1];
       this->zz[i] = point[2];
-      this->vx[i] = vx_array->GetTuple1(idx);
-      this->vy[i] = vy_array->GetTuple1(idx);
-      this->vz[i] = vz_array->GetTuple1(idx);
+      this->vx[i] = vx_array->GetComponent(idx, 0);
+      this->vy[i] = vy_array->GetComponent(idx, 0);
+      this->vz[i] = vz_array->GetComponent(idx, 0);
       this->mass[i] = particleMass;
-      this->id[i] = id_array->GetTuple1(idx);
+      this->id[i] = id_array->GetComponent(idx, 0);
       this->actualIndex[i] = idx;
     }
   }
 };
 
+// What the subhalo finder found in one halo, merged into the outputs once
+// all halos are processed.
+class SubhaloResults
+{
+public:
+  SubhaloResults()
+    : ParticleCount(0)
+  {
+  }
+
+  long ParticleCount;
+  std::vector<int> Count;
+  std::vector<POSVEL_T> Mass;
+  std::vector<POSVEL_T> XPos;
+  std::vector<POSVEL_T> YPos;
+  std::vector<POSVEL_T> ZPos;
+  std::vector<POSVEL_T> XCofMass;
+  std::vector<POSVEL_T> YCofMass;
+  std::vector<POSVEL_T> ZCofMass;
+  std::vector<POSVEL_T> XVel;
+  std::vector<POSVEL_T> YVel;
+  std::vector<POSVEL_T> ZVel;
+  std::vector<POSVEL_T> VelDisp;
+  std::vector<ID_T> ParticleIndices;
+  std::vector<ID_T> ParticleSubhaloIds;
+};
+}
+
+class vtkPANLSubhaloFinder::vtkInternals
+{
+public:
+  vtkInternals() {}
+  std::map<vtkIdType, std::vector<vtkIdType> > haloIndices;
+
+  void ReadHalos(vtkDataArray* haloTag, vtkIdList* halos)
+  {
+    haloIndices.clear();
+    for (int i = 0; i < halos->GetNumberOfIds(); ++i)
+    {
+      haloIndices[halos->GetId(i)] = std::vector<vtkIdType>();
+    }
+    std::map<vtkIdType, std::vector<vtkIdType> >::iterator itr;
+    for (int j = 0; j < haloTag->GetNumberOfTuples(); ++j)
+    {
+      itr = haloIndices.find(static_cast<vtkIdType>(haloTag->GetTuple1(j)));
+      if (itr != haloIndices.end())
+      {
+        itr->second.push_back(j);
+      }
+    }
+  }
+};
+
+// Runs the subhalo finder on a range of the halos to process. The particles
+// of a halo are loaded in per-thread buffers.
+class vtkPANLSubhaloFinder::vtkFindSubhalos
+{
+public:
+  vtkSMPThreadLocal<HaloParticles> Particles;
+  vtkPANLSubhaloFinder* Self;
+  vtkUnstructuredGrid* Input;
+  vtkIdList* Halos;
+  std::vector<SubhaloResults>* Results;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    HaloParticles& particles = this->Particles.Local();
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      vtkIdType haloId = this->Halos->GetId(i);
+      SubhaloResults& results = (*this->Results)[i];
+      // All halos are in the map already, so find() is safe to call from
+      // several threads, unlike operator[].
+      particles.LoadHalo(this->Self->Internal->haloIndices.find(haloId)->second,
+        this->Self->ParticleMass, this->Input);
+      results.ParticleCount = particles.xx.size();
+      if (results.ParticleCount == 0)
+      {
+        continue;
+      }
+
+      cosmotk::SubHaloFinder subFinder;
+      subFinder.setParameters(this->Self->ParticleMass, GRAVITY_C, this->Self->AlphaFactor,
+        this->Self->BetaFactor, this->Self->MinCandidateSize, this->Self->NumSPHNeighbors,
+        this->Self->NumNeighbors);
+      subFinder.setParticles(particles.xx.size(), &particles.xx[0], &particles.yy[0],
+        &particles.zz[0], &particles.vx[0], &particles.vy[0], &particles.vz[0],
+        &particles.mass[0], &particles.id[0]);
+      subFinder.findSubHalos();
+
+      int numberOfSubHalos = subFinder.getNumberOfSubhalos();
+      int* fofSubHalos = subFinder.getSubhalos();
+      int* fofSubHaloCount = subFinder.getSubhaloCount();
+      int* fofSubHaloList = subFinder.getSubhaloList();
+      results.Count.assign(fofSubHaloCount, fofSubHaloCount + numberOfSubHalos);
+
+      cosmotk::FOFHaloProperties subhaloProperties;
+      subhaloProperties.setHalos(numberOfSubHalos, fofSubHalos, fofSubHaloCount, fofSubHaloList);
+      subhaloProperties.setParameters("", this->Self->RL, this->Self->DeadSize, this->Self->BB);
+      subhaloProperties.setParticles(particles.xx.size(), &particles.xx[0], &particles.yy[0],
+        &particles.zz[0], &particles.vx[0], &particles.vy[0], &particles.vz[0],
+        &particles.mass[0], &particles.id[0]);
+
+      subhaloProperties.FOFHaloMass(&results.Mass);
+      subhaloProperties.FOFPosition(&results.XPos, &results.YPos, &results.ZPos);
+      subhaloProperties.FOFCenterOfMass(&results.XCofMass, &results.YCofMass, &results.ZCofMass);
+      subhaloProperties.FOFVelocity(&results.XVel, &results.YVel, &results.ZVel);
+      subhaloProperties.FOFVelocityDispersion(
+        &results.XVel, &results.YVel, &results.ZVel, &results.VelDisp);
+
+      std::vector<POSVEL_T> shX, shY, shZ, shVX, shVY, shVZ;
+      std::vector<ID_T> shTag, shHID;
+      subFinder.getSubhaloCosmoData(
+        haloId, shX, shY, shZ, shVX, shVY, shVZ, shTag, shHID, results.ParticleSubhaloIds);
+      results.ParticleIndices.assign(particles.actualIndex.begin(),
+        particles.actualIndex.begin() + results.ParticleSubhaloIds.size());
+    }
+  }
+};
+
 vtkPANLSubhaloFinder::vtkPANLSubhaloFinder()
 {
   this->Controller = vtkMultiProcessController::GetGlobalController();
@@ -134,6 +235,7 @@ vtkPANLSubhaloFinder::vtkPANLSubhaloFinder()
   this->MinCandidateSize = 200;
   this->NumSPHNeighbors = 64;
   this->NumNeighbors = 20;
+  this->UseMultithreading = true;
 }
 
 vtkPANLSubhaloFinder::~vtkPANLSubhaloFinder()
@@ -146,6 +248,7 @@ vtkStandardNewMacro(vtkPANLSubhaloFinder)
   void vtkPANLSubhaloFinder::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "UseMultithreading: " << this->UseMultithreading << endl;
 }
 
 int vtkPANLSubhaloFinder::FillInputPortInformation(int vtkNotUsed(port), vtkInformation* info)
@@ -261,9 +364,6 @@ void vtkPANLSubhaloFinder::ExecuteSubHaloFinder(vtkUnstructuredGrid* input,
   std::vector<POSVEL_T> subMass, subCenterOfMassX, subCenterOfMassY, subCenterOfMassZ, subAvgX,
     subAvgY, subAvgZ, subAvgVX, subAvgVY, subAvgVZ, subVelDisp;
 
-  std::vector<POSVEL_T> shX, shY, shZ, shVX, shVY, shVZ;
-  std::vector<ID_T> shTag, shHID, shID;
-
   vtkNew<vtkTypeInt64Array> subhaloId;
   subhaloId->SetName("subhalo_tag");
   subhaloId->SetNumberOfTuples(input->GetNumberOfPoints());
@@ -305,86 +405,49 @@ void vtkPANLSubhaloFinder::ExecuteSubHaloFinder(vtkUnstructuredGrid* input,
     }
   }
 
-  for (int i = 0; i < finalHalosToProcess->GetNumberOfIds(); ++i)
+  const vtkIdType numberOfHalos = finalHalosToProcess->GetNumberOfIds();
+  std::vector<SubhaloResults> results(numberOfHalos);
+  vtkFindSubhalos functor;
+  functor.Self = this;
+  functor.Input = input;
+  functor.Halos = finalHalosToProcess.GetPointer();
+  functor.Results = &results;
+  if (this->UseMultithreading && numberOfHalos > 1)
   {
-    vtkIdType haloId = finalHalosToProcess->GetId(i);
-    vtkDebugMacro(<< "Processing halo: " << haloId);
-    this->Internal->LoadHalo(haloId, this->ParticleMass, input);
-    long particleCount = this->Internal->xx.size();
-    if (particleCount == 0)
-    {
-      continue;
-    }
+    vtkSMPTools::For(0, numberOfHalos, 1, functor);
+  }
+  else
+  {
+    functor(0, numberOfHalos);
+  }
 
-    cosmotk::SubHaloFinder subFinder;
-    subFinder.setParameters(this->ParticleMass, GRAVITY_C, this->AlphaFactor, this->BetaFactor,
-      this->MinCandidateSize, this->NumSPHNeighbors, this->NumNeighbors);
-    subFinder.setParticles(this->Internal->xx.size(), &this->Internal->xx[0],
-      &this->Internal->yy[0], &this->Internal->zz[0], &this->Internal->vx[0],
-      &this->Internal->vy[0], &this->Internal->vz[0], &this->Internal->mass[0],
-      &this->Internal->id[0]);
-    subFinder.findSubHalos();
-
-    int numberOfSubHalos = subFinder.getNumberOfSubhalos();
-    int* fofSubHalos = subFinder.getSubhalos();
-    int* fofSubHaloCount = subFinder.getSubhaloCount();
-    int* fofSubHaloList = subFinder.getSubhaloList();
-
-    cosmotk::FOFHaloProperties subhaloProperties;
-    subhaloProperties.setHalos(numberOfSubHalos, fofSubHalos, fofSubHaloCount, fofSubHaloList);
-    subhaloProperties.setParameters("", this->RL, this->DeadSize, this->BB);
-    subhaloProperties.setParticles(this->Internal->xx.size(), &this->Internal->xx[0],
-      &this->Internal->yy[0], &this->Internal->zz[0], &this->Internal->vx[0],
-      &this->Internal->vy[0], &this->Internal->vz[0], &this->Internal->mass[0],
-      &this->Internal->id[0]);
-
-    std::vector<POSVEL_T> subhaloMass;
-    subhaloProperties.FOFHaloMass(&subhaloMass);
-
-    std::vector<POSVEL_T> subhaloXPos;
-    std::vector<POSVEL_T> subhaloYPos;
-    std::vector<POSVEL_T> subhaloZPos;
-    subhaloProperties.FOFPosition(&subhaloXPos, &subhaloYPos, &subhaloZPos);
-
-    std::vector<POSVEL_T> subhaloXCofMass;
-    std::vector<POSVEL_T> subhaloYCofMass;
-    std::vector<POSVEL_T> subhaloZCofMass;
-    subhaloProperties.FOFCenterOfMass(&subhaloXCofMass, &subhaloYCofMass, &subhaloZCofMass);
-
-    std::vector<POSVEL_T> subhaloXVel;
-    std::vector<POSVEL_T> subhaloYVel;
-    std::vector<POSVEL_T> subhaloZVel;
-    subhaloProperties.FOFVelocity(&subhaloXVel, &subhaloYVel, &subhaloZVel);
-
-    std::vector<POSVEL_T> subhaloVelDisp;
-    subhaloProperties.FOFVelocityDispersion(
-      &subhaloXVel, &subhaloYVel, &subhaloZVel, &subhaloVelDisp);
-
-    for (int sidx = 0; sidx < numberOfSubHalos; ++sidx)
+  for (vtkIdType i = 0; i < numberOfHalos; ++i)
+  {
+    vtkIdType haloId = finalHalosToProcess->GetId(i);
+    vtkDebugMacro(<< "Processed halo: " << haloId);
+    const SubhaloResults& subhalos = results[i];
+    for (size_t sidx = 0; sidx < subhalos.Count.size(); ++sidx)
     {
       parentHaloTag.push_back(haloId);
-      parentFOFCount.push_back(particleCount);
+      parentFOFCount.push_back(subhalos.ParticleCount);
       subHaloTag.push_back(sidx);
-      subCount.push_back(fofSubHaloCount[sidx]);
-      subMass.push_back(subhaloMass[sidx]);
-      subCenterOfMassX.push_back(subhaloXCofMass[sidx]);
-      subCenterOfMassY.push_back(subhaloYCofMass[sidx]);
-      subCenterOfMassZ.push_back(subhaloZCofMass[sidx]);
-      subAvgX.push_back(subhaloXPos[sidx]);
-      subAvgY.push_back(subhaloYPos[sidx]);
-      subAvgZ.push_back(subhaloZPos[sidx]);
-      subAvgVX.push_back(subhaloXVel[sidx]);
-      subAvgVY.push_back(subhaloYVel[sidx]);
-      subAvgVZ.push_back(subhaloZVel[sidx]);
-      subVelDisp.push_back(subhaloVelDisp[sidx]);
+      subCount.push_back(subhalos.Count[sidx]);
+      subMass.push_back(subhalos.Mass[sidx]);
+      subCenterOfMassX.push_back(subhalos.XCofMass[sidx]);
+      subCenterOfMassY.push_back(subhalos.YCofMass[sidx]);
+      subCenterOfMassZ.push_back(subhalos.ZCofMass[sidx]);
+      subAvgX.push_back(subhalos.XPos[sidx]);
+      subAvgY.push_back(subhalos.YPos[sidx]);
+      subAvgZ.push_back(subhalos.ZPos[sidx]);
+      subAvgVX.push_back(subhalos.XVel[sidx]);
+      subAvgVY.push_back(subhalos.YVel[sidx]);
+      subAvgVZ.push_back(subhalos.ZVel[sidx]);
+      subVelDisp.push_back(subhalos.VelDisp[sidx]);
     }
 
-    size_t pointsBefore = shX.size();
-    subFinder.getSubhaloCosmoData(haloId, shX, shY, shZ, shVX, shVY, shVZ, shTag, shHID, shID);
-
-    for (size_t j = 0; pointsBefore + j < shX.size(); ++j)
+    for (size_t j = 0; j < subhalos.ParticleIndices.size(); ++j)
     {
-      subhaloId->SetValue(this->Internal->actualIndex[j], shID[pointsBefore + j]);
+      subhaloId->SetValue(subhalos.ParticleIndices[j], subhalos.ParticleSubhaloIds[j]);
     }
   }
 
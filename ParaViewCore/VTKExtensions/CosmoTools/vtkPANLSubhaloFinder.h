@@ -186,6 +186,16 @@ class VTKPVVTKEXTENSIONSCOSMOTOOLS_EXPORT vtkPANLSubhaloFinder : public vtkPassI
     vtkSetMacro(NumNeighbors, int) vtkGetMacro(NumNeighbors, int)
     //@}
 
+    //@{
+    /**
+     * When on, the halos of each process are processed by multiple threads.
+     * The output is the same either way.
+     * Default: On
+     */
+    vtkSetMacro(UseMultithreading, bool) vtkGetMacro(UseMultithreading, bool)
+      vtkBooleanMacro(UseMultithreading, bool)
+    //@}
+
     protected : vtkPANLSubhaloFinder();
   virtual ~vtkPANLSubhaloFinder();
 
@@ -202,6 +212,7 @@ class VTKPVVTKEXTENSIONSCOSMOTOOLS_EXPORT vtkPANLSubhaloFinder : public vtkPassI
   int MinCandidateSize;
   int NumSPHNeighbors;
   int NumNeighbors;
+  bool UseMultithreading;
 
   int Mode;
   vtkIdType SizeThreshold;
@@ -211,6 +222,7 @@ class VTKPVVTKEXTENSIONSCOSMOTOOLS_EXPORT vtkPANLSubhaloFinder : public vtkPassI
 
   class vtkInternals;
   vtkInternals* Internal;
+  class vtkFindSubhalos;
 
 private:
   vtkPANLSubhaloFinder(const vtkPANLSubhaloFinder&) = delete;
@@ -33,6 +33,7 @@
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPoints.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 #include "vtkStdString.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
@@ -68,7 +69,9 @@ public:
   std::map<std::string, gio::VariableInfo> Information;
   std::map<std::string, int> VariableGenericIOType;
   std::map<std::string, bool> VariableStatus;
-  std::map<std::string, void*> RawCache;
+  // GenericIO reads each variable directly into the array that is passed
+  // to the output, so there is no intermediate buffer to copy from.
+  std::map<std::string, vtkSmartPointer<vtkDataArray> > RawCache;
   MPI_Comm MPICommunicator;
   std::set<int> RanksToLoad;
 
@@ -134,12 +137,6 @@ public:
     this->VariableStatus.clear();
     this->Information.clear();
     this->RanksToLoad.clear();
-
-    std::map<std::string, void*>::iterator iter;
-    for (iter = this->RawCache.begin(); iter != this->RawCache.end(); ++iter)
-    {
-      delete[] static_cast<char*>(iter->second);
-    } // END for
     this->RawCache.clear();
   }
 };
@@ -504,11 +501,16 @@ void vtkPGenericIOReader::LoadRawVariableData(std::string varName)
     return;
   }
 
-  this->MetaData->RawCache[varName] = gio::GenericIOUtilities::AllocateVariableArray(
-    this->MetaData->Information[varName], this->MetaData->NumberOfElements);
+  vtkDataArray* dataArray = vtkGenericIOUtilities::CreateVtkDataArray(
+    varName, this->MetaData->VariableGenericIOType[varName], this->MetaData->NumberOfElements);
+  if (dataArray == NULL)
+  {
+    vtkErrorMacro(<< "Unsupported type for variable " << varName << "!\n");
+    return;
+  }
+  this->MetaData->RawCache[varName].TakeReference(dataArray);
 
-  this->Reader->AddVariable(
-    this->MetaData->Information[varName], this->MetaData->RawCache[varName]);
+  this->Reader->AddVariable(this->MetaData->Information[varName], dataArray->GetVoidPointer(0));
 
   this->MetaData->VariableStatus[varName] = true;
 
@@ -603,6 +605,34 @@ void vtkPGenericIOReader::GetPointFromRawData(int xType, void* xBuffer, int yTyp
   } // END for all dimensions
 }
 
+namespace
+{
+// Converts the coordinates of a range of particles to points and creates a
+// vertex for each of them.
+class vtkGenericIOLoadParticles
+{
+public:
+  int Types[3];
+  void* Buffers[3];
+  double* Points;
+  vtkIdType* Cells;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType idx = begin; idx < end; ++idx)
+    {
+      for (int i = 0; i < 3; ++i)
+      {
+        this->Points[3 * idx + i] =
+          vtkGenericIOUtilities::GetDoubleFromRawBuffer(this->Types[i], this->Buffers[i], idx);
+      }
+      this->Cells[2 * idx] = 1;
+      this->Cells[2 * idx + 1] = idx;
+    }
+  }
+};
+}
+
 //------------------------------------------------------------------------------
 void vtkPGenericIOReader::LoadCoordinates(
   vtkUnstructuredGrid* grid, std::set<vtkIdType>& pointsInSelectedHalos)
@@ -631,15 +661,21 @@ void vtkPGenericIOReader::LoadCoordinates(
     return;
   }
 
+  if (!this->MetaData->RawCache[xaxis] || !this->MetaData->RawCache[yaxis] ||
+    !this->MetaData->RawCache[zaxis])
+  {
+    vtkErrorMacro(<< "One or more coordinate arrays were not loaded!\n");
+    return;
+  }
+
   int xType = this->MetaData->VariableGenericIOType[xaxis];
-  void* xBuffer = this->MetaData->RawCache[xaxis];
+  void* xBuffer = this->MetaData->RawCache[xaxis]->GetVoidPointer(0);
   int yType = this->MetaData->VariableGenericIOType[yaxis];
-  void* yBuffer = this->MetaData->RawCache[yaxis];
+  void* yBuffer = this->MetaData->RawCache[yaxis]->GetVoidPointer(0);
   int zType = this->MetaData->VariableGenericIOType[zaxis];
-  void* zBuffer = this->MetaData->RawCache[zaxis];
+  void* zBuffer = this->MetaData->RawCache[zaxis]->GetVoidPointer(0);
 
   vtkCellArray* cells = vtkCellArray::New();
-  cells->Allocate(cells->EstimateSize(this->MetaData->NumberOfElements, 1));
 
   vtkPoints* pnts = vtkPoints::New();
   pnts->SetDataTypeToDouble();
@@ -650,19 +686,26 @@ void vtkPGenericIOReader::LoadCoordinates(
   vtkIdType idx = 0;
   if (this->HaloList->GetNumberOfIds() == 0)
   {
-    for (; idx < nparticles; ++idx)
-    {
-      this->GetPointFromRawData(xType, xBuffer, yType, yBuffer, zType, zBuffer, idx, pnt);
-      pnts->SetPoint(idx, pnt);
-      cells->InsertNextCell(1, &idx);
-    } // END for all points
+    // Every particle is a vertex, so the points and the connectivity are
+    // written in place, in parallel.
+    vtkGenericIOLoadParticles functor;
+    functor.Types[0] = xType;
+    functor.Types[1] = yType;
+    functor.Types[2] = zType;
+    functor.Buffers[0] = xBuffer;
+    functor.Buffers[1] = yBuffer;
+    functor.Buffers[2] = zBuffer;
+    functor.Points = static_cast<double*>(pnts->GetData()->GetVoidPointer(0));
+    functor.Cells = cells->WritePointer(nparticles, 2 * static_cast<vtkIdType>(nparticles));
+    vtkSMPTools::For(0, nparticles, functor);
   }
   else
   {
     std::string haloVarName = std::string(this->HaloIdVariableName);
     haloVarName = vtkGenericIOUtilities::trim(haloVarName);
     int haloType = this->MetaData->VariableGenericIOType[haloVarName];
-    void* haloBuffer = this->MetaData->RawCache[haloVarName];
+    void* haloBuffer = this->MetaData->RawCache[haloVarName]->GetVoidPointer(0);
+    cells->Allocate(cells->EstimateSize(this->MetaData->NumberOfElements, 1));
     vtkIdType numPointsSoFar = 0;
     for (; idx < nparticles; ++idx)
     {
@@ -734,10 +777,12 @@ void vtkPGenericIOReader::LoadData(
     if (this->PointDataArraySelection->ArrayIsEnabled(name))
     {
       std::string varName = std::string(name);
-      vtkSmartPointer<vtkDataArray> dataArray;
-      dataArray.TakeReference(vtkGenericIOUtilities::GetVtkDataArray(varName,
-        this->MetaData->VariableGenericIOType[varName], this->MetaData->RawCache[varName],
-        this->MetaData->NumberOfElements));
+      // The array GenericIO read into is passed as is.
+      vtkSmartPointer<vtkDataArray> dataArray = this->MetaData->RawCache[varName];
+      if (!dataArray)
+      {
+        continue;
+      }
       if (this->HaloList->GetNumberOfIds() != 0)
       {
         vtkSmartPointer<vtkDataArray> onlyDataInHalo;
@@ -0,0 +1,194 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestAMRDualFilterReexecute.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include "vtkAMRDualClip.h"
+#include "vtkAMRDualContour.h"
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkDummyController.h"
+#include "vtkHierarchicalFractal.h"
+#include "vtkIdList.h"
+#include "vtkMultiBlockDataSet.h"
+#include "vtkMultiPieceDataSet.h"
+#include "vtkNew.h"
+#include "vtkNonOverlappingAMR.h"
+#include "vtkPointSet.h"
+#include "vtkPoints.h"
+#include "vtkSmartPointer.h"
+#include "vtkUniformGrid.h"
+
+#define TEST_SUCCESS 0
+#define TEST_FAILED 1
+
+namespace
+{
+const char* ArrayName = "Fractal Volume Fraction";
+
+void CreateInput(int levels, vtkNonOverlappingAMR* input)
+{
+  vtkNew<vtkHierarchicalFractal> fractal;
+  fractal->SetDimensions(10);
+  fractal->SetMaximumLevel(levels);
+  fractal->SetTwoDimensional(0);
+  fractal->SetOverlap(0);
+  fractal->Update();
+  input->ShallowCopy(fractal->GetOutputDataObject(0));
+}
+
+// Same blocks, other values: the dual grid helper reuses its blocks for it.
+void CreateChangedInput(vtkNonOverlappingAMR* source, vtkNonOverlappingAMR* input)
+{
+  input->DeepCopy(source);
+  for (unsigned int level = 0; level < input->GetNumberOfLevels(); ++level)
+  {
+    for (unsigned int idx = 0; idx < input->GetNumberOfDataSets(level); ++idx)
+    {
+      vtkUniformGrid* grid = input->GetDataSet(level, idx);
+      vtkDataArray* array = grid ? grid->GetCellData()->GetArray(ArrayName) : NULL;
+      if (!array)
+      {
+        continue;
+      }
+      for (vtkIdType cc = 0; cc < array->GetNumberOfTuples(); ++cc)
+      {
+        const double value = array->GetTuple1(cc);
+        array->SetTuple1(cc, value * value);
+      }
+    }
+  }
+}
+
+vtkPointSet* GetMesh(vtkAlgorithm* filter)
+{
+  vtkMultiBlockDataSet* output = vtkMultiBlockDataSet::SafeDownCast(filter->GetOutputDataObject(0));
+  vtkMultiPieceDataSet* pieces =
+    output ? vtkMultiPieceDataSet::SafeDownCast(output->GetBlock(0)) : NULL;
+  return pieces ? vtkPointSet::SafeDownCast(pieces->GetPiece(0)) : NULL;
+}
+
+// The output of a filter that executed before must be exactly the output of
+// a new filter.
+bool SameMesh(vtkPointSet* reused, vtkPointSet* fresh)
+{
+  if (!reused || !fresh)
+  {
+    cerr << "Missing output." << endl;
+    return false;
+  }
+  if (reused->GetNumberOfPoints() != fresh->GetNumberOfPoints() ||
+    reused->GetNumberOfCells() != fresh->GetNumberOfCells())
+  {
+    cerr << "Got " << reused->GetNumberOfPoints() << " points and " << reused->GetNumberOfCells()
+         << " cells, expected " << fresh->GetNumberOfPoints() << " points and "
+         << fresh->GetNumberOfCells() << " cells." << endl;
+    return false;
+  }
+  for (vtkIdType cc = 0; cc < fresh->GetNumberOfPoints(); ++cc)
+  {
+    double first[3], second[3];
+    reused->GetPoint(cc, first);
+    fresh->GetPoint(cc, second);
+    if (first[0] != second[0] || first[1] != second[1] || first[2] != second[2])
+    {
+      cerr << "Point " << cc << " differs." << endl;
+      return false;
+    }
+  }
+  vtkNew<vtkIdList> first;
+  vtkNew<vtkIdList> second;
+  for (vtkIdType cc = 0; cc < fresh->GetNumberOfCells(); ++cc)
+  {
+    reused->GetCellPoints(cc, first.GetPointer());
+    fresh->GetCellPoints(cc, second.GetPointer());
+    bool same = first->GetNumberOfIds() == second->GetNumberOfIds();
+    for (vtkIdType kk = 0; same && kk < first->GetNumberOfIds(); ++kk)
+    {
+      same = first->GetId(kk) == second->GetId(kk);
+    }
+    if (!same)
+    {
+      cerr << "Cell " << cc << " differs." << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename FilterType>
+void Setup(FilterType* filter, vtkNonOverlappingAMR* input, double isoValue)
+{
+  filter->SetInputData(input);
+  filter->SetInputArrayToProcess(0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_CELLS, ArrayName);
+  filter->SetIsoValue(isoValue);
+  filter->SetUseMultithreading(false);
+}
+
+// Executes `reused` on each input in turn, and compares its output with the
+// one of a new filter.
+template <typename FilterType>
+bool Reexecute(const char* name, vtkNonOverlappingAMR** inputs, const double* isoValues, int count)
+{
+  vtkNew<FilterType> reused;
+  for (int cc = 0; cc < count; ++cc)
+  {
+    Setup(reused.GetPointer(), inputs[cc], isoValues[cc]);
+    reused->Update();
+    vtkNew<FilterType> fresh;
+    Setup(fresh.GetPointer(), inputs[cc], isoValues[cc]);
+    fresh->Update();
+    vtkPointSet* mesh = GetMesh(fresh.GetPointer());
+    if (!SameMesh(GetMesh(reused.GetPointer()), mesh))
+    {
+      cerr << name << " differs from a new filter at execution " << cc << endl;
+      return false;
+    }
+    if (mesh->GetNumberOfCells() == 0)
+    {
+      cerr << name << " has an empty output at execution " << cc << endl;
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+int TestAMRDualFilterReexecute(int, char* [])
+{
+  // The fractal source and the filters use the global controller.
+  vtkNew<vtkDummyController> controller;
+  vtkMultiProcessController::SetGlobalController(controller.GetPointer());
+
+  vtkNew<vtkNonOverlappingAMR> original;
+  CreateInput(3, original.GetPointer());
+  vtkNew<vtkNonOverlappingAMR> changed;
+  CreateChangedInput(original.GetPointer(), changed.GetPointer());
+  vtkNew<vtkNonOverlappingAMR> refined;
+  CreateInput(4, refined.GetPointer());
+
+  // The blocks are reused for the changed values and the new iso value, and
+  // rebuilt for the refined input.
+  vtkNonOverlappingAMR* inputs[5] = { original.GetPointer(), changed.GetPointer(),
+    changed.GetPointer(), refined.GetPointer(), original.GetPointer() };
+  const double isoValues[5] = { 0.5, 0.5, 0.3, 0.5, 0.5 };
+
+  int result = TEST_SUCCESS;
+  if (!Reexecute<vtkAMRDualContour>("vtkAMRDualContour", inputs, isoValues, 5) ||
+    !Reexecute<vtkAMRDualClip>("vtkAMRDualClip", inputs, isoValues, 5))
+  {
+    result = TEST_FAILED;
+  }
+  vtkMultiProcessController::SetGlobalController(NULL);
+  return result;
+}
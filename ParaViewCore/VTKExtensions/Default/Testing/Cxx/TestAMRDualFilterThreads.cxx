@@ -0,0 +1,212 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestAMRDualFilterThreads.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include "vtkAMRDualClip.h"
+#include "vtkAMRDualContour.h"
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkDummyController.h"
+#include "vtkHierarchicalFractal.h"
+#include "vtkIdList.h"
+#include "vtkMultiBlockDataSet.h"
+#include "vtkMultiPieceDataSet.h"
+#include "vtkNew.h"
+#include "vtkNonOverlappingAMR.h"
+#include "vtkPointData.h"
+#include "vtkPointSet.h"
+#include "vtkPoints.h"
+
+#define TEST_SUCCESS 0
+#define TEST_FAILED 1
+
+namespace
+{
+const char* ArrayName = "Fractal Volume Fraction";
+
+vtkPointSet* GetMesh(vtkAlgorithm* filter)
+{
+  vtkMultiBlockDataSet* output = vtkMultiBlockDataSet::SafeDownCast(filter->GetOutputDataObject(0));
+  vtkMultiPieceDataSet* pieces =
+    output ? vtkMultiPieceDataSet::SafeDownCast(output->GetBlock(0)) : NULL;
+  return pieces ? vtkPointSet::SafeDownCast(pieces->GetPiece(0)) : NULL;
+}
+
+bool SameArrays(vtkDataArray* serial, vtkDataArray* threaded, const char* name)
+{
+  if (!serial || !threaded)
+  {
+    cerr << "Missing array " << name << endl;
+    return false;
+  }
+  if (serial->GetDataType() != threaded->GetDataType() ||
+    serial->GetNumberOfTuples() != threaded->GetNumberOfTuples() ||
+    serial->GetNumberOfComponents() != threaded->GetNumberOfComponents())
+  {
+    cerr << "Array " << name << " has another type or size." << endl;
+    return false;
+  }
+  for (vtkIdType cc = 0; cc < serial->GetNumberOfTuples(); ++cc)
+  {
+    for (int kk = 0; kk < serial->GetNumberOfComponents(); ++kk)
+    {
+      if (serial->GetComponent(cc, kk) != threaded->GetComponent(cc, kk))
+      {
+        cerr << "Array " << name << " differs at tuple " << cc << endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool SameAttributes(vtkDataSetAttributes* serial, vtkDataSetAttributes* threaded)
+{
+  if (serial->GetNumberOfArrays() != threaded->GetNumberOfArrays())
+  {
+    cerr << "Got " << threaded->GetNumberOfArrays() << " arrays, expected "
+         << serial->GetNumberOfArrays() << endl;
+    return false;
+  }
+  for (int ii = 0; ii < serial->GetNumberOfArrays(); ++ii)
+  {
+    vtkDataArray* array = serial->GetArray(ii);
+    if (array && !SameArrays(array, threaded->GetArray(array->GetName()), array->GetName()))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// The threaded output must be exactly the serial one: same point and cell
+// order, same block ids and same point arrays.
+bool SameMesh(vtkPointSet* serial, vtkPointSet* threaded)
+{
+  if (!serial || !threaded)
+  {
+    cerr << "Missing output." << endl;
+    return false;
+  }
+  if (serial->GetNumberOfPoints() != threaded->GetNumberOfPoints() ||
+    serial->GetNumberOfCells() != threaded->GetNumberOfCells())
+  {
+    cerr << "Got " << threaded->GetNumberOfPoints() << " points and "
+         << threaded->GetNumberOfCells() << " cells, expected " << serial->GetNumberOfPoints()
+         << " points and " << serial->GetNumberOfCells() << " cells." << endl;
+    return false;
+  }
+  if (serial->GetNumberOfCells() == 0)
+  {
+    cerr << "Empty output." << endl;
+    return false;
+  }
+  if (!SameArrays(serial->GetPoints()->GetData(), threaded->GetPoints()->GetData(), "Points"))
+  {
+    return false;
+  }
+  vtkNew<vtkIdList> first;
+  vtkNew<vtkIdList> second;
+  for (vtkIdType cc = 0; cc < serial->GetNumberOfCells(); ++cc)
+  {
+    serial->GetCellPoints(cc, first.GetPointer());
+    threaded->GetCellPoints(cc, second.GetPointer());
+    bool same = serial->GetCellType(cc) == threaded->GetCellType(cc) &&
+      first->GetNumberOfIds() == second->GetNumberOfIds();
+    for (vtkIdType kk = 0; same && kk < first->GetNumberOfIds(); ++kk)
+    {
+      same = first->GetId(kk) == second->GetId(kk);
+    }
+    if (!same)
+    {
+      cerr << "Cell " << cc << " differs." << endl;
+      return false;
+    }
+  }
+  return SameArrays(serial->GetCellData()->GetArray("BlockIds"),
+           threaded->GetCellData()->GetArray("BlockIds"), "BlockIds") &&
+    SameAttributes(serial->GetPointData(), threaded->GetPointData());
+}
+
+template <typename FilterType>
+void Setup(FilterType* filter, vtkNonOverlappingAMR* input, bool useMultithreading)
+{
+  filter->SetInputData(input);
+  filter->SetInputArrayToProcess(0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_CELLS, ArrayName);
+  filter->SetIsoValue(0.5);
+  filter->SetUseMultithreading(useMultithreading);
+}
+
+// Options are bits of `options`: merge points, degenerate cells, capping.
+void SetOptions(vtkAMRDualContour* filter, int options)
+{
+  filter->SetEnableMergePoints((options & 1) ? 1 : 0);
+  filter->SetEnableDegenerateCells((options & 2) ? 1 : 0);
+  filter->SetEnableCapping((options & 4) ? 1 : 0);
+}
+
+// Options are bits of `options`: merge points, degenerate cells.
+void SetOptions(vtkAMRDualClip* filter, int options)
+{
+  filter->SetEnableMergePoints((options & 1) ? 1 : 0);
+  filter->SetEnableDegenerateCells((options & 2) ? 1 : 0);
+}
+
+template <typename FilterType>
+bool CompareThreaded(const char* name, vtkNonOverlappingAMR* input, int numberOfOptions)
+{
+  for (int options = 0; options < numberOfOptions; ++options)
+  {
+    vtkNew<FilterType> serial;
+    Setup(serial.GetPointer(), input, false);
+    SetOptions(serial.GetPointer(), options);
+    serial->Update();
+    vtkNew<FilterType> threaded;
+    Setup(threaded.GetPointer(), input, true);
+    SetOptions(threaded.GetPointer(), options);
+    threaded->Update();
+    if (!SameMesh(GetMesh(serial.GetPointer()), GetMesh(threaded.GetPointer())))
+    {
+      cerr << name << " differs when threaded, with options " << options << endl;
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+int TestAMRDualFilterThreads(int, char* [])
+{
+  // The fractal source and the filters use the global controller.
+  vtkNew<vtkDummyController> controller;
+  vtkMultiProcessController::SetGlobalController(controller.GetPointer());
+
+  vtkNew<vtkHierarchicalFractal> fractal;
+  fractal->SetDimensions(10);
+  fractal->SetMaximumLevel(4);
+  fractal->SetTwoDimensional(0);
+  fractal->SetOverlap(0);
+  fractal->Update();
+  vtkNew<vtkNonOverlappingAMR> input;
+  input->ShallowCopy(fractal->GetOutputDataObject(0));
+
+  int result = TEST_SUCCESS;
+  if (!CompareThreaded<vtkAMRDualContour>("vtkAMRDualContour", input.GetPointer(), 8) ||
+    !CompareThreaded<vtkAMRDualClip>("vtkAMRDualClip", input.GetPointer(), 4))
+  {
+    result = TEST_FAILED;
+  }
+  vtkMultiProcessController::SetGlobalController(NULL);
+  return result;
+}
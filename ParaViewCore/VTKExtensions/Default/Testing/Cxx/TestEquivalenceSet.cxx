@@ -0,0 +1,137 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestEquivalenceSet.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include "vtkConcurrentEquivalenceSet.h"
+#include "vtkEquivalenceSet.h"
+#include "vtkNew.h"
+#include "vtkSMPTools.h"
+
+#define TEST_SUCCESS 0
+#define TEST_FAILED 1
+
+namespace
+{
+// Members are equivalent when they have the same remainder modulo Modulus,
+// but only members below Limit are linked.
+const vtkIdType NumberOfMembers = 100000;
+const vtkIdType Modulus = 7;
+const vtkIdType Limit = 50000;
+
+vtkIdType ExpectedSetId(vtkIdType memberId)
+{
+  // Sets are numbered in the order of their smallest member: first the
+  // Modulus linked sets, then all other members are their own set.
+  return memberId < Limit ? memberId % Modulus : memberId - Limit + Modulus;
+}
+
+bool CheckResolved(vtkEquivalenceSet* set, const char* name)
+{
+  if (set->GetNumberOfMembers() != NumberOfMembers)
+  {
+    cerr << name << ": expected " << NumberOfMembers << " members, got "
+         << set->GetNumberOfMembers() << endl;
+    return false;
+  }
+  if (set->GetNumberOfResolvedSets() != NumberOfMembers - Limit + Modulus)
+  {
+    cerr << name << ": expected " << (NumberOfMembers - Limit + Modulus) << " sets, got "
+         << set->GetNumberOfResolvedSets() << endl;
+    return false;
+  }
+  for (vtkIdType cc = 0; cc < NumberOfMembers; ++cc)
+  {
+    if (set->GetEquivalentSetId(cc) != ExpectedSetId(cc))
+    {
+      cerr << name << ": member " << cc << " is in set " << set->GetEquivalentSetId(cc)
+           << ", expected " << ExpectedSetId(cc) << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+class LinkMembers
+{
+public:
+  vtkConcurrentEquivalenceSet* Set;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType cc = begin; cc < end; ++cc)
+    {
+      // Link backwards so that concurrent unions race on the same roots.
+      vtkIdType other = Limit - 1 - cc;
+      if (cc + Modulus < Limit)
+      {
+        this->Set->AddEquivalence(cc + Modulus, cc);
+      }
+      if (other >= Modulus)
+      {
+        this->Set->AddEquivalence(other - Modulus, other);
+      }
+    }
+  }
+};
+}
+
+int TestEquivalenceSet(int, char* [])
+{
+  // Serial set, grown one equivalence at a time, linked from the largest id
+  // down so that the trees are unbalanced unless merged by rank.
+  vtkNew<vtkEquivalenceSet> serial;
+  serial->AddEquivalence(NumberOfMembers - 1, NumberOfMembers - 1);
+  for (vtkIdType cc = Limit - 1; cc >= Modulus; --cc)
+  {
+    serial->AddEquivalence(cc, cc - Modulus);
+  }
+  if (serial->GetEquivalentSetId(Limit - 1) != serial->GetEquivalentSetId((Limit - 1) % Modulus))
+  {
+    cerr << "Unresolved serial set: members are not equivalent." << endl;
+    return TEST_FAILED;
+  }
+  serial->ResolveEquivalences();
+  if (!CheckResolved(serial.GetPointer(), "vtkEquivalenceSet"))
+  {
+    return TEST_FAILED;
+  }
+
+  // Concurrent set, linked from multiple threads.
+  vtkNew<vtkConcurrentEquivalenceSet> concurrent;
+  concurrent->SetNumberOfMembers(NumberOfMembers);
+  LinkMembers functor;
+  functor.Set = concurrent.GetPointer();
+  vtkSMPTools::For(0, Limit, 64, functor);
+  for (vtkIdType cc = 0; cc < NumberOfMembers; ++cc)
+  {
+    // representatives are the smallest members.
+    vtkIdType expected = cc < Limit ? cc % Modulus : cc;
+    if (concurrent->GetEquivalentSetId(cc) != expected)
+    {
+      cerr << "vtkConcurrentEquivalenceSet: member " << cc << " is represented by "
+           << concurrent->GetEquivalentSetId(cc) << ", expected " << expected << endl;
+      return TEST_FAILED;
+    }
+  }
+
+  vtkNew<vtkEquivalenceSet> copy;
+  concurrent->CopyEquivalences(copy.GetPointer());
+  copy->ResolveEquivalences();
+  if (!CheckResolved(copy.GetPointer(), "vtkConcurrentEquivalenceSet"))
+  {
+    return TEST_FAILED;
+  }
+
+  return TEST_SUCCESS;
+}
@@ -0,0 +1,316 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestFlashContour.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkDoubleArray.h"
+#include "vtkFieldData.h"
+#include "vtkFlashContour.h"
+#include "vtkImageData.h"
+#include "vtkIntArray.h"
+#include "vtkMultiBlockDataSet.h"
+#include "vtkMultiPieceDataSet.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkTimerLog.h"
+
+#include <cmath>
+
+#define TEST_SUCCESS 0
+#define TEST_FAILED 1
+
+namespace
+{
+// Dual cells per block along each axis.
+const int BlockCells = 8;
+
+void AddIntArray(vtkMultiBlockDataSet* input, const char* name, const int* values, int count)
+{
+  vtkNew<vtkIntArray> array;
+  array->SetName(name);
+  array->SetNumberOfTuples(count);
+  for (int cc = 0; cc < count; ++cc)
+  {
+    array->SetValue(cc, values[cc]);
+  }
+  input->GetFieldData()->AddArray(array.GetPointer());
+}
+
+vtkImageData* NewBlock(const double origin[3], double spacing)
+{
+  vtkImageData* image = vtkImageData::New();
+  image->SetDimensions(BlockCells + 1, BlockCells + 1, BlockCells + 1);
+  image->SetOrigin(origin[0], origin[1], origin[2]);
+  image->SetSpacing(spacing, spacing, spacing);
+  vtkNew<vtkDoubleArray> distance;
+  distance->SetName("Distance");
+  distance->SetNumberOfTuples(image->GetNumberOfCells());
+  vtkNew<vtkDoubleArray> x;
+  x->SetName("X");
+  x->SetNumberOfTuples(image->GetNumberOfCells());
+  vtkIdType cellId = 0;
+  for (int k = 0; k < BlockCells; ++k)
+  {
+    for (int j = 0; j < BlockCells; ++j)
+    {
+      for (int i = 0; i < BlockCells; ++i, ++cellId)
+      {
+        double center[3] = { origin[0] + (i + 0.5) * spacing, origin[1] + (j + 0.5) * spacing,
+          origin[2] + (k + 0.5) * spacing };
+        // A sphere in the middle of the domain.
+        double dx = center[0] - BlockCells;
+        double dy = center[1] - BlockCells;
+        double dz = center[2] - BlockCells;
+        distance->SetValue(cellId, std::sqrt(dx * dx + dy * dy + dz * dz));
+        x->SetValue(cellId, center[0]);
+      }
+    }
+  }
+  image->GetCellData()->AddArray(distance.GetPointer());
+  image->GetCellData()->AddArray(x.GetPointer());
+  return image;
+}
+
+// Flash-like input: 2x2x2 root blocks (global ids 0-7) where root 0 is
+// refined into 8 children (global ids 8-15), so the contour crosses level
+// transitions.
+void CreateInput(vtkMultiBlockDataSet* input)
+{
+  const int numGlobalBlocks = 16;
+  int globalToLocal[numGlobalBlocks];
+  int children[numGlobalBlocks * 8];
+  int neighbors[numGlobalBlocks * 6];
+  int levels[numGlobalBlocks];
+  for (int cc = 0; cc < numGlobalBlocks * 8; ++cc)
+  {
+    children[cc] = -1;
+  }
+  for (int cc = 0; cc < numGlobalBlocks * 6; ++cc)
+  {
+    neighbors[cc] = -1;
+  }
+
+  int localId = 0;
+  for (int root = 0; root < 8; ++root)
+  {
+    int idx[3] = { root & 1, (root >> 1) & 1, (root >> 2) & 1 };
+    levels[root] = 1;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      // Min and max face neighbors.
+      neighbors[root * 6 + 2 * axis] = idx[axis] ? root - (1 << axis) : -1;
+      neighbors[root * 6 + 2 * axis + 1] = idx[axis] ? -1 : root + (1 << axis);
+    }
+    if (root == 0)
+    { // Not loaded, but its children are.
+      globalToLocal[root] = -1;
+      for (int child = 0; child < 8; ++child)
+      {
+        children[child] = 8 + child;
+      }
+      continue;
+    }
+    double origin[3] = { idx[0] * BlockCells * 1.0, idx[1] * BlockCells * 1.0,
+      idx[2] * BlockCells * 1.0 };
+    vtkImageData* image = NewBlock(origin, 1.0);
+    input->SetBlock(localId, image);
+    image->Delete();
+    globalToLocal[root] = localId++;
+  }
+  for (int child = 0; child < 8; ++child)
+  {
+    int idx[3] = { child & 1, (child >> 1) & 1, (child >> 2) & 1 };
+    levels[8 + child] = 2;
+    double origin[3] = { idx[0] * BlockCells * 0.5, idx[1] * BlockCells * 0.5,
+      idx[2] * BlockCells * 0.5 };
+    vtkImageData* image = NewBlock(origin, 0.5);
+    input->SetBlock(localId, image);
+    image->Delete();
+    globalToLocal[8 + child] = localId++;
+  }
+
+  AddIntArray(input, "GlobalToLocalMap", globalToLocal, numGlobalBlocks);
+  AddIntArray(input, "BlockChildren", children, numGlobalBlocks * 8);
+  AddIntArray(input, "BlockNeighbors", neighbors, numGlobalBlocks * 6);
+  AddIntArray(input, "BlockLevel", levels, numGlobalBlocks);
+}
+
+vtkPolyData* Contour(vtkFlashContour* filter, bool mergePoints, bool useMultithreading,
+  vtkMultiBlockDataSet* input, double& time)
+{
+  filter->SetInputData(input);
+  filter->SetInputArrayToProcess(0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_CELLS, "Distance");
+  filter->SetIsoValue(5.3);
+  filter->SetPassAttribute("X");
+  filter->SetMergePoints(mergePoints);
+  filter->SetUseMultithreading(useMultithreading);
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  filter->Update();
+  timer->StopTimer();
+  time = timer->GetElapsedTime();
+  vtkMultiBlockDataSet* output = vtkMultiBlockDataSet::SafeDownCast(filter->GetOutputDataObject(0));
+  vtkMultiPieceDataSet* pieces =
+    output ? vtkMultiPieceDataSet::SafeDownCast(output->GetBlock(0)) : NULL;
+  return pieces ? vtkPolyData::SafeDownCast(pieces->GetPiece(0)) : NULL;
+}
+
+bool SameArrays(vtkDataArray* first, vtkDataArray* second)
+{
+  if (!first || !second || first->GetNumberOfTuples() != second->GetNumberOfTuples() ||
+    first->GetNumberOfComponents() != second->GetNumberOfComponents())
+  {
+    return false;
+  }
+  for (vtkIdType cc = 0; cc < first->GetNumberOfTuples(); ++cc)
+  {
+    for (int kk = 0; kk < first->GetNumberOfComponents(); ++kk)
+    {
+      if (first->GetComponent(cc, kk) != second->GetComponent(cc, kk))
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// The multithreaded output must be exactly the same as the serial one.
+bool SameOutput(vtkPolyData* serial, vtkPolyData* threaded, const char* name)
+{
+  const char* cellArrays[3] = { "GlobalBlockId", "Level", "HiddenLevels" };
+  bool same = SameArrays(serial->GetPoints()->GetData(), threaded->GetPoints()->GetData()) &&
+    SameArrays(serial->GetPolys()->GetData(), threaded->GetPolys()->GetData()) &&
+    SameArrays(serial->GetPointData()->GetArray("X"), threaded->GetPointData()->GetArray("X"));
+  for (int cc = 0; same && cc < 3; ++cc)
+  {
+    same = SameArrays(serial->GetCellData()->GetArray(cellArrays[cc]),
+      threaded->GetCellData()->GetArray(cellArrays[cc]));
+  }
+  if (!same)
+  {
+    cerr << name << ": multithreaded output differs from the serial output." << endl;
+  }
+  return same;
+}
+
+bool SamePoint(vtkPolyData* first, vtkIdType firstId, vtkPolyData* second, vtkIdType secondId)
+{
+  double p[3], q[3];
+  first->GetPoint(firstId, p);
+  second->GetPoint(secondId, q);
+  double a = first->GetPointData()->GetArray("X")->GetComponent(firstId, 0);
+  double b = second->GetPointData()->GetArray("X")->GetComponent(secondId, 0);
+  return std::fabs(p[0] - q[0]) < 1e-4 && std::fabs(p[1] - q[1]) < 1e-4 &&
+    std::fabs(p[2] - q[2]) < 1e-4 && std::fabs(a - b) < 1e-4;
+}
+
+// Merging points must only share points and drop the triangles that have
+// coincident points, in the same order as the filter without merging.
+bool SameSurface(vtkPolyData* reference, vtkPolyData* merged)
+{
+  if (merged->GetNumberOfPoints() >= reference->GetNumberOfPoints())
+  {
+    cerr << "Points were not merged: " << merged->GetNumberOfPoints() << " points vs. "
+         << reference->GetNumberOfPoints() << " without merging." << endl;
+    return false;
+  }
+  vtkCellArray* referencePolys = reference->GetPolys();
+  vtkCellArray* mergedPolys = merged->GetPolys();
+  referencePolys->InitTraversal();
+  mergedPolys->InitTraversal();
+  vtkIdType npts, *pts;
+  vtkIdType mergedNpts = 0, *mergedPts = NULL;
+  bool hasMerged = mergedPolys->GetNextCell(mergedNpts, mergedPts) != 0;
+  while (referencePolys->GetNextCell(npts, pts))
+  {
+    if (hasMerged && mergedNpts == 3 && SamePoint(reference, pts[0], merged, mergedPts[0]) &&
+      SamePoint(reference, pts[1], merged, mergedPts[1]) &&
+      SamePoint(reference, pts[2], merged, mergedPts[2]))
+    {
+      if (mergedPts[0] == mergedPts[1] || mergedPts[0] == mergedPts[2] ||
+        mergedPts[1] == mergedPts[2])
+      {
+        cerr << "Degenerate triangle in the merged output." << endl;
+        return false;
+      }
+      hasMerged = mergedPolys->GetNextCell(mergedNpts, mergedPts) != 0;
+      continue;
+    }
+    if (!SamePoint(reference, pts[0], reference, pts[1]) &&
+      !SamePoint(reference, pts[0], reference, pts[2]) &&
+      !SamePoint(reference, pts[1], reference, pts[2]))
+    {
+      cerr << "A triangle is missing from the merged output." << endl;
+      return false;
+    }
+  }
+  if (hasMerged)
+  {
+    cerr << "The merged output has extra triangles." << endl;
+    return false;
+  }
+  return true;
+}
+}
+
+int TestFlashContour(int, char* [])
+{
+  vtkNew<vtkMultiBlockDataSet> input;
+  CreateInput(input.GetPointer());
+
+  // The filter as it was: serial, one point per triangle corner.
+  double referenceTime, unmergedTime, serialTime, threadedTime;
+  vtkNew<vtkFlashContour> referenceFilter;
+  vtkPolyData* reference =
+    Contour(referenceFilter.GetPointer(), false, false, input.GetPointer(), referenceTime);
+  vtkNew<vtkFlashContour> unmergedFilter;
+  vtkPolyData* unmerged =
+    Contour(unmergedFilter.GetPointer(), false, true, input.GetPointer(), unmergedTime);
+  vtkNew<vtkFlashContour> serialFilter;
+  vtkPolyData* serial =
+    Contour(serialFilter.GetPointer(), true, false, input.GetPointer(), serialTime);
+  vtkNew<vtkFlashContour> threadedFilter;
+  vtkPolyData* threaded =
+    Contour(threadedFilter.GetPointer(), true, true, input.GetPointer(), threadedTime);
+  if (!reference || !unmerged || !serial || !threaded)
+  {
+    cerr << "Missing contour output." << endl;
+    return TEST_FAILED;
+  }
+  if (reference->GetNumberOfCells() == 0)
+  {
+    cerr << "Empty contour." << endl;
+    return TEST_FAILED;
+  }
+
+  cout << "Contouring " << input->GetNumberOfBlocks() << " blocks" << endl;
+  cout << "  serial, unmerged:        " << referenceTime << " s, "
+       << reference->GetNumberOfPoints() << " points" << endl;
+  cout << "  multithreaded, unmerged: " << unmergedTime << " s" << endl;
+  cout << "  serial, merged:          " << serialTime << " s, " << serial->GetNumberOfPoints()
+       << " points" << endl;
+  cout << "  multithreaded, merged:   " << threadedTime << " s" << endl;
+
+  if (!SameOutput(reference, unmerged, "Unmerged") || !SameOutput(serial, threaded, "Merged") ||
+    !SameSurface(reference, threaded))
+  {
+    return TEST_FAILED;
+  }
+  return TEST_SUCCESS;
+}
@@ -0,0 +1,226 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestIntegrateAttributes.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include "vtkAppendFilter.h"
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkDoubleArray.h"
+#include "vtkDummyController.h"
+#include "vtkFloatArray.h"
+#include "vtkImageData.h"
+#include "vtkIntArray.h"
+#include "vtkIntegrateAttributes.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkRectilinearGrid.h"
+#include "vtkSmartPointer.h"
+#include "vtkUnsignedCharArray.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+#define TEST_SUCCESS 0
+#define TEST_FAILED 1
+
+namespace
+{
+// Adds point and cell arrays of several types and a ghost array hiding every
+// seventh cell.
+void AddArrays(vtkDataSet* data)
+{
+  vtkNew<vtkFloatArray> temperature;
+  temperature->SetName("temperature");
+  vtkNew<vtkIntArray> velocity;
+  velocity->SetName("velocity");
+  velocity->SetNumberOfComponents(3);
+  double x[3];
+  for (vtkIdType cc = 0; cc < data->GetNumberOfPoints(); ++cc)
+  {
+    data->GetPoint(cc, x);
+    temperature->InsertNextValue(static_cast<float>(x[0] * x[0] + 2 * x[1] - x[2]));
+    velocity->InsertNextTuple3(cc % 5, -(cc % 3), 7);
+  }
+  data->GetPointData()->AddArray(temperature.GetPointer());
+  data->GetPointData()->AddArray(velocity.GetPointer());
+
+  vtkNew<vtkDoubleArray> density;
+  density->SetName("density");
+  vtkNew<vtkUnsignedCharArray> ghosts;
+  ghosts->SetName(vtkDataSetAttributes::GhostArrayName());
+  for (vtkIdType cc = 0; cc < data->GetNumberOfCells(); ++cc)
+  {
+    density->InsertNextValue(1.0 + 0.25 * (cc % 11));
+    ghosts->InsertNextValue(cc % 7 == 3 ? vtkDataSetAttributes::DUPLICATECELL : 0);
+  }
+  data->GetCellData()->AddArray(density.GetPointer());
+  data->GetCellData()->AddArray(ghosts.GetPointer());
+}
+
+vtkSmartPointer<vtkImageData> CreateImage(int nx, int ny, int nz, double shift)
+{
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetExtent(2, nx + 1, -1, ny - 2, 0, nz - 1);
+  image->SetOrigin(shift - 0.5, 1.0, 2.0);
+  image->SetSpacing(0.5, 0.25, 2.0);
+  AddArrays(image);
+  return image;
+}
+
+vtkSmartPointer<vtkDoubleArray> CreateCoordinates(int n, double scale)
+{
+  vtkSmartPointer<vtkDoubleArray> coords = vtkSmartPointer<vtkDoubleArray>::New();
+  for (int cc = 0; cc < n; ++cc)
+  {
+    // Non uniform spacing.
+    coords->InsertNextValue(scale * (cc + 0.1 * cc * cc));
+  }
+  return coords;
+}
+
+vtkSmartPointer<vtkRectilinearGrid> CreateRectilinearGrid(int nx, int ny, int nz)
+{
+  vtkSmartPointer<vtkRectilinearGrid> grid = vtkSmartPointer<vtkRectilinearGrid>::New();
+  grid->SetDimensions(nx, ny, nz);
+  grid->SetXCoordinates(CreateCoordinates(nx, 1.0));
+  grid->SetYCoordinates(CreateCoordinates(ny, 0.5));
+  grid->SetZCoordinates(CreateCoordinates(nz, -2.0));
+  AddArrays(grid);
+  return grid;
+}
+
+vtkSmartPointer<vtkUnstructuredGrid> Integrate(vtkDataObject* input)
+{
+  vtkNew<vtkIntegrateAttributes> integrate;
+  integrate->SetInputData(input);
+  integrate->Update();
+  vtkSmartPointer<vtkUnstructuredGrid> output = vtkSmartPointer<vtkUnstructuredGrid>::New();
+  output->ShallowCopy(integrate->GetOutput());
+  return output;
+}
+
+// Converts the inputs to one vtkUnstructuredGrid, so that they go through the
+// per-cell path of the filter.
+vtkSmartPointer<vtkUnstructuredGrid> Append(
+  vtkDataSet* first, vtkDataSet* second = NULL, vtkDataSet* third = NULL)
+{
+  vtkNew<vtkAppendFilter> append;
+  append->AddInputData(first);
+  if (second)
+  {
+    append->AddInputData(second);
+  }
+  if (third)
+  {
+    append->AddInputData(third);
+  }
+  append->Update();
+  vtkSmartPointer<vtkUnstructuredGrid> output = vtkSmartPointer<vtkUnstructuredGrid>::New();
+  output->ShallowCopy(append->GetOutput());
+  return output;
+}
+
+bool Close(double a, double b)
+{
+  return fabs(a - b) <= 1e-10 * std::max(1.0, std::max(fabs(a), fabs(b)));
+}
+
+bool SameAttributes(vtkDataSetAttributes* expected, vtkDataSetAttributes* result, const char* name)
+{
+  if (expected->GetNumberOfArrays() != result->GetNumberOfArrays())
+  {
+    cerr << name << ": got " << result->GetNumberOfArrays() << " arrays, expected "
+         << expected->GetNumberOfArrays() << endl;
+    return false;
+  }
+  for (int cc = 0; cc < expected->GetNumberOfArrays(); ++cc)
+  {
+    vtkDataArray* array = expected->GetArray(cc);
+    vtkDataArray* other = result->GetArray(array->GetName());
+    if (!other || other->GetNumberOfComponents() != array->GetNumberOfComponents())
+    {
+      cerr << name << ": array " << array->GetName() << " is missing or has another size."
+           << endl;
+      return false;
+    }
+    for (int comp = 0; comp < array->GetNumberOfComponents(); ++comp)
+    {
+      if (!Close(array->GetComponent(0, comp), other->GetComponent(0, comp)))
+      {
+        cerr << name << ": " << array->GetName() << " is " << other->GetComponent(0, comp)
+             << ", expected " << array->GetComponent(0, comp) << endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// The integration of `input` must be the one of `reference`.
+bool SameIntegration(const char* name, vtkDataObject* input, vtkDataObject* reference)
+{
+  vtkSmartPointer<vtkUnstructuredGrid> expected = Integrate(reference);
+  vtkSmartPointer<vtkUnstructuredGrid> result = Integrate(input);
+  if (expected->GetNumberOfPoints() != 1 || result->GetNumberOfPoints() != 1)
+  {
+    cerr << name << ": the output must have one point." << endl;
+    return false;
+  }
+  double first[3], second[3];
+  expected->GetPoint(0, first);
+  result->GetPoint(0, second);
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    if (!Close(first[axis], second[axis]))
+    {
+      cerr << name << ": the center is (" << second[0] << ", " << second[1] << ", " << second[2]
+           << "), expected (" << first[0] << ", " << first[1] << ", " << first[2] << ")" << endl;
+      return false;
+    }
+  }
+  return SameAttributes(expected->GetPointData(), result->GetPointData(), name) &&
+    SameAttributes(expected->GetCellData(), result->GetCellData(), name);
+}
+
+// The structured fast path must give the results of the per-cell path.
+bool CompareWithPerCellPath(const char* name, vtkDataSet* input)
+{
+  return SameIntegration(name, input, Append(input));
+}
+}
+
+int TestIntegrateAttributes(int, char* [])
+{
+  // The filter reduces its results over the global controller.
+  vtkNew<vtkDummyController> controller;
+  vtkMultiProcessController::SetGlobalController(controller.GetPointer());
+
+  bool valid = CompareWithPerCellPath("3D image", CreateImage(13, 9, 7, 0.0));
+  valid = CompareWithPerCellPath("2D image", CreateImage(13, 9, 1, 0.0)) && valid;
+  valid = CompareWithPerCellPath("1D image", CreateImage(1, 1, 40, 0.0)) && valid;
+  valid = CompareWithPerCellPath("3D rectilinear grid", CreateRectilinearGrid(11, 8, 6)) && valid;
+  valid = CompareWithPerCellPath("2D rectilinear grid", CreateRectilinearGrid(11, 1, 6)) && valid;
+
+  // Lower dimensional cells before and after the volume cells, in chunks of
+  // their own, are thrown out whatever the order in which they are met.
+  vtkSmartPointer<vtkImageData> volume = CreateImage(13, 9, 7, 0.0);
+  valid = SameIntegration("mixed dimensions",
+            Append(CreateImage(13, 9, 1, -20.0), volume, CreateImage(1, 9, 7, 20.0)), volume) &&
+    valid;
+
+  vtkMultiProcessController::SetGlobalController(NULL);
+  return valid ? TEST_SUCCESS : TEST_FAILED;
+}
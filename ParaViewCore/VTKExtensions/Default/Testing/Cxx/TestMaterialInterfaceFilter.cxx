@@ -0,0 +1,189 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestMaterialInterfaceFilter.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include "vtkDataArray.h"
+#include "vtkDummyController.h"
+#include "vtkHierarchicalFractal.h"
+#include "vtkMaterialInterfaceFilter.h"
+#include "vtkMultiBlockDataSet.h"
+#include "vtkNew.h"
+#include "vtkNonOverlappingAMR.h"
+#include "vtkPointData.h"
+#include "vtkPolyData.h"
+#include "vtkTimerLog.h"
+
+#include <vtksys/CommandLineArguments.hxx>
+
+#include <cmath>
+
+#define TEST_SUCCESS 0
+#define TEST_FAILED 1
+
+namespace
+{
+double Extract(vtkMaterialInterfaceFilter* filter, int count)
+{
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  for (int cc = 0; cc < count; ++cc)
+  {
+    filter->Modified();
+    filter->Update();
+  }
+  timer->StopTimer();
+  return timer->GetElapsedTime() / count;
+}
+
+vtkPolyData* GetFragmentCenters(vtkMaterialInterfaceFilter* filter)
+{
+  vtkMultiBlockDataSet* centers =
+    vtkMultiBlockDataSet::SafeDownCast(filter->GetOutputDataObject(1));
+  return centers ? vtkPolyData::SafeDownCast(centers->GetBlock(0)) : NULL;
+}
+
+// Integrated attributes are summed in a different order when multithreaded.
+bool SameArrays(vtkDataArray* first, vtkDataArray* second)
+{
+  if (first->GetNumberOfTuples() != second->GetNumberOfTuples() ||
+    first->GetNumberOfComponents() != second->GetNumberOfComponents())
+  {
+    return false;
+  }
+  const int numComps = first->GetNumberOfComponents();
+  for (vtkIdType cc = 0; cc < first->GetNumberOfTuples(); ++cc)
+  {
+    for (int kk = 0; kk < numComps; ++kk)
+    {
+      double a = first->GetComponent(cc, kk);
+      double b = second->GetComponent(cc, kk);
+      if (std::fabs(a - b) > 1e-9 * (1.0 + std::fabs(a)))
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// The fragments found by the multithreaded filter must be the same as the
+// serial ones, with the same ids.
+bool SameFragments(vtkPolyData* serial, vtkPolyData* threaded)
+{
+  if (serial->GetNumberOfPoints() != threaded->GetNumberOfPoints())
+  {
+    cerr << "Fragment counts differ: " << serial->GetNumberOfPoints() << " (serial) vs. "
+         << threaded->GetNumberOfPoints() << " (multithreaded)" << endl;
+    return false;
+  }
+  if (!SameArrays(serial->GetPoints()->GetData(), threaded->GetPoints()->GetData()))
+  {
+    cerr << "Fragment centers differ." << endl;
+    return false;
+  }
+  vtkPointData* serialPD = serial->GetPointData();
+  vtkPointData* threadedPD = threaded->GetPointData();
+  if (serialPD->GetNumberOfArrays() != threadedPD->GetNumberOfArrays())
+  {
+    cerr << "Number of fragment attributes differs." << endl;
+    return false;
+  }
+  for (int cc = 0; cc < serialPD->GetNumberOfArrays(); ++cc)
+  {
+    vtkDataArray* array = serialPD->GetArray(cc);
+    if (!array)
+    {
+      continue;
+    }
+    vtkDataArray* other = threadedPD->GetArray(array->GetName());
+    if (!other || !SameArrays(array, other))
+    {
+      cerr << "Fragment attribute " << array->GetName() << " differs." << endl;
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+int TestMaterialInterfaceFilter(int argc, char* argv[])
+{
+  int levels = 4;
+  int max_count = 1;
+
+  // Use --levels and --count to use this for benchmarking.
+  vtksys::CommandLineArguments arg;
+  arg.Initialize(argc, argv);
+  typedef vtksys::CommandLineArguments argT;
+  arg.AddArgument(
+    "--levels", argT::EQUAL_ARGUMENT, &levels, "Number of levels of the fractal AMR input.");
+  arg.AddArgument("--count", argT::EQUAL_ARGUMENT, &max_count, "Number of runs to average.");
+  arg.StoreUnusedArguments(true);
+  if (!arg.Parse())
+  {
+    cerr << "Problem parsing arguments" << endl;
+    return TEST_FAILED;
+  }
+
+  // Both the fractal source and the filter use the global controller.
+  vtkNew<vtkDummyController> controller;
+  vtkMultiProcessController::SetGlobalController(controller.GetPointer());
+
+  vtkNew<vtkHierarchicalFractal> fractal;
+  fractal->SetDimensions(10);
+  fractal->SetMaximumLevel(levels);
+  fractal->SetTwoDimensional(0);
+  fractal->SetOverlap(0);
+  fractal->Update();
+  vtkNew<vtkNonOverlappingAMR> input;
+  input->ShallowCopy(fractal->GetOutputDataObject(0));
+
+  vtkNew<vtkMaterialInterfaceFilter> serial;
+  serial->SetUseMultithreading(false);
+  vtkNew<vtkMaterialInterfaceFilter> threaded;
+  vtkMaterialInterfaceFilter* filters[2] = { serial.GetPointer(), threaded.GetPointer() };
+  for (int cc = 0; cc < 2; ++cc)
+  {
+    filters[cc]->SetInputData(input.GetPointer());
+    filters[cc]->SelectMaterialArray("Fractal Volume Fraction");
+    filters[cc]->SelectVolumeWtdAvgArray("TestX");
+    filters[cc]->SetMaterialFractionThreshold(0.5);
+  }
+
+  const double serialTime = Extract(serial.GetPointer(), max_count);
+  const double threadedTime = Extract(threaded.GetPointer(), max_count);
+  vtkPolyData* serialCenters = GetFragmentCenters(serial.GetPointer());
+  vtkPolyData* threadedCenters = GetFragmentCenters(threaded.GetPointer());
+  if (!serialCenters || !threadedCenters)
+  {
+    cerr << "Missing fragment centers." << endl;
+    vtkMultiProcessController::SetGlobalController(NULL);
+    return TEST_FAILED;
+  }
+
+  cout << "Extracting fragments from " << input->GetTotalNumberOfBlocks() << " blocks" << endl;
+  cout << "  serial:        " << serialTime << " s, " << serialCenters->GetNumberOfPoints()
+       << " fragments" << endl;
+  cout << "  multithreaded: " << threadedTime << " s, " << threadedCenters->GetNumberOfPoints()
+       << " fragments" << endl;
+
+  int result = TEST_SUCCESS;
+  if (threadedCenters->GetNumberOfPoints() == 0 ||
+    !SameFragments(serialCenters, threadedCenters))
+  {
+    result = TEST_FAILED;
+  }
+  vtkMultiProcessController::SetGlobalController(NULL);
+  return result;
+}
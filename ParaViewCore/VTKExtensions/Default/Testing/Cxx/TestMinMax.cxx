@@ -0,0 +1,212 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestMinMax.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkDataSetAttributes.h"
+#include "vtkDoubleArray.h"
+#include "vtkFloatArray.h"
+#include "vtkIntArray.h"
+#include "vtkMinMax.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkUnsignedCharArray.h"
+
+#include <algorithm>
+#include <cmath>
+
+#define TEST_SUCCESS 0
+#define TEST_FAILED 1
+
+namespace
+{
+// Large enough for the arrays to be split into several chunks.
+const vtkIdType NumberOfPoints = 100000;
+const vtkIdType NumberOfCells = 10;
+
+bool IsGhost(vtkIdType ptId)
+{
+  return ptId % 7 == 3;
+}
+
+double ScalarValue(vtkIdType ptId)
+{
+  return std::sin(0.001 * ptId) * 100.0 + 0.5 * (ptId % 13);
+}
+
+int VectorValue(vtkIdType ptId, int comp)
+{
+  return static_cast<int>((ptId * (comp + 3)) % 1001) - 500;
+}
+
+void MakeInput(vtkPolyData* input)
+{
+  vtkNew<vtkPoints> points;
+  points->SetNumberOfPoints(NumberOfPoints);
+  vtkNew<vtkDoubleArray> scalars;
+  scalars->SetName("scalars");
+  scalars->SetNumberOfTuples(NumberOfPoints);
+  vtkNew<vtkIntArray> vectors;
+  vectors->SetName("vectors");
+  vectors->SetNumberOfComponents(3);
+  vectors->SetNumberOfTuples(NumberOfPoints);
+  vtkNew<vtkUnsignedCharArray> pointGhosts;
+  pointGhosts->SetName(vtkDataSetAttributes::GhostArrayName());
+  pointGhosts->SetNumberOfTuples(NumberOfPoints);
+  for (vtkIdType cc = 0; cc < NumberOfPoints; ++cc)
+  {
+    points->SetPoint(cc, static_cast<double>(cc), 0.0, 0.0);
+    scalars->SetValue(cc, ScalarValue(cc));
+    for (int kk = 0; kk < 3; ++kk)
+    {
+      vectors->SetTypedComponent(cc, kk, VectorValue(cc, kk));
+    }
+    pointGhosts->SetValue(cc, IsGhost(cc) ? vtkDataSetAttributes::DUPLICATEPOINT : 0);
+  }
+  input->SetPoints(points.GetPointer());
+  input->GetPointData()->AddArray(scalars.GetPointer());
+  input->GetPointData()->AddArray(vectors.GetPointer());
+  input->GetPointData()->AddArray(pointGhosts.GetPointer());
+
+  // all cells are ghosts, so no cell value is ever initialized
+  vtkNew<vtkCellArray> verts;
+  vtkNew<vtkFloatArray> cellValues;
+  cellValues->SetName("cellvalues");
+  vtkNew<vtkUnsignedCharArray> cellGhosts;
+  cellGhosts->SetName(vtkDataSetAttributes::GhostArrayName());
+  for (vtkIdType cc = 0; cc < NumberOfCells; ++cc)
+  {
+    verts->InsertNextCell(1, &cc);
+    cellValues->InsertNextValue(static_cast<float>(cc + 1));
+    cellGhosts->InsertNextValue(vtkDataSetAttributes::DUPLICATECELL);
+  }
+  input->SetVerts(verts.GetPointer());
+  input->GetCellData()->AddArray(cellValues.GetPointer());
+  input->GetCellData()->AddArray(cellGhosts.GetPointer());
+}
+
+// Computes the expected result serially, one tuple at a time.
+double Expected(int operation, vtkIdType numTuples, double (*value)(vtkIdType, int), int comp)
+{
+  bool first = true;
+  double result = 0.0;
+  for (vtkIdType cc = 0; cc < numTuples; ++cc)
+  {
+    if (IsGhost(cc))
+    {
+      continue;
+    }
+    const double v = value(cc, comp);
+    if (first)
+    {
+      result = v;
+      first = false;
+    }
+    else if (operation == vtkMinMax::MIN)
+    {
+      result = std::min(result, v);
+    }
+    else if (operation == vtkMinMax::MAX)
+    {
+      result = std::max(result, v);
+    }
+    else
+    {
+      result += v;
+    }
+  }
+  return result;
+}
+
+double Scalar(vtkIdType ptId, int)
+{
+  return ScalarValue(ptId);
+}
+
+double Vector(vtkIdType ptId, int comp)
+{
+  return VectorValue(ptId, comp);
+}
+
+bool Check(const char* name, int operation, double result, double expected)
+{
+  // sums are accumulated per chunk, so they may differ in the last bits
+  const double tolerance = operation == vtkMinMax::SUM ? 1e-9 * (1.0 + std::fabs(expected)) : 0.0;
+  if (std::fabs(result - expected) > tolerance)
+  {
+    cerr << name << " (operation " << operation << "): got " << result << ", expected " << expected
+         << endl;
+    return false;
+  }
+  return true;
+}
+}
+
+int TestMinMax(int, char* [])
+{
+  vtkNew<vtkPolyData> input;
+  MakeInput(input.GetPointer());
+
+  vtkNew<vtkMinMax> minMax;
+  minMax->SetInputData(input.GetPointer());
+  const int operations[3] = { vtkMinMax::MIN, vtkMinMax::MAX, vtkMinMax::SUM };
+  for (int op = 0; op < 3; ++op)
+  {
+    minMax->SetOperation(operations[op]);
+    minMax->Update();
+    vtkPolyData* output = minMax->GetOutput();
+    if (minMax->GetMismatchOccurred())
+    {
+      cerr << "Unexpected mismatch." << endl;
+      return TEST_FAILED;
+    }
+
+    vtkDataArray* scalars = output->GetPointData()->GetArray("scalars");
+    vtkDataArray* vectors = output->GetPointData()->GetArray("vectors");
+    vtkDataArray* cellValues = output->GetCellData()->GetArray("cellvalues");
+    if (!scalars || !vectors || !cellValues || scalars->GetNumberOfTuples() != 1 ||
+      vectors->GetNumberOfTuples() != 1 || cellValues->GetNumberOfTuples() != 1)
+    {
+      cerr << "Missing output arrays." << endl;
+      return TEST_FAILED;
+    }
+
+    if (!Check("scalars", operations[op], scalars->GetComponent(0, 0),
+          Expected(operations[op], NumberOfPoints, Scalar, 0)))
+    {
+      return TEST_FAILED;
+    }
+    for (int kk = 0; kk < 3; ++kk)
+    {
+      if (!Check("vectors", operations[op], vectors->GetComponent(0, kk),
+            Expected(operations[op], NumberOfPoints, Vector, kk)))
+      {
+        return TEST_FAILED;
+      }
+    }
+
+    // the cell values were never initialized, they must be reset to zero
+    if (cellValues->GetComponent(0, 0) != 0.0)
+    {
+      cerr << "Uninitialized cell value is " << cellValues->GetComponent(0, 0)
+           << ", expected 0." << endl;
+      return TEST_FAILED;
+    }
+  }
+
+  return TEST_SUCCESS;
+}
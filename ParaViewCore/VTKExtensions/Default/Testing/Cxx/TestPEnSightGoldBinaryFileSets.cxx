@@ -0,0 +1,287 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestPEnSightGoldBinaryFileSets.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include "vtkByteSwap.h"
+#include "vtkDataArray.h"
+#include "vtkDummyController.h"
+#include "vtkIdList.h"
+#include "vtkMultiBlockDataSet.h"
+#include "vtkNew.h"
+#include "vtkPEnSightGoldBinaryReader.h"
+#include "vtkPointData.h"
+#include "vtkSmartPointer.h"
+#include "vtkTestUtilities.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#define TEST_SUCCESS 0
+#define TEST_FAILED 1
+
+namespace
+{
+const int NumberOfSteps = 4;
+const int NumberOfPoints = 6;
+const int NumberOfTriangles = NumberOfPoints - 2;
+
+// Writes big endian EnSight Gold binary records.
+class Writer
+{
+public:
+  Writer(const std::string& fileName)
+    : Stream(fileName.c_str(), ios::out | ios::binary)
+  {
+  }
+
+  bool Good() const { return this->Stream.good(); }
+
+  void Line(const char* text)
+  {
+    char line[80];
+    memset(line, 0, sizeof(line));
+    strncpy(line, text, sizeof(line) - 1);
+    this->Stream.write(line, sizeof(line));
+  }
+
+  void Ints(std::vector<int> values)
+  {
+    vtkByteSwap::Swap4BERange(&values[0], values.size());
+    this->Stream.write(reinterpret_cast<char*>(&values[0]), values.size() * sizeof(int));
+  }
+
+  void Floats(std::vector<float> values)
+  {
+    vtkByteSwap::Swap4BERange(&values[0], values.size());
+    this->Stream.write(reinterpret_cast<char*>(&values[0]), values.size() * sizeof(float));
+  }
+
+private:
+  std::ofstream Stream;
+};
+
+// Point i of step t is at (i, t, i % 2), and its temperature is 10 t + i.
+double Coordinate(int step, int point, int component)
+{
+  return component == 0 ? point : (component == 1 ? step : point % 2);
+}
+
+double Temperature(int step, int point)
+{
+  return 10.0 * step + point;
+}
+
+// Writes a case with one file set for the geometry and one for a scalar per
+// node, every time step of a file set being in the same file.
+bool WriteCase(const std::string& dir)
+{
+  std::ofstream caseFile((dir + "/TestPEnSightGoldBinaryFileSets.case").c_str());
+  caseFile << "FORMAT\n"
+           << "type: ensight gold\n\n"
+           << "GEOMETRY\n"
+           << "model: 1 1 TestPEnSightGoldBinaryFileSets.geo\n\n"
+           << "VARIABLE\n"
+           << "scalar per node: 1 1 temperature TestPEnSightGoldBinaryFileSets.temperature\n\n"
+           << "TIME\n"
+           << "time set: 1\n"
+           << "number of steps: " << NumberOfSteps << "\n"
+           << "time values:";
+  for (int step = 0; step < NumberOfSteps; ++step)
+  {
+    caseFile << " " << step;
+  }
+  caseFile << "\n\nFILE\n"
+           << "file set: 1\n"
+           << "number of steps: " << NumberOfSteps << "\n";
+  if (!caseFile.good())
+  {
+    return false;
+  }
+
+  Writer geometry(dir + "/TestPEnSightGoldBinaryFileSets.geo");
+  Writer temperature(dir + "/TestPEnSightGoldBinaryFileSets.temperature");
+  geometry.Line("C Binary");
+  for (int step = 0; step < NumberOfSteps; ++step)
+  {
+    geometry.Line("BEGIN TIME STEP");
+    geometry.Line("TestPEnSightGoldBinaryFileSets");
+    geometry.Line("geometry");
+    geometry.Line("node id off");
+    geometry.Line("element id off");
+    geometry.Line("part");
+    geometry.Ints(std::vector<int>(1, 1));
+    geometry.Line("strip");
+    geometry.Line("coordinates");
+    geometry.Ints(std::vector<int>(1, NumberOfPoints));
+    std::vector<float> coords(NumberOfPoints);
+    for (int component = 0; component < 3; ++component)
+    {
+      for (int ii = 0; ii < NumberOfPoints; ++ii)
+      {
+        coords[ii] = static_cast<float>(Coordinate(step, ii, component));
+      }
+      geometry.Floats(coords);
+    }
+    geometry.Line("tria3");
+    geometry.Ints(std::vector<int>(1, NumberOfTriangles));
+    std::vector<int> connectivity;
+    for (int ii = 0; ii < NumberOfTriangles; ++ii)
+    {
+      // EnSight numbers points from 1.
+      connectivity.push_back(ii + 1);
+      connectivity.push_back(ii + 2);
+      connectivity.push_back(ii + 3);
+    }
+    geometry.Ints(connectivity);
+    geometry.Line("END TIME STEP");
+
+    temperature.Line("BEGIN TIME STEP");
+    temperature.Line("temperature");
+    temperature.Line("part");
+    temperature.Ints(std::vector<int>(1, 1));
+    temperature.Line("coordinates");
+    std::vector<float> values(NumberOfPoints);
+    for (int ii = 0; ii < NumberOfPoints; ++ii)
+    {
+      values[ii] = static_cast<float>(Temperature(step, ii));
+    }
+    temperature.Floats(values);
+    temperature.Line("END TIME STEP");
+  }
+  return geometry.Good() && temperature.Good();
+}
+
+void SetupReader(vtkPEnSightGoldBinaryReader* reader, const std::string& dir, bool mapped)
+{
+  reader->SetFilePath(dir.c_str());
+  reader->SetCaseFileName("TestPEnSightGoldBinaryFileSets.case");
+  reader->SetByteOrderToBigEndian();
+  reader->SetUseMemoryMapping(mapped ? 1 : 0);
+}
+
+vtkUnstructuredGrid* GetPart(vtkPEnSightGoldBinaryReader* reader)
+{
+  vtkMultiBlockDataSet* output = vtkMultiBlockDataSet::SafeDownCast(reader->GetOutputDataObject(0));
+  return output ? vtkUnstructuredGrid::SafeDownCast(output->GetBlock(0)) : NULL;
+}
+
+// The part read from the mapped files must be the one read through a stream,
+// and must have the values written for the step.
+bool CheckPart(vtkUnstructuredGrid* mapped, vtkUnstructuredGrid* streamed, int step)
+{
+  if (!mapped || !streamed)
+  {
+    cerr << "Missing part for step " << step << endl;
+    return false;
+  }
+  if (mapped->GetNumberOfPoints() != NumberOfPoints ||
+    streamed->GetNumberOfPoints() != NumberOfPoints ||
+    mapped->GetNumberOfCells() != NumberOfTriangles ||
+    streamed->GetNumberOfCells() != NumberOfTriangles)
+  {
+    cerr << "Wrong number of points or cells for step " << step << endl;
+    return false;
+  }
+  vtkDataArray* mappedValues = mapped->GetPointData()->GetArray("temperature");
+  vtkDataArray* streamedValues = streamed->GetPointData()->GetArray("temperature");
+  if (!mappedValues || !streamedValues)
+  {
+    cerr << "Missing temperature for step " << step << endl;
+    return false;
+  }
+  for (vtkIdType ii = 0; ii < NumberOfPoints; ++ii)
+  {
+    double first[3], second[3];
+    mapped->GetPoint(ii, first);
+    streamed->GetPoint(ii, second);
+    for (int component = 0; component < 3; ++component)
+    {
+      if (first[component] != second[component] ||
+        first[component] != Coordinate(step, ii, component))
+      {
+        cerr << "Wrong coordinates for point " << ii << " of step " << step << endl;
+        return false;
+      }
+    }
+    if (mappedValues->GetTuple1(ii) != streamedValues->GetTuple1(ii) ||
+      mappedValues->GetTuple1(ii) != Temperature(step, ii))
+    {
+      cerr << "Wrong temperature for point " << ii << " of step " << step << endl;
+      return false;
+    }
+  }
+  vtkNew<vtkIdList> first;
+  vtkNew<vtkIdList> second;
+  for (vtkIdType cc = 0; cc < NumberOfTriangles; ++cc)
+  {
+    mapped->GetCellPoints(cc, first.GetPointer());
+    streamed->GetCellPoints(cc, second.GetPointer());
+    bool same = first->GetNumberOfIds() == 3 && second->GetNumberOfIds() == 3;
+    for (vtkIdType kk = 0; same && kk < 3; ++kk)
+    {
+      same = first->GetId(kk) == second->GetId(kk);
+    }
+    if (!same)
+    {
+      cerr << "Cell " << cc << " of step " << step << " differs." << endl;
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+int TestPEnSightGoldBinaryFileSets(int argc, char* argv[])
+{
+  // The reader distributes the parts over the processes of the global
+  // controller.
+  vtkNew<vtkDummyController> controller;
+  vtkMultiProcessController::SetGlobalController(controller.GetPointer());
+
+  char* tempDir =
+    vtkTestUtilities::GetArgOrEnvOrDefault("-T", argc, argv, "VTK_TEMP_DIR", "Testing/Temporary");
+  const std::string dir = tempDir;
+  delete[] tempDir;
+
+  int result = TEST_SUCCESS;
+  if (!WriteCase(dir))
+  {
+    cerr << "Could not write the case to " << dir << endl;
+    result = TEST_FAILED;
+  }
+
+  // Steps are read out of order with one reader, so that cached time step
+  // offsets are used both backward and forward. Every step is compared with
+  // the one read through a stream by a new reader.
+  const int steps[] = { 2, 0, 3, 1, 1, 0, 3 };
+  vtkNew<vtkPEnSightGoldBinaryReader> mapped;
+  SetupReader(mapped.GetPointer(), dir, true);
+  for (size_t cc = 0; result == TEST_SUCCESS && cc < sizeof(steps) / sizeof(steps[0]); ++cc)
+  {
+    mapped->UpdateTimeStep(steps[cc]);
+    vtkNew<vtkPEnSightGoldBinaryReader> streamed;
+    SetupReader(streamed.GetPointer(), dir, false);
+    streamed->UpdateTimeStep(steps[cc]);
+    if (!CheckPart(GetPart(mapped.GetPointer()), GetPart(streamed.GetPointer()), steps[cc]))
+    {
+      result = TEST_FAILED;
+    }
+  }
+
+  vtkMultiProcessController::SetGlobalController(NULL);
+  return result;
+}
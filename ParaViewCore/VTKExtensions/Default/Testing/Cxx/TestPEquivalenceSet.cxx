@@ -0,0 +1,117 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestPEquivalenceSet.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include "vtkMPIController.h"
+#include "vtkNew.h"
+#include "vtkPEquivalenceSet.h"
+#include "vtkProcessGroup.h"
+
+#define TEST_SUCCESS 0
+#define TEST_FAILED 1
+
+namespace
+{
+// Members [0, NumberOfMembers) are linked in runs of RunLength, the links
+// being spread over all processes. The last process also has ExtraMembers
+// members that are not linked to anything.
+const vtkIdType NumberOfMembers = 60;
+const vtkIdType RunLength = 10;
+const vtkIdType ExtraMembers = 5;
+
+// Resolves the equivalences with the processes of `controller`, which is
+// the global controller while this runs. Each process only has the links
+// (k, k + 1) for which k % numProcs is its rank, so that every process holds
+// links the others do not have.
+bool ResolveOn(vtkMultiProcessController* controller)
+{
+  const int myId = controller->GetLocalProcessId();
+  const int numProcs = controller->GetNumberOfProcesses();
+  vtkNew<vtkPEquivalenceSet> set;
+  for (vtkIdType kk = myId; kk + 1 < NumberOfMembers; kk += numProcs)
+  {
+    if (kk % RunLength != RunLength - 1)
+    {
+      set->AddEquivalence(kk, kk + 1);
+    }
+  }
+  if (myId == numProcs - 1)
+  {
+    set->SetNumberOfMembers(NumberOfMembers + ExtraMembers);
+  }
+
+  const vtkIdType expectedSets = NumberOfMembers / RunLength + ExtraMembers;
+  vtkIdType numSets = set->ResolveEquivalences();
+  if (numSets != expectedSets || set->GetNumberOfMembers() != NumberOfMembers + ExtraMembers)
+  {
+    cerr << "With " << numProcs << " processes, process " << myId << " got " << numSets
+         << " sets and " << set->GetNumberOfMembers() << " members, expected " << expectedSets
+         << " sets and " << NumberOfMembers + ExtraMembers << " members." << endl;
+    return false;
+  }
+  for (vtkIdType cc = 0; cc < NumberOfMembers + ExtraMembers; ++cc)
+  {
+    const vtkIdType expected =
+      cc < NumberOfMembers ? cc / RunLength : NumberOfMembers / RunLength + cc - NumberOfMembers;
+    if (set->GetEquivalentSetId(cc) != expected)
+    {
+      cerr << "With " << numProcs << " processes, member " << cc << " is in set "
+           << set->GetEquivalentSetId(cc) << ", expected " << expected << endl;
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+int TestPEquivalenceSet(int argc, char* argv[])
+{
+  vtkNew<vtkMPIController> controller;
+  controller->Initialize(&argc, &argv, 0);
+  const int myId = controller->GetLocalProcessId();
+
+  // Reduce over the first 1, 2, ... processes, so that process counts that
+  // are not powers of 2 (3, 5, 6 when running on 6 processes) are covered.
+  int valid = 1;
+  for (int numProcs = 1; numProcs <= controller->GetNumberOfProcesses(); ++numProcs)
+  {
+    vtkNew<vtkProcessGroup> group;
+    group->Initialize(controller.GetPointer());
+    group->RemoveAllProcessIds();
+    for (int cc = 0; cc < numProcs; ++cc)
+    {
+      group->AddProcessId(cc);
+    }
+    vtkMultiProcessController* subController = controller->CreateSubController(group.GetPointer());
+    int localValid = 1;
+    if (subController)
+    {
+      vtkMultiProcessController::SetGlobalController(subController);
+      localValid = ResolveOn(subController) ? 1 : 0;
+      vtkMultiProcessController::SetGlobalController(controller.GetPointer());
+      subController->Delete();
+    }
+    int allValid = 0;
+    controller->AllReduce(&localValid, &allValid, 1, vtkCommunicator::MIN_OP);
+    valid = valid && allValid;
+  }
+  if (myId == 0 && !valid)
+  {
+    cerr << "Equivalences were lost while reducing them." << endl;
+  }
+
+  vtkMultiProcessController::SetGlobalController(NULL);
+  controller->Finalize();
+  return valid ? TEST_SUCCESS : TEST_FAILED;
+}
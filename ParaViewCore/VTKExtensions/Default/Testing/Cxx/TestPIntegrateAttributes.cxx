@@ -0,0 +1,184 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestPIntegrateAttributes.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkDoubleArray.h"
+#include "vtkImageData.h"
+#include "vtkIntegrateAttributes.h"
+#include "vtkMPIController.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkProcessGroup.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+#define TEST_SUCCESS 0
+#define TEST_FAILED 1
+
+namespace
+{
+// Every third process has a volume, the others a surface, so that pieces of
+// a higher dimension arrive at processes that integrated a surface while the
+// pieces are reduced, and surfaces arrive at processes that have a volume.
+bool HasVolume(int processId)
+{
+  return processId % 3 == 2;
+}
+
+// The 2x3(x4) cells of process `processId`, starting at x = 10 processId.
+void CreatePiece(int processId, vtkImageData* image)
+{
+  image->SetDimensions(3, 4, HasVolume(processId) ? 5 : 1);
+  image->SetOrigin(10.0 * processId, 0.0, 0.0);
+  image->SetSpacing(1.0, 1.0, 1.0);
+
+  vtkNew<vtkDoubleArray> pressure;
+  pressure->SetName("pressure");
+  pressure->SetNumberOfTuples(image->GetNumberOfPoints());
+  pressure->FillComponent(0, 2.0);
+  image->GetPointData()->AddArray(pressure.GetPointer());
+
+  vtkNew<vtkDoubleArray> density;
+  density->SetName("density");
+  density->SetNumberOfTuples(image->GetNumberOfCells());
+  density->FillComponent(0, processId + 1.0);
+  image->GetCellData()->AddArray(density.GetPointer());
+}
+
+bool Close(double a, double b)
+{
+  return fabs(a - b) <= 1e-12 * std::max(1.0, std::max(fabs(a), fabs(b)));
+}
+
+bool CheckValue(vtkDataSetAttributes* data, const char* name, double expected, int numProcs)
+{
+  vtkDataArray* array = data->GetArray(name);
+  if (!array || array->GetNumberOfTuples() != 1)
+  {
+    cerr << "With " << numProcs << " processes, " << name << " is missing." << endl;
+    return false;
+  }
+  if (!Close(array->GetComponent(0, 0), expected))
+  {
+    cerr << "With " << numProcs << " processes, " << name << " is " << array->GetComponent(0, 0)
+         << ", expected " << expected << endl;
+    return false;
+  }
+  return true;
+}
+
+// Integrates the pieces of the processes of `controller` and checks the
+// result on process 0: only the pieces of the highest dimension count.
+bool IntegrateOn(vtkMultiProcessController* controller)
+{
+  const int myId = controller->GetLocalProcessId();
+  const int numProcs = controller->GetNumberOfProcesses();
+  vtkNew<vtkImageData> piece;
+  CreatePiece(myId, piece.GetPointer());
+  vtkNew<vtkIntegrateAttributes> integrate;
+  integrate->SetController(controller);
+  integrate->SetInputData(piece.GetPointer());
+  integrate->Update();
+  if (myId != 0)
+  {
+    return true;
+  }
+
+  bool volume = false;
+  for (int cc = 0; cc < numProcs; ++cc)
+  {
+    volume = volume || HasVolume(cc);
+  }
+  const double measure = volume ? 24.0 : 6.0;
+  double sum = 0.0, density = 0.0, center = 0.0;
+  for (int cc = 0; cc < numProcs; ++cc)
+  {
+    if (HasVolume(cc) == volume)
+    {
+      sum += measure;
+      density += measure * (cc + 1);
+      center += measure * (10.0 * cc + 1.0);
+    }
+  }
+
+  vtkUnstructuredGrid* output = integrate->GetOutput();
+  const char* measureName = volume ? "Volume" : "Area";
+  const char* otherName = volume ? "Area" : "Volume";
+  if (output->GetCellData()->GetArray(otherName))
+  {
+    cerr << "With " << numProcs << " processes, the output has an " << otherName << " array."
+         << endl;
+    return false;
+  }
+  if (!CheckValue(output->GetCellData(), measureName, sum, numProcs) ||
+    !CheckValue(output->GetCellData(), "density", density, numProcs) ||
+    !CheckValue(output->GetPointData(), "pressure", 2.0 * sum, numProcs))
+  {
+    return false;
+  }
+  double x[3];
+  output->GetPoint(0, x);
+  if (!Close(x[0], center / sum) || !Close(x[1], 1.5) || !Close(x[2], volume ? 2.0 : 0.0))
+  {
+    cerr << "With " << numProcs << " processes, the center is (" << x[0] << ", " << x[1] << ", "
+         << x[2] << ")" << endl;
+    return false;
+  }
+  return true;
+}
+}
+
+int TestPIntegrateAttributes(int argc, char* argv[])
+{
+  vtkNew<vtkMPIController> controller;
+  controller->Initialize(&argc, &argv, 0);
+  vtkMultiProcessController::SetGlobalController(controller.GetPointer());
+  const int myId = controller->GetLocalProcessId();
+
+  // Reduce over the first 1, 2, ... processes, so that process counts that
+  // are not powers of 2 (3 and 5 when running on 5 processes) are covered.
+  int valid = 1;
+  for (int numProcs = 1; numProcs <= controller->GetNumberOfProcesses(); ++numProcs)
+  {
+    vtkNew<vtkProcessGroup> group;
+    group->Initialize(controller.GetPointer());
+    group->RemoveAllProcessIds();
+    for (int cc = 0; cc < numProcs; ++cc)
+    {
+      group->AddProcessId(cc);
+    }
+    vtkMultiProcessController* subController = controller->CreateSubController(group.GetPointer());
+    int localValid = 1;
+    if (subController)
+    {
+      localValid = IntegrateOn(subController) ? 1 : 0;
+      subController->Delete();
+    }
+    int allValid = 0;
+    controller->AllReduce(&localValid, &allValid, 1, vtkCommunicator::MIN_OP);
+    valid = valid && allValid;
+  }
+  if (myId == 0 && !valid)
+  {
+    cerr << "The integration was not reduced correctly." << endl;
+  }
+
+  vtkMultiProcessController::SetGlobalController(NULL);
+  controller->Finalize();
+  return valid ? TEST_SUCCESS : TEST_FAILED;
+}
@@ -0,0 +1,299 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestPPhastaReaderTimeSteps.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include "vtkDataArray.h"
+#include "vtkMultiBlockDataSet.h"
+#include "vtkMultiPieceDataSet.h"
+#include "vtkNew.h"
+#include "vtkPPhastaReader.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkSmartPointer.h"
+#include "vtkTestUtilities.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#define TEST_SUCCESS 0
+#define TEST_FAILED 1
+
+namespace
+{
+const int NumberOfPoints = 8;
+const int NumberOfVariables = 5;
+
+// The geometry used by each time step: the field files of steps 0 to 2 share
+// the first geometry file, step 3 uses another one.
+const int GeometryIndices[] = { 0, 0, 0, 1 };
+const int NumberOfSteps = sizeof(GeometryIndices) / sizeof(GeometryIndices[0]);
+
+// Writes phasta binary files: text headers, each followed by a block of data
+// ended by a newline, in the native byte order.
+class Writer
+{
+public:
+  Writer(const std::string& fileName)
+    : Stream(fileName.c_str(), ios::out | ios::binary)
+  {
+    this->Stream << "# PHASTA Input File Version 2.0\n";
+    const int magic = 362436;
+    this->Stream << "byteorder magic number : < " << sizeof(int) + 1 << " > 1\n";
+    this->Data(&magic, 1);
+  }
+
+  bool Good() const { return this->Stream.good(); }
+
+  // A header without data block.
+  void Header(const char* key, int value)
+  {
+    this->Stream << key << " : < 0 > " << value << "\n";
+  }
+
+  template <class T>
+  void Block(const char* key, const std::vector<T>& values, const char* params)
+  {
+    this->Stream << key << " : < " << values.size() * sizeof(T) + 1 << " > " << params << "\n";
+    this->Data(&values[0], values.size());
+  }
+
+  void Raw(const std::string& text) { this->Stream << text; }
+
+private:
+  template <class T>
+  void Data(const T* values, size_t count)
+  {
+    this->Stream.write(reinterpret_cast<const char*>(values), count * sizeof(T));
+    this->Stream << "\n";
+  }
+
+  std::ofstream Stream;
+};
+
+// The corners of a cube of side `geometry` + 1.
+double Coordinate(int geometry, int point, int component)
+{
+  static const int corners[NumberOfPoints][3] = { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 },
+    { 0, 1, 0 }, { 0, 0, 1 }, { 1, 0, 1 }, { 1, 1, 1 }, { 0, 1, 1 } };
+  return (geometry + 1.0) * corners[point][component];
+}
+
+// Variable 0 is the pressure, 1 to 3 the velocity and 4 the temperature.
+double Variable(int step, int point, int variable)
+{
+  switch (variable)
+  {
+    case 0:
+      return 10.0 * step + point;
+    case 1:
+      return point;
+    case 2:
+      return step;
+    case 3:
+      return -point;
+    default:
+      return 100.0 + step;
+  }
+}
+
+std::string FileName(const std::string& dir, const char* kind, int index)
+{
+  std::ostringstream name;
+  name << dir << "/TestPPhastaReaderTimeSteps." << kind << "." << index << ".1";
+  return name.str();
+}
+
+bool WriteGeometry(const std::string& dir, int geometry)
+{
+  Writer writer(FileName(dir, "geombc", geometry));
+  writer.Header("number of nodes", NumberOfPoints);
+  writer.Header("number of interior elements", 1);
+  writer.Header("number of interior tpblocks", 1);
+  std::vector<double> coords;
+  for (int component = 0; component < 3; ++component)
+  {
+    for (int point = 0; point < NumberOfPoints; ++point)
+    {
+      coords.push_back(Coordinate(geometry, point, component));
+    }
+  }
+  writer.Block("co-ordinates", coords, "8 3");
+  // One hexahedron, numbering points from 1.
+  std::vector<int> connectivity;
+  for (int point = 0; point < NumberOfPoints; ++point)
+  {
+    connectivity.push_back(point + 1);
+  }
+  writer.Block("connectivity interior", connectivity, "1 8 0 8 0 0 0");
+  return writer.Good();
+}
+
+// The solution block of every field file follows a "decoy" block. In the
+// field file of step 1, the size of the decoy block is wrong, so that the
+// solution block cannot be found by scanning the headers from the start of
+// the file: it is only read if the reader seeks straight to the header
+// offset found in the field file of step 0. The field file of step 2 has an
+// additional block first, so that the offset found in step 1 is stale.
+bool WriteField(const std::string& dir, int step)
+{
+  Writer writer(FileName(dir, "restart", step));
+  if (step == 2)
+  {
+    writer.Raw("extra : < 0064 > 1\n" + std::string(63, '.') + "\n");
+  }
+  writer.Raw(step == 1 ? "decoy : < 9999 > 1\n" : "decoy : < 0016 > 1\n");
+  writer.Raw(std::string(15, '.') + "\n");
+  std::vector<double> solution;
+  for (int variable = 0; variable < NumberOfVariables; ++variable)
+  {
+    for (int point = 0; point < NumberOfPoints; ++point)
+    {
+      solution.push_back(Variable(step, point, variable));
+    }
+  }
+  writer.Block("solution", solution, "8 5 1");
+  return writer.Good();
+}
+
+bool WriteFiles(const std::string& dir)
+{
+  std::ofstream metaFile((dir + "/TestPPhastaReaderTimeSteps.pht").c_str());
+  metaFile << "<?xml version=\"1.0\" ?>\n"
+           << "<PhastaMetaFile number_of_pieces=\"1\">\n"
+           << "  <GeometryFileNamePattern pattern=\"TestPPhastaReaderTimeSteps.geombc.%d.%d\"\n"
+           << "    has_piece_entry=\"1\" has_time_entry=\"1\"/>\n"
+           << "  <FieldFileNamePattern pattern=\"TestPPhastaReaderTimeSteps.restart.%d.%d\"\n"
+           << "    has_piece_entry=\"1\" has_time_entry=\"1\"/>\n"
+           << "  <TimeSteps number_of_steps=\"" << NumberOfSteps << "\">\n";
+  for (int step = 0; step < NumberOfSteps; ++step)
+  {
+    metaFile << "    <TimeStep index=\"" << step << "\" geometry_index=\""
+             << GeometryIndices[step] << "\" field_index=\"" << step << "\" value=\"" << step
+             << "\"/>\n";
+  }
+  metaFile << "  </TimeSteps>\n"
+           << "</PhastaMetaFile>\n";
+  if (!metaFile.good())
+  {
+    return false;
+  }
+
+  bool valid = WriteGeometry(dir, 0) && WriteGeometry(dir, 1);
+  for (int step = 0; valid && step < NumberOfSteps; ++step)
+  {
+    valid = WriteField(dir, step);
+  }
+  return valid;
+}
+
+vtkUnstructuredGrid* GetPiece(vtkPPhastaReader* reader)
+{
+  vtkMultiBlockDataSet* output = vtkMultiBlockDataSet::SafeDownCast(reader->GetOutputDataObject(0));
+  vtkMultiPieceDataSet* pieces =
+    output ? vtkMultiPieceDataSet::SafeDownCast(output->GetBlock(0)) : NULL;
+  return pieces ? vtkUnstructuredGrid::SafeDownCast(pieces->GetPiece(0)) : NULL;
+}
+
+// The piece must have the points of the geometry of the step and the
+// variables of its field file.
+bool CheckPiece(vtkUnstructuredGrid* piece, int step)
+{
+  if (!piece || piece->GetNumberOfPoints() != NumberOfPoints || piece->GetNumberOfCells() != 1)
+  {
+    cerr << "Wrong piece for step " << step << endl;
+    return false;
+  }
+  vtkDataArray* pressure = piece->GetPointData()->GetArray("pressure");
+  vtkDataArray* velocity = piece->GetPointData()->GetArray("velocity");
+  vtkDataArray* temperature = piece->GetPointData()->GetArray("temperature");
+  if (!pressure || !velocity || !temperature)
+  {
+    cerr << "Missing arrays for step " << step << endl;
+    return false;
+  }
+  for (vtkIdType point = 0; point < NumberOfPoints; ++point)
+  {
+    double x[3];
+    piece->GetPoint(point, x);
+    for (int component = 0; component < 3; ++component)
+    {
+      if (x[component] != Coordinate(GeometryIndices[step], point, component))
+      {
+        cerr << "Wrong coordinates for point " << point << " of step " << step << endl;
+        return false;
+      }
+    }
+    double* v = velocity->GetTuple3(point);
+    if (pressure->GetTuple1(point) != Variable(step, point, 0) ||
+      v[0] != Variable(step, point, 1) || v[1] != Variable(step, point, 2) ||
+      v[2] != Variable(step, point, 3) || temperature->GetTuple1(point) != Variable(step, point, 4))
+    {
+      cerr << "Wrong values for point " << point << " of step " << step << endl;
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+int TestPPhastaReaderTimeSteps(int argc, char* argv[])
+{
+  char* tempDir =
+    vtkTestUtilities::GetArgOrEnvOrDefault("-T", argc, argv, "VTK_TEMP_DIR", "Testing/Temporary");
+  const std::string dir = tempDir;
+  delete[] tempDir;
+
+  if (!WriteFiles(dir))
+  {
+    cerr << "Could not write the phasta files to " << dir << endl;
+    return TEST_FAILED;
+  }
+
+  // Step 0 is read again last, after the geometry changed, and with a stale
+  // header offset.
+  const int steps[] = { 0, 1, 2, 3, 0 };
+  vtkNew<vtkPPhastaReader> reader;
+  const std::string fileName = dir + "/TestPPhastaReaderTimeSteps.pht";
+  reader->SetFileName(fileName.c_str());
+  vtkSmartPointer<vtkPoints> previousPoints;
+  int result = TEST_SUCCESS;
+  for (size_t cc = 0; result == TEST_SUCCESS && cc < sizeof(steps) / sizeof(steps[0]); ++cc)
+  {
+    const int step = steps[cc];
+    reader->UpdateTimeStep(step);
+    vtkUnstructuredGrid* piece = GetPiece(reader.GetPointer());
+    if (!CheckPiece(piece, step))
+    {
+      result = TEST_FAILED;
+      break;
+    }
+
+    // The mesh is only read again when the geometry file changes.
+    if (cc > 0)
+    {
+      const bool sameGeometry = GeometryIndices[step] == GeometryIndices[steps[cc - 1]];
+      if (sameGeometry != (piece->GetPoints() == previousPoints))
+      {
+        cerr << "The cached mesh was " << (sameGeometry ? "not " : "") << "used for step " << step
+             << endl;
+        result = TEST_FAILED;
+      }
+    }
+    previousPoints = piece->GetPoints();
+  }
+  return result;
+}
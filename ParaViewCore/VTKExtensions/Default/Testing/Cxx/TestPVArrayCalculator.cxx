@@ -0,0 +1,157 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestPVArrayCalculator.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkDataObject.h"
+#include "vtkDoubleArray.h"
+#include "vtkFloatArray.h"
+#include "vtkImageData.h"
+#include "vtkNew.h"
+#include "vtkPVArrayCalculator.h"
+#include "vtkPointData.h"
+#include "vtkRTAnalyticSource.h"
+
+#include <cmath>
+
+#define TEST_SUCCESS 0
+#define TEST_FAILED 1
+
+namespace
+{
+void MakeInput(vtkImageData* input)
+{
+  vtkNew<vtkRTAnalyticSource> source;
+  source->SetWholeExtent(-20, 20, -20, 20, -20, 20);
+  source->Update();
+  input->ShallowCopy(source->GetOutput());
+
+  // a 3-component point array and a float cell array, with values of both
+  // signs and some zeros so that a few function values are invalid
+  const vtkIdType numPoints = input->GetNumberOfPoints();
+  vtkNew<vtkDoubleArray> velocity;
+  velocity->SetName("Velocity");
+  velocity->SetNumberOfComponents(3);
+  velocity->SetNumberOfTuples(numPoints);
+  for (vtkIdType cc = 0; cc < numPoints; ++cc)
+  {
+    double pt[3];
+    input->GetPoint(cc, pt);
+    velocity->SetTuple3(cc, pt[1] - pt[2], std::sin(0.1 * pt[0]), pt[0] * pt[2] * 0.01);
+  }
+  input->GetPointData()->AddArray(velocity.GetPointer());
+
+  const vtkIdType numCells = input->GetNumberOfCells();
+  vtkNew<vtkFloatArray> cellValue;
+  cellValue->SetName("CellValue");
+  cellValue->SetNumberOfTuples(numCells);
+  for (vtkIdType cc = 0; cc < numCells; ++cc)
+  {
+    cellValue->SetValue(cc, static_cast<float>((cc % 211) - 105) * 0.25f);
+  }
+  input->GetCellData()->AddArray(cellValue.GetPointer());
+}
+
+vtkDataArray* Calculate(vtkPVArrayCalculator* calculator, bool multithreaded)
+{
+  calculator->SetMultithreadedEvaluation(multithreaded);
+  calculator->Update();
+  vtkDataSet* output = vtkDataSet::SafeDownCast(calculator->GetOutputDataObject(0));
+  return output ? output->GetAttributes(calculator->GetAttributeType())->GetArray("Result")
+                : NULL;
+}
+
+// The multithreaded evaluation must give exactly the same values.
+bool Compare(vtkPVArrayCalculator* calculator, const char* function)
+{
+  calculator->SetFunction(function);
+  vtkDataArray* serial = Calculate(calculator, false);
+  if (!serial)
+  {
+    cerr << "Missing serial result for " << function << endl;
+    return false;
+  }
+  vtkNew<vtkDoubleArray> serialCopy;
+  serialCopy->DeepCopy(serial);
+  vtkDataArray* threaded = Calculate(calculator, true);
+  if (!threaded)
+  {
+    cerr << "Missing multithreaded result for " << function << endl;
+    return false;
+  }
+  if (serialCopy->GetNumberOfTuples() != threaded->GetNumberOfTuples() ||
+    serialCopy->GetNumberOfComponents() != threaded->GetNumberOfComponents() ||
+    serial->GetDataType() != threaded->GetDataType())
+  {
+    cerr << "Result shapes differ for " << function << endl;
+    return false;
+  }
+  const int numComps = threaded->GetNumberOfComponents();
+  for (vtkIdType cc = 0; cc < threaded->GetNumberOfTuples(); ++cc)
+  {
+    for (int kk = 0; kk < numComps; ++kk)
+    {
+      const double a = serialCopy->GetComponent(cc, kk);
+      const double b = threaded->GetComponent(cc, kk);
+      if (a != b && !(std::isnan(a) && std::isnan(b)))
+      {
+        cerr << function << ": tuple " << cc << ", component " << kk << " is " << b
+             << " (multithreaded), expected " << a << " (serial)" << endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+}
+
+int TestPVArrayCalculator(int, char* [])
+{
+  vtkNew<vtkImageData> input;
+  MakeInput(input.GetPointer());
+
+  vtkNew<vtkPVArrayCalculator> calculator;
+  calculator->SetInputData(input.GetPointer());
+  calculator->SetResultArrayName("Result");
+
+  calculator->SetAttributeType(vtkDataObject::POINT);
+  if (!Compare(calculator.GetPointer(), "RTData*Velocity + coordsX*iHat + "
+                                        "sin(RTData)*mag(Velocity)*jHat + "
+                                        "Velocity_X*Velocity_Z*kHat") ||
+    !Compare(calculator.GetPointer(), "sqrt(abs(RTData - 100)) + Velocity.coords + coordsZ^2") ||
+    !Compare(calculator.GetPointer(), "cross(Velocity, coords)"))
+  {
+    return TEST_FAILED;
+  }
+
+  // invalid values (square roots of negative values, divisions by zero) must
+  // be replaced the same way
+  calculator->ReplaceInvalidValuesOn();
+  calculator->SetReplacementValue(-1.0);
+  if (!Compare(calculator.GetPointer(), "sqrt(Velocity_Y) / Velocity_X"))
+  {
+    return TEST_FAILED;
+  }
+  calculator->ReplaceInvalidValuesOff();
+
+  calculator->SetAttributeType(vtkDataObject::CELL);
+  if (!Compare(calculator.GetPointer(), "cos(CellValue)^2 + ln(abs(CellValue) + 1)") ||
+    !Compare(calculator.GetPointer(), "CellValue*iHat - exp(CellValue/10)*kHat"))
+  {
+    return TEST_FAILED;
+  }
+
+  return TEST_SUCCESS;
+}
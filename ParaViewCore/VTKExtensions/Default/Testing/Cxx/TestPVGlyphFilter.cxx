@@ -0,0 +1,207 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestPVGlyphFilter.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include "vtkCellArray.h"
+#include "vtkConeSource.h"
+#include "vtkDoubleArray.h"
+#include "vtkNew.h"
+#include "vtkPVGlyphFilter.h"
+#include "vtkPointData.h"
+#include "vtkPolyData.h"
+#include "vtkSphereSource.h"
+#include "vtkTimerLog.h"
+
+#include <vtksys/CommandLineArguments.hxx>
+
+#define TEST_SUCCESS 0
+#define TEST_FAILED 1
+
+namespace
+{
+double Glyph(vtkPVGlyphFilter* filter, int count)
+{
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  for (int cc = 0; cc < count; ++cc)
+  {
+    filter->Modified();
+    filter->Update();
+  }
+  timer->StopTimer();
+  return timer->GetElapsedTime() / count;
+}
+
+bool SameArrays(vtkDataArray* first, vtkDataArray* second)
+{
+  if (first->GetNumberOfTuples() != second->GetNumberOfTuples() ||
+    first->GetNumberOfComponents() != second->GetNumberOfComponents())
+  {
+    return false;
+  }
+  const int numComps = first->GetNumberOfComponents();
+  for (vtkIdType cc = 0; cc < first->GetNumberOfTuples(); ++cc)
+  {
+    for (int kk = 0; kk < numComps; ++kk)
+    {
+      if (first->GetComponent(cc, kk) != second->GetComponent(cc, kk))
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// The multithreaded output must be identical to the serial one.
+bool SameGlyphs(vtkPolyData* serial, vtkPolyData* threaded)
+{
+  if (serial->GetNumberOfPoints() != threaded->GetNumberOfPoints() ||
+    serial->GetNumberOfCells() != threaded->GetNumberOfCells() ||
+    serial->GetNumberOfPolys() != threaded->GetNumberOfPolys())
+  {
+    cerr << "Glyph counts differ: " << serial->GetNumberOfPoints() << " points, "
+         << serial->GetNumberOfCells() << " cells (serial) vs. " << threaded->GetNumberOfPoints()
+         << " points, " << threaded->GetNumberOfCells() << " cells (multithreaded)" << endl;
+    return false;
+  }
+  if (serial->GetNumberOfPoints() > 0 &&
+    !SameArrays(serial->GetPoints()->GetData(), threaded->GetPoints()->GetData()))
+  {
+    cerr << "Glyph points differ." << endl;
+    return false;
+  }
+
+  vtkCellArray* serialPolys = serial->GetPolys();
+  vtkCellArray* threadedPolys = threaded->GetPolys();
+  if (serialPolys->GetNumberOfConnectivityEntries() !=
+    threadedPolys->GetNumberOfConnectivityEntries())
+  {
+    cerr << "Glyph connectivity differs." << endl;
+    return false;
+  }
+  for (vtkIdType cc = 0; cc < serialPolys->GetNumberOfConnectivityEntries(); ++cc)
+  {
+    if (serialPolys->GetPointer()[cc] != threadedPolys->GetPointer()[cc])
+    {
+      cerr << "Glyph connectivity differs." << endl;
+      return false;
+    }
+  }
+
+  vtkPointData* serialPD = serial->GetPointData();
+  vtkPointData* threadedPD = threaded->GetPointData();
+  if (serialPD->GetNumberOfArrays() != threadedPD->GetNumberOfArrays())
+  {
+    cerr << "Number of point arrays differs." << endl;
+    return false;
+  }
+  for (int cc = 0; cc < serialPD->GetNumberOfArrays(); ++cc)
+  {
+    vtkDataArray* array = serialPD->GetArray(cc);
+    vtkDataArray* other = threadedPD->GetArray(array->GetName());
+    if (!other || !SameArrays(array, other))
+    {
+      cerr << "Point array " << array->GetName() << " differs." << endl;
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+int TestPVGlyphFilter(int argc, char* argv[])
+{
+  int resolution = 256;
+  int max_count = 1;
+
+  // Use --resolution and --count to use this for benchmarking.
+  vtksys::CommandLineArguments arg;
+  arg.Initialize(argc, argv);
+  typedef vtksys::CommandLineArguments argT;
+  arg.AddArgument("--resolution", argT::EQUAL_ARGUMENT, &resolution,
+    "Theta/phi resolution of the sphere to glyph.");
+  arg.AddArgument("--count", argT::EQUAL_ARGUMENT, &max_count, "Number of runs to average.");
+  arg.StoreUnusedArguments(true);
+  if (!arg.Parse())
+  {
+    cerr << "Problem parsing arguments" << endl;
+    return TEST_FAILED;
+  }
+
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(resolution);
+  sphere->SetPhiResolution(resolution);
+  sphere->Update();
+  vtkNew<vtkPolyData> input;
+  input->ShallowCopy(sphere->GetOutput());
+
+  vtkNew<vtkDoubleArray> scalars;
+  scalars->SetName("Scalars");
+  scalars->SetNumberOfTuples(input->GetNumberOfPoints());
+  for (vtkIdType cc = 0; cc < input->GetNumberOfPoints(); ++cc)
+  {
+    scalars->SetValue(cc, 1.0 + input->GetPoint(cc)[0]);
+  }
+  input->GetPointData()->AddArray(scalars.GetPointer());
+
+  vtkNew<vtkConeSource> cone;
+  cone->SetResolution(6);
+
+  vtkNew<vtkPVGlyphFilter> serial;
+  serial->SetUseMultithreading(false);
+  vtkNew<vtkPVGlyphFilter> threaded;
+  vtkPVGlyphFilter* filters[2] = { serial.GetPointer(), threaded.GetPointer() };
+  for (int cc = 0; cc < 2; ++cc)
+  {
+    filters[cc]->SetInputData(input.GetPointer());
+    filters[cc]->SetSourceConnection(cone->GetOutputPort());
+    filters[cc]->SetInputArrayToProcess(
+      0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_POINTS, "Scalars");
+    filters[cc]->SetInputArrayToProcess(
+      1, 0, 0, vtkDataObject::FIELD_ASSOCIATION_POINTS, "Normals");
+    filters[cc]->SetScaleModeToScaleByScalar();
+    filters[cc]->SetScaleFactor(0.01);
+    filters[cc]->SetOrient(1);
+    filters[cc]->SetGeneratePointIds(1);
+  }
+
+  const int modes[2] = { vtkPVGlyphFilter::ALL_POINTS,
+    vtkPVGlyphFilter::SPATIALLY_UNIFORM_DISTRIBUTION };
+  const char* names[2] = { "all points", "uniform distribution" };
+  for (int mode = 0; mode < 2; ++mode)
+  {
+    serial->SetGlyphMode(modes[mode]);
+    threaded->SetGlyphMode(modes[mode]);
+    threaded->SetMaximumNumberOfSamplePoints(input->GetNumberOfPoints() / 2);
+    serial->SetMaximumNumberOfSamplePoints(input->GetNumberOfPoints() / 2);
+
+    const double serialTime = Glyph(serial.GetPointer(), max_count);
+    const double threadedTime = Glyph(threaded.GetPointer(), max_count);
+    vtkPolyData* serialOutput = vtkPolyData::SafeDownCast(serial->GetOutputDataObject(0));
+    vtkPolyData* threadedOutput = vtkPolyData::SafeDownCast(threaded->GetOutputDataObject(0));
+
+    cout << "Glyphing " << input->GetNumberOfPoints() << " points, " << names[mode] << endl;
+    cout << "  serial:        " << serialTime << " s, " << serialOutput->GetNumberOfCells()
+         << " cells" << endl;
+    cout << "  multithreaded: " << threadedTime << " s, " << threadedOutput->GetNumberOfCells()
+         << " cells" << endl;
+
+    if (threadedOutput->GetNumberOfCells() == 0 || !SameGlyphs(serialOutput, threadedOutput))
+    {
+      return TEST_FAILED;
+    }
+  }
+  return TEST_SUCCESS;
+}
@@ -29,6 +29,7 @@ vtk_module(vtkPVVTKExtensionsDefault
     vtkChartsCore
     vtkIOPLY
   TEST_DEPENDS
+    vtkFiltersSources
     vtkTestingCore
   TEST_LABELS
     PARAVIEW
@@ -248,6 +248,11 @@ vtkAMRConnectivity::vtkAMRConnectivity()
 
 vtkAMRConnectivity::~vtkAMRConnectivity()
 {
+  if (this->Helper)
+  {
+    this->Helper->Delete();
+    this->Helper = 0;
+  }
 }
 
 void vtkAMRConnectivity::PrintSelf(ostream& os, vtkIndent indent)
@@ -312,7 +317,12 @@ int vtkAMRConnectivity::RequestData(vtkInformation* vtkNotUsed(request),
 
   amrOutput->ShallowCopy(amrInput);
 
-  this->Helper = vtkAMRDualGridHelper::New();
+  // The helper reuses the blocks and their neighbors while the structure of
+  // the input does not change.
+  if (!this->Helper)
+  {
+    this->Helper = vtkAMRDualGridHelper::New();
+  }
   vtkMultiProcessController* controller = vtkMultiProcessController::GetGlobalController();
   this->Helper->SetController(controller);
   this->Helper->Initialize(amrInput);
@@ -325,7 +335,6 @@ int vtkAMRConnectivity::RequestData(vtkInformation* vtkNotUsed(request),
       return 0;
     }
   }
-  this->Helper->Delete();
 
   return 1;
 }
@@ -34,6 +34,7 @@
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
 #include "vtkCompositeDataIterator.h"
+#include "vtkDataArray.h"
 #include "vtkDataSet.h"
 #include "vtkImageData.h"
 #include "vtkIntArray.h"
@@ -41,6 +42,7 @@
 #include "vtkMultiPieceDataSet.h"
 #include "vtkNonOverlappingAMR.h"
 #include "vtkPointData.h"
+#include "vtkSMPTools.h"
 #include "vtkUniformGrid.h"
 #include "vtkUnsignedCharArray.h"
 #include "vtkUnsignedCharArray.h"
@@ -145,6 +147,15 @@ public:
 
   vtkUnsignedCharArray* GetLevelMaskArray() { return this->LevelMaskArray; }
 
+  // Copies the level mask of a locator with the same dimensions.
+  void CopyLevelMask(vtkAMRDualClipLocator* source);
+
+  // Description:
+  // Converts a pointer returned by GetEdgePointer or GetCornerPointer to an
+  // index, and back.  Locators with the same dimensions use the same indices.
+  vtkIdType GetSlot(vtkIdType* ptIdPtr);
+  vtkIdType* GetSlotPointer(vtkIdType slot);
+
 private:
   int DualCellDimensions[3];
   // Increments for translating 3d to 1d.  XIncrement = 1;
@@ -209,6 +220,13 @@ vtkAMRDualClipLocator* vtkAMRDualClipGetBlockLocator(vtkAMRDualGridHelperBlock*
   return (vtkAMRDualClipLocator*)(block->UserData);
 }
 
+//----------------------------------------------------------------------------
+// Deletes the locators the helper still holds when its blocks are reused.
+void vtkAMRDualClipDeleteBlockLocator(void* locator)
+{
+  delete static_cast<vtkAMRDualClipLocator*>(locator);
+}
+
 //----------------------------------------------------------------------------
 // The only data specific stuff we need to do for the contour.
 template <class T>
@@ -569,6 +587,35 @@ void vtkAMRDualClipLocator::CopyNeighborLevelMask(
   }
 }
 
+//----------------------------------------------------------------------------
+void vtkAMRDualClipLocator::CopyLevelMask(vtkAMRDualClipLocator* source)
+{
+  memcpy(this->GetLevelMaskPointer(), source->GetLevelMaskPointer(), this->ArrayLength);
+  this->CenterLevelMaskComputed = source->CenterLevelMaskComputed;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkAMRDualClipLocator::GetSlot(vtkIdType* ptIdPtr)
+{
+  vtkIdType* arrays[4] = { this->XEdges, this->YEdges, this->ZEdges, this->Corners };
+  for (int ii = 0; ii < 4; ++ii)
+  {
+    if (ptIdPtr >= arrays[ii] && ptIdPtr < arrays[ii] + this->ArrayLength)
+    {
+      return ii * this->ArrayLength + (ptIdPtr - arrays[ii]);
+    }
+  }
+  assert(0 && "Pointer is not in the locator.");
+  return -1;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType* vtkAMRDualClipLocator::GetSlotPointer(vtkIdType slot)
+{
+  vtkIdType* arrays[4] = { this->XEdges, this->YEdges, this->ZEdges, this->Corners };
+  return arrays[slot / this->ArrayLength] + (slot % this->ArrayLength);
+}
+
 //----------------------------------------------------------------------------
 unsigned char vtkAMRDualClipLocator::GetLevelMaskValue(int x, int y, int z)
 {
@@ -1016,6 +1063,105 @@ void vtkAMRDualClipLocator::ShareBlockLocatorWithNeighbor(
   }
 }
 
+//============================================================================
+// The tetrahedra of one block.  Blocks are clipped independently, possibly by
+// different threads, with point ids local to the block.  They are merged into
+// the output in block order, so the output does not depend on the number of
+// threads.
+class vtkAMRDualClipBlockOutput
+{
+public:
+  vtkAMRDualGridHelperBlock* Block;
+  int BlockId;
+  vtkDataArray* Scalars;
+
+  // For each local point: its coordinates, its slot in the block locator, its
+  // level mask value and the two input cells its attributes are interpolated
+  // from.  Internal points copy the attributes of one cell (negative weight).
+  std::vector<double> Points;
+  std::vector<vtkIdType> Slots;
+  std::vector<unsigned char> LevelMasks;
+  std::vector<vtkIdType> CellOffsets;
+  std::vector<double> Weights;
+  // Four local point ids per tetrahedron.
+  std::vector<vtkIdType> Tetras;
+
+  // Set when merging: the output id of each local point, the local points
+  // that are new in the output and where the tetrahedra are written.
+  std::vector<vtkIdType> PointIds;
+  std::vector<vtkIdType> NewPoints;
+  vtkIdType PointOffset;
+  vtkIdType CellOffset;
+  vtkIdType NumberOfCells;
+
+  // Saved while the level masks are initialized.
+  unsigned char CenterRegionBits;
+
+  vtkIdType AddPoint(vtkIdType slot, const double* pt, unsigned char levelMask, vtkIdType offset0,
+    vtkIdType offset1, double k)
+  {
+    vtkIdType ptId = static_cast<vtkIdType>(this->Slots.size());
+    this->Points.insert(this->Points.end(), pt, pt + 3);
+    this->Slots.push_back(slot);
+    this->LevelMasks.push_back(levelMask);
+    this->CellOffsets.push_back(offset0);
+    this->CellOffsets.push_back(offset1);
+    this->Weights.push_back(k);
+    return ptId;
+  }
+
+  // Maps a tetrahedron to output point ids.  Returns false for a tetrahedron
+  // that became degenerate when the points shared with other blocks were
+  // merged.
+  bool MapTetra(vtkIdType tetraId, vtkIdType* ptIds)
+  {
+    for (int ii = 0; ii < 4; ++ii)
+    {
+      ptIds[ii] = this->PointIds[this->Tetras[4 * tetraId + ii]];
+    }
+    return ptIds[0] != ptIds[1] && ptIds[0] != ptIds[2] && ptIds[0] != ptIds[3] &&
+      ptIds[1] != ptIds[2] && ptIds[1] != ptIds[3] && ptIds[2] != ptIds[3];
+  }
+};
+
+//============================================================================
+// Runs one pass of the clipping over a range of blocks.  Each range has its
+// own locator.
+class vtkAMRDualClipProcessBlocks
+{
+public:
+  enum
+  {
+    CLIP_BLOCKS,
+    FILL_OUTPUT
+  };
+
+  vtkAMRDualClip* Filter;
+  vtkAMRDualClipBlockOutput* Outputs;
+  int Pass;
+
+  // Output arrays filled by FILL_OUTPUT.
+  vtkIdType* Cells;
+  std::vector<vtkAbstractArray*> PointArrays;
+  std::vector<bool> NearestPointArrays;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkAMRDualClipLocator locator;
+    for (vtkIdType ii = begin; ii < end; ++ii)
+    {
+      if (this->Pass == CLIP_BLOCKS)
+      {
+        this->Filter->ProcessBlock(this->Outputs + ii, &locator);
+      }
+      else
+      {
+        this->Filter->FillBlockOutput(this->Outputs + ii, this);
+      }
+    }
+  }
+};
+
 //============================================================================
 //----------------------------------------------------------------------------
 // Description:
@@ -1041,16 +1187,16 @@ vtkAMRDualClip::vtkAMRDualClip()
   this->BlockIdCellArray = 0;
   this->Helper = 0;
 
-  this->BlockLocator = 0;
+  this->UseMultithreading = true;
 }
 
 //----------------------------------------------------------------------------
 vtkAMRDualClip::~vtkAMRDualClip()
 {
-  if (this->BlockLocator)
+  if (this->Helper)
   {
-    delete this->BlockLocator;
-    this->BlockLocator = 0;
+    this->Helper->Delete();
+    this->Helper = 0;
   }
   this->SetController(NULL);
 }
@@ -1064,6 +1210,7 @@ void vtkAMRDualClip::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "EnableInternalDecimation: " << this->EnableInternalDecimation << endl;
   os << indent << "EnableDegenerateCells: " << this->EnableDegenerateCells << endl;
   os << indent << "EnableMergePoints: " << this->EnableMergePoints << endl;
+  os << indent << "UseMultithreading: " << this->UseMultithreading << endl;
   os << indent << "Controller: " << this->Controller << endl;
 }
 
@@ -1159,13 +1306,14 @@ vtkMultiBlockDataSet* vtkAMRDualClip::DoRequestData(
 
   mpds->SetNumberOfPieces(0);
 
-  if (this->Helper)
+  // The helper is kept between requests so that it can reuse the blocks and
+  // their neighbors when only the iso value or the arrays change.
+  if (!this->Helper)
   {
-    this->Helper->Delete();
+    this->Helper = vtkAMRDualGridHelper::New();
   }
-
-  this->Helper = vtkAMRDualGridHelper::New();
   this->Helper->SetEnableDegenerateCells(this->EnableDegenerateCells);
+  this->Helper->SetUserDataDeleter(vtkAMRDualClipDeleteBlockLocator);
   if (this->EnableMultiProcessCommunication)
   {
     this->Helper->SetController(this->Controller);
@@ -1204,19 +1352,36 @@ vtkMultiBlockDataSet* vtkAMRDualClip::DoRequestData(
 
   // Loop through blocks
   int numLevels = hbdsInput->GetNumberOfLevels();
-  int numBlocks;
-  int blockId;
 
   // Add each block.
+  std::vector<vtkAMRDualClipBlockOutput> outputs;
   for (int level = 0; level < numLevels; ++level)
   {
-    numBlocks = this->Helper->GetNumberOfBlocksInLevel(level);
-    for (blockId = 0; blockId < numBlocks; ++blockId)
+    int numBlocks = this->Helper->GetNumberOfBlocksInLevel(level);
+    for (int blockId = 0; blockId < numBlocks; ++blockId)
     {
       vtkAMRDualGridHelperBlock* block = this->Helper->GetBlock(level, blockId);
-      this->ProcessBlock(block, blockId, arrayNameToProcess);
+      if (block->Image == 0)
+      { // Remote blocks are only to setup local block bit flags.
+        continue;
+      }
+      // We are looking for only cell data arrays.
+      vtkDataArray* volumeFractionArray =
+        block->Image->GetCellData()->GetArray(arrayNameToProcess);
+      if (volumeFractionArray)
+      {
+        outputs.push_back(vtkAMRDualClipBlockOutput());
+        outputs.back().Block = block;
+        outputs.back().BlockId = blockId;
+        outputs.back().Scalars = volumeFractionArray;
+      }
     }
   }
+  this->ProcessBlocks(outputs);
+
+  // The helper is kept for the next request, so delete the locators left on
+  // blocks that were not processed.
+  this->Helper->ClearUserData();
 
   this->BlockIdCellArray->Delete();
   this->BlockIdCellArray = 0;
@@ -1233,8 +1398,6 @@ vtkMultiBlockDataSet* vtkAMRDualClip::DoRequestData(
   this->Cells = 0;
 
   mpds->Delete();
-  this->Helper->Delete();
-  this->Helper = 0;
 
   return mbdsOutput0;
 }
@@ -1455,24 +1618,237 @@ void vtkAMRDualClip::ShareLevelMask(vtkAMRDualGridHelperBlock* block)
 }
 
 //----------------------------------------------------------------------------
-void vtkAMRDualClip::ProcessBlock(
-  vtkAMRDualGridHelperBlock* block, int blockId, const char* arrayNameToProcess)
+// Clips the local blocks, in parallel when UseMultithreading is on.  Each
+// block is clipped with point ids local to the block.  The points shared by
+// blocks are then merged in block order, the order in which the block
+// locators are shared when blocks are clipped one after the other.  Last,
+// every block copies its points and tetrahedra to the output at offsets known
+// from the previous blocks.
+void vtkAMRDualClip::ProcessBlocks(std::vector<vtkAMRDualClipBlockOutput>& outputs)
 {
-  vtkImageData* image = block->Image;
-  if (image == 0)
-  { // Remote blocks are only to setup local block bit flags.
+  vtkIdType numBlocks = static_cast<vtkIdType>(outputs.size());
+  if (numBlocks == 0)
+  {
     return;
   }
 
-  // We are looking for only cell data arrays.
-  vtkDataArray* volumeFractionArray = image->GetCellData()->GetArray(arrayNameToProcess);
+  if (this->EnableMergePoints)
+  {
+    this->InitializeLevelMasks(outputs);
+  }
+
+  vtkAMRDualClipProcessBlocks functor;
+  functor.Filter = this;
+  functor.Outputs = &outputs[0];
+  functor.Pass = vtkAMRDualClipProcessBlocks::CLIP_BLOCKS;
+  functor.Cells = 0;
+  if (this->UseMultithreading && numBlocks > 1)
+  {
+    vtkSMPTools::For(0, numBlocks, 1, functor);
+  }
+  else
+  {
+    functor(0, numBlocks);
+  }
+
+  vtkIdType numPts = 0;
+  vtkIdType numCells = 0;
+  for (vtkIdType ii = 0; ii < numBlocks; ++ii)
+  {
+    vtkAMRDualClipBlockOutput& output = outputs[ii];
+    this->MergeBlockPoints(&output, numPts);
+    output.CellOffset = numCells;
+    numCells += output.NumberOfCells;
+  }
 
-  if (!volumeFractionArray)
+  // Allocate the output so that blocks only have to set values.
+  this->Points->SetNumberOfPoints(numPts);
+  functor.Cells = this->Cells->WritePointer(numCells, 5 * numCells);
+  this->BlockIdCellArray->SetNumberOfTuples(numCells);
+  this->LevelMaskPointArray->SetNumberOfTuples(numPts);
+  vtkPointData* outPD = this->Mesh->GetPointData();
+  for (int ii = 0; ii < outPD->GetNumberOfArrays(); ++ii)
   {
-    return;
+    vtkAbstractArray* array = outPD->GetAbstractArray(ii);
+    if (array == this->LevelMaskPointArray)
+    {
+      continue;
+    }
+    array->SetNumberOfTuples(numPts);
+    functor.PointArrays.push_back(array);
+    // Like vtkDataSetAttributes::InterpolateEdge, some attributes take the
+    // value of the closest cell.
+    int attribute = outPD->IsArrayAnAttribute(ii);
+    functor.NearestPointArrays.push_back(
+      attribute >= 0 && outPD->GetCopyAttribute(attribute, vtkDataSetAttributes::INTERPOLATE) == 2);
+  }
+
+  functor.Pass = vtkAMRDualClipProcessBlocks::FILL_OUTPUT;
+  if (this->UseMultithreading && numBlocks > 1)
+  {
+    vtkSMPTools::For(0, numBlocks, 1, functor);
+  }
+  else
+  {
+    functor(0, numBlocks);
+  }
+}
+
+//----------------------------------------------------------------------------
+// The level mask of a block depends on the masks of the blocks processed
+// before it, so the masks are computed one block after the other, as when
+// the blocks are clipped sequentially.  The block locators keep the masks
+// until the blocks are merged.
+void vtkAMRDualClip::InitializeLevelMasks(std::vector<vtkAMRDualClipBlockOutput>& outputs)
+{
+  size_t numBlocks = outputs.size();
+  for (size_t ii = 0; ii < numBlocks; ++ii)
+  {
+    vtkAMRDualGridHelperBlock* block = outputs[ii].Block;
+    this->InitializeLevelMask(block);
+    this->ShareLevelMask(block);
+    // Mark the block as processed for the neighbors that follow.
+    outputs[ii].CenterRegionBits = block->RegionBits[1][1][1];
+    block->RegionBits[1][1][1] = 0;
+  }
+  // The center flag is also the owner bit of the center region.
+  for (size_t ii = 0; ii < numBlocks; ++ii)
+  {
+    outputs[ii].Block->RegionBits[1][1][1] = outputs[ii].CenterRegionBits;
+  }
+}
+
+//----------------------------------------------------------------------------
+// Gives output ids to the points of a block and counts its tetrahedra.  With
+// EnableMergePoints, the block locator has the ids of the points added by the
+// neighbors merged before, and shares the ids of the block with the neighbors
+// merged after.
+void vtkAMRDualClip::MergeBlockPoints(vtkAMRDualClipBlockOutput* output, vtkIdType& numberOfPoints)
+{
+  vtkAMRDualGridHelperBlock* block = output->Block;
+  vtkAMRDualClipLocator* locator = 0;
+  if (this->EnableMergePoints)
+  {
+    locator = vtkAMRDualClipGetBlockLocator(block);
+  }
+
+  vtkIdType numLocalPts = static_cast<vtkIdType>(output->Slots.size());
+  output->PointIds.resize(numLocalPts);
+  output->NewPoints.clear();
+  output->PointOffset = numberOfPoints;
+  for (vtkIdType ii = 0; ii < numLocalPts; ++ii)
+  {
+    vtkIdType* ptIdPtr = locator ? locator->GetSlotPointer(output->Slots[ii]) : 0;
+    if (ptIdPtr && *ptIdPtr >= 0)
+    { // A neighbor already added this point.
+      output->PointIds[ii] = *ptIdPtr;
+      continue;
+    }
+    output->PointIds[ii] = numberOfPoints++;
+    output->NewPoints.push_back(ii);
+    if (ptIdPtr)
+    {
+      *ptIdPtr = output->PointIds[ii];
+    }
+  }
+
+  output->NumberOfCells = 0;
+  vtkIdType numTetras = static_cast<vtkIdType>(output->Tetras.size() / 4);
+  vtkIdType ptIds[4];
+  for (vtkIdType ii = 0; ii < numTetras; ++ii)
+  {
+    if (output->MapTetra(ii, ptIds))
+    {
+      ++output->NumberOfCells;
+    }
+  }
+
+  if (locator)
+  {
+    // Copy point ids into neighbor locators.
+    this->ShareBlockLocatorWithNeighbors(block);
+    // We are done.  We no longer need the locator for this block.
+    delete locator;
+    block->UserData = 0;
+    // Lets use this unused flag (owner of center region/block) to indicate
+    // that the block is already processes.
+    // This will keep neighbors from recreating the locator.
+    block->RegionBits[1][1][1] = 0;
+  }
+}
+
+//----------------------------------------------------------------------------
+// Copies the new points of a block, their attributes and the tetrahedra of
+// the block to the output.  Blocks write to separate ranges of the arrays
+// allocated by ProcessBlocks, so blocks can be copied in parallel.
+void vtkAMRDualClip::FillBlockOutput(
+  vtkAMRDualClipBlockOutput* output, vtkAMRDualClipProcessBlocks* pass)
+{
+  // Blocks may not have the cell arrays in the same order.
+  vtkCellData* inCD = output->Block->Image->GetCellData();
+  size_t numArrays = pass->PointArrays.size();
+  std::vector<vtkAbstractArray*> inArrays(numArrays);
+  for (size_t jj = 0; jj < numArrays; ++jj)
+  {
+    inArrays[jj] = inCD->GetAbstractArray(pass->PointArrays[jj]->GetName());
+  }
+
+  vtkIdType numNewPts = static_cast<vtkIdType>(output->NewPoints.size());
+  for (vtkIdType ii = 0; ii < numNewPts; ++ii)
+  {
+    vtkIdType localId = output->NewPoints[ii];
+    vtkIdType outId = output->PointOffset + ii;
+    this->Points->SetPoint(outId, &output->Points[3 * localId]);
+    this->LevelMaskPointArray->SetValue(outId, output->LevelMasks[localId]);
+    vtkIdType offset0 = output->CellOffsets[2 * localId];
+    vtkIdType offset1 = output->CellOffsets[2 * localId + 1];
+    double k = output->Weights[localId];
+    for (size_t jj = 0; jj < numArrays; ++jj)
+    {
+      vtkAbstractArray* inArray = inArrays[jj];
+      if (inArray == 0)
+      {
+        continue;
+      }
+      if (k < 0.0)
+      {
+        pass->PointArrays[jj]->SetTuple(outId, offset0, inArray);
+      }
+      else
+      {
+        double t = pass->NearestPointArrays[jj] ? (k < 0.5 ? 0.0 : 1.0) : k;
+        pass->PointArrays[jj]->InterpolateTuple(outId, offset0, inArray, offset1, inArray, t);
+      }
+    }
+  }
+
+  vtkIdType* cells = pass->Cells + 5 * output->CellOffset;
+  vtkIdType cellId = output->CellOffset;
+  vtkIdType numTetras = static_cast<vtkIdType>(output->Tetras.size() / 4);
+  vtkIdType ptIds[4];
+  for (vtkIdType ii = 0; ii < numTetras; ++ii)
+  {
+    if (output->MapTetra(ii, ptIds))
+    {
+      *cells++ = 4;
+      for (int jj = 0; jj < 4; ++jj)
+      {
+        *cells++ = ptIds[jj];
+      }
+      this->BlockIdCellArray->SetValue(cellId++, output->BlockId);
+    }
   }
+}
+
+//----------------------------------------------------------------------------
+// Clips a block with point ids local to the block.  This only reads the
+// filter and the block, so blocks can be clipped in parallel, each thread
+// with its own locator.
+void vtkAMRDualClip::ProcessBlock(vtkAMRDualClipBlockOutput* output, vtkAMRDualClipLocator* locator)
+{
+  vtkAMRDualGridHelperBlock* block = output->Block;
+  vtkImageData* image = block->Image;
 
-  // void* volumeFractionPtr = volumeFractionArray->GetVoidPointer(0);
   double origin[3];
   double* spacing;
   int extent[6];
@@ -1484,22 +1860,13 @@ void vtkAMRDualClip::ProcessBlock(
   --extent[3];
   --extent[5];
 
-  // Locator merges points in this block.
+  // Locator merges points in this block.  Points shared with other blocks
+  // are merged by MergeBlockPoints.
   // Input the dimensions of the dual cells with ghosts.
+  locator->Initialize(extent[1] - extent[0], extent[3] - extent[2], extent[5] - extent[4]);
   if (this->EnableMergePoints)
-  {
-    this->InitializeLevelMask(block);
-    this->BlockLocator = vtkAMRDualClipGetBlockLocator(block);
-  }
-  else
-  { // Shared locator.
-    if (this->BlockLocator == 0)
-    {
-      this->BlockLocator = new vtkAMRDualClipLocator;
-    }
-    this->BlockLocator->Initialize(
-      extent[1] - extent[0], extent[3] - extent[2], extent[5] - extent[4]);
-    // this->BlockLocator->CopyRegionLevelDifferences(block);
+  { // The level mask was computed by InitializeLevelMasks.
+    locator->CopyLevelMask(vtkAMRDualClipGetBlockLocator(block));
   }
   image->GetOrigin(origin);
   spacing = image->GetSpacing();
@@ -1575,7 +1942,7 @@ void vtkAMRDualClip::ProcessBlock(
           cornerOffsets[5] = xOffset + 1 + zInc;
           cornerOffsets[6] = xOffset + yInc + zInc;
           cornerOffsets[7] = xOffset + 1 + yInc + zInc;
-          this->ProcessDualCell(block, blockId, x, y, z, cornerOffsets, volumeFractionArray);
+          this->ProcessDualCell(output, locator, x, y, z, cornerOffsets);
         }
         xOffset += 1; // xInc
       }
@@ -1583,39 +1950,18 @@ void vtkAMRDualClip::ProcessBlock(
     }
     zOffset += zInc;
   }
-
-  if (this->EnableMergePoints)
-  {
-    this->ShareLevelMask(block);
-    // Copy point ids into neighbor locators.
-    this->ShareBlockLocatorWithNeighbors(block);
-    // We are done.  We no longer need the locator for this block.
-    delete this->BlockLocator;
-    this->BlockLocator = 0;
-    block->UserData = 0;
-    // Lets use this unused flag (owner of center region/block) to indicate
-    // that the block is already processes.
-    // This will keep neighbors from recreating the locator.
-    // Another option would be to create the locator object for
-    // all blocks but do not allocate until needed.  Then the existence of the locator
-    // would tell whether the block was processed.
-    block->RegionBits[1][1][1] = 0;
-  }
 }
 
 //----------------------------------------------------------------------------
 // Not implemented as optimally as we could.  It can be improved by making
 // a fast path for internal cells (with no degeneracies).
-void vtkAMRDualClip::ProcessDualCell(vtkAMRDualGridHelperBlock* block, int blockId, int x, int y,
-  int z, vtkIdType cornerOffsets[8], vtkDataArray* volumeFractionArray)
+void vtkAMRDualClip::ProcessDualCell(vtkAMRDualClipBlockOutput* output,
+  vtkAMRDualClipLocator* locator, int x, int y, int z, vtkIdType cornerOffsets[8])
 {
-  // compute the case index
-  vtkImageData* image = block->Image;
-  if (image == 0)
-  { // Remote blocks are only to setup local block bit flags.
-    return;
-  }
+  vtkAMRDualGridHelperBlock* block = output->Block;
+  vtkDataArray* volumeFractionArray = output->Scalars;
 
+  // compute the case index
   void* volumeFractionPtr = volumeFractionArray->GetVoidPointer(0);
   int dataType = volumeFractionArray->GetDataType();
   double cornerValues[8];
@@ -1835,8 +2181,8 @@ void vtkAMRDualClip::ProcessDualCell(vtkAMRDualGridHelperBlock* block, int block
       // convert from VTK corner ids to bit (x,y,z) corner ids.
       if (casePtId < 8)
       { // Corner (internal point)
-        ptIdPtr = this->BlockLocator->GetCornerPointer(x, y, z, casePtId, block->OriginIndex);
-        levelMaskValue = this->BlockLocator->GetLevelMaskValue(
+        ptIdPtr = locator->GetCornerPointer(x, y, z, casePtId, block->OriginIndex);
+        levelMaskValue = locator->GetLevelMaskValue(
           x + ((casePtId & 1) ? 1 : 0), y + ((casePtId & 2) ? 1 : 0), z + ((casePtId & 4) ? 1 : 0));
         if (levelMaskValue == 0)
         { // bug !!!!! trying to figure out what is going on.
@@ -1888,7 +2234,6 @@ void vtkAMRDualClip::ProcessDualCell(vtkAMRDualGridHelperBlock* block, int block
           pt[0] = origin[0] + spacing[0] * (double)(1 << levelDiff) * ((double)(px) + dx);
           pt[1] = origin[1] + spacing[1] * (double)(1 << levelDiff) * ((double)(py) + dy);
           pt[2] = origin[2] + spacing[2] * (double)(1 << levelDiff) * ((double)(pz) + dz);
-          *ptIdPtr = this->Points->InsertNextPoint(pt);
           if (pt[1] > 100000.0)
           {
             cerr << "bug\n";
@@ -1902,14 +2247,13 @@ void vtkAMRDualClip::ProcessDualCell(vtkAMRDualGridHelperBlock* block, int block
           // Averaging could be a pre processing step but we would have to modify input attributes
           // .......
           vtkIdType offset = cornerOffsets[casePtId];
-          this->Mesh->GetPointData()->CopyData(block->Image->GetCellData(), offset, *ptIdPtr);
-
-          this->LevelMaskPointArray->InsertNextValue(levelMaskValue);
+          *ptIdPtr = output->AddPoint(
+            locator->GetSlot(ptIdPtr), pt, levelMaskValue, offset, offset, -1.0);
         }
       }
       else
       { // Edge (clipped cell, point on iso surface)
-        ptIdPtr = this->BlockLocator->GetEdgePointer(x, y, z, casePtId - 8);
+        ptIdPtr = locator->GetEdgePointer(x, y, z, casePtId - 8);
         if (*ptIdPtr == -1)
         {
           int edge = casePtId - 8;
@@ -1926,7 +2270,6 @@ void vtkAMRDualClip::ProcessDualCell(vtkAMRDualGridHelperBlock* block, int block
             cornerPoints[pt1Idx | 1] + k * (cornerPoints[pt2Idx | 1] - cornerPoints[pt1Idx | 1]);
           pt[2] =
             cornerPoints[pt1Idx | 2] + k * (cornerPoints[pt2Idx | 2] - cornerPoints[pt1Idx | 2]);
-          *ptIdPtr = this->Points->InsertNextPoint(pt);
           if (pt[1] > 100000.0)
           {
             cerr << "bug\n";
@@ -1936,20 +2279,14 @@ void vtkAMRDualClip::ProcessDualCell(vtkAMRDualGridHelperBlock* block, int block
           // Find the offsets of the two attributes to interpolate
           vtkIdType offset0 = cornerOffsets[pt1Idx >> 2];
           vtkIdType offset1 = cornerOffsets[pt2Idx >> 2];
-          this->Mesh->GetPointData()->InterpolateEdge(
-            block->Image->GetCellData(), *ptIdPtr, offset0, offset1, k);
-
-          this->LevelMaskPointArray->InsertNextValue(levelMaskValue);
+          *ptIdPtr =
+            output->AddPoint(locator->GetSlot(ptIdPtr), pt, levelMaskValue, offset0, offset1, k);
         }
       }
       pointIds[ii] = *ptIdPtr;
     }
-    if (pointIds[0] != pointIds[1] && pointIds[0] != pointIds[2] && pointIds[0] != pointIds[3] &&
-      pointIds[1] != pointIds[2] && pointIds[1] != pointIds[3] && pointIds[2] != pointIds[3])
-    {
-      this->Cells->InsertNextCell(4, pointIds);
-      this->BlockIdCellArray->InsertNextValue(blockId);
-    }
+    // Degenerate tetrahedra are dropped when the block is merged.
+    output->Tetras.insert(output->Tetras.end(), pointIds, pointIds + 4);
   }
 }
 
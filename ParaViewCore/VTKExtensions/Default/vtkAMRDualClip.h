@@ -21,6 +21,12 @@
  * transitions are handled correctly, and second is that internal
  * cells are decimated.  I use a variation of degenerate points/cells
  * used for level transitions.
+ *
+ * When UseMultithreading is on, the blocks of each process are clipped
+ * concurrently using vtkSMPTools.  The level masks are computed first, one
+ * block after the other, and the tetrahedra of the blocks are merged into the
+ * output in block order, so the output is the same as when the blocks are
+ * clipped one after the other.
 */
 
 #ifndef vtkAMRDualClip_h
@@ -28,6 +34,7 @@
 
 #include "vtkMultiBlockDataSetAlgorithm.h"
 #include "vtkPVVTKExtensionsDefaultModule.h" //needed for exports
+#include <vector>
 
 class vtkDataSet;
 class vtkImageData;
@@ -47,6 +54,8 @@ class vtkAMRDualGridHelper;
 class vtkAMRDualGridHelperBlock;
 class vtkAMRDualGridHelperFace;
 class vtkAMRDualClipLocator;
+class vtkAMRDualClipBlockOutput;
+class vtkAMRDualClipProcessBlocks;
 
 class VTKPVVTKEXTENSIONSDEFAULT_EXPORT vtkAMRDualClip : public vtkMultiBlockDataSetAlgorithm
 {
@@ -85,6 +94,16 @@ public:
   vtkBooleanMacro(EnableMergePoints, int);
   //@}
 
+  //@{
+  /**
+   * When on, the blocks of each process are clipped by multiple threads.
+   * The output is the same either way. Default is on.
+   */
+  vtkSetMacro(UseMultithreading, bool);
+  vtkGetMacro(UseMultithreading, bool);
+  vtkBooleanMacro(UseMultithreading, bool);
+  //@}
+
   vtkGetObjectMacro(Controller, vtkMultiProcessController);
   virtual void SetController(vtkMultiProcessController*);
 
@@ -99,6 +118,7 @@ protected:
   int EnableDegenerateCells;
   int EnableMultiProcessCommunication;
   int EnableMergePoints;
+  bool UseMultithreading;
 
   // Needed for copying cell data to point data.
   vtkUnstructuredGrid* Mesh;
@@ -118,11 +138,17 @@ protected:
 
   void ShareBlockLocatorWithNeighbors(vtkAMRDualGridHelperBlock* block);
 
-  void ProcessBlock(vtkAMRDualGridHelperBlock* block, int blockId, const char* arrayName);
+  // Clip the blocks, possibly in parallel, and merge them into the output.
+  void ProcessBlocks(std::vector<vtkAMRDualClipBlockOutput>& outputs);
+  void MergeBlockPoints(vtkAMRDualClipBlockOutput* output, vtkIdType& numberOfPoints);
+  void FillBlockOutput(vtkAMRDualClipBlockOutput* output, vtkAMRDualClipProcessBlocks* pass);
+
+  void ProcessBlock(vtkAMRDualClipBlockOutput* output, vtkAMRDualClipLocator* locator);
 
-  void ProcessDualCell(vtkAMRDualGridHelperBlock* block, int blockId, int x, int y, int z,
-    vtkIdType cornerOffsets[8], vtkDataArray* volumeFractionArray);
+  void ProcessDualCell(vtkAMRDualClipBlockOutput* output, vtkAMRDualClipLocator* locator, int x,
+    int y, int z, vtkIdType cornerOffsets[8]);
 
+  void InitializeLevelMasks(std::vector<vtkAMRDualClipBlockOutput>& outputs);
   void InitializeLevelMask(vtkAMRDualGridHelperBlock* block);
   void ShareLevelMask(vtkAMRDualGridHelperBlock* block);
   void DistributeLevelMasks();
@@ -148,11 +174,11 @@ protected:
   int* MessageBuffer;
   int* MessageBufferLength;
 
-  vtkAMRDualClipLocator* BlockLocator;
-
 private:
   vtkAMRDualClip(const vtkAMRDualClip&) = delete;
   void operator=(const vtkAMRDualClip&) = delete;
+
+  friend class vtkAMRDualClipProcessBlocks;
 };
 
 #endif
@@ -33,6 +33,7 @@
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
 #include "vtkCompositeDataIterator.h"
+#include "vtkDataArray.h"
 #include "vtkDataSet.h"
 #include "vtkFloatArray.h"
 #include "vtkImageData.h"
@@ -41,6 +42,7 @@
 #include "vtkNonOverlappingAMR.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
+#include "vtkSMPTools.h"
 #include "vtkUniformGrid.h"
 #include "vtkUnsignedCharArray.h"
 #include "vtkUnstructuredGrid.h"
@@ -103,6 +105,12 @@ public:
   void ShareBlockLocatorWithNeighbor(
     vtkAMRDualGridHelperBlock* block, vtkAMRDualGridHelperBlock* neighbor);
 
+  // Description:
+  // Converts a pointer returned by GetEdgePointer or GetCornerPointer to an
+  // index, and back.  Locators with the same dimensions use the same indices.
+  vtkIdType GetSlot(vtkIdType* ptIdPtr);
+  vtkIdType* GetSlotPointer(vtkIdType slot);
+
 private:
   int DualCellDimensions[3];
   // Increments for translating 3d to 1d.  XIncrement = 1;
@@ -431,6 +439,28 @@ vtkIdType* vtkAMRDualContourEdgeLocator::GetCornerPointer(
   return this->Corners + (xCell + (yCell * this->YIncrement) + (zCell * this->ZIncrement));
 }
 
+//----------------------------------------------------------------------------
+vtkIdType vtkAMRDualContourEdgeLocator::GetSlot(vtkIdType* ptIdPtr)
+{
+  vtkIdType* arrays[4] = { this->XEdges, this->YEdges, this->ZEdges, this->Corners };
+  for (int ii = 0; ii < 4; ++ii)
+  {
+    if (ptIdPtr >= arrays[ii] && ptIdPtr < arrays[ii] + this->ArrayLength)
+    {
+      return ii * this->ArrayLength + (ptIdPtr - arrays[ii]);
+    }
+  }
+  assert(0 && "Pointer is not in the locator.");
+  return -1;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType* vtkAMRDualContourEdgeLocator::GetSlotPointer(vtkIdType slot)
+{
+  vtkIdType* arrays[4] = { this->XEdges, this->YEdges, this->ZEdges, this->Corners };
+  return arrays[slot / this->ArrayLength] + (slot % this->ArrayLength);
+}
+
 //----------------------------------------------------------------------------
 vtkAMRDualContourEdgeLocator* vtkAMRDualContourGetBlockLocator(vtkAMRDualGridHelperBlock* block)
 {
@@ -457,6 +487,13 @@ vtkAMRDualContourEdgeLocator* vtkAMRDualContourGetBlockLocator(vtkAMRDualGridHel
   return (vtkAMRDualContourEdgeLocator*)(block->UserData);
 }
 
+//----------------------------------------------------------------------------
+// Deletes the locators the helper still holds when its blocks are reused.
+void vtkAMRDualContourDeleteBlockLocator(void* locator)
+{
+  delete static_cast<vtkAMRDualContourEdgeLocator*>(locator);
+}
+
 //----------------------------------------------------------------------------
 // This version works with higher level neighbor blocks.
 void vtkAMRDualContourEdgeLocator::ShareBlockLocatorWithNeighbor(
@@ -608,6 +645,115 @@ void vtkAMRDualContourEdgeLocator::ShareBlockLocatorWithNeighbor(
   }
 }
 
+//============================================================================
+// The surface of one block.  Blocks are contoured independently, possibly by
+// different threads, with point ids local to the block.  They are merged into
+// the output in block order, so the output does not depend on the number of
+// threads.
+class vtkAMRDualContourBlockOutput
+{
+public:
+  vtkAMRDualGridHelperBlock* Block;
+  int BlockId;
+  vtkDataArray* Scalars;
+
+  // For each local point: its coordinates, its slot in the block locator and
+  // the two input cells its attributes are interpolated from.  Corner points
+  // of the capping surface copy the attributes of one cell (negative weight).
+  std::vector<double> Points;
+  std::vector<vtkIdType> Slots;
+  std::vector<vtkIdType> CellOffsets;
+  std::vector<double> Weights;
+  // Polygons as (number of points, local point ids...).  The number of
+  // points is negative for polygons that are kept even when degenerate.
+  std::vector<vtkIdType> Polygons;
+
+  // Set when merging: the output id of each local point, the local points
+  // that are new in the output and where the polygons are written.
+  std::vector<vtkIdType> PointIds;
+  std::vector<vtkIdType> NewPoints;
+  vtkIdType PointOffset;
+  vtkIdType CellOffset;
+  vtkIdType ConnectivityOffset;
+  vtkIdType NumberOfCells;
+  vtkIdType ConnectivitySize;
+
+  vtkIdType AddPoint(
+    vtkIdType slot, const double* pt, vtkIdType offset0, vtkIdType offset1, double k)
+  {
+    vtkIdType ptId = static_cast<vtkIdType>(this->Slots.size());
+    this->Points.insert(this->Points.end(), pt, pt + 3);
+    this->Slots.push_back(slot);
+    this->CellOffsets.push_back(offset0);
+    this->CellOffsets.push_back(offset1);
+    this->Weights.push_back(k);
+    return ptId;
+  }
+
+  void AddPolygon(int numPts, const vtkIdType* ptIds, bool removeDegenerate)
+  {
+    this->Polygons.push_back(removeDegenerate ? numPts : -numPts);
+    this->Polygons.insert(this->Polygons.end(), ptIds, ptIds + numPts);
+  }
+
+  // Maps the polygon starting at polygon to output point ids.  Returns the
+  // number of points, or 0 for a triangle that became degenerate when the
+  // points shared with other blocks were merged.
+  int MapPolygon(const vtkIdType* polygon, vtkIdType* ptIds)
+  {
+    bool removeDegenerate = polygon[0] > 0;
+    int numPts = static_cast<int>(removeDegenerate ? polygon[0] : -polygon[0]);
+    for (int ii = 0; ii < numPts; ++ii)
+    {
+      ptIds[ii] = this->PointIds[polygon[ii + 1]];
+    }
+    if (removeDegenerate &&
+      (ptIds[0] == ptIds[1] || ptIds[0] == ptIds[2] || ptIds[1] == ptIds[2]))
+    {
+      return 0;
+    }
+    return numPts;
+  }
+};
+
+//============================================================================
+// Runs one pass of the contouring over a range of blocks.  Each range has its
+// own locator.
+class vtkAMRDualContourProcessBlocks
+{
+public:
+  enum
+  {
+    CONTOUR_BLOCKS,
+    FILL_OUTPUT
+  };
+
+  vtkAMRDualContour* Filter;
+  vtkAMRDualContourBlockOutput* Outputs;
+  int Pass;
+
+  // Output arrays filled by FILL_OUTPUT.
+  vtkIdType* Cells;
+  std::vector<vtkAbstractArray*> PointArrays;
+  std::vector<bool> NearestPointArrays;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkAMRDualContourEdgeLocator locator;
+    for (vtkIdType ii = begin; ii < end; ++ii)
+    {
+      if (this->Pass == CONTOUR_BLOCKS)
+      {
+        this->Filter->ProcessBlock(this->Outputs + ii, &locator);
+      }
+      else
+      {
+        this->Filter->FillBlockOutput(this->Outputs + ii, this);
+      }
+    }
+  }
+};
+
 //============================================================================
 //----------------------------------------------------------------------------
 // Description:
@@ -634,16 +780,16 @@ vtkAMRDualContour::vtkAMRDualContour()
   this->BlockIdCellArray = 0;
   this->Helper = 0;
 
-  this->BlockLocator = 0;
+  this->UseMultithreading = true;
 }
 
 //----------------------------------------------------------------------------
 vtkAMRDualContour::~vtkAMRDualContour()
 {
-  if (this->BlockLocator)
+  if (this->Helper)
   {
-    delete this->BlockLocator;
-    this->BlockLocator = 0;
+    this->Helper->Delete();
+    this->Helper = 0;
   }
   this->SetController(NULL);
 }
@@ -661,6 +807,7 @@ void vtkAMRDualContour::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "EnableMergePoints: " << this->EnableMergePoints << endl;
   os << indent << "TriangulateCap: " << this->TriangulateCap << endl;
   os << indent << "SkipGhostCopy: " << this->SkipGhostCopy << endl;
+  os << indent << "UseMultithreading: " << this->UseMultithreading << endl;
 }
 
 //----------------------------------------------------------------------------
@@ -755,13 +902,14 @@ int vtkAMRDualContour::RequestData(vtkInformation* vtkNotUsed(request),
 
 void vtkAMRDualContour::InitializeRequest(vtkNonOverlappingAMR* hbdsInput)
 {
-  if (this->Helper)
+  // The helper is kept between requests so that it can reuse the blocks and
+  // their neighbors when only the iso value or the arrays change.
+  if (!this->Helper)
   {
-    this->Helper->Delete();
+    this->Helper = vtkAMRDualGridHelper::New();
   }
-
-  this->Helper = vtkAMRDualGridHelper::New();
   this->Helper->SetEnableDegenerateCells(this->EnableDegenerateCells);
+  this->Helper->SetUserDataDeleter(vtkAMRDualContourDeleteBlockLocator);
   this->Helper->SetSkipGhostCopy(this->SkipGhostCopy);
   if (this->EnableMultiProcessCommunication)
   {
@@ -776,8 +924,6 @@ void vtkAMRDualContour::InitializeRequest(vtkNonOverlappingAMR* hbdsInput)
 
 void vtkAMRDualContour::FinalizeRequest()
 {
-  this->Helper->Delete();
-  this->Helper = 0;
 }
 
 vtkMultiBlockDataSet* vtkAMRDualContour::DoRequestData(
@@ -810,15 +956,34 @@ vtkMultiBlockDataSet* vtkAMRDualContour::DoRequestData(
   int numLevels = hbdsInput->GetNumberOfLevels();
 
   // Add each block.
+  std::vector<vtkAMRDualContourBlockOutput> outputs;
   for (int level = 0; level < numLevels; ++level)
   {
     int numBlocks = this->Helper->GetNumberOfBlocksInLevel(level);
     for (int blockId = 0; blockId < numBlocks; ++blockId)
     {
       vtkAMRDualGridHelperBlock* block = this->Helper->GetBlock(level, blockId);
-      this->ProcessBlock(block, blockId, arrayNameToProcess);
+      if (block->Image == 0)
+      { // Remote blocks are only to setup local block bit flags.
+        continue;
+      }
+      // We are looking for only cell data arrays.
+      vtkDataArray* volumeFractionArray =
+        block->Image->GetCellData()->GetArray(arrayNameToProcess);
+      if (volumeFractionArray)
+      {
+        outputs.push_back(vtkAMRDualContourBlockOutput());
+        outputs.back().Block = block;
+        outputs.back().BlockId = blockId;
+        outputs.back().Scalars = volumeFractionArray;
+      }
     }
   }
+  this->ProcessBlocks(outputs);
+
+  // The helper is kept for the next request, so delete the locators left on
+  // blocks that were not processed.
+  this->Helper->ClearUserData();
 
   this->FinalizeCopyAttributes(this->Mesh);
   this->BlockIdCellArray->Delete();
@@ -836,6 +1001,206 @@ vtkMultiBlockDataSet* vtkAMRDualContour::DoRequestData(
   return mbdsOutput0;
 }
 
+//----------------------------------------------------------------------------
+// Contours the local blocks, in parallel when UseMultithreading is on.  Each
+// block is contoured with point ids local to the block.  The points shared by
+// blocks are then merged in block order, the order in which the block
+// locators are shared when blocks are contoured one after the other.  Last,
+// every block copies its points and polygons to the output at offsets known
+// from the previous blocks.
+void vtkAMRDualContour::ProcessBlocks(std::vector<vtkAMRDualContourBlockOutput>& outputs)
+{
+  vtkIdType numBlocks = static_cast<vtkIdType>(outputs.size());
+  if (numBlocks == 0)
+  {
+    return;
+  }
+
+  vtkAMRDualContourProcessBlocks functor;
+  functor.Filter = this;
+  functor.Outputs = &outputs[0];
+  functor.Pass = vtkAMRDualContourProcessBlocks::CONTOUR_BLOCKS;
+  functor.Cells = 0;
+  if (this->UseMultithreading && numBlocks > 1)
+  {
+    vtkSMPTools::For(0, numBlocks, 1, functor);
+  }
+  else
+  {
+    functor(0, numBlocks);
+  }
+
+  vtkIdType numPts = 0;
+  vtkIdType numCells = 0;
+  vtkIdType connectivitySize = 0;
+  for (vtkIdType ii = 0; ii < numBlocks; ++ii)
+  {
+    vtkAMRDualContourBlockOutput& output = outputs[ii];
+    this->MergeBlockPoints(&output, numPts);
+    output.CellOffset = numCells;
+    output.ConnectivityOffset = connectivitySize;
+    numCells += output.NumberOfCells;
+    connectivitySize += output.ConnectivitySize;
+  }
+
+  // Allocate the output so that blocks only have to set values.
+  this->Points->SetNumberOfPoints(numPts);
+  functor.Cells = this->Faces->WritePointer(numCells, connectivitySize);
+  this->BlockIdCellArray->SetNumberOfTuples(numCells);
+  vtkPointData* outPD = this->Mesh->GetPointData();
+  for (int ii = 0; ii < outPD->GetNumberOfArrays(); ++ii)
+  {
+    vtkAbstractArray* array = outPD->GetAbstractArray(ii);
+    array->SetNumberOfTuples(numPts);
+    functor.PointArrays.push_back(array);
+    // Like vtkDataSetAttributes::InterpolateEdge, some attributes take the
+    // value of the closest cell.
+    int attribute = outPD->IsArrayAnAttribute(ii);
+    functor.NearestPointArrays.push_back(
+      attribute >= 0 && outPD->GetCopyAttribute(attribute, vtkDataSetAttributes::INTERPOLATE) == 2);
+  }
+
+  functor.Pass = vtkAMRDualContourProcessBlocks::FILL_OUTPUT;
+  if (this->UseMultithreading && numBlocks > 1)
+  {
+    vtkSMPTools::For(0, numBlocks, 1, functor);
+  }
+  else
+  {
+    functor(0, numBlocks);
+  }
+}
+
+//----------------------------------------------------------------------------
+// Gives output ids to the points of a block and counts its polygons.  With
+// EnableMergePoints, the block locator has the ids of the points added by the
+// neighbors merged before, and shares the ids of the block with the neighbors
+// merged after.
+void vtkAMRDualContour::MergeBlockPoints(
+  vtkAMRDualContourBlockOutput* output, vtkIdType& numberOfPoints)
+{
+  vtkAMRDualGridHelperBlock* block = output->Block;
+  vtkAMRDualContourEdgeLocator* locator = 0;
+  if (this->EnableMergePoints)
+  {
+    locator = vtkAMRDualContourGetBlockLocator(block);
+  }
+
+  vtkIdType numLocalPts = static_cast<vtkIdType>(output->Slots.size());
+  output->PointIds.resize(numLocalPts);
+  output->NewPoints.clear();
+  output->PointOffset = numberOfPoints;
+  for (vtkIdType ii = 0; ii < numLocalPts; ++ii)
+  {
+    vtkIdType* ptIdPtr = locator ? locator->GetSlotPointer(output->Slots[ii]) : 0;
+    if (ptIdPtr && *ptIdPtr >= 0)
+    { // A neighbor already added this point.
+      output->PointIds[ii] = *ptIdPtr;
+      continue;
+    }
+    output->PointIds[ii] = numberOfPoints++;
+    output->NewPoints.push_back(ii);
+    if (ptIdPtr)
+    {
+      *ptIdPtr = output->PointIds[ii];
+    }
+  }
+
+  output->NumberOfCells = 0;
+  output->ConnectivitySize = 0;
+  vtkIdType ptIds[8];
+  size_t pos = 0;
+  while (pos < output->Polygons.size())
+  {
+    const vtkIdType* polygon = &output->Polygons[pos];
+    int numPts = output->MapPolygon(polygon, ptIds);
+    if (numPts)
+    {
+      ++output->NumberOfCells;
+      output->ConnectivitySize += numPts + 1;
+    }
+    pos += 1 + (polygon[0] < 0 ? -polygon[0] : polygon[0]);
+  }
+
+  if (locator)
+  {
+    // Copy point ids into neighbor locators.
+    this->ShareBlockLocatorWithNeighbors(block);
+    // We are done.  We no longer need the locator for this block.
+    delete locator;
+    block->UserData = 0;
+    // Lets use this unused flag (owner of center region/block) to indicate
+    // that the block is already processes.
+    // This will keep neighbors from recreating the locator.
+    block->RegionBits[1][1][1] = 0;
+  }
+}
+
+//----------------------------------------------------------------------------
+// Copies the new points of a block, their attributes and the polygons of the
+// block to the output.  Blocks write to separate ranges of the arrays
+// allocated by ProcessBlocks, so blocks can be copied in parallel.
+void vtkAMRDualContour::FillBlockOutput(
+  vtkAMRDualContourBlockOutput* output, vtkAMRDualContourProcessBlocks* pass)
+{
+  // Blocks may not have the cell arrays in the same order.
+  vtkCellData* inCD = output->Block->Image->GetCellData();
+  size_t numArrays = pass->PointArrays.size();
+  std::vector<vtkAbstractArray*> inArrays(numArrays);
+  for (size_t jj = 0; jj < numArrays; ++jj)
+  {
+    inArrays[jj] = inCD->GetAbstractArray(pass->PointArrays[jj]->GetName());
+  }
+
+  vtkIdType numNewPts = static_cast<vtkIdType>(output->NewPoints.size());
+  for (vtkIdType ii = 0; ii < numNewPts; ++ii)
+  {
+    vtkIdType localId = output->NewPoints[ii];
+    vtkIdType outId = output->PointOffset + ii;
+    this->Points->SetPoint(outId, &output->Points[3 * localId]);
+    vtkIdType offset0 = output->CellOffsets[2 * localId];
+    vtkIdType offset1 = output->CellOffsets[2 * localId + 1];
+    double k = output->Weights[localId];
+    for (size_t jj = 0; jj < numArrays; ++jj)
+    {
+      vtkAbstractArray* inArray = inArrays[jj];
+      if (inArray == 0)
+      {
+        continue;
+      }
+      if (k < 0.0)
+      {
+        pass->PointArrays[jj]->SetTuple(outId, offset0, inArray);
+      }
+      else
+      {
+        double t = pass->NearestPointArrays[jj] ? (k < 0.5 ? 0.0 : 1.0) : k;
+        pass->PointArrays[jj]->InterpolateTuple(outId, offset0, inArray, offset1, inArray, t);
+      }
+    }
+  }
+
+  vtkIdType* cells = pass->Cells + output->ConnectivityOffset;
+  vtkIdType cellId = output->CellOffset;
+  vtkIdType ptIds[8];
+  size_t pos = 0;
+  while (pos < output->Polygons.size())
+  {
+    const vtkIdType* polygon = &output->Polygons[pos];
+    int numPts = output->MapPolygon(polygon, ptIds);
+    if (numPts)
+    {
+      *cells++ = numPts;
+      for (int ii = 0; ii < numPts; ++ii)
+      {
+        *cells++ = ptIds[ii];
+      }
+      this->BlockIdCellArray->SetValue(cellId++, output->BlockId);
+    }
+    pos += 1 + (polygon[0] < 0 ? -polygon[0] : polygon[0]);
+  }
+}
+
 //----------------------------------------------------------------------------
 void vtkAMRDualContour::ShareBlockLocatorWithNeighbors(vtkAMRDualGridHelperBlock* block)
 {
@@ -884,22 +1249,14 @@ void vtkAMRDualContour::ShareBlockLocatorWithNeighbors(vtkAMRDualGridHelperBlock
 }
 
 //----------------------------------------------------------------------------
+// Contours a block with point ids local to the block.  This only reads the
+// filter and the block, so blocks can be contoured in parallel, each thread
+// with its own locator.
 void vtkAMRDualContour::ProcessBlock(
-  vtkAMRDualGridHelperBlock* block, int blockId, const char* arrayNameToProcess)
+  vtkAMRDualContourBlockOutput* output, vtkAMRDualContourEdgeLocator* locator)
 {
+  vtkAMRDualGridHelperBlock* block = output->Block;
   vtkImageData* image = block->Image;
-  if (image == 0)
-  { // Remote blocks are only to setup local block bit flags.
-    return;
-  }
-
-  // We are looking for only cell data arrays.
-  vtkDataArray* volumeFractionArray = image->GetCellData()->GetArray(arrayNameToProcess);
-
-  if (!volumeFractionArray)
-  {
-    return;
-  }
 
   double origin[3];
   double* spacing;
@@ -912,22 +1269,11 @@ void vtkAMRDualContour::ProcessBlock(
   --extent[3];
   --extent[5];
 
-  // Locator merges points in this block.
+  // Locator merges points in this block.  Points shared with other blocks
+  // are merged by MergeBlockPoints.
   // Input the dimensions of the dual cells with ghosts.
-  if (this->EnableMergePoints)
-  {
-    this->BlockLocator = vtkAMRDualContourGetBlockLocator(block);
-  }
-  else
-  { // Shared locator.
-    if (this->BlockLocator == 0)
-    {
-      this->BlockLocator = new vtkAMRDualContourEdgeLocator;
-    }
-    this->BlockLocator->Initialize(
-      extent[1] - extent[0], extent[3] - extent[2], extent[5] - extent[4]);
-    this->BlockLocator->CopyRegionLevelDifferences(block);
-  }
+  locator->Initialize(extent[1] - extent[0], extent[3] - extent[2], extent[5] - extent[4]);
+  locator->CopyRegionLevelDifferences(block);
   image->GetOrigin(origin);
   spacing = image->GetSpacing();
   // Dual cells are shifted half a pixel.
@@ -1007,7 +1353,7 @@ void vtkAMRDualContour::ProcessBlock(
           cornerOffsets[5] = xOffset + 1 + zInc;
           cornerOffsets[6] = xOffset + 1 + yInc + zInc;
           cornerOffsets[7] = xOffset + yInc + zInc;
-          this->ProcessDualCell(block, blockId, x, y, z, cornerOffsets, volumeFractionArray);
+          this->ProcessDualCell(output, locator, x, y, z, cornerOffsets);
         }
         xOffset += 1; // xInc
       }
@@ -1015,23 +1361,6 @@ void vtkAMRDualContour::ProcessBlock(
     }
     zOffset += zInc;
   }
-
-  if (this->EnableMergePoints)
-  {
-    // Copy point ids into neighbor locators.
-    this->ShareBlockLocatorWithNeighbors(block);
-    // We are done.  We no longer need the locator for this block.
-    delete this->BlockLocator;
-    this->BlockLocator = 0;
-    block->UserData = 0;
-    // Lets use this unused flag (owner of center region/block) to indicate
-    // that the block is already processes.
-    // This will keep neighbors from recreating the locator.
-    // Another option would be to create the locator object for
-    // all blocks but do not allocate until needed.  Then the existence of the locator
-    // would tell whether the block was processed.
-    block->RegionBits[1][1][1] = 0;
-  }
 }
 
 //----------------------------------------------------------------------------
@@ -1091,15 +1420,12 @@ static int vtkAMRDualLegacyIdToBitIdMap[8] = { 0, 1, 3, 2, 4, 5, 7, 6 };
 // Not implemented as optimally as we could.  It can be improved by making
 // a fast path for internal cells (with no degeneracies).
 // Corner offsets are absolute (relative to origin / 0).
-void vtkAMRDualContour::ProcessDualCell(vtkAMRDualGridHelperBlock* block, int blockId, int x, int y,
-  int z, vtkIdType cornerOffsets[8], vtkDataArray* volumeFractionArray)
+void vtkAMRDualContour::ProcessDualCell(vtkAMRDualContourBlockOutput* output,
+  vtkAMRDualContourEdgeLocator* locator, int x, int y, int z, vtkIdType cornerOffsets[8])
 {
   // compute the case index
-  vtkImageData* image = block->Image;
-  if (image == 0)
-  { // Remote blocks are only to setup local block bit flags.
-    return;
-  }
+  vtkAMRDualGridHelperBlock* block = output->Block;
+  vtkDataArray* volumeFractionArray = output->Scalars;
 
   void* volumeFractionPtr = volumeFractionArray->GetVoidPointer(0);
   int dataType = volumeFractionArray->GetDataType();
@@ -1329,7 +1655,7 @@ void vtkAMRDualContour::ProcessDualCell(vtkAMRDualGridHelperBlock* block, int bl
     // Only permanently keep locator for edges shared between two blocks.
     for (int ii = 0; ii < 3; ++ii, ++edge) // insert triangle
     {
-      vtkIdType* ptIdPtr = this->BlockLocator->GetEdgePointer(x, y, z, *edge);
+      vtkIdType* ptIdPtr = locator->GetEdgePointer(x, y, z, *edge);
 
       if (*ptIdPtr == -1)
       {
@@ -1357,31 +1683,30 @@ void vtkAMRDualContour::ProcessDualCell(vtkAMRDualGridHelperBlock* block, int bl
           cornerPoints[pt1Idx | 1] + k * (cornerPoints[pt2Idx | 1] - cornerPoints[pt1Idx | 1]);
         pt[2] =
           cornerPoints[pt1Idx | 2] + k * (cornerPoints[pt2Idx | 2] - cornerPoints[pt1Idx | 2]);
-        *ptIdPtr = this->Points->InsertNextPoint(pt);
         // Interpolate attributes
         // Find the offsets of the two attributes to interpolate
         vtkIdType offset0 = cornerOffsets[vtkAMRDualIsoEdgeToVTKPointsTable[*edge][0]];
         vtkIdType offset1 = cornerOffsets[vtkAMRDualIsoEdgeToVTKPointsTable[*edge][1]];
-        this->InterpolateAttributes(block->Image, offset0, offset1, k, this->Mesh, *ptIdPtr);
+        *ptIdPtr = output->AddPoint(locator->GetSlot(ptIdPtr), pt, offset0, offset1, k);
       }
       edgePointIds[*edge] = pointIds[ii] = *ptIdPtr;
     }
     if (pointIds[0] != pointIds[1] && pointIds[0] != pointIds[2] && pointIds[1] != pointIds[2])
     {
-      this->Faces->InsertNextCell(3, pointIds);
-      this->BlockIdCellArray->InsertNextValue(blockId);
+      output->AddPolygon(3, pointIds, true);
     }
   }
 
   if (this->EnableCapping)
   {
-    this->CapCell(x, y, z, cubeBoundaryBits, cubeCase, edgePointIds, cornerPoints, cornerOffsets,
-      blockId, block->Image);
+    this->CapCell(output, locator, x, y, z, cubeBoundaryBits, cubeCase, edgePointIds, cornerPoints,
+      cornerOffsets);
   }
 }
 
 //----------------------------------------------------------------------------
-void vtkAMRDualContour::AddCapPolygon(int ptCount, vtkIdType* pointIds, int blockId)
+void vtkAMRDualContour::AddCapPolygon(
+  vtkAMRDualContourBlockOutput* output, int ptCount, vtkIdType* pointIds)
 {
   if (this->TriangulateCap)
   {
@@ -1397,8 +1722,7 @@ void vtkAMRDualContour::AddCapPolygon(int ptCount, vtkIdType* pointIds, int bloc
         tri[2] = pointIds[low];
         if (tri[0] != tri[1] && tri[0] != tri[2] && tri[1] != tri[2])
         {
-          this->Faces->InsertNextCell(3, tri);
-          this->BlockIdCellArray->InsertNextValue(blockId);
+          output->AddPolygon(3, tri, true);
         }
       }
       else
@@ -1408,16 +1732,14 @@ void vtkAMRDualContour::AddCapPolygon(int ptCount, vtkIdType* pointIds, int bloc
         tri[2] = pointIds[low];
         if (tri[0] != tri[1] && tri[0] != tri[2] && tri[1] != tri[2])
         {
-          this->Faces->InsertNextCell(3, tri);
-          this->BlockIdCellArray->InsertNextValue(blockId);
+          output->AddPolygon(3, tri, true);
         }
         tri[0] = pointIds[high];
         tri[1] = pointIds[high + 1];
         tri[2] = pointIds[low];
         if (tri[0] != tri[1] && tri[0] != tri[2] && tri[1] != tri[2])
         {
-          this->Faces->InsertNextCell(3, tri);
-          this->BlockIdCellArray->InsertNextValue(blockId);
+          output->AddPolygon(3, tri, true);
         }
       }
       ++low;
@@ -1427,8 +1749,7 @@ void vtkAMRDualContour::AddCapPolygon(int ptCount, vtkIdType* pointIds, int bloc
   else
   {
     // Do not worry about degenerate polygons in this path.
-    this->Faces->InsertNextCell(ptCount, pointIds);
-    this->BlockIdCellArray->InsertNextValue(blockId);
+    output->AddPolygon(ptCount, pointIds, false);
   }
 }
 
@@ -1439,7 +1760,10 @@ void vtkAMRDualContour::AddCapPolygon(int ptCount, vtkIdType* pointIds, int bloc
 // and I permute the face corners and edges into hex corners and endges.
 // It ends up being a little long to duplicate the code 6 times,
 // but it is still fast.
-void vtkAMRDualContour::CapCell(int cellX, int cellY, int cellZ, // cell index in block coordinates.
+void vtkAMRDualContour::CapCell(
+  // The block being contoured and its locator.
+  vtkAMRDualContourBlockOutput* output, vtkAMRDualContourEdgeLocator* locator,
+  int cellX, int cellY, int cellZ, // cell index in block coordinates.
   // Which cell faces need to be capped.
   unsigned char cubeBoundaryBits,
   // Marching cubes case for this cell
@@ -1449,11 +1773,7 @@ void vtkAMRDualContour::CapCell(int cellX, int cellY, int cellZ, // cell index i
   // Locations of 8 corners (xyz4xyz4...); 4th value is not used.
   double cornerPoints[32],
   // The id order is VTK from marching cube cases.  Different than axis ordered "cornerPoints".
-  vtkIdType cornerOffsets[8],
-  // For block id array (for debugging).  I should just make this an ivar.
-  int blockId,
-  // For passing attributes to output mesh
-  vtkDataSet* inData)
+  vtkIdType cornerOffsets[8])
 {
   int cornerIdx;
   vtkIdType* ptIdPtr;
@@ -1472,12 +1792,12 @@ void vtkAMRDualContour::CapCell(int cellX, int cellY, int cellZ, // cell index i
         if (*capPtr < 4)
         {
           cornerIdx = (vtkAMRDualIsoNXCapEdgeMap[*capPtr]);
-          ptIdPtr = this->BlockLocator->GetCornerPointer(cellX, cellY, cellZ, cornerIdx);
+          ptIdPtr = locator->GetCornerPointer(cellX, cellY, cellZ, cornerIdx);
           if (*ptIdPtr == -1)
           {
-            *ptIdPtr = this->Points->InsertNextPoint(cornerPoints + (cornerIdx << 2));
-            this->CopyAttributes(
-              inData, cornerOffsets[vtkAMRDualLegacyIdToBitIdMap[cornerIdx]], this->Mesh, *ptIdPtr);
+            vtkIdType offset = cornerOffsets[vtkAMRDualLegacyIdToBitIdMap[cornerIdx]];
+            *ptIdPtr = output->AddPoint(
+              locator->GetSlot(ptIdPtr), cornerPoints + (cornerIdx << 2), offset, offset, -1.0);
           }
           pointIds[ptCount++] = *ptIdPtr;
         }
@@ -1487,7 +1807,7 @@ void vtkAMRDualContour::CapCell(int cellX, int cellY, int cellZ, // cell index i
         }
         ++capPtr;
       }
-      this->AddCapPolygon(ptCount, pointIds, blockId);
+      this->AddCapPolygon(output, ptCount, pointIds);
       if (*capPtr == -1)
       {
         ++capPtr;
@@ -1508,12 +1828,12 @@ void vtkAMRDualContour::CapCell(int cellX, int cellY, int cellZ, // cell index i
         if (*capPtr < 4)
         {
           cornerIdx = (vtkAMRDualIsoPXCapEdgeMap[*capPtr]);
-          ptIdPtr = this->BlockLocator->GetCornerPointer(cellX, cellY, cellZ, cornerIdx);
+          ptIdPtr = locator->GetCornerPointer(cellX, cellY, cellZ, cornerIdx);
           if (*ptIdPtr == -1)
           {
-            *ptIdPtr = this->Points->InsertNextPoint(cornerPoints + (cornerIdx << 2));
-            this->CopyAttributes(
-              inData, cornerOffsets[vtkAMRDualLegacyIdToBitIdMap[cornerIdx]], this->Mesh, *ptIdPtr);
+            vtkIdType offset = cornerOffsets[vtkAMRDualLegacyIdToBitIdMap[cornerIdx]];
+            *ptIdPtr = output->AddPoint(
+              locator->GetSlot(ptIdPtr), cornerPoints + (cornerIdx << 2), offset, offset, -1.0);
           }
           pointIds[ptCount++] = *ptIdPtr;
         }
@@ -1523,7 +1843,7 @@ void vtkAMRDualContour::CapCell(int cellX, int cellY, int cellZ, // cell index i
         }
         ++capPtr;
       }
-      this->AddCapPolygon(ptCount, pointIds, blockId);
+      this->AddCapPolygon(output, ptCount, pointIds);
       if (*capPtr == -1)
       {
         ++capPtr;
@@ -1545,12 +1865,12 @@ void vtkAMRDualContour::CapCell(int cellX, int cellY, int cellZ, // cell index i
         if (*capPtr < 4)
         {
           cornerIdx = (vtkAMRDualIsoNYCapEdgeMap[*capPtr]);
-          ptIdPtr = this->BlockLocator->GetCornerPointer(cellX, cellY, cellZ, cornerIdx);
+          ptIdPtr = locator->GetCornerPointer(cellX, cellY, cellZ, cornerIdx);
           if (*ptIdPtr == -1)
           {
-            *ptIdPtr = this->Points->InsertNextPoint(cornerPoints + (cornerIdx << 2));
-            this->CopyAttributes(
-              inData, cornerOffsets[vtkAMRDualLegacyIdToBitIdMap[cornerIdx]], this->Mesh, *ptIdPtr);
+            vtkIdType offset = cornerOffsets[vtkAMRDualLegacyIdToBitIdMap[cornerIdx]];
+            *ptIdPtr = output->AddPoint(
+              locator->GetSlot(ptIdPtr), cornerPoints + (cornerIdx << 2), offset, offset, -1.0);
           }
           pointIds[ptCount++] = *ptIdPtr;
         }
@@ -1560,7 +1880,7 @@ void vtkAMRDualContour::CapCell(int cellX, int cellY, int cellZ, // cell index i
         }
         ++capPtr;
       }
-      this->AddCapPolygon(ptCount, pointIds, blockId);
+      this->AddCapPolygon(output, ptCount, pointIds);
       if (*capPtr == -1)
       {
         ++capPtr;
@@ -1582,12 +1902,12 @@ void vtkAMRDualContour::CapCell(int cellX, int cellY, int cellZ, // cell index i
         if (*capPtr < 4)
         {
           cornerIdx = (vtkAMRDualIsoPYCapEdgeMap[*capPtr]);
-          ptIdPtr = this->BlockLocator->GetCornerPointer(cellX, cellY, cellZ, cornerIdx);
+          ptIdPtr = locator->GetCornerPointer(cellX, cellY, cellZ, cornerIdx);
           if (*ptIdPtr == -1)
           {
-            *ptIdPtr = this->Points->InsertNextPoint(cornerPoints + (cornerIdx << 2));
-            this->CopyAttributes(
-              inData, cornerOffsets[vtkAMRDualLegacyIdToBitIdMap[cornerIdx]], this->Mesh, *ptIdPtr);
+            vtkIdType offset = cornerOffsets[vtkAMRDualLegacyIdToBitIdMap[cornerIdx]];
+            *ptIdPtr = output->AddPoint(
+              locator->GetSlot(ptIdPtr), cornerPoints + (cornerIdx << 2), offset, offset, -1.0);
           }
           pointIds[ptCount++] = *ptIdPtr;
         }
@@ -1597,7 +1917,7 @@ void vtkAMRDualContour::CapCell(int cellX, int cellY, int cellZ, // cell index i
         }
         ++capPtr;
       }
-      this->AddCapPolygon(ptCount, pointIds, blockId);
+      this->AddCapPolygon(output, ptCount, pointIds);
       if (*capPtr == -1)
       {
         ++capPtr;
@@ -1618,12 +1938,12 @@ void vtkAMRDualContour::CapCell(int cellX, int cellY, int cellZ, // cell index i
         if (*capPtr < 4)
         {
           cornerIdx = (vtkAMRDualIsoNZCapEdgeMap[*capPtr]);
-          ptIdPtr = this->BlockLocator->GetCornerPointer(cellX, cellY, cellZ, cornerIdx);
+          ptIdPtr = locator->GetCornerPointer(cellX, cellY, cellZ, cornerIdx);
           if (*ptIdPtr == -1)
           {
-            *ptIdPtr = this->Points->InsertNextPoint(cornerPoints + (cornerIdx << 2));
-            this->CopyAttributes(
-              inData, cornerOffsets[vtkAMRDualLegacyIdToBitIdMap[cornerIdx]], this->Mesh, *ptIdPtr);
+            vtkIdType offset = cornerOffsets[vtkAMRDualLegacyIdToBitIdMap[cornerIdx]];
+            *ptIdPtr = output->AddPoint(
+              locator->GetSlot(ptIdPtr), cornerPoints + (cornerIdx << 2), offset, offset, -1.0);
           }
           pointIds[ptCount++] = *ptIdPtr;
         }
@@ -1633,7 +1953,7 @@ void vtkAMRDualContour::CapCell(int cellX, int cellY, int cellZ, // cell index i
         }
         ++capPtr;
       }
-      this->AddCapPolygon(ptCount, pointIds, blockId);
+      this->AddCapPolygon(output, ptCount, pointIds);
       if (*capPtr == -1)
       {
         ++capPtr;
@@ -1655,12 +1975,12 @@ void vtkAMRDualContour::CapCell(int cellX, int cellY, int cellZ, // cell index i
         if (*capPtr < 4)
         {
           cornerIdx = (vtkAMRDualIsoPZCapEdgeMap[*capPtr]);
-          ptIdPtr = this->BlockLocator->GetCornerPointer(cellX, cellY, cellZ, cornerIdx);
+          ptIdPtr = locator->GetCornerPointer(cellX, cellY, cellZ, cornerIdx);
           if (*ptIdPtr == -1)
           {
-            *ptIdPtr = this->Points->InsertNextPoint(cornerPoints + (cornerIdx << 2));
-            this->CopyAttributes(
-              inData, cornerOffsets[vtkAMRDualLegacyIdToBitIdMap[cornerIdx]], this->Mesh, *ptIdPtr);
+            vtkIdType offset = cornerOffsets[vtkAMRDualLegacyIdToBitIdMap[cornerIdx]];
+            *ptIdPtr = output->AddPoint(
+              locator->GetSlot(ptIdPtr), cornerPoints + (cornerIdx << 2), offset, offset, -1.0);
           }
           pointIds[ptCount++] = *ptIdPtr;
         }
@@ -1670,7 +1990,7 @@ void vtkAMRDualContour::CapCell(int cellX, int cellY, int cellZ, // cell index i
         }
         ++capPtr;
       }
-      this->AddCapPolygon(ptCount, pointIds, blockId);
+      this->AddCapPolygon(output, ptCount, pointIds);
       if (*capPtr == -1)
       {
         ++capPtr;
@@ -1719,17 +2039,3 @@ void vtkAMRDualContour::FinalizeCopyAttributes(vtkDataSet* mesh)
 {
   mesh->GetPointData()->Squeeze();
 }
-
-//----------------------------------------------------------------------------
-void vtkAMRDualContour::InterpolateAttributes(vtkDataSet* uGrid, vtkIdType offset0,
-  vtkIdType offset1, double k, vtkDataSet* mesh, vtkIdType outId)
-{
-  mesh->GetPointData()->InterpolateEdge(uGrid->GetCellData(), outId, offset0, offset1, k);
-}
-
-//----------------------------------------------------------------------------
-void vtkAMRDualContour::CopyAttributes(
-  vtkDataSet* uGrid, vtkIdType inId, vtkDataSet* mesh, vtkIdType outId)
-{
-  mesh->GetPointData()->CopyData(uGrid->GetCellData(), inId, outId);
-}
@@ -21,6 +21,12 @@
  * a particle index as part of the cell data of the output.  It computes
  * the volume of each particle from the volume fraction.
  *
+ * When UseMultithreading is on, the blocks of each process are contoured
+ * concurrently using vtkSMPTools, each with point ids local to the block.
+ * The points shared by blocks are then merged in block order and the blocks
+ * are copied to the output at offsets known from the previous blocks, so the
+ * output is the same as when the blocks are contoured one after the other.
+ *
  * This will turn on validation and debug i/o of the filter.
  * \code{.cpp}
  * #define vtkAMRDualContourDEBUG
@@ -54,6 +60,8 @@ class vtkAMRDualGridHelper;
 class vtkAMRDualGridHelperBlock;
 class vtkAMRDualGridHelperFace;
 class vtkAMRDualContourEdgeLocator;
+class vtkAMRDualContourBlockOutput;
+class vtkAMRDualContourProcessBlocks;
 
 class VTKPVVTKEXTENSIONSDEFAULT_EXPORT vtkAMRDualContour : public vtkMultiBlockDataSetAlgorithm
 {
@@ -114,6 +122,16 @@ public:
   vtkBooleanMacro(SkipGhostCopy, int);
   //@}
 
+  //@{
+  /**
+   * When on, the blocks of each process are contoured by multiple threads.
+   * The output is the same either way. Default is on.
+   */
+  vtkSetMacro(UseMultithreading, bool);
+  vtkGetMacro(UseMultithreading, bool);
+  vtkBooleanMacro(UseMultithreading, bool);
+  //@}
+
   vtkGetObjectMacro(Controller, vtkMultiProcessController);
   virtual void SetController(vtkMultiProcessController*);
 
@@ -130,6 +148,7 @@ protected:
   int EnableMergePoints;
   int TriangulateCap;
   int SkipGhostCopy;
+  bool UseMultithreading;
 
   int RequestData(vtkInformation*, vtkInformationVector**, vtkInformationVector*) VTK_OVERRIDE;
 
@@ -154,16 +173,24 @@ protected:
 
   void ShareBlockLocatorWithNeighbors(vtkAMRDualGridHelperBlock* block);
 
-  void ProcessBlock(vtkAMRDualGridHelperBlock* block, int blockId, const char* arrayName);
+  // Contour the blocks, possibly in parallel, and merge them into the output.
+  void ProcessBlocks(std::vector<vtkAMRDualContourBlockOutput>& outputs);
+  void MergeBlockPoints(vtkAMRDualContourBlockOutput* output, vtkIdType& numberOfPoints);
+  void FillBlockOutput(vtkAMRDualContourBlockOutput* output, vtkAMRDualContourProcessBlocks* pass);
+
+  void ProcessBlock(vtkAMRDualContourBlockOutput* output, vtkAMRDualContourEdgeLocator* locator);
 
-  void ProcessDualCell(vtkAMRDualGridHelperBlock* block, int blockId, int x, int y, int z,
-    vtkIdType cornerOffsets[8], vtkDataArray* volumeFractionArray);
+  void ProcessDualCell(vtkAMRDualContourBlockOutput* output, vtkAMRDualContourEdgeLocator* locator,
+    int x, int y, int z, vtkIdType cornerOffsets[8]);
 
-  void AddCapPolygon(int ptCount, vtkIdType* pointIds, int blockId);
+  void AddCapPolygon(vtkAMRDualContourBlockOutput* output, int ptCount, vtkIdType* pointIds);
 
   // This method is getting too many arguments!
   // Capping was an after thought...
-  void CapCell(int cellX, int cellY, int cellZ, // block coordinates
+  void CapCell(
+    // The block being contoured and its locator.
+    vtkAMRDualContourBlockOutput* output, vtkAMRDualContourEdgeLocator* locator,
+    int cellX, int cellY, int cellZ, // block coordinates
     // Which cell faces need to be capped.
     unsigned char cubeBoundaryBits,
     // Marching cubes case for this cell
@@ -173,11 +200,7 @@ protected:
     // Locations of 8 corners. (xyz4xyz4...) 4th value is not used.
     double cornerPoints[32],
     // The id order is VTK from marching cube cases.  Different than axis ordered "cornerPoints".
-    vtkIdType cornerOffsets[8],
-    // For block id array (for debugging).  I should just make this an ivar.
-    int blockId,
-    // For passing attributes to output mesh
-    vtkDataSet* inData);
+    vtkIdType cornerOffsets[8]);
 
   // Stuff exclusively for debugging.
   vtkIntArray* BlockIdCellArray;
@@ -196,18 +219,16 @@ protected:
   int* MessageBuffer;
   int* MessageBufferLength;
 
-  vtkAMRDualContourEdgeLocator* BlockLocator;
-
   // Stuff for passing cell attributes to point attributes.
+  // The attributes are copied by FillBlockOutput.
   void InitializeCopyAttributes(vtkNonOverlappingAMR* hbdsInput, vtkDataSet* mesh);
-  void InterpolateAttributes(vtkDataSet* uGrid, vtkIdType offset0, vtkIdType offset1, double k,
-    vtkDataSet* mesh, vtkIdType outId);
-  void CopyAttributes(vtkDataSet* uGrid, vtkIdType inId, vtkDataSet* mesh, vtkIdType outId);
   void FinalizeCopyAttributes(vtkDataSet* mesh);
 
 private:
   vtkAMRDualContour(const vtkAMRDualContour&) = delete;
   void operator=(const vtkAMRDualContour&) = delete;
+
+  friend class vtkAMRDualContourProcessBlocks;
 };
 
 #endif
@@ -721,6 +721,8 @@ vtkAMRDualGridHelper::vtkAMRDualGridHelper()
   this->EnableDegenerateCells = 1;
   this->EnableAsynchronousCommunication = 1;
   this->NumberOfBlocksInThisProcess = 0;
+  this->SharedRegionsAssigned = false;
+  this->UserDataDeleter = 0;
   for (ii = 0; ii < 3; ++ii)
   {
     this->StandardBlockDimensions[ii] = 0;
@@ -741,21 +743,9 @@ vtkAMRDualGridHelper::vtkAMRDualGridHelper()
 //----------------------------------------------------------------------------
 vtkAMRDualGridHelper::~vtkAMRDualGridHelper()
 {
-  int ii;
-  int numberOfLevels = (int)(this->Levels.size());
-
   this->SetArrayName(0);
 
-  for (ii = 0; ii < numberOfLevels; ++ii)
-  {
-    delete this->Levels[ii];
-    this->Levels[ii] = 0;
-  }
-
-  // Todo: See if we really need this.
-  this->NumberOfBlocksInThisProcess = 0;
-
-  this->DegenerateRegionQueue.clear();
+  this->ClearLevels();
 
   this->Controller->UnRegister(this);
   this->Controller = NULL;
@@ -797,6 +787,9 @@ void vtkAMRDualGridHelper::SetController(vtkMultiProcessController* controller)
   this->Controller = controller;
   controller->Register(this);
 
+  // The blocks of other processes have to be shared again.
+  this->TopologyKey.clear();
+
   this->Modified();
 }
 
@@ -853,6 +846,21 @@ void vtkAMRDualGridHelper::AddBlock(int level, int id, vtkImageData* volume)
   int y = (int)((center[1] - this->GlobalOrigin[1]) / blockSize[1]);
   int z = (int)((center[2] - this->GlobalOrigin[2]) / blockSize[2]);
   vtkAMRDualGridHelperBlock* block = this->Levels[level]->AddGridBlock(x, y, z, id, volume);
+  this->SetBlockImage(block, volume);
+}
+
+//----------------------------------------------------------------------------
+// Sets the image of a local block.  This computes the origin index of the
+// block and completes its ghost layers, so the image may be replaced by a copy.
+void vtkAMRDualGridHelper::SetBlockImage(vtkAMRDualGridHelperBlock* block, vtkImageData* volume)
+{
+  if (block->Image && block->CopyFlag)
+  { // We made a copy of the previous image.
+    block->Image->Delete();
+  }
+  block->Image = volume;
+  block->CopyFlag = 0;
+  int level = block->Level;
 
   // We need to set this ivar here because we need to compute the index
   // from the global origin and root spacing.  The issue is that some blocks
@@ -1293,10 +1301,41 @@ int vtkAMRDualGridHelper::ClaimBlockSharedRegion(vtkAMRDualGridHelperBlock* bloc
   }
 
   // If the region is degenerate and points have to be moved
-  // to a lower level grid, tehn we have to copy the
+  // to a lower level grid, then we have to copy the
   // volume fractions from the lower level grid too.
+  // The copy only depends on the array, so it is planned here and made by
+  // CopyDegenerateRegions() for every array.
   if (this->EnableDegenerateCells && bestLevel < blockLevel)
   {
+    vtkAMRDualGridHelperDegenerateRegion region;
+    region.ReceivingRegion[0] = regionX;
+    region.ReceivingRegion[1] = regionY;
+    region.ReceivingRegion[2] = regionZ;
+    region.SourceBlock = bestBlock;
+    region.ReceivingBlock = block;
+    this->DegenerateRegionPlan.push_back(region);
+  }
+
+  return bestLevel;
+}
+
+//----------------------------------------------------------------------------
+// Copies the values of the array being processed to the degenerate regions
+// planned by AssignSharedRegions().  Copies from remote blocks are queued
+// for ProcessRegionRemoteCopyQueue().
+void vtkAMRDualGridHelper::CopyDegenerateRegions()
+{
+  this->DegenerateRegionQueue.clear();
+
+  std::vector<vtkAMRDualGridHelperDegenerateRegion>::iterator region;
+  for (region = this->DegenerateRegionPlan.begin(); region != this->DegenerateRegionPlan.end();
+       ++region)
+  {
+    int regionX = region->ReceivingRegion[0];
+    int regionY = region->ReceivingRegion[1];
+    int regionZ = region->ReceivingRegion[2];
+    vtkAMRDualGridHelperBlock* bestBlock = region->SourceBlock;
+    vtkAMRDualGridHelperBlock* block = region->ReceivingBlock;
     if (block->Image == 0 || bestBlock->Image == 0)
     { // Deal with remote blocks later.
       // Add the pair of blocks to a queue to copy when we get the data.
@@ -1336,7 +1375,8 @@ int vtkAMRDualGridHelper::ClaimBlockSharedRegion(vtkAMRDualGridHelperBlock* bloc
         // << bestBlock->Image  << "\n";
       }
       vtkDataArray* blockDataArray = block->Image->GetCellData()->GetArray(this->ArrayName);
-      vtkDataArray* bestBlockDataArray = bestBlock->Image->GetCellData()->GetArray(this->ArrayName);
+      vtkDataArray* bestBlockDataArray =
+        bestBlock->Image->GetCellData()->GetArray(this->ArrayName);
       if (blockDataArray && bestBlockDataArray)
       {
         this->CopyDegenerateRegionBlockToBlock(
@@ -1344,9 +1384,8 @@ int vtkAMRDualGridHelper::ClaimBlockSharedRegion(vtkAMRDualGridHelperBlock* bloc
       }
     }
   }
-
-  return bestLevel;
 }
+
 void vtkAMRDualGridHelper::QueueRegionRemoteCopy(int regionX, int regionY, int regionZ,
   vtkAMRDualGridHelperBlock* lowResBlock, vtkDataArray* lowResArray,
   vtkAMRDualGridHelperBlock* highResBlock, vtkDataArray* highResArray)
@@ -2247,6 +2286,8 @@ void vtkAMRDualGridHelper::FinishDegenerateRegionsCommMPIAsynchronous(bool hackL
 // The array name is the cell array that is being processed by the filter.
 // Ghost values have to be modified at level changes.  It could be extended to
 // process multiple arrays.
+// The blocks and their neighbors are kept until the structure of the input
+// changes.  Then only the images of the local blocks are updated.
 int vtkAMRDualGridHelper::Initialize(vtkNonOverlappingAMR* input)
 {
   vtkTimerLogSmartMarkEvent markevent("vtkAMRDualGridHelper::Initialize", this->Controller);
@@ -2254,6 +2295,25 @@ int vtkAMRDualGridHelper::Initialize(vtkNonOverlappingAMR* input)
   int blockId, numBlocks;
   int numLevels = input->GetNumberOfLevels();
 
+  std::vector<double> topologyKey;
+  this->ComputeTopologyKey(input, topologyKey);
+  int reuseTopology = (!this->TopologyKey.empty() && topologyKey == this->TopologyKey) ? 1 : 0;
+  // Data attached to the blocks by the previous request is stale now, whether
+  // the blocks are reused or not.
+  this->ClearUserData();
+  if (this->Controller->GetNumberOfProcesses() > 1)
+  { // Blocks are shared by all processes, or none.
+    int localReuseTopology = reuseTopology;
+    this->Controller->AllReduce(&localReuseTopology, &reuseTopology, 1, vtkCommunicator::MIN_OP);
+  }
+  if (reuseTopology)
+  {
+    this->UpdateBlockImages(input);
+    return VTK_OK;
+  }
+  this->ClearLevels();
+  this->TopologyKey.swap(topologyKey);
+
   // Create the level objects.
   this->Levels.reserve(numLevels);
   for (int ii = 0; ii < numLevels; ++ii)
@@ -2367,19 +2427,39 @@ int vtkAMRDualGridHelper::SetupData(vtkNonOverlappingAMR* input, const char* arr
     }
   }
 
-  // Reset all the region bits
-  for (int level = 0; level < numLevels; ++level)
+  if (this->SharedRegionsAssigned)
   {
-    numBlocks = this->GetNumberOfBlocksInLevel(level);
-    for (blockId = 0; blockId < numBlocks; ++blockId)
+    // Filters flag processed blocks with the center region bit.
+    for (int level = 0; level < numLevels; ++level)
+    {
+      numBlocks = this->GetNumberOfBlocksInLevel(level);
+      for (blockId = 0; blockId < numBlocks; ++blockId)
+      {
+        this->GetBlock(level, blockId)->RegionBits[1][1][1] = vtkAMRRegionBitOwner;
+      }
+    }
+  }
+  else
+  {
+    // Reset all the region bits
+    for (int level = 0; level < numLevels; ++level)
     {
-      vtkAMRDualGridHelperBlock* block = this->GetBlock(level, blockId);
-      block->ResetRegionBits();
+      numBlocks = this->GetNumberOfBlocksInLevel(level);
+      for (blockId = 0; blockId < numBlocks; ++blockId)
+      {
+        vtkAMRDualGridHelperBlock* block = this->GetBlock(level, blockId);
+        block->ResetRegionBits();
+      }
     }
+
+    // Plan for meshing between blocks.
+    this->DegenerateRegionPlan.clear();
+    this->AssignSharedRegions();
+    this->SharedRegionsAssigned = true;
   }
 
-  // Plan for meshing between blocks.
-  this->AssignSharedRegions();
+  // Copy regions on level boundaries, queuing the ones between processes.
+  this->CopyDegenerateRegions();
 
   // Copy regions on level boundaries between processes.
   this->ProcessRegionRemoteCopyQueue(false);
@@ -2393,6 +2473,120 @@ void vtkAMRDualGridHelper::ClearRegionRemoteCopyQueue()
 {
   this->DegenerateRegionQueue.clear();
 }
+
+//----------------------------------------------------------------------------
+void vtkAMRDualGridHelper::ClearUserData()
+{
+  int numberOfLevels = (int)(this->Levels.size());
+  for (int level = 0; level < numberOfLevels; ++level)
+  {
+    std::vector<vtkAMRDualGridHelperBlock*>& blocks = this->Levels[level]->Blocks;
+    for (size_t ii = 0; ii < blocks.size(); ++ii)
+    {
+      vtkAMRDualGridHelperBlock* block = blocks[ii];
+      if (block->UserData && this->UserDataDeleter)
+      {
+        (*this->UserDataDeleter)(block->UserData);
+      }
+      block->UserData = 0;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkAMRDualGridHelper::ClearLevels()
+{
+  this->ClearUserData();
+  int numberOfLevels = (int)(this->Levels.size());
+  for (int ii = 0; ii < numberOfLevels; ++ii)
+  {
+    delete this->Levels[ii];
+    this->Levels[ii] = 0;
+  }
+  this->Levels.clear();
+
+  // Todo: See if we really need this.
+  this->NumberOfBlocksInThisProcess = 0;
+
+  this->DegenerateRegionQueue.clear();
+  this->DegenerateRegionPlan.clear();
+  this->SharedRegionsAssigned = false;
+  this->TopologyKey.clear();
+}
+
+//----------------------------------------------------------------------------
+// Everything Initialize() computes depends on the levels, the extents and
+// positions of the local images, the meta information passed by a
+// coprocessing adaptor and EnableDegenerateCells.  The key holds all of them.
+void vtkAMRDualGridHelper::ComputeTopologyKey(vtkNonOverlappingAMR* input, std::vector<double>& key)
+{
+  key.clear();
+  key.push_back(this->EnableDegenerateCells);
+  int numLevels = input->GetNumberOfLevels();
+  key.push_back(numLevels);
+  for (int level = 0; level < numLevels; ++level)
+  {
+    int numBlocks = input->GetNumberOfDataSets(level);
+    key.push_back(numBlocks);
+    for (int blockId = 0; blockId < numBlocks; ++blockId)
+    {
+      vtkImageData* image = input->GetDataSet(level, blockId);
+      if (image == 0)
+      {
+        continue;
+      }
+      key.push_back(blockId);
+      int* ext = image->GetExtent();
+      key.insert(key.end(), ext, ext + 6);
+      double* origin = image->GetOrigin();
+      key.insert(key.end(), origin, origin + 3);
+      double* spacing = image->GetSpacing();
+      key.insert(key.end(), spacing, spacing + 3);
+    }
+  }
+
+  const char* metaDataNames[5] = { "GlobalBounds", "GlobalBoxSize", "MinLevel", "MinLevelSpacing",
+    "Neighbors" };
+  vtkFieldData* inputFd = input->GetFieldData();
+  for (int ii = 0; ii < 5; ++ii)
+  {
+    vtkDataArray* array = inputFd->GetArray(metaDataNames[ii]);
+    if (array == 0)
+    {
+      continue;
+    }
+    key.push_back(ii);
+    vtkIdType numValues = array->GetNumberOfTuples() * array->GetNumberOfComponents();
+    key.push_back(numValues);
+    for (vtkIdType jj = 0; jj < numValues; ++jj)
+    {
+      key.push_back(array->GetComponent(jj / array->GetNumberOfComponents(),
+        static_cast<int>(jj % array->GetNumberOfComponents())));
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+// The structure of the input has not changed: keep the blocks and give the
+// local ones the images of the new input.
+void vtkAMRDualGridHelper::UpdateBlockImages(vtkNonOverlappingAMR* input)
+{
+  int numLevels = this->GetNumberOfLevels();
+  for (int level = 0; level < numLevels; ++level)
+  {
+    std::vector<vtkAMRDualGridHelperBlock*>& blocks = this->Levels[level]->Blocks;
+    for (size_t ii = 0; ii < blocks.size(); ++ii)
+    {
+      vtkAMRDualGridHelperBlock* block = blocks[ii];
+      if (block->Image)
+      { // Only local blocks have images.
+        this->SetBlockImage(block, input->GetDataSet(level, block->BlockId));
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
 void vtkAMRDualGridHelper::ShareBlocks()
 {
   vtkTimerLogSmartMarkEvent markevent("ShareBlocks", this->Controller);
@@ -23,6 +23,14 @@
  * This class will take advantage of some meta information, if available
  * from a coprocessing adaptor.  If not available, it will compute the
  * information.
+ *
+ * Filters can keep the helper between executions.  The blocks, their
+ * neighbors and the regions shared between blocks only depend on the
+ * structure of the input, so Initialize() only recomputes and exchanges them
+ * when the levels, the extents of the images or the meta information change.
+ * Otherwise SetupData() just copies the values of the array to the degenerate
+ * regions and exchanges the ones on other processes, which makes changing
+ * e.g. the contour value cheap.
 */
 
 #ifndef vtkAMRDualGridHelper_h
@@ -95,7 +103,19 @@ public:
   virtual void SetController(vtkMultiProcessController*);
   //@}
 
+  /**
+   * Finds the blocks of all processes and their neighbors.  This is
+   * collective.  When the structure of the input is the same as in the
+   * previous call on all processes, the blocks are kept and only the images
+   * of the local blocks are updated.
+   */
   int Initialize(vtkNonOverlappingAMR* input);
+
+  /**
+   * Assigns the regions shared between blocks, the first time after the
+   * blocks changed, and copies the values of the array to the degenerate
+   * regions of the blocks, exchanging them between processes.
+   */
   int SetupData(vtkNonOverlappingAMR* input, const char* arrayName);
   const double* GetGlobalOrigin() { return this->GlobalOrigin; }
   const double* GetRootSpacing() { return this->RootSpacing; }
@@ -142,6 +162,19 @@ public:
   vtkGetStringMacro(ArrayName);
   //@}
 
+  //@{
+  /**
+   * Filters store their own data, e.g. point locators, in
+   * vtkAMRDualGridHelperBlock::UserData.  Since the blocks are kept between
+   * calls to Initialize(), the helper uses this function to delete the user
+   * data of the blocks when they are reused or deleted.  ClearUserData() does
+   * the same on demand, e.g. at the end of a request.
+   */
+  typedef void (*UserDataDeleterType)(void*);
+  void SetUserDataDeleter(UserDataDeleterType deleter) { this->UserDataDeleter = deleter; }
+  void ClearUserData();
+  //@}
+
 private:
   vtkAMRDualGridHelper();
   ~vtkAMRDualGridHelper() override;
@@ -163,6 +196,14 @@ private:
   vtkMultiProcessController* Controller;
   void ComputeGlobalMetaData(vtkNonOverlappingAMR* input);
   void AddBlock(int level, int id, vtkImageData* volume);
+  void SetBlockImage(vtkAMRDualGridHelperBlock* block, vtkImageData* volume);
+
+  // Reuse of the blocks between calls to Initialize.
+  UserDataDeleterType UserDataDeleter;
+  void ClearLevels();
+  void ComputeTopologyKey(vtkNonOverlappingAMR* input, std::vector<double>& key);
+  void UpdateBlockImages(vtkNonOverlappingAMR* input);
+  std::vector<double> TopologyKey;
 
   // Manage connectivity seeds between blocks.
   void CreateFaces();
@@ -175,6 +216,9 @@ private:
     vtkAMRDualGridHelperBlock* block, int blockLevel, int blockX, int blockY, int blockZ);
   int ClaimBlockSharedRegion(vtkAMRDualGridHelperBlock* block, int blockX, int blockY, int blockZ,
     int regionX, int regionY, int regionZ);
+  // Copy the array to the degenerate regions found by AssignSharedRegions.
+  void CopyDegenerateRegions();
+  bool SharedRegionsAssigned;
 
   int NumberOfBlocksInThisProcess;
 
@@ -211,6 +255,8 @@ private:
   // Degenerate regions that span processes.  We keep them in a queue
   // to communicate and process all at once.
   std::vector<vtkAMRDualGridHelperDegenerateRegion> DegenerateRegionQueue;
+  // All degenerate regions, local or not, without arrays.
+  std::vector<vtkAMRDualGridHelperDegenerateRegion> DegenerateRegionPlan;
   void DegenerateRegionMessageSize(vtkIdTypeArray* srcProcs, vtkIdTypeArray* destProc);
   void* CopyDegenerateRegionBlockToMessage(
     const vtkAMRDualGridHelperDegenerateRegion& region, void* messagePtr);
@@ -294,7 +340,7 @@ public:
 
   // Different algorithms need to store different information
   // with the blocks.  I could make this a vtkObject so the destructor
-  // would delete it.
+  // would delete it.  The helper deletes it with its UserDataDeleter.
   void* UserData;
 
 private:
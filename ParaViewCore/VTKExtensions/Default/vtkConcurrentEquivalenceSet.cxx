@@ -0,0 +1,162 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    vtkConcurrentEquivalenceSet.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkConcurrentEquivalenceSet.h"
+
+#include "vtkEquivalenceSet.h"
+#include "vtkObjectFactory.h"
+#include "vtkSMPTools.h"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+class vtkConcurrentEquivalenceSet::vtkInternals
+{
+public:
+  // Parent of each member, roots reference themselves. A member always
+  // references a smaller or equal id, so the forest cannot have cycles
+  // whatever the order in which threads link roots.
+  std::vector<std::atomic<vtkIdType> > Parents;
+
+  vtkIdType FindRoot(vtkIdType memberId)
+  {
+    vtkIdType parent = this->Parents[memberId].load(std::memory_order_relaxed);
+    while (parent != memberId)
+    {
+      // Path halving. This only shortcuts a path, so it is fine for the
+      // exchange to fail when another thread changed the parent first.
+      vtkIdType grandParent = this->Parents[parent].load(std::memory_order_relaxed);
+      this->Parents[memberId].compare_exchange_weak(
+        parent, grandParent, std::memory_order_relaxed);
+      memberId = grandParent;
+      parent = this->Parents[memberId].load(std::memory_order_relaxed);
+    }
+    return memberId;
+  }
+
+  void Equate(vtkIdType id1, vtkIdType id2)
+  {
+    for (;;)
+    {
+      vtkIdType root1 = this->FindRoot(id1);
+      vtkIdType root2 = this->FindRoot(id2);
+      if (root1 == root2)
+      {
+        return;
+      }
+      if (root1 < root2)
+      {
+        std::swap(root1, root2);
+      }
+      // Attach the larger root to the smaller one, unless another thread
+      // attached it somewhere first, in which case we start over.
+      vtkIdType expected = root1;
+      if (this->Parents[root1].compare_exchange_strong(
+            expected, root2, std::memory_order_acq_rel, std::memory_order_relaxed))
+      {
+        return;
+      }
+      id1 = root1;
+      id2 = root2;
+    }
+  }
+};
+
+namespace
+{
+class vtkInitializeParents
+{
+public:
+  std::vector<std::atomic<vtkIdType> >& Parents;
+
+  vtkInitializeParents(std::vector<std::atomic<vtkIdType> >& parents)
+    : Parents(parents)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType ii = begin; ii < end; ++ii)
+    {
+      this->Parents[ii].store(ii, std::memory_order_relaxed);
+    }
+  }
+};
+}
+
+vtkStandardNewMacro(vtkConcurrentEquivalenceSet);
+//----------------------------------------------------------------------------
+vtkConcurrentEquivalenceSet::vtkConcurrentEquivalenceSet()
+{
+  this->Internals = new vtkInternals();
+}
+
+//----------------------------------------------------------------------------
+vtkConcurrentEquivalenceSet::~vtkConcurrentEquivalenceSet()
+{
+  delete this->Internals;
+  this->Internals = NULL;
+}
+
+//----------------------------------------------------------------------------
+void vtkConcurrentEquivalenceSet::SetNumberOfMembers(vtkIdType num)
+{
+  // std::atomic is not movable, so the vector cannot be resized.
+  std::vector<std::atomic<vtkIdType> > parents(num > 0 ? num : 0);
+  this->Internals->Parents.swap(parents);
+  vtkInitializeParents functor(this->Internals->Parents);
+  vtkSMPTools::For(0, num, functor);
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkConcurrentEquivalenceSet::GetNumberOfMembers()
+{
+  return static_cast<vtkIdType>(this->Internals->Parents.size());
+}
+
+//----------------------------------------------------------------------------
+void vtkConcurrentEquivalenceSet::AddEquivalence(vtkIdType id1, vtkIdType id2)
+{
+  this->Internals->Equate(id1, id2);
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkConcurrentEquivalenceSet::GetEquivalentSetId(vtkIdType memberId)
+{
+  return this->Internals->FindRoot(memberId);
+}
+
+//----------------------------------------------------------------------------
+void vtkConcurrentEquivalenceSet::CopyEquivalences(vtkEquivalenceSet* set)
+{
+  const vtkIdType num = this->GetNumberOfMembers();
+  set->SetNumberOfMembers(num);
+  for (vtkIdType ii = 0; ii < num; ++ii)
+  {
+    vtkIdType root = this->Internals->FindRoot(ii);
+    if (root != ii)
+    {
+      set->AddEquivalence(root, ii);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkConcurrentEquivalenceSet::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfMembers: " << this->GetNumberOfMembers() << endl;
+}
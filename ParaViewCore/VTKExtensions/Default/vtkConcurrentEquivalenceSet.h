@@ -0,0 +1,87 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    vtkConcurrentEquivalenceSet.h
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+ * @class   vtkConcurrentEquivalenceSet
+ * @brief   equivalence set that threads can update concurrently.
+ *
+ * vtkConcurrentEquivalenceSet is a lock-free union-find forest over a fixed
+ * range of 64-bit ids. Once SetNumberOfMembers() is called, any number of
+ * threads (e.g. vtkSMPTools functors labeling blocks of cells) can call
+ * AddEquivalence() and GetEquivalentSetId() at the same time. Roots are
+ * linked with compare-and-swap, always attaching the larger root to the
+ * smaller one, and lookups halve the paths they walk. Thus, once all threads
+ * are done, the representative of every set is its smallest member,
+ * regardless of the order in which equivalences were added.
+ *
+ * Use CopyEquivalences() to pass the result to a vtkEquivalenceSet (or
+ * vtkPEquivalenceSet) for resolution.
+ * @sa
+ * vtkEquivalenceSet
+*/
+
+#ifndef vtkConcurrentEquivalenceSet_h
+#define vtkConcurrentEquivalenceSet_h
+
+#include "vtkObject.h"
+#include "vtkPVVTKExtensionsDefaultModule.h" //needed for exports
+
+class vtkEquivalenceSet;
+
+class VTKPVVTKEXTENSIONSDEFAULT_EXPORT vtkConcurrentEquivalenceSet : public vtkObject
+{
+public:
+  static vtkConcurrentEquivalenceSet* New();
+  vtkTypeMacro(vtkConcurrentEquivalenceSet, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  /**
+   * Resets the set so that ids [0, num) are members, each equivalent to only
+   * itself. This is not thread safe.
+   */
+  void SetNumberOfMembers(vtkIdType num);
+  vtkIdType GetNumberOfMembers();
+
+  /**
+   * Makes two members equivalent. This is thread safe. Both ids must be in
+   * [0, GetNumberOfMembers()).
+   */
+  void AddEquivalence(vtkIdType id1, vtkIdType id2);
+
+  /**
+   * Returns the representative of the set the member belongs to. This is
+   * thread safe. While other threads add equivalences, the result may be
+   * outdated as soon as it is returned.
+   */
+  vtkIdType GetEquivalentSetId(vtkIdType memberId);
+
+  /**
+   * Adds all equivalences recorded in this set to the given set, which is
+   * grown to include all members. This is not thread safe.
+   */
+  void CopyEquivalences(vtkEquivalenceSet* set);
+
+protected:
+  vtkConcurrentEquivalenceSet();
+  ~vtkConcurrentEquivalenceSet() override;
+
+private:
+  vtkConcurrentEquivalenceSet(const vtkConcurrentEquivalenceSet&) = delete;
+  void operator=(const vtkConcurrentEquivalenceSet&) = delete;
+
+  class vtkInternals;
+  vtkInternals* Internals;
+};
+
+#endif
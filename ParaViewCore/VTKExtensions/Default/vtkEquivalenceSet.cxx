@@ -13,8 +13,9 @@
 
 =========================================================================*/
 #include "vtkEquivalenceSet.h"
-#include "vtkIntArray.h"
+#include "vtkIdTypeArray.h"
 #include "vtkObjectFactory.h"
+#include "vtkUnsignedCharArray.h"
 
 vtkStandardNewMacro(vtkEquivalenceSet);
 
@@ -22,14 +23,18 @@ vtkStandardNewMacro(vtkEquivalenceSet);
 // A class that implements an equivalent set.  It is used to combine fragments
 // from different processes.
 //
-// I believe that this class is a strictly ordered tree of equivalences.
-// Every member points to its own id or an id smaller than itself.
+// This is a union-find forest.  Every member points to its parent, roots
+// point to themselves.  Sets are merged by rank (the smaller tree is attached
+// to the root of the larger one) and every lookup halves the path it walks,
+// so trees stay nearly flat.
 
 //----------------------------------------------------------------------------
 vtkEquivalenceSet::vtkEquivalenceSet()
 {
   this->Resolved = 0;
-  this->EquivalenceArray = vtkIntArray::New();
+  this->NumberOfResolvedSets = 0;
+  this->EquivalenceArray = vtkIdTypeArray::New();
+  this->RankArray = vtkUnsignedCharArray::New();
 }
 
 //----------------------------------------------------------------------------
@@ -41,6 +46,11 @@ vtkEquivalenceSet::~vtkEquivalenceSet()
     this->EquivalenceArray->Delete();
     this->EquivalenceArray = 0;
   }
+  if (this->RankArray)
+  {
+    this->RankArray->Delete();
+    this->RankArray = 0;
+  }
 }
 
 //----------------------------------------------------------------------------
@@ -49,13 +59,16 @@ void vtkEquivalenceSet::Initialize()
   this->Resolved = 0;
   this->NumberOfResolvedSets = 0;
   this->EquivalenceArray->Initialize();
+  this->RankArray->Initialize();
 }
 
 //----------------------------------------------------------------------------
 void vtkEquivalenceSet::DeepCopy(vtkEquivalenceSet* in)
 {
   this->Resolved = in->Resolved;
+  this->NumberOfResolvedSets = in->NumberOfResolvedSets;
   this->EquivalenceArray->DeepCopy(in->EquivalenceArray);
+  this->RankArray->DeepCopy(in->RankArray);
 }
 
 //----------------------------------------------------------------------------
@@ -74,23 +87,18 @@ void vtkEquivalenceSet::PrintSelf(ostream& os, vtkIndent indent)
 
 //----------------------------------------------------------------------------
 // Return the id of the equivalent set.
-int vtkEquivalenceSet::GetEquivalentSetId(int memberId)
+vtkIdType vtkEquivalenceSet::GetEquivalentSetId(vtkIdType memberId)
 {
-  int ref;
-
-  ref = this->GetReference(memberId);
-  while (!this->Resolved && ref != memberId)
+  if (this->Resolved)
   {
-    memberId = ref;
-    ref = this->GetReference(memberId);
+    return this->GetReference(memberId);
   }
-
-  return ref;
+  return this->FindRoot(memberId);
 }
 
 //----------------------------------------------------------------------------
 // Return the id of the equivalent set.
-int vtkEquivalenceSet::GetReference(int memberId)
+vtkIdType vtkEquivalenceSet::GetReference(vtkIdType memberId)
 {
   if (memberId >= this->EquivalenceArray->GetNumberOfTuples())
   { // We might consider this an error ...
@@ -99,11 +107,50 @@ int vtkEquivalenceSet::GetReference(int memberId)
   return this->EquivalenceArray->GetValue(memberId);
 }
 
+//----------------------------------------------------------------------------
+vtkIdType vtkEquivalenceSet::FindRoot(vtkIdType memberId)
+{
+  if (memberId >= this->EquivalenceArray->GetNumberOfTuples())
+  {
+    return memberId;
+  }
+  // Path halving: point every other member on the path to its grandparent.
+  vtkIdType* parents = this->EquivalenceArray->GetPointer(0);
+  while (parents[memberId] != memberId)
+  {
+    vtkIdType grandParent = parents[parents[memberId]];
+    parents[memberId] = grandParent;
+    memberId = grandParent;
+  }
+  return memberId;
+}
+
+//----------------------------------------------------------------------------
+void vtkEquivalenceSet::SetNumberOfMembers(vtkIdType num)
+{
+  vtkIdType oldNum = this->EquivalenceArray->GetNumberOfTuples();
+  if (num <= oldNum)
+  {
+    return;
+  }
+  // The arrays grow geometrically, so growing one id at a time is cheap too.
+  this->EquivalenceArray->SetNumberOfTuples(num);
+  this->RankArray->SetNumberOfTuples(num);
+  vtkIdType* parents = this->EquivalenceArray->GetPointer(0);
+  unsigned char* ranks = this->RankArray->GetPointer(0);
+  for (vtkIdType ii = oldNum; ii < num; ++ii)
+  {
+    // All values inserted are equivalent to only themselves.
+    parents[ii] = ii;
+    ranks[ii] = 0;
+  }
+}
+
 //----------------------------------------------------------------------------
 // Makes two new or existing ids equivalent.
 // If the array is too small, the range of ids is increased until it contains
 // both the ids.  Negative ids are not allowed.
-void vtkEquivalenceSet::AddEquivalence(int id1, int id2)
+void vtkEquivalenceSet::AddEquivalence(vtkIdType id1, vtkIdType id2)
 {
   if (this->Resolved)
   {
@@ -111,46 +158,20 @@ void vtkEquivalenceSet::AddEquivalence(int id1, int id2)
     return;
   }
 
-  int num = this->EquivalenceArray->GetNumberOfTuples();
-
   // Expand the range to include both ids.
-  while (num <= id1 || num <= id2)
-  {
-    // All values inserted are equivalent to only themselves.
-    this->EquivalenceArray->InsertNextTuple1(num);
-    ++num;
-  }
-
-  // Our rule for references in the equivalent set is that
-  // all elements must point to a member equal to or smaller
-  // than itself.
-
-  // The only problem we could encounter is changing a reference.
-  // we do not want to orphan anything previously referenced.
+  this->SetNumberOfMembers((id1 > id2 ? id1 : id2) + 1);
 
-  // Replace the larger references.
-  if (id1 < id2)
-  {
-    // We could follow the references to the smallest.  It might
-    // make this processing more efficient.  This is a compromise.
-    // The referenced id will always be smaller than the id so
-    // order does not change.
-    this->EquateInternal(this->GetReference(id1), id2);
-  }
-  else
-  {
-    this->EquateInternal(this->GetReference(id2), id1);
-  }
+  this->EquateInternal(id1, id2);
 }
 
 //----------------------------------------------------------------------------
-int vtkEquivalenceSet::GetNumberOfMembers()
+vtkIdType vtkEquivalenceSet::GetNumberOfMembers()
 {
   return this->EquivalenceArray->GetNumberOfTuples();
 }
 
 //----------------------------------------------------------------------------
-int* vtkEquivalenceSet::GetPointer()
+vtkIdType* vtkEquivalenceSet::GetPointer()
 {
   return this->EquivalenceArray->GetPointer(0);
 }
@@ -159,6 +180,7 @@ int* vtkEquivalenceSet::GetPointer()
 void vtkEquivalenceSet::Squeeze()
 {
   this->EquivalenceArray->Squeeze();
+  this->RankArray->Squeeze();
 }
 
 //----------------------------------------------------------------------------
@@ -168,63 +190,86 @@ vtkIdType vtkEquivalenceSet::Capacity()
 }
 
 //----------------------------------------------------------------------------
-// id1 must be less than or equal to id2.
-void vtkEquivalenceSet::EquateInternal(int id1, int id2)
+// Both ids must be members.
+void vtkEquivalenceSet::EquateInternal(vtkIdType id1, vtkIdType id2)
 {
-  // This is the reference that might be orphaned in this process.
-  int oldRef = this->GetEquivalentSetId(id2);
+  vtkIdType root1 = this->FindRoot(id1);
+  vtkIdType root2 = this->FindRoot(id2);
 
-  // The two ids are already equal (not the only way they might be equal).
-  if (oldRef == id1)
+  // The two ids are already equal.
+  if (root1 == root2)
   {
     return;
   }
 
-  // The only problem we could encounter is changing a reference.
-  // we do not want to orphan anything previously referenced.
-  if (oldRef == id2)
+  // Attach the shallower tree to the root of the deeper one.
+  vtkIdType* parents = this->EquivalenceArray->GetPointer(0);
+  unsigned char* ranks = this->RankArray->GetPointer(0);
+  if (ranks[root1] < ranks[root2])
   {
-    this->EquivalenceArray->SetValue(id2, id1);
+    parents[root1] = root2;
   }
-  else if (oldRef > id1)
+  else if (ranks[root1] > ranks[root2])
   {
-    this->EquivalenceArray->SetValue(id2, id1);
-    this->EquateInternal(id1, oldRef);
+    parents[root2] = root1;
   }
   else
-  { // oldRef < id1
-    this->EquateInternal(oldRef, id1);
+  {
+    parents[root2] = root1;
+    ++ranks[root1];
   }
 }
 
 //----------------------------------------------------------------------------
 // Returns the number of merged sets.
-int vtkEquivalenceSet::ResolveEquivalences()
+vtkIdType vtkEquivalenceSet::ResolveEquivalences()
 {
   // Go through the equivalence array collapsing chains
   // and assigning consecutive ids.
-  int count = 0;
-  int id;
-  int newId;
+  vtkIdType numIds = this->EquivalenceArray->GetNumberOfTuples();
+  vtkIdType* parents = this->EquivalenceArray->GetPointer(0);
 
-  int numIds = this->EquivalenceArray->GetNumberOfTuples();
-  for (int ii = 0; ii < numIds; ++ii)
+  // Point all members to their root.
+  for (vtkIdType ii = 0; ii < numIds; ++ii)
   {
-    id = this->EquivalenceArray->GetValue(ii);
-    if (id == ii)
+    parents[ii] = this->FindRoot(parents[ii]);
+  }
+
+  // Number the sets in the order of their smallest member.  A root is seen
+  // for the first time either as itself or through a smaller member.  Until
+  // the root itself is relabeled, its set id is stored as -(id + 1) in place
+  // of the root.  Members smaller than ii always hold their final set id.
+  vtkIdType count = 0;
+  for (vtkIdType ii = 0; ii < numIds; ++ii)
+  {
+    vtkIdType root = parents[ii];
+    if (root < 0)
+    { // A root already numbered through a smaller member.
+      parents[ii] = -root - 1;
+    }
+    else if (root == ii)
     { // This is a new equivalence set.
-      this->EquivalenceArray->SetValue(ii, count);
-      ++count;
+      parents[ii] = count++;
     }
-    else
+    else if (root > ii)
     {
-      // All earlier ids will be resolved already.
-      // This array only point to less than or equal ids. (id <= ii).
-      newId = this->EquivalenceArray->GetValue(id);
-      this->EquivalenceArray->SetValue(ii, newId);
+      if (parents[root] == root)
+      { // This is a new equivalence set, its root comes later.
+        parents[root] = -(count + 1);
+        parents[ii] = count++;
+      }
+      else
+      {
+        parents[ii] = -parents[root] - 1;
+      }
+    }
+    else
+    { // The root was already relabeled.
+      parents[ii] = parents[root];
     }
   }
   this->Resolved = 1;
+  this->RankArray->Initialize();
   // cerr << "Final number of equivalent sets: " << count << endl;
 
   this->NumberOfResolvedSets = count;
@@ -18,6 +18,12 @@
  *
  * Useful for connectivity on multiple processes.  Run connectivity
  * on each processes, then make touching fragments equivalent.
+ *
+ * The set is a union-find forest over 64-bit ids (vtkIdType): equivalences
+ * are merged by rank and lookups compress the paths they walk, so adding
+ * equivalences and looking up set ids take near constant time. The
+ * representative of a set is any of its members until the set is resolved.
+ * For labeling with multiple threads, see vtkConcurrentEquivalenceSet.
 */
 
 #ifndef vtkEquivalenceSet_h
@@ -25,7 +31,8 @@
 
 #include "vtkObject.h"
 #include "vtkPVVTKExtensionsDefaultModule.h" //needed for exports
-class vtkIntArray;
+class vtkIdTypeArray;
+class vtkUnsignedCharArray;
 
 class VTKPVVTKEXTENSIONSDEFAULT_EXPORT vtkEquivalenceSet : public vtkObject
 {
@@ -35,29 +42,34 @@ public:
   static vtkEquivalenceSet* New();
 
   void Initialize();
-  void AddEquivalence(int id1, int id2);
+  void AddEquivalence(vtkIdType id1, vtkIdType id2);
 
   // The length of the equivalent array...
   // The Domain of the equivalance map is [0, numberOfMembers).
-  int GetNumberOfMembers();
+  vtkIdType GetNumberOfMembers();
+
+  // Make sure ids [0, num) are members. Use this to avoid growing the set one
+  // equivalence at a time when the number of members is known.
+  void SetNumberOfMembers(vtkIdType num);
 
   // Valid only after set is resolved.
   // The range of the map is [0 numberOfResolvedSets)
-  int GetNumberOfResolvedSets() { return this->NumberOfResolvedSets; }
+  vtkIdType GetNumberOfResolvedSets() { return this->NumberOfResolvedSets; }
 
   // Return the id of the equivalent set.
-  int GetEquivalentSetId(int memberId);
+  vtkIdType GetEquivalentSetId(vtkIdType memberId);
 
-  // Equivalent set ids are reassinged to be sequential.
+  // Equivalent set ids are reassinged to be sequential, in the order of the
+  // smallest member of each set.
   // You cannot add anymore equivalences after this is called.
-  virtual int ResolveEquivalences();
+  virtual vtkIdType ResolveEquivalences();
 
   void DeepCopy(vtkEquivalenceSet* in);
 
   // Needed for sending the set over MPI.
   // Be very careful with the pointer.
   // I guess this means do not write to the memory.
-  int* GetPointer();
+  vtkIdType* GetPointer();
 
   // Free unused memory
   void Squeeze();
@@ -68,20 +80,30 @@ public:
   // We should fix the pointer API and hide this ivar.
   int Resolved;
 
-  int GetReference(int memberId);
+  vtkIdType GetReference(vtkIdType memberId);
 
 protected:
   vtkEquivalenceSet();
   ~vtkEquivalenceSet() override;
 
-  int NumberOfResolvedSets;
+  vtkIdType NumberOfResolvedSets;
 
   // To merge connected framgments that have different ids because they were
   // traversed by different processes or passes.
-  vtkIntArray* EquivalenceArray;
+  // Each member references its parent in the union-find forest, roots
+  // reference themselves. After resolution, members reference their set id.
+  vtkIdTypeArray* EquivalenceArray;
 
-  // Return the id of the equivalent set.
-  void EquateInternal(int id1, int id2);
+  // Upper bound of the height of the tree below each root, used to keep the
+  // trees shallow when merging. Not used after resolution.
+  vtkUnsignedCharArray* RankArray;
+
+  // Return the root of the tree the member belongs to, compressing the path
+  // walked.
+  vtkIdType FindRoot(vtkIdType memberId);
+
+  // Merge the sets of two existing ids.
+  void EquateInternal(vtkIdType id1, vtkIdType id2);
 
 private:
   vtkEquivalenceSet(const vtkEquivalenceSet&) = delete;
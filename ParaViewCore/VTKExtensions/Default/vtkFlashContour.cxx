@@ -27,8 +27,12 @@
 #include "vtkPointData.h"
 #include "vtkPoints.h"
 #include "vtkPolyData.h"
+#include "vtkSMPTools.h"
 #include "vtkUnsignedCharArray.h"
 
+#include <unordered_map>
+#include <vector>
+
 vtkStandardNewMacro(vtkFlashContour);
 
 // How do we find edge/corner neighbors and neighbors in different levels.
@@ -45,6 +49,113 @@ static int vtkFlashIsoEdgeToPointsTable[12][2] = { { 0, 1 }, { 1, 3 }, { 2, 3 },
 static int vtkFlashIsoEdgeToVTKPointsTable[12][2] = { { 0, 1 }, { 1, 2 }, { 3, 2 }, { 0, 3 },
   { 4, 5 }, { 5, 6 }, { 7, 6 }, { 4, 7 }, { 0, 4 }, { 1, 5 }, { 3, 7 }, { 2, 6 } };
 
+//============================================================================
+// A contour point is on the edge between two dual points, which are the
+// centers of two input cells.  Cells are identified by the global block id
+// and the index of the cell in the block, so the point is found again by
+// every dual cell sharing the edge, in this block or in a neighbor.
+class vtkFlashContourEdge
+{
+public:
+  vtkFlashContourEdge(vtkTypeInt64 cellA, vtkTypeInt64 cellB)
+    : MinCell((cellA < cellB) ? cellA : cellB)
+    , MaxCell((cellA < cellB) ? cellB : cellA)
+  {
+  }
+  vtkTypeInt64 MinCell;
+  vtkTypeInt64 MaxCell;
+  bool operator==(const vtkFlashContourEdge& other) const
+  {
+    return this->MinCell == other.MinCell && this->MaxCell == other.MaxCell;
+  }
+};
+
+struct vtkFlashContourEdgeHash
+{
+  size_t operator()(const vtkFlashContourEdge& edge) const
+  {
+    // Neighboring cells have close ids, so mix them before combining.
+    vtkTypeUInt64 key = static_cast<vtkTypeUInt64>(edge.MinCell) * 0x9E3779B97F4A7C15ULL;
+    key ^= static_cast<vtkTypeUInt64>(edge.MaxCell) + (key >> 29);
+    return static_cast<size_t>(key ^ (key >> 32));
+  }
+};
+
+typedef std::unordered_map<vtkFlashContourEdge, vtkIdType, vtkFlashContourEdgeHash>
+  vtkFlashContourEdgeMap;
+
+//============================================================================
+// The triangles of one leaf block and of the shared regions it owns.
+// Leaves are contoured independently, possibly by different threads, with
+// point ids local to the leaf.  They are merged into the output in the order
+// of the tree traversal, so the output does not depend on the number of
+// threads.
+class vtkFlashContourBlockOutput
+{
+public:
+  // Set by RecurseTree.
+  int Neighborhood[3][3][3];
+  vtkImageData* Image;
+  int GlobalBlockId;
+  unsigned char Level;
+  unsigned char RemainingDepth;
+
+  // Errors cannot be reported from the threads.
+  const char* Error;
+
+  // For each local point: its coordinates, the interpolated value of the
+  // passed attribute and, when merging points, its edge.
+  std::vector<double> Points;
+  std::vector<double> PassValues;
+  std::vector<vtkFlashContourEdge> Edges;
+  // Local point of each edge while the leaf is contoured.
+  vtkFlashContourEdgeMap EdgeMap;
+  // Three local point ids per triangle.
+  std::vector<vtkIdType> Triangles;
+
+  // Set when merging: the output id of each local point, the local points
+  // that are new in the output and where the triangles are written.
+  std::vector<vtkIdType> PointIds;
+  std::vector<vtkIdType> NewPoints;
+  vtkIdType PointOffset;
+  vtkIdType CellOffset;
+};
+
+//============================================================================
+// Runs one pass of the contour over a range of leaf blocks.
+class vtkFlashContourProcessBlocks
+{
+public:
+  enum
+  {
+    CONTOUR_BLOCKS,
+    FILL_OUTPUT
+  };
+
+  vtkFlashContour* Filter;
+  vtkFlashContourBlockOutput* Outputs;
+  vtkMultiBlockDataSet* Input;
+  int Pass;
+
+  // Output connectivity filled by FILL_OUTPUT.
+  vtkIdType* Cells;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType ii = begin; ii < end; ++ii)
+    {
+      if (this->Pass == CONTOUR_BLOCKS)
+      {
+        this->Filter->ContourBlock(this->Outputs + ii, this->Input);
+      }
+      else
+      {
+        this->Filter->FillBlockOutput(this->Outputs + ii, this);
+      }
+    }
+  }
+};
+
 //============================================================================
 //----------------------------------------------------------------------------
 // Description:
@@ -56,6 +167,9 @@ vtkFlashContour::vtkFlashContour()
   this->PassAttribute = 0;
   this->PassArray = 0;
   this->CellArrayNameToProcess = 0;
+  this->MergePoints = true;
+  this->UseMultithreading = true;
+  this->NumberOfCellsPerBlock = 0;
 
   // Pipeline
   this->SetNumberOfOutputPorts(1);
@@ -79,6 +193,8 @@ void vtkFlashContour::PrintSelf(ostream& os, vtkIndent indent)
   {
     os << indent << "PassAttribute: " << this->PassAttribute << endl;
   }
+  os << indent << "MergePoints: " << this->MergePoints << endl;
+  os << indent << "UseMultithreading: " << this->UseMultithreading << endl;
 }
 
 //----------------------------------------------------------------------------
@@ -364,7 +480,19 @@ int vtkFlashContour::RequestData(vtkInformation* vtkNotUsed(request),
     }
   }
 
+  // Edges are identified by cell ids that are unique across blocks.
+  this->NumberOfCellsPerBlock = 0;
+  for (unsigned int blockId = 0; blockId < mbdsInput->GetNumberOfBlocks(); ++blockId)
+  {
+    vtkImageData* image = vtkImageData::SafeDownCast(mbdsInput->GetBlock(blockId));
+    if (image && image->GetNumberOfCells() > this->NumberOfCellsPerBlock)
+    {
+      this->NumberOfCellsPerBlock = image->GetNumberOfCells();
+    }
+  }
+
   // Find all roots and recurse on each.
+  std::vector<vtkFlashContourBlockOutput> leaves;
   int* levelPtr = this->GlobalLevelArray;
   for (int i = 0; i < this->NumberOfGlobalBlocks; ++i)
   {
@@ -413,9 +541,10 @@ int vtkFlashContour::RequestData(vtkInformation* vtkNotUsed(request),
       this->PropogateNeighbors(neighborhood, 0, 2, 2);
       this->PropogateNeighbors(neighborhood, 2, 2, 2);
 
-      this->RecurseTree(neighborhood, mbdsInput);
+      this->RecurseTree(neighborhood, mbdsInput, leaves);
     }
   }
+  this->ProcessBlocks(leaves, mbdsInput);
 
   this->Mesh->Delete();
   this->Points->Delete();
@@ -462,7 +591,8 @@ unsigned char vtkFlashContour::ComputeBranchDepth(int globalBlockId)
 }
 
 //----------------------------------------------------------------------------
-void vtkFlashContour::RecurseTree(int neighborhood[3][3][3], vtkMultiBlockDataSet* input)
+void vtkFlashContour::RecurseTree(int neighborhood[3][3][3], vtkMultiBlockDataSet* input,
+  std::vector<vtkFlashContourBlockOutput>& leaves)
 {
   int parent = neighborhood[1][1][1];
   int* children = this->GlobalChildrenArray + (parent << 3);
@@ -634,45 +764,179 @@ void vtkFlashContour::RecurseTree(int neighborhood[3][3][3], vtkMultiBlockDataSe
       {
         childNeighborhood[nx0][ny0][nz0] = neighborChildren[cx1 | cy1 | cz1]; // (7) 1 1 1
       }
-      this->RecurseTree(childNeighborhood, input);
+      this->RecurseTree(childNeighborhood, input, leaves);
     }
     return;
   }
 
   // Center of neighborhood is a leaf.
-  // Contour the block and the shared regions it owns.
+  // The block and the shared regions it owns are contoured by ProcessBlocks.
   int globalBlockId = neighborhood[1][1][1];
   vtkDataObject* block = input->GetBlock(this->GlobalToLocalMap[globalBlockId]);
   vtkImageData* image = vtkImageData::SafeDownCast(block);
   if (image)
   {
-    this->CurrentLevel = this->GlobalLevelArray[globalBlockId];
-    this->CurrentBlockId = globalBlockId;
+    leaves.push_back(vtkFlashContourBlockOutput());
+    vtkFlashContourBlockOutput& leaf = leaves.back();
+    memcpy(leaf.Neighborhood, neighborhood, sizeof(leaf.Neighborhood));
+    leaf.Image = image;
+    leaf.GlobalBlockId = globalBlockId;
+    leaf.Level = this->GlobalLevelArray[globalBlockId];
     // Recursively find the maximum depth of the children branches (not loaded).
-    this->RemainingDepth = this->ComputeBranchDepth(globalBlockId);
+    leaf.RemainingDepth = this->ComputeBranchDepth(globalBlockId);
+    leaf.Error = 0;
+  }
+}
+
+//----------------------------------------------------------------------------
+// Contours the leaf blocks, in parallel when UseMultithreading is on.  Each
+// leaf is contoured with point ids local to the leaf.  With MergePoints, the
+// points of the leaves are then merged by edge in the order of the tree
+// traversal.  Last, every leaf copies its points and triangles to the output
+// at offsets known from the previous leaves.
+void vtkFlashContour::ProcessBlocks(
+  std::vector<vtkFlashContourBlockOutput>& leaves, vtkMultiBlockDataSet* input)
+{
+  vtkIdType numLeaves = static_cast<vtkIdType>(leaves.size());
+  if (numLeaves == 0)
+  {
+    return;
+  }
+
+  vtkFlashContourProcessBlocks functor;
+  functor.Filter = this;
+  functor.Outputs = &leaves[0];
+  functor.Input = input;
+  functor.Pass = vtkFlashContourProcessBlocks::CONTOUR_BLOCKS;
+  functor.Cells = 0;
+  if (this->UseMultithreading && numLeaves > 1)
+  {
+    vtkSMPTools::For(0, numLeaves, 1, functor);
+  }
+  else
+  {
+    functor(0, numLeaves);
+  }
+
+  vtkFlashContourEdgeMap edgeMap;
+  vtkIdType numPts = 0;
+  vtkIdType numCells = 0;
+  for (vtkIdType ii = 0; ii < numLeaves; ++ii)
+  {
+    vtkFlashContourBlockOutput& leaf = leaves[ii];
+    if (leaf.Error)
+    {
+      vtkErrorMacro(<< leaf.Error);
+    }
+    vtkIdType numLocalPts = static_cast<vtkIdType>(leaf.Points.size() / 3);
+    leaf.PointIds.resize(numLocalPts);
+    leaf.PointOffset = numPts;
+    for (vtkIdType jj = 0; jj < numLocalPts; ++jj)
+    {
+      if (this->MergePoints)
+      {
+        std::pair<vtkFlashContourEdgeMap::iterator, bool> inserted =
+          edgeMap.insert(std::make_pair(leaf.Edges[jj], numPts));
+        if (!inserted.second)
+        { // A previous leaf already added this point.
+          leaf.PointIds[jj] = inserted.first->second;
+          continue;
+        }
+      }
+      leaf.PointIds[jj] = numPts++;
+      leaf.NewPoints.push_back(jj);
+    }
+    leaf.CellOffset = numCells;
+    numCells += static_cast<vtkIdType>(leaf.Triangles.size() / 3);
+  }
+
+  // Allocate the output so that leaves only have to set values.
+  this->Points->SetNumberOfPoints(numPts);
+  functor.Cells = this->Faces->WritePointer(numCells, 4 * numCells);
+  this->BlockIdCellArray->SetNumberOfTuples(numCells);
+  this->LevelCellArray->SetNumberOfTuples(numCells);
+  this->RemainingDepthCellArray->SetNumberOfTuples(numCells);
+  if (this->PassArray)
+  {
+    this->PassArray->SetNumberOfTuples(numPts);
+  }
+
+  functor.Pass = vtkFlashContourProcessBlocks::FILL_OUTPUT;
+  if (this->UseMultithreading && numLeaves > 1)
+  {
+    vtkSMPTools::For(0, numLeaves, 1, functor);
+  }
+  else
+  {
+    functor(0, numLeaves);
+  }
+}
 
-    this->ProcessBlock(image);
-    // Now lets process the regions shared with neighbors.
-    int r[3];
-    for (r[2] = 0; r[2] < 3; ++r[2])
+//----------------------------------------------------------------------------
+// Contours a leaf block and the regions it shares with its neighbors.  This
+// only reads the filter and the input, so leaves can be contoured in
+// parallel.
+void vtkFlashContour::ContourBlock(vtkFlashContourBlockOutput* leaf, vtkMultiBlockDataSet* input)
+{
+  this->ProcessBlock(leaf);
+  // Now lets process the regions shared with neighbors.
+  int r[3];
+  for (r[2] = 0; r[2] < 3; ++r[2])
+  {
+    for (r[1] = 0; r[1] < 3; ++r[1])
     {
-      for (r[1] = 0; r[1] < 3; ++r[1])
+      for (r[0] = 0; r[0] < 3; ++r[0])
       {
-        for (r[0] = 0; r[0] < 3; ++r[0])
+        if (r[0] != 1 || r[1] != 1 || r[2] != 1)
         {
-          if (r[0] != 1 || r[1] != 1 || r[2] != 1)
-          {
-            this->ProcessNeighborhoodSharedRegion(neighborhood, r, input);
-          }
+          this->ProcessNeighborhoodSharedRegion(leaf, leaf->Neighborhood, r, input);
         }
       }
     }
   }
+  // Points shared with other leaves are merged by ProcessBlocks.
+  vtkFlashContourEdgeMap().swap(leaf->EdgeMap);
+}
+
+//----------------------------------------------------------------------------
+// Copies the new points of a leaf and its triangles to the output.  Leaves
+// write to separate ranges of the arrays allocated by ProcessBlocks, so they
+// can be copied in parallel.
+void vtkFlashContour::FillBlockOutput(
+  vtkFlashContourBlockOutput* leaf, vtkFlashContourProcessBlocks* pass)
+{
+  vtkIdType numNewPts = static_cast<vtkIdType>(leaf->NewPoints.size());
+  for (vtkIdType ii = 0; ii < numNewPts; ++ii)
+  {
+    vtkIdType localId = leaf->NewPoints[ii];
+    vtkIdType outId = leaf->PointOffset + ii;
+    this->Points->SetPoint(outId, &leaf->Points[3 * localId]);
+    if (this->PassArray)
+    {
+      this->PassArray->SetValue(outId, leaf->PassValues[localId]);
+    }
+  }
+
+  vtkIdType* cells = pass->Cells + 4 * leaf->CellOffset;
+  vtkIdType cellId = leaf->CellOffset;
+  vtkIdType numTriangles = static_cast<vtkIdType>(leaf->Triangles.size() / 3);
+  for (vtkIdType ii = 0; ii < numTriangles; ++ii, ++cellId)
+  {
+    *cells++ = 3;
+    for (int jj = 0; jj < 3; ++jj)
+    {
+      *cells++ = leaf->PointIds[leaf->Triangles[3 * ii + jj]];
+    }
+    this->BlockIdCellArray->SetValue(cellId, leaf->GlobalBlockId);
+    this->LevelCellArray->SetValue(cellId, leaf->Level);
+    this->RemainingDepthCellArray->SetValue(cellId, leaf->RemainingDepth);
+  }
 }
 
 //----------------------------------------------------------------------------
-void vtkFlashContour::ProcessBlock(vtkImageData* image)
+void vtkFlashContour::ProcessBlock(vtkFlashContourBlockOutput* leaf)
 {
+  vtkImageData* image = leaf->Image;
   const double* spacing = image->GetSpacing();
   double blockOrigin[3];
   image->GetOrigin(blockOrigin);
@@ -688,11 +952,14 @@ void vtkFlashContour::ProcessBlock(vtkImageData* image)
   vtkDataArray* da = image->GetCellData()->GetArray(this->CellArrayNameToProcess);
   if (da->GetDataType() != VTK_DOUBLE)
   {
-    vtkErrorMacro("Expecting doubles");
+    leaf->Error = "Expecting doubles";
     return;
   }
   void* ptr = da->GetVoidPointer(0);
   double* dPtr = (double*)(ptr);
+  // Id of the first cell of the block, for merging points.
+  const double* dFirst = dPtr;
+  vtkTypeInt64 firstCellId = leaf->GlobalBlockId * this->NumberOfCellsPerBlock;
   // For passing / interpolating one double array.
   double* pPtr = 0;
   if (this->PassArray)
@@ -700,7 +967,7 @@ void vtkFlashContour::ProcessBlock(vtkImageData* image)
     da = image->GetCellData()->GetArray(this->PassAttribute);
     if (da->GetDataType() != VTK_DOUBLE)
     {
-      vtkErrorMacro("Expecting doubles");
+      leaf->Error = "Expecting doubles";
       return;
     }
     ptr = da->GetVoidPointer(0);
@@ -766,7 +1033,8 @@ void vtkFlashContour::ProcessBlock(vtkImageData* image)
 
         // I adding interpolation of attributes after the fact.
         // I need ids of the corner cells (dual points).
-        this->ProcessCell(origin, spacing, cornerValues, passValues);
+        this->ProcessCell(leaf, origin, spacing, cornerValues, passValues,
+          firstCellId + (dPtr - dFirst), cornerOffsets);
         ++dPtr;
         if (pPtr)
         {
@@ -797,7 +1065,7 @@ void vtkFlashContour::ProcessBlock(vtkImageData* image)
 
 //----------------------------------------------------------------------------
 // Assume the same level: easy.
-void vtkFlashContour::ProcessNeighborhoodSharedRegion(
+void vtkFlashContour::ProcessNeighborhoodSharedRegion(vtkFlashContourBlockOutput* leaf,
   int neighborhood[3][3][3], int r[3], vtkMultiBlockDataSet* input)
 {
   int regionDims[3];   // dual cell dimensions of region
@@ -808,6 +1076,10 @@ void vtkFlashContour::ProcessNeighborhoodSharedRegion(
   int levelDiff[8];    // level of corner relative to center block
   int incs[3];         // all blocks have the same increments
 
+  // First scalar and id of the first cell of each corner block.
+  double* bases[8];
+  vtkTypeInt64 blockCellIds[8];
+
   // Assumptions that all blocks have the same increments is only
   // to minimize the arguments to the ProcessSharedRegion method.
   int block1GlobalId = neighborhood[1][1][1];
@@ -854,7 +1126,7 @@ void vtkFlashContour::ProcessNeighborhoodSharedRegion(
         regionDims[i] = 1; // Collapse axis to get face/edge/corner region dimensions.
         break;
       default:
-        vtkErrorMacro("Bad neighbor index.");
+        leaf->Error = "Bad neighbor index.";
     }
   }
   // Note:  using index 1 and 2 (i.e. image1 and image2) is a bit confusing.
@@ -879,7 +1151,7 @@ void vtkFlashContour::ProcessNeighborhoodSharedRegion(
     // If the corner block has children then the children have priority for
     // ownership of this region and we should not process it.
     int* block2Children = this->GlobalChildrenArray + (block2GlobalId << 3);
-    if (this->GlobalToLocalMap[block2Children[0]] >= 0)
+    if (block2Children[0] >= 0 && this->GlobalToLocalMap[block2Children[0]] >= 0)
     {
       return;
     }
@@ -907,7 +1179,7 @@ void vtkFlashContour::ProcessNeighborhoodSharedRegion(
     int* dims2 = image2->GetDimensions();
     if (dims1[0] != dims2[0] || dims1[1] != dims2[1] || dims1[2] != dims2[2])
     {
-      vtkErrorMacro("Neighbor dimensions do not match.");
+      leaf->Error = "Neighbor dimensions do not match.";
       return;
     }
     // Origin of block that contains the corner.
@@ -956,10 +1228,12 @@ void vtkFlashContour::ProcessNeighborhoodSharedRegion(
     vtkDataArray* da = image2->GetCellData()->GetArray(this->CellArrayNameToProcess);
     if (da->GetDataType() != VTK_DOUBLE)
     {
-      vtkErrorMacro("Expecting doubles");
+      leaf->Error = "Expecting doubles";
       return;
     }
-    ptrs[cornerId] = (double*)(da->GetVoidPointer(0));
+    bases[cornerId] = (double*)(da->GetVoidPointer(0));
+    blockCellIds[cornerId] = block2GlobalId * this->NumberOfCellsPerBlock;
+    ptrs[cornerId] = bases[cornerId];
     // Move pointer to the correct position.
     ptrs[cornerId] +=
       incs[0] * dualPoint2Index[0] + incs[1] * dualPoint2Index[1] + incs[2] * dualPoint2Index[2];
@@ -969,7 +1243,7 @@ void vtkFlashContour::ProcessNeighborhoodSharedRegion(
       da = image2->GetCellData()->GetArray(this->PassAttribute);
       if (da->GetDataType() != VTK_DOUBLE)
       {
-        vtkErrorMacro("Expecting doubles");
+        leaf->Error = "Expecting doubles";
         return;
       }
       aptrs[cornerId] = (double*)(da->GetVoidPointer(0));
@@ -980,13 +1254,16 @@ void vtkFlashContour::ProcessNeighborhoodSharedRegion(
   }
   // Now that we have all of the information for the starting cell corners
   // Contour the region.
-  this->ProcessSharedRegion(regionDims, ptrs, incs, corners, spacings, levelDiff, aptrs);
+  this->ProcessSharedRegion(
+    leaf, regionDims, ptrs, incs, corners, spacings, levelDiff, aptrs, bases, blockCellIds);
 }
 
 //----------------------------------------------------------------------------
 // cornerPtr and cornerPoints get modified.
-void vtkFlashContour::ProcessSharedRegion(int regionDims[3], double* cornerPtrs[8], int incs[3],
-  double cornerPoints[32], double cornerSpacings[32], int cornerLevelDiffs[8], double* passPtrs[8])
+void vtkFlashContour::ProcessSharedRegion(vtkFlashContourBlockOutput* leaf, int regionDims[3],
+  double* cornerPtrs[8], int incs[3], double cornerPoints[32], double cornerSpacings[32],
+  int cornerLevelDiffs[8], double* passPtrs[8], double* cornerBases[8],
+  vtkTypeInt64 cornerBlockCellIds[8])
 {
   // Skip schedule for lower levels.
   // The 2's have not effect when levelDiff = 0.
@@ -1025,7 +1302,8 @@ void vtkFlashContour::ProcessSharedRegion(int regionDims[3], double* cornerPtrs[
       }
       for (int x = 0; x < regionDims[0]; ++x)
       {
-        this->ProcessDegenerateCell(cornerPointsX, cornerPtrsX, passPtrsX);
+        this->ProcessDegenerateCell(
+          leaf, cornerPointsX, cornerPtrsX, passPtrsX, cornerBases, cornerBlockCellIds);
         // Increment x corners
         for (int i = 0; i < 8; ++i)
         {
@@ -1080,8 +1358,9 @@ void vtkFlashContour::ProcessSharedRegion(int regionDims[3], double* cornerPtrs[
 }
 
 //----------------------------------------------------------------------------
-void vtkFlashContour::ProcessDegenerateCell(
-  double cornerPoints[32], double* cornerPtrs[8], double* passPtrs[8])
+void vtkFlashContour::ProcessDegenerateCell(vtkFlashContourBlockOutput* leaf,
+  double cornerPoints[32], double* cornerPtrs[8], double* passPtrs[8], double* cornerBases[8],
+  vtkTypeInt64 cornerBlockCellIds[8])
 {
   int cubeCase = 0;
   double cornerValues[8];
@@ -1150,12 +1429,22 @@ void vtkFlashContour::ProcessDegenerateCell(
     passValues[7] = *passPtrs[6];
   }
 
-  this->ProcessCellFinal(cornerPoints, cornerValues, cubeCase, passValues);
+  // Same order as the corner values.
+  static const int cornerOrder[8] = { 0, 1, 3, 2, 4, 5, 7, 6 };
+  vtkTypeInt64 cornerIds[8];
+  for (int c = 0; c < 8; ++c)
+  {
+    int i = cornerOrder[c];
+    cornerIds[c] = cornerBlockCellIds[i] + (cornerPtrs[i] - cornerBases[i]);
+  }
+
+  this->ProcessCellFinal(leaf, cornerPoints, cornerValues, cornerIds, cubeCase, passValues);
 }
 
 //----------------------------------------------------------------------------
-void vtkFlashContour::ProcessCell(
-  const double* origin, const double* spacing, const double* cornerValues, const double* passValues)
+void vtkFlashContour::ProcessCell(vtkFlashContourBlockOutput* leaf, const double* origin,
+  const double* spacing, const double* cornerValues, const double* passValues, vtkTypeInt64 cellId,
+  const int cornerOffsets[8])
 {
   int cubeCase = 0;
 
@@ -1215,13 +1504,21 @@ void vtkFlashContour::ProcessCell(
     cornerPoints[(c << 2) | 2] = origin[2] + spacing[2] * ((double)(pz));
   }
 
-  this->ProcessCellFinal(cornerPoints, cornerValues, cubeCase, passValues);
+  // Ids of the input cells at the corners, in the same order as the values.
+  vtkTypeInt64 cornerIds[8];
+  for (int c = 0; c < 8; ++c)
+  {
+    cornerIds[c] = cellId + cornerOffsets[c];
+  }
+
+  this->ProcessCellFinal(leaf, cornerPoints, cornerValues, cornerIds, cubeCase, passValues);
 }
 
 //----------------------------------------------------------------------------
 // It appears that cornerValues use VTK indexing scheme but
 // cornerPoints does not.
-void vtkFlashContour::ProcessCellFinal(const double cornerPoints[32], const double cornerValues[8],
+void vtkFlashContour::ProcessCellFinal(vtkFlashContourBlockOutput* leaf,
+  const double cornerPoints[32], const double cornerValues[8], const vtkTypeInt64 cornerIds[8],
   int cubeCase, const double passValues[8])
 {
   vtkIdType pointIds[6];
@@ -1239,14 +1536,27 @@ void vtkFlashContour::ProcessCellFinal(const double cornerPoints[32], const doub
   // loop over triangles
   while (*edge > -1)
   {
-    // I want to avoid adding degenerate triangles.
-    // Maybe the best way to do this is to have a point locator
-    // merge points first.
-    // Create brute force locator for a block, and resuse it.
-    // Only permanently keep locator for edges shared between two blocks.
+    // Points are merged by the input cells of their edge, first within
+    // the leaf, then across leaves by ProcessBlocks.
     for (int ii = 0; ii < 3; ++ii, ++edge) // insert triangle
     {
-      vtkIdType ptId = -1; // = this->BlockLocator->GetEdgePointer(x,y,z,*edge);
+      vtkIdType ptId = -1;
+      vtkIdType nextId = static_cast<vtkIdType>(leaf->Points.size() / 3);
+      if (this->MergePoints)
+      {
+        vtkFlashContourEdge key(cornerIds[vtkFlashIsoEdgeToVTKPointsTable[*edge][0]],
+          cornerIds[vtkFlashIsoEdgeToVTKPointsTable[*edge][1]]);
+        std::pair<vtkFlashContourEdgeMap::iterator, bool> inserted =
+          leaf->EdgeMap.insert(std::make_pair(key, nextId));
+        if (inserted.second)
+        {
+          leaf->Edges.push_back(key);
+        }
+        else
+        {
+          ptId = inserted.first->second;
+        }
+      }
 
       if (ptId == -1)
       {
@@ -1263,7 +1573,8 @@ void vtkFlashContour::ProcessCellFinal(const double cornerPoints[32], const doub
           cornerPoints[pt1Idx | 1] + k * (cornerPoints[pt2Idx | 1] - cornerPoints[pt1Idx | 1]);
         pt[2] =
           cornerPoints[pt1Idx | 2] + k * (cornerPoints[pt2Idx | 2] - cornerPoints[pt1Idx | 2]);
-        ptId = this->Points->InsertNextPoint(pt);
+        leaf->Points.insert(leaf->Points.end(), pt, pt + 3);
+        ptId = nextId;
 
         if (this->PassArray)
         {
@@ -1272,17 +1583,16 @@ void vtkFlashContour::ProcessCellFinal(const double cornerPoints[32], const doub
           p0 = passValues[vtkFlashIsoEdgeToVTKPointsTable[*edge][0]];
           p1 = passValues[vtkFlashIsoEdgeToVTKPointsTable[*edge][1]];
           double value = p0 + k * (p1 - p0);
-          this->PassArray->InsertNextValue(value);
+          leaf->PassValues.push_back(value);
         }
       }
       pointIds[ii] = ptId;
     }
+    // Points with different edges are not merged across leaves, so local
+    // ids are enough to find degenerate triangles.
     if (pointIds[0] != pointIds[1] && pointIds[0] != pointIds[2] && pointIds[1] != pointIds[2])
     {
-      this->Faces->InsertNextCell(3, pointIds);
-      this->BlockIdCellArray->InsertNextValue(this->CurrentBlockId);
-      this->LevelCellArray->InsertNextValue(this->CurrentLevel);
-      this->RemainingDepthCellArray->InsertNextValue(this->RemainingDepth);
+      leaf->Triangles.insert(leaf->Triangles.end(), pointIds, pointIds + 3);
     }
   }
 }
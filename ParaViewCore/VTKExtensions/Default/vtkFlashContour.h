@@ -18,6 +18,13 @@
  *
  * This filter takes a cell data array and generates a polydata
  * surface.
+ *
+ * The leaf blocks are contoured concurrently using vtkSMPTools when
+ * UseMultithreading is on.  With MergePoints, a contour point is identified
+ * by the two input cells of the dual edge it lies on, and points found by
+ * several dual cells or blocks are merged with a hash table.  Blocks are
+ * merged in the order of the block tree traversal, so the output does not
+ * depend on the number of threads.
 */
 
 #ifndef vtkFlashContour_h
@@ -25,6 +32,7 @@
 
 #include "vtkMultiBlockDataSetAlgorithm.h"
 #include "vtkPVVTKExtensionsDefaultModule.h" //needed for exports
+#include <vector>
 
 class vtkImageData;
 class vtkPoints;
@@ -33,6 +41,8 @@ class vtkUnsignedCharArray;
 class vtkPolyData;
 class vtkDoubleArray;
 class vtkIntArray;
+class vtkFlashContourBlockOutput;
+class vtkFlashContourProcessBlocks;
 
 class VTKPVVTKEXTENSIONSDEFAULT_EXPORT vtkFlashContour : public vtkMultiBlockDataSetAlgorithm
 {
@@ -47,6 +57,26 @@ public:
   vtkSetStringMacro(PassAttribute);
   vtkGetStringMacro(PassAttribute);
 
+  //@{
+  /**
+   * When on, points shared by triangles, in the same block or in neighboring
+   * blocks, are merged. Default is on.
+   */
+  vtkSetMacro(MergePoints, bool);
+  vtkGetMacro(MergePoints, bool);
+  vtkBooleanMacro(MergePoints, bool);
+  //@}
+
+  //@{
+  /**
+   * When on, the blocks are contoured by multiple threads. The output is the
+   * same either way. Default is on.
+   */
+  vtkSetMacro(UseMultithreading, bool);
+  vtkGetMacro(UseMultithreading, bool);
+  vtkBooleanMacro(UseMultithreading, bool);
+  //@}
+
 protected:
   vtkFlashContour();
   ~vtkFlashContour() override;
@@ -54,17 +84,16 @@ protected:
   double IsoValue;
   char* PassAttribute;
   vtkDoubleArray* PassArray;
+  bool MergePoints;
+  bool UseMultithreading;
 
   // Just for debugging.
   vtkIntArray* BlockIdCellArray;
-  int CurrentBlockId;
   // A couple cell arrays to help determine where I should refine.
   vtkUnsignedCharArray* LevelCellArray;
-  unsigned char CurrentLevel;
   // Instead of maximum depth, compute the different between the
   // maximum depth and the current depth.
   vtkUnsignedCharArray* RemainingDepthCellArray;
-  unsigned char RemainingDepth;
   unsigned char ComputeBranchDepth(int globalBlockId);
 
   vtkPoints* Points;
@@ -85,23 +114,39 @@ protected:
   int* GlobalChildrenArray;
   int* GlobalNeighborArray;
   int* GlobalToLocalMap;
-
-  void RecurseTree(int neighborhood[3][3][3], vtkMultiBlockDataSet* input);
-  void ProcessBlock(vtkImageData* block);
-  void ProcessCell(const double* origin, const double* spacing, const double* cornerValues,
-    const double* passValues);
-  void ProcessNeighborhoodSharedRegion(
+  // Used to give cells of different blocks different ids.
+  vtkTypeInt64 NumberOfCellsPerBlock;
+
+  // Collects the leaf blocks in traversal order.
+  void RecurseTree(int neighborhood[3][3][3], vtkMultiBlockDataSet* input,
+    std::vector<vtkFlashContourBlockOutput>& leaves);
+  // Contour the leaves, possibly in parallel, and merge them into the output.
+  void ProcessBlocks(std::vector<vtkFlashContourBlockOutput>& leaves, vtkMultiBlockDataSet* input);
+  void ContourBlock(vtkFlashContourBlockOutput* leaf, vtkMultiBlockDataSet* input);
+  void FillBlockOutput(vtkFlashContourBlockOutput* leaf, vtkFlashContourProcessBlocks* pass);
+
+  void ProcessBlock(vtkFlashContourBlockOutput* leaf);
+  void ProcessCell(vtkFlashContourBlockOutput* leaf, const double* origin, const double* spacing,
+    const double* cornerValues, const double* passValues, vtkTypeInt64 cellId,
+    const int cornerOffsets[8]);
+  void ProcessNeighborhoodSharedRegion(vtkFlashContourBlockOutput* leaf,
     int neighborhood[3][3][3], int r[3], vtkMultiBlockDataSet* input);
-  void ProcessSharedRegion(int regionDims[3], double* cornerPtrs[8], int incs[3],
-    double cornerPoints[32], double cornerSpacings[32], int cornerLevelDiffs[8],
-    double* passPtrs[8]);
-  void ProcessDegenerateCell(double cornerPoints[32], double* cornerPtrs[8], double* passPtrs[8]);
-  void ProcessCellFinal(const double cornerPoints[32], const double cornerValues[8], int cubeCase,
+  void ProcessSharedRegion(vtkFlashContourBlockOutput* leaf, int regionDims[3],
+    double* cornerPtrs[8], int incs[3], double cornerPoints[32], double cornerSpacings[32],
+    int cornerLevelDiffs[8], double* passPtrs[8], double* cornerBases[8],
+    vtkTypeInt64 cornerBlockCellIds[8]);
+  void ProcessDegenerateCell(vtkFlashContourBlockOutput* leaf, double cornerPoints[32],
+    double* cornerPtrs[8], double* passPtrs[8], double* cornerBases[8],
+    vtkTypeInt64 cornerBlockCellIds[8]);
+  void ProcessCellFinal(vtkFlashContourBlockOutput* leaf, const double cornerPoints[32],
+    const double cornerValues[8], const vtkTypeInt64 cornerIds[8], int cubeCase,
     const double passValues[8]);
 
 private:
   vtkFlashContour(const vtkFlashContour&) = delete;
   void operator=(const vtkFlashContour&) = delete;
+
+  friend class vtkFlashContourProcessBlocks;
 };
 
 #endif
@@ -640,7 +640,7 @@ void vtkGridConnectivityExecuteProcess(vtkGridConnectivity* self, vtkUnstructure
         }
         // I do not think that the equivalence set has a more up to date id,
         // but it cannot hurt to check/
-        minFragmentId = equivalenceSet->GetEquivalentSetId(minFragmentId);
+        minFragmentId = static_cast<int>(equivalenceSet->GetEquivalentSetId(minFragmentId));
         // Label the faces with the fragment id we computed.
         for (int kk = 0; kk < numNewFaces; ++kk)
         {
@@ -1252,7 +1252,7 @@ void vtkGridConnectivity::CollectFacesAndArraysToRootProcess(
     // Build up a map to make each processes fragment
     int numProcs = this->Controller->GetNumberOfProcesses();
     fragmentIdMap[0] = 0;
-    fragmentIdMap[1] = this->EquivalenceSet->GetNumberOfMembers();
+    fragmentIdMap[1] = static_cast<int>(this->EquivalenceSet->GetNumberOfMembers());
     fragmentNumFaces[0] = 0;
     for (int procIdx = 1; procIdx < numProcs; ++procIdx)
     { // loop over every process.
@@ -1552,12 +1552,12 @@ void vtkGridConnectivity::ResolveIntegrationArrays()
   }
 
   vtkDoubleArray* newVolumes = vtkDoubleArray::New();
-  int numSets = this->EquivalenceSet->GetNumberOfResolvedSets();
+  vtkIdType numSets = this->EquivalenceSet->GetNumberOfResolvedSets();
   newVolumes->SetNumberOfTuples(numSets);
   // Initialize all values to 0 to start sumation.
   memset(newVolumes->GetPointer(0), 0, numSets * sizeof(double));
   // Loop over all the partial fragments summing volumes.
-  int numMembers = this->EquivalenceSet->GetNumberOfMembers();
+  vtkIdType numMembers = this->EquivalenceSet->GetNumberOfMembers();
   if (this->FragmentVolumes->GetNumberOfTuples() < numMembers)
   {
     vtkErrorMacro("More partial fragments than volume entries.");
@@ -1565,9 +1565,9 @@ void vtkGridConnectivity::ResolveIntegrationArrays()
   }
   double* partialVolumePtr = this->FragmentVolumes->GetPointer(0);
   double* finalVolumePtr = newVolumes->GetPointer(0);
-  for (int ii = 0; ii < numMembers; ++ii)
+  for (vtkIdType ii = 0; ii < numMembers; ++ii)
   {
-    int setId = this->EquivalenceSet->GetEquivalentSetId(ii);
+    vtkIdType setId = this->EquivalenceSet->GetEquivalentSetId(ii);
     finalVolumePtr[setId] += *partialVolumePtr;
     // update to the next fragment volume
     ++partialVolumePtr;
@@ -1584,9 +1584,9 @@ void vtkGridConnectivity::ResolveIntegrationArrays()
   for (int j = 0; j < numArrays; ++j)
   {
     vtkDoubleArray* da = this->CellAttributesIntegration[j];
-    for (int i = 0; i < da->GetNumberOfTuples(); ++i)
+    for (vtkIdType i = 0; i < da->GetNumberOfTuples(); ++i)
     {
-      int setId = this->EquivalenceSet->GetEquivalentSetId(i);
+      vtkIdType setId = this->EquivalenceSet->GetEquivalentSetId(i);
       if (i != setId)
       {
         double* oldIntegrationPtr = da->GetPointer(i);
@@ -1603,9 +1603,9 @@ void vtkGridConnectivity::ResolveIntegrationArrays()
   for (int j = 0; j < numArrays; ++j)
   {
     vtkDoubleArray* da = this->PointAttributesIntegration[j];
-    for (int i = 0; i < da->GetNumberOfTuples(); ++i)
+    for (vtkIdType i = 0; i < da->GetNumberOfTuples(); ++i)
     {
-      int setId = this->EquivalenceSet->GetEquivalentSetId(i);
+      vtkIdType setId = this->EquivalenceSet->GetEquivalentSetId(i);
       if (i != setId)
       {
         for (int k = 0; k < da->GetNumberOfComponents(); ++k)
@@ -1633,7 +1633,8 @@ void vtkGridConnectivity::ResolveFaceFragmentIds()
   this->FaceHash->InitTraversal();
   while ((face = this->FaceHash->GetNextFace()))
   {
-    face->FragmentId = this->EquivalenceSet->GetEquivalentSetId(face->FragmentId);
+    face->FragmentId =
+      static_cast<int>(this->EquivalenceSet->GetEquivalentSetId(face->FragmentId));
   }
 }
 
@@ -87,6 +87,7 @@ using std::string;
 
 // for paraview cliping
 #include "vtkPlane.h"
+#include "vtkSMPTools.h"
 #include "vtkSphere.h"
 
 class InitializeVolumeFractrionArray;
@@ -541,6 +542,8 @@ public:
   int* GetBaseFragmentIdPointer();
   int GetBaseFlatIndex();
   int* GetFragmentIdPointer() { return this->FragmentIds; }
+  // Add an offset to the ids of the labeled cells.
+  void OffsetFragmentIds(int offset);
   int GetLevel() { return this->Level; }
   double* GetSpacing() { return this->Spacing; }
   double* GetOrigin() { return this->Origin; }
@@ -1129,6 +1132,20 @@ int vtkMaterialInterfaceFilterBlock::GetBaseFlatIndex()
   return idx;
 }
 //----------------------------------------------------------------------------
+void vtkMaterialInterfaceFilterBlock::OffsetFragmentIds(int offset)
+{
+  int numCells = (this->CellExtent[1] - this->CellExtent[0] + 1) *
+    (this->CellExtent[3] - this->CellExtent[2] + 1) *
+    (this->CellExtent[5] - this->CellExtent[4] + 1);
+  for (int ii = 0; ii < numCells; ++ii)
+  {
+    if (this->FragmentIds[ii] != -1)
+    {
+      this->FragmentIds[ii] += offset;
+    }
+  }
+}
+//----------------------------------------------------------------------------
 void vtkMaterialInterfaceFilterBlock::ExtractExtent(unsigned char* buf, int ext[6])
 {
   // Initialize the buffer to 0.
@@ -1538,6 +1555,141 @@ int vtkMaterialInterfaceFilterRingBuffer::Pop(vtkMaterialInterfaceFilterIterator
   return 1;
 }
 
+//============================================================================
+// Fragments found by ProcessBlock, numbered from 0, until they are added to
+// the fragments of the filter. When labeling with multiple threads there is
+// one for each input block so that fragment ids are assigned in block order,
+// whatever the order in which threads finish.
+class vtkMaterialInterfaceFilterBlockFragments
+{
+public:
+  vtkMaterialInterfaceFilterBlockFragments() { this->FirstFragmentId = 0; }
+
+  // Local id of the first fragment, once added to the filter.
+  int FirstFragmentId;
+  // The surface of each fragment.
+  vector<vtkPolyData*> Meshes;
+  // The integrated attributes of each fragment, in the order they are
+  // saved by vtkMaterialInterfaceFilterLabeling::SaveAccumulators().
+  vector<double> Values;
+  // Pairs of iterators (a voxel of the block, its neighbor in another block)
+  // connected across the boundary of the block.
+  vector<vtkMaterialInterfaceFilterIterator> Connections;
+};
+
+//============================================================================
+// The state of a connectivity search: the queue, accumulators for the current
+// fragment and the ivars for computing the points of a face. Each thread
+// has its own.
+// How neighbors are connected depends on Block and CurrentFragmentMesh:
+// * No Block: the search floods across blocks.
+// * Block and CurrentFragmentMesh: the search floods the voxels of Block
+//   only, other blocks may be labeled by other threads at the same time.
+// * Block without CurrentFragmentMesh: Block has been labeled, neighbors in
+//   other blocks are saved in Fragments->Connections.
+class vtkMaterialInterfaceFilterLabeling
+{
+public:
+  vtkMaterialInterfaceFilterLabeling();
+
+  // Clear the accumulators before searching a new fragment.
+  void ClearAccumulators();
+  // Save the accumulators of the current fragment in Fragments->Values.
+  void SaveAccumulators();
+
+  vtkMaterialInterfaceFilterBlock* Block;
+  vtkMaterialInterfaceFilterBlockFragments* Fragments;
+  // Id of the current fragment, in Fragments.
+  int FragmentId;
+  // The surface of the current fragment.
+  vtkPolyData* CurrentFragmentMesh;
+  // Voxels to search.
+  vtkMaterialInterfaceFilterRingBuffer Queue;
+
+  // Which accumulators are saved.
+  bool ClipWithPlane;
+  bool ComputeMoments;
+  // Accumulators of the current fragment, see the arrays indexed by fragment
+  // id in vtkMaterialInterfaceFilter.
+  double FragmentVolume;
+  double ClipDepthMin;
+  double ClipDepthMax;
+  vector<double> FragmentMoment; // =(Myz, Mxz, Mxy, m)
+  vector<vector<double> > FragmentVolumeWtdAvg;
+  vector<vector<double> > FragmentMassWtdAvg;
+  vector<vector<double> > FragmentSum;
+
+  // Ivars for computing the point on corners and edges of a face.
+  vtkMaterialInterfaceFilterIterator FaceNeighbors[32];
+  double FaceCornerPoints[12];
+  double FaceEdgePoints[12];
+  int FaceEdgeFlags[4];
+};
+
+//----------------------------------------------------------------------------
+vtkMaterialInterfaceFilterLabeling::vtkMaterialInterfaceFilterLabeling()
+{
+  this->Block = 0;
+  this->Fragments = 0;
+  this->FragmentId = 0;
+  this->CurrentFragmentMesh = 0;
+  this->ClipWithPlane = false;
+  this->ComputeMoments = false;
+  this->FragmentMoment.resize(4, 0.0);
+  this->ClearAccumulators();
+}
+
+//----------------------------------------------------------------------------
+void vtkMaterialInterfaceFilterLabeling::ClearAccumulators()
+{
+  this->FragmentVolume = 0.0;
+  this->ClipDepthMax = 0.0;
+  this->ClipDepthMin = VTK_FLOAT_MAX;
+  FillVector(this->FragmentMoment, 0.0);
+  for (size_t i = 0; i < this->FragmentVolumeWtdAvg.size(); ++i)
+  {
+    FillVector(this->FragmentVolumeWtdAvg[i], 0.0);
+  }
+  for (size_t i = 0; i < this->FragmentMassWtdAvg.size(); ++i)
+  {
+    FillVector(this->FragmentMassWtdAvg[i], 0.0);
+  }
+  for (size_t i = 0; i < this->FragmentSum.size(); ++i)
+  {
+    FillVector(this->FragmentSum[i], 0.0);
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkMaterialInterfaceFilterLabeling::SaveAccumulators()
+{
+  vector<double>& values = this->Fragments->Values;
+  values.push_back(this->FragmentVolume);
+  if (this->ClipWithPlane)
+  {
+    values.push_back(this->ClipDepthMax);
+    values.push_back(this->ClipDepthMin);
+  }
+  if (this->ComputeMoments)
+  {
+    values.insert(values.end(), this->FragmentMoment.begin(), this->FragmentMoment.end());
+  }
+  for (size_t i = 0; i < this->FragmentVolumeWtdAvg.size(); ++i)
+  {
+    values.insert(
+      values.end(), this->FragmentVolumeWtdAvg[i].begin(), this->FragmentVolumeWtdAvg[i].end());
+  }
+  for (size_t i = 0; i < this->FragmentMassWtdAvg.size(); ++i)
+  {
+    values.insert(
+      values.end(), this->FragmentMassWtdAvg[i].begin(), this->FragmentMassWtdAvg[i].end());
+  }
+  for (size_t i = 0; i < this->FragmentSum.size(); ++i)
+  {
+    values.insert(values.end(), this->FragmentSum[i].begin(), this->FragmentSum[i].end());
+  }
+}
+
 //============================================================================
 
 //----------------------------------------------------------------------------
@@ -1608,17 +1760,13 @@ vtkMaterialInterfaceFilter::vtkMaterialInterfaceFilter()
   this->RootSpacing[0] = this->RootSpacing[1] = this->RootSpacing[2] = 1.0;
 
   this->FragmentId = 0;
-  this->FragmentVolume = 0.0;
   this->FragmentVolumes = 0;
-  this->FragmentMoment.resize(4, 0.0);
   this->FragmentMoments = 0;
   this->FragmentAABBCenters = 0;
   this->FragmentOBBs = 0;
   this->FragmentSplitGeometry = 0;
 
   // Keep depth of crater along clip plane normal.
-  this->ClipDepthMax = 0.0;
-  this->ClipDepthMin = VTK_FLOAT_MAX;
   this->ClipDepthMaximums = 0;
   this->ClipDepthMinimums = 0;
 
@@ -1633,10 +1781,6 @@ vtkMaterialInterfaceFilter::vtkMaterialInterfaceFilter()
   this->ResolvedFragmentCenters = 0;
   this->ResolvedFragmentOBBs = 0;
 
-  this->FaceNeighbors = new vtkMaterialInterfaceFilterIterator[32];
-
-  this->CurrentFragmentMesh = 0;
-
   this->NVolumeWtdAvgs = 0;
   this->NToSum = 0;
   this->ComputeMoments = false;
@@ -1668,6 +1812,8 @@ vtkMaterialInterfaceFilter::vtkMaterialInterfaceFilter()
 
   // 1 Layer of ghost cell by block by default
   this->BlockGhostLevel = 1;
+
+  this->UseMultithreading = true;
 }
 
 //----------------------------------------------------------------------------
@@ -1679,9 +1825,6 @@ vtkMaterialInterfaceFilter::~vtkMaterialInterfaceFilter()
   this->RootSpacing[0] = this->RootSpacing[1] = this->RootSpacing[2] = 1.0;
 
   this->FragmentId = 0;
-  this->FragmentVolume = 0.0;
-  this->ClipDepthMax = 0.0;
-  this->ClipDepthMin = VTK_FLOAT_MAX;
 
   this->SetClipFunction(0);
 
@@ -1699,9 +1842,6 @@ vtkMaterialInterfaceFilter::~vtkMaterialInterfaceFilter()
   delete this->EquivalenceSet;
   this->EquivalenceSet = 0;
 
-  delete[] this->FaceNeighbors;
-  this->FaceNeighbors = 0;
-
   // clean up PV interface
   this->MaterialArraySelection->RemoveObserver(this->SelectionObserver);
   this->MaterialArraySelection->Delete();
@@ -3229,14 +3369,11 @@ void vtkMaterialInterfaceFilter::PrepareForPass(vtkNonOverlappingAMR* hbdsInput,
 {
   this->FragmentId = 0;
 
-  this->FragmentVolume = 0.0;
   ReNewVtkPointer(this->FragmentVolumes);
   this->FragmentVolumes->SetName("Volume");
 
   if (this->ClipWithPlane)
   {
-    this->ClipDepthMax = 0.0;
-    this->ClipDepthMin = VTK_FLOAT_MAX;
     ReNewVtkPointer(this->ClipDepthMaximums);
     ReNewVtkPointer(this->ClipDepthMinimums);
     this->ClipDepthMaximums->SetName("ClipDepthMax");
@@ -3245,8 +3382,6 @@ void vtkMaterialInterfaceFilter::PrepareForPass(vtkNonOverlappingAMR* hbdsInput,
 
   if (this->ComputeMoments)
   {
-    this->FragmentMoment.clear();
-    this->FragmentMoment.resize(4, 0.0);
     ReNewVtkPointer(this->FragmentMoments);
     this->FragmentMoments->SetNumberOfComponents(4);
     this->FragmentMoments->SetName("Moments");
@@ -3284,11 +3419,9 @@ void vtkMaterialInterfaceFilter::PrepareForPass(vtkNonOverlappingAMR* hbdsInput,
   // Configure data structures
   // 1) Volume weighted average of attribute over the
   // fragment set up containers
-  this->FragmentVolumeWtdAvg.clear();
-  this->FragmentVolumeWtdAvg.resize(this->NVolumeWtdAvgs);
   ClearVectorOfVtkPointers(this->FragmentVolumeWtdAvgs);
   this->FragmentVolumeWtdAvgs.resize(this->NVolumeWtdAvgs);
-  // set up data array and accumulator for each weighted average
+  // set up data array for each weighted average
   for (int j = 0; j < this->NVolumeWtdAvgs; ++j)
   {
     // data array
@@ -3307,16 +3440,12 @@ void vtkMaterialInterfaceFilter::PrepareForPass(vtkNonOverlappingAMR* hbdsInput,
     ostringstream osIntegratedArrayName;
     osIntegratedArrayName << "VolumeWeightedAverage-" << thisArrayName;
     this->FragmentVolumeWtdAvgs[j]->SetName(osIntegratedArrayName.str().c_str());
-    // accumulator
-    this->FragmentVolumeWtdAvg[j].resize(nComp, 0.0);
   }
   // 2) Mass weighted average of attribute over the fragment
   // set up containers
-  this->FragmentMassWtdAvg.clear();
-  this->FragmentMassWtdAvg.resize(this->NMassWtdAvgs);
   ClearVectorOfVtkPointers(this->FragmentMassWtdAvgs);
   this->FragmentMassWtdAvgs.resize(this->NMassWtdAvgs);
-  // set up data array and accumulator for each weighted average
+  // set up data array for each weighted average
   for (int j = 0; j < this->NMassWtdAvgs; ++j)
   {
     // data array
@@ -3335,16 +3464,12 @@ void vtkMaterialInterfaceFilter::PrepareForPass(vtkNonOverlappingAMR* hbdsInput,
     ostringstream osIntegratedArrayName;
     osIntegratedArrayName << "MassWeightedAverage-" << thisArrayName;
     this->FragmentMassWtdAvgs[j]->SetName(osIntegratedArrayName.str().c_str());
-    // accumulator
-    this->FragmentMassWtdAvg[j].resize(nComp, 0.0);
   }
   // 3) Summation of attribute over the fragment
   // set up containers
-  this->FragmentSum.clear();
-  this->FragmentSum.resize(this->NToSum);
   ClearVectorOfVtkPointers(this->FragmentSums);
   this->FragmentSums.resize(this->NToSum);
-  // set up data array and accumulator for each weighted average
+  // set up data array for each sum
   for (int j = 0; j < this->NToSum; ++j)
   {
     // data array
@@ -3363,8 +3488,6 @@ void vtkMaterialInterfaceFilter::PrepareForPass(vtkNonOverlappingAMR* hbdsInput,
     ostringstream osIntegratedArrayName;
     osIntegratedArrayName << "Summation-" << thisArrayName;
     this->FragmentSums[j]->SetName(osIntegratedArrayName.str().c_str());
-    // accumulator
-    this->FragmentSum[j].resize(nComp, 0.0);
   }
 
   // 4) Unique list of integrated attributes
@@ -3592,12 +3715,8 @@ int vtkMaterialInterfaceFilter::RequestData(vtkInformation* vtkNotUsed(request),
     // Lets profile to see what takes the most time for large number of processes.
     this->ProcessBlocksTimer->StartTimer();
 #endif
-    int blockId;
-    for (blockId = 0; blockId < this->NumberOfInputBlocks; ++blockId)
-    {
-      // build fragments
-      this->ProcessBlock(blockId);
-    }
+    // build fragments
+    this->ProcessBlocks();
 #ifdef vtkMaterialInterfaceFilterPROFILE
     // Lets profile to see what takes the most time for large number of processes.
     this->ProcessBlocksTimer->StopTimer();
@@ -3741,17 +3860,152 @@ int vtkMaterialInterfaceFilter::RequestData(vtkInformation* vtkNotUsed(request),
 }
 
 //----------------------------------------------------------------------------
-int vtkMaterialInterfaceFilter::ProcessBlock(int blockId)
+// Set up a labeling for the current material and its attributes.
+void vtkMaterialInterfaceFilter::InitializeLabeling(vtkMaterialInterfaceFilterLabeling* labeling)
+{
+  labeling->ClipWithPlane = this->ClipWithPlane != 0;
+  labeling->ComputeMoments = this->ComputeMoments;
+  labeling->FragmentVolumeWtdAvg.resize(this->NVolumeWtdAvgs);
+  for (int i = 0; i < this->NVolumeWtdAvgs; ++i)
+  {
+    labeling->FragmentVolumeWtdAvg[i].resize(
+      this->FragmentVolumeWtdAvgs[i]->GetNumberOfComponents());
+  }
+  labeling->FragmentMassWtdAvg.resize(this->NMassWtdAvgs);
+  for (int i = 0; i < this->NMassWtdAvgs; ++i)
+  {
+    labeling->FragmentMassWtdAvg[i].resize(this->FragmentMassWtdAvgs[i]->GetNumberOfComponents());
+  }
+  labeling->FragmentSum.resize(this->NToSum);
+  for (int i = 0; i < this->NToSum; ++i)
+  {
+    labeling->FragmentSum[i].resize(this->FragmentSums[i]->GetNumberOfComponents());
+  }
+  labeling->ClearAccumulators();
+}
+
+//============================================================================
+// Runs one pass of the multithreaded search over a range of input blocks.
+// Each range has its own labeling.
+class vtkMaterialInterfaceFilterProcessBlocks
+{
+public:
+  enum
+  {
+    LABEL_BLOCKS,
+    OFFSET_FRAGMENT_IDS,
+    CONNECT_BLOCK_BOUNDARIES
+  };
+
+  vtkMaterialInterfaceFilter* Filter;
+  vector<vtkMaterialInterfaceFilterBlockFragments>* Fragments;
+  int Pass;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkMaterialInterfaceFilterLabeling labeling;
+    this->Filter->InitializeLabeling(&labeling);
+    for (vtkIdType blockId = begin; blockId < end; ++blockId)
+    {
+      vtkMaterialInterfaceFilterBlock* block = this->Filter->InputBlocks[blockId];
+      if (block == 0)
+      {
+        continue;
+      }
+      labeling.Block = block;
+      labeling.Fragments = &(*this->Fragments)[blockId];
+      switch (this->Pass)
+      {
+        case LABEL_BLOCKS:
+          labeling.FragmentId = 0;
+          this->Filter->ProcessBlock(&labeling, static_cast<int>(blockId));
+          break;
+        case OFFSET_FRAGMENT_IDS:
+          if (labeling.Fragments->FirstFragmentId != 0)
+          {
+            block->OffsetFragmentIds(labeling.Fragments->FirstFragmentId);
+          }
+          break;
+        case CONNECT_BLOCK_BOUNDARIES:
+          this->Filter->ConnectBlockBoundary(&labeling, static_cast<int>(blockId));
+          break;
+      }
+    }
+  }
+};
+
+//----------------------------------------------------------------------------
+// Find the fragments of the input blocks, their surfaces and integrated
+// attributes, and the equivalences between fragments found in different
+// blocks. When multithreaded, each block is labeled independently with ids
+// local to the block. The fragments are then numbered in block order, which
+// is the order the serial search finds them, and the connections across
+// block boundaries are turned into equivalences.
+void vtkMaterialInterfaceFilter::ProcessBlocks()
 {
 #ifdef vtkMaterialInterfaceFilterDEBUG
   ostringstream progressMesg;
-  progressMesg << "vtkMaterialInterfaceFilter::ProcessBlock(" << blockId << ") , Material "
-               << this->MaterialId;
+  progressMesg << "vtkMaterialInterfaceFilter::ProcessBlocks(), Material " << this->MaterialId;
   this->SetProgressText(progressMesg.str().c_str());
 #endif
-  this->Progress += this->ProgressBlockInc;
-  this->UpdateProgress(this->Progress);
 
+  if (!this->UseMultithreading || this->NumberOfInputBlocks < 2)
+  {
+    vtkMaterialInterfaceFilterBlockFragments fragments;
+    vtkMaterialInterfaceFilterLabeling labeling;
+    this->InitializeLabeling(&labeling);
+    labeling.Fragments = &fragments;
+    for (int blockId = 0; blockId < this->NumberOfInputBlocks; ++blockId)
+    {
+      this->ProcessBlock(&labeling, blockId);
+      this->Progress += this->ProgressBlockInc;
+      this->UpdateProgress(this->Progress);
+    }
+    this->AddBlockFragments(&fragments);
+  }
+  else
+  {
+    vector<vtkMaterialInterfaceFilterBlockFragments> fragments(this->NumberOfInputBlocks);
+    vtkMaterialInterfaceFilterProcessBlocks functor;
+    functor.Filter = this;
+    functor.Fragments = &fragments;
+    functor.Pass = vtkMaterialInterfaceFilterProcessBlocks::LABEL_BLOCKS;
+    vtkSMPTools::For(0, this->NumberOfInputBlocks, functor);
+    this->Progress += this->ProgressBlockInc * this->NumberOfInputBlocks;
+    this->UpdateProgress(this->Progress);
+
+    for (int blockId = 0; blockId < this->NumberOfInputBlocks; ++blockId)
+    {
+      this->AddBlockFragments(&fragments[blockId]);
+    }
+    functor.Pass = vtkMaterialInterfaceFilterProcessBlocks::OFFSET_FRAGMENT_IDS;
+    vtkSMPTools::For(0, this->NumberOfInputBlocks, functor);
+    functor.Pass = vtkMaterialInterfaceFilterProcessBlocks::CONNECT_BLOCK_BOUNDARIES;
+    vtkSMPTools::For(0, this->NumberOfInputBlocks, functor);
+
+    // The equivalence set and the ghost blocks are shared, merge the
+    // connections in block order.
+    vtkMaterialInterfaceFilterLabeling labeling;
+    this->InitializeLabeling(&labeling);
+    for (int blockId = 0; blockId < this->NumberOfInputBlocks; ++blockId)
+    {
+      this->ConnectBlockNeighbors(&labeling, &fragments[blockId]);
+    }
+  }
+
+  // Every local fragment must be a member of the equivalence set.
+  if (this->FragmentId > 0)
+  {
+    this->EquivalenceSet->AddEquivalence(this->FragmentId - 1, this->FragmentId - 1);
+  }
+}
+
+//----------------------------------------------------------------------------
+// Search the voxels of a block for new fragments. The fragments found are
+// saved in labeling->Fragments.
+int vtkMaterialInterfaceFilter::ProcessBlock(
+  vtkMaterialInterfaceFilterLabeling* labeling, int blockId)
+{
   vtkMaterialInterfaceFilterBlock* block = this->InputBlocks[blockId];
   if (block == 0)
   {
@@ -3767,8 +4021,6 @@ int vtkMaterialInterfaceFilter::ProcessBlock(int blockId)
   zIterator->FragmentIdPointer = block->GetBaseFragmentIdPointer();
   zIterator->FlatIndex = block->GetBaseFlatIndex();
 
-  vtkMaterialInterfaceFilterRingBuffer* queue = new vtkMaterialInterfaceFilterRingBuffer;
-
   // Loop through all the voxels.
   int ix, iy, iz;
   const int* ext;
@@ -3791,65 +4043,24 @@ int vtkMaterialInterfaceFilter::ProcessBlock(int blockId)
         if (*(xIterator->FragmentIdPointer) == -1 &&
           *(xIterator->VolumeFractionPointer) > this->scaledMaterialFractionThreshold)
         { // We have a new fragment.
-          this->CurrentFragmentMesh = this->NewFragmentMesh();
-          this->EquivalenceSet->AddEquivalence(this->FragmentId, this->FragmentId);
+          labeling->CurrentFragmentMesh = this->NewFragmentMesh();
           // We have to mark every voxel we push on the queue.
-          *(xIterator->FragmentIdPointer) = this->FragmentId;
+          *(xIterator->FragmentIdPointer) = labeling->FragmentId;
           // There should be no need to clear the queue.
-          queue->Push(xIterator);
-          this->ConnectFragment(queue);
+          labeling->Queue.Push(xIterator);
+          this->ConnectFragment(labeling);
           // save the current fragment mesh
           // the id is implicit given by its position in the vector, but only
           // until fragments are resolved. After resolution we add addributes such
           // as id, volume, summations averages, etc..
-          this->CurrentFragmentMesh->Squeeze();
-          this->FragmentMeshes.push_back(this->CurrentFragmentMesh);
-          // Save the volume from the last fragment.
-          this->FragmentVolumes->InsertTuple1(this->FragmentId, this->FragmentVolume);
-          if (this->ClipWithPlane)
-          {
-            this->ClipDepthMaximums->InsertTuple1(this->FragmentId, this->ClipDepthMax);
-            this->ClipDepthMinimums->InsertTuple1(this->FragmentId, this->ClipDepthMin);
-          }
-          // clear the volume accumulator
-          this->FragmentVolume = 0.0;
-          this->ClipDepthMax = 0.0;
-          this->ClipDepthMin = VTK_FLOAT_MAX;
-          if (this->ComputeMoments)
-          {
-            // Save the moments from the last fragment
-            this->FragmentMoments->InsertTuple(this->FragmentId, &this->FragmentMoment[0]);
-            // clear the moment accumulator
-            FillVector(this->FragmentMoment, 0.0);
-          }
-          // for the volume weighted averaged scalars/vectors...
-          for (int i = 0; i < this->NVolumeWtdAvgs; ++i)
-          {
-            // update the integrated value, independent of ncomps
-            this->FragmentVolumeWtdAvgs[i]->InsertTuple(
-              this->FragmentId, &this->FragmentVolumeWtdAvg[i][0]);
-            // clear the accumulator
-            FillVector(this->FragmentVolumeWtdAvg[i], 0.0);
-          }
-          // for the mass weighted averaged scalars/vectors...
-          for (int i = 0; i < this->NMassWtdAvgs; ++i)
-          {
-            // update the integrated value, independent of ncomps
-            this->FragmentMassWtdAvgs[i]->InsertTuple(
-              this->FragmentId, &this->FragmentMassWtdAvg[i][0]);
-            // clear the accumulator
-            FillVector(this->FragmentMassWtdAvg[i], 0.0);
-          }
-          // for the summed scalars/vectors...
-          for (int i = 0; i < this->NToSum; ++i)
-          {
-            // update the integrated value, independent of ncomps
-            this->FragmentSums[i]->InsertTuple(this->FragmentId, &this->FragmentSum[i][0]);
-            // clear the accumulator
-            FillVector(this->FragmentSum[i], 0.0);
-          }
+          labeling->CurrentFragmentMesh->Squeeze();
+          labeling->Fragments->Meshes.push_back(labeling->CurrentFragmentMesh);
+          labeling->CurrentFragmentMesh = 0;
+          // Save the integrated attributes and clear the accumulators.
+          labeling->SaveAccumulators();
+          labeling->ClearAccumulators();
           // Move to next fragment.
-          ++this->FragmentId;
+          ++labeling->FragmentId;
         }
         xIterator->FlatIndex += cellIncs[0]; // 1/ncomp
         xIterator->VolumeFractionPointer += cellIncs[0];
@@ -3864,7 +4075,6 @@ int vtkMaterialInterfaceFilter::ProcessBlock(int blockId)
     zIterator->FragmentIdPointer += cellIncs[2];
   }
 
-  delete queue;
   delete xIterator;
   delete yIterator;
   delete zIterator;
@@ -3872,6 +4082,161 @@ int vtkMaterialInterfaceFilter::ProcessBlock(int blockId)
   return 1;
 }
 
+//----------------------------------------------------------------------------
+// Give the fragments found by ProcessBlock the next local fragment ids and
+// copy their meshes and integrated attributes to the filter.
+void vtkMaterialInterfaceFilter::AddBlockFragments(
+  vtkMaterialInterfaceFilterBlockFragments* fragments)
+{
+  fragments->FirstFragmentId = this->FragmentId;
+  const double* values = fragments->Values.empty() ? 0 : &fragments->Values[0];
+  int numFragments = static_cast<int>(fragments->Meshes.size());
+  for (int ii = 0; ii < numFragments; ++ii)
+  {
+    this->FragmentMeshes.push_back(fragments->Meshes[ii]);
+    this->FragmentVolumes->InsertTuple1(this->FragmentId, *values++);
+    if (this->ClipWithPlane)
+    {
+      this->ClipDepthMaximums->InsertTuple1(this->FragmentId, *values++);
+      this->ClipDepthMinimums->InsertTuple1(this->FragmentId, *values++);
+    }
+    if (this->ComputeMoments)
+    {
+      this->FragmentMoments->InsertTuple(this->FragmentId, values);
+      values += 4;
+    }
+    for (int i = 0; i < this->NVolumeWtdAvgs; ++i)
+    {
+      this->FragmentVolumeWtdAvgs[i]->InsertTuple(this->FragmentId, values);
+      values += this->FragmentVolumeWtdAvgs[i]->GetNumberOfComponents();
+    }
+    for (int i = 0; i < this->NMassWtdAvgs; ++i)
+    {
+      this->FragmentMassWtdAvgs[i]->InsertTuple(this->FragmentId, values);
+      values += this->FragmentMassWtdAvgs[i]->GetNumberOfComponents();
+    }
+    for (int i = 0; i < this->NToSum; ++i)
+    {
+      this->FragmentSums[i]->InsertTuple(this->FragmentId, values);
+      values += this->FragmentSums[i]->GetNumberOfComponents();
+    }
+    ++this->FragmentId;
+  }
+  // The meshes are owned by FragmentMeshes now.
+  fragments->Meshes.clear();
+  vector<double>().swap(fragments->Values);
+}
+
+//----------------------------------------------------------------------------
+// Once the voxels of a block have their final ids, save the voxels connected
+// to neighbors in other blocks. Only the voxels on the boundary of the block
+// can have such neighbors.
+void vtkMaterialInterfaceFilter::ConnectBlockBoundary(
+  vtkMaterialInterfaceFilterLabeling* labeling, int blockId)
+{
+  vtkMaterialInterfaceFilterBlock* block = this->InputBlocks[blockId];
+  if (block == 0)
+  {
+    return;
+  }
+  labeling->Block = block;
+  labeling->CurrentFragmentMesh = 0;
+
+  vtkMaterialInterfaceFilterIterator iterator;
+  iterator.Block = block;
+  unsigned char* baseVolumeFraction = block->GetBaseVolumeFractionPointer();
+  int* baseFragmentId = block->GetBaseFragmentIdPointer();
+  int baseFlatIndex = block->GetBaseFlatIndex();
+  int cellIncs[3];
+  block->GetCellIncrements(cellIncs);
+  const int* ext = block->GetBaseCellExtent();
+  for (int iz = ext[4]; iz <= ext[5]; ++iz)
+  {
+    for (int iy = ext[2]; iy <= ext[3]; ++iy)
+    {
+      // Rows inside the block only have their first and last voxels
+      // on the boundary.
+      int ixInc = 1;
+      if (iz != ext[4] && iz != ext[5] && iy != ext[2] && iy != ext[3] && ext[1] > ext[0])
+      {
+        ixInc = ext[1] - ext[0];
+      }
+      for (int ix = ext[0]; ix <= ext[1]; ix += ixInc)
+      {
+        int offset = (ix - ext[0]) * cellIncs[0] + (iy - ext[2]) * cellIncs[1] +
+          (iz - ext[4]) * cellIncs[2];
+        if (baseFragmentId[offset] == -1)
+        {
+          continue;
+        }
+        iterator.Index[0] = ix;
+        iterator.Index[1] = iy;
+        iterator.Index[2] = iz;
+        iterator.VolumeFractionPointer = baseVolumeFraction + offset;
+        iterator.FragmentIdPointer = baseFragmentId + offset;
+        iterator.FlatIndex = baseFlatIndex + offset;
+        this->ConnectNeighbors(labeling, &iterator);
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+// Turn the connections saved by ConnectBlockBoundary into equivalences.
+// Unvisited neighbors are voxels of ghost blocks, which are flooded as in
+// the serial search so that ghost fragments are shared between processes.
+void vtkMaterialInterfaceFilter::ConnectBlockNeighbors(
+  vtkMaterialInterfaceFilterLabeling* labeling, vtkMaterialInterfaceFilterBlockFragments* fragments)
+{
+  // Flood across blocks, without creating faces.
+  labeling->Block = 0;
+  labeling->CurrentFragmentMesh = 0;
+  size_t numConnections = fragments->Connections.size();
+  for (size_t ii = 0; ii + 1 < numConnections; ii += 2)
+  {
+    vtkMaterialInterfaceFilterIterator* iterator = &fragments->Connections[ii];
+    labeling->FragmentId = *(iterator->FragmentIdPointer);
+    this->ConnectNeighbor(labeling, iterator, &fragments->Connections[ii + 1]);
+    this->ConnectFragment(labeling);
+  }
+  vector<vtkMaterialInterfaceFilterIterator>().swap(fragments->Connections);
+}
+
+//----------------------------------------------------------------------------
+// Connect a voxel of the current fragment to a neighbor above the material
+// threshold. See vtkMaterialInterfaceFilterLabeling for the three cases.
+void vtkMaterialInterfaceFilter::ConnectNeighbor(vtkMaterialInterfaceFilterLabeling* labeling,
+  vtkMaterialInterfaceFilterIterator* iterator, vtkMaterialInterfaceFilterIterator* neighbor)
+{
+  if (labeling->Block == 0)
+  {
+    if (*(neighbor->FragmentIdPointer) == -1)
+    { // We have not visited this neighbor yet. Mark the voxel and recurse.
+      *(neighbor->FragmentIdPointer) = labeling->FragmentId;
+      labeling->Queue.Push(neighbor);
+    }
+    else
+    { // The last case is that we have already visited this voxel and it
+      // is in the same fragment.
+      this->AddEquivalence(iterator, neighbor);
+    }
+  }
+  else if (neighbor->Block == labeling->Block)
+  {
+    // Visited voxels of the block are in the current fragment.
+    if (labeling->CurrentFragmentMesh && *(neighbor->FragmentIdPointer) == -1)
+    {
+      *(neighbor->FragmentIdPointer) = labeling->FragmentId;
+      labeling->Queue.Push(neighbor);
+    }
+  }
+  else if (labeling->CurrentFragmentMesh == 0)
+  {
+    labeling->Fragments->Connections.push_back(*iterator);
+    labeling->Fragments->Connections.push_back(*neighbor);
+  }
+}
+
 // We conserver neighbor relations and put the reference (in)
 // block in position 0, and the out block in position 1.
 // The face being generated is between 0 and 1.
@@ -4249,8 +4614,9 @@ int vtkMaterialInterfaceFilter::ComputeDisplacementFactors(
 // It will be modified with the sub voxel displacement.
 // The return value indicates that an edge may be non manifold.
 // It returns the y or z axis index of the edge that may be non manifold.
-int vtkMaterialInterfaceFilter::SubVoxelPositionCorner(double* point,
-  vtkMaterialInterfaceFilterIterator* pointNeighborIterators[8], int rootNeighborIdx, int faceAxis)
+int vtkMaterialInterfaceFilter::SubVoxelPositionCorner(vtkMaterialInterfaceFilterLabeling* labeling,
+  double* point, vtkMaterialInterfaceFilterIterator* pointNeighborIterators[8], int rootNeighborIdx,
+  int faceAxis)
 {
   int retVal;
 
@@ -4298,13 +4664,13 @@ int vtkMaterialInterfaceFilter::SubVoxelPositionCorner(double* point,
     projection = (point[0] - this->ClipCenter[0]) * this->ClipPlaneNormal[0];
     projection += (point[1] - this->ClipCenter[1]) * this->ClipPlaneNormal[1];
     projection += (point[2] - this->ClipCenter[2]) * this->ClipPlaneNormal[2];
-    if (this->ClipDepthMax < projection)
+    if (labeling->ClipDepthMax < projection)
     {
-      this->ClipDepthMax = projection;
+      labeling->ClipDepthMax = projection;
     }
-    if (this->ClipDepthMin > projection)
+    if (labeling->ClipDepthMin > projection)
     {
-      this->ClipDepthMin = projection;
+      labeling->ClipDepthMin = projection;
     }
   }
 
@@ -4322,10 +4688,12 @@ int vtkMaterialInterfaceFilter::SubVoxelPositionCorner(double* point,
 // Now to fix cracks.  If neighbors are higher level,
 // I need to have more than 4 points for a face.
 // I am only going to support transitions of 1 level.
-void vtkMaterialInterfaceFilter::CreateFace(vtkMaterialInterfaceFilterIterator* in,
-  vtkMaterialInterfaceFilterIterator* out, int axis, int outMaxFlag)
+void vtkMaterialInterfaceFilter::CreateFace(vtkMaterialInterfaceFilterLabeling* labeling,
+  vtkMaterialInterfaceFilterIterator* in, vtkMaterialInterfaceFilterIterator* out, int axis,
+  int outMaxFlag)
 {
-  if (in->Block == 0 || in->Block->GetGhostFlag())
+  // Faces are only created while building a fragment.
+  if (in->Block == 0 || in->Block->GetGhostFlag() || labeling->CurrentFragmentMesh == 0)
   {
     return;
   }
@@ -4346,8 +4714,8 @@ void vtkMaterialInterfaceFilter::CreateFace(vtkMaterialInterfaceFilterIterator*
   // Add points to the output.  Create separate points for each triangle.
   // We can worry about merging points later.
   vtkMaterialInterfaceFilterIterator* cornerNeighbors[8];
-  vtkPoints* points = this->CurrentFragmentMesh->GetPoints(); // TODO for performance store?
-  vtkCellArray* polys = this->CurrentFragmentMesh->GetPolys();
+  vtkPoints* points = labeling->CurrentFragmentMesh->GetPoints(); // TODO for performance store?
+  vtkCellArray* polys = labeling->CurrentFragmentMesh->GetPolys();
   vtkIdType quadCornerIds[4];
   vtkIdType quadMidIds[4];
   vtkIdType triPtIds[3];
@@ -4358,10 +4726,10 @@ void vtkMaterialInterfaceFilter::CreateFace(vtkMaterialInterfaceFilterIterator*
 
   // Compute the corner and edge points (before subpixel positioning).
   // Store the results in ivars.
-  this->ComputeFacePoints(in, out, axis, outMaxFlag);
+  this->ComputeFacePoints(labeling, in, out, axis, outMaxFlag);
   // Find the neighbor iterators.
   // Store the results in ivars.
-  this->ComputeFaceNeighbors(in, out, axis, outMaxFlag);
+  this->ComputeFaceNeighbors(labeling, in, out, axis, outMaxFlag);
 
   // A word about indexing:
   // face neighbors 2x4x4 indexed face normal axis first, axis1, then axis2.
@@ -4396,55 +4764,55 @@ void vtkMaterialInterfaceFilter::CreateFace(vtkMaterialInterfaceFilterIterator*
   // to perform connectivity on the 2x2x2 point neighbors.
   int inNeighborIdx;
 
-  cornerNeighbors[i0] = &(this->FaceNeighbors[0]);
-  cornerNeighbors[i1] = &(this->FaceNeighbors[1]);
-  cornerNeighbors[i2] = &(this->FaceNeighbors[2]);
-  cornerNeighbors[i3] = &(this->FaceNeighbors[3]);
-  cornerNeighbors[i4] = &(this->FaceNeighbors[8]);
-  cornerNeighbors[i5] = &(this->FaceNeighbors[9]);
-  cornerNeighbors[i6] = &(this->FaceNeighbors[10]);
-  cornerNeighbors[i7] = &(this->FaceNeighbors[11]);
+  cornerNeighbors[i0] = &(labeling->FaceNeighbors[0]);
+  cornerNeighbors[i1] = &(labeling->FaceNeighbors[1]);
+  cornerNeighbors[i2] = &(labeling->FaceNeighbors[2]);
+  cornerNeighbors[i3] = &(labeling->FaceNeighbors[3]);
+  cornerNeighbors[i4] = &(labeling->FaceNeighbors[8]);
+  cornerNeighbors[i5] = &(labeling->FaceNeighbors[9]);
+  cornerNeighbors[i6] = &(labeling->FaceNeighbors[10]);
+  cornerNeighbors[i7] = &(labeling->FaceNeighbors[11]);
   inNeighborIdx = outMaxFlag ? i6 : i7; // Face neighbor 10 or 11
-  manifoldIssue[0] =
-    this->SubVoxelPositionCorner(this->FaceCornerPoints, cornerNeighbors, inNeighborIdx, axis);
+  manifoldIssue[0] = this->SubVoxelPositionCorner(
+    labeling, labeling->FaceCornerPoints, cornerNeighbors, inNeighborIdx, axis);
   // 1 =>
-  quadCornerIds[0] = points->InsertNextPoint(this->FaceCornerPoints);
-  cornerNeighbors[i0] = &(this->FaceNeighbors[4]);
-  cornerNeighbors[i1] = &(this->FaceNeighbors[5]);
-  cornerNeighbors[i2] = &(this->FaceNeighbors[6]);
-  cornerNeighbors[i3] = &(this->FaceNeighbors[7]);
-  cornerNeighbors[i4] = &(this->FaceNeighbors[12]);
-  cornerNeighbors[i5] = &(this->FaceNeighbors[13]);
-  cornerNeighbors[i6] = &(this->FaceNeighbors[14]);
-  cornerNeighbors[i7] = &(this->FaceNeighbors[15]);
+  quadCornerIds[0] = points->InsertNextPoint(labeling->FaceCornerPoints);
+  cornerNeighbors[i0] = &(labeling->FaceNeighbors[4]);
+  cornerNeighbors[i1] = &(labeling->FaceNeighbors[5]);
+  cornerNeighbors[i2] = &(labeling->FaceNeighbors[6]);
+  cornerNeighbors[i3] = &(labeling->FaceNeighbors[7]);
+  cornerNeighbors[i4] = &(labeling->FaceNeighbors[12]);
+  cornerNeighbors[i5] = &(labeling->FaceNeighbors[13]);
+  cornerNeighbors[i6] = &(labeling->FaceNeighbors[14]);
+  cornerNeighbors[i7] = &(labeling->FaceNeighbors[15]);
   inNeighborIdx = outMaxFlag ? i4 : i5; // Face neighbor 12 or 13
-  manifoldIssue[1] =
-    this->SubVoxelPositionCorner(this->FaceCornerPoints + 3, cornerNeighbors, inNeighborIdx, axis);
-  quadCornerIds[1] = points->InsertNextPoint(this->FaceCornerPoints + 3);
-  cornerNeighbors[i0] = &(this->FaceNeighbors[16]);
-  cornerNeighbors[i1] = &(this->FaceNeighbors[17]);
-  cornerNeighbors[i2] = &(this->FaceNeighbors[18]);
-  cornerNeighbors[i3] = &(this->FaceNeighbors[19]);
-  cornerNeighbors[i4] = &(this->FaceNeighbors[24]);
-  cornerNeighbors[i5] = &(this->FaceNeighbors[25]);
-  cornerNeighbors[i6] = &(this->FaceNeighbors[26]);
-  cornerNeighbors[i7] = &(this->FaceNeighbors[27]);
+  manifoldIssue[1] = this->SubVoxelPositionCorner(
+    labeling, labeling->FaceCornerPoints + 3, cornerNeighbors, inNeighborIdx, axis);
+  quadCornerIds[1] = points->InsertNextPoint(labeling->FaceCornerPoints + 3);
+  cornerNeighbors[i0] = &(labeling->FaceNeighbors[16]);
+  cornerNeighbors[i1] = &(labeling->FaceNeighbors[17]);
+  cornerNeighbors[i2] = &(labeling->FaceNeighbors[18]);
+  cornerNeighbors[i3] = &(labeling->FaceNeighbors[19]);
+  cornerNeighbors[i4] = &(labeling->FaceNeighbors[24]);
+  cornerNeighbors[i5] = &(labeling->FaceNeighbors[25]);
+  cornerNeighbors[i6] = &(labeling->FaceNeighbors[26]);
+  cornerNeighbors[i7] = &(labeling->FaceNeighbors[27]);
   inNeighborIdx = outMaxFlag ? i2 : i3; // Face neighbor 18 or 19
-  manifoldIssue[2] =
-    this->SubVoxelPositionCorner(this->FaceCornerPoints + 6, cornerNeighbors, inNeighborIdx, axis);
-  quadCornerIds[2] = points->InsertNextPoint(this->FaceCornerPoints + 6);
-  cornerNeighbors[i0] = &(this->FaceNeighbors[20]);
-  cornerNeighbors[i1] = &(this->FaceNeighbors[21]);
-  cornerNeighbors[i2] = &(this->FaceNeighbors[22]);
-  cornerNeighbors[i3] = &(this->FaceNeighbors[23]);
-  cornerNeighbors[i4] = &(this->FaceNeighbors[28]);
-  cornerNeighbors[i5] = &(this->FaceNeighbors[29]);
-  cornerNeighbors[i6] = &(this->FaceNeighbors[30]);
-  cornerNeighbors[i7] = &(this->FaceNeighbors[31]);
+  manifoldIssue[2] = this->SubVoxelPositionCorner(
+    labeling, labeling->FaceCornerPoints + 6, cornerNeighbors, inNeighborIdx, axis);
+  quadCornerIds[2] = points->InsertNextPoint(labeling->FaceCornerPoints + 6);
+  cornerNeighbors[i0] = &(labeling->FaceNeighbors[20]);
+  cornerNeighbors[i1] = &(labeling->FaceNeighbors[21]);
+  cornerNeighbors[i2] = &(labeling->FaceNeighbors[22]);
+  cornerNeighbors[i3] = &(labeling->FaceNeighbors[23]);
+  cornerNeighbors[i4] = &(labeling->FaceNeighbors[28]);
+  cornerNeighbors[i5] = &(labeling->FaceNeighbors[29]);
+  cornerNeighbors[i6] = &(labeling->FaceNeighbors[30]);
+  cornerNeighbors[i7] = &(labeling->FaceNeighbors[31]);
   inNeighborIdx = outMaxFlag ? i0 : i1; // Face neighbor 20 or 21
-  manifoldIssue[3] =
-    this->SubVoxelPositionCorner(this->FaceCornerPoints + 9, cornerNeighbors, inNeighborIdx, axis);
-  quadCornerIds[3] = points->InsertNextPoint(this->FaceCornerPoints + 9);
+  manifoldIssue[3] = this->SubVoxelPositionCorner(
+    labeling, labeling->FaceCornerPoints + 9, cornerNeighbors, inNeighborIdx, axis);
+  quadCornerIds[3] = points->InsertNextPoint(labeling->FaceCornerPoints + 9);
 
   // If both corners of an edge have an issue, the we need an extra
   // point on the edge to generate a hole.
@@ -4457,93 +4825,97 @@ void vtkMaterialInterfaceFilter::CreateFace(vtkMaterialInterfaceFilterIterator*
   if (manifoldIssue[0] != 0 && manifoldIssue[1] != 0 && tmp[manifoldIssue[0]] == 1 &&
     tmp[manifoldIssue[1]] == 1)
   {
-    this->FaceEdgeFlags[0] = 1;
+    labeling->FaceEdgeFlags[0] = 1;
   }
 
   if (manifoldIssue[0] != 0 && manifoldIssue[2] != 0 && tmp[manifoldIssue[0]] == 2 &&
     tmp[manifoldIssue[2]] == 2)
   {
-    this->FaceEdgeFlags[1] = 1;
+    labeling->FaceEdgeFlags[1] = 1;
   }
   if (manifoldIssue[1] != 0 && manifoldIssue[3] != 0 && tmp[manifoldIssue[1]] == 2 &&
     tmp[manifoldIssue[3]] == 2)
   {
-    this->FaceEdgeFlags[2] = 1;
+    labeling->FaceEdgeFlags[2] = 1;
   }
   if (manifoldIssue[2] != 0 && manifoldIssue[3] && tmp[manifoldIssue[2]] == 1 &&
     tmp[manifoldIssue[3]] == 1)
   {
-    this->FaceEdgeFlags[3] = 1;
+    labeling->FaceEdgeFlags[3] = 1;
   }
 
   // Now for the mid edge point if the neighbors on that side are smaller.
-  if (this->FaceEdgeFlags[0])
-  {
-    cornerNeighbors[i0] = &(this->FaceNeighbors[2]);
-    cornerNeighbors[i1] = &(this->FaceNeighbors[3]);
-    cornerNeighbors[i2] = &(this->FaceNeighbors[4]);
-    cornerNeighbors[i3] = &(this->FaceNeighbors[5]);
-    cornerNeighbors[i4] = &(this->FaceNeighbors[10]);
-    cornerNeighbors[i5] = &(this->FaceNeighbors[11]);
-    cornerNeighbors[i6] = &(this->FaceNeighbors[12]);
-    cornerNeighbors[i7] = &(this->FaceNeighbors[13]);
+  if (labeling->FaceEdgeFlags[0])
+  {
+    cornerNeighbors[i0] = &(labeling->FaceNeighbors[2]);
+    cornerNeighbors[i1] = &(labeling->FaceNeighbors[3]);
+    cornerNeighbors[i2] = &(labeling->FaceNeighbors[4]);
+    cornerNeighbors[i3] = &(labeling->FaceNeighbors[5]);
+    cornerNeighbors[i4] = &(labeling->FaceNeighbors[10]);
+    cornerNeighbors[i5] = &(labeling->FaceNeighbors[11]);
+    cornerNeighbors[i6] = &(labeling->FaceNeighbors[12]);
+    cornerNeighbors[i7] = &(labeling->FaceNeighbors[13]);
     // Two choices here (10, 12) because they both are the same voxel.
     inNeighborIdx = outMaxFlag ? i4 : i5;
-    this->SubVoxelPositionCorner(this->FaceEdgePoints, cornerNeighbors, inNeighborIdx, axis);
-    quadMidIds[0] = points->InsertNextPoint(this->FaceEdgePoints);
-  }
-  if (this->FaceEdgeFlags[1])
-  {
-    cornerNeighbors[i0] = &(this->FaceNeighbors[8]);
-    cornerNeighbors[i1] = &(this->FaceNeighbors[9]);
-    cornerNeighbors[i2] = &(this->FaceNeighbors[10]);
-    cornerNeighbors[i3] = &(this->FaceNeighbors[11]);
-    cornerNeighbors[i4] = &(this->FaceNeighbors[16]);
-    cornerNeighbors[i5] = &(this->FaceNeighbors[17]);
-    cornerNeighbors[i6] = &(this->FaceNeighbors[18]);
-    cornerNeighbors[i7] = &(this->FaceNeighbors[19]);
+    this->SubVoxelPositionCorner(
+      labeling, labeling->FaceEdgePoints, cornerNeighbors, inNeighborIdx, axis);
+    quadMidIds[0] = points->InsertNextPoint(labeling->FaceEdgePoints);
+  }
+  if (labeling->FaceEdgeFlags[1])
+  {
+    cornerNeighbors[i0] = &(labeling->FaceNeighbors[8]);
+    cornerNeighbors[i1] = &(labeling->FaceNeighbors[9]);
+    cornerNeighbors[i2] = &(labeling->FaceNeighbors[10]);
+    cornerNeighbors[i3] = &(labeling->FaceNeighbors[11]);
+    cornerNeighbors[i4] = &(labeling->FaceNeighbors[16]);
+    cornerNeighbors[i5] = &(labeling->FaceNeighbors[17]);
+    cornerNeighbors[i6] = &(labeling->FaceNeighbors[18]);
+    cornerNeighbors[i7] = &(labeling->FaceNeighbors[19]);
     // Two choices here (10, 18) because they both are the same voxel.
     inNeighborIdx = outMaxFlag ? i2 : i3;
-    this->SubVoxelPositionCorner(this->FaceEdgePoints + 3, cornerNeighbors, inNeighborIdx, axis);
-    quadMidIds[1] = points->InsertNextPoint(this->FaceEdgePoints + 3);
-  }
-  if (this->FaceEdgeFlags[2])
-  {
-    cornerNeighbors[i0] = &(this->FaceNeighbors[12]);
-    cornerNeighbors[i1] = &(this->FaceNeighbors[13]);
-    cornerNeighbors[i2] = &(this->FaceNeighbors[14]);
-    cornerNeighbors[i3] = &(this->FaceNeighbors[15]);
-    cornerNeighbors[i4] = &(this->FaceNeighbors[20]);
-    cornerNeighbors[i5] = &(this->FaceNeighbors[21]);
-    cornerNeighbors[i6] = &(this->FaceNeighbors[22]);
-    cornerNeighbors[i7] = &(this->FaceNeighbors[23]);
+    this->SubVoxelPositionCorner(
+      labeling, labeling->FaceEdgePoints + 3, cornerNeighbors, inNeighborIdx, axis);
+    quadMidIds[1] = points->InsertNextPoint(labeling->FaceEdgePoints + 3);
+  }
+  if (labeling->FaceEdgeFlags[2])
+  {
+    cornerNeighbors[i0] = &(labeling->FaceNeighbors[12]);
+    cornerNeighbors[i1] = &(labeling->FaceNeighbors[13]);
+    cornerNeighbors[i2] = &(labeling->FaceNeighbors[14]);
+    cornerNeighbors[i3] = &(labeling->FaceNeighbors[15]);
+    cornerNeighbors[i4] = &(labeling->FaceNeighbors[20]);
+    cornerNeighbors[i5] = &(labeling->FaceNeighbors[21]);
+    cornerNeighbors[i6] = &(labeling->FaceNeighbors[22]);
+    cornerNeighbors[i7] = &(labeling->FaceNeighbors[23]);
     // Two choices here (12, 20) because they both are the same voxel.
     inNeighborIdx = outMaxFlag ? i0 : i1;
-    this->SubVoxelPositionCorner(this->FaceEdgePoints + 6, cornerNeighbors, inNeighborIdx, axis);
-    quadMidIds[2] = points->InsertNextPoint(this->FaceEdgePoints + 6);
-  }
-  if (this->FaceEdgeFlags[3])
-  {
-    cornerNeighbors[i0] = &(this->FaceNeighbors[18]);
-    cornerNeighbors[i1] = &(this->FaceNeighbors[19]);
-    cornerNeighbors[i2] = &(this->FaceNeighbors[20]);
-    cornerNeighbors[i3] = &(this->FaceNeighbors[21]);
-    cornerNeighbors[i4] = &(this->FaceNeighbors[26]);
-    cornerNeighbors[i5] = &(this->FaceNeighbors[27]);
-    cornerNeighbors[i6] = &(this->FaceNeighbors[28]);
-    cornerNeighbors[i7] = &(this->FaceNeighbors[29]);
+    this->SubVoxelPositionCorner(
+      labeling, labeling->FaceEdgePoints + 6, cornerNeighbors, inNeighborIdx, axis);
+    quadMidIds[2] = points->InsertNextPoint(labeling->FaceEdgePoints + 6);
+  }
+  if (labeling->FaceEdgeFlags[3])
+  {
+    cornerNeighbors[i0] = &(labeling->FaceNeighbors[18]);
+    cornerNeighbors[i1] = &(labeling->FaceNeighbors[19]);
+    cornerNeighbors[i2] = &(labeling->FaceNeighbors[20]);
+    cornerNeighbors[i3] = &(labeling->FaceNeighbors[21]);
+    cornerNeighbors[i4] = &(labeling->FaceNeighbors[26]);
+    cornerNeighbors[i5] = &(labeling->FaceNeighbors[27]);
+    cornerNeighbors[i6] = &(labeling->FaceNeighbors[28]);
+    cornerNeighbors[i7] = &(labeling->FaceNeighbors[29]);
     // Two choices here (18, 20) because they both are the same voxel.
     inNeighborIdx = outMaxFlag ? i0 : i1;
-    this->SubVoxelPositionCorner(this->FaceEdgePoints + 9, cornerNeighbors, inNeighborIdx, axis);
-    quadMidIds[3] = points->InsertNextPoint(this->FaceEdgePoints + 9);
+    this->SubVoxelPositionCorner(
+      labeling, labeling->FaceEdgePoints + 9, cornerNeighbors, inNeighborIdx, axis);
+    quadMidIds[3] = points->InsertNextPoint(labeling->FaceEdgePoints + 9);
   }
 
   // Now there are 9 possibilities
   // (10 if you count the two ways to triangulate the simple quad).
   // No edges, $ cases with one mid point, 4 cases with two mid points.
   // That is all because the face is always the smallest of the two in/out voxels.
-  int caseIdx = this->FaceEdgeFlags[0] | (this->FaceEdgeFlags[1] << 1) |
-    (this->FaceEdgeFlags[2] << 2) | (this->FaceEdgeFlags[3] << 3);
+  int caseIdx = labeling->FaceEdgeFlags[0] | (labeling->FaceEdgeFlags[1] << 1) |
+    (labeling->FaceEdgeFlags[2] << 2) | (labeling->FaceEdgeFlags[3] << 3);
 
   // c2 e3 c3
   // e1    e2
@@ -4689,10 +5061,10 @@ void vtkMaterialInterfaceFilter::CreateFace(vtkMaterialInterfaceFilterIterator*
       // This will help us decide which way to split up the quad into triangles.
       double d0011 = 0.0;
       double d0110 = 0.0;
-      double* pt00 = this->FaceCornerPoints;
-      double* pt01 = this->FaceCornerPoints + 3;
-      double* pt10 = this->FaceCornerPoints + 6;
-      double* pt11 = this->FaceCornerPoints + 9;
+      double* pt00 = labeling->FaceCornerPoints;
+      double* pt01 = labeling->FaceCornerPoints + 3;
+      double* pt10 = labeling->FaceCornerPoints + 6;
+      double* pt11 = labeling->FaceCornerPoints + 9;
       for (int ii = 0; ii < 3; ++ii)
       {
         double tmp2 = pt00[ii] - pt11[ii];
@@ -4742,7 +5114,7 @@ void vtkMaterialInterfaceFilter::CreateFace(vtkMaterialInterfaceFilterIterator*
 
     // fragment
     vtkDoubleArray* destArray =
-      dynamic_cast<vtkDoubleArray*>(this->CurrentFragmentMesh->GetCellData()->GetArray(i));
+      dynamic_cast<vtkDoubleArray*>(labeling->CurrentFragmentMesh->GetCellData()->GetArray(i));
     for (vtkIdType ii = 0; ii < numTris; ++ii)
     {
       destArray->InsertNextTuple(&thisTup[0]);
@@ -4751,13 +5123,13 @@ void vtkMaterialInterfaceFilter::CreateFace(vtkMaterialInterfaceFilterIterator*
 // Cell data attributes for debugging.
 #ifdef vtkMaterialInterfaceFilterDEBUG
   vtkIntArray* levelArray =
-    dynamic_cast<vtkIntArray*>(this->CurrentFragmentMesh->GetCellData()->GetArray("Level"));
+    dynamic_cast<vtkIntArray*>(labeling->CurrentFragmentMesh->GetCellData()->GetArray("Level"));
 
   vtkIntArray* blockIdArray =
-    dynamic_cast<vtkIntArray*>(this->CurrentFragmentMesh->GetCellData()->GetArray("BlockId"));
+    dynamic_cast<vtkIntArray*>(labeling->CurrentFragmentMesh->GetCellData()->GetArray("BlockId"));
 
   vtkIntArray* procIdArray =
-    dynamic_cast<vtkIntArray*>(this->CurrentFragmentMesh->GetCellData()->GetArray("ProcId"));
+    dynamic_cast<vtkIntArray*>(labeling->CurrentFragmentMesh->GetCellData()->GetArray("ProcId"));
 
   for (vtkIdType ii = 0; ii < numTris; ++ii)
   {
@@ -4771,8 +5143,9 @@ void vtkMaterialInterfaceFilter::CreateFace(vtkMaterialInterfaceFilterIterator*
 //----------------------------------------------------------------------------
 // Computes the face and edge middle points of the shared contact face
 // between the two iterators.
-void vtkMaterialInterfaceFilter::ComputeFacePoints(vtkMaterialInterfaceFilterIterator* in,
-  vtkMaterialInterfaceFilterIterator* out, int axis, int outMaxFlag)
+void vtkMaterialInterfaceFilter::ComputeFacePoints(vtkMaterialInterfaceFilterLabeling* labeling,
+  vtkMaterialInterfaceFilterIterator* in, vtkMaterialInterfaceFilterIterator* out, int axis,
+  int outMaxFlag)
 {
   vtkMaterialInterfaceFilterIterator* smaller;
   double* origin;
@@ -4812,41 +5185,42 @@ void vtkMaterialInterfaceFilter::ComputeFacePoints(vtkMaterialInterfaceFilterIte
   // 6 9
   // 0 3
   // First set them all to the origin.
-  this->FaceCornerPoints[0] = this->FaceCornerPoints[3] = this->FaceCornerPoints[6] =
-    this->FaceCornerPoints[9] = faceOrigin[0];
-  this->FaceCornerPoints[1] = this->FaceCornerPoints[4] = this->FaceCornerPoints[7] =
-    this->FaceCornerPoints[10] = faceOrigin[1];
-  this->FaceCornerPoints[2] = this->FaceCornerPoints[5] = this->FaceCornerPoints[8] =
-    this->FaceCornerPoints[11] = faceOrigin[2];
+  labeling->FaceCornerPoints[0] = labeling->FaceCornerPoints[3] = labeling->FaceCornerPoints[6] =
+    labeling->FaceCornerPoints[9] = faceOrigin[0];
+  labeling->FaceCornerPoints[1] = labeling->FaceCornerPoints[4] = labeling->FaceCornerPoints[7] =
+    labeling->FaceCornerPoints[10] = faceOrigin[1];
+  labeling->FaceCornerPoints[2] = labeling->FaceCornerPoints[5] = labeling->FaceCornerPoints[8] =
+    labeling->FaceCornerPoints[11] = faceOrigin[2];
   // Now offset them to the corners.
-  this->FaceCornerPoints[3 + axis1] += spacing[axis1];
-  this->FaceCornerPoints[9 + axis1] += spacing[axis1];
-  this->FaceCornerPoints[6 + axis2] += spacing[axis2];
-  this->FaceCornerPoints[9 + axis2] += spacing[axis2];
+  labeling->FaceCornerPoints[3 + axis1] += spacing[axis1];
+  labeling->FaceCornerPoints[9 + axis1] += spacing[axis1];
+  labeling->FaceCornerPoints[6 + axis2] += spacing[axis2];
+  labeling->FaceCornerPoints[9 + axis2] += spacing[axis2];
 
   // Now do the same for the edge points
   //   3
   // 1   2
   //   0
   // First set them all to the origin.
-  this->FaceEdgePoints[0] = this->FaceEdgePoints[3] = this->FaceEdgePoints[6] =
-    this->FaceEdgePoints[9] = faceOrigin[0];
-  this->FaceEdgePoints[1] = this->FaceEdgePoints[4] = this->FaceEdgePoints[7] =
-    this->FaceEdgePoints[10] = faceOrigin[1];
-  this->FaceEdgePoints[2] = this->FaceEdgePoints[5] = this->FaceEdgePoints[8] =
-    this->FaceEdgePoints[11] = faceOrigin[2];
+  labeling->FaceEdgePoints[0] = labeling->FaceEdgePoints[3] = labeling->FaceEdgePoints[6] =
+    labeling->FaceEdgePoints[9] = faceOrigin[0];
+  labeling->FaceEdgePoints[1] = labeling->FaceEdgePoints[4] = labeling->FaceEdgePoints[7] =
+    labeling->FaceEdgePoints[10] = faceOrigin[1];
+  labeling->FaceEdgePoints[2] = labeling->FaceEdgePoints[5] = labeling->FaceEdgePoints[8] =
+    labeling->FaceEdgePoints[11] = faceOrigin[2];
   // Now offset the points to the middle of the edges.
-  this->FaceEdgePoints[axis1] += halfSpacing[axis1];
-  this->FaceEdgePoints[9 + axis1] += halfSpacing[axis1];
-  this->FaceEdgePoints[6 + axis1] += spacing[axis1];
-  this->FaceEdgePoints[3 + axis2] += halfSpacing[axis2];
-  this->FaceEdgePoints[6 + axis2] += halfSpacing[axis2];
-  this->FaceEdgePoints[9 + axis2] += spacing[axis2];
+  labeling->FaceEdgePoints[axis1] += halfSpacing[axis1];
+  labeling->FaceEdgePoints[9 + axis1] += halfSpacing[axis1];
+  labeling->FaceEdgePoints[6 + axis1] += spacing[axis1];
+  labeling->FaceEdgePoints[3 + axis2] += halfSpacing[axis2];
+  labeling->FaceEdgePoints[6 + axis2] += halfSpacing[axis2];
+  labeling->FaceEdgePoints[9 + axis2] += spacing[axis2];
 }
 
 //----------------------------------------------------------------------------
-void vtkMaterialInterfaceFilter::ComputeFaceNeighbors(vtkMaterialInterfaceFilterIterator* in,
-  vtkMaterialInterfaceFilterIterator* out, int axis, int outMaxFlag)
+void vtkMaterialInterfaceFilter::ComputeFaceNeighbors(vtkMaterialInterfaceFilterLabeling* labeling,
+  vtkMaterialInterfaceFilterIterator* in, vtkMaterialInterfaceFilterIterator* out, int axis,
+  int outMaxFlag)
 {
   int axis1 = (axis + 1) % 3;
   int axis2 = (axis + 2) % 3;
@@ -4893,17 +5267,17 @@ void vtkMaterialInterfaceFilter::ComputeFaceNeighbors(vtkMaterialInterfaceFilter
   // for subdivision.
   if (outMaxFlag)
   {
-    this->FaceNeighbors[10] = this->FaceNeighbors[12] = this->FaceNeighbors[18] =
-      this->FaceNeighbors[20] = *in;
-    this->FaceNeighbors[11] = this->FaceNeighbors[13] = this->FaceNeighbors[19] =
-      this->FaceNeighbors[21] = *out;
+    labeling->FaceNeighbors[10] = labeling->FaceNeighbors[12] = labeling->FaceNeighbors[18] =
+      labeling->FaceNeighbors[20] = *in;
+    labeling->FaceNeighbors[11] = labeling->FaceNeighbors[13] = labeling->FaceNeighbors[19] =
+      labeling->FaceNeighbors[21] = *out;
   }
   else
   {
-    this->FaceNeighbors[10] = this->FaceNeighbors[12] = this->FaceNeighbors[18] =
-      this->FaceNeighbors[20] = *out;
-    this->FaceNeighbors[11] = this->FaceNeighbors[13] = this->FaceNeighbors[19] =
-      this->FaceNeighbors[21] = *in;
+    labeling->FaceNeighbors[10] = labeling->FaceNeighbors[12] = labeling->FaceNeighbors[18] =
+      labeling->FaceNeighbors[20] = *out;
+    labeling->FaceNeighbors[11] = labeling->FaceNeighbors[13] = labeling->FaceNeighbors[19] =
+      labeling->FaceNeighbors[21] = *in;
   }
 
   // Ok, we have 24 neighbors to compute.
@@ -4912,92 +5286,93 @@ void vtkMaterialInterfaceFilter::ComputeFaceNeighbors(vtkMaterialInterfaceFilter
   // Face index starts at (1,1,1)
   // increments: 1, 2, 8
   // Start at the corner and march around the edges.
+  vtkMaterialInterfaceFilterIterator* faceNeighbors = labeling->FaceNeighbors;
   faceIndex[axis2] -= 1;
-  this->FindNeighbor(faceIndex, faceLevel, this->FaceNeighbors + 3, this->FaceNeighbors + 11);
+  this->FindNeighbor(faceIndex, faceLevel, faceNeighbors + 3, faceNeighbors + 11);
   faceIndex[axis1] += 1;
-  this->FindNeighbor(faceIndex, faceLevel, this->FaceNeighbors + 5, this->FaceNeighbors + 3);
+  this->FindNeighbor(faceIndex, faceLevel, faceNeighbors + 5, faceNeighbors + 3);
   faceIndex[axis1] += 1;
-  this->FindNeighbor(faceIndex, faceLevel, this->FaceNeighbors + 7, this->FaceNeighbors + 5);
+  this->FindNeighbor(faceIndex, faceLevel, faceNeighbors + 7, faceNeighbors + 5);
   faceIndex[axis2] += 1;
-  this->FindNeighbor(faceIndex, faceLevel, this->FaceNeighbors + 15, this->FaceNeighbors + 7);
+  this->FindNeighbor(faceIndex, faceLevel, faceNeighbors + 15, faceNeighbors + 7);
   faceIndex[axis2] += 1;
-  this->FindNeighbor(faceIndex, faceLevel, this->FaceNeighbors + 23, this->FaceNeighbors + 15);
+  this->FindNeighbor(faceIndex, faceLevel, faceNeighbors + 23, faceNeighbors + 15);
   faceIndex[axis2] += 1;
-  this->FindNeighbor(faceIndex, faceLevel, this->FaceNeighbors + 31, this->FaceNeighbors + 23);
+  this->FindNeighbor(faceIndex, faceLevel, faceNeighbors + 31, faceNeighbors + 23);
   faceIndex[axis1] -= 1;
-  this->FindNeighbor(faceIndex, faceLevel, this->FaceNeighbors + 29, this->FaceNeighbors + 31);
+  this->FindNeighbor(faceIndex, faceLevel, faceNeighbors + 29, faceNeighbors + 31);
   faceIndex[axis1] -= 1;
-  this->FindNeighbor(faceIndex, faceLevel, this->FaceNeighbors + 27, this->FaceNeighbors + 29);
+  this->FindNeighbor(faceIndex, faceLevel, faceNeighbors + 27, faceNeighbors + 29);
   faceIndex[axis1] -= 1;
-  this->FindNeighbor(faceIndex, faceLevel, this->FaceNeighbors + 25, this->FaceNeighbors + 27);
+  this->FindNeighbor(faceIndex, faceLevel, faceNeighbors + 25, faceNeighbors + 27);
   faceIndex[axis2] -= 1;
-  this->FindNeighbor(faceIndex, faceLevel, this->FaceNeighbors + 17, this->FaceNeighbors + 25);
+  this->FindNeighbor(faceIndex, faceLevel, faceNeighbors + 17, faceNeighbors + 25);
   faceIndex[axis2] -= 1;
-  this->FindNeighbor(faceIndex, faceLevel, this->FaceNeighbors + 9, this->FaceNeighbors + 17);
+  this->FindNeighbor(faceIndex, faceLevel, faceNeighbors + 9, faceNeighbors + 17);
   faceIndex[axis2] -= 1;
-  this->FindNeighbor(faceIndex, faceLevel, this->FaceNeighbors + 1, this->FaceNeighbors + 9);
+  this->FindNeighbor(faceIndex, faceLevel, faceNeighbors + 1, faceNeighbors + 9);
   // Now for the other side (min axis).
   faceIndex[axis] -= 1;  // Move to the other layer
   faceIndex[axis1] += 1; // Start below reference block.
-  this->FindNeighbor(faceIndex, faceLevel, this->FaceNeighbors + 2, this->FaceNeighbors + 10);
+  this->FindNeighbor(faceIndex, faceLevel, faceNeighbors + 2, faceNeighbors + 10);
   faceIndex[axis1] += 1;
-  this->FindNeighbor(faceIndex, faceLevel, this->FaceNeighbors + 4, this->FaceNeighbors + 2);
+  this->FindNeighbor(faceIndex, faceLevel, faceNeighbors + 4, faceNeighbors + 2);
   faceIndex[axis1] += 1;
-  this->FindNeighbor(faceIndex, faceLevel, this->FaceNeighbors + 6, this->FaceNeighbors + 4);
+  this->FindNeighbor(faceIndex, faceLevel, faceNeighbors + 6, faceNeighbors + 4);
   faceIndex[axis2] += 1;
-  this->FindNeighbor(faceIndex, faceLevel, this->FaceNeighbors + 14, this->FaceNeighbors + 6);
+  this->FindNeighbor(faceIndex, faceLevel, faceNeighbors + 14, faceNeighbors + 6);
   faceIndex[axis2] += 1;
-  this->FindNeighbor(faceIndex, faceLevel, this->FaceNeighbors + 22, this->FaceNeighbors + 14);
+  this->FindNeighbor(faceIndex, faceLevel, faceNeighbors + 22, faceNeighbors + 14);
   faceIndex[axis2] += 1;
-  this->FindNeighbor(faceIndex, faceLevel, this->FaceNeighbors + 30, this->FaceNeighbors + 22);
+  this->FindNeighbor(faceIndex, faceLevel, faceNeighbors + 30, faceNeighbors + 22);
   faceIndex[axis1] -= 1;
-  this->FindNeighbor(faceIndex, faceLevel, this->FaceNeighbors + 28, this->FaceNeighbors + 30);
+  this->FindNeighbor(faceIndex, faceLevel, faceNeighbors + 28, faceNeighbors + 30);
   faceIndex[axis1] -= 1;
-  this->FindNeighbor(faceIndex, faceLevel, this->FaceNeighbors + 26, this->FaceNeighbors + 28);
+  this->FindNeighbor(faceIndex, faceLevel, faceNeighbors + 26, faceNeighbors + 28);
   faceIndex[axis1] -= 1;
-  this->FindNeighbor(faceIndex, faceLevel, this->FaceNeighbors + 24, this->FaceNeighbors + 26);
+  this->FindNeighbor(faceIndex, faceLevel, faceNeighbors + 24, faceNeighbors + 26);
   faceIndex[axis2] -= 1;
-  this->FindNeighbor(faceIndex, faceLevel, this->FaceNeighbors + 16, this->FaceNeighbors + 24);
+  this->FindNeighbor(faceIndex, faceLevel, faceNeighbors + 16, faceNeighbors + 24);
   faceIndex[axis2] -= 1;
-  this->FindNeighbor(faceIndex, faceLevel, this->FaceNeighbors + 8, this->FaceNeighbors + 16);
+  this->FindNeighbor(faceIndex, faceLevel, faceNeighbors + 8, faceNeighbors + 16);
   faceIndex[axis2] -= 1;
-  this->FindNeighbor(faceIndex, faceLevel, this->FaceNeighbors + 0, this->FaceNeighbors + 8);
+  this->FindNeighbor(faceIndex, faceLevel, faceNeighbors + 0, faceNeighbors + 8);
 
   // Split edges if neighbors are a higher level than face.
   --faceLevel;
-  this->FaceEdgeFlags[0] = 0;
+  labeling->FaceEdgeFlags[0] = 0;
   // Checking equivalences (this->FaceNeighbor[2] != this->FaceNeighbor[4])
   // May be faster and work fine.
-  if (this->FaceNeighbors[2].Block->GetLevel() > faceLevel ||
-    this->FaceNeighbors[3].Block->GetLevel() > faceLevel ||
-    this->FaceNeighbors[4].Block->GetLevel() > faceLevel ||
-    this->FaceNeighbors[5].Block->GetLevel() > faceLevel)
+  if (labeling->FaceNeighbors[2].Block->GetLevel() > faceLevel ||
+    labeling->FaceNeighbors[3].Block->GetLevel() > faceLevel ||
+    labeling->FaceNeighbors[4].Block->GetLevel() > faceLevel ||
+    labeling->FaceNeighbors[5].Block->GetLevel() > faceLevel)
   {
-    this->FaceEdgeFlags[0] = 1;
+    labeling->FaceEdgeFlags[0] = 1;
   }
-  this->FaceEdgeFlags[1] = 0;
-  if (this->FaceNeighbors[8].Block->GetLevel() > faceLevel ||
-    this->FaceNeighbors[9].Block->GetLevel() > faceLevel ||
-    this->FaceNeighbors[16].Block->GetLevel() > faceLevel ||
-    this->FaceNeighbors[17].Block->GetLevel() > faceLevel)
+  labeling->FaceEdgeFlags[1] = 0;
+  if (labeling->FaceNeighbors[8].Block->GetLevel() > faceLevel ||
+    labeling->FaceNeighbors[9].Block->GetLevel() > faceLevel ||
+    labeling->FaceNeighbors[16].Block->GetLevel() > faceLevel ||
+    labeling->FaceNeighbors[17].Block->GetLevel() > faceLevel)
   {
-    this->FaceEdgeFlags[1] = 1;
+    labeling->FaceEdgeFlags[1] = 1;
   }
-  this->FaceEdgeFlags[2] = 0;
-  if (this->FaceNeighbors[14].Block->GetLevel() > faceLevel ||
-    this->FaceNeighbors[15].Block->GetLevel() > faceLevel ||
-    this->FaceNeighbors[22].Block->GetLevel() > faceLevel ||
-    this->FaceNeighbors[23].Block->GetLevel() > faceLevel)
+  labeling->FaceEdgeFlags[2] = 0;
+  if (labeling->FaceNeighbors[14].Block->GetLevel() > faceLevel ||
+    labeling->FaceNeighbors[15].Block->GetLevel() > faceLevel ||
+    labeling->FaceNeighbors[22].Block->GetLevel() > faceLevel ||
+    labeling->FaceNeighbors[23].Block->GetLevel() > faceLevel)
   {
-    this->FaceEdgeFlags[2] = 1;
+    labeling->FaceEdgeFlags[2] = 1;
   }
-  this->FaceEdgeFlags[3] = 0;
-  if (this->FaceNeighbors[26].Block->GetLevel() > faceLevel ||
-    this->FaceNeighbors[27].Block->GetLevel() > faceLevel ||
-    this->FaceNeighbors[28].Block->GetLevel() > faceLevel ||
-    this->FaceNeighbors[29].Block->GetLevel() > faceLevel)
+  labeling->FaceEdgeFlags[3] = 0;
+  if (labeling->FaceNeighbors[26].Block->GetLevel() > faceLevel ||
+    labeling->FaceNeighbors[27].Block->GetLevel() > faceLevel ||
+    labeling->FaceNeighbors[28].Block->GetLevel() > faceLevel ||
+    labeling->FaceNeighbors[29].Block->GetLevel() > faceLevel)
   {
-    this->FaceEdgeFlags[3] = 1;
+    labeling->FaceEdgeFlags[3] = 1;
   }
 }
 
@@ -5478,8 +5853,9 @@ inline int vtkMaterialInterfaceFilter::AccumulateMoments(double* moments, // =(M
 // This integrates quantities at the same time.
 // This is called only when the voxel is part of a fragment.
 // I tried to create a generic API to replace the hard coded conditional ifs.
-void vtkMaterialInterfaceFilter::ConnectFragment(vtkMaterialInterfaceFilterRingBuffer* queue)
+void vtkMaterialInterfaceFilter::ConnectFragment(vtkMaterialInterfaceFilterLabeling* labeling)
 {
+  vtkMaterialInterfaceFilterRingBuffer* queue = &labeling->Queue;
   while (queue->GetSize())
   {
     // Get the next voxel/iterator to search.
@@ -5498,14 +5874,14 @@ void vtkMaterialInterfaceFilter::ConnectFragment(vtkMaterialInterfaceFilterRingB
       double voxelVolumeFrac =
         dX[0] * dX[1] * dX[2] * (double)(*(iterator.VolumeFractionPointer)) / 255.0;
 #endif
-      this->FragmentVolume += voxelVolumeFrac;
+      labeling->FragmentVolume += voxelVolumeFrac;
       // The clip depth is accumulated in SubvoxelPositionCorner.
       // accumulate volume weighted average
       for (int i = 0; i < this->NVolumeWtdAvgs; ++i)
       {
         vtkDataArray* arrayToIntegrate = iterator.Block->GetVolumeWtdAvgArray(i);
         int nComps = arrayToIntegrate->GetNumberOfComponents();
-        this->Accumulate(&this->FragmentVolumeWtdAvg[i][0], arrayToIntegrate, nComps,
+        this->Accumulate(&labeling->FragmentVolumeWtdAvg[i][0], arrayToIntegrate, nComps,
           iterator.FlatIndex, voxelVolumeFrac);
       }
       // accumulate mass weighted average
@@ -5517,7 +5893,7 @@ void vtkMaterialInterfaceFilter::ConnectFragment(vtkMaterialInterfaceFilterRingB
         const double* X0 = iterator.Block->GetOrigin();
         double X[3] = { X0[0] + dX[0] * (0.5 + iterator.Index[0]),
           X0[1] + dX[1] * (0.5 + iterator.Index[1]), X0[2] + dX[2] * (0.5 + iterator.Index[2]) };
-        this->AccumulateMoments(&this->FragmentMoment[0], massArray, iterator.FlatIndex, X);
+        this->AccumulateMoments(&labeling->FragmentMoment[0], massArray, iterator.FlatIndex, X);
         // mass weighted averages
         double voxelMass;
         massArray->GetTuple(iterator.FlatIndex, &voxelMass);
@@ -5525,7 +5901,7 @@ void vtkMaterialInterfaceFilter::ConnectFragment(vtkMaterialInterfaceFilterRingB
         {
           vtkDataArray* arrayToIntegrate = iterator.Block->GetMassWtdAvgArray(i);
           int nComps = arrayToIntegrate->GetNumberOfComponents();
-          this->Accumulate(&this->FragmentMassWtdAvg[i][0], arrayToIntegrate, nComps,
+          this->Accumulate(&labeling->FragmentMassWtdAvg[i][0], arrayToIntegrate, nComps,
             iterator.FlatIndex, voxelMass);
         }
       }
@@ -5535,205 +5911,166 @@ void vtkMaterialInterfaceFilter::ConnectFragment(vtkMaterialInterfaceFilterRingB
         vtkDataArray* arrayToIntegrate = iterator.Block->GetArrayToSum(i);
         int nComps = arrayToIntegrate->GetNumberOfComponents();
         this->Accumulate(
-          &this->FragmentSum[i][0], arrayToIntegrate, nComps, iterator.FlatIndex, 1.0);
+          &labeling->FragmentSum[i][0], arrayToIntegrate, nComps, iterator.FlatIndex, 1.0);
       }
     }
 
-    // Create another iterator on the stack for recursion.
-    vtkMaterialInterfaceFilterIterator next;
+    this->ConnectNeighbors(labeling, &iterator);
+  }
+}
 
-    // Look at the face connected neighbors and recurse.
-    // We are not on the border and volume fraction of neighbor is high and
-    // we have not visited the voxel yet.
-    for (int ii = 0; ii < 3; ++ii)
+//----------------------------------------------------------------------------
+// Visits the face connected neighbors of a voxel, creating faces where the
+// neighbor is outside of the fragment.
+void vtkMaterialInterfaceFilter::ConnectNeighbors(
+  vtkMaterialInterfaceFilterLabeling* labeling, vtkMaterialInterfaceFilterIterator* iterator)
+{
+  // Create another iterator on the stack for recursion.
+  vtkMaterialInterfaceFilterIterator next;
+
+  // Look at the face connected neighbors and recurse.
+  // We are not on the border and volume fraction of neighbor is high and
+  // we have not visited the voxel yet.
+  for (int ii = 0; ii < 3; ++ii)
+  {
+    // I would make these variables to make the computation more clear,
+    // but they would accumulate on the stack.
+    // axis0 = ii;
+    // axis1 = (ii+1)%3;
+    // axis2 = (ii+2)%3;
+    // idxMin = 2*ii;
+    // idxMax = 2*ii+1this->IndexMax+1;
+    // "Left"/min
+    this->GetNeighborIterator(&next, iterator, ii, 0, (ii + 1) % 3, 0, (ii + 2) % 3, 0);
+
+    if (next.VolumeFractionPointer == 0 ||
+      next.VolumeFractionPointer[0] < this->scaledMaterialFractionThreshold)
     {
-      // I would make these variables to make the computation more clear,
-      // but they would accumulate on the stack.
-      // axis0 = ii;
-      // axis1 = (ii+1)%3;
-      // axis2 = (ii+2)%3;
-      // idxMin = 2*ii;
-      // idxMax = 2*ii+1this->IndexMax+1;
-      // "Left"/min
-      this->GetNeighborIterator(&next, &iterator, ii, 0, (ii + 1) % 3, 0, (ii + 2) % 3, 0);
-
-      if (next.VolumeFractionPointer == 0 ||
-        next.VolumeFractionPointer[0] < this->scaledMaterialFractionThreshold)
-      {
-        // Neighbor is outside of fragment.  Make a face.
-        this->CreateFace(&iterator, &next, ii, 0);
-      }
-      else if (next.FragmentIdPointer[0] == -1)
-      { // We have not visited this neighbor yet. Mark the voxel and recurse.
-        *(next.FragmentIdPointer) = this->FragmentId;
-        queue->Push(&next);
-      }
-      else
-      { // The last case is that we have already visited this voxel and it
-        // is in the same fragment.
-        this->AddEquivalence(&iterator, &next);
+      // Neighbor is outside of fragment.  Make a face.
+      this->CreateFace(labeling, iterator, &next, ii, 0);
+    }
+    else
+    { // Mark the voxel and recurse, or make it equivalent.
+      this->ConnectNeighbor(labeling, iterator, &next);
+    }
+
+    // Handle the case when the new iterator is a higher level.
+    // We need to loop over all the faces of the higher level that touch this face.
+    // We will restrict our case to 4 neighbors (max difference in levels is 1).
+    // If level skip, things should still work OK. Biggest issue is holes in surface.
+    // This also sort of assumes that at most one other block touches this face.
+    // Holes might appear if this is not true.
+    if (next.Block && next.Block->GetLevel() > iterator->Block->GetLevel())
+    {
+      vtkMaterialInterfaceFilterIterator next2;
+      bool threeDimFlag = next.Block->GetBaseCellExtent()[4] < next.Block->GetBaseCellExtent()[5];
+      // Take the first neighbor found and move +Y
+      if (ii != 1 || threeDimFlag)
+      { // stupid after the fact way of dealing with 2d AMR input.
+        this->GetNeighborIterator(&next2, &next, (ii + 1) % 3, 1, (ii + 2) % 3, 0, ii, 0);
+        if (next2.VolumeFractionPointer == 0 ||
+          next2.VolumeFractionPointer[0] < this->scaledMaterialFractionThreshold)
+        {
+          // Neighbor is outside of fragment.  Make a face.
+          this->CreateFace(labeling, iterator, &next2, ii, 0);
+        }
+        else
+        { // Mark the voxel and recurse, or make it equivalent.
+          this->ConnectNeighbor(labeling, iterator, &next2);
+        }
       }
-
-      // Handle the case when the new iterator is a higher level.
-      // We need to loop over all the faces of the higher level that touch this face.
-      // We will restrict our case to 4 neighbors (max difference in levels is 1).
-      // If level skip, things should still work OK. Biggest issue is holes in surface.
-      // This also sort of assumes that at most one other block touches this face.
-      // Holes might appear if this is not true.
-      if (next.Block && next.Block->GetLevel() > iterator.Block->GetLevel())
-      {
-        vtkMaterialInterfaceFilterIterator next2;
-        bool threeDimFlag = next.Block->GetBaseCellExtent()[4] < next.Block->GetBaseCellExtent()[5];
-        // Take the first neighbor found and move +Y
-        if (ii != 1 || threeDimFlag)
-        { // stupid after the fact way of dealing with 2d AMR input.
-          this->GetNeighborIterator(&next2, &next, (ii + 1) % 3, 1, (ii + 2) % 3, 0, ii, 0);
-          if (next2.VolumeFractionPointer == 0 ||
-            next2.VolumeFractionPointer[0] < this->scaledMaterialFractionThreshold)
-          {
-            // Neighbor is outside of fragment.  Make a face.
-            this->CreateFace(&iterator, &next2, ii, 0);
-          }
-          else if (next2.FragmentIdPointer[0] == -1)
-          { // We have not visited this neighbor yet. Mark the voxel and recurse.
-            *(next2.FragmentIdPointer) = this->FragmentId;
-            queue->Push(&next2);
-          }
-          else
-          { // The last case is that we have already visited this voxel and it
-            // is in the same fragment.
-            this->AddEquivalence(&next2, &next);
-          }
+      // Take the fist iterator found and move +Z
+      if (ii != 0 || threeDimFlag)
+      { // stupid after the fact way of dealing with 2d AMR input.
+        this->GetNeighborIterator(&next2, &next, (ii + 2) % 3, 1, ii, 0, (ii + 1) % 3, 0);
+        if (next2.VolumeFractionPointer == 0 ||
+          next2.VolumeFractionPointer[0] < this->scaledMaterialFractionThreshold)
+        {
+          // Neighbor is outside of fragment.  Make a face.
+          this->CreateFace(labeling, iterator, &next2, ii, 0);
         }
-        // Take the fist iterator found and move +Z
-        if (ii != 0 || threeDimFlag)
-        { // stupid after the fact way of dealing with 2d AMR input.
-          this->GetNeighborIterator(&next2, &next, (ii + 2) % 3, 1, ii, 0, (ii + 1) % 3, 0);
-          if (next2.VolumeFractionPointer == 0 ||
-            next2.VolumeFractionPointer[0] < this->scaledMaterialFractionThreshold)
-          {
-            // Neighbor is outside of fragment.  Make a face.
-            this->CreateFace(&iterator, &next2, ii, 0);
-          }
-          else if (next2.FragmentIdPointer[0] == -1)
-          { // We have not visited this neighbor yet. Mark the voxel and recurse.
-            *(next2.FragmentIdPointer) = this->FragmentId;
-            queue->Push(&next2);
-          }
-          else
-          { // The last case is that we have already visited this voxel and it
-            // is in the same fragment.
-            this->AddEquivalence(&next2, &next);
-          }
+        else
+        { // Mark the voxel and recurse, or make it equivalent.
+          this->ConnectNeighbor(labeling, iterator, &next2);
         }
-        // To get the +Y+Z start with the +Z iterator and move +Y put results in "next"
-        if (next2.Block && threeDimFlag)
+      }
+      // To get the +Y+Z start with the +Z iterator and move +Y put results in "next"
+      if (next2.Block && threeDimFlag)
+      {
+        this->GetNeighborIterator(&next, &next2, (ii + 1) % 3, 1, (ii + 2) % 3, 0, ii, 0);
+        if (next.VolumeFractionPointer == 0 ||
+          next.VolumeFractionPointer[0] < this->scaledMaterialFractionThreshold)
         {
-          this->GetNeighborIterator(&next, &next2, (ii + 1) % 3, 1, (ii + 2) % 3, 0, ii, 0);
-          if (next.VolumeFractionPointer == 0 ||
-            next.VolumeFractionPointer[0] < this->scaledMaterialFractionThreshold)
-          {
-            // Neighbor is outside of fragment.  Make a face.
-            this->CreateFace(&iterator, &next, ii, 0);
-          }
-          else if (next.FragmentIdPointer[0] == -1)
-          { // We have not visited this neighbor yet. Mark the voxel and recurse.
-            *(next.FragmentIdPointer) = this->FragmentId;
-            queue->Push(&next);
-          }
-          else
-          { // The last case is that we have already visited this voxel and it
-            // is in the same fragment.
-            this->AddEquivalence(&next2, &next);
-          }
+          // Neighbor is outside of fragment.  Make a face.
+          this->CreateFace(labeling, iterator, &next, ii, 0);
+        }
+        else
+        { // Mark the voxel and recurse, or make it equivalent.
+          this->ConnectNeighbor(labeling, iterator, &next);
         }
       }
+    }
 
-      // "Right"/max
-      this->GetNeighborIterator(&next, &iterator, ii, 1, (ii + 1) % 3, 0, (ii + 2) % 3, 0);
-      if (next.VolumeFractionPointer == 0 ||
-        next.VolumeFractionPointer[0] < this->scaledMaterialFractionThreshold)
-      { // Neighbor is outside of fragment.  Make a face.
-        this->CreateFace(&iterator, &next, ii, 1);
-      }
-      else if (next.FragmentIdPointer[0] == -1)
-      { // We have not visited this neighbor yet. Mark the voxel and recurse.
-        *(next.FragmentIdPointer) = this->FragmentId;
-        queue->Push(&next);
-      }
-      else
-      { // The last case is that we have already visited this voxel and it
-        // is in the same fragment.
-        this->AddEquivalence(&iterator, &next);
+    // "Right"/max
+    this->GetNeighborIterator(&next, iterator, ii, 1, (ii + 1) % 3, 0, (ii + 2) % 3, 0);
+    if (next.VolumeFractionPointer == 0 ||
+      next.VolumeFractionPointer[0] < this->scaledMaterialFractionThreshold)
+    { // Neighbor is outside of fragment.  Make a face.
+      this->CreateFace(labeling, iterator, &next, ii, 1);
+    }
+    else
+    { // Mark the voxel and recurse, or make it equivalent.
+      this->ConnectNeighbor(labeling, iterator, &next);
+    }
+    // Same case as above with the same logic to visit the
+    // four smaller cells that touch this face of the current block.
+    if (next.Block && next.Block->GetLevel() > iterator->Block->GetLevel())
+    {
+      vtkMaterialInterfaceFilterIterator next2;
+      bool threeDimFlag = next.Block->GetBaseCellExtent()[4] < next.Block->GetBaseCellExtent()[5];
+      // Take the first neighbor found and move +Y
+      if (ii != 1 || threeDimFlag)
+      { // stupid after the fact way of dealing with 2d AMR input.
+        this->GetNeighborIterator(&next2, &next, (ii + 1) % 3, 1, (ii + 2) % 3, 0, ii, 0);
+        if (next2.VolumeFractionPointer == 0 ||
+          next2.VolumeFractionPointer[0] < this->scaledMaterialFractionThreshold)
+        {
+          // Neighbor is outside of fragment.  Make a face.
+          this->CreateFace(labeling, iterator, &next2, ii, 1);
+        }
+        else
+        { // Mark the voxel and recurse, or make it equivalent.
+          this->ConnectNeighbor(labeling, iterator, &next2);
+        }
       }
-      // Same case as above with the same logic to visit the
-      // four smaller cells that touch this face of the current block.
-      if (next.Block && next.Block->GetLevel() > iterator.Block->GetLevel())
-      {
-        vtkMaterialInterfaceFilterIterator next2;
-        bool threeDimFlag = next.Block->GetBaseCellExtent()[4] < next.Block->GetBaseCellExtent()[5];
-        // Take the first neighbor found and move +Y
-        if (ii != 1 || threeDimFlag)
-        { // stupid after the fact way of dealing with 2d AMR input.
-          this->GetNeighborIterator(&next2, &next, (ii + 1) % 3, 1, (ii + 2) % 3, 0, ii, 0);
-          if (next2.VolumeFractionPointer == 0 ||
-            next2.VolumeFractionPointer[0] < this->scaledMaterialFractionThreshold)
-          {
-            // Neighbor is outside of fragment.  Make a face.
-            this->CreateFace(&iterator, &next2, ii, 1);
-          }
-          else if (next2.FragmentIdPointer[0] == -1)
-          { // We have not visited this neighbor yet. Mark the voxel and recurse.
-            *(next2.FragmentIdPointer) = this->FragmentId;
-            queue->Push(&next2);
-          }
-          else
-          { // The last case is that we have already visited this voxel and it
-            // is in the same fragment.
-            this->AddEquivalence(&next2, &next);
-          }
+      // Take the fist iterator found and move +Z
+      if (ii != 0 || threeDimFlag)
+      { // stupid after the fact way of dealing with 2d AMR input.
+        this->GetNeighborIterator(&next2, &next, (ii + 2) % 3, 1, ii, 0, (ii + 1) % 3, 0);
+        if (next2.VolumeFractionPointer == 0 ||
+          next2.VolumeFractionPointer[0] < this->scaledMaterialFractionThreshold)
+        {
+          // Neighbor is outside of fragment.  Make a face.
+          this->CreateFace(labeling, iterator, &next2, ii, 1);
         }
-        // Take the fist iterator found and move +Z
-        if (ii != 0 || threeDimFlag)
-        { // stupid after the fact way of dealing with 2d AMR input.
-          this->GetNeighborIterator(&next2, &next, (ii + 2) % 3, 1, ii, 0, (ii + 1) % 3, 0);
-          if (next2.VolumeFractionPointer == 0 ||
-            next2.VolumeFractionPointer[0] < this->scaledMaterialFractionThreshold)
-          {
-            // Neighbor is outside of fragment.  Make a face.
-            this->CreateFace(&iterator, &next2, ii, 1);
-          }
-          else if (next2.FragmentIdPointer[0] == -1)
-          { // We have not visited this neighbor yet. Mark the voxel and recurse.
-            *(next2.FragmentIdPointer) = this->FragmentId;
-            queue->Push(&next2);
-          }
-          else
-          { // The last case is that we have already visited this voxel and it
-            // is in the same fragment.
-            this->AddEquivalence(&next2, &next);
-          }
+        else
+        { // Mark the voxel and recurse, or make it equivalent.
+          this->ConnectNeighbor(labeling, iterator, &next2);
         }
-        // To get the +Y+Z start with the +Z iterator and move +Y put results in "next"
-        if (next2.Block && threeDimFlag)
+      }
+      // To get the +Y+Z start with the +Z iterator and move +Y put results in "next"
+      if (next2.Block && threeDimFlag)
+      {
+        this->GetNeighborIterator(&next, &next2, (ii + 1) % 3, 1, (ii + 2) % 3, 0, ii, 0);
+        if (next.VolumeFractionPointer == 0 ||
+          next.VolumeFractionPointer[0] < this->scaledMaterialFractionThreshold)
         {
-          this->GetNeighborIterator(&next, &next2, (ii + 1) % 3, 1, (ii + 2) % 3, 0, ii, 0);
-          if (next.VolumeFractionPointer == 0 ||
-            next.VolumeFractionPointer[0] < this->scaledMaterialFractionThreshold)
-          {
-            // Neighbor is outside of fragment.  Make a face.
-            this->CreateFace(&iterator, &next, ii, 1);
-          }
-          else if (next.FragmentIdPointer[0] == -1)
-          { // We have not visited this neighbor yet. Mark the voxel and recurse.
-            *(next.FragmentIdPointer) = this->FragmentId;
-            queue->Push(&next);
-          }
-          else
-          { // The last case is that we have already visited this voxel and it
-            // is in the same fragment.
-            this->AddEquivalence(&next2, &next);
-          }
+          // Neighbor is outside of fragment.  Make a face.
+          this->CreateFace(labeling, iterator, &next, ii, 1);
+        }
+        else
+        { // Mark the voxel and recurse, or make it equivalent.
+          this->ConnectNeighbor(labeling, iterator, &next);
         }
       }
     }
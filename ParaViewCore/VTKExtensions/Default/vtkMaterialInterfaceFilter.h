@@ -21,6 +21,16 @@
  * a particle index as part of the cell data of the output.  It computes
  * the volume of each particle from the volume fraction.
  *
+ * When UseMultithreading is on, the blocks of each process are labeled
+ * concurrently using vtkSMPTools. Every thread only floods the voxels of the
+ * block it labels, with its own accumulators, and gives the fragments it finds
+ * ids local to the block. Once all blocks are labeled, the ids are offset in
+ * block order and the connections across block boundaries, and into ghost
+ * blocks, are turned into equivalences. Since equivalent fragments are
+ * numbered by their smallest id, the resolved fragment ids are the same as
+ * the ones of the serial labeling and integrated quantities only differ by
+ * the order in which they are summed.
+ *
  * This will turn on validation and debug i/o of the filter.
  * \code{.cpp}
  * #define vtkMaterialInterfaceFilterDEBUG
@@ -61,6 +71,9 @@ class vtkImplicitFunction;
 class vtkMaterialInterfaceLevel;
 class vtkMaterialInterfaceFilterBlock;
 class vtkMaterialInterfaceFilterIterator;
+class vtkMaterialInterfaceFilterBlockFragments;
+class vtkMaterialInterfaceFilterLabeling;
+class vtkMaterialInterfaceFilterProcessBlocks;
 class vtkMaterialInterfaceEquivalenceSet;
 class vtkMaterialInterfaceFilterRingBuffer;
 class vtkMaterialInterfacePieceLoading;
@@ -327,6 +340,16 @@ public:
   vtkGetMacro(InvertVolumeFraction, int);
   //@}
 
+  //@{
+  /**
+   * When on, the blocks of each process are labeled by multiple threads.
+   * Fragment ids are the same either way. Default is on.
+   */
+  vtkSetMacro(UseMultithreading, bool);
+  vtkGetMacro(UseMultithreading, bool);
+  vtkBooleanMacro(UseMultithreading, bool);
+  //@}
+
   /**
    * Return the mtime also considering the locator and clip function.
    */
@@ -348,22 +371,40 @@ protected:
     std::vector<std::string>& integratedArrayNames);
   // Create a new fragment/piece.
   vtkPolyData* NewFragmentMesh();
+  // Label all the input blocks, serially or with multiple threads.
+  void ProcessBlocks();
+  // Set up the accumulators of a labeling for this pass.
+  void InitializeLabeling(vtkMaterialInterfaceFilterLabeling* labeling);
   // Process each cell, looking for fragments.
-  int ProcessBlock(int blockId);
+  int ProcessBlock(vtkMaterialInterfaceFilterLabeling* labeling, int blockId);
+  // Move the fragments found by ProcessBlock to the fragment arrays,
+  // giving them the next local ids.
+  void AddBlockFragments(vtkMaterialInterfaceFilterBlockFragments* fragments);
+  // Find the neighbors of a labeled block which are in other blocks.
+  void ConnectBlockBoundary(vtkMaterialInterfaceFilterLabeling* labeling, int blockId);
+  // Turn the connections found by ConnectBlockBoundary into equivalences,
+  // flooding ghost blocks.
+  void ConnectBlockNeighbors(vtkMaterialInterfaceFilterLabeling* labeling,
+    vtkMaterialInterfaceFilterBlockFragments* fragments);
   // Cell has been identified as inside the fragment. Integrate, and
   // generate fragment surface etc...
-  void ConnectFragment(vtkMaterialInterfaceFilterRingBuffer* iterator);
+  void ConnectFragment(vtkMaterialInterfaceFilterLabeling* labeling);
+  void ConnectNeighbors(
+    vtkMaterialInterfaceFilterLabeling* labeling, vtkMaterialInterfaceFilterIterator* iterator);
+  void ConnectNeighbor(vtkMaterialInterfaceFilterLabeling* labeling,
+    vtkMaterialInterfaceFilterIterator* iterator, vtkMaterialInterfaceFilterIterator* neighbor);
   void GetNeighborIterator(vtkMaterialInterfaceFilterIterator* next,
     vtkMaterialInterfaceFilterIterator* iterator, int axis0, int maxFlag0, int axis1, int maxFlag1,
     int axis2, int maxFlag2);
   void GetNeighborIteratorPad(vtkMaterialInterfaceFilterIterator* next,
     vtkMaterialInterfaceFilterIterator* iterator, int axis0, int maxFlag0, int axis1, int maxFlag1,
     int axis2, int maxFlag2);
-  void CreateFace(vtkMaterialInterfaceFilterIterator* in, vtkMaterialInterfaceFilterIterator* out,
-    int axis, int outMaxFlag);
+  void CreateFace(vtkMaterialInterfaceFilterLabeling* labeling,
+    vtkMaterialInterfaceFilterIterator* in, vtkMaterialInterfaceFilterIterator* out, int axis,
+    int outMaxFlag);
   int ComputeDisplacementFactors(vtkMaterialInterfaceFilterIterator* pointNeighborIterators[8],
     double displacmentFactors[3], int rootNeighborIdx, int faceAxis);
-  int SubVoxelPositionCorner(double* point,
+  int SubVoxelPositionCorner(vtkMaterialInterfaceFilterLabeling* labeling, double* point,
     vtkMaterialInterfaceFilterIterator* pointNeighborIterators[8], int rootNeighborIdx,
     int faceAxis);
   void FindPointNeighbors(vtkMaterialInterfaceFilterIterator* iteratorMin0,
@@ -525,10 +566,6 @@ protected:
   char* MaterialFractionArrayName;
   vtkSetStringMacro(MaterialFractionArrayName);
 
-  // while processing a material array this holds
-  // a pointer to the output poly data
-  // data set
-  vtkPolyData* CurrentFragmentMesh;
   // As pieces/fragments are found they are stored here
   // until resolution.
   std::vector<vtkPolyData*> FragmentMeshes;
@@ -538,23 +575,18 @@ protected:
   // all of the supported operations.
   /// class vtkMaterialInterfaceFilterIntegrator
   ///{
-  // Local id of current fragment
+  // Local id of the next fragment. The accumulators of the current
+  // fragment are in vtkMaterialInterfaceFilterLabeling.
   int FragmentId;
-  // Accumulator for the volume of the current fragment.
-  double FragmentVolume;
   // Fragment volumes indexed by the fragment id. It's a local
   // per-process indexing until fragments have been resolved
   vtkDoubleArray* FragmentVolumes;
 
   // Min and max depth of crater.
   // These are only computed when the clip plane is on.
-  double ClipDepthMin;
-  double ClipDepthMax;
   vtkDoubleArray* ClipDepthMinimums;
   vtkDoubleArray* ClipDepthMaximums;
 
-  // Accumulator for moments of the current fragment
-  std::vector<double> FragmentMoment; // =(Myz, Mxz, Mxy, m)
   // Moments indexed by fragment id
   vtkDoubleArray* FragmentMoments;
   // Centers of fragment AABBs, only computed if moments are not
@@ -563,8 +595,6 @@ protected:
   bool ComputeMoments;
 
   // Weighted average, where weights correspond to fragment volume.
-  // Accumulators one for each array to average, scalar or vector
-  std::vector<std::vector<double> > FragmentVolumeWtdAvg;
   // weighted averages indexed by fragment id.
   std::vector<vtkDoubleArray*> FragmentVolumeWtdAvgs;
   // number of arrays for which to compute the weighted average
@@ -573,8 +603,6 @@ protected:
   std::vector<std::string> VolumeWtdAvgArrayNames;
 
   // Weighted average, where weights correspond to fragment mass.
-  // Accumulators one for each array to average, scalar or vector
-  std::vector<std::vector<double> > FragmentMassWtdAvg;
   // weighted averages indexed by fragment id.
   std::vector<vtkDoubleArray*> FragmentMassWtdAvgs;
   // number of arrays for which to compute the weighted average
@@ -591,8 +619,6 @@ protected:
   int NToIntegrate;
 
   // Sum of data over the fragment.
-  // Accumulators, one for each array to sum
-  std::vector<std::vector<double> > FragmentSum;
   // sums indexed by fragment id.
   std::vector<vtkDoubleArray*> FragmentSums;
   // number of arrays for which to compute the weighted average
@@ -656,20 +682,15 @@ protected:
   // It could be changed into the primary storage of blocks.
   std::vector<vtkMaterialInterfaceLevel*> Levels;
 
-  // Ivars for computing the point on corners and edges of a face.
-  vtkMaterialInterfaceFilterIterator* FaceNeighbors;
-  // Permutation of the neighbors. Axis0 normal to face.
-  int faceAxis0;
-  int faceAxis1;
-  int faceAxis2;
-  double FaceCornerPoints[12];
-  double FaceEdgePoints[12];
-  int FaceEdgeFlags[4];
+  // Compute the point on corners and edges of a face. The results are
+  // stored in the labeling.
   // outMaxFlag implies out is positive direction of axis.
-  void ComputeFacePoints(vtkMaterialInterfaceFilterIterator* in,
-    vtkMaterialInterfaceFilterIterator* out, int axis, int outMaxFlag);
-  void ComputeFaceNeighbors(vtkMaterialInterfaceFilterIterator* in,
-    vtkMaterialInterfaceFilterIterator* out, int axis, int outMaxFlag);
+  void ComputeFacePoints(vtkMaterialInterfaceFilterLabeling* labeling,
+    vtkMaterialInterfaceFilterIterator* in, vtkMaterialInterfaceFilterIterator* out, int axis,
+    int outMaxFlag);
+  void ComputeFaceNeighbors(vtkMaterialInterfaceFilterLabeling* labeling,
+    vtkMaterialInterfaceFilterIterator* in, vtkMaterialInterfaceFilterIterator* out, int axis,
+    int outMaxFlag);
 
   long ComputeProximity(const int faceIdx[3], int faceLevel, const int ext[6], int refLevel);
 
@@ -713,6 +734,8 @@ protected:
   // By default set to 1
   unsigned char BlockGhostLevel;
 
+  bool UseMultithreading;
+
 #ifdef vtkMaterialInterfaceFilterPROFILE
   // Lets profile to see what takes the most time for large number of processes.
   vtkSmartPointer<vtkTimerLog> InitializeBlocksTimer;
@@ -724,6 +747,8 @@ protected:
 #endif
 
 private:
+  friend class vtkMaterialInterfaceFilterProcessBlocks;
+
   vtkMaterialInterfaceFilter(const vtkMaterialInterfaceFilter&) = delete;
   void operator=(const vtkMaterialInterfaceFilter&) = delete;
 };
@@ -27,14 +27,224 @@
 #include "vtkInformationVector.h"
 #include "vtkPointData.h"
 #include "vtkPoints.h"
+#include "vtkSMPTools.h"
+#include "vtkUnsignedCharArray.h"
 
 #include "vtkMultiProcessController.h"
 
+#include <algorithm>
+#include <vector>
+
 vtkStandardNewMacro(vtkMinMax);
 
 template <class T>
 void vtkMinMaxExecute(vtkMinMax* self, int numComp, int compIdx, T* idata, T* odata);
 
+namespace
+{
+// Upper bound on the number of chunks an array is split into. Each chunk
+// computes its own partial result and the partials are combined in chunk
+// order, so results (sums in particular) do not depend on the number of
+// threads.
+const vtkIdType vtkMinMaxMaximumNumberOfChunks = 256;
+
+// Tuples per chunk below which splitting an array is not worth it.
+const vtkIdType vtkMinMaxMinimumChunkSize = 16384;
+
+struct vtkMinMaxMinOp
+{
+  template <class T>
+  static void Apply(T& out, const T& in)
+  {
+    out = in < out ? in : out;
+  }
+};
+
+struct vtkMinMaxMaxOp
+{
+  template <class T>
+  static void Apply(T& out, const T& in)
+  {
+    out = in > out ? in : out;
+  }
+};
+
+struct vtkMinMaxSumOp
+{
+  template <class T>
+  static void Apply(T& out, const T& in)
+  {
+    out += in;
+  }
+};
+
+//-----------------------------------------------------------------------------
+// Computes the partial result of each chunk of tuples of a typed array.
+template <class T>
+class vtkMinMaxArrayFunctor
+{
+public:
+  vtkMinMaxArrayFunctor(const T* input, vtkIdType numTuples, int numComp,
+    vtkUnsignedCharArray* ghosts, int operation, vtkIdType numChunks)
+    : Input(input)
+    , NumberOfTuples(numTuples)
+    , NumberOfComponents(numComp)
+    , Ghosts(ghosts ? ghosts->GetPointer(0) : NULL)
+    , Operation(operation)
+    , NumberOfChunks(numChunks)
+    , Partials(numChunks * numComp)
+    , Valid(numChunks, 0)
+  {
+  }
+
+  void operator()(vtkIdType firstChunk, vtkIdType lastChunk)
+  {
+    for (vtkIdType chunk = firstChunk; chunk < lastChunk; ++chunk)
+    {
+      const vtkIdType begin = chunk * this->NumberOfTuples / this->NumberOfChunks;
+      const vtkIdType end = (chunk + 1) * this->NumberOfTuples / this->NumberOfChunks;
+      switch (this->Operation)
+      {
+        case vtkMinMax::MIN:
+          this->Execute<vtkMinMaxMinOp>(chunk, begin, end);
+          break;
+        case vtkMinMax::MAX:
+          this->Execute<vtkMinMaxMaxOp>(chunk, begin, end);
+          break;
+        default:
+          this->Execute<vtkMinMaxSumOp>(chunk, begin, end);
+          break;
+      }
+    }
+  }
+
+  vtkIdType GetNumberOfChunks() const { return this->NumberOfChunks; }
+  bool IsValid(vtkIdType chunk) const { return this->Valid[chunk] != 0; }
+  T* GetPartial(vtkIdType chunk) { return &this->Partials[chunk * this->NumberOfComponents]; }
+
+private:
+  template <class OpT>
+  void Execute(vtkIdType chunk, vtkIdType begin, vtkIdType end)
+  {
+    const int numComp = this->NumberOfComponents;
+    T* partial = this->GetPartial(chunk);
+
+    // skip cell and point attributes that don't belong to me
+    if (this->Ghosts)
+    {
+      while (begin < end && (this->Ghosts[begin] & vtkDataSetAttributes::DUPLICATECELL))
+      {
+        ++begin;
+      }
+    }
+    if (begin == end)
+    {
+      return;
+    }
+
+    std::copy(this->Input + begin * numComp, this->Input + (begin + 1) * numComp, partial);
+    this->Valid[chunk] = 1;
+
+    if (this->Ghosts)
+    {
+      for (vtkIdType idx = begin + 1; idx < end; ++idx)
+      {
+        if (this->Ghosts[idx] & vtkDataSetAttributes::DUPLICATECELL)
+        {
+          continue;
+        }
+        const T* in = this->Input + idx * numComp;
+        for (int jdx = 0; jdx < numComp; ++jdx)
+        {
+          OpT::Apply(partial[jdx], in[jdx]);
+        }
+      }
+    }
+    else if (numComp == 1)
+    {
+      // common case, a tight loop the compiler can vectorize
+      T value = partial[0];
+      for (vtkIdType idx = begin + 1; idx < end; ++idx)
+      {
+        OpT::Apply(value, this->Input[idx]);
+      }
+      partial[0] = value;
+    }
+    else
+    {
+      for (vtkIdType idx = begin + 1; idx < end; ++idx)
+      {
+        const T* in = this->Input + idx * numComp;
+        for (int jdx = 0; jdx < numComp; ++jdx)
+        {
+          OpT::Apply(partial[jdx], in[jdx]);
+        }
+      }
+    }
+  }
+
+  const T* Input;
+  vtkIdType NumberOfTuples;
+  int NumberOfComponents;
+  const unsigned char* Ghosts;
+  int Operation;
+  vtkIdType NumberOfChunks;
+  std::vector<T> Partials;
+  std::vector<char> Valid;
+};
+
+//-----------------------------------------------------------------------------
+template <class T>
+void vtkMinMaxOperateOnArray(vtkMinMax* self, int compIdx, vtkIdType numTuples, int numComp,
+  vtkUnsignedCharArray* ghosts, T* idata, T* odata)
+{
+  const vtkIdType numChunks = std::max<vtkIdType>(
+    std::min(numTuples / vtkMinMaxMinimumChunkSize, vtkMinMaxMaximumNumberOfChunks), 1);
+  vtkMinMaxArrayFunctor<T> functor(
+    idata, numTuples, numComp, ghosts, self->GetOperation(), numChunks);
+  if (numChunks > 1)
+  {
+    vtkSMPTools::For(0, numChunks, 1, functor);
+  }
+  else
+  {
+    functor(0, 1);
+  }
+
+  // fold the partial results into the output, honoring the first pass flags
+  for (vtkIdType chunk = 0; chunk < numChunks; ++chunk)
+  {
+    if (functor.IsValid(chunk))
+    {
+      vtkMinMaxExecute(self, numComp, compIdx, functor.GetPartial(chunk), odata);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Sets the components that were never initialized to zero, instead of
+// leaving whatever the output array was allocated with.
+void vtkMinMaxResetUninitialized(vtkFieldData* ofd, const char* firstPasses)
+{
+  int compIdx = 0;
+  const int numArrays = ofd->GetNumberOfArrays();
+  for (int idx = 0; idx < numArrays; idx++)
+  {
+    vtkAbstractArray* oa = ofd->GetAbstractArray(idx);
+    vtkDataArray* da = vtkDataArray::SafeDownCast(oa);
+    const int numComp = oa->GetNumberOfComponents();
+    for (int jdx = 0; da && jdx < numComp; jdx++)
+    {
+      if (firstPasses[compIdx + jdx])
+      {
+        da->SetComponent(0, jdx, 0.0);
+      }
+    }
+    compIdx += numComp;
+  }
+}
+}
+
 //-----------------------------------------------------------------------------
 vtkMinMax::vtkMinMax()
 {
@@ -234,6 +444,9 @@ int vtkMinMax::RequestData(vtkInformation* vtkNotUsed(reqInfo), vtkInformationVe
     }
   }
 
+  vtkMinMaxResetUninitialized(ocd, this->CFirstPass);
+  vtkMinMaxResetUninitialized(opd, this->PFirstPass);
+
   return 1;
 }
 
@@ -293,37 +506,29 @@ void vtkMinMax::OperateOnArray(vtkAbstractArray* ia, vtkAbstractArray* oa)
   int datatype = ia->GetDataType();
 
   this->Name = ia->GetName();
+  this->Idx = numTuples;
 
-  // go over each tuple
-  for (vtkIdType idx = 0; idx < numTuples; idx++)
+  if (numTuples == 0)
   {
-    this->Idx = idx;
-
-    if ((this->GhostArray != NULL) &&
-      (this->GhostArray->GetValue(idx) & vtkDataSetAttributes::DUPLICATECELL))
-    {
-      // skip cell and point attributes that don't belong to me
-      continue;
-    }
-
-    // get type agnostic access to the tuple
-    void* idata = ia->GetVoidPointer(idx * numComp);
-    void* odata = oa->GetVoidPointer(0);
+    return;
+  }
 
-    // go over each component in the tuple (jdx)
-    // perform odata[jdx] = operation(idata[jdx],odata[jdx])
-    switch (datatype)
-    {
-      vtkTemplateMacro(vtkMinMaxExecute(this, numComp, this->ComponentIdx,
-        static_cast<VTK_TT*>(idata), static_cast<VTK_TT*>(odata)));
+  // get type agnostic access to the whole array, the typed kernel goes over
+  // each tuple and component and performs
+  // odata[jdx] = operation(idata[jdx],odata[jdx])
+  void* idata = ia->GetVoidPointer(0);
+  void* odata = oa->GetVoidPointer(0);
+  switch (datatype)
+  {
+    vtkTemplateMacro(vtkMinMaxOperateOnArray(this, this->ComponentIdx, numTuples, numComp,
+      this->GhostArray, static_cast<VTK_TT*>(idata), static_cast<VTK_TT*>(odata)));
 
-      // if you can make an operator for things like strings etc,
-      // put the cases for those strings here
+    // if you can make an operator for things like strings etc,
+    // put the cases for those strings here
 
-      default:
-        vtkErrorMacro(<< "Unknown data type refusing to operate on this array");
-        this->MismatchOccurred = 1;
-    }
+    default:
+      vtkErrorMacro(<< "Unknown data type refusing to operate on this array");
+      this->MismatchOccurred = 1;
   }
 }
 
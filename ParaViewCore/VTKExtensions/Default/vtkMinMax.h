@@ -27,6 +27,10 @@
  * runs this filter REQUIRES ghost arrays to skip redundant
  * information. The output of this filter will always be a single vtkPolyData
  * that contains exactly one point and one cell (a VTK_VERTEX).
+ *
+ * Arrays are processed with typed kernels that run over tuple ranges in
+ * parallel (vtkSMPTools). Components for which no value was found, e.g.
+ * because all tuples are ghosts, are set to zero and flagged in FirstPasses.
 */
 
 #ifndef vtkMinMax_h
@@ -73,7 +77,8 @@ public:
   //@{
   /**
    * Contains a flag for each component of each (Point or Cell) array
-   * that indicates if any of the results were never initialized.
+   * that indicates if any of the results were never initialized. These
+   * results are set to zero.
    */
   vtkGetStringMacro(FirstPasses);
   void FlagsForPoints();
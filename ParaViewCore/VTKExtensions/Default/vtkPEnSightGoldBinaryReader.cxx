@@ -17,17 +17,134 @@
 #include <vtksys/SystemTools.hxx>
 
 #include <ctype.h>
+#include <limits>
+#include <streambuf>
 #include <string>
 
+#ifdef _WIN32
+#include "vtkWindows.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 vtkStandardNewMacro(vtkPEnSightGoldBinaryReader);
 
 // This is half the precision of an int.
 #define MAXIMUM_PART_ID 65536
 
+//----------------------------------------------------------------------------
+// Read only stream buffer over a memory mapped file. Seeking only moves the
+// get pointer and reading copies from the mapping, so neither goes through
+// the file system.
+class vtkPEnSightGoldBinaryReader::vtkMappedFile : public std::streambuf
+{
+public:
+  vtkMappedFile()
+    : Data(NULL)
+    , Size(0)
+  {
+  }
+
+  ~vtkMappedFile() override
+  {
+    if (this->Data)
+    {
+#ifdef _WIN32
+      UnmapViewOfFile(this->Data);
+#else
+      munmap(this->Data, this->Size);
+#endif
+    }
+  }
+
+  // Returns false if the file cannot be mapped, e.g. when it is empty or
+  // larger than the address space.
+  bool Open(const char* filename, vtkTypeInt64 size)
+  {
+    const vtkTypeInt64 maximumSize = std::numeric_limits<std::ptrdiff_t>::max();
+    if (size <= 0 || size > maximumSize)
+    {
+      return false;
+    }
+#ifdef _WIN32
+    HANDLE file = CreateFileA(
+      filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+      return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!mapping)
+    {
+      return false;
+    }
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!data)
+    {
+      return false;
+    }
+#else
+    int fd = ::open(filename, O_RDONLY);
+    if (fd < 0)
+    {
+      return false;
+    }
+    void* data = mmap(NULL, static_cast<size_t>(size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+      return false;
+    }
+#endif
+    this->Data = static_cast<char*>(data);
+    this->Size = static_cast<size_t>(size);
+    this->setg(this->Data, this->Data, this->Data + this->Size);
+    return true;
+  }
+
+protected:
+  pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override
+  {
+    if (!(which & std::ios_base::in))
+    {
+      return pos_type(off_type(-1));
+    }
+    off_type pos = off;
+    if (dir == std::ios_base::cur)
+    {
+      pos += this->gptr() - this->eback();
+    }
+    else if (dir == std::ios_base::end)
+    {
+      pos += static_cast<off_type>(this->Size);
+    }
+    if (pos < 0 || pos > static_cast<off_type>(this->Size))
+    {
+      return pos_type(off_type(-1));
+    }
+    this->setg(this->eback(), this->eback() + pos, this->egptr());
+    return pos_type(pos);
+  }
+
+  pos_type seekpos(pos_type pos, std::ios_base::openmode which) override
+  {
+    return this->seekoff(off_type(pos), std::ios_base::beg, which);
+  }
+
+private:
+  char* Data;
+  size_t Size;
+};
+
 //----------------------------------------------------------------------------
 vtkPEnSightGoldBinaryReader::vtkPEnSightGoldBinaryReader()
 {
   this->IFile = NULL;
+  this->MappedFile = NULL;
   this->FileSize = 0;
   this->Fortran = 0;
   this->NodeIdsListed = 0;
@@ -47,12 +164,7 @@ vtkPEnSightGoldBinaryReader::vtkPEnSightGoldBinaryReader()
 //----------------------------------------------------------------------------
 vtkPEnSightGoldBinaryReader::~vtkPEnSightGoldBinaryReader()
 {
-  if (this->IFile)
-  {
-    this->IFile->close();
-    delete this->IFile;
-    this->IFile = NULL;
-  }
+  this->CloseFile();
   delete[] this->FloatBuffer[2];
   delete[] this->FloatBuffer[1];
   delete[] this->FloatBuffer[0];
@@ -69,12 +181,7 @@ int vtkPEnSightGoldBinaryReader::OpenFile(const char* filename)
   }
 
   // Close file from any previous image
-  if (this->IFile)
-  {
-    this->IFile->close();
-    delete this->IFile;
-    this->IFile = NULL;
-  }
+  this->CloseFile();
 
   // Open the new file
   vtkDebugMacro(<< "Opening file " << filename);
@@ -84,11 +191,28 @@ int vtkPEnSightGoldBinaryReader::OpenFile(const char* filename)
     // Find out how big the file is.
     this->FileSize = (long)(fs.st_size);
 
+    if (this->UseMemoryMapping)
+    {
+      vtkMappedFile* mappedFile = new vtkMappedFile;
+      if (mappedFile->Open(filename, static_cast<vtkTypeInt64>(fs.st_size)))
+      {
+        this->MappedFile = mappedFile;
+        this->IFile = new istream(mappedFile);
+      }
+      else
+      {
+        delete mappedFile;
+        vtkDebugMacro(<< "Could not map " << filename << ", reading it as a stream.");
+      }
+    }
+    if (!this->IFile)
+    {
 #ifdef _WIN32
-    this->IFile = new ifstream(filename, ios::in | ios::binary);
+      this->IFile = new ifstream(filename, ios::in | ios::binary);
 #else
-    this->IFile = new ifstream(filename, ios::in);
+      this->IFile = new ifstream(filename, ios::in);
 #endif
+    }
   }
   else
   {
@@ -165,6 +289,16 @@ int vtkPEnSightGoldBinaryReader::OpenFile(const char* filename)
   return 1;
 }
 
+//----------------------------------------------------------------------------
+void vtkPEnSightGoldBinaryReader::CloseFile()
+{
+  // The stream must go before the buffer it reads from.
+  delete this->IFile;
+  this->IFile = NULL;
+  delete this->MappedFile;
+  this->MappedFile = NULL;
+}
+
 //----------------------------------------------------------------------------
 int vtkPEnSightGoldBinaryReader::InitializeFile(const char* fileName)
 {
@@ -390,24 +524,15 @@ int vtkPEnSightGoldBinaryReader::ReadGeometryFile(
       if (lineRead < 0)
       {
         free(name);
-        if (this->IFile)
-        {
-          this->IFile->close();
-          delete this->IFile;
-          this->IFile = NULL;
-        }
+        this->CloseFile();
         return 0;
       }
     }
     free(name);
   }
 
-  if (this->IFile)
-  {
-    this->IFile->close();
-    delete this->IFile;
-    this->IFile = NULL;
-  }
+  this->CacheNextTimeStepOffset(fileName, timeStep, line);
+  this->CloseFile();
   if (lineRead < 0)
   {
     return 0;
@@ -535,18 +660,27 @@ int vtkPEnSightGoldBinaryReader::SkipTimeStep()
 
   if (lineRead < 0)
   {
-    if (this->IFile)
-    {
-      this->IFile->close();
-      delete this->IFile;
-      this->IFile = NULL;
-    }
+    this->CloseFile();
     return 0;
   }
 
   return 1;
 }
 
+//----------------------------------------------------------------------------
+void vtkPEnSightGoldBinaryReader::CacheNextTimeStepOffset(
+  const char* fileName, int timeStep, const char* line)
+{
+  if (!this->UseFileSets || !this->IFile || !this->IFile->good() ||
+    strncmp(line, "END TIME STEP", 13) != 0)
+  {
+    return;
+  }
+  // timeStep starts at 1 while the cached offsets start at 0, so the offset
+  // of the next time step is cached at timeStep.
+  this->FileOffsets[fileName][timeStep] = this->IFile->tellg();
+}
+
 //----------------------------------------------------------------------------
 int vtkPEnSightGoldBinaryReader::SkipStructuredGrid(char line[256])
 {
@@ -1278,12 +1412,7 @@ int vtkPEnSightGoldBinaryReader::ReadMeasuredGeometryFile(
   delete[] yCoords;
   delete[] zCoords;
 
-  if (this->IFile)
-  {
-    this->IFile->close();
-    delete this->IFile;
-    this->IFile = NULL;
-  }
+  this->CloseFile();
   return 1;
 }
 
@@ -1432,12 +1561,7 @@ int vtkPEnSightGoldBinaryReader::ReadScalarsPerNode(const char* fileName, const
       scalars->Delete();
       delete[] scalarsRead;
     }
-    if (this->IFile)
-    {
-      this->IFile->close();
-      delete this->IFile;
-      this->IFile = NULL;
-    }
+    this->CloseFile();
     return 1;
   }
 
@@ -1499,12 +1623,8 @@ int vtkPEnSightGoldBinaryReader::ReadScalarsPerNode(const char* fileName, const
     lineRead = this->ReadLine(line);
   }
 
-  if (this->IFile)
-  {
-    this->IFile->close();
-    delete this->IFile;
-    this->IFile = NULL;
-  }
+  this->CacheNextTimeStepOffset(fileName, timeStep, line);
+  this->CloseFile();
   return 1;
 }
 
@@ -1653,12 +1773,7 @@ int vtkPEnSightGoldBinaryReader::ReadVectorsPerNode(const char* fileName, const
       }
       vectors->Delete();
     }
-    if (this->IFile)
-    {
-      this->IFile->close();
-      delete this->IFile;
-      this->IFile = NULL;
-    }
+    this->CloseFile();
     return 1;
   }
 
@@ -1710,12 +1825,8 @@ int vtkPEnSightGoldBinaryReader::ReadVectorsPerNode(const char* fileName, const
     lineRead = this->ReadLine(line);
   }
 
-  if (this->IFile)
-  {
-    this->IFile->close();
-    delete this->IFile;
-    this->IFile = NULL;
-  }
+  this->CacheNextTimeStepOffset(fileName, timeStep, line);
+  this->CloseFile();
 
   return 1;
 }
@@ -1873,12 +1984,8 @@ int vtkPEnSightGoldBinaryReader::ReadTensorsPerNode(const char* fileName, const
     lineRead = this->ReadLine(line);
   }
 
-  if (this->IFile)
-  {
-    this->IFile->close();
-    delete this->IFile;
-    this->IFile = NULL;
-  }
+  this->CacheNextTimeStepOffset(fileName, timeStep, line);
+  this->CloseFile();
 
   return 1;
 }
@@ -1981,12 +2088,7 @@ int vtkPEnSightGoldBinaryReader::ReadScalarsPerElement(const char* fileName,
               if (elementType == -1)
               {
                 vtkErrorMacro("Unknown element type \"" << line << "\"");
-                if (this->IFile)
-                {
-                  this->IFile->close();
-                  delete this->IFile;
-                  this->IFile = NULL;
-                }
+                this->CloseFile();
                 return 0;
               }
               idx = this->UnstructuredPartIds->IsId(realId);
@@ -2068,12 +2170,7 @@ int vtkPEnSightGoldBinaryReader::ReadScalarsPerElement(const char* fileName,
           if (elementType == -1)
           {
             vtkErrorMacro("Unknown element type \"" << line << "\"");
-            if (this->IFile)
-            {
-              this->IFile->close();
-              delete this->IFile;
-              this->IFile = NULL;
-            }
+            this->CloseFile();
             if (component == 0)
             {
               scalars->Delete();
@@ -2130,12 +2227,8 @@ int vtkPEnSightGoldBinaryReader::ReadScalarsPerElement(const char* fileName,
     }
   }
 
-  if (this->IFile)
-  {
-    this->IFile->close();
-    delete this->IFile;
-    this->IFile = NULL;
-  }
+  this->CacheNextTimeStepOffset(fileName, timeStep, line);
+  this->CloseFile();
   return 1;
 }
 
@@ -2379,12 +2472,8 @@ int vtkPEnSightGoldBinaryReader::ReadVectorsPerElement(const char* fileName,
     }
   }
 
-  if (this->IFile)
-  {
-    this->IFile->close();
-    delete this->IFile;
-    this->IFile = NULL;
-  }
+  this->CacheNextTimeStepOffset(fileName, timeStep, line);
+  this->CloseFile();
   return 1;
 }
 
@@ -2649,12 +2738,8 @@ int vtkPEnSightGoldBinaryReader::ReadTensorsPerElement(const char* fileName,
     }
   }
 
-  if (this->IFile)
-  {
-    this->IFile->close();
-    delete this->IFile;
-    this->IFile = NULL;
-  }
+  this->CacheNextTimeStepOffset(fileName, timeStep, line);
+  this->CloseFile();
   return 1;
 }
 
@@ -17,6 +17,18 @@
  *
  * Parallel vtkEnSightGoldBinaryReader.
  *
+ * Files are memory mapped when possible, so that the many seeks done to skip
+ * over the parts and the time steps that are not read by this process do not
+ * go through the file system. If a file cannot be mapped (e.g. it does not fit
+ * in the address space), or if UseMemoryMapping is off, it is read through an
+ * ifstream instead. The offsets of the time steps found in a file set are
+ * cached, including the one following the last time step read, so that reading
+ * consecutive time steps does not skip over the previous ones again. The
+ * offsets of the parts are not indexed: every part of a time step goes through
+ * the id maps that distribute points and cells across processes, so the parts
+ * are always read or skipped in order and an index would never be used to seek
+ * to one of them.
+ *
  * \verbatim
  * This file has been developed as part of the CARRIOCAS (Distributed
  * computation over ultra high optical internet network ) project (
@@ -53,6 +65,9 @@ protected:
   // Returns 1 if successful.  Sets file size as a side action.
   int OpenFile(const char* filename);
 
+  // Closes the file opened by OpenFile, if any.
+  void CloseFile();
+
   // Returns 1 if successful.  Handles constructing the filename, opening the file and checking
   // if it's binary
   int InitializeFile(const char* filename);
@@ -201,11 +216,21 @@ protected:
   int SkipImageData(char line[256]);
   //@}
 
+  /**
+   * Caches the offset of the time step following timeStep in a file set. The
+   * file must be positioned right after the given line, which is the last one
+   * read for timeStep.
+   */
+  void CacheNextTimeStepOffset(const char* fileName, int timeStep, const char* line);
+
   int NodeIdsListed;
   int ElementIdsListed;
   int Fortran;
 
-  ifstream* IFile;
+  istream* IFile;
+  // The memory mapped file IFile reads from, if any.
+  class vtkMappedFile;
+  vtkMappedFile* MappedFile;
   // The size of the file could be used to choose byte order.
   long FileSize;
 
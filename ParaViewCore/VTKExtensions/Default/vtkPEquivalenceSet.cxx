@@ -13,9 +13,12 @@
 
 =========================================================================*/
 #include "vtkPEquivalenceSet.h"
-#include "vtkIntArray.h"
+#include "vtkIdTypeArray.h"
 #include "vtkMultiProcessController.h"
 #include "vtkObjectFactory.h"
+#include "vtkUnsignedCharArray.h"
+
+#include <vector>
 
 vtkStandardNewMacro(vtkPEquivalenceSet);
 
@@ -32,55 +35,81 @@ void vtkPEquivalenceSet::PrintSelf(ostream& os, vtkIndent indent)
   this->Superclass::PrintSelf(os, indent);
 }
 
-int vtkPEquivalenceSet::ResolveEquivalences()
+vtkIdType vtkPEquivalenceSet::ResolveEquivalences()
 {
   vtkMultiProcessController* controller = vtkMultiProcessController::GetGlobalController();
   int myProc = controller->GetLocalProcessId();
   int numProcs = controller->GetNumberOfProcesses();
 
-  vtkIntArray* workingSet = vtkIntArray::New();
-  workingSet->SetNumberOfComponents(1);
-
+  // Reduce the equivalences to process 0 along a tree. At each step, the
+  // upper half of the processes that still hold equivalences sends them to
+  // the lower half. Rounding the half up keeps every process in the tree
+  // when their number is not a power of 2.
   int tag = 475893745;
-  int pivot = (numProcs + 1) / 2;
-  while (pivot > 0 && myProc < (pivot * 2))
+  int numActive = numProcs;
+  while (numActive > 1 && myProc < numActive)
   {
-    int tuples;
+    int pivot = (numActive + 1) / 2;
+    // header: number of members and number of equivalences.
+    vtkIdType header[2];
     if (myProc >= pivot)
     {
-      tuples = this->EquivalenceArray->GetNumberOfTuples();
-      controller->Send(&tuples, 1, myProc - pivot, tag + pivot + 0);
-      controller->Send(this->EquivalenceArray, myProc - pivot, tag + pivot + 1);
-    }
-    else if ((myProc + pivot) < numProcs)
-    {
-      controller->Receive(&tuples, 1, myProc + pivot, tag + pivot + 0);
-      workingSet->SetNumberOfTuples(tuples);
-
-      controller->Receive(workingSet, myProc + pivot, tag + pivot + 1);
-      while (workingSet->GetNumberOfTuples() > this->EquivalenceArray->GetNumberOfTuples())
+      // Send (member, root) pairs for all members that are not roots.
+      vtkIdType numMembers = this->GetNumberOfMembers();
+      std::vector<vtkIdType> pairs;
+      for (vtkIdType ii = 0; ii < numMembers; ++ii)
       {
-        this->EquivalenceArray->InsertNextTuple1(0);
-      }
-      for (int i = 0; i < workingSet->GetNumberOfTuples(); i++)
-      {
-        int workingVal = workingSet->GetValue(i);
-        if (workingVal == 0)
+        vtkIdType root = this->FindRoot(ii);
+        if (root != ii)
         {
-          continue;
+          pairs.push_back(ii);
+          pairs.push_back(root);
         }
-        int existingVal = this->EquivalenceArray->GetValue(i);
-        this->EquivalenceArray->SetValue(i, workingVal);
-        if (existingVal != 0 && existingVal < workingVal)
+      }
+      header[0] = numMembers;
+      header[1] = static_cast<vtkIdType>(pairs.size() / 2);
+      controller->Send(header, 2, myProc - pivot, tag + pivot + 0);
+      if (header[1] > 0)
+      {
+        controller->Send(&pairs[0], 2 * header[1], myProc - pivot, tag + pivot + 1);
+      }
+    }
+    else if ((myProc + pivot) < numActive)
+    {
+      controller->Receive(header, 2, myProc + pivot, tag + pivot + 0);
+      this->SetNumberOfMembers(header[0]);
+      if (header[1] > 0)
+      {
+        std::vector<vtkIdType> pairs(2 * header[1]);
+        controller->Receive(&pairs[0], 2 * header[1], myProc + pivot, tag + pivot + 1);
+        for (vtkIdType ii = 0; ii < header[1]; ++ii)
         {
-          this->EquateInternal(existingVal, workingVal);
+          this->EquateInternal(pairs[2 * ii], pairs[2 * ii + 1]);
         }
       }
     }
-    pivot /= 2;
+    numActive = pivot;
   }
-  controller->Broadcast(this->EquivalenceArray, 0);
 
-  this->Superclass::ResolveEquivalences();
-  return 1;
+  // The root process has all the equivalences now.
+  vtkIdType numMembers = 0;
+  if (myProc == 0)
+  {
+    this->Superclass::ResolveEquivalences();
+    numMembers = this->GetNumberOfMembers();
+  }
+  controller->Broadcast(&numMembers, 1, 0);
+  if (myProc != 0)
+  {
+    this->Initialize();
+    this->EquivalenceArray->SetNumberOfTuples(numMembers);
+  }
+  if (numMembers > 0)
+  {
+    controller->Broadcast(this->EquivalenceArray->GetPointer(0), numMembers, 0);
+  }
+  controller->Broadcast(&this->NumberOfResolvedSets, 1, 0);
+  this->Resolved = 1;
+  this->RankArray->Initialize();
+  return this->NumberOfResolvedSets;
 }
@@ -17,6 +17,9 @@
  * @brief   distributed method of Equivalence
  *
  * Same as EquivalenceSet, but resolving is a global operation.
+ * Processes are merged pairwise in a tree, exchanging only the members
+ * that are not roots (with their root), i.e. the equivalences, rather than
+ * the whole set. The resolved set ids are then broadcast from the root.
  * .SEE vtkEquivalenceSet
 */
 
@@ -34,7 +37,7 @@ public:
   static vtkPEquivalenceSet* New();
 
   // Globally equivalent set IDs are reassigned to be sequential.
-  int ResolveEquivalences() VTK_OVERRIDE;
+  vtkIdType ResolveEquivalences() VTK_OVERRIDE;
 
 protected:
   vtkPEquivalenceSet();
@@ -38,6 +38,19 @@ public:
   vtkTypeMacro(vtkPGenericEnSightReader, vtkGenericEnSightReader);
   void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
 
+  //@{
+  /**
+   * Set/Get whether EnSight Gold binary files are memory mapped when they are
+   * read in parallel. On by default. Turn it off on file systems where
+   * mappings are slow, or when files may be truncated while they are read:
+   * reading a truncated mapping raises SIGBUS, while a stream only fails the
+   * read. See vtkPEnSightGoldBinaryReader.
+   */
+  vtkSetMacro(UseMemoryMapping, int);
+  vtkGetMacro(UseMemoryMapping, int);
+  vtkBooleanMacro(UseMemoryMapping, int);
+  //@}
+
 protected:
   vtkPGenericEnSightReader();
   ~vtkPGenericEnSightReader() override;
@@ -57,6 +70,8 @@ protected:
   int MultiProcessLocalProcessId;
   int MultiProcessNumberOfProcesses;
 
+  int UseMemoryMapping;
+
 private:
   vtkPGenericEnSightReader(const vtkPGenericEnSightReader&) = delete;
   void operator=(const vtkPGenericEnSightReader&) = delete;
@@ -33,6 +33,7 @@
 
 #include <map>
 #include <sstream>
+#include <string>
 
 struct vtkPPhastaReaderInternal
 {
@@ -52,7 +53,16 @@ struct vtkPPhastaReaderInternal
 
   typedef std::map<int, TimeStepInfo> TimeStepInfoMapType;
   TimeStepInfoMapType TimeStepInfoMap;
-  typedef std::map<int, vtkSmartPointer<vtkUnstructuredGrid> > CachedGridsMapType;
+  // Geometry of each piece, without attributes, along with the geometry file
+  // it was read from. When only the field files change with time, the mesh
+  // is read once and only the fields are read for the following time steps.
+  struct CachedGridInfo
+  {
+    std::string GeometryFileName;
+    vtkSmartPointer<vtkUnstructuredGrid> Grid;
+  };
+
+  typedef std::map<int, CachedGridInfo> CachedGridsMapType;
   CachedGridsMapType CachedGrids;
 };
 
@@ -277,25 +287,24 @@ int vtkPPhastaReader::RequestData(
     fieldFName << field_name << ends;
     this->Reader->SetFieldFileName(fieldFName.str().c_str());
 
-    vtkPPhastaReaderInternal::CachedGridsMapType::iterator CachedCopy =
-      this->Internal->CachedGrids.find(loadingPiece);
-
-    // if there is a cached copy, use that
-    if (CachedCopy != this->Internal->CachedGrids.end())
-    {
-      this->Reader->SetCachedGrid(CachedCopy->second);
-    }
+    // if there is a cached copy of the same geometry file, use that
+    vtkPPhastaReaderInternal::CachedGridInfo& cachedCopy =
+      this->Internal->CachedGrids[loadingPiece];
+    const bool useCachedCopy =
+      cachedCopy.Grid && cachedCopy.GeometryFileName == this->Reader->GetGeometryFileName();
+    this->Reader->SetCachedGrid(useCachedCopy ? cachedCopy.Grid.GetPointer() : NULL);
 
     this->Reader->Update();
 
-    if (CachedCopy == this->Internal->CachedGrids.end())
+    if (!useCachedCopy)
     {
       vtkSmartPointer<vtkUnstructuredGrid> cached = vtkSmartPointer<vtkUnstructuredGrid>::New();
       cached->ShallowCopy(this->Reader->GetOutput());
       cached->GetPointData()->Initialize();
       cached->GetCellData()->Initialize();
       cached->GetFieldData()->Initialize();
-      this->Internal->CachedGrids[loadingPiece] = cached;
+      cachedCopy.GeometryFileName = this->Reader->GetGeometryFileName();
+      cachedCopy.Grid = cached;
     }
     vtkSmartPointer<vtkUnstructuredGrid> copy = vtkSmartPointer<vtkUnstructuredGrid>::New();
     copy->ShallowCopy(this->Reader->GetOutput());
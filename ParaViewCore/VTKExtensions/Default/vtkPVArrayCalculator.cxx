@@ -15,6 +15,7 @@
 #include "vtkPVArrayCalculator.h"
 
 #include "vtkCellData.h"
+#include "vtkDataArray.h"
 #include "vtkDataObject.h"
 #include "vtkDataSet.h"
 #include "vtkFunctionParser.h"
@@ -24,6 +25,9 @@
 #include "vtkObjectFactory.h"
 #include "vtkPVPostFilter.h"
 #include "vtkPointData.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+#include "vtkSmartPointer.h"
 #include "vtkTable.h"
 
 #include <algorithm>
@@ -31,6 +35,7 @@
 #include <set>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace
 {
@@ -67,12 +72,121 @@ public:
     this->Calc->AddScalarVariable(name.c_str(), this->ArrayName, this->Component);
   }
 };
+
+//-----------------------------------------------------------------------------
+// Maps a variable of the function parser to the values it takes for each tuple.
+// For coordinate variables Array is NULL and the values come from the points.
+struct vtkCalculatorBinding
+{
+  vtkDataArray* Array;
+  int Components[3];
+  int Index;
+};
+
+//-----------------------------------------------------------------------------
+// Evaluates the function over ranges of tuples. The function parser keeps its
+// evaluation stack as state, so each thread gets its own parser defined with
+// the same function and variables (in the same order, so variable indices
+// match those of the calculator's parser).
+class vtkCalculatorFunctor
+{
+public:
+  vtkCalculatorFunctor(const std::string& function, int replaceInvalidValues,
+    double replacementValue, const std::vector<std::string>& scalarNames,
+    const std::vector<std::string>& vectorNames)
+    : Function(function)
+    , ReplaceInvalidValues(replaceInvalidValues)
+    , ReplacementValue(replacementValue)
+    , ScalarVariableNames(scalarNames)
+    , VectorVariableNames(vectorNames)
+    , DataSet(NULL)
+    , Result(NULL)
+    , ScalarResult(true)
+  {
+  }
+
+  void Initialize()
+  {
+    vtkFunctionParser* parser = this->Parsers.Local();
+    for (const std::string& name : this->ScalarVariableNames)
+    {
+      parser->SetScalarVariableValue(name.c_str(), 0.0);
+    }
+    for (const std::string& name : this->VectorVariableNames)
+    {
+      parser->SetVectorVariableValue(name.c_str(), 0.0, 0.0, 0.0);
+    }
+    parser->SetReplaceInvalidValues(this->ReplaceInvalidValues);
+    parser->SetReplacementValue(this->ReplacementValue);
+    parser->SetFunction(this->Function.c_str());
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkFunctionParser* parser = this->Parsers.Local();
+    double pt[3];
+    for (vtkIdType idx = begin; idx < end; ++idx)
+    {
+      if (!this->CoordinateScalars.empty() || !this->CoordinateVectors.empty())
+      {
+        this->DataSet->GetPoint(idx, pt);
+      }
+      for (const vtkCalculatorBinding& binding : this->Scalars)
+      {
+        parser->SetScalarVariableValue(
+          binding.Index, binding.Array->GetComponent(idx, binding.Components[0]));
+      }
+      for (const vtkCalculatorBinding& binding : this->CoordinateScalars)
+      {
+        parser->SetScalarVariableValue(binding.Index, pt[binding.Components[0]]);
+      }
+      for (const vtkCalculatorBinding& binding : this->Vectors)
+      {
+        parser->SetVectorVariableValue(binding.Index,
+          binding.Array->GetComponent(idx, binding.Components[0]),
+          binding.Array->GetComponent(idx, binding.Components[1]),
+          binding.Array->GetComponent(idx, binding.Components[2]));
+      }
+      for (const vtkCalculatorBinding& binding : this->CoordinateVectors)
+      {
+        parser->SetVectorVariableValue(binding.Index, pt[binding.Components[0]],
+          pt[binding.Components[1]], pt[binding.Components[2]]);
+      }
+      if (this->ScalarResult)
+      {
+        this->Result->SetTuple1(idx, parser->GetScalarResult());
+      }
+      else
+      {
+        this->Result->SetTuple(idx, parser->GetVectorResult());
+      }
+    }
+  }
+
+  void Reduce() {}
+
+  std::vector<vtkCalculatorBinding> Scalars;
+  std::vector<vtkCalculatorBinding> Vectors;
+  std::vector<vtkCalculatorBinding> CoordinateScalars;
+  std::vector<vtkCalculatorBinding> CoordinateVectors;
+
+  std::string Function;
+  int ReplaceInvalidValues;
+  double ReplacementValue;
+  const std::vector<std::string>& ScalarVariableNames;
+  const std::vector<std::string>& VectorVariableNames;
+  vtkDataSet* DataSet;
+  vtkDataArray* Result;
+  bool ScalarResult;
+  vtkSMPThreadLocalObject<vtkFunctionParser> Parsers;
+};
 }
 
 vtkStandardNewMacro(vtkPVArrayCalculator);
 // ----------------------------------------------------------------------------
 vtkPVArrayCalculator::vtkPVArrayCalculator()
 {
+  this->MultithreadedEvaluation = false;
 }
 
 // ----------------------------------------------------------------------------
@@ -199,11 +313,162 @@ int vtkPVArrayCalculator::RequestData(
     this->UpdateArrayAndVariableNames(input, dataAttrs);
   }
 
+  if (this->MultithreadedEvaluation && numTuples > 0)
+  {
+    vtkDataObject* output =
+      outputVector->GetInformationObject(0)->Get(vtkDataObject::DATA_OBJECT());
+    if (this->RequestDataMultithreaded(input, output, attributeType))
+    {
+      return 1;
+    }
+  }
+
   return this->Superclass::RequestData(request, inputVector, outputVector);
 }
 
+// ----------------------------------------------------------------------------
+bool vtkPVArrayCalculator::RequestDataMultithreaded(
+  vtkDataObject* input, vtkDataObject* output, int attributeType)
+{
+  vtkDataSet* dsInput = vtkDataSet::SafeDownCast(input);
+  vtkDataSet* dsOutput = vtkDataSet::SafeDownCast(output);
+  if (!dsInput || !dsOutput || this->CoordinateResults || this->ResultNormals ||
+    this->ResultTCoords || !this->Function || this->Function[0] == '\0' ||
+    !this->ResultArrayName || this->ResultArrayName[0] == '\0' ||
+    (attributeType != vtkDataObject::POINT && attributeType != vtkDataObject::CELL))
+  {
+    return false;
+  }
+
+  vtkDataSetAttributes* inFD = dsInput->GetAttributes(attributeType);
+  const vtkIdType numTuples = dsInput->GetNumberOfElements(attributeType);
+
+  // Define the variables on the calculator's parser in the same order as
+  // vtkArrayCalculator does: array scalars, then coordinate scalars, and
+  // likewise for vectors. Coordinates are only available for point data.
+  std::vector<std::string> scalarNames;
+  std::vector<std::string> vectorNames;
+  for (int i = 0; i < this->NumberOfScalarArrays; i++)
+  {
+    scalarNames.push_back(this->ScalarVariableNames[i]);
+  }
+  for (int i = 0; i < this->NumberOfCoordinateScalarArrays; i++)
+  {
+    scalarNames.push_back(this->CoordinateScalarVariableNames[i]);
+  }
+  for (int i = 0; i < this->NumberOfVectorArrays; i++)
+  {
+    vectorNames.push_back(this->VectorVariableNames[i]);
+  }
+  for (int i = 0; i < this->NumberOfCoordinateVectorArrays; i++)
+  {
+    vectorNames.push_back(this->CoordinateVectorVariableNames[i]);
+  }
+
+  vtkFunctionParser* parser = this->FunctionParser;
+  parser->RemoveAllVariables();
+  for (const std::string& name : scalarNames)
+  {
+    parser->SetScalarVariableValue(name.c_str(), 0.0);
+  }
+  for (const std::string& name : vectorNames)
+  {
+    parser->SetVectorVariableValue(name.c_str(), 0.0, 0.0, 0.0);
+  }
+  parser->SetReplaceInvalidValues(this->ReplaceInvalidValues);
+  parser->SetReplacementValue(this->ReplacementValue);
+  parser->SetFunction(this->Function);
+
+  // Let vtkArrayCalculator report invalid functions.
+  const bool scalarResult = parser->IsScalarResult() != 0;
+  if (!scalarResult && !parser->IsVectorResult())
+  {
+    return false;
+  }
+
+  vtkCalculatorFunctor functor(
+    this->Function, this->ReplaceInvalidValues, this->ReplacementValue, scalarNames, vectorNames);
+
+  // Bind the variables to input arrays. Missing or non-numeric arrays and
+  // invalid components are reported by vtkArrayCalculator.
+  for (int i = 0; i < this->NumberOfScalarArrays; i++)
+  {
+    vtkDataArray* array = inFD->GetArray(this->ScalarArrayNames[i]);
+    const int comp = this->SelectedScalarComponents[i];
+    if (!array || comp < 0 || comp >= array->GetNumberOfComponents())
+    {
+      return false;
+    }
+    vtkCalculatorBinding binding = { array, { comp, 0, 0 },
+      parser->GetScalarVariableIndex(this->ScalarVariableNames[i]) };
+    functor.Scalars.push_back(binding);
+  }
+  for (int i = 0; i < this->NumberOfVectorArrays; i++)
+  {
+    vtkDataArray* array = inFD->GetArray(this->VectorArrayNames[i]);
+    const int* comps = this->SelectedVectorComponents[i];
+    if (!array ||
+      *std::max_element(comps, comps + 3) >= array->GetNumberOfComponents() ||
+      *std::min_element(comps, comps + 3) < 0)
+    {
+      return false;
+    }
+    vtkCalculatorBinding binding = { array, { comps[0], comps[1], comps[2] },
+      parser->GetVectorVariableIndex(this->VectorVariableNames[i]) };
+    functor.Vectors.push_back(binding);
+  }
+  if (attributeType == vtkDataObject::POINT)
+  {
+    for (int i = 0; i < this->NumberOfCoordinateScalarArrays; i++)
+    {
+      vtkCalculatorBinding binding = { NULL, { this->SelectedCoordinateScalarComponents[i], 0, 0 },
+        parser->GetScalarVariableIndex(this->CoordinateScalarVariableNames[i]) };
+      functor.CoordinateScalars.push_back(binding);
+    }
+    for (int i = 0; i < this->NumberOfCoordinateVectorArrays; i++)
+    {
+      const int* comps = this->SelectedCoordinateVectorComponents[i];
+      vtkCalculatorBinding binding = { NULL, { comps[0], comps[1], comps[2] },
+        parser->GetVectorVariableIndex(this->CoordinateVectorVariableNames[i]) };
+      functor.CoordinateVectors.push_back(binding);
+    }
+  }
+
+  vtkSmartPointer<vtkDataArray> resultArray;
+  resultArray.TakeReference(vtkDataArray::CreateDataArray(this->ResultArrayType));
+  if (!resultArray)
+  {
+    return false;
+  }
+  resultArray->SetNumberOfComponents(scalarResult ? 1 : 3);
+  resultArray->SetNumberOfTuples(numTuples);
+  resultArray->SetName(this->ResultArrayName);
+
+  // Make sure lazily built structures used by GetPoint() exist before the
+  // threads start.
+  if (!functor.CoordinateScalars.empty() || !functor.CoordinateVectors.empty())
+  {
+    double pt[3];
+    dsInput->GetPoint(0, pt);
+  }
+
+  functor.DataSet = dsInput;
+  functor.Result = resultArray;
+  functor.ScalarResult = scalarResult;
+  vtkSMPTools::For(0, numTuples, functor);
+
+  dsOutput->CopyStructure(dsInput);
+  dsOutput->CopyAttributes(dsInput);
+  vtkDataSetAttributes* outFD = dsOutput->GetAttributes(attributeType);
+  const int idx = outFD->AddArray(resultArray);
+  outFD->SetActiveAttribute(
+    idx, scalarResult ? vtkDataSetAttributes::SCALARS : vtkDataSetAttributes::VECTORS);
+  return true;
+}
+
 // ----------------------------------------------------------------------------
 void vtkPVArrayCalculator::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "MultithreadedEvaluation: " << this->MultithreadedEvaluation << endl;
 }
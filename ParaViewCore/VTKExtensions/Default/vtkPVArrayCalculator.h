@@ -24,6 +24,11 @@
  *  their mapping with the input fields. We extend vtkArrayCalculator to
  *  automatically add scalar/vector fields mapping using the array available in
  *  the input.
+ *
+ *  When MultithreadedEvaluation is enabled, the expression is evaluated over
+ *  ranges of tuples concurrently using vtkSMPTools. Each thread uses its own
+ *  vtkFunctionParser compiled from the same function, so results are identical
+ *  to the serial evaluation.
  * @sa
  *  vtkArrayCalculator vtkFunctionParser
 */
@@ -45,6 +50,19 @@ public:
 
   static vtkPVArrayCalculator* New();
 
+  //@{
+  /**
+   * When set, evaluate the function for point or cell data of vtkDataSet
+   * inputs using multiple threads. Cases that the threaded evaluation does not
+   * handle (coordinate, normal or texture coordinate results, non-dataset
+   * inputs) fall back to the serial evaluation of vtkArrayCalculator.
+   * Default is false.
+   */
+  vtkSetMacro(MultithreadedEvaluation, bool);
+  vtkGetMacro(MultithreadedEvaluation, bool);
+  vtkBooleanMacro(MultithreadedEvaluation, bool);
+  //@}
+
 protected:
   vtkPVArrayCalculator();
   ~vtkPVArrayCalculator() override;
@@ -63,6 +81,14 @@ protected:
    */
   void UpdateArrayAndVariableNames(vtkDataObject* theInputObj, vtkDataSetAttributes* inDataAttrs);
 
+  /**
+   * Evaluates the function using vtkSMPTools. Returns false, without touching
+   * the output, if the request cannot be handled by the threaded evaluation.
+   */
+  bool RequestDataMultithreaded(vtkDataObject* input, vtkDataObject* output, int attributeType);
+
+  bool MultithreadedEvaluation;
+
 private:
   vtkPVArrayCalculator(const vtkPVArrayCalculator&) = delete;
   void operator=(const vtkPVArrayCalculator&) = delete;
@@ -17,32 +17,431 @@
 // VTK includes
 #include "vtkAppendPolyData.h"
 #include "vtkBoundingBox.h"
+#include "vtkCellArray.h"
 #include "vtkCellCenters.h"
 #include "vtkCellData.h"
 #include "vtkCompositeDataIterator.h"
 #include "vtkDataSet.h"
+#include "vtkIdTypeArray.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkMath.h"
 #include "vtkMinimalStandardRandomSequence.h"
 #include "vtkMultiBlockDataSet.h"
 #include "vtkMultiProcessController.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
-#include "vtkOctreePointLocator.h"
 #include "vtkPointData.h"
+#include "vtkPointSet.h"
+#include "vtkPoints.h"
 #include "vtkPolyData.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
+#include "vtkTransform.h"
 #include "vtkTuple.h"
 #include "vtkUniformGrid.h"
 
 // C/C++ includes
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <map>
-#include <set>
 #include <vector>
 
+namespace
+{
+// Points of a dataset sorted in a uniform grid of bins. Bins are at least as
+// large as the search radius, so that only a few bins need to be visited to
+// find the closest point to a sample point.
+class vtkPointBins
+{
+public:
+  void Build(vtkDataSet* ds, double radius);
+  vtkIdType FindClosestPointWithinRadius(const double x[3], double radius) const;
+
+  std::vector<double> Coordinates;
+  std::vector<vtkIdType> Bins;
+  double Origin[3];
+  double Size[3];
+  int Divisions[3];
+
+private:
+  // Offsets of the points of each bin in PointIds.
+  std::vector<vtkIdType> Offsets;
+  std::vector<vtkIdType> PointIds;
+};
+
+// Copies the point coordinates and computes the bin of every point.
+struct vtkBinPointsFunctor
+{
+  vtkDataSet* DataSet;
+  vtkPointBins* Bins;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkPointBins& bins = *this->Bins;
+    for (vtkIdType cc = begin; cc < end; ++cc)
+    {
+      double* x = &bins.Coordinates[3 * cc];
+      this->DataSet->GetPoint(cc, x);
+      vtkIdType bin = 0;
+      for (int kk = 2; kk >= 0; --kk)
+      {
+        int idx = bins.Size[kk] > 0 ? static_cast<int>((x[kk] - bins.Origin[kk]) / bins.Size[kk])
+                                    : 0;
+        idx = std::max(0, std::min(idx, bins.Divisions[kk] - 1));
+        bin = bin * bins.Divisions[kk] + idx;
+      }
+      bins.Bins[cc] = bin;
+    }
+  }
+};
+
+void vtkPointBins::Build(vtkDataSet* ds, double radius)
+{
+  const vtkIdType numPts = ds->GetNumberOfPoints();
+  double bounds[6];
+  ds->GetBounds(bounds);
+
+  // Use bins of the size of the search radius, but not more bins than points.
+  double divisions[3];
+  double numBins = 1.0;
+  for (int cc = 0; cc < 3; ++cc)
+  {
+    const double length = bounds[2 * cc + 1] - bounds[2 * cc];
+    divisions[cc] = (length > 0 && radius > 0) ? std::max(1.0, std::floor(length / radius)) : 1.0;
+    numBins *= divisions[cc];
+  }
+  for (int iter = 0; iter < 3 && numBins > numPts; ++iter)
+  {
+    // ... shrink the dimensions that are not flat yet ...
+    int numDims = 0;
+    for (int cc = 0; cc < 3; ++cc)
+    {
+      numDims += divisions[cc] > 1.0 ? 1 : 0;
+    }
+    const double scale = std::pow(numBins / numPts, 1.0 / numDims);
+    numBins = 1.0;
+    for (int cc = 0; cc < 3; ++cc)
+    {
+      divisions[cc] = std::max(1.0, std::floor(divisions[cc] / scale));
+      numBins *= divisions[cc];
+    }
+  }
+  for (int cc = 0; cc < 3; ++cc)
+  {
+    this->Divisions[cc] = static_cast<int>(divisions[cc]);
+    this->Origin[cc] = bounds[2 * cc];
+    this->Size[cc] = (bounds[2 * cc + 1] - bounds[2 * cc]) / this->Divisions[cc];
+  }
+
+  this->Coordinates.resize(3 * numPts);
+  this->Bins.resize(numPts);
+  vtkBinPointsFunctor binPoints = { ds, this };
+  vtkSMPTools::For(0, numPts, binPoints);
+
+  // Counting sort, points of a bin stay sorted by id.
+  const vtkIdType totalBins =
+    static_cast<vtkIdType>(this->Divisions[0]) * this->Divisions[1] * this->Divisions[2];
+  this->Offsets.assign(totalBins + 1, 0);
+  for (vtkIdType cc = 0; cc < numPts; ++cc)
+  {
+    this->Offsets[this->Bins[cc] + 1]++;
+  }
+  for (vtkIdType cc = 0; cc < totalBins; ++cc)
+  {
+    this->Offsets[cc + 1] += this->Offsets[cc];
+  }
+  std::vector<vtkIdType> next(this->Offsets.begin(), this->Offsets.end() - 1);
+  this->PointIds.resize(numPts);
+  for (vtkIdType cc = 0; cc < numPts; ++cc)
+  {
+    this->PointIds[next[this->Bins[cc]]++] = cc;
+  }
+}
+
+vtkIdType vtkPointBins::FindClosestPointWithinRadius(const double x[3], double radius) const
+{
+  int minIdx[3], maxIdx[3];
+  for (int cc = 0; cc < 3; ++cc)
+  {
+    if (this->Size[cc] > 0)
+    {
+      const double from = std::floor((x[cc] - radius - this->Origin[cc]) / this->Size[cc]);
+      const double to = std::floor((x[cc] + radius - this->Origin[cc]) / this->Size[cc]);
+      if (to < 0 || from >= this->Divisions[cc])
+      {
+        return -1;
+      }
+      minIdx[cc] = static_cast<int>(std::max(from, 0.0));
+      maxIdx[cc] = static_cast<int>(std::min(to, this->Divisions[cc] - 1.0));
+    }
+    else
+    {
+      minIdx[cc] = maxIdx[cc] = 0;
+    }
+  }
+
+  // Ties go to the lowest point id, so that the result does not depend on
+  // the order in which the bins are visited.
+  vtkIdType closest = -1;
+  double closestDist2 = radius * radius;
+  for (int k = minIdx[2]; k <= maxIdx[2]; ++k)
+  {
+    for (int j = minIdx[1]; j <= maxIdx[1]; ++j)
+    {
+      for (int i = minIdx[0]; i <= maxIdx[0]; ++i)
+      {
+        const vtkIdType bin =
+          i + this->Divisions[0] * (j + static_cast<vtkIdType>(this->Divisions[1]) * k);
+        for (vtkIdType cc = this->Offsets[bin]; cc < this->Offsets[bin + 1]; ++cc)
+        {
+          const vtkIdType ptId = this->PointIds[cc];
+          const double dist2 = vtkMath::Distance2BetweenPoints(x, &this->Coordinates[3 * ptId]);
+          if (dist2 < closestDist2 || (dist2 == closestDist2 && (closest < 0 || ptId < closest)))
+          {
+            closest = ptId;
+            closestDist2 = dist2;
+          }
+        }
+      }
+    }
+  }
+  return closest;
+}
+
+// Finds the closest point to every sample point.
+struct vtkClosestPointFunctor
+{
+  const vtkPointBins* Bins;
+  const vtkTuple<double, 3>* Samples;
+  double Radius;
+  vtkIdType* Closest;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType cc = begin; cc < end; ++cc)
+    {
+      this->Closest[cc] = this->Bins->FindClosestPointWithinRadius(
+        this->Samples[cc].GetData(), this->Radius);
+    }
+  }
+};
+
+// Number of glyphed points handled by each vtkGlyph3D in the multithreaded
+// path. Inputs with fewer points are glyphed serially.
+const vtkIdType vtkGlyphChunkSize = 16384;
+
+// vtkGlyph3D glyphing points that were already selected by
+// vtkPVGlyphFilter::IsPointVisible().
+class vtkPVGlyphChunkFilter : public vtkGlyph3D
+{
+public:
+  static vtkPVGlyphChunkFilter* New();
+  vtkTypeMacro(vtkPVGlyphChunkFilter, vtkGlyph3D);
+
+  bool Glyph(vtkDataSet* input, vtkInformationVector* sourceVector, vtkPolyData* output,
+    vtkDataArray* inSScalars, vtkDataArray* inVectors)
+  {
+    return this->Execute(input, sourceVector, output, inSScalars, inVectors);
+  }
+
+protected:
+  vtkPVGlyphChunkFilter() {}
+  ~vtkPVGlyphChunkFilter() override {}
+
+private:
+  vtkPVGlyphChunkFilter(const vtkPVGlyphChunkFilter&) = delete;
+  void operator=(const vtkPVGlyphChunkFilter&) = delete;
+};
+vtkStandardNewMacro(vtkPVGlyphChunkFilter);
+
+vtkCellArray* GetCellArray(vtkPolyData* pd, int type)
+{
+  switch (type)
+  {
+    case 0:
+      return pd->GetVerts();
+    case 1:
+      return pd->GetLines();
+    case 2:
+      return pd->GetPolys();
+    default:
+      return pd->GetStrips();
+  }
+}
+
+// Raw tuples of the arrays of some point or cell data.
+struct vtkRawArrays
+{
+  std::vector<char*> Pointers;
+  std::vector<vtkIdType> TupleSizes;
+
+  void Set(vtkDataSetAttributes* dsa)
+  {
+    const int numArrays = dsa->GetNumberOfArrays();
+    this->Pointers.resize(numArrays);
+    this->TupleSizes.resize(numArrays);
+    for (int cc = 0; cc < numArrays; ++cc)
+    {
+      vtkDataArray* array = dsa->GetArray(cc);
+      this->Pointers[cc] = static_cast<char*>(array->GetVoidPointer(0));
+      this->TupleSizes[cc] = array->GetDataTypeSize() * array->GetNumberOfComponents();
+    }
+  }
+};
+
+// A contiguous range of the glyphed points, with its own vtkGlyph3D.
+struct vtkGlyphChunk
+{
+  vtkIdType Begin;
+  vtkIdType End;
+  vtkSmartPointer<vtkPolyData> Input;
+  vtkRawArrays InputPointData;
+  vtkSmartPointer<vtkInformationVector> Sources;
+  vtkSmartPointer<vtkPVGlyphChunkFilter> Glyph;
+  vtkSmartPointer<vtkPolyData> Output;
+  vtkIdType PointOffset;
+  vtkIdType CellOffset;
+  vtkIdType ConnectivityOffset;
+};
+
+// Gathers the points of each chunk with their point data and glyphs them.
+struct vtkGlyphChunksFunctor
+{
+  vtkDataSet* Input;
+  const char* InputPoints;
+  vtkIdType PointTupleSize;
+  const vtkRawArrays* InputPointData;
+  const vtkIdType* PointIds;
+  vtkGlyphChunk* Chunks;
+  int ScalarsIndex;
+  int VectorsIndex;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType cc = begin; cc < end; ++cc)
+    {
+      vtkGlyphChunk& chunk = this->Chunks[cc];
+      const vtkIdType* ids = this->PointIds + chunk.Begin;
+      const vtkIdType numPts = chunk.End - chunk.Begin;
+
+      vtkPoints* points = chunk.Input->GetPoints();
+      if (this->InputPoints)
+      {
+        char* to = static_cast<char*>(points->GetVoidPointer(0));
+        for (vtkIdType i = 0; i < numPts; ++i)
+        {
+          memcpy(to + i * this->PointTupleSize, this->InputPoints + ids[i] * this->PointTupleSize,
+            this->PointTupleSize);
+        }
+      }
+      else
+      {
+        double x[3];
+        for (vtkIdType i = 0; i < numPts; ++i)
+        {
+          this->Input->GetPoint(ids[i], x);
+          points->SetPoint(i, x);
+        }
+      }
+
+      for (size_t a = 0; a < chunk.InputPointData.Pointers.size(); ++a)
+      {
+        const char* from = this->InputPointData->Pointers[a];
+        char* to = chunk.InputPointData.Pointers[a];
+        const vtkIdType tupleSize = this->InputPointData->TupleSizes[a];
+        for (vtkIdType i = 0; i < numPts; ++i)
+        {
+          memcpy(to + i * tupleSize, from + ids[i] * tupleSize, tupleSize);
+        }
+      }
+
+      vtkPointData* pd = chunk.Input->GetPointData();
+      chunk.Glyph->Glyph(chunk.Input, chunk.Sources, chunk.Output,
+        this->ScalarsIndex >= 0 ? pd->GetArray(this->ScalarsIndex) : NULL,
+        this->VectorsIndex >= 0 ? pd->GetArray(this->VectorsIndex) : NULL);
+    }
+  }
+};
+
+// Copies the glyphs of each chunk into the output, at the chunk offsets.
+struct vtkMergeGlyphsFunctor
+{
+  vtkGlyphChunk* Chunks;
+  int CellType;
+  vtkIdType* OutputConnectivity;
+  char* OutputPoints;
+  vtkIdType PointTupleSize;
+  const vtkRawArrays* OutputPointData;
+  const vtkRawArrays* OutputCellData;
+  int PointIdsIndex;
+  const vtkIdType* PointIds;
+
+  static void CopyTuples(const vtkRawArrays& from, const vtkRawArrays& to, vtkIdType numTuples,
+    vtkIdType offset, int skip)
+  {
+    for (size_t a = 0; a < from.Pointers.size(); ++a)
+    {
+      if (static_cast<int>(a) != skip)
+      {
+        memcpy(to.Pointers[a] + offset * to.TupleSizes[a], from.Pointers[a],
+          numTuples * from.TupleSizes[a]);
+      }
+    }
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkRawArrays pointData, cellData;
+    for (vtkIdType cc = begin; cc < end; ++cc)
+    {
+      vtkGlyphChunk& chunk = this->Chunks[cc];
+      vtkPolyData* glyphs = chunk.Output;
+      const vtkIdType numPts = glyphs->GetNumberOfPoints();
+      if (numPts > 0)
+      {
+        memcpy(this->OutputPoints + chunk.PointOffset * this->PointTupleSize,
+          glyphs->GetPoints()->GetVoidPointer(0), numPts * this->PointTupleSize);
+      }
+
+      pointData.Set(glyphs->GetPointData());
+      CopyTuples(pointData, *this->OutputPointData, numPts, chunk.PointOffset, this->PointIdsIndex);
+      if (this->PointIdsIndex >= 0)
+      {
+        // ... point ids refer to the points of the chunk input ...
+        const vtkIdType* from =
+          reinterpret_cast<const vtkIdType*>(pointData.Pointers[this->PointIdsIndex]);
+        vtkIdType* to =
+          reinterpret_cast<vtkIdType*>(this->OutputPointData->Pointers[this->PointIdsIndex]);
+        for (vtkIdType i = 0; i < numPts; ++i)
+        {
+          to[chunk.PointOffset + i] = this->PointIds[chunk.Begin + from[i]];
+        }
+      }
+
+      vtkCellArray* cells = GetCellArray(glyphs, this->CellType);
+      cellData.Set(glyphs->GetCellData());
+      CopyTuples(cellData, *this->OutputCellData, cells->GetNumberOfCells(), chunk.CellOffset, -1);
+
+      const vtkIdType size = cells->GetNumberOfConnectivityEntries();
+      const vtkIdType* from = cells->GetPointer();
+      vtkIdType* to = this->OutputConnectivity + chunk.ConnectivityOffset;
+      for (vtkIdType i = 0; i < size;)
+      {
+        const vtkIdType npts = from[i];
+        to[i++] = npts;
+        for (vtkIdType j = 0; j < npts; ++j, ++i)
+        {
+          to[i] = from[i] + chunk.PointOffset;
+        }
+      }
+    }
+  }
+};
+}
+
 class vtkPVGlyphFilter::vtkInternals
 {
   vtkBoundingBox Bounds;
@@ -50,45 +449,55 @@ class vtkPVGlyphFilter::vtkInternals
   std::vector<vtkTuple<double, 3> > Points;
   std::vector<vtkIdType> PointIds;
   size_t NextPointId;
+  vtkDataSet* DataSet;
 
-  vtkNew<vtkOctreePointLocator> Locator;
-
-  void SetupLocator(vtkDataSet* ds)
+  //---------------------------------------------------------------------------
+  // Builds the sorted list of the points of ds closest to the sample points.
+  void SetupPointIds(vtkDataSet* ds)
   {
-    if (this->Locator->GetDataSet() == ds)
+    if (this->DataSet == ds)
     {
       return;
     }
 
-    this->Locator->Initialize();
-    this->Locator->SetDataSet(ds);
-    this->Locator->BuildLocator();
-
+    this->DataSet = ds;
     this->PointIds.clear();
-    std::set<vtkIdType> pointset;
-    for (std::vector<vtkTuple<double, 3> >::iterator iter = this->Points.begin(),
-                                                     end = this->Points.end();
-         iter != end; ++iter)
-    {
-      double dist2;
-      vtkIdType ptId = this->Locator->FindClosestPointWithinRadius(
-        this->NearestPointRadius, iter->GetData(), dist2);
-      if (ptId >= 0)
-      {
-        pointset.insert(ptId);
-      }
-    }
-    this->PointIds.insert(this->PointIds.begin(), pointset.begin(), pointset.end());
     this->NextPointId = 0;
+    const vtkIdType numSamples = static_cast<vtkIdType>(this->Points.size());
+    if (ds->GetNumberOfPoints() == 0 || numSamples == 0)
+    {
+      return;
+    }
+
+    vtkPointBins bins;
+    bins.Build(ds, this->NearestPointRadius);
+
+    std::vector<vtkIdType> closest(numSamples);
+    vtkClosestPointFunctor findClosest = { &bins, &this->Points[0], this->NearestPointRadius,
+      &closest[0] };
+    vtkSMPTools::For(0, numSamples, findClosest);
+
+    std::sort(closest.begin(), closest.end());
+    closest.erase(std::unique(closest.begin(), closest.end()), closest.end());
+    std::vector<vtkIdType>::iterator first =
+      std::lower_bound(closest.begin(), closest.end(), static_cast<vtkIdType>(0));
+    this->PointIds.assign(first, closest.end());
   }
 
 public:
+  vtkInternals()
+    : NearestPointRadius(0.0)
+    , NextPointId(0)
+    , DataSet(NULL)
+  {
+  }
+
   void Reset()
   {
     this->Bounds.Reset();
     this->Points.clear();
-    this->Locator->Initialize();
-    this->Locator->SetDataSet(NULL);
+    this->PointIds.clear();
+    this->DataSet = NULL;
   }
 
   //---------------------------------------------------------------------------
@@ -197,9 +606,9 @@ public:
         return self->GetStride() <= 1 || (ptId % self->GetStride()) == 0;
 
       case vtkPVGlyphFilter::SPATIALLY_UNIFORM_DISTRIBUTION:
-        // This will initialize the point locator and build the list of PointIds
-        // that should be glyphed.
-        this->SetupLocator(ds);
+        // This will bin the points and build the list of PointIds that should
+        // be glyphed.
+        this->SetupPointIds(ds);
 
         // since PointIds is a sorted list, and we know that IsPointVisible will
         // be called for in monotonically increasing fashion for a specific ds, we
@@ -232,6 +641,7 @@ vtkPVGlyphFilter::vtkPVGlyphFilter()
   , MaximumNumberOfSamplePoints(5000)
   , Seed(1)
   , Stride(1)
+  , UseMultithreading(true)
   , Controller(0)
   , Internals(new vtkPVGlyphFilter::vtkInternals())
 {
@@ -336,7 +746,10 @@ int vtkPVGlyphFilter::RequestData(vtkInformation* vtkNotUsed(request),
     }
     else
     {
-      return this->Execute(ds, sourceVector, outputPD) ? 1 : 0;
+      return this->ExecuteGlyphs(ds, sourceVector, outputPD, this->GetInputArrayToProcess(0, ds),
+               this->GetInputArrayToProcess(1, ds))
+        ? 1
+        : 0;
     }
   }
   else if (cds)
@@ -376,7 +789,8 @@ int vtkPVGlyphFilter::RequestData(vtkInformation* vtkNotUsed(request),
         }
         else
         {
-          res = this->Execute(currentDS, sourceVector, outputPD.GetPointer());
+          res = this->ExecuteGlyphs(currentDS, sourceVector, outputPD.GetPointer(),
+            this->GetInputArrayToProcess(0, currentDS), this->GetInputArrayToProcess(1, currentDS));
         }
         if (!res)
         {
@@ -489,9 +903,269 @@ bool vtkPVGlyphFilter::ExecuteWithCellCenters(
     this->GetInputArrayInformation(0)->Get(vtkDataObject::FIELD_NAME()));
   vtkDataArray* inVectors = input->GetPointData()->GetArray(
     this->GetInputArrayInformation(1)->Get(vtkDataObject::FIELD_NAME()));
+  return this->ExecuteGlyphs(input, sourceVector, output, inSScalars, inVectors);
+}
+
+//-----------------------------------------------------------------------------
+bool vtkPVGlyphFilter::ExecuteGlyphs(vtkDataSet* input, vtkInformationVector* sourceVector,
+  vtkPolyData* output, vtkDataArray* inSScalars, vtkDataArray* inVectors)
+{
+  if (this->UseMultithreading &&
+    this->ExecuteMultithreaded(input, sourceVector, output, inSScalars, inVectors))
+  {
+    return true;
+  }
   return this->Execute(input, sourceVector, output, inSScalars, inVectors);
 }
 
+//-----------------------------------------------------------------------------
+bool vtkPVGlyphFilter::ExecuteMultithreaded(vtkDataSet* input, vtkInformationVector* sourceVector,
+  vtkPolyData* output, vtkDataArray* inSScalars, vtkDataArray* inVectors)
+{
+  const vtkIdType numPts = input->GetNumberOfPoints();
+  vtkPolyData* source = this->GetSource(0, sourceVector);
+  if (numPts <= vtkGlyphChunkSize || this->IndexMode != VTK_INDEXING_OFF || source == NULL)
+  {
+    return false;
+  }
+
+  // Glyphs are concatenated per kind of cell, which would reorder the cells
+  // of sources mixing several kinds.
+  int cellType = -1;
+  for (int type = 0; type < 4; ++type)
+  {
+    if (GetCellArray(source, type)->GetNumberOfCells() > 0)
+    {
+      if (cellType >= 0)
+      {
+        return false;
+      }
+      cellType = type;
+    }
+  }
+  if (cellType < 0)
+  {
+    return false;
+  }
+
+  // The point data is gathered as raw tuples.
+  vtkPointData* inPD = input->GetPointData();
+  int scalarsIndex = -1;
+  int vectorsIndex = -1;
+  for (int cc = 0; cc < inPD->GetNumberOfArrays(); ++cc)
+  {
+    vtkDataArray* array = inPD->GetArray(cc);
+    if (array == NULL || array->GetDataType() == VTK_BIT || !array->HasStandardMemoryLayout())
+    {
+      return false;
+    }
+    scalarsIndex = array == inSScalars ? cc : scalarsIndex;
+    vectorsIndex = array == inVectors ? cc : vectorsIndex;
+  }
+  if ((inSScalars && scalarsIndex < 0) || (inVectors && vectorsIndex < 0))
+  {
+    return false;
+  }
+  vtkPointSet* inputPointSet = vtkPointSet::SafeDownCast(input);
+  vtkDataArray* inputPoints =
+    inputPointSet && inputPointSet->GetPoints() ? inputPointSet->GetPoints()->GetData() : NULL;
+  if (inputPoints && !inputPoints->HasStandardMemoryLayout())
+  {
+    return false;
+  }
+
+  // ... select the points to glyph, in order since IsPointVisible() expects
+  //   increasing point ids ...
+  std::vector<vtkIdType> pointIds;
+  pointIds.reserve(numPts);
+  for (vtkIdType cc = 0; cc < numPts; ++cc)
+  {
+    if (this->IsPointVisible(input, cc))
+    {
+      pointIds.push_back(cc);
+    }
+  }
+  const vtkIdType numGlyphs = static_cast<vtkIdType>(pointIds.size());
+  const vtkIdType numChunks =
+    std::max<vtkIdType>(1, (numGlyphs + vtkGlyphChunkSize - 1) / vtkGlyphChunkSize);
+
+  // ... set up the chunks, the parallel section only fills preallocated
+  //   arrays and runs vtkGlyph3D ...
+  vtkRawArrays inputPointData;
+  inputPointData.Set(inPD);
+  std::vector<vtkGlyphChunk> chunks(numChunks);
+  for (vtkIdType cc = 0; cc < numChunks; ++cc)
+  {
+    vtkGlyphChunk& chunk = chunks[cc];
+    chunk.Begin = cc * vtkGlyphChunkSize;
+    chunk.End = std::min(numGlyphs, chunk.Begin + vtkGlyphChunkSize);
+    const vtkIdType numChunkPts = chunk.End - chunk.Begin;
+
+    chunk.Input = vtkSmartPointer<vtkPolyData>::New();
+    vtkNew<vtkPoints> points;
+    points->SetDataType(inputPoints ? inputPoints->GetDataType() : VTK_FLOAT);
+    points->SetNumberOfPoints(numChunkPts);
+    chunk.Input->SetPoints(points.GetPointer());
+    vtkPointData* pd = chunk.Input->GetPointData();
+    for (int a = 0; a < inPD->GetNumberOfArrays(); ++a)
+    {
+      vtkDataArray* array = inPD->GetArray(a);
+      vtkDataArray* copy = array->NewInstance();
+      copy->SetName(array->GetName());
+      copy->SetNumberOfComponents(array->GetNumberOfComponents());
+      copy->SetNumberOfTuples(numChunkPts);
+      pd->AddArray(copy);
+      copy->Delete();
+    }
+    int attributes[vtkDataSetAttributes::NUM_ATTRIBUTES];
+    inPD->GetAttributeIndices(attributes);
+    for (int attr = 0; attr < vtkDataSetAttributes::NUM_ATTRIBUTES; ++attr)
+    {
+      if (attributes[attr] >= 0)
+      {
+        pd->SetActiveAttribute(attributes[attr], attr);
+      }
+    }
+    chunk.InputPointData.Set(pd);
+
+    // ... each vtkGlyph3D gets its own copy of the source and transform ...
+    vtkNew<vtkPolyData> sourceCopy;
+    sourceCopy->ShallowCopy(source);
+    vtkNew<vtkInformation> sourceInfo;
+    sourceInfo->Set(vtkDataObject::DATA_OBJECT(), sourceCopy.GetPointer());
+    chunk.Sources = vtkSmartPointer<vtkInformationVector>::New();
+    chunk.Sources->Append(sourceInfo.GetPointer());
+
+    chunk.Glyph = vtkSmartPointer<vtkPVGlyphChunkFilter>::New();
+    vtkPVGlyphChunkFilter* glyph = chunk.Glyph;
+    glyph->SetScaling(this->Scaling);
+    glyph->SetScaleMode(this->ScaleMode);
+    glyph->SetColorMode(this->ColorMode);
+    glyph->SetScaleFactor(this->ScaleFactor);
+    glyph->SetRange(this->Range);
+    glyph->SetOrient(this->Orient);
+    glyph->SetClamping(this->Clamping);
+    glyph->SetVectorMode(this->VectorMode);
+    glyph->SetIndexMode(this->IndexMode);
+    glyph->SetGeneratePointIds(this->GeneratePointIds);
+    glyph->SetPointIdsName(this->PointIdsName);
+    glyph->SetFillCellData(this->FillCellData);
+    glyph->SetOutputPointsPrecision(this->OutputPointsPrecision);
+    if (this->SourceTransform)
+    {
+      vtkNew<vtkTransform> transform;
+      transform->DeepCopy(this->SourceTransform);
+      glyph->SetSourceTransform(transform.GetPointer());
+    }
+    chunk.Output = vtkSmartPointer<vtkPolyData>::New();
+  }
+
+  vtkGlyphChunksFunctor glyphChunks = { input,
+    inputPoints ? static_cast<const char*>(inputPoints->GetVoidPointer(0)) : NULL,
+    inputPoints ? inputPoints->GetDataTypeSize() * 3 : 0, &inputPointData,
+    pointIds.empty() ? NULL : &pointIds[0], &chunks[0], scalarsIndex, vectorsIndex };
+  vtkSMPTools::For(0, numChunks, 1, glyphChunks);
+
+  int pointIdsIndex = -1;
+  vtkPolyData* first = chunks[0].Output;
+  if (this->GeneratePointIds)
+  {
+    first->GetPointData()->GetArray(this->PointIdsName, pointIdsIndex);
+    if (pointIdsIndex >= 0 &&
+      !vtkIdTypeArray::SafeDownCast(first->GetPointData()->GetArray(pointIdsIndex)))
+    {
+      pointIdsIndex = -1;
+    }
+  }
+
+  if (numChunks == 1)
+  {
+    // ... no copy needed, only map the point ids back to the input ...
+    if (pointIdsIndex >= 0)
+    {
+      vtkIdTypeArray* ids =
+        vtkIdTypeArray::SafeDownCast(first->GetPointData()->GetArray(pointIdsIndex));
+      for (vtkIdType cc = 0; cc < ids->GetNumberOfTuples(); ++cc)
+      {
+        ids->SetValue(cc, pointIds[ids->GetValue(cc)]);
+      }
+    }
+    output->ShallowCopy(first);
+    return true;
+  }
+
+  // ... allocate the output like the first chunk and copy the chunks ...
+  vtkIdType numOutPts = 0, numOutCells = 0, connectivitySize = 0;
+  for (vtkIdType cc = 0; cc < numChunks; ++cc)
+  {
+    vtkGlyphChunk& chunk = chunks[cc];
+    vtkCellArray* cells = GetCellArray(chunk.Output, cellType);
+    chunk.PointOffset = numOutPts;
+    chunk.CellOffset = numOutCells;
+    chunk.ConnectivityOffset = connectivitySize;
+    numOutPts += chunk.Output->GetNumberOfPoints();
+    numOutCells += cells->GetNumberOfCells();
+    connectivitySize += cells->GetNumberOfConnectivityEntries();
+  }
+
+  vtkNew<vtkPoints> outPoints;
+  outPoints->SetDataType(first->GetPoints() ? first->GetPoints()->GetDataType() : VTK_FLOAT);
+  outPoints->SetNumberOfPoints(numOutPts);
+  output->SetPoints(outPoints.GetPointer());
+
+  vtkNew<vtkCellArray> outCells;
+  outCells->WritePointer(numOutCells, connectivitySize);
+  switch (cellType)
+  {
+    case 0:
+      output->SetVerts(outCells.GetPointer());
+      break;
+    case 1:
+      output->SetLines(outCells.GetPointer());
+      break;
+    case 2:
+      output->SetPolys(outCells.GetPointer());
+      break;
+    default:
+      output->SetStrips(outCells.GetPointer());
+  }
+
+  vtkDataSetAttributes* outAttributes[2] = { output->GetPointData(), output->GetCellData() };
+  vtkDataSetAttributes* firstAttributes[2] = { first->GetPointData(), first->GetCellData() };
+  const vtkIdType numTuples[2] = { numOutPts, numOutCells };
+  for (int kk = 0; kk < 2; ++kk)
+  {
+    for (int a = 0; a < firstAttributes[kk]->GetNumberOfArrays(); ++a)
+    {
+      vtkDataArray* array = firstAttributes[kk]->GetArray(a);
+      vtkDataArray* copy = array->NewInstance();
+      copy->SetName(array->GetName());
+      copy->SetNumberOfComponents(array->GetNumberOfComponents());
+      copy->SetNumberOfTuples(numTuples[kk]);
+      outAttributes[kk]->AddArray(copy);
+      copy->Delete();
+    }
+    int attributes[vtkDataSetAttributes::NUM_ATTRIBUTES];
+    firstAttributes[kk]->GetAttributeIndices(attributes);
+    for (int attr = 0; attr < vtkDataSetAttributes::NUM_ATTRIBUTES; ++attr)
+    {
+      if (attributes[attr] >= 0)
+      {
+        outAttributes[kk]->SetActiveAttribute(attributes[attr], attr);
+      }
+    }
+  }
+
+  vtkRawArrays outPointData, outCellData;
+  outPointData.Set(output->GetPointData());
+  outCellData.Set(output->GetCellData());
+  vtkMergeGlyphsFunctor merge = { &chunks[0], cellType, outCells->GetPointer(),
+    static_cast<char*>(outPoints->GetVoidPointer(0)), outPoints->GetData()->GetDataTypeSize() * 3,
+    &outPointData, &outCellData, pointIdsIndex, pointIds.empty() ? NULL : &pointIds[0] };
+  vtkSMPTools::For(0, numChunks, 1, merge);
+  return true;
+}
+
 //-----------------------------------------------------------------------------
 void vtkPVGlyphFilter::PrintSelf(ostream& os, vtkIndent indent)
 {
@@ -517,5 +1191,6 @@ void vtkPVGlyphFilter::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "MaximumNumberOfSamplePoints: " << this->MaximumNumberOfSamplePoints << endl;
   os << indent << "Seed: " << this->Seed << endl;
   os << indent << "Stride: " << this->Stride << endl;
+  os << indent << "UseMultithreading: " << this->UseMultithreading << endl;
   os << indent << "Controller: " << this->Controller << endl;
 }
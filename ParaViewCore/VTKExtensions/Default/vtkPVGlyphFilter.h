@@ -34,7 +34,15 @@
  * can be used to limit the number of sample points used for random sampling. This
  * doesn't not equal the number of points actually glyphed, since that depends on
  * several factors. In parallel, this filter ensures that spatial bounds are collected
- * across all ranks for generating identical sample points.
+ * across all ranks for generating identical sample points. The points of each
+ * dataset are sorted in a uniform grid of bins to find the point closest to
+ * each sample point, the samples being processed in parallel using vtkSMPTools.
+ *
+ * When \c UseMultithreading is on, large inputs are split into contiguous
+ * ranges of glyphed points which are glyphed in parallel by separate vtkGlyph3D
+ * instances. The pieces are then copied into the preallocated output arrays,
+ * in order, so that the output is the same as the one of the serial code and
+ * does not depend on the number of threads.
 */
 
 #ifndef vtkPVGlyphFilter_h
@@ -102,6 +110,17 @@ public:
   vtkGetMacro(MaximumNumberOfSamplePoints, int);
   //@}
 
+  //@{
+  /**
+   * Enable/disable glyphing the points in parallel. Small inputs, indexed
+   * glyphs and glyph sources mixing several kinds of cells are always glyphed
+   * serially. Default is on.
+   */
+  vtkSetMacro(UseMultithreading, bool);
+  vtkGetMacro(UseMultithreading, bool);
+  vtkBooleanMacro(UseMultithreading, bool);
+  //@}
+
   //@{
   /**
    * Overridden to create output data of appropriate type.
@@ -152,10 +171,25 @@ protected:
   virtual bool ExecuteWithCellCenters(
     vtkDataSet* input, vtkInformationVector* sourceVector, vtkPolyData* output);
 
+  /**
+   * Glyphs the points of \c input with ExecuteMultithreaded() when enabled and
+   * supported, with vtkGlyph3D::Execute() otherwise.
+   */
+  bool ExecuteGlyphs(vtkDataSet* input, vtkInformationVector* sourceVector, vtkPolyData* output,
+    vtkDataArray* inSScalars, vtkDataArray* inVectors);
+
+  /**
+   * Multithreaded glyphing. Returns false if the input is not supported, in
+   * which case the output is left untouched.
+   */
+  bool ExecuteMultithreaded(vtkDataSet* input, vtkInformationVector* sourceVector,
+    vtkPolyData* output, vtkDataArray* inSScalars, vtkDataArray* inVectors);
+
   int GlyphMode;
   int MaximumNumberOfSamplePoints;
   int Seed;
   int Stride;
+  bool UseMultithreading;
   vtkMultiProcessController* Controller;
 
 private:
@@ -60,6 +60,27 @@ struct vtkPhastaReaderInternal
 
   typedef std::map<std::string, FieldInfo> FieldInfoMapType;
   FieldInfoMapType FieldInfoMap;
+
+  // Offset of the headers found in the last field file read for each
+  // geometry file, i.e. for each piece, by phasta field tag. The field files
+  // of a piece have the same layout at every time step.
+  typedef std::map<std::string, std::map<std::string, long> > HeaderOffsetsMapType;
+  HeaderOffsetsMapType HeaderOffsets;
+
+  // A block of a field file, read once even when several fields use it.
+  struct FieldBlock
+  {
+    int NumberOfDatas;
+    int NumberOfVariables;
+    std::vector<double> DoubleData;
+    std::vector<float> FloatData;
+
+    FieldBlock()
+      : NumberOfDatas(0)
+      , NumberOfVariables(0)
+    {
+    }
+  };
 };
 
 // Begin of copy from phastaIO
@@ -77,6 +98,7 @@ std::vector<int> byte_order;
 std::vector<int> header_type;
 int DataSize = 0;
 int LastHeaderNotFound = 0;
+long LastHeaderOffset = -1;
 int Wrong_Endian = 0;
 int Strict_Error = 0;
 int binary_format = 0;
@@ -186,11 +208,13 @@ int vtkPhastaReader::readHeader(FILE* fileObject, const char phrase[], int* para
   int skip_size, integer_value;
   int rewind_count = 0;
 
+  long line_start = ftell(fileObject);
   if (!fgets(Line, 1024, fileObject) && feof(fileObject))
   {
     rewind(fileObject);
     clearerr(fileObject);
     rewind_count++;
+    line_start = ftell(fileObject);
     fgets(Line, 1024, fileObject);
   }
 
@@ -205,6 +229,7 @@ int vtkPhastaReader::readHeader(FILE* fileObject, const char phrase[], int* para
       if (cscompare(phrase, token))
       {
         FOUND = 1;
+        LastHeaderOffset = line_start;
         token = strtok(NULL, " ,;<>");
         skip_size = atoi(token);
         int i;
@@ -255,11 +280,13 @@ int vtkPhastaReader::readHeader(FILE* fileObject, const char phrase[], int* para
 
     if (!FOUND)
     {
+      line_start = ftell(fileObject);
       if (!fgets(Line, 1024, fileObject) && feof(fileObject))
       {
         rewind(fileObject);
         clearerr(fileObject);
         rewind_count++;
+        line_start = ftell(fileObject);
         fgets(Line, 1024, fileObject);
       }
     }
@@ -461,6 +488,44 @@ void vtkPhastaReader::readdatablock(int* fileDescriptor, const char keyphrase[],
 
 // End of copy from phastaIO
 
+void vtkPhastaReader::ReadFieldHeader(
+  int* fileDescriptor, const char keyphrase[], int* array, int* expect, const char datatype[])
+{
+  // readheader scans the file from the current position, wrapping around at
+  // the end, for the first header matching keyphrase. Starting where the
+  // header was in the previous field file of this piece avoids scanning the
+  // headers of all the blocks in between, and does not change the result
+  // when the layout is different.
+  std::map<std::string, long>& offsets =
+    this->Internal->HeaderOffsets[this->GeometryFileName ? this->GeometryFileName : ""];
+  std::map<std::string, long>::iterator hint = offsets.find(keyphrase);
+  if (*fileDescriptor >= 1 && *fileDescriptor <= (int)fileArray.size() && hint != offsets.end())
+  {
+    FILE* fileObject = fileArray[*fileDescriptor - 1];
+    long current = ftell(fileObject);
+    char line[1024];
+    bool isHeader = false;
+    if (fseek(fileObject, hint->second, SEEK_SET) == 0 && fgets(line, 1024, fileObject))
+    {
+      char* colon = strchr(line, ':');
+      if (colon)
+      {
+        *colon = '\0';
+        isHeader = cscompare(keyphrase, line) != 0;
+      }
+    }
+    clearerr(fileObject);
+    fseek(fileObject, isHeader ? hint->second : current, SEEK_SET);
+  }
+
+  LastHeaderOffset = -1;
+  readheader(fileDescriptor, keyphrase, array, expect, datatype, "binary");
+  if (!LastHeaderNotFound && LastHeaderOffset >= 0)
+  {
+    offsets[keyphrase] = LastHeaderOffset;
+  }
+}
+
 vtkPhastaReader::vtkPhastaReader()
 {
   this->GeometryFileName = NULL;
@@ -804,7 +869,7 @@ void vtkPhastaReader::ReadFieldFile(
   temperature->SetName("temperature");
 
   expect = 3;
-  readheader(&fieldfile, "solution", array, &expect, "double", "binary");
+  this->ReadFieldHeader(&fieldfile, "solution", array, &expect, "double");
   noOfNodes = array[0];
   this->NumberOfVariables = array[1];
 
@@ -888,6 +953,11 @@ void vtkPhastaReader::ReadFieldFile(
 
   int activeScalars = 0, activeTensors = 0;
 
+  // Fields are often components of the same block, e.g. pressure, velocity
+  // and temperature all come from "solution", so blocks are kept by phasta
+  // field tag and data type until the file is read.
+  std::map<std::pair<std::string, std::string>, vtkPhastaReaderInternal::FieldBlock> blocks;
+
   vtkPhastaReaderInternal::FieldInfoMapType::iterator it = this->Internal->FieldInfoMap.begin();
   vtkPhastaReaderInternal::FieldInfoMapType::iterator itend = this->Internal->FieldInfoMap.end();
   for (; it != itend; it++)
@@ -928,11 +998,19 @@ void vtkPhastaReader::ReadFieldFile(
     dataArray->SetName(paraviewFieldTag);
     dataArray->SetNumberOfComponents(numOfComps);
 
-    expect = 3;
-    readheader(&fieldfile, phastaFieldTag, array, &expect, dataType, "binary");
-    noOfDatas = array[0];
-    this->NumberOfVariables = array[1];
-    numOfVars = array[1];
+    vtkPhastaReaderInternal::FieldBlock& block =
+      blocks[std::make_pair(it->second.PhastaFieldTag, it->second.DataType)];
+    bool readBlock = block.DoubleData.empty() && block.FloatData.empty();
+    if (readBlock)
+    {
+      expect = 3;
+      this->ReadFieldHeader(&fieldfile, phastaFieldTag, array, &expect, dataType);
+      block.NumberOfDatas = array[0];
+      block.NumberOfVariables = array[1];
+    }
+    noOfDatas = block.NumberOfDatas;
+    this->NumberOfVariables = block.NumberOfVariables;
+    numOfVars = block.NumberOfVariables;
     dataArray->SetNumberOfTuples(noOfDatas);
 
     if (index < 0 || index > numOfVars - 1)
@@ -960,18 +1038,13 @@ void vtkPhastaReader::ReadFieldFile(
     if (dtype == 0)
     { // data is type double
 
-      double* data;
-      data = new double[item];
-
-      if (data == NULL)
+      if (readBlock && item > 0)
       {
-        vtkErrorMacro(<< "Unable to allocate memory for field info");
-
-        dataArray->Delete();
-        continue;
+        block.DoubleData.resize(item);
+        readdatablock(
+          &fieldfile, phastaFieldTag, &block.DoubleData[0], &item, dataType, "binary");
       }
-
-      readdatablock(&fieldfile, phastaFieldTag, data, &item, dataType, "binary");
+      const double* data = block.DoubleData.empty() ? NULL : &block.DoubleData[0];
 
       switch (numOfComps)
       {
@@ -1027,28 +1100,19 @@ void vtkPhastaReader::ReadFieldFile(
           vtkErrorMacro("number of components [" << numOfComps << "] NOT supported");
 
           dataArray->Delete();
-          delete[] data;
           continue;
       }
-
-      // clean up
-      delete[] data;
     }
     else if (dtype == 1)
     { // data is type float
 
-      float* data;
-      data = new float[item];
-
-      if (data == NULL)
+      if (readBlock && item > 0)
       {
-        vtkErrorMacro(<< "Unable to allocate memory for field info");
-
-        dataArray->Delete();
-        continue;
+        block.FloatData.resize(item);
+        readdatablock(
+          &fieldfile, phastaFieldTag, &block.FloatData[0], &item, dataType, "binary");
       }
-
-      readdatablock(&fieldfile, phastaFieldTag, data, &item, dataType, "binary");
+      const float* data = block.FloatData.empty() ? NULL : &block.FloatData[0];
 
       switch (numOfComps)
       {
@@ -1124,12 +1188,8 @@ void vtkPhastaReader::ReadFieldFile(
           vtkErrorMacro("number of components [" << numOfComps << "] NOT supported");
 
           dataArray->Delete();
-          delete[] data;
           continue;
       }
-
-      // clean up
-      delete[] data;
     }
     else
     {
@@ -84,6 +84,13 @@ protected:
   void ReadFieldFile(
     char* fieldFileName, int firstVertexNo, vtkUnstructuredGrid* output, int& noOfDatas);
 
+  /**
+   * Reads the header of a field file block, looking for it first where it
+   * was in the previous field file read for the same geometry file.
+   */
+  void ReadFieldHeader(
+    int* fileDescriptor, const char keyphrase[], int* array, int* expect, const char datatype[]);
+
 private:
   char* GeometryFileName;
   char* FieldFileName;
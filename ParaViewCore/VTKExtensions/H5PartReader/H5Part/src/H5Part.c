@@ -187,11 +187,18 @@ _H5Part_open_file (
    HANDLE_H5P_CREATE_ERR;
    goto error_cleanup;
   }
-#if defined(PARALLEL_IO) && defined(H5_HAVE_PARALLEL)
+#if defined(H5_HAVE_PARALLEL)
   if (H5Pset_fapl_mpio (f->access_prop, comm, info) < 0) {
    HANDLE_H5P_SET_FAPL_MPIO_ERR;
    goto error_cleanup;
   }
+#if H5_VERSION_GE(1,10,0)
+  /* let one process read the metadata and broadcast it to the others,
+     instead of all of them hitting the file system for it */
+  if ( flags == H5PART_READ ) {
+   H5Pset_all_coll_metadata_ops (f->access_prop, 1);
+  }
+#endif
 #endif  
   /* f->create_prop = H5Pcreate(H5P_FILE_CREATE); */
   f->create_prop = H5P_DEFAULT;
@@ -205,7 +212,7 @@ _H5Part_open_file (
      HANDLE_H5P_CREATE_ERR;
      goto error_cleanup;
     }
-#if defined(PARALLEL_IO) && defined(H5_HAVE_PARALLEL)
+#if defined(H5_HAVE_PARALLEL)
     if (H5Pset_dxpl_mpio (f->xfer_prop,H5FD_MPIO_COLLECTIVE) < 0) {
      HANDLE_H5P_SET_DXPL_MPIO_ERR;
      goto error_cleanup;
@@ -290,7 +297,7 @@ _H5Part_open_file (
  return NULL;
 }
 
-#ifdef PARALLEL_IO
+#ifdef H5PART_HAS_MPI
 /*!
   \ingroup h5part_openclose
 
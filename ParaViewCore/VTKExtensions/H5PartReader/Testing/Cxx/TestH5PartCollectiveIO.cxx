@@ -0,0 +1,245 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestH5PartCollectiveIO.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include "vtkDataArray.h"
+#include "vtkH5PartReader.h"
+#include "vtkMPIController.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkTestUtilities.h"
+
+#include "vtk_hdf5.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#define TEST_SUCCESS 0
+#define TEST_FAILED 1
+
+namespace
+{
+// Not a multiple of the usual process counts, so that pieces differ in size.
+const int NumberOfParticles = 1001;
+const int NumberOfSteps = 2;
+
+void WriteDataset(hid_t group, const char* name, hid_t type, const void* values)
+{
+  hsize_t dims[1] = { static_cast<hsize_t>(NumberOfParticles) };
+  hid_t space = H5Screate_simple(1, dims, NULL);
+  hid_t dataset = H5Dcreate2(group, name, type, space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  H5Dwrite(dataset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, values);
+  H5Dclose(dataset);
+  H5Sclose(space);
+}
+
+// Writes the H5Part layout with plain HDF5: one "Step#<n>" group per step,
+// with a "TimeValue" attribute and one 1-D dataset per array and component.
+bool WriteFile(const std::string& fileName)
+{
+  hid_t file = H5Fcreate(fileName.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+  if (file < 0)
+  {
+    cerr << "Could not create " << fileName << endl;
+    return false;
+  }
+  std::vector<double> coords[3];
+  std::vector<double> temperature(NumberOfParticles);
+  std::vector<float> velocity[3];
+  std::vector<int> ids(NumberOfParticles);
+  for (int cc = 0; cc < 3; ++cc)
+  {
+    coords[cc].resize(NumberOfParticles);
+    velocity[cc].resize(NumberOfParticles);
+  }
+  for (int step = 0; step < NumberOfSteps; ++step)
+  {
+    for (int ii = 0; ii < NumberOfParticles; ++ii)
+    {
+      coords[0][ii] = ii;
+      coords[1][ii] = 2.0 * ii + step;
+      coords[2][ii] = -ii;
+      temperature[ii] = 0.5 * ii + step;
+      velocity[0][ii] = static_cast<float>(step);
+      velocity[1][ii] = static_cast<float>(ii);
+      velocity[2][ii] = static_cast<float>(-ii);
+      ids[ii] = ii;
+    }
+
+    char groupName[64];
+    snprintf(groupName, sizeof(groupName), "Step#%d", step);
+    hid_t group = H5Gcreate2(file, groupName, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    const double time = step;
+    hid_t scalar = H5Screate(H5S_SCALAR);
+    hid_t attribute =
+      H5Acreate2(group, "TimeValue", H5T_NATIVE_DOUBLE, scalar, H5P_DEFAULT, H5P_DEFAULT);
+    H5Awrite(attribute, H5T_NATIVE_DOUBLE, &time);
+    H5Aclose(attribute);
+    H5Sclose(scalar);
+
+    WriteDataset(group, "x", H5T_NATIVE_DOUBLE, &coords[0][0]);
+    WriteDataset(group, "y", H5T_NATIVE_DOUBLE, &coords[1][0]);
+    WriteDataset(group, "z", H5T_NATIVE_DOUBLE, &coords[2][0]);
+    WriteDataset(group, "temperature", H5T_NATIVE_DOUBLE, &temperature[0]);
+    // Combined into a 3 component "velocity" array by the reader.
+    WriteDataset(group, "velocity_0", H5T_NATIVE_FLOAT, &velocity[0][0]);
+    WriteDataset(group, "velocity_1", H5T_NATIVE_FLOAT, &velocity[1][0]);
+    WriteDataset(group, "velocity_2", H5T_NATIVE_FLOAT, &velocity[2][0]);
+    WriteDataset(group, "id", H5T_NATIVE_INT, &ids[0]);
+    H5Gclose(group);
+  }
+  H5Fclose(file);
+  return true;
+}
+
+// Reads all steps with one reader, which keeps the file open until it is
+// deleted, so that the file is never open with both drivers at once.
+void ReadSteps(const std::string& fileName, bool useCollectiveIO, int piece, int numPieces,
+  std::vector<vtkSmartPointer<vtkPolyData> >& outputs)
+{
+  vtkNew<vtkH5PartReader> reader;
+  reader->SetFileName(const_cast<char*>(fileName.c_str()));
+  reader->SetUseCollectiveIO(useCollectiveIO ? 1 : 0);
+  for (int step = 0; step < NumberOfSteps; ++step)
+  {
+    reader->UpdateTimeStep(step, piece, numPieces, 0);
+    vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+    output->DeepCopy(reader->GetOutput());
+    outputs.push_back(output);
+  }
+}
+
+bool SameArrays(vtkDataArray* first, vtkDataArray* second, const char* name)
+{
+  if (!first || !second)
+  {
+    cerr << "Missing array " << name << endl;
+    return false;
+  }
+  if (first->GetDataType() != second->GetDataType() ||
+    first->GetNumberOfTuples() != second->GetNumberOfTuples() ||
+    first->GetNumberOfComponents() != second->GetNumberOfComponents())
+  {
+    cerr << "Array " << name << " has another type or size." << endl;
+    return false;
+  }
+  for (vtkIdType cc = 0; cc < first->GetNumberOfTuples(); ++cc)
+  {
+    for (int kk = 0; kk < first->GetNumberOfComponents(); ++kk)
+    {
+      if (first->GetComponent(cc, kk) != second->GetComponent(cc, kk))
+      {
+        cerr << "Array " << name << " differs at tuple " << cc << endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Both reads must give the values written for this piece of the step.
+bool CheckOutput(vtkPolyData* independent, vtkPolyData* collective, int piece, int numPieces,
+  int step)
+{
+  const int div = NumberOfParticles / numPieces;
+  const int rem = NumberOfParticles % numPieces;
+  const vtkIdType count = piece < rem ? div + 1 : div;
+  const vtkIdType offset = piece < rem ? (div + 1) * piece : (div + 1) * rem + div * (piece - rem);
+  if (!independent->GetPoints() || !collective->GetPoints())
+  {
+    cerr << "Missing particles for step " << step << endl;
+    return false;
+  }
+  if (independent->GetNumberOfPoints() != count)
+  {
+    cerr << "Piece " << piece << " has " << independent->GetNumberOfPoints()
+         << " particles, expected " << count << endl;
+    return false;
+  }
+  vtkDataArray* coords = independent->GetPoints()->GetData();
+  vtkDataArray* temperature = independent->GetPointData()->GetArray("temperature");
+  vtkDataArray* velocity = independent->GetPointData()->GetArray("velocity");
+  if (!temperature || !velocity || velocity->GetNumberOfComponents() != 3)
+  {
+    cerr << "Missing arrays." << endl;
+    return false;
+  }
+  for (vtkIdType cc = 0; cc < count; ++cc)
+  {
+    const double ii = static_cast<double>(offset + cc);
+    if (coords->GetComponent(cc, 0) != ii || coords->GetComponent(cc, 1) != 2.0 * ii + step ||
+      coords->GetComponent(cc, 2) != -ii || temperature->GetComponent(cc, 0) != 0.5 * ii + step ||
+      velocity->GetComponent(cc, 0) != step || velocity->GetComponent(cc, 1) != ii ||
+      velocity->GetComponent(cc, 2) != -ii)
+    {
+      cerr << "Wrong values for particle " << offset + cc << " of step " << step << endl;
+      return false;
+    }
+  }
+
+  const char* names[3] = { "temperature", "velocity", "id" };
+  bool same = SameArrays(coords, collective->GetPoints()->GetData(), "Points");
+  for (int cc = 0; same && cc < 3; ++cc)
+  {
+    same = SameArrays(independent->GetPointData()->GetArray(names[cc]),
+      collective->GetPointData()->GetArray(names[cc]), names[cc]);
+  }
+  return same;
+}
+}
+
+int TestH5PartCollectiveIO(int argc, char* argv[])
+{
+  vtkNew<vtkMPIController> controller;
+  controller->Initialize(&argc, &argv, 0);
+  vtkMultiProcessController::SetGlobalController(controller.GetPointer());
+  const int myId = controller->GetLocalProcessId();
+  const int numProcs = controller->GetNumberOfProcesses();
+
+  char* tempDir =
+    vtkTestUtilities::GetArgOrEnvOrDefault("-T", argc, argv, "VTK_TEMP_DIR", "Testing/Temporary");
+  const std::string fileName = std::string(tempDir) + "/TestH5PartCollectiveIO.h5part";
+  delete[] tempDir;
+
+  int valid = 1;
+  if (myId == 0)
+  {
+    valid = WriteFile(fileName) ? 1 : 0;
+  }
+  controller->Broadcast(&valid, 1, 0);
+
+  // Collective reads are only used when HDF5 has parallel support; the
+  // reader falls back to independent reads otherwise, and the outputs must
+  // be the same either way.
+  std::vector<vtkSmartPointer<vtkPolyData> > independent;
+  std::vector<vtkSmartPointer<vtkPolyData> > collective;
+  if (valid)
+  {
+    ReadSteps(fileName, false, myId, numProcs, independent);
+    ReadSteps(fileName, true, myId, numProcs, collective);
+  }
+  for (int step = 0; valid && step < NumberOfSteps; ++step)
+  {
+    int localValid = CheckOutput(independent[step], collective[step], myId, numProcs, step) ? 1 : 0;
+    controller->AllReduce(&localValid, &valid, 1, vtkCommunicator::MIN_OP);
+  }
+
+  vtkMultiProcessController::SetGlobalController(NULL);
+  controller->Finalize();
+  return valid ? TEST_SUCCESS : TEST_FAILED;
+}
@@ -1,3 +1,8 @@
+set (__dependencies)
+if (PARAVIEW_USE_MPI)
+  set (__dependencies vtkParallelMPI)
+endif()
+
 vtk_module(vtkPVVTKExtensionsH5PartReader
     DEPENDS
       vtkCommonCore
@@ -8,10 +13,13 @@ vtk_module(vtkPVVTKExtensionsH5PartReader
       vtkcgns
       vtkhdf5
       vtksys
+      ${__dependencies}
     TEST_DEPENDS
+      vtkhdf5
       vtkInteractionStyle
       vtkTestingCore
       vtkTestingRendering
+      ${__dependencies}
     TEST_LABELS
       PARAVIEW
     KIT
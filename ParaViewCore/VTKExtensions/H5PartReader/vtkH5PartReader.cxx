@@ -77,11 +77,17 @@
 #include <functional>
 
 #include "H5Part.h"
+
+#if defined(H5PART_HAS_MPI) && defined(H5_HAVE_PARALLEL)
+#include "vtkMPI.h"
+#include "vtkMPICommunicator.h"
+#include "vtkMPIController.h"
+#endif
 //----------------------------------------------------------------------------
 /*!
   \ingroup h5part_utility
 
-  This function can be used to query the Type of a dataset
+  This function can be used to query the Type of an open dataset
   It is not used by the core H5Part library but is useful when
   reading generic data from the file.
   An example of usage would be (H5Tequal(datatype,H5T_NATIVE_FLOAT))
@@ -89,21 +95,37 @@
 
   \return  \c an hdf5 handle to the native type of the data
 */
-static hid_t H5PartGetNativeDatasetType(H5PartFile* f, const char* name)
+static hid_t H5PartGetNativeDatasetType(hid_t dataset)
 {
-  hid_t dataset, datatype, datatypen;
-  if (!f->timegroup)
-  {
-    H5PartSetStep(f, f->timestep); /* choose current step */
-  }
-  dataset = H5Dopen(f->timegroup, name);
+  hid_t datatype, datatypen;
   datatype = H5Dget_type(dataset);
   datatypen = H5Tget_native_type(datatype, H5T_DIR_DEFAULT);
   H5Tclose(datatype);
-  H5Dclose(dataset);
   return datatypen;
 }
 
+#if defined(H5PART_HAS_MPI) && defined(H5_HAVE_PARALLEL)
+//----------------------------------------------------------------------------
+// Returns the communicator to open files with for collective I/O, or
+// MPI_COMM_NULL when not running on several MPI processes.
+static MPI_Comm H5PartGetCommunicator()
+{
+  vtkMPIController* controller =
+    vtkMPIController::SafeDownCast(vtkMultiProcessController::GetGlobalController());
+  if (!controller || controller->GetNumberOfProcesses() < 2)
+  {
+    return MPI_COMM_NULL;
+  }
+  vtkMPICommunicator* communicator =
+    vtkMPICommunicator::SafeDownCast(controller->GetCommunicator());
+  if (!communicator)
+  {
+    return MPI_COMM_NULL;
+  }
+  return *communicator->GetMPIComm()->GetHandle();
+}
+#endif
+
 //----------------------------------------------------------------------------
 static hid_t H5PartGetDiskShape(H5PartFile* f, hid_t dataset)
 {
@@ -177,6 +199,7 @@ vtkH5PartReader::vtkH5PartReader()
   this->Zarray = nullptr;
   this->TimeOutOfRange = 0;
   this->MaskOutOfTimeRangeOutput = 0;
+  this->UseCollectiveIO = 0;
   this->PointDataArraySelection = vtkDataArraySelection::New();
 }
 
@@ -222,6 +245,18 @@ void vtkH5PartReader::SetFileName(char* filename)
   this->Modified();
 }
 //----------------------------------------------------------------------------
+void vtkH5PartReader::SetUseCollectiveIO(int use)
+{
+  if (this->UseCollectiveIO == use)
+  {
+    return;
+  }
+  this->UseCollectiveIO = use;
+  // the file must be opened again with the other driver.
+  this->FileModifiedTime.Modified();
+  this->Modified();
+}
+//----------------------------------------------------------------------------
 void vtkH5PartReader::CloseFile()
 {
   if (this->H5FileId != nullptr)
@@ -246,7 +281,17 @@ int vtkH5PartReader::OpenFile()
 
   if (!this->H5FileId)
   {
-    this->H5FileId = H5PartOpenFile(this->FileName, H5PART_READ);
+#if defined(H5PART_HAS_MPI) && defined(H5_HAVE_PARALLEL)
+    MPI_Comm comm = this->UseCollectiveIO ? H5PartGetCommunicator() : MPI_COMM_NULL;
+    if (comm != MPI_COMM_NULL)
+    {
+      this->H5FileId = H5PartOpenFileParallel(this->FileName, H5PART_READ, comm);
+    }
+    else
+#endif
+    {
+      this->H5FileId = H5PartOpenFile(this->FileName, H5PART_READ);
+    }
     this->FileOpenedTime.Modified();
   }
 
@@ -698,6 +743,10 @@ int vtkH5PartReader::RequestData(vtkInformation* vtkNotUsed(request),
     return 1;
   }
 
+  // When the file is opened for collective I/O, all processes must take part
+  // in every read, even those that have no particles to read.
+  const bool collective = this->H5FileId->nprocs > 1;
+
   // Set the TimeStep on the H5 file
   H5PartSetStep(this->H5FileId, this->ActualTimeStep);
   // Get the number of points for this step
@@ -719,6 +768,10 @@ int vtkH5PartReader::RequestData(vtkInformation* vtkNotUsed(request),
       H5PartSetView(this->H5FileId, -1, -1);
     }
   }
+  else if (collective)
+  {
+    Nt = 0;
+  }
   else
   {
     // don't do anything.
@@ -735,72 +788,78 @@ int vtkH5PartReader::RequestData(vtkInformation* vtkNotUsed(request),
     const char* array_name = arraylist[0].c_str();
     std::string rootname = this->NameOfVectorComponent(array_name);
     int Nc = static_cast<int>(arraylist.size());
-    //
-    vtkSmartPointer<vtkDataArray> dataarray = nullptr;
-    hid_t datatype = H5PartGetNativeDatasetType(H5FileId, array_name);
-    int vtk_datatype = GetVTKDataType(datatype);
 
-    if (vtk_datatype != VTK_VOID)
+    // Open each dataset once. The type of the first one is used for the
+    // whole array, H5Dread converts the other components to it.
+    std::vector<hid_t> datasets(Nc);
+    for (int c = 0; c < Nc; c++)
+    {
+      datasets[c] = H5Dopen(this->H5FileId->timegroup, arraylist[c].c_str());
+    }
+    hid_t datatype = datasets[0] >= 0 ? H5PartGetNativeDatasetType(datasets[0]) : -1;
+    int vtk_datatype = datatype >= 0 ? GetVTKDataType(datatype) : VTK_VOID;
+    if (vtk_datatype == VTK_VOID)
     {
-      dataarray.TakeReference(vtkDataArray::CreateDataArray(vtk_datatype));
-      dataarray->SetNumberOfComponents(Nc);
-      dataarray->SetNumberOfTuples(Nt);
-      dataarray->SetName(rootname.c_str());
-
-      // now read the data components.
-      hsize_t count1_mem[] = { static_cast<hsize_t>(Nt * Nc) };
-      hsize_t count2_mem[] = { static_cast<hsize_t>(Nt) };
-      hsize_t offset_mem[] = { 0 };
-      hsize_t stride_mem[] = { static_cast<hsize_t>(Nc) };
       for (int c = 0; c < Nc; c++)
       {
-        const char* name = arraylist[c].c_str();
-        hid_t dataset = H5Dopen(H5FileId->timegroup, name);
-        hid_t diskshape = H5PartGetDiskShape(H5FileId, dataset);
-        hid_t memspace = H5Screate_simple(1, count1_mem, nullptr);
-        hid_t component_datatype = H5PartGetNativeDatasetType(H5FileId, name);
-        offset_mem[0] = c;
-        H5Sselect_hyperslab(memspace, H5S_SELECT_SET, offset_mem, stride_mem, count2_mem, nullptr);
-
-        if (H5Tequal(component_datatype, datatype) > 0)
-        {
-          H5Dread(
-            dataset, datatype, memspace, diskshape, H5P_DEFAULT, dataarray->GetVoidPointer(0));
-        }
-        else
-        {
-          // read data into a temporary array of the right type and then copy it
-          // over to the "dataarray".
-          // This can be optimized to create a single component array. But I
-          // don't understand the stride/offset stuff too well to fix that.
-          vtkDataArray* temparray =
-            vtkDataArray::CreateDataArray(GetVTKDataType(component_datatype));
-          temparray->SetNumberOfComponents(Nc);
-          temparray->SetNumberOfTuples(Nt);
-          H5Sselect_hyperslab(
-            memspace, H5S_SELECT_SET, offset_mem, stride_mem, count2_mem, nullptr);
-          H5Dread(dataset, component_datatype, memspace, diskshape, H5P_DEFAULT,
-            temparray->GetVoidPointer(0));
-          dataarray->CopyComponent(c, temparray, c);
-          temparray->Delete();
-        }
-        if (memspace != H5S_ALL)
-        {
-          H5Sclose(memspace);
-        }
-        if (diskshape != H5S_ALL)
+        if (datasets[c] >= 0)
         {
-          H5Sclose(diskshape);
+          H5Dclose(datasets[c]);
         }
-        H5Dclose(dataset);
       }
-    }
-    else
-    {
-      H5Tclose(datatype);
+      if (datatype >= 0)
+      {
+        H5Tclose(datatype);
+      }
       vtkErrorMacro("An unexpected data type was encountered");
       return 0;
     }
+
+    vtkSmartPointer<vtkDataArray> dataarray;
+    dataarray.TakeReference(vtkDataArray::CreateDataArray(vtk_datatype));
+    dataarray->SetNumberOfComponents(Nc);
+    dataarray->SetNumberOfTuples(Nt);
+    dataarray->SetName(rootname.c_str());
+
+    // now read the data components, each one straight into its place in
+    // the interleaved array.
+    char empty;
+    void* buffer = Nt > 0 ? dataarray->GetVoidPointer(0) : &empty;
+    hsize_t count1_mem[] = { static_cast<hsize_t>(Nt > 0 ? Nt * Nc : 1) };
+    hsize_t count2_mem[] = { static_cast<hsize_t>(Nt) };
+    hsize_t offset_mem[] = { 0 };
+    hsize_t stride_mem[] = { static_cast<hsize_t>(Nc) };
+    for (int c = 0; c < Nc; c++)
+    {
+      if (datasets[c] < 0)
+      {
+        // e.g. no Z coordinates for 2D data.
+        dataarray->FillComponent(c, 0.0);
+        continue;
+      }
+      hid_t diskshape = H5PartGetDiskShape(H5FileId, datasets[c]);
+      hid_t memspace = H5Screate_simple(1, count1_mem, nullptr);
+      if (Nt > 0)
+      {
+        offset_mem[0] = c;
+        H5Sselect_hyperslab(memspace, H5S_SELECT_SET, offset_mem, stride_mem, count2_mem, nullptr);
+      }
+      else
+      {
+        H5Sselect_none(memspace);
+        H5Sselect_none(diskshape);
+      }
+      H5Dread(datasets[c], datatype, memspace, diskshape, this->H5FileId->xfer_prop, buffer);
+      if (memspace != H5S_ALL)
+      {
+        H5Sclose(memspace);
+      }
+      if (diskshape != H5S_ALL)
+      {
+        H5Sclose(diskshape);
+      }
+      H5Dclose(datasets[c]);
+    }
     H5Tclose(datatype);
     //
     if (dataarray)
@@ -913,4 +972,6 @@ void vtkH5PartReader::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "FileName: " << (this->FileName ? this->FileName : "(none)") << "\n";
 
   os << indent << "NumberOfSteps: " << this->NumberOfTimeSteps << "\n";
+
+  os << indent << "UseCollectiveIO: " << this->UseCollectiveIO << "\n";
 }
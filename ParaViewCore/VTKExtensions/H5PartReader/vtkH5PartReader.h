@@ -128,6 +128,20 @@ public:
   vtkBooleanMacro(MaskOutOfTimeRangeOutput, int);
   //@}
 
+  //@{
+  /**
+  * When set (default no) and ParaView is running on more than one MPI
+  * process, the file is opened with the MPI-IO driver of HDF5 and the arrays
+  * are read with collective transfers. The file metadata is then read by one
+  * process and broadcast to the others. This requires all processes to
+  * execute the reader together, with the same arrays selected. It has no
+  * effect when HDF5 is not built with parallel support.
+  */
+  void SetUseCollectiveIO(int use);
+  vtkGetMacro(UseCollectiveIO, int);
+  vtkBooleanMacro(UseCollectiveIO, int);
+  //@}
+
   //@{
   /**
   * An H5Part file may contain multiple arrays
@@ -199,6 +213,7 @@ protected:
   vtkTimeStamp FileOpenedTime;
   int MaskOutOfTimeRangeOutput;
   int TimeOutOfRange;
+  int UseCollectiveIO;
   //
   char* Xarray;
   char* Yarray;
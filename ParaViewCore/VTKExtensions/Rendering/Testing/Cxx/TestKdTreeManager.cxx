@@ -0,0 +1,210 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestKdTreeManager.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include "vtkCellArray.h"
+#include "vtkKdTreeManager.h"
+#include "vtkMPIController.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkPKdTree.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+
+#include <vector>
+
+#define TEST_SUCCESS 0
+#define TEST_FAILED 1
+
+namespace
+{
+// Random vertices in `box`. When `corners` is true, the first two vertices
+// are the corners of the box.
+vtkSmartPointer<vtkPolyData> CreateVertices(const double box[6], vtkIdType count, bool corners)
+{
+  vtkNew<vtkPoints> points;
+  vtkNew<vtkCellArray> verts;
+  for (vtkIdType cc = 0; cc < count; ++cc)
+  {
+    double x[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      x[axis] = corners && cc < 2 ? box[2 * axis + cc]
+                                  : vtkMath::Random(box[2 * axis], box[2 * axis + 1]);
+    }
+    vtkIdType ptId = points->InsertNextPoint(x);
+    verts->InsertNextCell(1, &ptId);
+  }
+  vtkSmartPointer<vtkPolyData> data = vtkSmartPointer<vtkPolyData>::New();
+  data->SetPoints(points.GetPointer());
+  data->SetVerts(verts.GetPointer());
+  return data;
+}
+
+// Every piece must get the same number of cells, within 2%, whatever the
+// number of cells of each process.
+bool IsBalanced(vtkKdTreeManager* manager, vtkPolyData* data,
+  vtkMultiProcessController* controller, const char* step)
+{
+  vtkPKdTree* tree = manager->GetKdTree();
+  const int numProcs = controller->GetNumberOfProcesses();
+  std::vector<double> local(numProcs, 0.0);
+  std::vector<double> global(numProcs, 0.0);
+  int valid = 1;
+  for (vtkIdType cc = 0; cc < data->GetNumberOfPoints(); ++cc)
+  {
+    double x[3];
+    data->GetPoint(cc, x);
+    const int region = tree->GetRegionContainingPoint(x[0], x[1], x[2]);
+    const int process = region < 0 ? -1 : tree->GetProcessAssignedToRegion(region);
+    if (process < 0 || process >= numProcs)
+    {
+      valid = 0;
+      continue;
+    }
+    local[process] += 1.0;
+  }
+  int allValid = 0;
+  controller->AllReduce(&valid, &allValid, 1, vtkCommunicator::MIN_OP);
+  controller->AllReduce(&local[0], &global[0], numProcs, vtkCommunicator::SUM_OP);
+  if (!allValid)
+  {
+    cerr << step << ": some cells are not in any piece." << endl;
+    return false;
+  }
+
+  double total = 0.0;
+  for (int cc = 0; cc < numProcs; ++cc)
+  {
+    total += global[cc];
+  }
+  const double average = total / numProcs;
+  for (int cc = 0; cc < numProcs; ++cc)
+  {
+    if (global[cc] < 0.98 * average || global[cc] > 1.02 * average)
+    {
+      cerr << step << ": piece " << cc << " has " << global[cc] << " cells, expected "
+           << average << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+// Replaces the data of the manager and generates the KdTree. Returns true if
+// the KdTree was rebuilt.
+bool Generate(vtkKdTreeManager* manager, vtkPolyData* data)
+{
+  const vtkMTimeType mtime = manager->GetKdTree()->GetMTime();
+  manager->RemoveAllDataObjects();
+  manager->AddDataObject(data);
+  manager->GenerateKdTree();
+  return manager->GetKdTree()->GetMTime() != mtime;
+}
+
+void GetGlobalBounds(vtkPolyData* data, vtkMultiProcessController* controller, double bounds[6])
+{
+  double local[6];
+  data->GetBounds(local);
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    local[2 * axis + 1] = -local[2 * axis + 1];
+  }
+  controller->AllReduce(local, bounds, 6, vtkCommunicator::MIN_OP);
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    bounds[2 * axis + 1] = -bounds[2 * axis + 1];
+  }
+}
+}
+
+int TestKdTreeManager(int argc, char* argv[])
+{
+  vtkNew<vtkMPIController> controller;
+  controller->Initialize(&argc, &argv, 0);
+  vtkMultiProcessController::SetGlobalController(controller.GetPointer());
+  const int myId = controller->GetLocalProcessId();
+  vtkMath::RandomSeed(1234 + myId);
+
+  // Deliberately unbalanced: process k has (k + 1)^2 times as many cells as
+  // process 0, in overlapping boxes.
+  const vtkIdType count = 1000 * (myId + 1) * (myId + 1);
+  const double box[6] = { 0.0, 4.0 + myId, -1.0, 1.0, 0.0, 2.0 };
+  vtkSmartPointer<vtkPolyData> data = CreateVertices(box, count, false);
+
+  // The manager uses the global controller.
+  vtkNew<vtkKdTreeManager> manager;
+  bool valid = true;
+  if (!Generate(manager.GetPointer(), data) ||
+    !IsBalanced(manager.GetPointer(), data, controller.GetPointer(), "Initial cuts"))
+  {
+    valid = false;
+  }
+
+  // The same data fits the cuts: the KdTree must be left untouched.
+  if (Generate(manager.GetPointer(), data))
+  {
+    cerr << "The decomposition was not reused for the same data." << endl;
+    valid = false;
+  }
+
+  // Data within the same bounds, but all in the first piece: the imbalance
+  // requires new cuts.
+  double bounds[6];
+  GetGlobalBounds(data, controller.GetPointer(), bounds);
+  double corner[6];
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    corner[2 * axis] = bounds[2 * axis];
+    corner[2 * axis + 1] = bounds[2 * axis] + 0.01 * (bounds[2 * axis + 1] - bounds[2 * axis]);
+  }
+  vtkSmartPointer<vtkPolyData> clustered = CreateVertices(corner, count, false);
+  if (myId == 0)
+  {
+    vtkSmartPointer<vtkPolyData> extremes = CreateVertices(bounds, 2, true);
+    clustered->GetPoints()->InsertNextPoint(extremes->GetPoint(0));
+    clustered->GetPoints()->InsertNextPoint(extremes->GetPoint(1));
+    for (vtkIdType ptId = count; ptId < count + 2; ++ptId)
+    {
+      clustered->GetVerts()->InsertNextCell(1, &ptId);
+    }
+  }
+  if (!Generate(manager.GetPointer(), clustered))
+  {
+    cerr << "The decomposition was reused for unbalanced data." << endl;
+    valid = false;
+  }
+  else if (!IsBalanced(manager.GetPointer(), clustered, controller.GetPointer(), "Clustered"))
+  {
+    valid = false;
+  }
+
+  // Data that moved out of the bounds requires new cuts.
+  const double moved[6] = { 10.0, 14.0 + myId, -1.0, 1.0, 0.0, 2.0 };
+  vtkSmartPointer<vtkPolyData> outside = CreateVertices(moved, count, false);
+  if (!Generate(manager.GetPointer(), outside))
+  {
+    cerr << "The decomposition was reused for data out of its bounds." << endl;
+    valid = false;
+  }
+  else if (!IsBalanced(manager.GetPointer(), outside, controller.GetPointer(), "Moved"))
+  {
+    valid = false;
+  }
+
+  vtkMultiProcessController::SetGlobalController(NULL);
+  controller->Finalize();
+  return valid ? TEST_SUCCESS : TEST_FAILED;
+}
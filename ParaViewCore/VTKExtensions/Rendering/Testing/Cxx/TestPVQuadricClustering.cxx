@@ -0,0 +1,210 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestPVQuadricClustering.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include "vtkCellArray.h"
+#include "vtkIdTypeArray.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkPVQuadricClustering.h"
+#include "vtkPointLocator.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSphereSource.h"
+#include "vtkTimerLog.h"
+
+#include <cmath>
+#include <vtksys/CommandLineArguments.hxx>
+
+#define TEST_SUCCESS 0
+#define TEST_FAILED 1
+
+namespace
+{
+double Decimate(vtkPVQuadricClustering* filter, vtkPolyData* input, int count)
+{
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  for (int cc = 0; cc < count; ++cc)
+  {
+    filter->SetInputData(input);
+    filter->Modified();
+    filter->Update();
+  }
+  timer->StopTimer();
+  return timer->GetElapsedTime() / count;
+}
+
+bool Similar(vtkIdType serial, vtkIdType threaded, const char* what)
+{
+  if (std::abs(static_cast<double>(serial - threaded)) > 0.1 * serial)
+  {
+    cerr << "Number of " << what << " differs: " << serial << " (serial) vs. " << threaded
+         << " (multithreaded)" << endl;
+    return false;
+  }
+  return true;
+}
+
+// Every point of `output` must be within `tolerance` of a point of `reference`.
+bool ClosePoints(vtkPolyData* reference, vtkPolyData* output, double tolerance, const char* what)
+{
+  vtkNew<vtkPointLocator> locator;
+  locator->SetDataSet(reference);
+  locator->BuildLocator();
+  double x[3], y[3];
+  for (vtkIdType cc = 0; cc < output->GetNumberOfPoints(); ++cc)
+  {
+    output->GetPoint(cc, x);
+    reference->GetPoint(locator->FindClosestPoint(x), y);
+    if (std::sqrt(vtkMath::Distance2BetweenPoints(x, y)) > tolerance)
+    {
+      cerr << what << ": point " << cc << " (" << x[0] << ", " << x[1] << ", " << x[2]
+           << ") is farther than " << tolerance << " from the reference." << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+// Points and triangles must be exactly the same.
+bool SameOutput(vtkPolyData* first, vtkPolyData* second, const char* what)
+{
+  bool same = first->GetNumberOfPoints() == second->GetNumberOfPoints() &&
+    first->GetNumberOfCells() == second->GetNumberOfCells();
+  double x[3], y[3];
+  for (vtkIdType cc = 0; same && cc < first->GetNumberOfPoints(); ++cc)
+  {
+    first->GetPoint(cc, x);
+    second->GetPoint(cc, y);
+    same = x[0] == y[0] && x[1] == y[1] && x[2] == y[2];
+  }
+  vtkIdTypeArray* cells[2] = { first->GetPolys()->GetData(), second->GetPolys()->GetData() };
+  same = same && cells[0]->GetNumberOfTuples() == cells[1]->GetNumberOfTuples();
+  for (vtkIdType cc = 0; same && cc < cells[0]->GetNumberOfTuples(); ++cc)
+  {
+    same = cells[0]->GetValue(cc) == cells[1]->GetValue(cc);
+  }
+  if (!same)
+  {
+    cerr << what << ": outputs differ." << endl;
+  }
+  return same;
+}
+}
+
+int TestPVQuadricClustering(int argc, char* argv[])
+{
+  int resolution = 512;
+  int divisions = 85;
+  int max_count = 1;
+
+  // Use --resolution, --divisions and --count to use this for benchmarking.
+  vtksys::CommandLineArguments arg;
+  arg.Initialize(argc, argv);
+  typedef vtksys::CommandLineArguments argT;
+  arg.AddArgument("--resolution", argT::EQUAL_ARGUMENT, &resolution,
+    "Theta/phi resolution of the sphere to decimate.");
+  arg.AddArgument(
+    "--divisions", argT::EQUAL_ARGUMENT, &divisions, "Number of divisions along each axis.");
+  arg.AddArgument("--count", argT::EQUAL_ARGUMENT, &max_count, "Number of runs to average.");
+  arg.StoreUnusedArguments(true);
+  if (!arg.Parse())
+  {
+    cerr << "Problem parsing arguments" << endl;
+    return TEST_FAILED;
+  }
+
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(resolution);
+  sphere->SetPhiResolution(resolution);
+  sphere->Update();
+  vtkPolyData* input = sphere->GetOutput();
+
+  // Same settings as the LOD decimation in vtkGeometryRepresentation.
+  vtkNew<vtkPVQuadricClustering> serial;
+  serial->SetUseMultithreading(false);
+  vtkNew<vtkPVQuadricClustering> threaded;
+  vtkPVQuadricClustering* filters[2] = { serial.GetPointer(), threaded.GetPointer() };
+  for (int cc = 0; cc < 2; ++cc)
+  {
+    filters[cc]->SetNumberOfDivisions(divisions, divisions, divisions);
+    filters[cc]->SetUseInputPoints(1);
+    filters[cc]->SetCopyCellData(1);
+    filters[cc]->SetUseInternalTriangles(0);
+  }
+
+  const double serialTime = Decimate(serial.GetPointer(), input, max_count);
+  const double threadedTime = Decimate(threaded.GetPointer(), input, max_count);
+
+  vtkPolyData* serialOutput = serial->GetOutput();
+  vtkPolyData* threadedOutput = threaded->GetOutput();
+
+  cout << "Input: " << input->GetNumberOfPoints() << " points, " << input->GetNumberOfCells()
+       << " cells, " << divisions << "^3 bins" << endl;
+  cout << "  serial:        " << serialTime << " s, " << serialOutput->GetNumberOfPoints()
+       << " points, " << serialOutput->GetNumberOfCells() << " cells" << endl;
+  cout << "  multithreaded: " << threadedTime << " s, " << threadedOutput->GetNumberOfPoints()
+       << " points, " << threadedOutput->GetNumberOfCells() << " cells" << endl;
+
+  if (threadedOutput->GetNumberOfCells() == 0 ||
+    !Similar(serialOutput->GetNumberOfPoints(), threadedOutput->GetNumberOfPoints(), "points") ||
+    !Similar(serialOutput->GetNumberOfCells(), threadedOutput->GetNumberOfCells(), "cells"))
+  {
+    return TEST_FAILED;
+  }
+
+  // Both outputs pick input points in bins of the same size, so each point of
+  // one output must be within a couple of bins of a point of the other.
+  double inputBounds[6];
+  input->GetBounds(inputBounds);
+  double binDiagonal = 0.0;
+  for (int cc = 0; cc < 3; ++cc)
+  {
+    const double binSize = (inputBounds[2 * cc + 1] - inputBounds[2 * cc]) / divisions;
+    binDiagonal += binSize * binSize;
+  }
+  binDiagonal = std::sqrt(binDiagonal);
+  if (!ClosePoints(serialOutput, threadedOutput, 2 * binDiagonal, "multithreaded") ||
+    !ClosePoints(threadedOutput, serialOutput, 2 * binDiagonal, "serial"))
+  {
+    return TEST_FAILED;
+  }
+
+  // Quadrics are summed in the same order on every run, whatever the number
+  // of threads, so a second run must give exactly the same result.
+  vtkNew<vtkPolyData> first;
+  first->DeepCopy(threadedOutput);
+  Decimate(threaded.GetPointer(), input, 1);
+  if (!SameOutput(first.GetPointer(), threadedOutput, "second multithreaded run"))
+  {
+    return TEST_FAILED;
+  }
+
+  // Explicit division spacing is only handled by the serial implementation.
+  for (int cc = 0; cc < 2; ++cc)
+  {
+    filters[cc]->SetComputeNumberOfDivisions(1);
+    filters[cc]->SetDivisionOrigin(inputBounds[0], inputBounds[2], inputBounds[4]);
+    filters[cc]->SetDivisionSpacing(0.03, 0.03, 0.03);
+  }
+  Decimate(serial.GetPointer(), input, 1);
+  Decimate(threaded.GetPointer(), input, 1);
+  if (serialOutput->GetNumberOfCells() == 0 ||
+    !SameOutput(serialOutput, threadedOutput, "ComputeNumberOfDivisions"))
+  {
+    return TEST_FAILED;
+  }
+  return TEST_SUCCESS;
+}
@@ -0,0 +1,234 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestRedistributePolyData.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include "vtkBalancedRedistributePolyData.h"
+#include "vtkCellData.h"
+#include "vtkDoubleArray.h"
+#include "vtkIdTypeArray.h"
+#include "vtkMPIController.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPolyData.h"
+#include "vtkSphereSource.h"
+#include "vtkTimerLog.h"
+
+#include <cmath>
+#include <vector>
+#include <vtksys/CommandLineArguments.hxx>
+
+#define TEST_SUCCESS 0
+#define TEST_FAILED 1
+
+namespace
+{
+// Each process gets a sphere of a different resolution, so that cells have to
+// move to balance the load. Cells are tagged with a global id and their
+// center, points with their coordinates, to check the attributes follow.
+void MakeInput(vtkMultiProcessController* controller, int resolution, vtkPolyData* input)
+{
+  const int myId = controller->GetLocalProcessId();
+  const int numProcs = controller->GetNumberOfProcesses();
+
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(resolution * (myId + 1));
+  sphere->SetPhiResolution(resolution);
+  sphere->SetCenter(2.0 * myId, 0.0, 0.0);
+  sphere->Update();
+  input->ShallowCopy(sphere->GetOutput());
+
+  vtkIdType numCells = input->GetNumberOfCells();
+  std::vector<vtkIdType> counts(numProcs);
+  controller->AllGather(&numCells, &counts[0], 1);
+  vtkIdType firstId = 0;
+  for (int cc = 0; cc < myId; ++cc)
+  {
+    firstId += counts[cc];
+  }
+
+  vtkNew<vtkIdTypeArray> ids;
+  ids->SetName("CellIds");
+  ids->SetNumberOfTuples(numCells);
+  vtkNew<vtkDoubleArray> centers;
+  centers->SetName("Centers");
+  centers->SetNumberOfComponents(3);
+  centers->SetNumberOfTuples(numCells);
+  for (vtkIdType cc = 0; cc < numCells; ++cc)
+  {
+    ids->SetValue(cc, firstId + cc);
+    double bounds[6];
+    input->GetCellBounds(cc, bounds);
+    centers->SetTuple3(cc, (bounds[0] + bounds[1]) / 2, (bounds[2] + bounds[3]) / 2,
+      (bounds[4] + bounds[5]) / 2);
+  }
+  input->GetCellData()->AddArray(ids.GetPointer());
+  input->GetCellData()->AddArray(centers.GetPointer());
+
+  vtkNew<vtkDoubleArray> coords;
+  coords->SetName("Coords");
+  coords->DeepCopy(input->GetPoints()->GetData());
+  input->GetPointData()->AddArray(coords.GetPointer());
+}
+
+bool CheckOutput(vtkMultiProcessController* controller, vtkPolyData* input, vtkPolyData* output)
+{
+  const int numProcs = controller->GetNumberOfProcesses();
+
+  // ... no cell is lost or duplicated ...
+  vtkIdType numCells[2] = { input->GetNumberOfCells(), output->GetNumberOfCells() };
+  vtkIdType totals[2];
+  controller->AllReduce(numCells, totals, 2, vtkCommunicator::SUM_OP);
+  if (totals[0] != totals[1])
+  {
+    cerr << "Number of cells changed from " << totals[0] << " to " << totals[1] << endl;
+    return false;
+  }
+
+  vtkIdTypeArray* ids = vtkIdTypeArray::SafeDownCast(output->GetCellData()->GetArray("CellIds"));
+  vtkDoubleArray* centers =
+    vtkDoubleArray::SafeDownCast(output->GetCellData()->GetArray("Centers"));
+  vtkDoubleArray* coords = vtkDoubleArray::SafeDownCast(output->GetPointData()->GetArray("Coords"));
+  int hasArrays = (ids && centers && coords) ? 1 : 0;
+  int allHaveArrays = 0;
+  controller->AllReduce(&hasArrays, &allHaveArrays, 1, vtkCommunicator::MIN_OP);
+  if (!allHaveArrays)
+  {
+    cerr << "Missing attribute arrays in the output." << endl;
+    return false;
+  }
+
+  // ... every process takes part in the reductions below, even when its own
+  //   output is already known to be wrong ...
+  bool valid = true;
+  std::vector<int> marks(totals[0], 0), allMarks(totals[0], 0);
+  for (vtkIdType cc = 0; cc < numCells[1]; ++cc)
+  {
+    vtkIdType id = ids->GetValue(cc);
+    if (id < 0 || id >= totals[0])
+    {
+      cerr << "Invalid cell id " << id << endl;
+      valid = false;
+      continue;
+    }
+    marks[id]++;
+  }
+  controller->AllReduce(&marks[0], &allMarks[0], totals[0], vtkCommunicator::SUM_OP);
+  for (vtkIdType cc = 0; valid && cc < totals[0]; ++cc)
+  {
+    if (allMarks[cc] != 1)
+    {
+      cerr << "Cell " << cc << " found " << allMarks[cc] << " times." << endl;
+      valid = false;
+    }
+  }
+
+  // ... the load is balanced ...
+  vtkIdType minCells, maxCells;
+  controller->AllReduce(&numCells[1], &minCells, 1, vtkCommunicator::MIN_OP);
+  controller->AllReduce(&numCells[1], &maxCells, 1, vtkCommunicator::MAX_OP);
+  if (maxCells - minCells > numProcs)
+  {
+    cerr << "Unbalanced output: " << minCells << " to " << maxCells << " cells." << endl;
+    valid = false;
+  }
+  if (!valid)
+  {
+    return false;
+  }
+
+  // ... cells, points and attributes still match ...
+  for (vtkIdType cc = 0; cc < numCells[1]; ++cc)
+  {
+    double bounds[6];
+    output->GetCellBounds(cc, bounds);
+    double* center = centers->GetTuple3(cc);
+    for (int kk = 0; kk < 3; ++kk)
+    {
+      if (std::abs((bounds[2 * kk] + bounds[2 * kk + 1]) / 2 - center[kk]) > 1e-5)
+      {
+        cerr << "Cell " << ids->GetValue(cc) << " does not match its attributes." << endl;
+        return false;
+      }
+    }
+  }
+  for (vtkIdType cc = 0; cc < output->GetNumberOfPoints(); ++cc)
+  {
+    double pt[3];
+    output->GetPoint(cc, pt);
+    double* coord = coords->GetTuple3(cc);
+    for (int kk = 0; kk < 3; ++kk)
+    {
+      if (std::abs(pt[kk] - coord[kk]) > 1e-5)
+      {
+        cerr << "Point " << cc << " does not match its attributes." << endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+}
+
+int TestRedistributePolyData(int argc, char* argv[])
+{
+  vtkNew<vtkMPIController> controller;
+  controller->Initialize(&argc, &argv, 0);
+  vtkMultiProcessController::SetGlobalController(controller.GetPointer());
+
+  int resolution = 64;
+  int max_count = 1;
+
+  // Use --resolution and --count to use this for benchmarking.
+  vtksys::CommandLineArguments arg;
+  arg.Initialize(argc, argv);
+  typedef vtksys::CommandLineArguments argT;
+  arg.AddArgument("--resolution", argT::EQUAL_ARGUMENT, &resolution,
+    "Resolution of the sphere on the first process.");
+  arg.AddArgument("--count", argT::EQUAL_ARGUMENT, &max_count, "Number of runs to average.");
+  arg.StoreUnusedArguments(true);
+  int status = arg.Parse() ? TEST_SUCCESS : TEST_FAILED;
+
+  if (status == TEST_SUCCESS)
+  {
+    vtkNew<vtkPolyData> input;
+    MakeInput(controller.GetPointer(), resolution, input.GetPointer());
+
+    vtkNew<vtkBalancedRedistributePolyData> redistribute;
+    redistribute->SetController(controller.GetPointer());
+    redistribute->SetInputData(input.GetPointer());
+
+    vtkNew<vtkTimerLog> timer;
+    timer->StartTimer();
+    for (int cc = 0; cc < max_count; ++cc)
+    {
+      redistribute->Modified();
+      redistribute->Update();
+    }
+    timer->StopTimer();
+    if (controller->GetLocalProcessId() == 0)
+    {
+      cout << "Redistributed " << input->GetNumberOfCells() << " cells on process 0 in "
+           << timer->GetElapsedTime() / max_count << " s" << endl;
+    }
+
+    int valid = CheckOutput(controller.GetPointer(), input.GetPointer(), redistribute->GetOutput());
+    int allValid = 0;
+    controller->AllReduce(&valid, &allValid, 1, vtkCommunicator::MIN_OP);
+    status = allValid ? TEST_SUCCESS : TEST_FAILED;
+  }
+
+  vtkMultiProcessController::SetGlobalController(NULL);
+  controller->Finalize();
+  return status;
+}
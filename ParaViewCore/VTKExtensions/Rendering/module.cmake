@@ -55,6 +55,7 @@ vtk_module(vtkPVVTKExtensionsRendering
     vtklz4
 
   TEST_DEPENDS
+    vtkFiltersSources
     vtkInteractionStyle
     vtkIOAMR
     vtkIOXML
@@ -16,6 +16,7 @@
 
 #include "vtkBoundingBox.h"
 #include "vtkCameraPass.h"
+#include "vtkCommunicator.h"
 #include "vtkFloatArray.h"
 #include "vtkFrameBufferObjectBase.h"
 #include "vtkHardwareSelector.h"
@@ -41,7 +42,11 @@
 #include "vtkTimerLog.h"
 
 #include "vtk_icet.h"
+#include <algorithm>
 #include <assert.h>
+#include <map>
+#include <sstream>
+#include <vector>
 
 #include "vtkCompositeZPassFS.h"
 #include "vtkOpenGLHelper.h"
@@ -92,6 +97,106 @@ void MergeCubeAxesBounds(double bounds[6], const vtkRenderState* rState)
 
   bbox.GetBounds(bounds);
 }
+
+IceTEnum GetIceTStrategy(int strategy, bool single_tile)
+{
+  switch (strategy)
+  {
+    case vtkIceTCompositePass::DIRECT_STRATEGY:
+      return ICET_STRATEGY_DIRECT;
+    case vtkIceTCompositePass::SEQUENTIAL_STRATEGY:
+      return ICET_STRATEGY_SEQUENTIAL;
+    case vtkIceTCompositePass::SPLIT_STRATEGY:
+      return ICET_STRATEGY_SPLIT;
+    case vtkIceTCompositePass::REDUCE_STRATEGY:
+      return ICET_STRATEGY_REDUCE;
+    case vtkIceTCompositePass::VTREE_STRATEGY:
+      return ICET_STRATEGY_VTREE;
+    case vtkIceTCompositePass::DEFAULT_STRATEGY:
+    default:
+      return single_tile ? ICET_STRATEGY_SEQUENTIAL : ICET_STRATEGY_REDUCE;
+  }
+}
+
+IceTEnum GetIceTSingleImageStrategy(int strategy)
+{
+  switch (strategy)
+  {
+    case vtkIceTCompositePass::BSWAP_SINGLE_IMAGE_STRATEGY:
+      return ICET_SINGLE_IMAGE_STRATEGY_BSWAP;
+    case vtkIceTCompositePass::TREE_SINGLE_IMAGE_STRATEGY:
+      return ICET_SINGLE_IMAGE_STRATEGY_TREE;
+    case vtkIceTCompositePass::RADIXK_SINGLE_IMAGE_STRATEGY:
+      return ICET_SINGLE_IMAGE_STRATEGY_RADIXK;
+    case vtkIceTCompositePass::AUTOMATIC_SINGLE_IMAGE_STRATEGY:
+    default:
+      return ICET_SINGLE_IMAGE_STRATEGY_AUTOMATIC;
+  }
+}
+
+const char* GetSingleImageStrategyName(int strategy)
+{
+  switch (strategy)
+  {
+    case vtkIceTCompositePass::BSWAP_SINGLE_IMAGE_STRATEGY:
+      return "BSWAP";
+    case vtkIceTCompositePass::TREE_SINGLE_IMAGE_STRATEGY:
+      return "TREE";
+    case vtkIceTCompositePass::RADIXK_SINGLE_IMAGE_STRATEGY:
+      return "RADIXK";
+    default:
+      return "AUTOMATIC";
+  }
+}
+
+// Single image strategies timed by the auto-tuner, in the order they are tried.
+const int AutoTuneCandidates[] = { vtkIceTCompositePass::BSWAP_SINGLE_IMAGE_STRATEGY,
+  vtkIceTCompositePass::TREE_SINGLE_IMAGE_STRATEGY,
+  vtkIceTCompositePass::RADIXK_SINGLE_IMAGE_STRATEGY };
+const int NumberOfAutoTuneCandidates =
+  static_cast<int>(sizeof(AutoTuneCandidates) / sizeof(AutoTuneCandidates[0]));
+};
+
+//----------------------------------------------------------------------------
+class vtkIceTCompositePass::vtkAutoTuner
+{
+public:
+  // Number of processes, tile dimensions and full resolution image size. The
+  // window size is synchronized among processes, so all processes agree on the
+  // key. The image reduction factor is left out: it is adapted from frame to
+  // frame to reach the target frame rate, and would restart tuning every time.
+  typedef std::vector<int> KeyType;
+
+  // Strategy picked for each configuration tuned so far.
+  std::map<KeyType, int> Selected;
+
+  // Configuration being tuned.
+  KeyType Key;
+  bool Tuning;
+  int Candidate;
+  int Frame;
+  // Number of pixels composited in the frame being timed. Strategies are
+  // compared by compositing time per pixel, since the image reduction factor
+  // may change while they are timed.
+  double Pixels;
+  double Times[NumberOfAutoTuneCandidates];
+
+  vtkAutoTuner()
+    : Tuning(false)
+    , Candidate(0)
+    , Frame(0)
+    , Pixels(1.0)
+  {
+  }
+
+  void Start(const KeyType& key)
+  {
+    this->Key = key;
+    this->Tuning = true;
+    this->Candidate = 0;
+    this->Frame = 0;
+    std::fill(this->Times, this->Times + NumberOfAutoTuneCandidates, VTK_DOUBLE_MAX);
+  }
 };
 
 vtkStandardNewMacro(vtkIceTCompositePass);
@@ -120,6 +225,11 @@ vtkIceTCompositePass::vtkIceTCompositePass()
 
   this->DataReplicatedOnAllProcesses = false;
   this->ImageReductionFactor = 1;
+  this->Strategy = DEFAULT_STRATEGY;
+  this->SingleImageStrategy = AUTOMATIC_SINGLE_IMAGE_STRATEGY;
+  this->NumberOfAutoTuneFrames = 3;
+  this->LastSingleImageStrategy = AUTOMATIC_SINGLE_IMAGE_STRATEGY;
+  this->AutoTuner = new vtkAutoTuner();
 
   this->RenderEmptyImages = false;
   this->UseOrderedCompositing = false;
@@ -159,6 +269,8 @@ vtkIceTCompositePass::~vtkIceTCompositePass()
   this->SetController(0);
   this->IceTContext->Delete();
   this->IceTContext = 0;
+  delete this->AutoTuner;
+  this->AutoTuner = NULL;
 
   delete this->LastRenderedEyes[0];
   delete this->LastRenderedEyes[1];
@@ -226,14 +338,10 @@ void vtkIceTCompositePass::SetupContext(const vtkRenderState* render_state)
   this->UpdateTileInformation(render_state);
 
   // Set IceT compositing strategy.
-  if ((this->TileDimensions[0] == 1) && (this->TileDimensions[1] == 1))
-  {
-    icetStrategy(ICET_STRATEGY_SEQUENTIAL);
-  }
-  else
-  {
-    icetStrategy(ICET_STRATEGY_REDUCE);
-  }
+  bool single_tile = (this->TileDimensions[0] == 1) && (this->TileDimensions[1] == 1);
+  icetStrategy(GetIceTStrategy(this->Strategy, single_tile));
+  this->LastSingleImageStrategy = this->SelectSingleImageStrategy(render_state);
+  icetSingleImageStrategy(GetIceTSingleImageStrategy(this->LastSingleImageStrategy));
 
   bool use_ordered_compositing =
     (this->PartitionOrdering && this->UseOrderedCompositing && !this->DepthOnly &&
@@ -564,6 +672,7 @@ void vtkIceTCompositePass::Render(const vtkRenderState* render_state)
   double val = 0.;
   icetGetDoublev(ICET_COMPOSITE_TIME, &val);
   vtkTimerLog::InsertTimedEvent("ICET_COMPOSITE_TIME", val, 0);
+  this->UpdateAutoTuner(val);
   icetGetDoublev(ICET_BLEND_TIME, &val);
   vtkTimerLog::InsertTimedEvent("ICET_BLEND_TIME", val, 0);
   icetGetDoublev(ICET_COMPRESS_TIME, &val);
@@ -580,6 +689,88 @@ void vtkIceTCompositePass::Render(const vtkRenderState* render_state)
   vtkOpenGLRenderUtilities::MarkDebugEvent("vtkIceTCompositePass::Render End");
 }
 
+//----------------------------------------------------------------------------
+int vtkIceTCompositePass::SelectSingleImageStrategy(const vtkRenderState* render_state)
+{
+  vtkAutoTuner* tuner = this->AutoTuner;
+  if (this->SingleImageStrategy != AUTO_TUNE_SINGLE_IMAGE_STRATEGY)
+  {
+    tuner->Tuning = false;
+    return this->SingleImageStrategy;
+  }
+
+  const int* size = render_state->GetRenderer()->GetVTKWindow()->GetActualSize();
+  const int factor = this->ImageReductionFactor > 0 ? this->ImageReductionFactor : 1;
+  vtkAutoTuner::KeyType key(5);
+  key[0] = this->Controller->GetNumberOfProcesses();
+  key[1] = this->TileDimensions[0];
+  key[2] = this->TileDimensions[1];
+  key[3] = size[0];
+  key[4] = size[1];
+  tuner->Pixels = std::max(1.0, static_cast<double>(size[0] / factor) * (size[1] / factor));
+
+  std::map<vtkAutoTuner::KeyType, int>::const_iterator iter = tuner->Selected.find(key);
+  if (iter != tuner->Selected.end())
+  {
+    tuner->Tuning = false;
+    return iter->second;
+  }
+  if (!tuner->Tuning || tuner->Key != key)
+  {
+    tuner->Start(key);
+  }
+  return AutoTuneCandidates[tuner->Candidate];
+}
+
+//----------------------------------------------------------------------------
+void vtkIceTCompositePass::UpdateAutoTuner(double composite_time)
+{
+  vtkAutoTuner* tuner = this->AutoTuner;
+  if (!tuner->Tuning)
+  {
+    return;
+  }
+
+  double& time = tuner->Times[tuner->Candidate];
+  time = std::min(time, composite_time / tuner->Pixels);
+  if (++tuner->Frame < this->NumberOfAutoTuneFrames)
+  {
+    return;
+  }
+  tuner->Frame = 0;
+  if (++tuner->Candidate < NumberOfAutoTuneCandidates)
+  {
+    return;
+  }
+
+  // All strategies have been timed. Compare the slowest process for each, so
+  // that all processes pick the same one.
+  double times[NumberOfAutoTuneCandidates];
+  this->Controller->AllReduce(
+    tuner->Times, times, NumberOfAutoTuneCandidates, vtkCommunicator::MAX_OP);
+
+  int best = 0;
+  for (int cc = 0; cc < NumberOfAutoTuneCandidates; ++cc)
+  {
+    std::ostringstream name;
+    name << "ICET_AUTO_TUNE_" << GetSingleImageStrategyName(AutoTuneCandidates[cc])
+         << "_TIME_PER_MEGAPIXEL";
+    vtkTimerLog::InsertTimedEvent(name.str().c_str(), 1e6 * times[cc], 0);
+    if (times[cc] < times[best])
+    {
+      best = cc;
+    }
+  }
+  tuner->Selected[tuner->Key] = AutoTuneCandidates[best];
+  tuner->Tuning = false;
+
+  std::ostringstream event;
+  event << "IceT auto-tune: " << GetSingleImageStrategyName(AutoTuneCandidates[best])
+        << " single image strategy for " << tuner->Key[0] << " processes, " << tuner->Key[1]
+        << "x" << tuner->Key[2] << " tiles, " << tuner->Key[3] << "x" << tuner->Key[4] << " pixels";
+  vtkTimerLog::MarkEvent(event.str().c_str());
+}
+
 // ----------------------------------------------------------------------------
 void vtkIceTCompositePass::ReadyProgram(vtkOpenGLRenderWindow* context)
 {
@@ -1150,6 +1341,9 @@ void vtkIceTCompositePass::PrintSelf(ostream& os, vtkIndent indent)
      << endl;
   os << indent << "DataReplicatedOnAllProcesses: " << this->DataReplicatedOnAllProcesses << endl;
   os << indent << "ImageReductionFactor: " << this->ImageReductionFactor << endl;
+  os << indent << "Strategy: " << this->Strategy << endl;
+  os << indent << "SingleImageStrategy: " << this->SingleImageStrategy << endl;
+  os << indent << "NumberOfAutoTuneFrames: " << this->NumberOfAutoTuneFrames << endl;
   os << indent << "PartitionOrdering: " << this->PartitionOrdering << endl;
   os << indent << "UseOrderedCompositing: " << this->UseOrderedCompositing << endl;
   os << indent << "DepthOnly: " << this->DepthOnly << endl;
@@ -139,6 +139,69 @@ public:
   vtkGetMacro(ImageReductionFactor, int);
   //@}
 
+  enum Strategies
+  {
+    DEFAULT_STRATEGY = 0,
+    DIRECT_STRATEGY = 1,
+    SEQUENTIAL_STRATEGY = 2,
+    SPLIT_STRATEGY = 3,
+    REDUCE_STRATEGY = 4,
+    VTREE_STRATEGY = 5
+  };
+
+  enum SingleImageStrategies
+  {
+    AUTOMATIC_SINGLE_IMAGE_STRATEGY = 0,
+    BSWAP_SINGLE_IMAGE_STRATEGY = 1,
+    TREE_SINGLE_IMAGE_STRATEGY = 2,
+    RADIXK_SINGLE_IMAGE_STRATEGY = 3,
+    AUTO_TUNE_SINGLE_IMAGE_STRATEGY = 4
+  };
+
+  //@{
+  /**
+   * Get/Set the IceT multi-tile strategy. DEFAULT_STRATEGY uses
+   * SEQUENTIAL_STRATEGY for a single tile and REDUCE_STRATEGY for tile
+   * displays. Must be the same on all processes.
+   * Initial value is DEFAULT_STRATEGY.
+   */
+  vtkSetClampMacro(Strategy, int, DEFAULT_STRATEGY, VTREE_STRATEGY);
+  vtkGetMacro(Strategy, int);
+  //@}
+
+  //@{
+  /**
+   * Get/Set the IceT strategy used to composite each tile: binary-swap, tree,
+   * radix-k, or let IceT decide (AUTOMATIC_SINGLE_IMAGE_STRATEGY). With
+   * AUTO_TUNE_SINGLE_IMAGE_STRATEGY, binary-swap, tree and radix-k are each
+   * used for NumberOfAutoTuneFrames frames, then the one with the lowest
+   * compositing time per pixel (the slowest rank counts) is used. Tuning is done
+   * once per number of processes, tile layout and full resolution image size,
+   * whatever the ImageReductionFactor. The timings and the choice are recorded
+   * in the vtkTimerLog. Must be the same on all processes.
+   * Initial value is AUTOMATIC_SINGLE_IMAGE_STRATEGY.
+   */
+  vtkSetClampMacro(
+    SingleImageStrategy, int, AUTOMATIC_SINGLE_IMAGE_STRATEGY, AUTO_TUNE_SINGLE_IMAGE_STRATEGY);
+  vtkGetMacro(SingleImageStrategy, int);
+  //@}
+
+  //@{
+  /**
+   * Get/Set the number of frames each single image strategy is timed for when
+   * SingleImageStrategy is AUTO_TUNE_SINGLE_IMAGE_STRATEGY. The fastest of
+   * these frames is used for comparison. Initial value is 3.
+   */
+  vtkSetClampMacro(NumberOfAutoTuneFrames, int, 1, 100);
+  vtkGetMacro(NumberOfAutoTuneFrames, int);
+  //@}
+
+  /**
+   * Returns the single image strategy (one of SingleImageStrategies, other
+   * than AUTO_TUNE_SINGLE_IMAGE_STRATEGY) used for the last render.
+   */
+  vtkGetMacro(LastSingleImageStrategy, int);
+
   //@{
   /**
    * partition ordering that gives processes ordering. Initial value is a NULL pointer.
@@ -273,6 +336,19 @@ protected:
    */
   void UpdateTileInformation(const vtkRenderState*);
 
+  /**
+   * Returns the single image strategy to use for the next frame, picking the
+   * strategy being tuned when SingleImageStrategy is
+   * AUTO_TUNE_SINGLE_IMAGE_STRATEGY.
+   */
+  int SelectSingleImageStrategy(const vtkRenderState*);
+
+  /**
+   * Records the compositing time of the last frame for the auto-tuner. This is
+   * collective when the last strategy has been timed.
+   */
+  void UpdateAutoTuner(double composite_time);
+
   vtkMultiProcessController* Controller;
   vtkPartitionOrderingInterface* PartitionOrdering;
   vtkRenderPass* RenderPass;
@@ -292,6 +368,10 @@ protected:
   double PhysicalViewport[4];
 
   int ImageReductionFactor;
+  int Strategy;
+  int SingleImageStrategy;
+  int NumberOfAutoTuneFrames;
+  int LastSingleImageStrategy;
 
   vtkNew<vtkFloatArray> LastRenderedDepths;
 
@@ -318,6 +398,9 @@ protected:
 private:
   vtkIceTCompositePass(const vtkIceTCompositePass&) = delete;
   void operator=(const vtkIceTCompositePass&) = delete;
+
+  class vtkAutoTuner;
+  vtkAutoTuner* AutoTuner;
 };
 
 #endif
@@ -14,11 +14,14 @@
 =========================================================================*/
 #include "vtkKdTreeManager.h"
 
+#include "vtkBSPCuts.h"
 #include "vtkBoundingBox.h"
 #include "vtkCompositeDataIterator.h"
 #include "vtkCompositeDataSet.h"
 #include "vtkExtentTranslator.h"
+#include "vtkKdNode.h"
 #include "vtkKdTreeGenerator.h"
+#include "vtkMath.h"
 #include "vtkMultiProcessController.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
@@ -26,15 +29,132 @@
 #include "vtkPKdTree.h"
 #include "vtkPoints.h"
 #include "vtkSphereSource.h"
+#include "vtkTimerLog.h"
 #include "vtkUnstructuredGrid.h"
 
+#include <algorithm>
+#include <cmath>
+#include <numeric>
 #include <set>
+#include <utility>
 #include <vector>
 
 class vtkKdTreeManager::vtkDataObjectSet : public std::set<vtkSmartPointer<vtkDataObject> >
 {
 };
 
+// The decomposition built by BuildBalancedCuts(), kept to decide whether it
+// can be reused.
+class vtkKdTreeManager::vtkDecomposition
+{
+public:
+  // Internal nodes split along Axis at Cut, leaves have Axis == -1.
+  struct Node
+  {
+    int Axis;
+    double Cut;
+    int Left;
+    int Right;
+    int Piece;
+  };
+
+  std::vector<Node> Nodes;
+  double Bounds[6];
+  int NumberOfPieces;
+
+  vtkDecomposition()
+    : NumberOfPieces(0)
+  {
+    vtkMath::UninitializeBounds(this->Bounds);
+  }
+
+  void Clear() { this->Nodes.clear(); }
+
+  int FindPiece(const float center[3]) const
+  {
+    int cc = 0;
+    while (this->Nodes[cc].Axis >= 0)
+    {
+      const Node& node = this->Nodes[cc];
+      cc = center[node.Axis] < node.Cut ? node.Left : node.Right;
+    }
+    return this->Nodes[cc].Piece;
+  }
+};
+
+namespace
+{
+void vtkCollectDataSets(vtkDataObject* data, std::vector<vtkDataSet*>& datasets)
+{
+  vtkCompositeDataSet* mbs = vtkCompositeDataSet::SafeDownCast(data);
+  if (!mbs)
+  {
+    if (vtkDataSet* ds = vtkDataSet::SafeDownCast(data))
+    {
+      datasets.push_back(ds);
+    }
+    return;
+  }
+
+  vtkCompositeDataIterator* iter = mbs->NewIterator();
+  for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+  {
+    if (vtkDataSet* ds = vtkDataSet::SafeDownCast(iter->GetCurrentDataObject()))
+    {
+      datasets.push_back(ds);
+    }
+  }
+  iter->Delete();
+}
+
+// The center of the bounding box of a cell.
+void vtkCellCenter(vtkDataSet* ds, vtkIdType cellId, float center[3])
+{
+  double cellBounds[6];
+  ds->GetCellBounds(cellId, cellBounds);
+  center[0] = static_cast<float>(0.5 * (cellBounds[0] + cellBounds[1]));
+  center[1] = static_cast<float>(0.5 * (cellBounds[2] + cellBounds[3]));
+  center[2] = static_cast<float>(0.5 * (cellBounds[4] + cellBounds[5]));
+}
+
+// A node of the KdTree that is being split by BuildBalancedCuts(), along with
+// the local cells whose centers are inside it.
+struct vtkSplitTask
+{
+  vtkKdNode* KdNode;
+  int Node;
+  double Bounds[6];
+  int FirstPiece;
+  int NumberOfPieces;
+  std::vector<vtkIdType> Cells;
+
+  // State of the search for the cut position. The cut is searched for in
+  // [Lo, Hi], among the Window cells, knowing that Below cells (over all
+  // processes) are left of Lo.
+  int Axis;
+  double Lo;
+  double Hi;
+  double Below;
+  double Target;
+  double Cut;
+  bool Done;
+  std::vector<vtkIdType> Window;
+};
+
+const int vtkNumberOfBins = 128;
+const int vtkNumberOfRefinements = 3;
+
+inline int vtkBinOf(double x, double lo, double hi)
+{
+  if (hi <= lo)
+  {
+    return 0;
+  }
+  const int bin = static_cast<int>((x - lo) / (hi - lo) * vtkNumberOfBins);
+  return std::min(std::max(bin, 0), vtkNumberOfBins - 1);
+}
+}
+
 vtkStandardNewMacro(vtkKdTreeManager);
 //----------------------------------------------------------------------------
 vtkKdTreeManager::vtkKdTreeManager()
@@ -45,9 +165,14 @@ vtkKdTreeManager::vtkKdTreeManager()
     vtkWarningMacro("No global controller");
   }
   this->DataObjects = new vtkDataObjectSet();
+  this->Decomposition = new vtkDecomposition();
   this->KdTree = 0;
   this->NumberOfPieces = globalController ? globalController->GetNumberOfProcesses() : 1;
   this->KdTreeInitialized = false;
+  this->BalanceCellCounts = true;
+  this->ReuseDecomposition = true;
+  this->BoundsTolerance = 0.05;
+  this->ImbalanceTolerance = 0.2;
 
   vtkPKdTree* tree = vtkPKdTree::New();
   tree->SetController(globalController);
@@ -68,6 +193,7 @@ vtkKdTreeManager::~vtkKdTreeManager()
   this->SetKdTree(0);
 
   delete this->DataObjects;
+  delete this->Decomposition;
 }
 
 //----------------------------------------------------------------------------
@@ -91,6 +217,7 @@ void vtkKdTreeManager::SetKdTree(vtkPKdTree* tree)
   {
     vtkSetObjectBodyMacro(KdTree, vtkPKdTree, tree);
     this->KdTreeInitialized = false;
+    this->Decomposition->Clear();
   }
 }
 
@@ -105,9 +232,37 @@ void vtkKdTreeManager::SetStructuredDataInformation(vtkExtentTranslator* transla
   this->Modified();
 }
 
+//----------------------------------------------------------------------------
+void vtkKdTreeManager::RemoveStructuredDataInformation()
+{
+  if (this->ExtentTranslator)
+  {
+    this->ExtentTranslator = nullptr;
+    this->Modified();
+  }
+}
+
 //----------------------------------------------------------------------------
 void vtkKdTreeManager::GenerateKdTree()
 {
+  vtkMultiProcessController* controller = this->KdTree->GetController();
+  bool balance = this->BalanceCellCounts && !this->ExtentTranslator && controller &&
+    this->NumberOfPieces > 1;
+
+  double dataBounds[6];
+  if (balance)
+  {
+    balance = this->ComputeBounds(dataBounds);
+  }
+  if (balance && this->CanReuseDecomposition(dataBounds))
+  {
+    // Leave the KdTree untouched so that data is only redistributed if it
+    // changed.
+    vtkTimerLog::MarkEvent("Reusing Kd-Tree decomposition");
+    return;
+  }
+  this->Decomposition->Clear();
+
   this->KdTree->RemoveAllDataSets();
   if (!this->KdTreeInitialized)
   {
@@ -156,6 +311,12 @@ void vtkKdTreeManager::GenerateKdTree()
     generator->BuildTree(this->ExtentTranslator, this->WholeExtent, this->Origin, this->Spacing);
     generator->Delete();
   }
+  else if (balance)
+  {
+    std::vector<float> centers;
+    this->ComputeCellCenters(centers);
+    this->BuildBalancedCuts(centers, dataBounds);
+  }
   else
   {
     // Ensure that the kdtree is not using predefined cuts.
@@ -165,10 +326,337 @@ void vtkKdTreeManager::GenerateKdTree()
     this->KdTree->AssignRegionsContiguous();
   }
 
+  // The KdTree may be the one built by the previous call; make sure users
+  // notice that it changed.
+  this->KdTree->Modified();
   this->KdTree->BuildLocator();
   // this->KdTree->PrintTree();
 }
 
+//-----------------------------------------------------------------------------
+void vtkKdTreeManager::CollectDataSets(std::vector<vtkDataSet*>& datasets)
+{
+  for (vtkDataObjectSet::iterator iter = this->DataObjects->begin();
+       iter != this->DataObjects->end(); ++iter)
+  {
+    vtkCollectDataSets(iter->GetPointer(), datasets);
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool vtkKdTreeManager::ComputeBounds(double bounds[6])
+{
+  std::vector<vtkDataSet*> datasets;
+  this->CollectDataSets(datasets);
+  vtkBoundingBox bbox;
+  for (size_t cc = 0; cc < datasets.size(); ++cc)
+  {
+    if (datasets[cc]->GetNumberOfCells() > 0)
+    {
+      bbox.AddBounds(datasets[cc]->GetBounds());
+    }
+  }
+
+  // Reduce mins and negated maxs in a single call.
+  double local[6] = { VTK_DOUBLE_MAX, VTK_DOUBLE_MAX, VTK_DOUBLE_MAX, VTK_DOUBLE_MAX,
+    VTK_DOUBLE_MAX, VTK_DOUBLE_MAX };
+  if (bbox.IsValid())
+  {
+    for (int cc = 0; cc < 3; ++cc)
+    {
+      local[cc] = bbox.GetMinPoint()[cc];
+      local[cc + 3] = -bbox.GetMaxPoint()[cc];
+    }
+  }
+  double global[6];
+  this->KdTree->GetController()->AllReduce(local, global, 6, vtkCommunicator::MIN_OP);
+  for (int cc = 0; cc < 3; ++cc)
+  {
+    bounds[2 * cc] = global[cc];
+    bounds[2 * cc + 1] = -global[cc + 3];
+  }
+  return bounds[0] <= bounds[1] && bounds[2] <= bounds[3] && bounds[4] <= bounds[5];
+}
+
+//-----------------------------------------------------------------------------
+void vtkKdTreeManager::ComputeCellCenters(std::vector<float>& centers)
+{
+  std::vector<vtkDataSet*> datasets;
+  this->CollectDataSets(datasets);
+  vtkIdType numCells = 0;
+  for (size_t cc = 0; cc < datasets.size(); ++cc)
+  {
+    numCells += datasets[cc]->GetNumberOfCells();
+  }
+
+  centers.resize(3 * numCells);
+  float* center = centers.empty() ? nullptr : &centers[0];
+  for (size_t cc = 0; cc < datasets.size(); ++cc)
+  {
+    vtkDataSet* ds = datasets[cc];
+    const vtkIdType count = ds->GetNumberOfCells();
+    for (vtkIdType cellId = 0; cellId < count; ++cellId, center += 3)
+    {
+      vtkCellCenter(ds, cellId, center);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool vtkKdTreeManager::CanReuseDecomposition(const double bounds[6])
+{
+  const vtkDecomposition* decomposition = this->Decomposition;
+  if (!this->ReuseDecomposition || decomposition->Nodes.empty() ||
+    decomposition->NumberOfPieces != this->NumberOfPieces)
+  {
+    return false;
+  }
+
+  // The decision only depends on global values, so all processes agree.
+  const double* oldBounds = decomposition->Bounds;
+  double diagonal = 0.0;
+  for (int cc = 0; cc < 3; ++cc)
+  {
+    const double length = oldBounds[2 * cc + 1] - oldBounds[2 * cc];
+    diagonal += length * length;
+  }
+  const double tolerance = this->BoundsTolerance * std::sqrt(diagonal);
+  for (int cc = 0; cc < 6; cc += 2)
+  {
+    if (bounds[cc] < oldBounds[cc] || bounds[cc + 1] > oldBounds[cc + 1] ||
+      bounds[cc] - oldBounds[cc] > tolerance || oldBounds[cc + 1] - bounds[cc + 1] > tolerance)
+    {
+      return false;
+    }
+  }
+
+  // Count the cells of each piece, without keeping their centers.
+  std::vector<vtkDataSet*> datasets;
+  this->CollectDataSets(datasets);
+  std::vector<double> local(this->NumberOfPieces, 0.0);
+  std::vector<double> global(this->NumberOfPieces, 0.0);
+  float center[3];
+  for (size_t cc = 0; cc < datasets.size(); ++cc)
+  {
+    vtkDataSet* ds = datasets[cc];
+    const vtkIdType count = ds->GetNumberOfCells();
+    for (vtkIdType cellId = 0; cellId < count; ++cellId)
+    {
+      vtkCellCenter(ds, cellId, center);
+      local[decomposition->FindPiece(center)] += 1.0;
+    }
+  }
+  this->KdTree->GetController()->AllReduce(
+    &local[0], &global[0], this->NumberOfPieces, vtkCommunicator::SUM_OP);
+
+  const double total = std::accumulate(global.begin(), global.end(), 0.0);
+  const double largest = *std::max_element(global.begin(), global.end());
+  return largest <= (1.0 + this->ImbalanceTolerance) * total / this->NumberOfPieces;
+}
+
+//-----------------------------------------------------------------------------
+void vtkKdTreeManager::BuildBalancedCuts(const std::vector<float>& centers, const double bounds[6])
+{
+  // Recursive bisection: a node shared by k pieces is cut along its longest
+  // axis so that the left child holds k/2 pieces worth of cells. The position
+  // of the cut is found with histograms of the cell centers, refined a few
+  // times around the target. All the nodes of a level are refined together
+  // so that each refinement only needs one AllReduce.
+  vtkMultiProcessController* controller = this->KdTree->GetController();
+  vtkDecomposition* decomposition = this->Decomposition;
+  decomposition->NumberOfPieces = this->NumberOfPieces;
+  std::copy(bounds, bounds + 6, decomposition->Bounds);
+  decomposition->Nodes.resize(1);
+
+  vtkSmartPointer<vtkKdNode> root = vtkSmartPointer<vtkKdNode>::New();
+  root->DeleteChildNodes();
+
+  std::vector<vtkSplitTask> level(1);
+  level[0].KdNode = root;
+  level[0].Node = 0;
+  std::copy(bounds, bounds + 6, level[0].Bounds);
+  level[0].FirstPiece = 0;
+  level[0].NumberOfPieces = this->NumberOfPieces;
+  level[0].Cells.resize(centers.size() / 3);
+  std::iota(level[0].Cells.begin(), level[0].Cells.end(), 0);
+
+  std::vector<double> local;
+  std::vector<double> global;
+  while (!level.empty())
+  {
+    std::vector<vtkSplitTask*> splits;
+    for (size_t cc = 0; cc < level.size(); ++cc)
+    {
+      vtkSplitTask& task = level[cc];
+      task.KdNode->SetBounds(task.Bounds);
+      if (task.NumberOfPieces == 1)
+      {
+        // We set the ID to the piece so that it is easy to check the region
+        // assignments, KdTree will replace these IDs.
+        task.KdNode->SetDim(3);
+        task.KdNode->SetID(task.FirstPiece);
+        vtkDecomposition::Node& node = decomposition->Nodes[task.Node];
+        node.Axis = -1;
+        node.Cut = 0.0;
+        node.Left = node.Right = -1;
+        node.Piece = task.FirstPiece;
+        continue;
+      }
+
+      task.Axis = 0;
+      for (int axis = 1; axis < 3; ++axis)
+      {
+        if (task.Bounds[2 * axis + 1] - task.Bounds[2 * axis] >
+          task.Bounds[2 * task.Axis + 1] - task.Bounds[2 * task.Axis])
+        {
+          task.Axis = axis;
+        }
+      }
+      task.Lo = task.Bounds[2 * task.Axis];
+      task.Hi = task.Bounds[2 * task.Axis + 1];
+      task.Below = 0.0;
+      task.Done = false;
+      task.Window = task.Cells;
+      splits.push_back(&task);
+    }
+
+    const size_t numSplits = splits.size();
+    for (int round = 0; round < vtkNumberOfRefinements && numSplits > 0; ++round)
+    {
+      local.assign(numSplits * vtkNumberOfBins, 0.0);
+      global.assign(numSplits * vtkNumberOfBins, 0.0);
+      for (size_t cc = 0; cc < numSplits; ++cc)
+      {
+        vtkSplitTask& task = *splits[cc];
+        double* histogram = &local[cc * vtkNumberOfBins];
+        for (size_t kk = 0; !task.Done && kk < task.Window.size(); ++kk)
+        {
+          const double x = centers[3 * task.Window[kk] + task.Axis];
+          histogram[vtkBinOf(x, task.Lo, task.Hi)] += 1.0;
+        }
+      }
+      controller->AllReduce(
+        &local[0], &global[0], static_cast<vtkIdType>(local.size()), vtkCommunicator::SUM_OP);
+
+      for (size_t cc = 0; cc < numSplits; ++cc)
+      {
+        vtkSplitTask& task = *splits[cc];
+        if (task.Done)
+        {
+          continue;
+        }
+        const double* histogram = &global[cc * vtkNumberOfBins];
+        if (round == 0)
+        {
+          const double total = std::accumulate(histogram, histogram + vtkNumberOfBins, 0.0);
+          if (total <= 0.0)
+          {
+            // No cells anywhere in this node, split it in halves.
+            task.Cut = 0.5 * (task.Lo + task.Hi);
+            task.Done = true;
+            continue;
+          }
+          task.Target = total * (task.NumberOfPieces / 2) / task.NumberOfPieces;
+        }
+
+        int bin = 0;
+        double below = task.Below;
+        while (bin < vtkNumberOfBins - 1 && below + histogram[bin] < task.Target)
+        {
+          below += histogram[bin];
+          ++bin;
+        }
+        const double width = (task.Hi - task.Lo) / vtkNumberOfBins;
+        const double binLo = task.Lo + bin * width;
+        if (round == vtkNumberOfRefinements - 1 || histogram[bin] <= 0.0)
+        {
+          const double fraction =
+            histogram[bin] > 0.0 ? (task.Target - below) / histogram[bin] : 0.5;
+          task.Cut = binLo + std::min(std::max(fraction, 0.0), 1.0) * width;
+          task.Done = true;
+          continue;
+        }
+
+        // Zoom on the bin containing the target.
+        std::vector<vtkIdType> window;
+        for (size_t kk = 0; kk < task.Window.size(); ++kk)
+        {
+          const double x = centers[3 * task.Window[kk] + task.Axis];
+          if (vtkBinOf(x, task.Lo, task.Hi) == bin)
+          {
+            window.push_back(task.Window[kk]);
+          }
+        }
+        task.Window.swap(window);
+        task.Below = below;
+        task.Hi = bin == vtkNumberOfBins - 1 ? task.Hi : binLo + width;
+        task.Lo = binLo;
+      }
+    }
+
+    std::vector<vtkSplitTask> next;
+    next.reserve(2 * numSplits);
+    for (size_t cc = 0; cc < numSplits; ++cc)
+    {
+      vtkSplitTask& task = *splits[cc];
+      const int axis = task.Axis;
+      const double cut =
+        std::min(std::max(task.Cut, task.Bounds[2 * axis]), task.Bounds[2 * axis + 1]);
+      std::vector<vtkIdType>().swap(task.Window);
+
+      vtkSplitTask left;
+      left.KdNode = vtkKdNode::New();
+      left.Node = static_cast<int>(decomposition->Nodes.size());
+      std::copy(task.Bounds, task.Bounds + 6, left.Bounds);
+      left.Bounds[2 * axis + 1] = cut;
+      left.FirstPiece = task.FirstPiece;
+      left.NumberOfPieces = task.NumberOfPieces / 2;
+
+      vtkSplitTask right;
+      right.KdNode = vtkKdNode::New();
+      right.Node = left.Node + 1;
+      std::copy(task.Bounds, task.Bounds + 6, right.Bounds);
+      right.Bounds[2 * axis] = cut;
+      right.FirstPiece = task.FirstPiece + left.NumberOfPieces;
+      right.NumberOfPieces = task.NumberOfPieces - left.NumberOfPieces;
+
+      for (size_t kk = 0; kk < task.Cells.size(); ++kk)
+      {
+        const vtkIdType cellId = task.Cells[kk];
+        (centers[3 * cellId + axis] < cut ? left : right).Cells.push_back(cellId);
+      }
+      std::vector<vtkIdType>().swap(task.Cells);
+
+      task.KdNode->SetDim(axis);
+      task.KdNode->SetLeft(left.KdNode);
+      task.KdNode->SetRight(right.KdNode);
+      left.KdNode->Delete();
+      right.KdNode->Delete();
+
+      vtkDecomposition::Node& node = decomposition->Nodes[task.Node];
+      node.Axis = axis;
+      node.Cut = cut;
+      node.Left = left.Node;
+      node.Right = right.Node;
+      node.Piece = -1;
+      decomposition->Nodes.resize(decomposition->Nodes.size() + 2);
+
+      next.push_back(std::move(left));
+      next.push_back(std::move(right));
+    }
+    level.swap(next);
+  }
+
+  // Pieces are numbered left to right, like the regions of the KdTree.
+  std::vector<int> assignments(this->NumberOfPieces);
+  std::iota(assignments.begin(), assignments.end(), 0);
+  this->KdTree->AssignRegions(&assignments[0], this->NumberOfPieces);
+
+  vtkSmartPointer<vtkBSPCuts> cuts = vtkSmartPointer<vtkBSPCuts>::New();
+  cuts->CreateCuts(root);
+  this->KdTree->SetCuts(cuts);
+}
+
 //-----------------------------------------------------------------------------
 void vtkKdTreeManager::AddDataObjectToKdTree(vtkDataObject* data)
 {
@@ -285,4 +773,8 @@ void vtkKdTreeManager::PrintSelf(ostream& os, vtkIndent indent)
   this->Superclass::PrintSelf(os, indent);
   os << indent << "KdTree: " << this->KdTree << endl;
   os << indent << "NumberOfPieces: " << this->NumberOfPieces << endl;
+  os << indent << "BalanceCellCounts: " << this->BalanceCellCounts << endl;
+  os << indent << "ReuseDecomposition: " << this->ReuseDecomposition << endl;
+  os << indent << "BoundsTolerance: " << this->BoundsTolerance << endl;
+  os << indent << "ImbalanceTolerance: " << this->ImbalanceTolerance << endl;
 }
@@ -22,7 +22,12 @@
  * present, or using the partitions provided by the structure data's extent
  * translator. This class manages this logic. When structure data's extent
  * translator is to be used, it simply uses vtkKdTreeGenerator. Otherwise, it
- * lets the vtkPKdTree build the optimal partitioning for the data.
+ * places the cuts itself so that each piece gets an equal share of the cells
+ * over all processes (see BalanceCellCounts).
+ *
+ * The decomposition built for unstructured data is remembered, and reused by
+ * subsequent GenerateKdTree() calls, without modifying the KdTree, as long as
+ * the data did not move or grow much (see ReuseDecomposition).
 */
 
 #ifndef vtkKdTreeManager_h
@@ -32,6 +37,8 @@
 #include "vtkPVVTKExtensionsRenderingModule.h" // needed for export macro
 #include "vtkSmartPointer.h"                   // needed for vtkSmartPointer.
 
+#include <vector> // needed for std::vector
+
 class vtkPKdTree;
 class vtkAlgorithm;
 class vtkDataSet;
@@ -60,6 +67,11 @@ public:
   void SetStructuredDataInformation(vtkExtentTranslator* translator, const int whole_extent[6],
     const double origin[3], const double spacing[3]);
 
+  /**
+   * Clears the information set with SetStructuredDataInformation().
+   */
+  void RemoveStructuredDataInformation();
+
   //@{
   /**
    * Get/Set the KdTree managed by this manager.
@@ -78,8 +90,41 @@ public:
   vtkGetMacro(NumberOfPieces, int);
   //@}
 
+  //@{
+  /**
+   * When on, the cuts for unstructured data are placed by recursive bisection
+   * of the cell centers of all processes so that each piece gets the same
+   * number of cells. Otherwise, vtkPKdTree builds a power-of-two number of
+   * regions that are then assigned contiguously, which can give twice as many
+   * cells to some pieces when the number of pieces is not a power of two.
+   * Not used when structured data information is provided. Default is on.
+   */
+  vtkSetMacro(BalanceCellCounts, bool);
+  vtkGetMacro(BalanceCellCounts, bool);
+  vtkBooleanMacro(BalanceCellCounts, bool);
+  //@}
+
+  //@{
+  /**
+   * When on, the decomposition built with BalanceCellCounts is kept by
+   * GenerateKdTree() if the new data still fits in it: the global bounds of
+   * the data are within the old ones and no side moved inward by more than
+   * BoundsTolerance times the old diagonal, and no piece gets more than
+   * (1 + ImbalanceTolerance) times the average number of cells. In that case
+   * the KdTree is left untouched, so its MTime does not change. Default is
+   * on, with tolerances of 0.05 and 0.2.
+   */
+  vtkSetMacro(ReuseDecomposition, bool);
+  vtkGetMacro(ReuseDecomposition, bool);
+  vtkBooleanMacro(ReuseDecomposition, bool);
+  vtkSetClampMacro(BoundsTolerance, double, 0.0, 1.0);
+  vtkGetMacro(BoundsTolerance, double);
+  vtkSetClampMacro(ImbalanceTolerance, double, 0.0, VTK_DOUBLE_MAX);
+  vtkGetMacro(ImbalanceTolerance, double);
+  //@}
+
   /**
-   * Rebuilds the KdTree.
+   * Rebuilds the KdTree, unless the previous decomposition can be reused.
    */
   void GenerateKdTree();
 
@@ -90,6 +135,36 @@ protected:
   void AddDataObjectToKdTree(vtkDataObject* data);
   void AddDataSetToKdTree(vtkDataSet* data);
 
+  /**
+   * Collects the non-composite datasets of the data objects.
+   */
+  void CollectDataSets(std::vector<vtkDataSet*>& datasets);
+
+  /**
+   * Computes the global bounds of the data. Returns false if no process has
+   * any cells.
+   */
+  bool ComputeBounds(double bounds[6]);
+
+  /**
+   * Computes the centers of the local cells.
+   */
+  void ComputeCellCenters(std::vector<float>& centers);
+
+  /**
+   * Returns true if the decomposition from the previous call to
+   * BuildBalancedCuts() can be used for data with the given global bounds.
+   * The cells are assigned to the pieces of the decomposition one at a time,
+   * so that no centers are computed for data that needs new cuts.
+   */
+  bool CanReuseDecomposition(const double bounds[6]);
+
+  /**
+   * Sets up the KdTree cuts and region assignments so that each piece gets
+   * the same number of cells.
+   */
+  void BuildBalancedCuts(const std::vector<float>& centers, const double bounds[6]);
+
   bool KdTreeInitialized;
   vtkPKdTree* KdTree;
   int NumberOfPieces;
@@ -99,6 +174,11 @@ protected:
   double Spacing[3];
   int WholeExtent[6];
 
+  bool BalanceCellCounts;
+  bool ReuseDecomposition;
+  double BoundsTolerance;
+  double ImbalanceTolerance;
+
   vtkSetVector3Macro(Origin, double);
   vtkSetVector3Macro(Spacing, double);
   vtkSetVector6Macro(WholeExtent, int);
@@ -109,6 +189,9 @@ private:
 
   class vtkDataObjectSet;
   vtkDataObjectSet* DataObjects;
+
+  class vtkDecomposition;
+  vtkDecomposition* Decomposition;
 };
 
 #endif
@@ -0,0 +1,653 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    vtkPVQuadricClustering.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkPVQuadricClustering.h"
+
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
+#include "vtkInformation.h"
+#include "vtkInformationVector.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+// Number of buckets the bins are hashed into. Buckets are merged
+// independently, which is what makes the merge parallel.
+const vtkIdType vtkNumberOfBuckets = 64;
+
+// Upper bound on the number of chunks cells are split into. Chunk boundaries do
+// not depend on the number of threads, and per-chunk results are combined in
+// chunk order, which keeps the output (including the floating point sums of
+// the quadrics) independent of the number of threads.
+const vtkIdType vtkMaxNumberOfChunks = 256;
+
+// Symmetric 4x4 quadric stored as its upper triangle:
+// a2 ab ac ad b2 bc bd c2 cd d2
+struct vtkQuadric
+{
+  double Q[10];
+  vtkQuadric() { std::fill(this->Q, this->Q + 10, 0.0); }
+
+  void Add(const vtkQuadric& other)
+  {
+    for (int cc = 0; cc < 10; ++cc)
+    {
+      this->Q[cc] += other.Q[cc];
+    }
+  }
+
+  double Error(const double x[3]) const
+  {
+    const double* q = this->Q;
+    return q[0] * x[0] * x[0] + 2 * q[1] * x[0] * x[1] + 2 * q[2] * x[0] * x[2] +
+      2 * q[3] * x[0] + q[4] * x[1] * x[1] + 2 * q[5] * x[1] * x[2] + 2 * q[6] * x[1] +
+      q[7] * x[2] * x[2] + 2 * q[8] * x[2] + q[9];
+  }
+};
+
+typedef std::unordered_map<vtkIdType, vtkQuadric> vtkBucketType;
+typedef std::vector<vtkBucketType> vtkBucketsType;
+
+inline vtkIdType vtkBucketOf(vtkIdType bin)
+{
+  return bin % vtkNumberOfBuckets;
+}
+
+// Area weighted plane quadric of a triangle. Returns false for degenerate
+// triangles.
+bool vtkTriangleQuadric(const double p0[3], const double p1[3], const double p2[3], vtkQuadric& q)
+{
+  double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+  double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+  double n[3];
+  vtkMath::Cross(e1, e2, n);
+  double length = vtkMath::Norm(n);
+  if (length == 0.0)
+  {
+    return false;
+  }
+  const double area = 0.5 * length;
+  n[0] /= length;
+  n[1] /= length;
+  n[2] /= length;
+  const double d = -vtkMath::Dot(n, p0);
+  const double plane[4] = { n[0], n[1], n[2], d };
+  int idx = 0;
+  for (int i = 0; i < 4; ++i)
+  {
+    for (int j = i; j < 4; ++j)
+    {
+      q.Q[idx++] = area * plane[i] * plane[j];
+    }
+  }
+  return true;
+}
+
+class vtkBinning
+{
+public:
+  double Origin[3];
+  double Size[3];
+  int Divisions[3];
+
+  vtkIdType BinOf(const double x[3]) const
+  {
+    int ijk[3];
+    for (int cc = 0; cc < 3; ++cc)
+    {
+      int idx = this->Size[cc] > 0 ? static_cast<int>((x[cc] - this->Origin[cc]) / this->Size[cc])
+                                   : 0;
+      ijk[cc] = std::max(0, std::min(idx, this->Divisions[cc] - 1));
+    }
+    const vtkIdType nx = this->Divisions[0];
+    const vtkIdType ny = this->Divisions[1];
+    return ijk[0] + nx * (ijk[1] + ny * ijk[2]);
+  }
+
+  void CenterOf(vtkIdType bin, double center[3]) const
+  {
+    vtkIdType ijk[3];
+    ijk[0] = bin % this->Divisions[0];
+    bin /= this->Divisions[0];
+    ijk[1] = bin % this->Divisions[1];
+    ijk[2] = bin / this->Divisions[1];
+    for (int cc = 0; cc < 3; ++cc)
+    {
+      center[cc] = this->Origin[cc] + (ijk[cc] + 0.5) * this->Size[cc];
+    }
+  }
+};
+
+// Computes the bin of every input point.
+struct vtkBinPointsFunctor
+{
+  vtkPoints* Points;
+  const vtkBinning* Binning;
+  vtkIdType* Bins;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    double x[3];
+    for (vtkIdType cc = begin; cc < end; ++cc)
+    {
+      this->Points->GetPoint(cc, x);
+      this->Bins[cc] = this->Binning->BinOf(x);
+    }
+  }
+};
+
+// Triangles of the fan triangulation of the polygons. Polygon offsets are
+// computed up front so that cells can be visited in parallel.
+struct vtkPolygons
+{
+  const vtkIdType* Connectivity;
+  std::vector<vtkIdType> Offsets;
+
+  template <typename Visitor>
+  void VisitTriangles(vtkIdType cellId, Visitor& visitor) const
+  {
+    const vtkIdType* cell = this->Connectivity + this->Offsets[cellId];
+    const vtkIdType npts = cell[0];
+    for (vtkIdType cc = 2; cc < npts; ++cc)
+    {
+      visitor(cellId, cell[1], cell[cc], cell[cc + 1]);
+    }
+  }
+};
+
+// Quadric accumulation, one set of buckets per chunk of cells.
+struct vtkAccumulateFunctor
+{
+  const vtkPolygons* Polygons;
+  vtkPoints* Points;
+  const vtkIdType* Bins;
+  bool UseInternalTriangles;
+  vtkIdType NumberOfCells;
+  vtkIdType ChunkSize;
+  std::vector<vtkBucketsType>* ChunkBuckets;
+  vtkBucketsType* Current;
+
+  void operator()(vtkIdType, vtkIdType a, vtkIdType b, vtkIdType c)
+  {
+    const vtkIdType bins[3] = { this->Bins[a], this->Bins[b], this->Bins[c] };
+    if (!this->UseInternalTriangles && bins[0] == bins[1] && bins[0] == bins[2])
+    {
+      return;
+    }
+    double p[3][3];
+    this->Points->GetPoint(a, p[0]);
+    this->Points->GetPoint(b, p[1]);
+    this->Points->GetPoint(c, p[2]);
+    vtkQuadric q;
+    if (!vtkTriangleQuadric(p[0], p[1], p[2], q))
+    {
+      return;
+    }
+    vtkBucketsType& buckets = *this->Current;
+    for (int cc = 0; cc < 3; ++cc)
+    {
+      buckets[vtkBucketOf(bins[cc])][bins[cc]].Add(q);
+    }
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    // operator() may be called by several threads; use a copy to carry the
+    // current buckets.
+    vtkAccumulateFunctor local = *this;
+    for (vtkIdType chunk = begin; chunk < end; ++chunk)
+    {
+      local.Current = &(*this->ChunkBuckets)[chunk];
+      local.Current->resize(vtkNumberOfBuckets);
+      const vtkIdType first = chunk * this->ChunkSize;
+      const vtkIdType last = std::min(first + this->ChunkSize, this->NumberOfCells);
+      for (vtkIdType cc = first; cc < last; ++cc)
+      {
+        this->Polygons->VisitTriangles(cc, local);
+      }
+    }
+  }
+};
+
+// Merges bucket k of every chunk, in chunk order, into the k-th merged bucket.
+struct vtkMergeFunctor
+{
+  std::vector<vtkBucketsType>* ChunkBuckets;
+  vtkBucketsType* Merged;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType k = begin; k < end; ++k)
+    {
+      vtkBucketType& merged = (*this->Merged)[k];
+      for (size_t t = 0; t < this->ChunkBuckets->size(); ++t)
+      {
+        vtkBucketType& bucket = (*this->ChunkBuckets)[t][k];
+        for (vtkBucketType::iterator iter = bucket.begin(); iter != bucket.end(); ++iter)
+        {
+          merged[iter->first].Add(iter->second);
+        }
+        vtkBucketType().swap(bucket);
+      }
+    }
+  }
+};
+
+// Collects the triangles whose vertices fall in three different bins, one list
+// per chunk of cells. Each triangle is stored as bin, bin, bin, input cell id.
+struct vtkEmitFunctor
+{
+  const vtkPolygons* Polygons;
+  const vtkIdType* Bins;
+  vtkIdType NumberOfCells;
+  vtkIdType ChunkSize;
+  std::vector<std::vector<vtkIdType> >* Triangles;
+  std::vector<vtkIdType>* Current;
+
+  void operator()(vtkIdType cellId, vtkIdType a, vtkIdType b, vtkIdType c)
+  {
+    const vtkIdType bins[3] = { this->Bins[a], this->Bins[b], this->Bins[c] };
+    if (bins[0] != bins[1] && bins[0] != bins[2] && bins[1] != bins[2])
+    {
+      this->Current->insert(this->Current->end(), bins, bins + 3);
+      this->Current->push_back(cellId);
+    }
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    // operator() may be called by several threads; use a copy to carry the
+    // current list.
+    vtkEmitFunctor local = *this;
+    for (vtkIdType chunk = begin; chunk < end; ++chunk)
+    {
+      local.Current = &(*this->Triangles)[chunk];
+      const vtkIdType first = chunk * this->ChunkSize;
+      const vtkIdType last = std::min(first + this->ChunkSize, this->NumberOfCells);
+      for (vtkIdType cc = first; cc < last; ++cc)
+      {
+        this->Polygons->VisitTriangles(cc, local);
+      }
+    }
+  }
+};
+
+// Selects, for each output point, the input point with the smallest quadric
+// error in its bin. Ties go to the smallest point id.
+struct vtkSelectInputPointsFunctor
+{
+  vtkPoints* Points;
+  const vtkIdType* Bins;
+  const std::vector<vtkIdType>* UsedBins;
+  const vtkBucketsType* Quadrics;
+
+  struct Candidate
+  {
+    double Error;
+    vtkIdType PointId;
+  };
+  typedef std::vector<Candidate> CandidatesType;
+  vtkSMPThreadLocal<CandidatesType> Candidates;
+
+  void Initialize()
+  {
+    Candidate none = { VTK_DOUBLE_MAX, -1 };
+    this->Candidates.Local().assign(this->UsedBins->size(), none);
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    CandidatesType& candidates = this->Candidates.Local();
+    double x[3];
+    for (vtkIdType cc = begin; cc < end; ++cc)
+    {
+      const vtkIdType bin = this->Bins[cc];
+      std::vector<vtkIdType>::const_iterator iter =
+        std::lower_bound(this->UsedBins->begin(), this->UsedBins->end(), bin);
+      if (iter == this->UsedBins->end() || *iter != bin)
+      {
+        continue;
+      }
+      const vtkBucketType& bucket = (*this->Quadrics)[vtkBucketOf(bin)];
+      vtkBucketType::const_iterator q = bucket.find(bin);
+      this->Points->GetPoint(cc, x);
+      const double error = q != bucket.end() ? q->second.Error(x) : 0.0;
+      Candidate& candidate = candidates[iter - this->UsedBins->begin()];
+      if (error < candidate.Error || (error == candidate.Error && cc < candidate.PointId))
+      {
+        candidate.Error = error;
+        candidate.PointId = cc;
+      }
+    }
+  }
+
+  void Reduce() {}
+};
+
+struct vtkReduceCandidatesFunctor
+{
+  std::vector<vtkSelectInputPointsFunctor::CandidatesType*> ThreadCandidates;
+  vtkIdType* PointIds;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType cc = begin; cc < end; ++cc)
+    {
+      vtkSelectInputPointsFunctor::Candidate best = { VTK_DOUBLE_MAX, -1 };
+      for (size_t t = 0; t < this->ThreadCandidates.size(); ++t)
+      {
+        const vtkSelectInputPointsFunctor::Candidate& candidate = (*this->ThreadCandidates[t])[cc];
+        if (candidate.PointId >= 0 && (best.PointId < 0 || candidate.Error < best.Error ||
+                                        (candidate.Error == best.Error &&
+                                          candidate.PointId < best.PointId)))
+        {
+          best = candidate;
+        }
+      }
+      this->PointIds[cc] = best.PointId;
+    }
+  }
+};
+
+// Computes the point minimizing the quadric error of each output bin, using
+// the pseudo-inverse around the bin center like vtkQuadricClustering.
+struct vtkOptimalPointsFunctor
+{
+  const vtkBinning* Binning;
+  const std::vector<vtkIdType>* UsedBins;
+  const vtkBucketsType* Quadrics;
+  vtkPoints* Output;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType cc = begin; cc < end; ++cc)
+    {
+      const vtkIdType bin = (*this->UsedBins)[cc];
+      double x[3];
+      this->Binning->CenterOf(bin, x);
+
+      const vtkBucketType& bucket = (*this->Quadrics)[vtkBucketOf(bin)];
+      vtkBucketType::const_iterator iter = bucket.find(bin);
+      if (iter != bucket.end())
+      {
+        const double* q = iter->second.Q;
+        double A[3][3] = { { q[0], q[1], q[2] }, { q[1], q[4], q[5] }, { q[2], q[5], q[7] } };
+        double b[3] = { -q[3], -q[6], -q[8] };
+        double U[3][3], w[3], VT[3][3];
+        vtkMath::SingularValueDecomposition3x3(A, U, w, VT);
+        const double maxW = std::max(std::abs(w[0]), std::max(std::abs(w[1]), std::abs(w[2])));
+
+        // r = b - A x
+        double r[3];
+        for (int i = 0; i < 3; ++i)
+        {
+          r[i] = b[i] - (A[i][0] * x[0] + A[i][1] * x[1] + A[i][2] * x[2]);
+        }
+        // x += V W^+ U^T r, dropping small singular values.
+        double tmp[3];
+        for (int i = 0; i < 3; ++i)
+        {
+          tmp[i] = 0.0;
+          if (maxW > 0 && std::abs(w[i]) > 1e-3 * maxW)
+          {
+            tmp[i] = (U[0][i] * r[0] + U[1][i] * r[1] + U[2][i] * r[2]) / w[i];
+          }
+        }
+        for (int i = 0; i < 3; ++i)
+        {
+          x[i] += VT[0][i] * tmp[0] + VT[1][i] * tmp[1] + VT[2][i] * tmp[2];
+        }
+      }
+      this->Output->SetPoint(cc, x);
+    }
+  }
+};
+
+// Fills the output connectivity from the per-chunk triangle lists.
+struct vtkConnectivityFunctor
+{
+  const std::vector<std::vector<vtkIdType> >* Triangles;
+  const std::vector<vtkIdType>* Offsets;
+  const std::vector<vtkIdType>* UsedBins;
+  vtkIdType* Connectivity;
+  vtkIdType* SourceCells;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType chunk = begin; chunk < end; ++chunk)
+    {
+      const std::vector<vtkIdType>& triangles = (*this->Triangles)[chunk];
+      vtkIdType outCell = (*this->Offsets)[chunk];
+      for (size_t cc = 0; cc < triangles.size(); cc += 4, ++outCell)
+      {
+        vtkIdType* cell = this->Connectivity + 4 * outCell;
+        cell[0] = 3;
+        for (int i = 0; i < 3; ++i)
+        {
+          cell[i + 1] =
+            std::lower_bound(this->UsedBins->begin(), this->UsedBins->end(), triangles[cc + i]) -
+            this->UsedBins->begin();
+        }
+        this->SourceCells[outCell] = triangles[cc + 3];
+      }
+    }
+  }
+};
+}
+
+vtkStandardNewMacro(vtkPVQuadricClustering);
+//----------------------------------------------------------------------------
+vtkPVQuadricClustering::vtkPVQuadricClustering()
+{
+  this->UseMultithreading = true;
+}
+
+//----------------------------------------------------------------------------
+vtkPVQuadricClustering::~vtkPVQuadricClustering()
+{
+}
+
+//----------------------------------------------------------------------------
+int vtkPVQuadricClustering::RequestData(
+  vtkInformation* request, vtkInformationVector** inputVector, vtkInformationVector* outputVector)
+{
+  vtkPolyData* input = vtkPolyData::GetData(inputVector[0], 0);
+  vtkPolyData* output = vtkPolyData::GetData(outputVector, 0);
+  if (this->UseMultithreading && input && output &&
+    this->RequestDataMultithreaded(input, output))
+  {
+    return 1;
+  }
+  return this->Superclass::RequestData(request, inputVector, outputVector);
+}
+
+//----------------------------------------------------------------------------
+bool vtkPVQuadricClustering::RequestDataMultithreaded(vtkPolyData* input, vtkPolyData* output)
+{
+  vtkPoints* inPoints = input->GetPoints();
+  if (!inPoints || input->GetNumberOfPolys() == 0 || input->GetNumberOfVerts() > 0 ||
+    input->GetNumberOfLines() > 0 || input->GetNumberOfStrips() > 0 || this->UseFeatureEdges ||
+    this->UseFeaturePoints || this->ComputeNumberOfDivisions)
+  {
+    return false;
+  }
+
+  const vtkIdType numPoints = input->GetNumberOfPoints();
+  const vtkIdType numCells = input->GetNumberOfPolys();
+
+  // Bins span the input bounds. Flat dimensions get a single division.
+  vtkBinning binning;
+  double bounds[6];
+  input->GetBounds(bounds);
+  int divisions[3];
+  this->GetNumberOfDivisions(divisions);
+  for (int cc = 0; cc < 3; ++cc)
+  {
+    const double length = bounds[2 * cc + 1] - bounds[2 * cc];
+    binning.Divisions[cc] = length > 0 ? std::max(divisions[cc], 1) : 1;
+    binning.Origin[cc] = bounds[2 * cc];
+    binning.Size[cc] = length / binning.Divisions[cc];
+  }
+
+  std::vector<vtkIdType> bins(numPoints);
+  vtkBinPointsFunctor binPoints = { inPoints, &binning, bins.empty() ? NULL : &bins[0] };
+  vtkSMPTools::For(0, numPoints, binPoints);
+  this->UpdateProgress(0.1);
+
+  vtkPolygons polygons;
+  vtkCellArray* polys = input->GetPolys();
+  polygons.Connectivity = polys->GetPointer();
+  polygons.Offsets.resize(numCells);
+  for (vtkIdType cc = 0, offset = 0; cc < numCells; ++cc)
+  {
+    polygons.Offsets[cc] = offset;
+    offset += polygons.Connectivity[offset] + 1;
+  }
+
+  // Cells are processed in fixed chunks, see vtkMaxNumberOfChunks.
+  const vtkIdType numChunks = std::min(numCells, vtkMaxNumberOfChunks);
+  const vtkIdType chunkSize = (numCells + numChunks - 1) / numChunks;
+
+  // Accumulate the quadrics per chunk, then merge them bucket by bucket.
+  std::vector<vtkBucketsType> chunkQuadrics(numChunks);
+  vtkAccumulateFunctor accumulate;
+  accumulate.Polygons = &polygons;
+  accumulate.Points = inPoints;
+  accumulate.Bins = &bins[0];
+  accumulate.UseInternalTriangles = this->UseInternalTriangles != 0;
+  accumulate.NumberOfCells = numCells;
+  accumulate.ChunkSize = chunkSize;
+  accumulate.ChunkBuckets = &chunkQuadrics;
+  accumulate.Current = NULL;
+  vtkSMPTools::For(0, numChunks, 1, accumulate);
+
+  vtkBucketsType quadrics(vtkNumberOfBuckets);
+  vtkMergeFunctor merge = { &chunkQuadrics, &quadrics };
+  vtkSMPTools::For(0, vtkNumberOfBuckets, 1, merge);
+  std::vector<vtkBucketsType>().swap(chunkQuadrics);
+  this->UpdateProgress(0.5);
+
+  // Output triangles, grouped in the same chunks of input cells.
+  std::vector<std::vector<vtkIdType> > triangles(numChunks);
+  vtkEmitFunctor emit;
+  emit.Polygons = &polygons;
+  emit.Bins = &bins[0];
+  emit.NumberOfCells = numCells;
+  emit.ChunkSize = chunkSize;
+  emit.Triangles = &triangles;
+  emit.Current = NULL;
+  vtkSMPTools::For(0, numChunks, 1, emit);
+
+  // Output points are the bins used by the output triangles, in bin order.
+  std::vector<vtkIdType> offsets(numChunks + 1, 0);
+  std::vector<vtkIdType> usedBins;
+  for (vtkIdType chunk = 0; chunk < numChunks; ++chunk)
+  {
+    const std::vector<vtkIdType>& list = triangles[chunk];
+    offsets[chunk + 1] = offsets[chunk] + static_cast<vtkIdType>(list.size() / 4);
+    for (size_t cc = 0; cc < list.size(); cc += 4)
+    {
+      usedBins.insert(usedBins.end(), list.begin() + cc, list.begin() + cc + 3);
+    }
+  }
+  std::sort(usedBins.begin(), usedBins.end());
+  usedBins.erase(std::unique(usedBins.begin(), usedBins.end()), usedBins.end());
+  const vtkIdType numOutPoints = static_cast<vtkIdType>(usedBins.size());
+  const vtkIdType numOutCells = offsets[numChunks];
+  this->UpdateProgress(0.7);
+
+  vtkNew<vtkPoints> outPoints;
+  outPoints->SetDataType(inPoints->GetDataType());
+  outPoints->SetNumberOfPoints(numOutPoints);
+  vtkPointData* outPD = output->GetPointData();
+  if (this->UseInputPoints)
+  {
+    vtkSelectInputPointsFunctor select;
+    select.Points = inPoints;
+    select.Bins = &bins[0];
+    select.UsedBins = &usedBins;
+    select.Quadrics = &quadrics;
+    vtkSMPTools::For(0, numPoints, select);
+
+    vtkNew<vtkIdList> pointIds;
+    pointIds->SetNumberOfIds(numOutPoints);
+    vtkReduceCandidatesFunctor reduce;
+    reduce.PointIds = pointIds->GetPointer(0);
+    for (vtkSMPThreadLocal<vtkSelectInputPointsFunctor::CandidatesType>::iterator iter =
+           select.Candidates.begin();
+         iter != select.Candidates.end(); ++iter)
+    {
+      reduce.ThreadCandidates.push_back(&(*iter));
+    }
+    vtkSMPTools::For(0, numOutPoints, reduce);
+
+    inPoints->GetPoints(pointIds.GetPointer(), outPoints.GetPointer());
+    outPD->CopyAllocate(input->GetPointData(), numOutPoints);
+    for (vtkIdType cc = 0; cc < numOutPoints; ++cc)
+    {
+      outPD->CopyData(input->GetPointData(), pointIds->GetId(cc), cc);
+    }
+  }
+  else
+  {
+    vtkOptimalPointsFunctor optimal = { &binning, &usedBins, &quadrics, outPoints.GetPointer() };
+    vtkSMPTools::For(0, numOutPoints, optimal);
+  }
+  this->UpdateProgress(0.9);
+
+  vtkNew<vtkIdTypeArray> connectivity;
+  connectivity->SetNumberOfValues(4 * numOutCells);
+  std::vector<vtkIdType> sourceCells(numOutCells);
+  vtkConnectivityFunctor fill = { &triangles, &offsets, &usedBins, connectivity->GetPointer(0),
+    sourceCells.empty() ? NULL : &sourceCells[0] };
+  vtkSMPTools::For(0, numChunks, 1, fill);
+
+  vtkNew<vtkCellArray> outPolys;
+  outPolys->SetCells(numOutCells, connectivity.GetPointer());
+  output->SetPoints(outPoints.GetPointer());
+  output->SetPolys(outPolys.GetPointer());
+
+  if (this->CopyCellData)
+  {
+    vtkCellData* outCD = output->GetCellData();
+    outCD->CopyAllocate(input->GetCellData(), numOutCells);
+    // Polygons are the only cells of the input, so polygon ids are cell ids.
+    for (vtkIdType cc = 0; cc < numOutCells; ++cc)
+    {
+      outCD->CopyData(input->GetCellData(), sourceCells[cc], cc);
+    }
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkPVQuadricClustering::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "UseMultithreading: " << this->UseMultithreading << endl;
+}
@@ -0,0 +1,88 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    vtkPVQuadricClustering.h
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+ * @class   vtkPVQuadricClustering
+ * @brief   multithreaded quadric clustering decimation.
+ *
+ * vtkPVQuadricClustering is a vtkQuadricClustering that uses vtkSMPTools to
+ * decimate polygonal meshes. The cells are split into a fixed number of chunks
+ * that do not depend on the number of threads. The triangle quadrics of each
+ * chunk are accumulated into their own bins, and the per-chunk bins are then
+ * merged in chunk order, in parallel over buckets of bins. Representative
+ * points and output triangles are computed in parallel as well, and the output
+ * triangles are ordered like the input cells. Since every sum is evaluated in
+ * the same order, the result does not depend on the number of threads.
+ *
+ * The bins span the bounds of the input using the requested number of
+ * divisions; AutoAdjustNumberOfDivisions is not applied, so the output is close
+ * to, but not the same as, the serial output. Only polygons are handled by the
+ * multithreaded path; inputs with vertices, lines or strips, as well as feature
+ * edge/point handling and ComputeNumberOfDivisions (DivisionOrigin and
+ * DivisionSpacing), fall back to the serial superclass implementation. The
+ * multithreaded path supports UseInputPoints (copying point data of the
+ * selected points), CopyCellData and UseInternalTriangles.
+ *
+ * This is used to generate the LOD geometry in vtkGeometryRepresentation when
+ * VTK-m is not available.
+ *
+ * @sa
+ * vtkQuadricClustering
+*/
+
+#ifndef vtkPVQuadricClustering_h
+#define vtkPVQuadricClustering_h
+
+#include "vtkPVVTKExtensionsRenderingModule.h" // needed for export macro
+#include "vtkQuadricClustering.h"
+
+class vtkPolyData;
+
+class VTKPVVTKEXTENSIONSRENDERING_EXPORT vtkPVQuadricClustering : public vtkQuadricClustering
+{
+public:
+  static vtkPVQuadricClustering* New();
+  vtkTypeMacro(vtkPVQuadricClustering, vtkQuadricClustering);
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  //@{
+  /**
+   * Enable/disable the multithreaded implementation. When off, or when the
+   * input is not supported by it, vtkQuadricClustering is used. Default is on.
+   */
+  vtkSetMacro(UseMultithreading, bool);
+  vtkGetMacro(UseMultithreading, bool);
+  vtkBooleanMacro(UseMultithreading, bool);
+  //@}
+
+protected:
+  vtkPVQuadricClustering();
+  ~vtkPVQuadricClustering() override;
+
+  int RequestData(vtkInformation*, vtkInformationVector**, vtkInformationVector*) VTK_OVERRIDE;
+
+  /**
+   * Multithreaded decimation. Returns false if the input is not supported, in
+   * which case the output is left untouched.
+   */
+  bool RequestDataMultithreaded(vtkPolyData* input, vtkPolyData* output);
+
+  bool UseMultithreading;
+
+private:
+  vtkPVQuadricClustering(const vtkPVQuadricClustering&) = delete;
+  void operator=(const vtkPVQuadricClustering&) = delete;
+};
+
+#endif
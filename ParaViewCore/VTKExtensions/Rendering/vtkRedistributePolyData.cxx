@@ -29,6 +29,7 @@
 #include "vtkInformationVector.h"
 #include "vtkIntArray.h"
 #include "vtkLongArray.h"
+#include "vtkMPICommunicator.h"
 #include "vtkMath.h"
 #include "vtkMultiProcessController.h"
 #include "vtkObjectFactory.h"
@@ -44,6 +45,10 @@
 #include "vtkUnsignedLongArray.h"
 #include "vtkUnsignedShortArray.h"
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 vtkStandardNewMacro(vtkRedistributePolyData);
 
 vtkCxxSetObjectMacro(vtkRedistributePolyData, Controller, vtkMultiProcessController);
@@ -58,6 +63,218 @@ typedef struct
 } _TimerInfo;
 _TimerInfo timerInfo8;
 
+namespace
+{
+// MPI counts are ints, so larger messages go in chunks with the same tag,
+// which MPI delivers in order.
+const vtkIdType ChunkSize = 1 << 30;
+
+//----------------------------------------------------------------------------
+// Exchanges byte buffers with other processes. With a vtkMPICommunicator all
+// the messages are posted at once in Start() and each receive can be waited on
+// separately, so that it can be unpacked while the others are in flight.
+// Otherwise Start() issues blocking calls, peer by peer in increasing rank
+// order, the lower rank sending first, which cannot deadlock.
+class vtkBufferExchange
+{
+public:
+  vtkBufferExchange(vtkMultiProcessController* controller, int tag)
+    : Controller(controller)
+    , Communicator(vtkMPICommunicator::SafeDownCast(controller->GetCommunicator()))
+    , Tag(tag)
+  {
+  }
+
+  ~vtkBufferExchange() { this->Finish(); }
+
+  void AddSend(int process, char* data, vtkIdType length)
+  {
+    this->Sends.push_back(Message(process, data, length));
+  }
+
+  void AddReceive(int process, char* data, vtkIdType length)
+  {
+    this->Receives.push_back(Message(process, data, length));
+  }
+
+  void Start()
+  {
+    if (!this->Communicator)
+    {
+      this->ExchangeBlocking();
+      return;
+    }
+    for (size_t i = 0; i < this->Receives.size(); ++i)
+    {
+      this->Post(this->Receives[i], false);
+    }
+    for (size_t i = 0; i < this->Sends.size(); ++i)
+    {
+      this->Post(this->Sends[i], true);
+    }
+  }
+
+  // Waits for the index-th receive added with AddReceive().
+  void WaitForReceive(size_t index) { Wait(this->Receives[index]); }
+
+  void Finish()
+  {
+    for (size_t i = 0; i < this->Receives.size(); ++i)
+    {
+      Wait(this->Receives[i]);
+    }
+    for (size_t i = 0; i < this->Sends.size(); ++i)
+    {
+      Wait(this->Sends[i]);
+    }
+  }
+
+private:
+  vtkBufferExchange(const vtkBufferExchange&) = delete;
+  void operator=(const vtkBufferExchange&) = delete;
+
+  struct Message
+  {
+    Message(int process, char* data, vtkIdType length)
+      : Process(process)
+      , Data(data)
+      , Length(length)
+    {
+    }
+    int Process;
+    char* Data;
+    vtkIdType Length;
+    std::vector<vtkMPICommunicator::Request> Requests;
+  };
+
+  void Post(Message& msg, bool send)
+  {
+    msg.Requests.reserve((msg.Length + ChunkSize - 1) / ChunkSize);
+    for (vtkIdType offset = 0; offset < msg.Length; offset += ChunkSize)
+    {
+      const int length = static_cast<int>(std::min(ChunkSize, msg.Length - offset));
+      msg.Requests.push_back(vtkMPICommunicator::Request());
+      if (send)
+      {
+        this->Communicator->NoBlockSend(
+          msg.Data + offset, length, msg.Process, this->Tag, msg.Requests.back());
+      }
+      else
+      {
+        this->Communicator->NoBlockReceive(
+          msg.Data + offset, length, msg.Process, this->Tag, msg.Requests.back());
+      }
+    }
+  }
+
+  static void Wait(Message& msg)
+  {
+    for (size_t i = 0; i < msg.Requests.size(); ++i)
+    {
+      msg.Requests[i].Wait();
+    }
+    msg.Requests.clear();
+  }
+
+  void ExchangeBlocking()
+  {
+    const int myId = this->Controller->GetLocalProcessId();
+    std::vector<int> peers;
+    for (size_t i = 0; i < this->Sends.size(); ++i)
+    {
+      peers.push_back(this->Sends[i].Process);
+    }
+    for (size_t i = 0; i < this->Receives.size(); ++i)
+    {
+      peers.push_back(this->Receives[i].Process);
+    }
+    std::sort(peers.begin(), peers.end());
+    peers.erase(std::unique(peers.begin(), peers.end()), peers.end());
+
+    for (size_t p = 0; p < peers.size(); ++p)
+    {
+      if (peers[p] < myId)
+      {
+        this->ReceiveBlocking(peers[p]);
+        this->SendBlocking(peers[p]);
+      }
+      else
+      {
+        this->SendBlocking(peers[p]);
+        this->ReceiveBlocking(peers[p]);
+      }
+    }
+  }
+
+  void SendBlocking(int process)
+  {
+    for (size_t i = 0; i < this->Sends.size(); ++i)
+    {
+      const Message& msg = this->Sends[i];
+      if (msg.Process == process && msg.Length > 0)
+      {
+        this->Controller->Send(msg.Data, msg.Length, process, this->Tag);
+      }
+    }
+  }
+
+  void ReceiveBlocking(int process)
+  {
+    for (size_t i = 0; i < this->Receives.size(); ++i)
+    {
+      const Message& msg = this->Receives[i];
+      if (msg.Process == process && msg.Length > 0)
+      {
+        this->Controller->Receive(msg.Data, msg.Length, process, this->Tag);
+      }
+    }
+  }
+
+  vtkMultiProcessController* Controller;
+  vtkMPICommunicator* Communicator;
+  int Tag;
+  std::vector<Message> Sends;
+  std::vector<Message> Receives;
+};
+
+//----------------------------------------------------------------------------
+// Size in bytes of a tuple of the array.
+vtkIdType TupleSize(vtkDataArray* array)
+{
+  return static_cast<vtkIdType>(array->GetDataTypeSize()) * array->GetNumberOfComponents();
+}
+
+//----------------------------------------------------------------------------
+// Appends the given tuples of the array to the buffer, returns the new end.
+char* PackTuples(vtkDataArray* array, const vtkIdType* ids, vtkIdType numIds, char* out)
+{
+  const vtkIdType tupleSize = TupleSize(array);
+  const char* from = static_cast<const char*>(array->GetVoidPointer(0));
+  for (vtkIdType i = 0; i < numIds; ++i)
+  {
+    memcpy(out, from + tupleSize * ids[i], tupleSize);
+    out += tupleSize;
+  }
+  return out;
+}
+
+//----------------------------------------------------------------------------
+// Appends the given points to the buffer as floats, returns the new end.
+template <typename T>
+char* PackPoints(const T* from, const vtkIdType* ids, vtkIdType numIds, char* out)
+{
+  for (vtkIdType i = 0; i < numIds; ++i)
+  {
+    const T* pt = from + 3 * ids[i];
+    float fpt[3] = { static_cast<float>(pt[0]), static_cast<float>(pt[1]),
+      static_cast<float>(pt[2]) };
+    memcpy(out, fpt, sizeof(fpt));
+    out += sizeof(fpt);
+  }
+  return out;
+}
+}
+
 vtkRedistributePolyData::vtkRedistributePolyData()
 {
   this->Controller = NULL;
@@ -257,7 +474,7 @@ int vtkRedistributePolyData::RequestData(vtkInformation* vtkNotUsed(request),
 #endif
 
   // sssssssssssssssssssssssssssssssssssssssssssssssssssssssssssssss
-  // ... send cell and point sizes ...
+  // ... pack cells, points and attributes to send to each processor ...
 
   vtkIdType prevStopCell[NUM_CELL_TYPES];
   vtkIdType startCell[NUM_CELL_TYPES];
@@ -282,31 +499,48 @@ int vtkRedistributePolyData::RequestData(vtkInformation* vtkNotUsed(request),
       prevStopCell[type] = inputNumCells[type] - totalNumCellsToSend[type] - 1;
     }
   }
-  vtkIdType* numPointsSend = new vtkIdType[cntSend];
-  vtkIdType** cellArraySize = new vtkIdType*[cntSend];
 
+  std::vector<vtkIdType> sendHeaders(HEADER_SIZE * cntSend);
+  std::vector<vtkSmartPointer<vtkCharArray> > sendBuffers(cntSend);
   for (i = 0; i < cntSend; i++)
   {
-    cellArraySize[i] = new vtkIdType[NUM_CELL_TYPES];
-
     for (type = 0; type < NUM_CELL_TYPES; type++)
     {
-      startCell[type] = prevStopCell[type] + 1;
-      stopCell[type] = startCell[type] + sendNum[type][i] - 1;
-      prevStopCell[type] = stopCell[type];
+      if (sendCellList)
+      {
+        startCell[type] = 0;
+        stopCell[type] = sendNum[type][i] - 1;
+      }
+      else
+      {
+        startCell[type] = prevStopCell[type] + 1;
+        stopCell[type] = startCell[type] + sendNum[type][i] - 1;
+        prevStopCell[type] = stopCell[type];
+      }
     }
-    if (sendCellList)
+    sendBuffers[i] = vtkSmartPointer<vtkCharArray>::New();
+    this->PackCells(startCell, stopCell, input, sendCellList ? sendCellList[i] : NULL,
+      &sendHeaders[HEADER_SIZE * i], sendBuffers[i]);
+  } // end of list of processors to send to
+
+  // ... exchange the headers so that the output can be allocated ...
+
+  std::vector<vtkIdType> recHeaders(HEADER_SIZE * cntRec);
+  {
+    vtkBufferExchange headerExchange(this->Controller, HEADER_TAG);
+    for (i = 0; i < cntSend; i++)
     {
-      this->SendCellSizes(
-        startCell, stopCell, input, sendTo[i], numPointsSend[i], cellArraySize[i], sendCellList[i]);
+      headerExchange.AddSend(sendTo[i], reinterpret_cast<char*>(&sendHeaders[HEADER_SIZE * i]),
+        HEADER_SIZE * sizeof(vtkIdType));
     }
-    else
+    for (i = 0; i < cntRec; i++)
     {
-      this->SendCellSizes(
-        startCell, stopCell, input, sendTo[i], numPointsSend[i], cellArraySize[i], NULL);
+      headerExchange.AddReceive(recFrom[i], reinterpret_cast<char*>(&recHeaders[HEADER_SIZE * i]),
+        HEADER_SIZE * sizeof(vtkIdType));
     }
-
-  } // end of list of processors to send to
+    headerExchange.Start();
+    headerExchange.Finish();
+  }
 
 // ssssssssssssssssssssssssssssssssssssssssssssssssssssssssssssss
 // aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa
@@ -337,23 +571,29 @@ int vtkRedistributePolyData::RequestData(vtkInformation* vtkNotUsed(request),
   }
   timerInfo8.timer->StartTimer();
 #endif
-  vtkIdType* numPointsRec = new vtkIdType[cntRec];
-  vtkIdType** cellptCntr = new vtkIdType*[cntRec];
   for (i = 0; i < cntRec; i++)
   {
-    cellptCntr[i] = new vtkIdType[NUM_CELL_TYPES];
+    for (type = 0; type < NUM_CELL_TYPES; type++)
+    {
+      if (recHeaders[HEADER_SIZE * i + 6 + type] != recNum[type][i])
+      {
+        vtkErrorMacro("Expected " << recNum[type][i] << " cells of type " << type << " from "
+                                  << recFrom[i] << ", got "
+                                  << recHeaders[HEADER_SIZE * i + 6 + type]);
+      }
+    }
   }
+  vtkCellData* outputCellData = output->GetCellData();
+  vtkPointData* outputPointData = output->GetPointData();
 
+  std::vector<vtkIdType> numPointsRec(cntRec);
   for (i = 0; i < cntRec; i++)
   {
-    this->Controller->Receive((vtkIdType*)cellptCntr[i], NUM_CELL_TYPES, recFrom[i], CELL_CNT_TAG);
-    this->Controller->Receive((vtkIdType*)&numPointsRec[i], 1, recFrom[i], POINTS_SIZE_TAG);
+    numPointsRec[i] = recHeaders[HEADER_SIZE * i + 1];
   }
-  vtkCellData* outputCellData = output->GetCellData();
-  vtkPointData* outputPointData = output->GetPointData();
-
   this->AllocateCellDataArrays(outputCellData, recNum, cntRec, origNumCells);
-  this->AllocatePointDataArrays(outputPointData, numPointsRec, cntRec, numPointsOnProc);
+  this->AllocatePointDataArrays(
+    outputPointData, cntRec > 0 ? &numPointsRec[0] : NULL, cntRec, numPointsOnProc);
 
   vtkIdType totalNumPoints = numPointsOnProc;
   vtkIdType totalNumCells[NUM_CELL_TYPES];
@@ -370,7 +610,7 @@ int vtkRedistributePolyData::RequestData(vtkInformation* vtkNotUsed(request),
     for (type = 0; type < NUM_CELL_TYPES; type++)
     {
       totalNumCells[type] += recNum[type][i];
-      totalNumCellPts[type] += cellptCntr[i][type];
+      totalNumCellPts[type] += recHeaders[HEADER_SIZE * i + 2 + type];
     }
   }
 
@@ -426,6 +666,24 @@ int vtkRedistributePolyData::RequestData(vtkInformation* vtkNotUsed(request),
   output->SetStrips(outputStrips.GetPointer());
 
   output->SetPoints(outputPoints.GetPointer());
+
+  // ... post all the receives and sends, then copy the cells staying on
+  //   this processor while the data is in flight ...
+
+  std::vector<vtkSmartPointer<vtkCharArray> > recBuffers(cntRec);
+  vtkBufferExchange exchange(this->Controller, BUFFER_TAG);
+  for (i = 0; i < cntSend; i++)
+  {
+    exchange.AddSend(sendTo[i], sendBuffers[i]->GetPointer(0), sendHeaders[HEADER_SIZE * i]);
+  }
+  for (i = 0; i < cntRec; i++)
+  {
+    recBuffers[i] = vtkSmartPointer<vtkCharArray>::New();
+    recBuffers[i]->SetNumberOfValues(recHeaders[HEADER_SIZE * i]);
+    exchange.AddReceive(recFrom[i], recBuffers[i]->GetPointer(0), recHeaders[HEADER_SIZE * i]);
+  }
+  exchange.Start();
+
   // aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa
   // ... Copy cells from input to output ...
   this->CopyCells(origNumCells, input, output, keepCellList);
@@ -442,125 +700,38 @@ int vtkRedistributePolyData::RequestData(vtkInformation* vtkNotUsed(request),
 
   // eeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeeee
 
-  // ... first exchange cells between processors.  Do this by
-  //  receiving first if this processor number is less than the
-  //  one it is exchanging with else send first ...
-
-  vtkIdType prevStopCellRec[NUM_CELL_TYPES];
-  vtkIdType prevStopCellSend[NUM_CELL_TYPES];
-
-  vtkIdType prevNumPointsRec = numPointsOnProc;
-  vtkIdType prevCellptCntrRec[NUM_CELL_TYPES];
+  // ... unpack the received buffers, in the order of the schedule,
+  //   after the cells kept on this processor ...
 
+  vtkIdType cellOffsets[NUM_CELL_TYPES];
+  vtkIdType cellPtOffsets[NUM_CELL_TYPES];
+  vtkIdType pointOffset = numPointsOnProc;
+  vtkIdType typeOffset = 0;
   for (type = 0; type < NUM_CELL_TYPES; type++)
   {
-    prevStopCellRec[type] = origNumCells[type] - 1;
-    prevStopCellSend[type] = origNumCells[type] - 1;
-    prevCellptCntrRec[type] = numCellPtsOnProc[type];
-
-    if (totalNumCellsToSend[type] + origNumCells[type] > inputNumCells[type])
+    cellOffsets[type] = typeOffset + origNumCells[type];
+    cellPtOffsets[type] = numCellPtsOnProc[type];
+    if (outputCellArrays[type])
     {
-      prevStopCellSend[type] = inputNumCells[type] - totalNumCellsToSend[type] - 1;
+      typeOffset += outputCellArrays[type]->GetNumberOfCells();
     }
   }
 
-  int finished = 0;
-  int procRec, procSend;
-  int rcntr = 0;
-  int scntr = 0;
-  int receiving;
-
-  while (!finished && (cntRec > 0 || cntSend > 0))
+  for (i = 0; i < cntRec; i++)
   {
-    if (rcntr < cntRec)
-    {
-      procRec = recFrom[rcntr];
-    }
-    else
-    {
-      procRec = 99999;
-    }
-    if (scntr < cntSend)
-    {
-      procSend = sendTo[scntr];
-    }
-    else
-    {
-      procSend = 99999;
-    }
-
-    receiving = 0;
-
-    // ... send or receive the smallest processor number next
-    //   (will send if receive == 0) ...
-    if (procRec < procSend)
-    {
-      receiving = 1;
-    }
-    else if (procRec == procSend)
-    {
-      // ... an exchange between 2 prcessors ...
-      if (myId < procRec)
-      {
-        receiving = 1;
-      }
-    }
-
-    if (receiving)
-    {
-      for (type = 0; type < NUM_CELL_TYPES; type++)
-      {
-        startCell[type] = prevStopCellRec[type] + 1;
-        stopCell[type] = startCell[type] + recNum[type][rcntr] - 1;
-      }
+    exchange.WaitForReceive(i);
+    this->UnpackCells(recBuffers[i], &recHeaders[HEADER_SIZE * i], output, recFrom[i],
+      cellOffsets, cellPtOffsets, pointOffset);
+    recBuffers[i] = NULL;
 
-      this->ReceiveCells(startCell, stopCell, output, recFrom[rcntr], prevCellptCntrRec,
-        cellptCntr[rcntr], prevNumPointsRec, numPointsRec[rcntr]);
-
-      prevNumPointsRec += numPointsRec[rcntr];
-      for (type = 0; type < NUM_CELL_TYPES; type++)
-      {
-        prevCellptCntrRec[type] += cellptCntr[rcntr][type];
-        prevStopCellRec[type] = stopCell[type];
-      }
-      rcntr++;
-    }
-    else
-    {
-      // ... sending ...
-      if (sendCellList == NULL)
-      {
-        for (type = 0; type < NUM_CELL_TYPES; type++)
-        {
-          startCell[type] = prevStopCellSend[type] + 1;
-          stopCell[type] = startCell[type] + sendNum[type][scntr] - 1;
-        }
-        this->SendCells(startCell, stopCell, input, output, sendTo[scntr], numPointsSend[scntr],
-          cellArraySize[scntr], NULL);
-      }
-      else
-      {
-        for (type = 0; type < NUM_CELL_TYPES; type++)
-        {
-          startCell[type] = 0;
-          stopCell[type] = sendNum[type][scntr] - 1;
-        }
-        this->SendCells(startCell, stopCell, input, output, sendTo[scntr], numPointsSend[scntr],
-          cellArraySize[scntr], sendCellList[scntr]);
-      }
-
-      for (type = 0; type < NUM_CELL_TYPES; type++)
-      {
-        prevStopCellSend[type] = stopCell[type];
-      }
-      scntr++;
-    }
-
-    if (scntr >= cntSend && rcntr >= cntRec)
+    pointOffset += numPointsRec[i];
+    for (type = 0; type < NUM_CELL_TYPES; type++)
     {
-      finished = 1;
+      cellOffsets[type] += recNum[type][i];
+      cellPtOffsets[type] += recHeaders[HEADER_SIZE * i + 2 + type];
     }
   }
+  exchange.Finish();
 
   input->Delete();
   input = NULL;
@@ -575,9 +746,6 @@ int vtkRedistributePolyData::RequestData(vtkInformation* vtkNotUsed(request),
   }
 #endif
 
-  delete[] numPointsRec;
-  delete[] cellptCntr;
-  delete[] cellArraySize;
   return 1;
 }
 
@@ -786,7 +954,7 @@ void vtkRedistributePolyData::OrderSchedule(vtkCommSched* localSched)
 // Copy the attribute data from one id to another. Make sure CopyAllocate() has// been invoked
 // before using this method.
 void vtkRedistributePolyData::CopyDataArrays(vtkDataSetAttributes* fromPd,
-  vtkDataSetAttributes* toPd, vtkIdType numToCopy, vtkIdType* fromId, int myId)
+  vtkDataSetAttributes* toPd, vtkIdType numToCopy, vtkIdType* fromId, vtkIdType toOffset, int myId)
 {
 
   vtkDataArray* DataFrom;
@@ -799,7 +967,7 @@ void vtkRedistributePolyData::CopyDataArrays(vtkDataSetAttributes* fromPd,
     DataFrom = fromPd->GetArray(i);
     DataTo = toPd->GetArray(i);
 
-    this->CopyArrays(DataFrom, DataTo, numToCopy, fromId, myId);
+    this->CopyArrays(DataFrom, DataTo, numToCopy, fromId, toOffset, myId);
   }
 }
 //*****************************************************************
@@ -831,11 +999,11 @@ namespace
 {
 template <typename T>
 void CopyArraysTemplate(vtkDataArray* DataFrom, vtkDataArray* DataTo, vtkIdType numToCopy,
-  vtkIdType* fromId, int myId, bool fillWithMyId)
+  vtkIdType* fromId, vtkIdType toOffset, int myId, bool fillWithMyId)
 {
-  T* from = (T*)DataFrom->GetVoidPointer(0);
-  T* to = (T*)DataTo->GetVoidPointer(0);
   int numComps = DataFrom->GetNumberOfComponents();
+  T* from = (T*)DataFrom->GetVoidPointer(0);
+  T* to = (T*)DataTo->GetVoidPointer(numComps * toOffset);
   if (fillWithMyId)
   {
     for (vtkIdType i = 0; i < numToCopy; ++i)
@@ -859,8 +1027,8 @@ void CopyArraysTemplate(vtkDataArray* DataFrom, vtkDataArray* DataTo, vtkIdType
 }
 }
 //******************************************************************
-void vtkRedistributePolyData::CopyArrays(
-  vtkDataArray* DataFrom, vtkDataArray* DataTo, vtkIdType numToCopy, vtkIdType* fromId, int myId)
+void vtkRedistributePolyData::CopyArrays(vtkDataArray* DataFrom, vtkDataArray* DataTo,
+  vtkIdType numToCopy, vtkIdType* fromId, vtkIdType toOffset, int myId)
 //******************************************************************
 {
   int dataType = DataFrom->GetDataType();
@@ -871,8 +1039,8 @@ void vtkRedistributePolyData::CopyArrays(
   {
 
     // Only change is that vtk unsigned short is now allowed...
-    vtkTemplateMacro(
-      CopyArraysTemplate<VTK_TT>(DataFrom, DataTo, numToCopy, fromId, myId, fillWithMyId));
+    vtkTemplateMacro(CopyArraysTemplate<VTK_TT>(
+      DataFrom, DataTo, numToCopy, fromId, toOffset, myId, fillWithMyId));
     case VTK_BIT:
       vtkErrorMacro("VTK_BIT not allowed for copy");
       break;
@@ -887,11 +1055,12 @@ template <typename T>
 void CopyBlockArraysTemplate(vtkDataArray* DataFrom, vtkDataArray* DataTo, vtkIdType numToCopy,
   vtkIdType startCell, vtkIdType fromOffset, vtkIdType toOffset, int myId, bool fillToWithMyId)
 {
-  T* from = (T*)DataFrom->GetVoidPointer(fromOffset);
-  T* to = (T*)DataTo->GetVoidPointer(toOffset);
-
   int numComps = DataFrom->GetNumberOfComponents();
 
+  // ... offsets are in tuples ...
+  T* from = (T*)DataFrom->GetVoidPointer(numComps * fromOffset);
+  T* to = (T*)DataTo->GetVoidPointer(numComps * toOffset);
+
   vtkIdType start = numComps * startCell;
   vtkIdType size = numToCopy * numComps;
   vtkIdType stop = start + size;
@@ -965,6 +1134,14 @@ void vtkRedistributePolyData::CopyCells(
   vtkCellData* inputCellData = input->GetCellData();
   vtkCellData* outputCellData = output->GetCellData();
 
+  // ... the cells of each type start after all the output cells of the
+  //   previous types, like in UnpackCells() ...
+  vtkCellArray* outputCellArrays[NUM_CELL_TYPES];
+  outputCellArrays[0] = output->GetVerts();
+  outputCellArrays[1] = output->GetLines();
+  outputCellArrays[2] = output->GetPolys();
+  outputCellArrays[3] = output->GetStrips();
+
   // ...Since fromId's is used to point to cell data where
   //  data from all of the different types of cells is
   //  combined, use an offset because cellId points
@@ -990,12 +1167,16 @@ void vtkRedistributePolyData::CopyCells(
     }
     else
     {
-      this->CopyDataArrays(inputCellData, outputCellData, numCells[type], fromIds, myId);
+      this->CopyDataArrays(
+        inputCellData, outputCellData, numCells[type], fromIds, cellOffsetOut, myId);
     }
     if (cellArrays[type])
     {
       cellOffset += cellArrays[type]->GetNumberOfCells();
-      cellOffsetOut += numCells[type];
+    }
+    if (outputCellArrays[type])
+    {
+      cellOffsetOut += outputCellArrays[type]->GetNumberOfCells();
     }
     delete[] fromIds;
   }
@@ -1055,12 +1236,6 @@ void vtkRedistributePolyData::CopyCells(
   inputCellArrays[2] = input->GetPolys();
   inputCellArrays[3] = input->GetStrips();
 
-  vtkCellArray* outputCellArrays[NUM_CELL_TYPES];
-  outputCellArrays[0] = output->GetVerts();
-  outputCellArrays[1] = output->GetLines();
-  outputCellArrays[2] = output->GetPolys();
-  outputCellArrays[3] = output->GetStrips();
-
   vtkIdType pointIncr = 0;
   vtkIdType pointId;
   vtkIdType npts;
@@ -1180,7 +1355,7 @@ void vtkRedistributePolyData::CopyCells(
   vtkPointData* outputPointData = output->GetPointData();
 
   // ... copy point data arrays ...
-  this->CopyDataArrays(inputPointData, outputPointData, numPoints, fromPtIds, myId);
+  this->CopyDataArrays(inputPointData, outputPointData, numPoints, fromPtIds, 0, myId);
   delete[] fromPtIds;
 
 #if VTK_REDIST_DO_TIMING
@@ -1195,383 +1370,161 @@ void vtkRedistributePolyData::CopyCells(
 }
 
 //*****************************************************************
-void vtkRedistributePolyData::SendCellSizes(vtkIdType* startCell, vtkIdType* stopCell,
-  vtkPolyData* input, int sendTo, vtkIdType& numPoints, vtkIdType* ptcntr, vtkIdType** sendCellList)
-
-//*****************************************************************
+// Pack the cells startCell..stopCell of each type (or the cells listed in
+// sendCellList), with their points and attributes, into one buffer. The
+// buffer holds the connectivity of each type with the point ids renumbered
+// from 0, the points as floats, the cell data arrays and then the point data
+// arrays. The sizes needed by the receiver are stored in header.
+void vtkRedistributePolyData::PackCells(vtkIdType* startCell, vtkIdType* stopCell,
+  vtkPolyData* input, vtkIdType** sendCellList, vtkIdType* header, vtkCharArray* buffer)
 {
-  // ... send cells and point sizes without sending data ...
-
-  vtkIdType cellId, i;
-  vtkIdType numCells;
-
-  // int myId = this->Controller->GetLocalProcessId();
-
-  // ... Allocate maximum possible number of points (use total from
-  //     all of input) ...
-
-  vtkIdType numPointsMax = input->GetNumberOfPoints();
-  vtkIdType* usedIds = new vtkIdType[numPointsMax];
-  for (i = 0; i < numPointsMax; i++)
-  {
-    usedIds[i] = -1;
-  }
-
-  // ... send point Id's for all the points in the cell. ...
-
-  vtkIdType pointIncr = 0;
-  vtkIdType pointId;
-  vtkIdType npts;
-  vtkIdType* inPtr;
-
   vtkCellArray* cellArrays[NUM_CELL_TYPES];
   cellArrays[0] = input->GetVerts();
   cellArrays[1] = input->GetLines();
   cellArrays[2] = input->GetPolys();
   cellArrays[3] = input->GetStrips();
 
+  // ... renumber the points used by the packed cells and remember which
+  //   input cells and points they came from ...
+  std::vector<vtkIdType> usedIds(input->GetNumberOfPoints(), -1);
+  std::vector<vtkIdType> fromPtIds;
+  std::vector<vtkIdType> fromCellIds;
+  std::vector<vtkIdType> connectivity[NUM_CELL_TYPES];
+
+  vtkIdType cellOffset = 0;
   int type;
   for (type = 0; type < NUM_CELL_TYPES; type++)
   {
-    if (cellArrays[type])
+    header[2 + type] = 0;
+    header[6 + type] = 0;
+    if (!cellArrays[type])
     {
-      inPtr = cellArrays[type]->GetPointer();
-      ptcntr[type] = 0; // counts the number of points stored in the
-      // cell array plus includes the extra space
-      // for each cell that contains the number of
-      // points in that cell.
-
-      if (sendCellList == NULL)
+      continue;
+    }
+    vtkIdType* inPtr = cellArrays[type]->GetPointer();
+    vtkIdType prevCellId = 0;
+    for (vtkIdType id = startCell[type]; id <= stopCell[type]; id++)
+    {
+      vtkIdType cellId = sendCellList ? sendCellList[type][id] : id;
+      for (; prevCellId < cellId; prevCellId++)
       {
-        // ... send cells in a block ...
-        for (cellId = 0; cellId < startCell[type]; cellId++)
-        {
-          // ... increment pointers to get to correct starting
-          //  point ...
-          npts = *inPtr++;
-          inPtr += npts;
-        }
+        inPtr += *inPtr + 1;
+      }
+      prevCellId = cellId + 1;
 
-        for (cellId = startCell[type]; cellId <= stopCell[type]; cellId++)
+      vtkIdType npts = *inPtr++;
+      connectivity[type].push_back(npts);
+      for (vtkIdType i = 0; i < npts; i++)
+      {
+        vtkIdType pointId = *inPtr++;
+        if (usedIds[pointId] == -1)
         {
-          // ... set output number of points to input number of
-          //   points ...
-          npts = *inPtr++;
-          ptcntr[type]++;
-          for (i = 0; i < npts; i++)
-          {
-            pointId = *inPtr++;
-            if (usedIds[pointId] == -1)
-            {
-              usedIds[pointId] = pointIncr++;
-            }
-            ptcntr[type]++;
-          }
+          usedIds[pointId] = static_cast<vtkIdType>(fromPtIds.size());
+          fromPtIds.push_back(pointId);
         }
+        connectivity[type].push_back(usedIds[pointId]);
       }
-      else
-      {
-        // ... there is a specific list of cells to send ...
-
-        vtkIdType prevCellId = 0;
-        numCells = stopCell[type] - startCell[type] + 1;
-
-        for (vtkIdType id = 0; id < numCells; id++)
-        {
-
-          cellId = sendCellList[type][id];
-          for (i = prevCellId; i < cellId; i++)
-          {
-            // ... increment pointers to get to correct starting
-            // point ...
-            npts = *inPtr++;
-            inPtr += npts;
-          }
-          prevCellId = cellId + 1;
-
-          // ... set output number of points to input number of
-          //   points ...
+      fromCellIds.push_back(cellOffset + cellId);
+      header[6 + type]++;
+    }
+    header[2 + type] = static_cast<vtkIdType>(connectivity[type].size());
+    cellOffset += cellArrays[type]->GetNumberOfCells();
+  }
 
-          npts = *inPtr++;
-          ptcntr[type]++;
+  const vtkIdType numPoints = static_cast<vtkIdType>(fromPtIds.size());
+  const vtkIdType numCells = static_cast<vtkIdType>(fromCellIds.size());
+  header[1] = numPoints;
 
-          for (i = 0; i < npts; i++)
-          {
-            pointId = *inPtr++;
-            if (usedIds[pointId] == -1)
-            {
-              usedIds[pointId] = pointIncr++;
-            }
-            ptcntr[type]++;
-          }
-        } // end loop over cells
-      }   // end if sendCellList
-    }     // end if cellArrays
-  }       // end loop over type
-
-  // ... send sizes first (must be in this order to allocate for
-  //   receive)...
-
-  this->Controller->Send((vtkIdType*)ptcntr, NUM_CELL_TYPES, sendTo, CELL_CNT_TAG);
-
-  numPoints = pointIncr;
-  this->Controller->Send((vtkIdType*)&numPoints, 1, sendTo, POINTS_SIZE_TAG);
-}
-//*****************************************************************
-void vtkRedistributePolyData::SendCells(vtkIdType* startCell, vtkIdType* stopCell,
-  vtkPolyData* input, vtkPolyData* output, int sendTo, vtkIdType& numPoints,
-  vtkIdType* cellArraySize, vtkIdType** sendCellList)
-
-//*****************************************************************
-{
-  // ... send cells, points and associated data from cells in
-  //     specified region ...
-
-  vtkIdType cellId, i;
-
-  // int myId = this->Controller->GetLocalProcessId();
-
-  // ... Allocate maximum possible number of points (use total from
-  //     all of input) ...
-
-  vtkIdType numPointsMax = input->GetNumberOfPoints();
-  vtkIdType* fromPtIds = new vtkIdType[numPointsMax];
-
-  vtkIdType* usedIds = new vtkIdType[numPointsMax];
-  for (i = 0; i < numPointsMax; i++)
+  // ... compute the size of the buffer ...
+  vtkCellData* inputCellData = input->GetCellData();
+  vtkPointData* inputPointData = input->GetPointData();
+  vtkIdType size = 3 * sizeof(float) * numPoints;
+  for (type = 0; type < NUM_CELL_TYPES; type++)
   {
-    usedIds[i] = -1;
+    size += header[2 + type] * sizeof(vtkIdType);
   }
-
-  // ... send point Id's for all the points in the cell. ...
-
-  vtkCellArray* inputCellArrays[NUM_CELL_TYPES];
-  inputCellArrays[0] = input->GetVerts();
-  inputCellArrays[1] = input->GetLines();
-  inputCellArrays[2] = input->GetPolys();
-  inputCellArrays[3] = input->GetStrips();
-
-  vtkIdType* ptr;
-  vtkIdType ptcntr[NUM_CELL_TYPES];
-  vtkIdType* ptrsav[NUM_CELL_TYPES];
-
-  vtkIdType pointIncr = 0;
-  vtkIdType pointId;
-  vtkIdType* inPtr;
-  vtkIdType npts;
-
-  int type;
-
-  vtkIdType numCells[NUM_CELL_TYPES];
-  for (type = 0; type < NUM_CELL_TYPES; type++)
+  int i;
+  for (i = 0; i < inputCellData->GetNumberOfArrays(); i++)
   {
-    inPtr = inputCellArrays[type]->GetPointer();
-    ptr = new vtkIdType[cellArraySize[type]];
-    ptrsav[type] = ptr;
-    ptcntr[type] = 0;
-    numCells[type] = stopCell[type] - startCell[type] + 1;
-
-    // ... set output number of points to input number of points ...
-    if (sendCellList == NULL)
+    vtkDataArray* array = inputCellData->GetArray(i);
+    if (array->GetDataType() == VTK_BIT)
     {
-      // ... send cells in a block ...
-      for (cellId = 0; cellId < startCell[type]; cellId++)
-      {
-        // ... increment pointers to get to correct starting point ...
-        npts = *inPtr++;
-        inPtr += npts;
-      }
-
-      for (cellId = startCell[type]; cellId <= stopCell[type]; cellId++)
-      {
-        npts = *inPtr++;
-        *ptr++ = npts;
-        ptcntr[type]++;
-        for (i = 0; i < npts; i++)
-        {
-          pointId = *inPtr++;
-          if (usedIds[pointId] == -1)
-          {
-            vtkIdType newPt = pointIncr;
-            *ptr++ = newPt;
-            ptcntr[type]++;
-            usedIds[pointId] = newPt;
-            fromPtIds[pointIncr] = pointId;
-            pointIncr++;
-          }
-          else
-          {
-            // ... use new point id ...
-            *ptr++ = usedIds[pointId];
-            ptcntr[type]++;
-          }
-        } // end loop over npts
-      }   // end loop over cellId
+      vtkErrorMacro("VTK_BIT not allowed for copy");
+      continue;
     }
-    else
+    size += TupleSize(array) * numCells;
+  }
+  for (i = 0; i < inputPointData->GetNumberOfArrays(); i++)
+  {
+    vtkDataArray* array = inputPointData->GetArray(i);
+    if (array->GetDataType() == VTK_BIT)
     {
-      // ... there is a specific list of cells to send ...
-
-      vtkIdType prevCellId = 0;
-
-      for (vtkIdType id = 0; id < numCells[type]; id++)
-      {
-
-        cellId = sendCellList[type][id];
-        for (i = prevCellId; i < cellId; i++)
-        {
-          // ... increment pointers to get to correct starting
-          //   point ...
-          npts = *inPtr++;
-          inPtr += npts;
-        }
-        prevCellId = cellId + 1;
-
-        npts = *inPtr++;
-        *ptr++ = npts;
-        ptcntr[type]++;
-
-        for (i = 0; i < npts; i++)
-        {
-          pointId = *inPtr++;
-          if (usedIds[pointId] == -1)
-          {
-            vtkIdType newPt = pointIncr;
-            *ptr++ = newPt;
-            ptcntr[type]++;
-            usedIds[pointId] = newPt;
-            fromPtIds[pointIncr] = pointId;
-            pointIncr++;
-          }
-          else
-          {
-            // ... use new point id ...
-            *ptr++ = usedIds[pointId];
-            ptcntr[type]++;
-          }
-        } // end loop over npts
-      }   // end loop over numCells
-    }     // end else where sendCellList isn't null
-  }       // end of type loop
+      vtkErrorMacro("VTK_BIT not allowed for copy");
+      continue;
+    }
+    size += TupleSize(array) * numPoints;
+  }
+  header[0] = size;
 
-  if (numPoints != pointIncr)
+  buffer->SetNumberOfValues(size);
+  if (size == 0)
   {
-    vtkErrorMacro("numPoints=" << numPoints << ", pointIncr=" << pointIncr << ", should be equal");
+    return;
   }
-
-  delete[] usedIds;
-
-  // ... send cell data attribute data (Scalars, Vectors, etc.)...
-
-  vtkCellData* inputCellData = input->GetCellData();
-  vtkCellData* outputCellData = output->GetCellData();
-
-  vtkIdType cellOffset = 0;
-  vtkIdType inputNumCells;
+  char* out = buffer->GetPointer(0);
 
   for (type = 0; type < NUM_CELL_TYPES; type++)
   {
-    vtkIdType cnt = 0;
-    vtkIdType* fromIds = new vtkIdType[numCells[type]];
-    if (sendCellList != NULL)
-    {
-      for (cellId = startCell[type]; cellId <= stopCell[type]; cellId++)
-      {
-        fromIds[cnt] = sendCellList[cnt][type] + cellOffset;
-        cnt++;
-      }
-    }
-
-    // ... output needed for flags only (assumes flags are the same
-    //   on all processors) ...
-
-    int typetag = type; //(typetag = type for cells, =5 for points)
-    if (sendCellList == NULL)
-    {
-      this->SendCellBlockDataArrays(inputCellData, outputCellData, numCells[type], sendTo,
-        startCell[type] + cellOffset, typetag);
-    }
-    else
+    if (header[2 + type] > 0)
     {
-      this->SendDataArrays(inputCellData, outputCellData, numCells[type], sendTo, fromIds, typetag);
+      const size_t bytes = header[2 + type] * sizeof(vtkIdType);
+      memcpy(out, &connectivity[type][0], bytes);
+      out += bytes;
     }
+  }
 
-    inputNumCells = 0;
-    if (inputCellArrays[type])
+  if (numPoints > 0)
+  {
+    vtkPoints* points = input->GetPoints();
+    void* pointsData = points->GetVoidPointer(0);
+    switch (points->GetDataType())
     {
-      inputNumCells = inputCellArrays[type]->GetNumberOfCells();
+      vtkTemplateMacro(
+        out = PackPoints(static_cast<VTK_TT*>(pointsData), &fromPtIds[0], numPoints, out));
     }
-    cellOffset += inputNumCells;
-
-    delete[] fromIds; // this array was allocated above in
-    // this case
   }
 
-  // ... Send points Id's in cells now ...
-
-  for (type = 0; type < NUM_CELL_TYPES; type++)
+  for (i = 0; i < inputCellData->GetNumberOfArrays(); i++)
   {
-    if (ptcntr[type] > 0)
+    vtkDataArray* array = inputCellData->GetArray(i);
+    if (array->GetDataType() != VTK_BIT && numCells > 0)
     {
-      this->Controller->Send(ptrsav[type], ptcntr[type], sendTo, CELL_TAG + type);
+      out = PackTuples(array, &fromCellIds[0], numCells, out);
     }
   }
-
-  // ... Copy cell points. ...
-
-  vtkPoints* inputPoints = input->GetPoints();
-  vtkDataArray* inputPointsArray = inputPoints->GetData();
-  void* inputPointsArrayData = inputPointsArray->GetVoidPointer(0);
-
-  float* outputPointsArrayData = new float[3 * numPoints];
-
-  // ... send x,y, z coordinates of points
-
-  int j;
-  vtkIdType inLoc, outLoc;
-  switch (inputPointsArray->GetDataType())
+  for (i = 0; i < inputPointData->GetNumberOfArrays(); i++)
   {
-    vtkTemplateMacro(for (i = 0; i < numPoints; i++) {
-      inLoc = fromPtIds[i] * 3;
-      outLoc = i * 3;
-      for (j = 0; j < 3; j++)
-      {
-        outputPointsArrayData[outLoc + j] =
-          static_cast<float>(reinterpret_cast<VTK_TT*>(inputPointsArrayData)[inLoc + j]);
-      }
-    });
+    vtkDataArray* array = inputPointData->GetArray(i);
+    if (array->GetDataType() != VTK_BIT && numPoints > 0)
+    {
+      out = PackTuples(array, &fromPtIds[0], numPoints, out);
+    }
   }
-
-  // ... Send points now ...
-
-  this->Controller->Send(outputPointsArrayData, 3 * numPoints, sendTo, POINTS_TAG);
-
-  // ... use output for flags only to avoid unnecessary sends ...
-  vtkPointData* inputPointData = input->GetPointData();
-  vtkPointData* outputPointData = output->GetPointData();
-
-  int typetag = 5; //(typetag = 0 for cells + type, =5 for points)
-
-  this->SendDataArrays(inputPointData, outputPointData, numPoints, sendTo, fromPtIds, typetag);
-  delete[] fromPtIds;
 }
-//****************************************************************
-void vtkRedistributePolyData::ReceiveCells(vtkIdType* startCell, vtkIdType* stopCell,
-  vtkPolyData* output, int recFrom, vtkIdType* prevCellptCntr, vtkIdType* cellptCntr,
-  vtkIdType prevNumPoints, vtkIdType numPoints)
 
 //*****************************************************************
+// Unpack a buffer filled by PackCells() on process recFrom. The cells of
+// each type go at cellOffsets (cell data) and cellPtOffsets (connectivity),
+// the points and point data at pointOffset.
+void vtkRedistributePolyData::UnpackCells(vtkCharArray* buffer, const vtkIdType* header,
+  vtkPolyData* output, int recFrom, const vtkIdType* cellOffsets, const vtkIdType* cellPtOffsets,
+  vtkIdType pointOffset)
 {
-  // ... send cells, points and associated data from cells in
-  //     specified region ...
-
-  vtkIdType cellId, i;
-
-  // ... receive cell data attribute data (Scalars, Vectors, etc.)...
-
-  vtkIdType cellOffset = 0;
-
-  vtkCellData* outputCellData = output->GetCellData();
+  if (header[0] == 0)
+  {
+    return;
+  }
+  const char* in = buffer->GetPointer(0);
 
   vtkCellArray* outputCellArrays[NUM_CELL_TYPES];
   outputCellArrays[0] = output->GetVerts();
@@ -1579,79 +1532,97 @@ void vtkRedistributePolyData::ReceiveCells(vtkIdType* startCell, vtkIdType* stop
   outputCellArrays[2] = output->GetPolys();
   outputCellArrays[3] = output->GetStrips();
 
+  // ... copy the connectivity, shifting the point ids past the points
+  //   already in the output ...
   int type;
   for (type = 0; type < NUM_CELL_TYPES; type++)
   {
-    vtkIdType cnt = 0;
-    vtkIdType numCells = stopCell[type] - startCell[type] + 1;
-    vtkIdType* toIds = new vtkIdType[numCells];
-    for (cellId = startCell[type]; cellId <= stopCell[type]; cellId++)
+    const vtkIdType size = header[2 + type];
+    if (size == 0)
     {
-      toIds[cnt++] = cellId + cellOffset;
+      continue;
     }
-
-    int typetag = type; //(typetag = type for cells, =5 for points)
-    this->ReceiveDataArrays(outputCellData, numCells, recFrom, toIds, typetag);
-    delete[] toIds;
-
-    vtkIdType outputNumCells = 0;
-    if (outputCellArrays[type])
+    if (!outputCellArrays[type])
     {
-      outputNumCells = outputCellArrays[type]->GetNumberOfCells();
+      vtkErrorMacro("Received cells of type " << type << " without output cell array.");
+      return;
     }
-    cellOffset += outputNumCells;
-  }
-
-  // ... receive point Id's for all the points in the cell. ...
-
-  vtkIdType* outPtr;
-  for (type = 0; type < NUM_CELL_TYPES; type++)
-  {
-    if (outputCellArrays[type])
+    vtkIdType* ptr = outputCellArrays[type]->GetPointer() + cellPtOffsets[type];
+    memcpy(ptr, in, size * sizeof(vtkIdType));
+    in += size * sizeof(vtkIdType);
+    for (vtkIdType* end = ptr + size; ptr < end;)
     {
-      outPtr = outputCellArrays[type]->GetPointer();
-      outPtr += prevCellptCntr[type];
-
-      if (cellptCntr[type] && outPtr)
+      vtkIdType npts = *ptr++;
+      for (vtkIdType i = 0; i < npts; i++)
       {
-        this->Controller->Receive((vtkIdType*)outPtr, cellptCntr[type], recFrom, CELL_TAG + type);
+        *ptr++ += pointOffset;
       }
+    }
+  }
 
-      // ... Fix pointId's (need to have offset added to represent
-      //   correct location ...
+  // ... copy x,y,z coordinates ...
+  const vtkIdType numPoints = header[1];
+  if (numPoints > 0)
+  {
+    vtkFloatArray* points = vtkFloatArray::SafeDownCast(output->GetPoints()->GetData());
+    memcpy(points->GetPointer(3 * pointOffset), in, 3 * sizeof(float) * numPoints);
+    in += 3 * sizeof(float) * numPoints;
+  }
 
-      for (cellId = startCell[type]; cellId <= stopCell[type]; cellId++)
+  // ... copy the cell data, one block per cell type ...
+  int myId = this->Controller->GetLocalProcessId();
+  vtkCellData* outputCellData = output->GetCellData();
+  int i;
+  for (i = 0; i < outputCellData->GetNumberOfArrays(); i++)
+  {
+    vtkDataArray* array = outputCellData->GetArray(i);
+    if (array->GetDataType() == VTK_BIT)
+    {
+      continue;
+    }
+    const vtkIdType tupleSize = TupleSize(array);
+    char* to = static_cast<char*>(array->GetVoidPointer(0));
+    for (type = 0; type < NUM_CELL_TYPES; type++)
+    {
+      const vtkIdType numCells = header[6 + type];
+      memcpy(to + tupleSize * cellOffsets[type], in, tupleSize * numCells);
+      in += tupleSize * numCells;
+      if (array->GetDataType() == VTK_DOUBLE && this->ColorProc)
       {
-        vtkIdType npts = *outPtr++;
-        for (i = 0; i < npts; i++)
-        {
-          *outPtr += prevNumPoints;
-          outPtr++;
-        }
+        double* values = static_cast<double*>(array->GetVoidPointer(0));
+        const int numComps = array->GetNumberOfComponents();
+        std::fill(values + numComps * cellOffsets[type],
+          values + numComps * (cellOffsets[type] + numCells), static_cast<double>(myId));
       }
-    } // end if outputCellArrays[type]
-  }   // end loop over type
-
-  // ... Receive points now ...
-
-  vtkPoints* outputPoints = output->GetPoints();
-  vtkFloatArray* outputPointsArray = vtkFloatArray::SafeDownCast(outputPoints->GetData());
-  float* outputPointsArrayData = outputPointsArray->GetPointer(0);
-
-  this->Controller->Receive(
-    &outputPointsArrayData[prevNumPoints * 3], 3 * numPoints, recFrom, POINTS_TAG);
+    }
+  }
 
-  // ... receive point attribute data ...
-  vtkIdType* toPtIds = new vtkIdType[numPoints];
-  for (i = 0; i < numPoints; i++)
+  // ... copy the point data ...
+  vtkPointData* outputPointData = output->GetPointData();
+  for (i = 0; i < outputPointData->GetNumberOfArrays(); i++)
   {
-    toPtIds[i] = prevNumPoints + i;
+    vtkDataArray* array = outputPointData->GetArray(i);
+    if (array->GetDataType() == VTK_BIT)
+    {
+      continue;
+    }
+    const vtkIdType tupleSize = TupleSize(array);
+    char* to = static_cast<char*>(array->GetVoidPointer(0));
+    memcpy(to + tupleSize * pointOffset, in, tupleSize * numPoints);
+    in += tupleSize * numPoints;
+    if (array->GetDataType() == VTK_DOUBLE && this->ColorProc)
+    {
+      double* values = static_cast<double*>(array->GetVoidPointer(0));
+      const int numComps = array->GetNumberOfComponents();
+      std::fill(values + numComps * pointOffset, values + numComps * (pointOffset + numPoints),
+        static_cast<double>(myId));
+    }
   }
 
-  vtkPointData* outputPointData = output->GetPointData();
-  int typetag = 5; //(typetag = type for cells, =5 for points)
-  this->ReceiveDataArrays(outputPointData, numPoints, recFrom, toPtIds, typetag);
-  delete[] toPtIds;
+  if (in != buffer->GetPointer(0) + header[0])
+  {
+    vtkErrorMacro("Buffer received from " << recFrom << " does not match its header.");
+  }
 }
 //*******************************************************************
 // Allocate space for the attribute data expected from all id's.
@@ -1783,208 +1754,6 @@ void vtkRedistributePolyData::FindMemReq(
   delete[] usedIds;
 }
 
-//*****************************************************************
-//*****************************************************************
-// Copy the attribute data from one id to another. Make sure CopyAllocate() has// been invoked
-// before using this method.
-void vtkRedistributePolyData::SendDataArrays(vtkDataSetAttributes* fromPd,
-  vtkDataSetAttributes* vtkNotUsed(toPd), vtkIdType numToCopy, int sendTo, vtkIdType* fromId,
-  int typetag)
-{
-
-  vtkDataArray* Data;
-  int numArrays = fromPd->GetNumberOfArrays();
-
-  // Note: sendTag is just mpi tag to keep sends separate
-  int sendTag;
-
-  for (int i = 0; i < numArrays; i++)
-  {
-    Data = fromPd->GetArray(i);
-
-    sendTag = 200 + 10 * i + typetag; // these tags should be unique
-    SendArrays(Data, numToCopy, sendTo, fromId, sendTag);
-  }
-}
-//*****************************************************************
-// Copy the attribute data from one id to another. Make sure
-// CopyAllocate() has// been invoked before using this method.
-
-void vtkRedistributePolyData::SendCellBlockDataArrays(vtkDataSetAttributes* fromPd,
-  vtkDataSetAttributes* vtkNotUsed(toPd), vtkIdType numToCopy, int sendTo, vtkIdType startCell,
-  int typetag)
-//*******************************************************************
-{
-
-  vtkDataArray* Data;
-  int numArrays = fromPd->GetNumberOfArrays();
-
-  for (int i = 0; i < numArrays; i++)
-  {
-    Data = fromPd->GetArray(i);
-
-    int sendTag = 200 + 10 * i + typetag; // these tags should be
-    // unique
-    this->SendBlockArrays(Data, numToCopy, sendTo, startCell, sendTag);
-  }
-}
-//------------------------------------------------------------------
-namespace
-{
-template <typename T>
-void SendArraysTemplate(vtkDataArray* Data, vtkIdType numToCopy, int sendTo, vtkIdType* fromId,
-  int sendTag, vtkMultiProcessController* controller)
-{
-  T* array = (T*)Data->GetVoidPointer(0);
-  int numComps = Data->GetNumberOfComponents();
-  T* buf = new T[numToCopy * numComps];
-  vtkIdType size = numToCopy * numComps;
-  for (vtkIdType i = 0; i < numToCopy; ++i)
-  {
-    for (int j = 0; j < numComps; ++j)
-    {
-      buf[numComps * i + j] = array[numComps * fromId[i] + j];
-    }
-  }
-  controller->Send(buf, size, sendTo, sendTag);
-  delete[] buf;
-}
-}
-//******************************************************************
-void vtkRedistributePolyData::SendArrays(
-  vtkDataArray* Data, vtkIdType numToCopy, int sendTo, vtkIdType* fromId, int sendTag)
-//******************************************************************
-{
-  int dataType = Data->GetDataType();
-
-  switch (dataType)
-  {
-    vtkTemplateMacro(
-      SendArraysTemplate<VTK_TT>(Data, numToCopy, sendTo, fromId, sendTag, this->Controller));
-    case VTK_BIT:
-      vtkErrorMacro("VTK_BIT not allowed for send");
-      break;
-    default:
-      vtkErrorMacro("datatype = " << dataType << " not allowed for send");
-  }
-}
-//-----------------------------------------------------------------
-namespace
-{
-template <typename T>
-void SendBlockArraysTemplate(vtkDataArray* Data, vtkIdType numToCopy, int sendTo,
-  vtkIdType startCell, int sendTag, vtkMultiProcessController* controller)
-{
-  int numComps = Data->GetNumberOfComponents();
-
-  vtkIdType start = numComps * startCell;
-  vtkIdType size = numToCopy * numComps;
-
-  T* array = (T*)Data->GetVoidPointer(0);
-  controller->Send((T*)&array[start], size, sendTo, sendTag);
-}
-}
-//******************************************************************
-void vtkRedistributePolyData::SendBlockArrays(
-  vtkDataArray* Data, vtkIdType numToCopy, int sendTo, vtkIdType startCell, int sendTag)
-//******************************************************************
-{
-  int dataType = Data->GetDataType();
-
-  // again adds support for unsigned short...
-  switch (dataType)
-  {
-    vtkTemplateMacro(SendBlockArraysTemplate<VTK_TT>(
-      Data, numToCopy, sendTo, startCell, sendTag, this->Controller));
-    case VTK_BIT:
-      vtkErrorMacro("VTK_BIT not allowed for send");
-      break;
-    default:
-      vtkErrorMacro("datatype = " << dataType << " not allowed for send");
-  }
-}
-//*****************************************************************
-// ... Receive the attribute data from recFrom.  Call
-//   AllocateDataArrays before calling this ...
-
-void vtkRedistributePolyData::ReceiveDataArrays(
-  vtkDataSetAttributes* toPd, vtkIdType numToCopy, int recFrom, vtkIdType* toId, int typetag)
-{
-
-  // ... this assumes that memory has been allocated already, this is
-  //     helpful to avoid repeatedly resizing ...
-
-  vtkDataArray* Data;
-  int numArrays = toPd->GetNumberOfArrays();
-
-  // Note: recTag is just mpi tag to keep receives separate
-  int recTag;
-
-  for (int i = 0; i < numArrays; i++)
-  {
-    Data = toPd->GetArray(i);
-
-    recTag = 200 + 10 * i + typetag; // these tags should be unique
-    this->ReceiveArrays(Data, numToCopy, recFrom, toId, recTag);
-  }
-}
-//-------------------------------------------------------------------
-namespace
-{
-template <typename T>
-void ReceiveArraysTemplate(vtkDataArray* Data, vtkIdType numToCopy, int recFrom, vtkIdType* toId,
-  int recTag, vtkMultiProcessController* controller, bool setDataToRecFrom)
-{
-  int numComps = Data->GetNumberOfComponents();
-
-  T* array = (T*)Data->GetVoidPointer(0);
-  T* buf = new T[numToCopy * numComps];
-
-  controller->Receive(buf, numToCopy * numComps, recFrom, recTag);
-  if (setDataToRecFrom)
-  {
-    for (vtkIdType i = 0; i < numToCopy; ++i)
-    {
-      for (int j = 0; j < numComps; ++j)
-      {
-        array[toId[i] * numComps + j] = recFrom;
-      }
-    }
-  }
-  else
-  {
-    for (vtkIdType i = 0; i < numToCopy; ++i)
-    {
-      for (int j = 0; j < numComps; ++j)
-      {
-        array[toId[i] * numComps + j] = buf[numComps * i + j];
-      }
-    }
-  }
-  delete[] buf;
-}
-}
-//*******************************************************************
-void vtkRedistributePolyData::ReceiveArrays(
-  vtkDataArray* Data, vtkIdType numToCopy, int recFrom, vtkIdType* toId, int recTag)
-//*******************************************************************
-{
-  int dataType = Data->GetDataType();
-
-  bool setDataToRecFrom = (dataType == VTK_DOUBLE) && this->ColorProc;
-
-  switch (dataType)
-  {
-    vtkTemplateMacro(ReceiveArraysTemplate<VTK_TT>(
-      Data, numToCopy, recFrom, toId, recTag, this->Controller, setDataToRecFrom));
-    case VTK_BIT:
-      vtkErrorMacro("VTK_BIT not allowed for receive");
-      break;
-    default:
-      vtkErrorMacro("datatype = " << dataType << " not allowed for receive");
-  }
-}
-
 //--------------------------------------------------------------------
 int vtkRedistributePolyData::DoubleCheckArrays(vtkPolyData* input)
 {
@@ -21,6 +21,12 @@
  * @class   vtkRedistributePolyData
  * @brief   redistribute poly cells from other processes
  *                        (special version to color according to processor)
+ *
+ * Subclasses decide which cells go where in MakeSchedule(). The cells, points
+ * and attributes sent to a process are packed in a single buffer. Buffer
+ * sizes are exchanged first, then all buffers are exchanged with nonblocking
+ * MPI calls, each received buffer being unpacked as soon as it arrives while
+ * the cells that stay on this process are copied in the meantime.
 */
 
 #ifndef vtkRedistributePolyData_h
@@ -30,6 +36,7 @@
 #include "vtkPolyDataAlgorithm.h"
 
 //*******************************************************************
+class vtkCharArray;
 class vtkDataArray;
 class vtkDataSetAttributes;
 class vtkMultiProcessController;
@@ -85,9 +92,17 @@ protected:
     CELL_CNT_TAG = 150,
     CELL_TAG = 160,
     POINTS_SIZE_TAG = 170,
-    POINTS_TAG = 180
+    POINTS_TAG = 180,
+
+    HEADER_TAG = 190,
+    BUFFER_TAG = 191
   };
 
+  // Number of values in the header sent ahead of each buffer: the buffer
+  // size in bytes, the number of points, then the connectivity size and the
+  // number of cells for each cell type.
+  static const int HEADER_SIZE = 10;
+
   class VTKPVVTKEXTENSIONSRENDERING_EXPORT vtkCommSched
   {
   public:
@@ -113,13 +128,27 @@ protected:
   virtual void MakeSchedule(vtkPolyData* input, vtkCommSched*);
   void OrderSchedule(vtkCommSched*);
 
-  void SendCellSizes(
-    vtkIdType*, vtkIdType*, vtkPolyData*, int, vtkIdType&, vtkIdType*, vtkIdType**);
+  /**
+   * Packs the given cells, their points and the associated attributes in a
+   * single buffer to send to another process. The cells are a block from
+   * startCell to stopCell or, when sendCellList is not null, the first
+   * (stopCell - startCell + 1) cells of the list, for each cell type. The
+   * header, HEADER_SIZE values, describes the buffer to the receiver.
+   */
+  void PackCells(vtkIdType* startCell, vtkIdType* stopCell, vtkPolyData* input,
+    vtkIdType** sendCellList, vtkIdType* header, vtkCharArray* buffer);
+
+  /**
+   * Unpacks a buffer made by PackCells() into the output. cellOffsets are the
+   * ids of the first output cell of each type, cellPtOffsets the location of
+   * its connectivity in the output cell arrays and pointOffset the id of the
+   * first output point for this buffer.
+   */
+  void UnpackCells(vtkCharArray* buffer, const vtkIdType* header, vtkPolyData* output,
+    int recFrom, const vtkIdType* cellOffsets, const vtkIdType* cellPtOffsets,
+    vtkIdType pointOffset);
+
   void CopyCells(vtkIdType*, vtkPolyData*, vtkPolyData*, vtkIdType**);
-  void SendCells(
-    vtkIdType*, vtkIdType*, vtkPolyData*, vtkPolyData*, int, vtkIdType&, vtkIdType*, vtkIdType**);
-  void ReceiveCells(
-    vtkIdType*, vtkIdType*, vtkPolyData*, int, vtkIdType*, vtkIdType*, vtkIdType, vtkIdType);
 
   void FindMemReq(vtkIdType*, vtkPolyData*, vtkIdType&, vtkIdType*);
 
@@ -127,30 +156,17 @@ protected:
   void AllocatePointDataArrays(vtkDataSetAttributes*, vtkIdType*, int, vtkIdType);
   void AllocateArrays(vtkDataArray*, vtkIdType);
 
-  void CopyDataArrays(vtkDataSetAttributes*, vtkDataSetAttributes*, vtkIdType, vtkIdType*, int);
+  void CopyDataArrays(
+    vtkDataSetAttributes*, vtkDataSetAttributes*, vtkIdType, vtkIdType*, vtkIdType, int);
 
   void CopyCellBlockDataArrays(
     vtkDataSetAttributes*, vtkDataSetAttributes*, vtkIdType, vtkIdType, vtkIdType, vtkIdType, int);
 
-  void CopyArrays(vtkDataArray*, vtkDataArray*, vtkIdType, vtkIdType*, int);
+  void CopyArrays(vtkDataArray*, vtkDataArray*, vtkIdType, vtkIdType*, vtkIdType, int);
 
   void CopyBlockArrays(
     vtkDataArray*, vtkDataArray*, vtkIdType, vtkIdType, vtkIdType, vtkIdType, int);
 
-  void SendDataArrays(
-    vtkDataSetAttributes*, vtkDataSetAttributes*, vtkIdType, int, vtkIdType*, int);
-
-  void SendCellBlockDataArrays(
-    vtkDataSetAttributes*, vtkDataSetAttributes*, vtkIdType, int, vtkIdType, int);
-
-  void SendArrays(vtkDataArray*, vtkIdType, int, vtkIdType*, int);
-
-  void SendBlockArrays(vtkDataArray*, vtkIdType, int, vtkIdType, int);
-
-  void ReceiveDataArrays(vtkDataSetAttributes*, vtkIdType, int, vtkIdType*, int);
-
-  void ReceiveArrays(vtkDataArray*, vtkIdType, int, vtkIdType*, int);
-
   int RequestData(vtkInformation* request, vtkInformationVector** inputVector,
     vtkInformationVector* outputVector) VTK_OVERRIDE;
 
@@ -33,6 +33,7 @@
 #include "vtkCleanArrays.h"
 #include "vtkCleanUnstructuredGrid.h"
 #include "vtkCompositeDataToUnstructuredGridFilter.h"
+#include "vtkConcurrentEquivalenceSet.h"
 #include "vtkDataSetToRectilinearGrid.h"
 //#include "vtkEnzoReader.h"
 #include "vtkEquivalenceSet.h"
@@ -211,6 +212,7 @@ int ParaViewCoreVTKExtensionsPrintSelf(int, char* [])
   PRINT_SELF(vtkCleanArrays);
   PRINT_SELF(vtkCleanUnstructuredGrid);
   PRINT_SELF(vtkCompositeDataToUnstructuredGridFilter);
+  PRINT_SELF(vtkConcurrentEquivalenceSet);
   PRINT_SELF(vtkCSVExporter);
   PRINT_SELF(vtkCSVWriter);
   PRINT_SELF(vtkDataSetToRectilinearGrid);
@@ -16,6 +16,7 @@ from vtkmodules.numpy_interface.algorithms import *
 
 from paraview.vtk import vtkDoubleArray, vtkSelectionNode, vtkSelection, vtkStreamingDemandDrivenPipeline
 
+import re
 import sys
 if sys.version_info >= (3,):
     xrange = range
@@ -140,6 +141,154 @@ def compute(inputs, expression, ns=None):
     retVal = eval(expression, globals(), mylocals)
     return retVal
 
+def batch_variables(variables):
+    """Concatenates the per-block arrays of the VTKCompositeDataArray instances
+    in `variables` into contiguous arrays.
+
+    Returns a tuple (batched, lengths) where `batched` is a new 'dict' with
+    each composite array replaced by its concatenation and `lengths` is the
+    list of the number of tuples of each block. Arrays that are missing on
+    some blocks are left out. Returns (None, None) if there is nothing to
+    batch or if the arrays do not line up across blocks.
+    """
+    batched = dict()
+    lengths = None
+    for name, value in variables.items():
+        if not isinstance(value, dsa.VTKCompositeDataArray):
+            if value is not dsa.NoneArray:
+                batched[name] = value
+            continue
+        arrays = value.Arrays
+        if not arrays or any(a is dsa.NoneArray for a in arrays):
+            continue
+        block_lengths = [a.shape[0] for a in arrays]
+        if lengths is None:
+            lengths = block_lengths
+        elif lengths != block_lengths:
+            return (None, None)
+        concatenated = dsa.VTKArray(np.concatenate(arrays))
+        concatenated.Association = value.Association
+        batched[name] = concatenated
+    if lengths is None:
+        return (None, None)
+    return (batched, lengths)
+
+def split_result(result, lengths, dataset, association):
+    """Splits a result computed on concatenated arrays back into blocks. The
+    per-block arrays are views into `result`, no data is copied."""
+    offsets = np.cumsum([0] + lengths)
+    arrays = [result[offsets[i]:offsets[i+1]] for i in xrange(len(lengths))]
+    return dsa.VTKCompositeDataArray(arrays, dataset=dataset, association=association)
+
+def _same_values(a, b):
+    """Returns True if `a` and `b` have the same type, shape and values, NaNs
+    included."""
+    if a.dtype != b.dtype or a.shape != b.shape:
+        return False
+    same = a == b
+    if a.dtype.kind == 'f':
+        same |= np.isnan(a) & np.isnan(b)
+    return bool(np.all(same))
+
+def evaluate_numexpr(expression, ns):
+    """Evaluates `expression` with numexpr, which uses multiple threads, if
+    numexpr is available and evaluates the expression the same way numpy
+    does. Returns None otherwise, in which case the expression should be
+    evaluated with Python.
+
+    numexpr differs from numpy on integer arithmetic (division and modulo of
+    negative numbers, overflow) and on the types of mixed results. Thus only
+    the floating point arrays and float numbers of `ns` are passed to
+    numexpr, so that expressions using anything else fail, and modulo and
+    floor division are never passed. Then the expression is evaluated by both
+    on the first few tuples, and numexpr is only used if it gives the same
+    values with the same type.
+    """
+    try:
+        import numexpr
+    except ImportError:
+        return None
+    if "%" in expression or "//" in expression:
+        return None
+    # With Intel's VML, numexpr's math functions may differ from numpy's in
+    # the last bits.
+    if getattr(numexpr, "use_vml", False) and \
+        re.search(r"[A-Za-z_][A-Za-z0-9_]*\s*\(", expression):
+        return None
+
+    local_dict = dict()
+    probe_dict = dict()
+    length = None
+    for name, value in ns.items():
+        if isinstance(value, np.ndarray):
+            if value.ndim == 0 or value.dtype not in (np.float32, np.float64):
+                continue
+            if length is None:
+                length = value.shape[0]
+            elif length != value.shape[0]:
+                return None
+            local_dict[name] = np.asarray(value)
+            probe_dict[name] = np.asarray(value[:16])
+        elif isinstance(value, float):
+            local_dict[name] = value
+            probe_dict[name] = value
+    if not length:
+        return None
+
+    # Python 2 divides integer numbers with floor division, as this module
+    # does not import division from __future__.
+    truediv = sys.version_info >= (3,)
+    try:
+        reference = np.asarray(eval(expression, globals(), dict(probe_dict)))
+        probe = numexpr.evaluate(expression, local_dict=probe_dict, global_dict={},
+            truediv=truediv)
+    except Exception:
+        return None
+    if reference.ndim == 0 or not _same_values(reference, probe):
+        return None
+    try:
+        retVal = numexpr.evaluate(expression, local_dict=local_dict, global_dict={},
+            truediv=truediv)
+    except Exception:
+        return None
+    if retVal.shape != (length,) + reference.shape[1:]:
+        return None
+    return retVal
+
+def compute_batched(self, inputs, output, expression, variables):
+    """Evaluates the expression once over the concatenated arrays of all blocks
+    of a composite first input and returns the result split over the blocks of
+    `output`. Returns None if the expression cannot be evaluated that way, in
+    which case it should be evaluated block by block."""
+    batched, lengths = batch_variables(variables)
+    if batched is None:
+        return None
+
+    retVal = None
+    if self.GetUseNumExpr():
+        retVal = evaluate_numexpr(expression, batched)
+    if retVal is None:
+        mylocals = dict(batched)
+        mylocals["inputs"] = inputs
+        try:
+            points = inputs[0].Points
+            if isinstance(points, dsa.VTKCompositeDataArray) and \
+                all(p is not dsa.NoneArray for p in points.Arrays):
+                mylocals["points"] = dsa.VTKArray(np.concatenate(points.Arrays))
+        except AttributeError: pass
+        try:
+            retVal = eval(expression, globals(), mylocals)
+        except Exception:
+            return None
+
+    if not isinstance(retVal, np.ndarray) or retVal.ndim == 0 or \
+        retVal.shape[0] != sum(lengths):
+        return None
+    association = getattr(retVal, "Association", None)
+    if association is None:
+        association = self.GetArrayAssociation()
+    return split_result(np.ascontiguousarray(retVal), lengths, output, association)
+
 def get_data_time(self, do, ininfo):
     dinfo = do.GetInformation()
     if dinfo and dinfo.Has(do.DATA_TIME_STEP()):
@@ -189,7 +338,14 @@ def execute(self, expression):
                        "t_value": inputs[0].t_value,
                        "time_index": inputs[0].time_index,
                        "t_index": inputs[0].t_index })
-    retVal = compute(inputs, expression, ns=variables)
+    retVal = None
+    if inputs[0].VTKObject.IsA("vtkCompositeDataSet"):
+        if self.GetBatchedEvaluation():
+            retVal = compute_batched(self, inputs, output, expression, variables)
+    elif self.GetUseNumExpr():
+        retVal = evaluate_numexpr(expression, variables)
+    if retVal is None:
+        retVal = compute(inputs, expression, ns=variables)
     if retVal is not None:
         if hasattr(retVal, "Association"):
             output.GetAttributes(retVal.Association).append(\
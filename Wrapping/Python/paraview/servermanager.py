@@ -1796,10 +1796,20 @@ class ProxyManager(object):
         return getattr(self.SMProxyManager, name)
 
     def LoadState(self, filename, loader = None):
-        self.SMProxyManager.LoadXMLState(filename, loader)
+        """Loads the state from the file. Files with the .pvsb extension
+        are loaded as binary state, others as XML state."""
+        if filename.lower().endswith(".pvsb"):
+            self.SMProxyManager.LoadBinaryState(filename, loader)
+        else:
+            self.SMProxyManager.LoadXMLState(filename, loader)
 
     def SaveState(self, filename):
-        self.SMProxyManager.SaveXMLState(filename)
+        """Saves the state to the file. Files with the .pvsb extension
+        are saved as binary state, others as XML state."""
+        if filename.lower().endswith(".pvsb"):
+            self.SMProxyManager.SaveBinaryState(filename)
+        else:
+            self.SMProxyManager.SaveXMLState(filename)
 
 class PropertyIterator(object):
     """Wrapper for a vtkSMPropertyIterator class to satisfy
@@ -437,6 +437,9 @@ def LoadState(filename, connection=None, **extraArgs):
 # -----------------------------------------------------------------------------
 
 def SaveState(filename):
+    """Saves the state. Use the .pvsb extension for the binary state format.
+    Loading a .pvsm state and saving it as .pvsb (or the other way around)
+    converts between the two formats."""
     servermanager.SaveState(filename)
 
 #==============================================================================